@@ -8,6 +8,7 @@
 #include "abyss.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdlib>
 #include <queue>
@@ -37,6 +38,7 @@
 #include "mapmark.h"
 #include "maps.h"
 #include "message.h"
+#include "mon-act.h"
 #include "mon-cast.h"
 #include "mon-death.h"
 #include "mon-pathfind.h"
@@ -51,6 +53,7 @@
 #include "state.h"
 #include "stairs.h"
 #include "stringutil.h"
+#include "tasks.h"
 #include "terrain.h"
 #include "rltiles/tiledef-dngn.h"
 #include "tileview.h"
@@ -73,6 +76,9 @@ typedef priority_queue<ProceduralSample, vector<ProceduralSample>, ProceduralSam
 static sample_queue abyss_sample_queue;
 static vector<dungeon_feature_type> abyssal_features;
 static list<monster*> displaced_monsters;
+// Cells whose terrain the current morph has changed.
+static vector<coord_def> morphed_cells;
+static const size_t MAX_MORPHED_CELLS_LOS = 24;
 
 static void abyss_area_shift();
 static void _push_items();
@@ -1154,10 +1160,136 @@ const static RiverLayout rivers(1800, baseLayout);
 // This one is not fixed: [0] is a level pulled from the current game
 static vector<const ProceduralLayout*> complex_vec(2);
 
+// While you're a step away from an area shift, the terrain the shift would
+// bring in is sampled on a worker thread, so that the shift itself only has
+// to look it up. The layouts depend on nothing but the cell and the depth,
+// and the depth doesn't change until the next morph, so these are exactly
+// the samples the shift would otherwise take.
+struct abyss_shift_samples
+{
+    coord_def tl;                   // in abyss coordinates
+    coord_def size;
+    uint32_t depth;
+    const ProceduralLayout *layout;
+    vector<ProceduralSample> samples;
+    std::atomic<bool> cancelled;
+};
+
+static shared_ptr<abyss_shift_samples> shift_samples;
+static task_ticket shift_samples_task;
+
+static void _sample_shift_area(abyss_shift_samples &area)
+{
+    area.samples.reserve(area.size.x * area.size.y);
+    for (int y = 0; y < area.size.y; ++y)
+    {
+        // A partial set of samples is never looked at.
+        if (area.cancelled)
+            return;
+        for (int x = 0; x < area.size.x; ++x)
+        {
+            const coord_def pt = area.tl + coord_def(x, y);
+            area.samples.push_back(_in_wastes(pt)
+                                   ? wastes(pt, area.depth)
+                                   : (*area.layout)(pt, area.depth));
+        }
+    }
+}
+
+static void _drop_shift_samples()
+{
+    if (!shift_samples)
+        return;
+    shift_samples->cancelled = true;
+    shift_samples_task.wait();
+    shift_samples.reset();
+    shift_samples_task = task_ticket();
+}
+
+// The abyss coordinates of the part of the map an area shift regenerates,
+// if the shift happens with you at pos.
+static void _shift_window(const coord_def &pos, coord_def &tl, coord_def &br)
+{
+    const coord_def major = abyssal_state.major_coord + (pos - ABYSS_CENTRE);
+    tl = coord_def(MAPGEN_BORDER, MAPGEN_BORDER) + major;
+    br = coord_def(GXM - MAPGEN_BORDER - 1, GYM - MAPGEN_BORDER - 1) + major;
+}
+
+static bool _shift_samples_cover(const coord_def &tl, const coord_def &br)
+{
+    return shift_samples
+           && shift_samples->depth == abyssal_state.depth
+           && shift_samples->layout == abyssLayout
+           && tl.x >= shift_samples->tl.x && tl.y >= shift_samples->tl.y
+           && br.x < shift_samples->tl.x + shift_samples->size.x
+           && br.y < shift_samples->tl.y + shift_samples->size.y;
+}
+
+static const ProceduralSample *_shift_sample(const coord_def &pt)
+{
+    if (!_shift_samples_cover(pt, pt) || !shift_samples_task.done())
+        return nullptr;
+
+    const abyss_shift_samples &area = *shift_samples;
+    if ((int)area.samples.size() != area.size.x * area.size.y)
+        return nullptr;
+    const coord_def d = pt - area.tl;
+    return &area.samples[d.y * area.size.x + d.x];
+}
+
+void abyss_sample_next_shift()
+{
+#ifdef TASK_THREADS
+    // Without a layout yet, making one would use the RNG.
+    if (!player_in_branch(BRANCH_ABYSS) || !abyssLayout)
+        return;
+
+    // Every step that would set off a shift; their windows overlap all but
+    // a row or column, so they're sampled as one.
+    bool any = false;
+    coord_def tl, br;
+    for (adjacent_iterator ai(you.pos()); ai; ++ai)
+    {
+        if (map_bounds_with_margin(*ai,
+                                   MAPGEN_BORDER + ABYSS_AREA_SHIFT_RADIUS + 1))
+        {
+            continue;
+        }
+        coord_def step_tl, step_br;
+        _shift_window(*ai, step_tl, step_br);
+        tl = any ? coord_def(min(tl.x, step_tl.x), min(tl.y, step_tl.y))
+                 : step_tl;
+        br = any ? coord_def(max(br.x, step_br.x), max(br.y, step_br.y))
+                 : step_br;
+        any = true;
+    }
+
+    if (!any || _shift_samples_cover(tl, br))
+        return;
+
+    _drop_shift_samples();
+    shift_samples = std::make_shared<abyss_shift_samples>();
+    shift_samples->tl = tl;
+    shift_samples->size = br - tl + coord_def(1, 1);
+    shift_samples->depth = abyssal_state.depth;
+    shift_samples->layout = abyssLayout;
+    shift_samples->cancelled = false;
+    shared_ptr<abyss_shift_samples> area = shift_samples;
+    shift_samples_task = task_start([area] { _sample_shift_area(*area); },
+                                    "abyss");
+#endif
+}
+
 static ProceduralSample _abyss_grid(const coord_def &p)
 {
     const coord_def pt = p + abyssal_state.major_coord;
 
+    if (const ProceduralSample *sample = _shift_sample(pt))
+    {
+        abyss_sample_queue.push(*sample);
+        return *sample;
+    }
+
     if (_in_wastes(pt))
     {
         ProceduralSample sample = wastes(pt, abyssal_state.depth);
@@ -1295,6 +1427,8 @@ static void _update_abyss_terrain(const coord_def &p,
     if (feat != currfeat)
     {
         env.grid(rp) = feat;
+        if (morph)
+            morphed_cells.push_back(rp);
         if (feat == DNGN_FLOOR && in_los_bounds_g(rp))
         {
             cloud_type cloud = _cloud_from_feat(currfeat);
@@ -1529,12 +1663,22 @@ static void abyss_area_shift()
         // spawn new monsters or allow return from transit, though.
         if (you.pos() != ABYSS_CENTRE)
         {
+            // Finish sampling the new area if that was under way, or stop
+            // if it was for somewhere else.
+            coord_def tl, br;
+            _shift_window(you.pos(), tl, br);
+            if (_shift_samples_cover(tl, br))
+                shift_samples_task.wait();
+            else
+                _drop_shift_samples();
+
             // Use a map mask to track the areas that the shift destroys and
             // that must be regenerated by _generate_area.
             map_bitmask abyss_genlevel_mask;
             _abyss_shift_level_contents_around_player(
                 ABYSS_AREA_SHIFT_RADIUS, ABYSS_CENTRE, abyss_genlevel_mask);
             _generate_area(abyss_genlevel_mask);
+            _drop_shift_samples();
         }
         forget_map(true);
 
@@ -1567,6 +1711,7 @@ static void abyss_area_shift()
 
 void destroy_abyss()
 {
+    _drop_shift_samples();
     if (abyssLayout)
     {
         delete abyssLayout;
@@ -1702,6 +1847,8 @@ static void _increase_depth()
 
 void abyss_morph()
 {
+    // The depth is about to move on.
+    _drop_shift_samples();
     if (abyssal_state.destroy_all_terrain)
     {
         _destroy_all_terrain(false);
@@ -1712,11 +1859,25 @@ void abyss_morph()
     _increase_depth();
     map_bitmask abyss_genlevel_mask(true);
     dgn_erase_unused_vault_placements();
+    morphed_cells.clear();
     _abyss_apply_terrain(abyss_genlevel_mask, true);
     _place_displaced_monsters();
     _push_items();
     // TODO: does gozag gold detection need to be here too?
-    los_changed();
+
+    // Clouds and moved monsters have updated LOS themselves, so only the
+    // changed terrain is left. Each cell forgets the LOS of everything in
+    // range of it, so past a handful of scattered cells that's most of the
+    // map and it's cheaper to drop the lot.
+    if (morphed_cells.size() > MAX_MORPHED_CELLS_LOS)
+        los_changed();
+    else
+    {
+        mons_reset_just_seen();
+        for (const coord_def &p : morphed_cells)
+            los_terrain_changed(p);
+    }
+    morphed_cells.clear();
 }
 
 // Force the player one level deeper in the abyss during an abyss teleport with
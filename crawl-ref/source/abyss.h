@@ -42,6 +42,7 @@ void push_features_to_abyss();
 void clear_abyssal_rune_knowledge();
 void generate_abyss();
 void maybe_shift_abyss_around_player();
+void abyss_sample_next_shift();
 void abyss_maybe_spawn_xp_exit();
 void abyss_teleport(bool wizard_tele = false);
 void save_abyss_uniques();
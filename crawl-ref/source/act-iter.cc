@@ -161,21 +161,45 @@ void monster_near_iterator::advance()
 
 //////////////////////////////////////////////////////////////////////////
 
+// Every slot at or above this is empty. Starts out covering everything,
+// since the level may have been filled without going through reset().
+static int _monster_slot_limit = MAX_MONSTERS;
+
+void note_monster_slot(int mindex)
+{
+    if (mindex >= _monster_slot_limit && mindex < MAX_MONSTERS)
+        _monster_slot_limit = mindex + 1;
+}
+
+void trim_monster_slots()
+{
+    while (_monster_slot_limit > 0
+           && env.mons[_monster_slot_limit - 1].type == MONS_NO_MONSTER)
+    {
+        _monster_slot_limit--;
+    }
+}
+
+int monster_slot_limit()
+{
+    return _monster_slot_limit;
+}
+
 monster_iterator::monster_iterator()
     : i(0)
 {
-    while (i < MAX_MONSTERS && !env.mons[i].alive())
+    while (i < _monster_slot_limit && !env.mons[i].alive())
         i++;
 }
 
 monster_iterator::operator bool() const
 {
-    return i < MAX_MONSTERS && (*this)->alive();
+    return i < _monster_slot_limit && (*this)->alive();
 }
 
 monster* monster_iterator::operator*() const
 {
-    if (i < MAX_MONSTERS)
+    if (i < _monster_slot_limit)
         return &env.mons[i];
     else
         return nullptr;
@@ -188,7 +212,7 @@ monster* monster_iterator::operator->() const
 
 monster_iterator& monster_iterator::operator++()
 {
-    while (++i < MAX_MONSTERS)
+    while (++i < _monster_slot_limit)
         if (env.mons[i].alive())
             break;
     return *this;
@@ -204,7 +228,7 @@ monster_iterator monster_iterator::operator++(int)
 void monster_iterator::advance()
 {
     do
-         if (++i >= MAX_MONSTERS)
+         if (++i >= _monster_slot_limit)
              return;
     while (!(*this)->alive());
 }
@@ -56,6 +56,13 @@ protected:
     void advance();
 };
 
+// monster_iterator only walks env.mons up to the highest slot that may be in
+// use. Filling a slot (monster::reset()) raises the limit; trimming lowers
+// it past empty slots, and must only be done when no monster is half-made.
+void note_monster_slot(int mindex);
+void trim_monster_slots();
+int monster_slot_limit();
+
 class monster_iterator
 {
 public:
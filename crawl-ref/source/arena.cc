@@ -7,6 +7,7 @@
 
 #include "arena.h"
 
+#include <chrono>
 #include <stdexcept>
 
 #include "act-iter.h"
@@ -18,6 +19,8 @@
 #include "item-name.h"
 #include "item-status-flag-type.h"
 #include "items.h"
+#include "json.h"
+#include "json-wrapper.h"
 #include "libutil.h"
 #include "los.h"
 #include "macro.h"
@@ -184,6 +187,15 @@ namespace arena
 
     static int turns       = 0;
 
+    // With the headless tag: what each match came to, for arena.json.
+    struct match_result
+    {
+        int turns;
+        double seconds;
+        int winner; // 0 for team a, 1 for team b, -1 for a tie
+    };
+    static vector<match_result> match_results;
+
     static bool allow_summons       = true;
     static bool allow_animate       = true;
     static bool allow_chain_summons = true;
@@ -196,6 +208,7 @@ namespace arena
     static bool move_summons        = false;
     static bool respawn             = false;
     static bool move_respawns       = false;
+    static bool headless            = false;
 
     static bool miscasts            = false;
 
@@ -408,6 +421,7 @@ namespace arena
         miscasts        =  strip_tag(spec, "miscasts");
         respawn         =  strip_tag(spec, "respawn");
         move_respawns   =  strip_tag(spec, "move_respawns");
+        headless        =  strip_tag(spec, "headless");
         summon_throttle = strip_number_tag(spec, "summon_throttle:");
 
         if (real_summons && respawn)
@@ -424,7 +438,8 @@ namespace arena
         random_uniques = strip_tag(spec, "random_uniques");
 
         const int ntrials = strip_number_tag(spec, "t:");
-        if (ntrials != TAG_UNFOUND && ntrials >= 1 && ntrials <= 99
+        if (ntrials != TAG_UNFOUND && ntrials >= 1
+            && ntrials <= (headless ? 9999 : 99)
             && !total_trials)
         {
             total_trials = ntrials;
@@ -521,6 +536,9 @@ namespace arena
 
     static void show_fight_banner(bool after_fight = false)
     {
+        if (headless)
+            return;
+
         int line = 1;
 
         cgotoxy(1, line++, GOTO_STAT);
@@ -825,12 +843,19 @@ namespace arena
 
     static void do_fight()
     {
-        viewwindow();
-        update_screen();
+        const auto start = chrono::steady_clock::now();
+
+        if (!headless)
+        {
+            viewwindow();
+            update_screen();
+        }
         clear_messages(true);
 
         {
             cursor_control coff(false);
+            // Nobody is watching: messages only matter for arena.result.
+            msg::suppress quiet(headless && !Options.arena_dump_msgs);
             while (fight_is_on() && !contest_cancelled)
             {
 #ifdef ARENA_VERBOSE
@@ -851,12 +876,12 @@ namespace arena
                 do_respawn(faction_a);
                 do_respawn(faction_b);
                 balance_spawners();
-                if (!contest_cancelled)
+                if (!contest_cancelled && !headless)
                     ui::delay(Options.view_delay);
                 clear_messages();
                 ASSERT(you.pet_target == MHITNOT);
             }
-            if (!contest_cancelled)
+            if (!contest_cancelled && !headless)
             {
                 viewwindow();
                 update_screen();
@@ -924,6 +949,11 @@ namespace arena
         else if (faction_a.won)
             team_a_wins++;
 
+        const chrono::duration<double> elapsed =
+            chrono::steady_clock::now() - start;
+        match_results.push_back({turns, elapsed.count(),
+                                 was_tied ? -1 : faction_a.won ? 0 : 1});
+
         show_fight_banner(true);
 
         string msg;
@@ -951,6 +981,7 @@ namespace arena
         contest_cancelled = false;
         is_respawning = false;
         uniques_list.clear();
+        match_results.clear();
         memset(banned_glyphs, 0, sizeof(banned_glyphs));
         arena_type = "";
         place = level_id(BRANCH_DEPTHS, 1);
@@ -963,6 +994,12 @@ namespace arena
         // Set various options from the arena spec's tags
         parse_monster_spec(); // may throw an arena_error
 
+        if (headless)
+        {
+            Options.view_delay = 0;
+            Options.use_animations = use_animations_type();
+        }
+
         crawl_view.init_geometry();
         expand_mlist(5);
 
@@ -999,6 +1036,54 @@ namespace arena
         }
     }
 
+    // The results of a headless run, one entry per match.
+    static void write_results_json()
+    {
+        JsonWrapper json(json_mkobject());
+        json_append_member(json.node, "teams",
+                           json_mkstring(faction_a.desc + " v "
+                                         + faction_b.desc));
+        json_append_member(json.node, "team_a_wins",
+                           json_mknumber(team_a_wins));
+        json_append_member(json.node, "team_b_wins",
+                           json_mknumber(trials_done - team_a_wins - ties));
+        json_append_member(json.node, "ties", json_mknumber(ties));
+
+        double total_seconds = 0;
+        int total_turns = 0;
+        JsonNode *matches(json_mkarray());
+        for (const match_result &result : match_results)
+        {
+            JsonNode *match(json_mkobject());
+            json_append_member(match, "turns", json_mknumber(result.turns));
+            json_append_member(match, "seconds",
+                               json_mknumber(result.seconds));
+            json_append_member(match, "winner",
+                               result.winner == -1 ? json_mknull()
+                               : json_mkstring(result.winner ? "b" : "a"));
+            json_append_element(matches, match);
+            total_seconds += result.seconds;
+            total_turns += result.turns;
+        }
+        json_append_member(json.node, "matches", matches);
+        json_append_member(json.node, "turns", json_mknumber(total_turns));
+        json_append_member(json.node, "seconds", json_mknumber(total_seconds));
+        if (total_seconds > 0)
+        {
+            json_append_member(json.node, "turns_per_second",
+                               json_mknumber(total_turns / total_seconds));
+        }
+
+        FILE *outf = fopen_u("arena.json", "w");
+        if (!outf)
+        {
+            fprintf(stderr, "Couldn't write arena.json.\n");
+            return;
+        }
+        fprintf(outf, "%s\n", json.to_string().c_str());
+        fclose(outf);
+    }
+
     static void write_error(const string &error)
     {
         if (file != nullptr)
@@ -1052,13 +1137,13 @@ namespace arena
             }
             do_fight();
 
-            if (!contest_cancelled && trials_done < total_trials)
+            if (!contest_cancelled && trials_done < total_trials && !headless)
                 ui::delay(Options.view_delay * 5);
         }
         while (!contest_cancelled && trials_done < total_trials);
 
         // why extra delay?
-        if (!contest_cancelled)
+        if (!contest_cancelled && !headless)
             ui::delay(Options.view_delay * 5);
 
         if (trials_done > 0)
@@ -1075,7 +1160,7 @@ namespace arena
             }
 
             mpr("---- Contest finished ----\n" + outcome);
-            if (!skipped_arena_ui)
+            if (!skipped_arena_ui && !headless)
             {
                 ui::message(outcome, "Arena results:",
                     "<cyan>Hit any key to continue, ctrl-p for the full log.</cyan>");
@@ -1085,6 +1170,8 @@ namespace arena
         ui::pop_layout();
 
         write_results();
+        if (headless)
+            write_results_json();
     }
 }
 
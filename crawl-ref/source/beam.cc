@@ -80,6 +80,7 @@
 #include "tiles-build-specific.h"
 #include "transform.h"
 #include "traps.h"
+#include "turn-times.h"
 #include "viewchar.h"
 #include "view.h"
 #include "xom.h"
@@ -1111,26 +1112,52 @@ void bolt::affect_cell()
         affect_ground();
 }
 
-static void _undo_tracer(bolt &orig, bolt &copy)
-{
-    // FIXME: we should have a better idea of what gets changed!
-    orig.target           = copy.target;
-    orig.source           = copy.source;
-    orig.aimed_at_spot    = copy.aimed_at_spot;
-    orig.aimed_at_feet    = copy.aimed_at_feet;
-    orig.extra_range_used = copy.extra_range_used;
-    orig.auto_hit         = copy.auto_hit;
-    orig.ray              = copy.ray;
-    orig.colour           = copy.colour;
-    orig.flavour          = copy.flavour;
-    orig.real_flavour     = copy.real_flavour;
-    orig.bounces          = copy.bounces;
-    orig.bounce_pos       = copy.bounce_pos;
-}
+// The fields a tracer may change, which fire() puts back afterwards. Only
+// these are kept, rather than a copy of the whole bolt with all its strings.
+// FIXME: we should have a better idea of what gets changed!
+struct tracer_undo
+{
+    coord_def target, source;
+    bool aimed_at_spot = false, aimed_at_feet = false;
+    int extra_range_used = 0;
+    bool auto_hit = false;
+    ray_def ray;
+    colour_t colour = BLACK;
+    beam_type flavour = BEAM_MAGIC, real_flavour = BEAM_MAGIC;
+    int bounces = 0;
+    coord_def bounce_pos;
+
+    tracer_undo() = default;
+    explicit tracer_undo(const bolt &b)
+        : target(b.target), source(b.source), aimed_at_spot(b.aimed_at_spot),
+          aimed_at_feet(b.aimed_at_feet), extra_range_used(b.extra_range_used),
+          auto_hit(b.auto_hit), ray(b.ray), colour(b.colour),
+          flavour(b.flavour), real_flavour(b.real_flavour),
+          bounces(b.bounces), bounce_pos(b.bounce_pos)
+    {
+    }
+
+    void restore(bolt &b) const
+    {
+        b.target           = target;
+        b.source           = source;
+        b.aimed_at_spot    = aimed_at_spot;
+        b.aimed_at_feet    = aimed_at_feet;
+        b.extra_range_used = extra_range_used;
+        b.auto_hit         = auto_hit;
+        b.ray              = ray;
+        b.colour           = colour;
+        b.flavour          = flavour;
+        b.real_flavour     = real_flavour;
+        b.bounces          = bounces;
+        b.bounce_pos       = bounce_pos;
+    }
+};
 
 // This saves some important things before calling fire().
 void bolt::fire()
 {
+    TURN_PHASE(TP_BEAM);
     path_taken.clear();
 
     if (special_explosion)
@@ -1138,19 +1165,16 @@ void bolt::fire()
 
     if (is_tracer)
     {
-        bolt boltcopy = *this;
+        const tracer_undo saved(*this);
+        tracer_undo saved_explosion;
         if (special_explosion != nullptr)
-            boltcopy.special_explosion = new bolt(*special_explosion);
+            saved_explosion = tracer_undo(*special_explosion);
 
         do_fire();
 
         if (special_explosion != nullptr)
-        {
-            _undo_tracer(*special_explosion, *boltcopy.special_explosion);
-            delete boltcopy.special_explosion;
-        }
-
-        _undo_tracer(*this, boltcopy);
+            saved_explosion.restore(*special_explosion);
+        saved.restore(*this);
     }
     else
         do_fire();
@@ -6282,8 +6306,7 @@ bool bolt::explode(bool show_more, bool hole_in_the_middle)
 
     // Run DFS to determine which cells are influenced
     explosion_map exp_map;
-    exp_map.init(INT_MAX);
-    determine_affected_cells(exp_map, coord_def(), 0, r, true, true);
+    explosion_cells(exp_map, r);
 
     // We get a bit fancy, drawing all radius 0 effects, then radius
     // 1, radius 2, etc. It looks a bit better that way.
@@ -6383,6 +6406,72 @@ void bolt::explosion_affect_cell(const coord_def& p)
     target = orig_pos;
 }
 
+// What determine_affected_cells() found for an explosion of radius r at
+// pos(), stopping at statues and walls, the way every explosion and
+// explosion targeter asks for it. Tracers and targeters ask again and
+// again for the same spot, so recent answers are kept until terrain or
+// sanctuary changes or the caster moves.
+struct explosion_footprint
+{
+    coord_def centre;
+    coord_def caster;
+    int radius;
+    beam_type flavour;
+    bool burns_trees;
+    bool through_plants;
+    uint32_t generation;
+    coord_def sanctuary_pos;
+    int sanctuary_time;
+    explosion_map cells;
+
+    bool operator==(const explosion_footprint &o) const
+    {
+        return centre == o.centre && caster == o.caster
+               && radius == o.radius && flavour == o.flavour
+               && burns_trees == o.burns_trees
+               && through_plants == o.through_plants
+               && generation == o.generation
+               && sanctuary_pos == o.sanctuary_pos
+               && sanctuary_time == o.sanctuary_time;
+    }
+};
+
+static const int EXPLOSION_FOOTPRINTS = 16;
+static explosion_footprint _footprints[EXPLOSION_FOOTPRINTS];
+static int _footprints_used = 0;
+static int _next_footprint = 0;
+
+void bolt::explosion_cells(explosion_map& m, int r)
+{
+    const actor* caster = actor_by_mid(source_id);
+    explosion_footprint key;
+    key.centre         = pos();
+    key.caster         = caster ? caster->pos() : you.pos();
+    key.radius         = r;
+    key.flavour        = flavour;
+    key.burns_trees    = can_burn_trees();
+    key.through_plants = have_passive(passive_t::shoot_through_plants);
+    key.generation     = los_terrain_generation();
+    key.sanctuary_pos  = env.sanctuary_pos;
+    key.sanctuary_time = env.sanctuary_time;
+
+    for (int i = 0; i < _footprints_used; ++i)
+        if (_footprints[i] == key)
+        {
+            m = _footprints[i].cells;
+            return;
+        }
+
+    m.init(INT_MAX);
+    determine_affected_cells(m, coord_def(), 0, r, true, true);
+
+    key.cells = m;
+    _footprints[_next_footprint] = key;
+    _next_footprint = (_next_footprint + 1) % EXPLOSION_FOOTPRINTS;
+    if (_footprints_used < EXPLOSION_FOOTPRINTS)
+        _footprints_used++;
+}
+
 // Uses DFS
 void bolt::determine_affected_cells(explosion_map& m, const coord_def& delta,
                                     int count, int r,
@@ -223,6 +223,7 @@ public:
     void determine_affected_cells(explosion_map& m, const coord_def& delta,
                                   int count, int r,
                                   bool stop_at_statues, bool stop_at_walls);
+    void explosion_cells(explosion_map& m, int r);
 
     bool self_targeted() const;
 
@@ -28,9 +28,17 @@ bit_vector::~bit_vector()
     delete[] data;
 }
 
-void bit_vector::reset()
+int bit_vector::words_for(unsigned long nbits) const
 {
-    for (int w = 0; w < nwords; ++w)
+    if (nbits >= size)
+        return nwords;
+    return static_cast<int>((nbits + LONGSIZE - 1) / LONGSIZE);
+}
+
+void bit_vector::reset(unsigned long nbits)
+{
+    const int words = words_for(nbits);
+    for (int w = 0; w < words; ++w)
         data[w] = 0;
 }
 
@@ -69,6 +77,56 @@ bit_vector& bit_vector::operator &= (const bit_vector& other)
     return *this;
 }
 
+void bit_vector::or_with(const bit_vector& other, unsigned long nbits)
+{
+    ASSERT(size == other.size);
+    const int words = words_for(nbits);
+    for (int w = 0; w < words; ++w)
+        data[w] |= other.data[w];
+}
+
+void bit_vector::or_and(const bit_vector& a, const bit_vector& b,
+                        unsigned long nbits)
+{
+    ASSERT(size == a.size);
+    ASSERT(size == b.size);
+    const int words = words_for(nbits);
+    for (int w = 0; w < words; ++w)
+        data[w] |= a.data[w] & b.data[w];
+}
+
+static int _count_trailing_zeros(unsigned long word)
+{
+#ifdef __GNUC__
+    return __builtin_ctzl(word);
+#else
+    int n = 0;
+    for (; !(word & 1); word >>= 1)
+        n++;
+    return n;
+#endif
+}
+
+unsigned long bit_vector::next_unset(unsigned long index,
+                                     unsigned long end) const
+{
+    end = min(size, end);
+    if (index >= end)
+        return end;
+
+    const int words = words_for(end);
+    int w = index / LONGSIZE;
+    // Look for clear bits, ignoring the ones before index.
+    unsigned long word = ~data[w] & (ULONG_MAX << (index % LONGSIZE));
+    while (!word)
+    {
+        if (++w == words)
+            return end;
+        word = ~data[w];
+    }
+    return min(end, w * LONGSIZE + _count_trailing_zeros(word));
+}
+
 bit_vector bit_vector::operator & (const bit_vector& other) const
 {
     ASSERT(size == other.size);
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <bitset>
+#include <climits>
 #include <vector>
 
 #include "debug.h"
@@ -24,7 +25,9 @@ public:
     bit_vector(const bit_vector& other);
     ~bit_vector();
 
-    void reset();
+    // The nbits arguments restrict an operation to the bits below nbits
+    // (rounded up to whole words); bits above that are left untouched.
+    void reset(unsigned long nbits = ULONG_MAX);
 
     bool get(unsigned long index) const;
     void set(unsigned long index, bool value = true);
@@ -33,7 +36,19 @@ public:
     bit_vector& operator &= (const bit_vector& other);
     bit_vector  operator & (const bit_vector& other) const;
 
+    void or_with(const bit_vector& other, unsigned long nbits);
+
+    // *this |= a & b, without the temporary.
+    void or_and(const bit_vector& a, const bit_vector& b,
+                unsigned long nbits = ULONG_MAX);
+    // The first unset bit at or after index and below end, or
+    // min(size, end) if there's none.
+    unsigned long next_unset(unsigned long index,
+                             unsigned long end = ULONG_MAX) const;
+
 protected:
+    int words_for(unsigned long nbits) const;
+
     unsigned long size;
     int nwords;
     unsigned long *data;
@@ -191,4 +206,9 @@ public:
         data &= x.data;
         return *this;
     }
+
+    inline bool operator==(const FixedBitArray<SIZEX, SIZEY>&x) const
+    {
+        return data == x.data;
+    }
 };
@@ -0,0 +1,209 @@
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include "bitary.h"
+#include "coordit.h"
+#include "coordit_reference.h"
+#include "fixedarray.h"
+#include "format.h"
+#include "store.h"
+#include "stringutil.h"
+#include "tags.h"
+
+// Microbenchmarks of the building blocks most other code is made of. These
+// aren't in catch2-tests-executable: "make bench-core" builds them into
+// their own executable and runs them. Extra arguments for Catch2 go in
+// BENCH_CORE_ARGS, e.g. "--benchmark-samples 20" or the name of a single
+// benchmark.
+//
+// Each benchmark returns what it computed, so that the compiler can't drop
+// the work.
+
+TEST_CASE("Coordinate iterators", "[bench-core]")
+{
+    const coord_def centre(GXM / 2, GYM / 2);
+
+    BENCHMARK("rectangle_iterator over the map")
+    {
+        int sum = 0;
+        for (rectangle_iterator ri(0); ri; ++ri)
+            sum += ri->x;
+        return sum;
+    };
+
+    BENCHMARK("radius_iterator radius 8")
+    {
+        int sum = 0;
+        for (radius_iterator ri(centre, 8, C_SQUARE); ri; ++ri)
+            sum += ri->x;
+        return sum;
+    };
+
+    BENCHMARK("radius_iterator radius 8, round")
+    {
+        int sum = 0;
+        for (radius_iterator ri(centre, 8, C_ROUND); ri; ++ri)
+            sum += ri->x;
+        return sum;
+    };
+
+    // What radius_iterator did before it used offset tables.
+    BENCHMARK("reference radius 8, round")
+    {
+        int sum = 0;
+        reference_radius_visit(centre, 8, C_ROUND,
+                               [&sum](coord_def c) { sum += c.x; });
+        return sum;
+    };
+
+    BENCHMARK("distance_iterator radius 8")
+    {
+        int sum = 0;
+        for (distance_iterator di(centre, true, true, 8); di; ++di)
+            sum += di->x;
+        return sum;
+    };
+
+    BENCHMARK("adjacent_iterator")
+    {
+        int sum = 0;
+        for (adjacent_iterator ai(centre); ai; ++ai)
+            sum += ai->x;
+        return sum;
+    };
+}
+
+TEST_CASE("Fixed size containers", "[bench-core]")
+{
+    FixedArray<int, GXM, GYM> grid;
+    grid.init(1);
+
+    BENCHMARK("FixedArray access by coord_def")
+    {
+        int sum = 0;
+        for (rectangle_iterator ri(0); ri; ++ri)
+            sum += grid(*ri);
+        return sum;
+    };
+
+    BENCHMARK("FixedArray access by x and y")
+    {
+        int sum = 0;
+        for (int x = 0; x < GXM; ++x)
+            for (int y = 0; y < GYM; ++y)
+                sum += grid[x][y];
+        return sum;
+    };
+
+    const unsigned long bits = GXM * GYM;
+    bit_vector a(bits), b(bits);
+    for (unsigned long i = 0; i < bits; i += 3)
+        a.set(i);
+    for (unsigned long i = 0; i < bits; i += 5)
+        b.set(i);
+
+    BENCHMARK("bit_vector set and get")
+    {
+        bit_vector v(bits);
+        int count = 0;
+        for (unsigned long i = 0; i < bits; i += 7)
+            v.set(i);
+        for (unsigned long i = 0; i < bits; ++i)
+            count += v.get(i);
+        return count;
+    };
+
+    BENCHMARK("bit_vector or_and")
+    {
+        bit_vector v(bits);
+        v.or_and(a, b);
+        return v.get(15);
+    };
+}
+
+TEST_CASE("CrawlHashTable lookups", "[bench-core]")
+{
+    CrawlHashTable table;
+    vector<string> keys;
+    for (int i = 0; i < 64; ++i)
+    {
+        keys.push_back(make_stringf("property_%d", i));
+        table[keys.back()] = i;
+    }
+
+    BENCHMARK("exists, 64 keys")
+    {
+        int count = 0;
+        for (const string &key : keys)
+            count += table.exists(key);
+        return count;
+    };
+
+    BENCHMARK("get_int, 64 keys")
+    {
+        int sum = 0;
+        for (const string &key : keys)
+            sum += table[key].get_int();
+        return sum;
+    };
+}
+
+TEST_CASE("Marshalling primitives", "[bench-core]")
+{
+    BENCHMARK("marshallInt and unmarshallInt, 1000")
+    {
+        vector<unsigned char> buf;
+        writer w(&buf);
+        for (int i = 0; i < 1000; ++i)
+            marshallInt(w, i * 7919);
+        reader r(buf);
+        int sum = 0;
+        for (int i = 0; i < 1000; ++i)
+            sum += unmarshallInt(r);
+        return sum;
+    };
+
+    BENCHMARK("marshallUnsigned and unmarshallUnsigned, 1000")
+    {
+        vector<unsigned char> buf;
+        writer w(&buf);
+        for (uint64_t i = 0; i < 1000; ++i)
+            marshallUnsigned(w, i * 7919);
+        reader r(buf);
+        uint64_t sum = 0;
+        for (int i = 0; i < 1000; ++i)
+            sum += unmarshallUnsigned(r);
+        return sum;
+    };
+
+    BENCHMARK("marshallString and unmarshallString, 100")
+    {
+        vector<unsigned char> buf;
+        writer w(&buf);
+        for (int i = 0; i < 100; ++i)
+            marshallString(w, "the quick brown fox jumps over the lazy dog");
+        reader r(buf);
+        size_t len = 0;
+        for (int i = 0; i < 100; ++i)
+            len += unmarshallString(r).size();
+        return len;
+    };
+}
+
+TEST_CASE("formatted_string parsing", "[bench-core]")
+{
+    const string line = "<white>You hit the <red>orc warrior</red>"
+                        " with your <lightblue>+3 broad axe</lightblue>!"
+                        "</white> <yellow>(x2)</yellow>";
+
+    BENCHMARK("parse_string, one message line")
+    {
+        return formatted_string::parse_string(line).width();
+    };
+
+    BENCHMARK("parse_string and tostring, one message line")
+    {
+        return formatted_string::parse_string(line).tostring().size();
+    };
+}
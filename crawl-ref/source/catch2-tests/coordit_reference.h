@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+
+#include "coord-circle.h"
+#include "coord-def.h"
+#include "defines.h"
+
+using std::vector;
+
+// The cells radius_iterator used to visit, worked out the way it did before
+// it used offset tables: row by row with the costs of each step, checking
+// the bounds as it goes. The tests check that the iterator still visits
+// the same cells in the same order, and bench_core.cc compares the two.
+template<typename F>
+static inline void reference_radius_visit(coord_def center, int r,
+                                          circle_type ctype, F visit)
+{
+    int credit = r;
+    switch (ctype)
+    {
+    case C_CIRCLE: credit = r; break;
+    case C_POINTY: credit = r * r; break;
+    case C_ROUND:  credit = r * r + 1; break;
+    case C_SQUARE: credit = r; break;
+    }
+    const bool is_square = ctype == C_SQUARE;
+    const int base_cost = is_square ? 1 : -1;
+    const int inc_cost = is_square ? 0 : 2;
+
+    int y = 0, cost_y = base_cost, credit_y = credit;
+    do
+    {
+        int x = 0, cost_x = base_cost;
+        int credit_x = is_square ? credit : credit_y;
+        do
+        {
+            if (x + center.x < GXM)
+            {
+                if (y + center.y < GYM)
+                    visit(coord_def(center.x + x, center.y + y));
+                if (y && y <= center.y)
+                    visit(coord_def(center.x + x, center.y - y));
+            }
+            if (x && x <= center.x)
+            {
+                if (y + center.y < GYM)
+                    visit(coord_def(center.x - x, center.y + y));
+                if (y && y <= center.y)
+                    visit(coord_def(center.x - x, center.y - y));
+            }
+            x++;
+            credit_x -= (cost_x += inc_cost);
+        } while (credit_x >= 0);
+
+        y++;
+        credit_y -= (cost_y += inc_cost);
+    } while (credit_y >= 0);
+}
+
+static inline vector<coord_def> reference_radius_cells(coord_def center,
+                                                       int r,
+                                                       circle_type ctype,
+                                                       bool exclude_center)
+{
+    vector<coord_def> cells;
+    reference_radius_visit(center, r, ctype,
+                           [&cells](coord_def c) { cells.push_back(c); });
+    if (exclude_center)
+        cells.erase(cells.begin());
+    return cells;
+}
@@ -6,6 +6,7 @@
 #include "AppHdr.h"
 
 #include "coordit.h"
+#include "coordit_reference.h"
 
 TEST_CASE("rectangle_iterator", "[single-file]")
 {
@@ -205,3 +206,24 @@ TEST_CASE("distance_iterator", "[single-file]")
         REQUIRE(points == expected);
     }
 }
+
+TEST_CASE("radius_iterator", "[single-file]")
+{
+    SECTION("Visits the same cells in the same order as it always has")
+    {
+        const auto x = GENERATE(0, 1, 5, 40, GXM - 2, GXM - 1);
+        const auto y = GENERATE(0, 3, 35, GYM - 1);
+        const auto r = GENERATE(0, 1, 2, 7, 8, 30, 100);
+        const auto ctype = GENERATE(C_SQUARE, C_CIRCLE, C_POINTY, C_ROUND);
+        const auto exclude = GENERATE(false, true);
+        const coord_def where(x, y);
+
+        CAPTURE(x, y, r, ctype, exclude);
+
+        vector<coord_def> points;
+        for (radius_iterator ri(where, r, ctype, exclude); ri; ++ri)
+            points.push_back(*ri);
+
+        REQUIRE(points == reference_radius_cells(where, r, ctype, exclude));
+    }
+}
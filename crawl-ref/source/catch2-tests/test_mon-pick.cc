@@ -0,0 +1,47 @@
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include "branch.h"
+#include "mon-pick.h"
+#include "random.h"
+
+static bool _veto_nothing(monster_type)
+{
+    return false;
+}
+
+// Unvetoed picks take a precomputed table; they must still make the same
+// draw and find the same monster as a pick that walks the population, or
+// seeded dungeons would change.
+TEST_CASE("pick_monster without a vetoer matches the walking picker",
+          "[single-file]")
+{
+    for (branch_iterator it; it; ++it)
+    {
+        if (!branch_has_monsters(it->id))
+            continue;
+
+        for (int depth = 1; depth <= it->numlevels; ++depth)
+        {
+            const level_id place(it->id, depth);
+            for (int seed = 0; seed < 20; ++seed)
+            {
+                monster_type tabled, walked;
+                uint64_t after_tabled, after_walked;
+                {
+                    rng::subgenerator sub(seed, depth);
+                    tabled = pick_monster(place);
+                    after_tabled = rng::peek_uint64();
+                }
+                {
+                    rng::subgenerator sub(seed, depth);
+                    walked = pick_monster(place, _veto_nothing);
+                    after_walked = rng::peek_uint64();
+                }
+                REQUIRE(tabled == walked);
+                REQUIRE(after_tabled == after_walked);
+            }
+        }
+    }
+}
@@ -0,0 +1,187 @@
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include <cstdio>
+
+#include "package.h"
+
+static string _chunk_data(size_t len, int seed)
+{
+    // Mostly repetitive, like real level chunks, with some noise mixed in.
+    string data(len, 0);
+    for (size_t i = 0; i < len; i++)
+        data[i] = i % 7 ? 'a' + (i / 13 + seed) % 5 : (char)(i * 31 + seed);
+    return data;
+}
+
+static void _write_chunk(package &save, const string &name, const string &data)
+{
+    chunk_writer w(&save, name);
+    // write in odd-sized pieces so blocks don't line up with anything
+    for (size_t at = 0; at < data.size(); at += 777)
+        w.write(&data[at], min<size_t>(777, data.size() - at));
+}
+
+static string _read_chunk(package &save, const string &name)
+{
+    chunk_reader r(&save, name);
+    vector<char> buf;
+    r.read_all(buf);
+    return string(buf.begin(), buf.end());
+}
+
+TEST_CASE( "Package chunks survive a round trip", "[single-file]" ) {
+    const string filename = "test_package.tmp";
+    const vector<size_t> sizes = { 1, 100, 5000, 70000, 300000, 2000000 };
+
+    {
+        package save(filename.c_str(), true, true);
+        for (size_t i = 0; i < sizes.size(); i++)
+            _write_chunk(save, to_string(i), _chunk_data(sizes[i], i));
+        save.commit();
+        // rewrite every other chunk, so the file has reused and split blocks
+        for (size_t i = 0; i < sizes.size(); i += 2)
+            _write_chunk(save, to_string(i), _chunk_data(sizes[i] + 3, i + 10));
+    }
+
+    SECTION ("reading a read-only package") {
+        package save(filename.c_str(), false);
+        for (size_t i = 0; i < sizes.size(); i++)
+        {
+            const string expected = i % 2 ? _chunk_data(sizes[i], i)
+                                          : _chunk_data(sizes[i] + 3, i + 10);
+            REQUIRE(_read_chunk(save, to_string(i)) == expected);
+        }
+    }
+
+    SECTION ("reading while writing to a writeable package") {
+        package save(filename.c_str(), true);
+        chunk_reader *old = new chunk_reader(&save, "3");
+
+        _write_chunk(save, "new", _chunk_data(123456, 99));
+        REQUIRE(_read_chunk(save, "new") == _chunk_data(123456, 99));
+        REQUIRE(_read_chunk(save, "1") == _chunk_data(sizes[1], 1));
+        save.commit();
+        REQUIRE(_read_chunk(save, "new") == _chunk_data(123456, 99));
+
+        // a reader started before the writes still sees its own data
+        vector<char> buf;
+        old->read_all(buf);
+        delete old;
+        REQUIRE(string(buf.begin(), buf.end()) == _chunk_data(sizes[3], 3));
+
+        save.delete_chunk("new");
+    }
+
+    SECTION ("writers from package::writer()") {
+        {
+            package save(filename.c_str(), true);
+            // more chunks than there are compression threads
+            for (int i = 0; i < 10; i++)
+            {
+                chunk_writer *w = save.writer("w" + to_string(i));
+                const string data = _chunk_data(20000 + i * 1000, i);
+                w->write(data.data(), data.size());
+                delete w;
+            }
+            // the same chunk twice, the later one wins
+            chunk_writer *w = save.writer("1");
+            w->write("x", 1);
+            delete w;
+            w = save.writer("1");
+            w->write("yz", 2);
+            delete w;
+            REQUIRE(save.has_chunk("w9"));
+            REQUIRE(_read_chunk(save, "1") == "yz");
+
+            // unchanged rewrites may be skipped, but never lose data
+            for (const string data : { "yz", "yz", "x", "yz" })
+            {
+                w = save.writer("1");
+                w->write(data.data(), data.size());
+                delete w;
+            }
+            save.delete_chunk("w0");
+            w = save.writer("w0");
+            const string w0 = _chunk_data(20000, 0);
+            w->write(w0.data(), w0.size());
+            delete w;
+        }
+
+        package save(filename.c_str(), false);
+        REQUIRE(_read_chunk(save, "1") == "yz");
+        for (int i = 0; i < 10; i++)
+        {
+            REQUIRE(_read_chunk(save, "w" + to_string(i))
+                    == _chunk_data(20000 + i * 1000, i));
+        }
+    }
+
+    SECTION ("reading one chunk while others are still deflating") {
+        {
+            package save(filename.c_str(), true);
+            chunk_writer *w = save.writer("leaving");
+            const string leaving = _chunk_data(300000, 70);
+            w->write(leaving.data(), leaving.size());
+            delete w;
+            w = save.writer("2");
+            w->write("new", 3);
+            delete w;
+
+            // a chunk that isn't queued first, then the queued ones
+            REQUIRE(_read_chunk(save, "3") == _chunk_data(sizes[3], 3));
+            REQUIRE(_read_chunk(save, "2") == "new");
+            REQUIRE(_read_chunk(save, "leaving") == leaving);
+            save.commit();
+        }
+
+        package save(filename.c_str(), false);
+        REQUIRE(_read_chunk(save, "leaving") == _chunk_data(300000, 70));
+        REQUIRE(_read_chunk(save, "2") == "new");
+    }
+
+    SECTION ("background commits") {
+        {
+            package save(filename.c_str(), true);
+            _write_chunk(save, "1", _chunk_data(4000, 50));
+            save.commit(true);
+            // keep writing while the commit is in flight
+            _write_chunk(save, "2", _chunk_data(90000, 51));
+            _write_chunk(save, "1", _chunk_data(4001, 52));
+            save.commit(true);
+            _write_chunk(save, "3", _chunk_data(10, 53));
+            save.commit(true);
+        }
+
+        package save(filename.c_str(), false);
+        REQUIRE(_read_chunk(save, "1") == _chunk_data(4001, 52));
+        REQUIRE(_read_chunk(save, "2") == _chunk_data(90000, 51));
+        REQUIRE(_read_chunk(save, "3") == _chunk_data(10, 53));
+        REQUIRE(_read_chunk(save, "4") == _chunk_data(sizes[4] + 3, 14));
+    }
+
+    SECTION ("compacting a fragmented package") {
+        {
+            package save(filename.c_str(), true);
+            REQUIRE(save.get_slack() > 0);
+            REQUIRE_FALSE(save.compact(100));
+            REQUIRE(save.compact());
+            REQUIRE(save.get_slack() == 0);
+            REQUIRE(_read_chunk(save, "5") == _chunk_data(sizes[5], 5));
+            // still writeable afterwards
+            _write_chunk(save, "0", _chunk_data(50, 60));
+        }
+
+        package save(filename.c_str(), false);
+        REQUIRE(_read_chunk(save, "0") == _chunk_data(50, 60));
+        for (size_t i = 1; i < sizes.size(); i++)
+        {
+            const string expected = i % 2 ? _chunk_data(sizes[i], i)
+                                          : _chunk_data(sizes[i] + 3, i + 10);
+            REQUIRE(_read_chunk(save, to_string(i)) == expected);
+        }
+    }
+
+    remove(filename.c_str());
+}
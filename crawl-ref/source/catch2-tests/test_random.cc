@@ -0,0 +1,125 @@
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include <chrono>
+#include <cstdio>
+
+#include "random.h"
+
+// The dice functions draw from the generator directly rather than through
+// random2(); they must still make exactly the draws random2() would, or
+// seeded games would change.
+
+TEST_CASE("roll_dice makes the same draws as random2", "[single-file]")
+{
+    for (int size = 1; size <= 20; ++size)
+    {
+        int dice, expected = 0;
+        uint64_t after_dice, after_random2;
+        {
+            rng::subgenerator sub(1234, size);
+            dice = roll_dice(4, size);
+            after_dice = rng::peek_uint64();
+        }
+        {
+            rng::subgenerator sub(1234, size);
+            for (int i = 0; i < 4; ++i)
+                expected += 1 + random2(size);
+            after_random2 = rng::peek_uint64();
+        }
+        REQUIRE(dice == expected);
+        REQUIRE(after_dice == after_random2);
+    }
+}
+
+TEST_CASE("binomial makes the same draws as x_chance_in_y", "[single-file]")
+{
+    const int probs[] = { 0, 1, 50, 99, 100, 150 };
+    for (int prob : probs)
+    {
+        int count, expected = 0;
+        uint64_t after_binomial, after_chance;
+        {
+            rng::subgenerator sub(4321, prob);
+            count = binomial(30, prob);
+            after_binomial = rng::peek_uint64();
+        }
+        {
+            rng::subgenerator sub(4321, prob);
+            for (int i = 0; i < 30; ++i)
+                if (x_chance_in_y(prob, 100))
+                    expected++;
+            after_chance = rng::peek_uint64();
+        }
+        REQUIRE(count == expected);
+        REQUIRE(after_binomial == after_chance);
+    }
+}
+
+TEST_CASE("random2min, random2max and random2avg make the same draws",
+          "[single-file]")
+{
+    for (int max = 0; max <= 10; ++max)
+    {
+        int lo, hi, avg, exp_lo, exp_hi, exp_avg;
+        uint64_t after, expected_after;
+        {
+            rng::subgenerator sub(99, max);
+            lo = random2min(max, 3);
+            hi = random2max(max, 3);
+            avg = random2avg(max, 3);
+            after = rng::peek_uint64();
+        }
+        {
+            rng::subgenerator sub(99, max);
+            exp_lo = random2(max);
+            for (int i = 0; i < 2; ++i)
+                exp_lo = min(exp_lo, random2(max));
+            exp_hi = random2(max);
+            for (int i = 0; i < 2; ++i)
+                exp_hi = ::max(exp_hi, random2(max));
+            exp_avg = random2(max);
+            for (int i = 0; i < 2; ++i)
+                exp_avg += random2(max + 1);
+            exp_avg /= 3;
+            expected_after = rng::peek_uint64();
+        }
+        REQUIRE(lo == exp_lo);
+        REQUIRE(hi == exp_hi);
+        REQUIRE(avg == exp_avg);
+        REQUIRE(after == expected_after);
+    }
+}
+
+// Not a test: times the common draws. Hidden from the default run; use
+// "make bench-rng", which passes the [bench-rng] tag.
+
+typedef chrono::steady_clock bench_clock;
+
+template<typename F>
+static void _time_draws(const char *name, int calls, F draw)
+{
+    rng::subgenerator sub(1, 1);
+    int64_t sink = 0;
+    const auto start = bench_clock::now();
+    for (int i = 0; i < calls; ++i)
+        sink += draw();
+    const double ms = chrono::duration<double, milli>(bench_clock::now()
+                                                      - start).count();
+    printf("%-24s %8.2f ms %8.2f ns/call (%lld)\n", name, ms,
+           ms * 1e6 / calls, (long long) sink);
+}
+
+TEST_CASE("Time random number draws", "[.][bench-rng]")
+{
+    const int calls = 10000000;
+    _time_draws("random2(100)", calls, [] { return random2(100); });
+    _time_draws("roll_dice(3, 6)", calls / 3, [] { return roll_dice(3, 6); });
+    _time_draws("x_chance_in_y(1, 3)", calls,
+                [] { return x_chance_in_y(1, 3); });
+    _time_draws("binomial(20, 30)", calls / 20,
+                [] { return binomial(20, 30); });
+    _time_draws("random2avg(100, 3)", calls / 3,
+                [] { return random2avg(100, 3); });
+}
@@ -0,0 +1,112 @@
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include <chrono>
+#include <cstdio>
+
+#include "files.h"
+#include "package.h"
+
+// Not a test: times the save package code over a directory of real saves.
+// Hidden from the default run; use "make bench-saves", which passes the
+// [bench-saves] tag, with CRAWL_BENCH_SAVES pointing at a directory of .cs
+// files (default: bench-saves/).
+//
+// Unmarshalling "you" and level chunks needs a fully initialised game,
+// which the catch2 executable doesn't have, so chunks are timed at the
+// package level: inflating every chunk, writing it back out to a scratch
+// package and committing that.
+
+typedef chrono::steady_clock bench_clock;
+
+static double _ms_since(bench_clock::time_point start)
+{
+    return chrono::duration<double, milli>(bench_clock::now() - start).count();
+}
+
+// Levels are named after their place ("D:3", "Lair:1", ...); lump them
+// together. Everything else is reported under its own chunk name.
+static string _chunk_kind(const string &name)
+{
+    return name.find(':') != string::npos ? "<levels>" : name;
+}
+
+struct bench_totals
+{
+    int count = 0;
+    uint64_t raw = 0;
+    uint64_t packed = 0;
+    double read_ms = 0;
+    double write_ms = 0;
+};
+
+TEST_CASE( "Save package benchmark", "[.][bench-saves]" ) {
+    const char *env_dir = getenv("CRAWL_BENCH_SAVES");
+    const string dir = env_dir ? env_dir : "bench-saves";
+    const string scratch = "bench-saves.tmp";
+
+    vector<string> saves = get_dir_files_ext(dir, SAVE_SUFFIX);
+    if (saves.empty())
+    {
+        WARN("no " SAVE_SUFFIX " files in " << dir);
+        return;
+    }
+
+    map<string, bench_totals> totals;
+    double open_ms = 0, commit_ms = 0;
+    uint64_t file_bytes = 0;
+
+    for (const string &file : saves)
+    {
+        const string path = catpath(dir, file);
+
+        auto start = bench_clock::now();
+        package save(path.c_str(), false);
+        open_ms += _ms_since(start);
+        file_bytes += save.get_size();
+
+        package copy(scratch.c_str(), true, true);
+        for (const string &name : save.list_chunks())
+        {
+            bench_totals &t = totals[_chunk_kind(name)];
+            vector<char> buf;
+
+            start = bench_clock::now();
+            {
+                chunk_reader in(&save, name);
+                in.read_all(buf);
+            }
+            t.read_ms += _ms_since(start);
+
+            start = bench_clock::now();
+            {
+                chunk_writer out(&copy, name);
+                out.write(buf.data(), buf.size());
+            }
+            t.write_ms += _ms_since(start);
+
+            t.count++;
+            t.raw += buf.size();
+            t.packed += save.get_chunk_compressed_length(name);
+        }
+
+        start = bench_clock::now();
+        copy.commit();
+        commit_ms += _ms_since(start);
+    }
+    remove(scratch.c_str());
+
+    printf("%u saves, %.1f KiB: open %.2f ms, commit %.2f ms\n",
+           (unsigned int)saves.size(), file_bytes / 1024.0, open_ms,
+           commit_ms);
+    printf("%-14s %6s %12s %12s %10s %10s\n", "chunk", "count", "bytes",
+           "compressed", "read ms", "write ms");
+    for (const auto &entry : totals)
+    {
+        const bench_totals &t = entry.second;
+        printf("%-14s %6d %12llu %12llu %10.2f %10.2f\n", entry.first.c_str(),
+               t.count, (unsigned long long)t.raw,
+               (unsigned long long)t.packed, t.read_ms, t.write_ms);
+    }
+}
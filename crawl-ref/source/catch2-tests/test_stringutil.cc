@@ -114,3 +114,38 @@ TEST_CASE( "uppercase and lowercase", "[single-file]")
         CHECK(&result2 == &s1);
     }
 }
+
+TEST_CASE( "lowercase with non-ascii text", "[single-file]")
+{
+    // Caseless, so that this doesn't depend on the locale.
+    CHECK(lowercase_string("SNOW☃MAN") == "snow☃man");
+    string s = "MIXED → Case";
+    CHECK(lowercase(s) == "mixed → case");
+    CHECK(s == "mixed → case");
+}
+
+TEST_CASE( "replace_all", "[single-file]")
+{
+    CHECK(replace_all("a-b-c", "-", "--") == "a--b--c");
+    CHECK(replace_all("aaaa", "aa", "a") == "aa");
+    CHECK(replace_all("abc", "x", "y") == "abc");
+    CHECK(replace_all("xabcx", "x", "") == "abc");
+}
+
+TEST_CASE( "split_string", "[single-file]")
+{
+    const vector<string> trimmed = { "a", "b", "c" };
+    CHECK(split_string(",", " a , b,,c ") == trimmed);
+
+    const vector<string> empties = { "a", "", "b" };
+    CHECK(split_string(",", "a,,b", false, true) == empties);
+
+    const vector<string> limited = { "a", "b,c" };
+    CHECK(split_string(",", "a,b,c", true, false, 1) == limited);
+
+    const vector<string> long_sep = { "a", "b" };
+    CHECK(split_string("::", "a::b", false) == long_sep);
+
+    const vector<string> escaped = { "a,b", "c" };
+    CHECK(split_string(",", "a\\,b,c", true, false, -1, true) == escaped);
+}
@@ -0,0 +1,48 @@
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include <vector>
+
+#include "tasks.h"
+
+TEST_CASE( "Background tasks all run, and wait() sees their work", "[single-file]" ) {
+    const int ntasks = 20;
+    vector<int> results(ntasks, 0);
+    vector<task_ticket> tickets;
+
+    for (int i = 0; i < ntasks; i++)
+    {
+        int *result = &results[i];
+        tickets.push_back(task_start([result, i] { *result = i * i; },
+                                     "test"));
+    }
+    for (task_ticket &ticket : tickets)
+    {
+        ticket.wait();
+        REQUIRE(ticket.done());
+    }
+    for (int i = 0; i < ntasks; i++)
+        REQUIRE(results[i] == i * i);
+}
+
+TEST_CASE( "Task futures return their results", "[single-file]" ) {
+    task_future<string> future =
+        task_async<string>([] { return string("levelgen"); }, "test");
+    REQUIRE(future.get() == "levelgen");
+    REQUIRE(future.done());
+}
+
+TEST_CASE( "Idle tasks run in order until they're done", "[single-file]" ) {
+    string log;
+    int steps_left = 3;
+    idle_task_add([&] { log += 'a'; return --steps_left > 0; }, "test");
+    idle_task_add([&] { log += 'b'; return false; }, "test");
+
+    // One step at least, however little time there is.
+    idle_tasks_run(0);
+    REQUIRE(log == "a");
+    while (idle_tasks_pending())
+        idle_tasks_run(0);
+    REQUIRE(log == "aaab");
+}
@@ -96,3 +96,77 @@ TEST_CASE( "Test scissor stack", "[single-file]" ) {
     }
 #endif
 }
+
+namespace
+{
+    // Counts how often its size is actually worked out.
+    class CountingWidget : public ui::Widget
+    {
+    public:
+        int horz_calls = 0, vert_calls = 0;
+
+        void invalidate() { _invalidate_sizereq(false); }
+
+    protected:
+        void _render() override { }
+
+        ui::SizeReq _get_preferred_size(Direction dim, int prosp_width) override
+        {
+            if (dim)
+            {
+                vert_calls++;
+                return { 1, 100 / max(prosp_width, 1) };
+            }
+            horz_calls++;
+            return { 1, 10 };
+        }
+    };
+}
+
+TEST_CASE( "Test widget size request caching", "[single-file]" ) {
+
+    SECTION ("Test that repeated requests are cached") {
+        CountingWidget w;
+
+        w.get_preferred_size(ui::Widget::HORZ, -1);
+        w.get_preferred_size(ui::Widget::HORZ, -1);
+        w.get_preferred_size(ui::Widget::VERT, 10);
+        w.get_preferred_size(ui::Widget::VERT, 10);
+        REQUIRE(w.horz_calls == 1);
+        REQUIRE(w.vert_calls == 1);
+    }
+
+    SECTION ("Test that heights are cached at more than one width") {
+        CountingWidget w;
+
+        const auto at_10 = w.get_preferred_size(ui::Widget::VERT, 10);
+        const auto at_20 = w.get_preferred_size(ui::Widget::VERT, 20);
+        REQUIRE(w.get_preferred_size(ui::Widget::VERT, 10).nat == at_10.nat);
+        REQUIRE(w.get_preferred_size(ui::Widget::VERT, 20).nat == at_20.nat);
+        REQUIRE(w.vert_calls == 2);
+        REQUIRE(at_10.nat == 10);
+        REQUIRE(at_20.nat == 5);
+    }
+
+    SECTION ("Test that heights are cached for widgets with margins") {
+        CountingWidget w;
+        w.set_margin_for_crt(1);
+        w.set_margin_for_sdl(1);
+
+        w.get_preferred_size(ui::Widget::VERT, 12);
+        w.get_preferred_size(ui::Widget::VERT, 12);
+        REQUIRE(w.vert_calls == 1);
+    }
+
+    SECTION ("Test that invalidation discards cached requests") {
+        CountingWidget w;
+
+        w.get_preferred_size(ui::Widget::HORZ, -1);
+        w.get_preferred_size(ui::Widget::VERT, 10);
+        w.invalidate();
+        w.get_preferred_size(ui::Widget::HORZ, -1);
+        w.get_preferred_size(ui::Widget::VERT, 10);
+        REQUIRE(w.horz_calls == 2);
+        REQUIRE(w.vert_calls == 2);
+    }
+}
@@ -22,6 +22,7 @@
 #include "artefact.h"
 #include "art-enum.h"
 #include "branch.h"
+#include "clua.h"
 #include "describe.h"
 #include "dgn-overview.h"
 #include "dungeon.h"
@@ -88,6 +89,7 @@ static void _sdump_monster_list(dump_params &);
 static void _sdump_vault_list(dump_params &);
 static void _sdump_skill_gains(dump_params &);
 static void _sdump_action_counts(dump_params &);
+static void _sdump_travel_stats(dump_params &);
 static void _sdump_separator(dump_params &);
 static void _sdump_lua(dump_params &);
 static bool _write_dump(const string &fname, const dump_params &,
@@ -110,11 +112,60 @@ struct dump_params
                 const scorefile_entry *s = nullptr)
         : section(sec), full_id(id), se(s)
     {
-        // Start with enough room for 100 80 character lines.
-        text.reserve(100 * 80);
+        // Start with enough room for 100 80 character lines, or for the
+        // last dump.
+        text.reserve(max<size_t>(100 * 80, last_size));
     }
+
+    static size_t last_size;
+};
+
+size_t dump_params::last_size = 0;
+
+// A section that only changes along with some counters, kept from one dump
+// to the next: webtiles servers make a dump on every save, and the notes
+// and kills of a long game are the bulk of it.
+class cached_dump_section
+{
+public:
+    // Add the text kept for key, if there is any; otherwise get ready to
+    // keep what the caller adds.
+    bool reuse(dump_params &par, const string &key)
+    {
+        if (m_valid && key == m_key)
+        {
+            par.text += m_text;
+            return true;
+        }
+        m_valid = false;
+        m_key = key;
+        m_start = par.text.size();
+        return false;
+    }
+
+    void keep(const dump_params &par)
+    {
+        m_text = par.text.substr(m_start);
+        m_valid = true;
+    }
+
+private:
+    bool m_valid = false;
+    string m_key;
+    string m_text;
+    size_t m_start = 0;
 };
 
+// The key of a section made from the notes, which skill levels and options
+// decide whether to show.
+static string _notes_section_key()
+{
+    string key = make_stringf("%" PRId64 ":%u:%u", (int64_t) you.birth_time,
+                              notes_generation(), options_generation());
+    key.append(you.skills.begin(), you.skills.end());
+    return key;
+}
+
 static dump_section_handler dump_handlers[] =
 {
     { "header",         _sdump_header        },
@@ -144,6 +195,7 @@ static dump_section_handler dump_handlers[] =
     { "spell_usage",    _sdump_action_counts }, // compat
     { "action_counts",  _sdump_action_counts },
     { "skill_gains",    _sdump_skill_gains   },
+    { "travel_stats",   _sdump_travel_stats  },
 
     // Conveniences for the .crawlrc artist.
     { "",               _sdump_newline       },
@@ -175,6 +227,7 @@ static dump_params _get_dump(bool full_id = false,
         par.section = section;
         dump_section(par);
     }
+    dump_params::last_size = par.text.size();
 
     // Hopefully we get RVO so we don't have to copy the text.
     return par;
@@ -625,9 +678,14 @@ static void _sdump_screenshot(dump_params &par)
 static void _sdump_screenshots(dump_params &par)
 {
     string &text(par.text);
+    ensure_notes_loaded();
     if (note_list.empty())
         return;
 
+    static cached_dump_section cache;
+    if (cache.reuse(par, _notes_section_key()))
+        return;
+
     text += "Illustrated notes\n\n";
 
     for (const Note &note : note_list)
@@ -642,14 +700,20 @@ static void _sdump_screenshots(dump_params &par)
         text += note.name;
         text += "\n\n";
     }
+    cache.keep(par);
 }
 
 static void _sdump_notes(dump_params &par)
 {
     string &text(par.text);
+    ensure_notes_loaded();
     if (note_list.empty())
         return;
 
+    static cached_dump_section cache;
+    if (cache.reuse(par, _notes_section_key()))
+        return;
+
     text += "Notes\n";
     text += "Turn   | Place    | Note\n";
     text += "-------+----------+-------------------------------------------\n";
@@ -676,6 +740,7 @@ static void _sdump_notes(dump_params &par)
             text += string(prefix.length()-2, ' ') + string("| ") + parts[j] + "\n";
     }
     text += "\n";
+    cache.keep(par);
 }
 
 static void _sdump_location(dump_params &par)
@@ -1023,8 +1088,19 @@ static void _sdump_spells(dump_params &par)
 
 static void _sdump_kills(dump_params &par)
 {
+    // The kill list goes through Lua (c_kill_list) as well as the options.
+    static cached_dump_section cache;
+    if (cache.reuse(par, make_stringf("%" PRId64 ":%u:%u:%u",
+                                      (int64_t) you.birth_time,
+                                      kills_generation(),
+                                      options_generation(),
+                                      clua.globals_generation)))
+    {
+        return;
+    }
     par.text += you.kills.kill_info();
     par.text += "\n";
+    cache.keep(par);
 }
 
 static string _sdump_kills_place_info(const PlaceInfo place_info, string name = "")
@@ -1151,6 +1227,13 @@ static void _sdump_vault_list(dump_params &par)
     }
 }
 
+static void _sdump_travel_stats(dump_params &par)
+{
+    par.text += "Travel and explore profiling, this session:\n";
+    par.text += travel_stats_description();
+    par.text += "\n";
+}
+
 static bool _sort_by_first(pair<int, FixedVector<int, 28> > a,
                            pair<int, FixedVector<int, 28> > b)
 {
@@ -1459,6 +1542,7 @@ static void _sdump_skill_gains(dump_params &par)
     vector<skill_type> skill_order;
     int xl = 0;
     int max_xl = 0;
+    ensure_notes_loaded();
     for (const Note &note : note_list)
     {
         if (note.type == NOTE_XP_LEVEL_CHANGE)
@@ -1713,6 +1797,7 @@ void display_notes()
     const string tag = "notes";
     scr.set_tag(tag);
     _add_text(scr, tag, "Turn   | Place    | Note\n");
+    ensure_notes_loaded();
     for (const Note &note : note_list)
     {
         if (note.hidden())
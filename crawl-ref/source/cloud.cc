@@ -22,6 +22,7 @@
 #include "level-state-type.h"
 #include "libutil.h" // testbits
 #include "los.h"
+#include "losglobal.h"
 #include "mapmark.h"
 #include "map-knowledge.h"
 #include "melee-attack.h"
@@ -43,7 +44,7 @@
 
 cloud_struct* cloud_at(coord_def pos)
 {
-    return map_find(env.cloud, pos);
+    return env.cloud.get(pos);
 }
 
 /// damage = base + random2avg(random, random/15 + 1)
@@ -595,10 +596,15 @@ void manage_clouds()
 {
     // We can't iterate over env.cloud directly because _dissipate_cloud
     // will remove this cloud and invalidate our iterator.
-    vector<cloud_struct *> cloud_ptrs;
+    static vector<cloud_struct *> cloud_ptrs;
+    cloud_ptrs.clear();
     for (auto& entry : env.cloud)
         cloud_ptrs.push_back(&entry.second);
 
+    // Spreading and fading clouds change opacity square by square, mostly
+    // next to each other.
+    los_invalidation_batch los_batch;
+
     for (auto ptr : cloud_ptrs)
     {
         cloud_struct& cloud = *ptr;
@@ -669,6 +675,7 @@ void delete_all_clouds()
     for (auto& entry : env.cloud)
         cloud_locs.push_back(entry.first);
 
+    los_invalidation_batch los_batch;
     for (auto pos : cloud_locs)
         delete_cloud(pos);
 }
@@ -1806,6 +1813,7 @@ void run_cloud_spreaders(int dur)
     if (!dur)
         return;
 
+    los_invalidation_batch los_batch;
     for (map_marker *marker : env.markers.get_all(MAT_CLOUD_SPREADER))
     {
         map_cloud_spreader_marker * const mark
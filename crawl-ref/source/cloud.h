@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include "coord-grid.h"
+
 struct cloud_struct
 {
     coord_def     pos;
@@ -39,6 +41,9 @@ struct cloud_struct
     static killer_type   whose_to_killer(kill_category whose);
 };
 
+// The clouds on a level, by position.
+typedef coord_grid<cloud_struct> cloud_grid;
+
 enum cloud_tile_variation
 {
     CTVARY_NONE,     ///< fixed tile (or special case)
@@ -3,6 +3,7 @@
 #include "clua.h"
 
 #include <algorithm>
+#include <chrono>
 
 #include "cluautil.h"
 #include "dlua.h"
@@ -43,10 +44,12 @@ CLua::CLua(bool managed)
     : error(), managed_vm(managed), shutting_down(false),
       throttle_unit_lines(50000),
       throttle_sleep_ms(0), throttle_sleep_start(2),
-      throttle_sleep_end(800), n_throttle_sleeps(0), mixed_call_depth(0),
+      throttle_sleep_end(800), n_throttle_sleeps(0), throttle_grace_ms(250),
+      mixed_call_depth(0),
       lua_call_depth(0), max_mixed_call_depth(8),
-      max_lua_call_depth(100), memory_used(0),
-      _state(nullptr), sourced_files(), uniqindex(0)
+      max_lua_call_depth(100), memory_used(0), globals_generation(0),
+      _state(nullptr), sourced_files(), uniqindex(0),
+      gc_pause_set(-1), gc_stepmul_set(-1)
 {
 }
 
@@ -113,6 +116,63 @@ void CLua::getregistry(const char *name)
 void CLua::gc()
 {
     lua_gc(state(), LUA_GCCOLLECT, 0);
+    ++gc_info.full_collections;
+}
+
+// Lua's own defaults for setpause and setstepmul.
+static const int LUA_DEFAULT_GC_PAUSE = 200;
+static const int LUA_DEFAULT_GC_STEPMUL = 200;
+
+/**
+ * Collect garbage while the game waits for a key, so that less of it is
+ * left for the collector's steps while scripts run: a bot allocating heavily
+ * in ready() otherwise pays for it all inside its own calls. This is also
+ * where the lua_gc_* options are applied, and where a VM getting close to
+ * lua_max_memory is collected in full, so that it's real use and not
+ * garbage that makes a script run out.
+ */
+void CLua::gc_idle()
+{
+    if (!_state)
+        return;
+
+    const int pause = Options.lua_gc_pause ? Options.lua_gc_pause
+                                           : LUA_DEFAULT_GC_PAUSE;
+    if (pause != gc_pause_set)
+        lua_gc(_state, LUA_GCSETPAUSE, gc_pause_set = pause);
+    const int stepmul = Options.lua_gc_step_multiplier
+                        ? Options.lua_gc_step_multiplier
+                        : LUA_DEFAULT_GC_STEPMUL;
+    if (stepmul != gc_stepmul_set)
+        lua_gc(_state, LUA_GCSETSTEPMUL, gc_stepmul_set = stepmul);
+
+    const auto start = chrono::steady_clock::now();
+    const auto elapsed_ms = [&start]() {
+        return chrono::duration<double, milli>(chrono::steady_clock::now()
+                                               - start).count();
+    };
+
+    const uint64_t used_kb = lua_gc(_state, LUA_GCCOUNT, 0);
+    if (managed_vm && used_kb * 4 >= crawl_state.clua_max_memory_mb * 1024 * 3)
+        gc();
+    else if (Options.lua_gc_idle_time)
+    {
+        do
+        {
+            if (lua_gc(_state, LUA_GCSTEP, 0))
+            {
+                ++gc_info.idle_cycles;
+                break;
+            }
+        }
+        while (elapsed_ms() < Options.lua_gc_idle_time);
+    }
+    else
+        return;
+
+    const double ms = elapsed_ms();
+    gc_info.idle_ms += ms;
+    gc_info.longest_ms = max(gc_info.longest_ms, ms);
 }
 
 void CLua::save(writer &outf)
@@ -216,6 +276,11 @@ void CLua::set_error(int err, lua_State *ls)
     const char *serr = lua_tostring(ls, -1);
     lua_pop(ls, 1);
     error = serr? serr : "<Unknown error>";
+    if (err == LUA_ERRMEM && managed_vm)
+    {
+        error += make_stringf(" (the limit is lua_max_memory = %d MB)",
+                              (int) crawl_state.clua_max_memory_mb);
+    }
 }
 
 void CLua::init_throttle()
@@ -241,6 +306,7 @@ void CLua::init_throttle()
                     LUA_MASKCOUNT, throttle_unit_lines);
         throttle_sleep_ms = 0;
         n_throttle_sleeps = 0;
+        throttle_start = chrono::steady_clock::now();
         crawl_state.lua_script_killed = false;
     }
 }
@@ -267,6 +333,9 @@ int CLua::execstring(const char *s, const char *context, int nresults)
     lua_call_throttle strangler(this);
     err = lua_pcall(ls, 0, nresults, 0);
     set_error(err, ls);
+    // A script that sets its own metatable on the globals would hide new
+    // globals from lua_hook; at least look again after each one.
+    ++globals_generation;
     return err;
 }
 
@@ -327,6 +396,7 @@ int CLua::execfile(const char *filename, bool trusted, bool die_on_fail,
     if (!err)
         sourced_files.insert(filename);
     set_error(err);
+    ++globals_generation;
     if (die_on_fail && !error.empty())
     {
         end(1, false, "Lua execfile error (%s): %s",
@@ -622,6 +692,13 @@ bool CLua::proc_returns(const char *par) const
 //
 void CLua::pushglobal(const string &name)
 {
+    // Most names are plain globals, and this is on the path of every hook.
+    if (name.find('.') == string::npos)
+    {
+        lua_getglobal(state(), name.c_str());
+        return;
+    }
+
     vector<string> pieces = split_string(".", name);
     lua_State *ls(state());
 
@@ -712,6 +789,15 @@ bool CLua::callfn(const char *fn, int nargs, int nret)
     return !err;
 }
 
+// __newindex for the globals table: t[k] = v for a k that isn't there yet.
+static int _clua_new_global(lua_State *ls)
+{
+    lua_settop(ls, 3);
+    lua_rawset(ls, 1);
+    ++CLua::get_vm(ls).globals_generation;
+    return 0;
+}
+
 void CLua::init_lua()
 {
     if (_state)
@@ -735,6 +821,7 @@ void CLua::init_lua()
     lua_stack_cleaner clean(_state);
 
     lua_atpanic(_state, _clua_panic);
+    gc_pause_set = gc_stepmul_set = -1;
 
 #ifdef CLUA_UNRESTRICTED_LIBS
     // open all libs -- this is not safe for public servers or releases!
@@ -779,6 +866,93 @@ void CLua::init_lua()
 
     lua_pushlightuserdata(_state, this);
     setregistry("__clua");
+
+    // Count the globals defined from now on, for lua_hook.
+    lua_newtable(_state);
+    lua_pushcfunction(_state, _clua_new_global);
+    lua_setfield(_state, -2, "__newindex");
+    lua_setmetatable(_state, LUA_GLOBALSINDEX);
+    ++globals_generation;
+}
+
+bool lua_hook::push(CLua &vm)
+{
+    vm.error.clear();
+    lua_State *ls = vm.state();
+    if (!ls || m_missing && m_generation == vm.globals_generation)
+        return false;
+
+    lua_getglobal(ls, m_name);
+    if (lua_isfunction(ls, -1))
+    {
+        m_missing = false;
+        return true;
+    }
+
+    // Only a nil can turn into a function by way of a new global; anything
+    // else has to be looked at every time.
+    m_missing = lua_isnil(ls, -1);
+    m_generation = vm.globals_generation;
+    lua_pop(ls, 1);
+    return false;
+}
+
+bool lua_hook::defined(CLua &vm)
+{
+    if (!push(vm))
+        return false;
+    lua_pop(vm.state(), 1);
+    return true;
+}
+
+void clua_push_hook_arg(lua_State *ls, const char *s)
+{
+    if (s)
+        lua_pushstring(ls, s);
+    else
+        lua_pushnil(ls);
+}
+
+void clua_push_hook_arg(lua_State *ls, const string &s)
+{
+    lua_pushlstring(ls, s.data(), s.length());
+}
+
+void clua_push_hook_arg(lua_State *ls, int n)
+{
+    lua_pushnumber(ls, n);
+}
+
+void clua_push_hook_arg(lua_State *ls, bool b)
+{
+    lua_pushboolean(ls, b);
+}
+
+void clua_push_hook_arg(lua_State *ls, const item_def *item)
+{
+    clua_push_item(ls, const_cast<item_def *>(item));
+}
+
+void clua_push_hook_arg(lua_State *ls, monster_info *mi)
+{
+    lua_push_moninf(ls, mi);
+}
+
+void clua_get_hook_result(lua_State *ls, bool &result)
+{
+    result = lua_toboolean(ls, -1);
+}
+
+void clua_get_hook_result(lua_State *ls, int &result)
+{
+    if (lua_isnumber(ls, -1))
+        result = luaL_safe_checkint(ls, -1);
+}
+
+void clua_get_hook_result(lua_State *ls, string &result)
+{
+    if (const char *s = lua_tostring(ls, -1))
+        result = s;
 }
 
 static int lua_loadstring(lua_State *ls)
@@ -1107,6 +1281,7 @@ static void *_clua_allocator(void *ud, void *ptr, size_t osize, size_t nsize)
             * 1024 * 1024
         && cl->mixed_call_depth)
     {
+        ++cl->gc_info.refused_allocations;
         return nullptr;
     }
 
@@ -1136,12 +1311,23 @@ static void _clua_throttle_hook(lua_State *ls, lua_Debug *dbg)
 
     if (lua)
     {
+        ++lua->throttle_info.checks;
+
+        // Scripts that finish within the grace period run at full speed;
+        // only the ones that keep going are slowed down and then stopped.
+        if (chrono::steady_clock::now() - lua->throttle_start
+            < chrono::milliseconds(lua->throttle_grace_ms))
+        {
+            return;
+        }
+
         if (!lua->throttle_sleep_ms)
             lua->throttle_sleep_ms = lua->throttle_sleep_start;
         else if (lua->throttle_sleep_ms < lua->throttle_sleep_end)
             lua->throttle_sleep_ms *= 2;
 
         ++lua->n_throttle_sleeps;
+        ++lua->throttle_info.sleeps;
 
         delay(lua->throttle_sleep_ms);
 
@@ -1149,6 +1335,7 @@ static void _clua_throttle_hook(lua_State *ls, lua_Debug *dbg)
         if (lua->n_throttle_sleeps > CLua::MAX_THROTTLE_SLEEPS)
         {
             lua->n_throttle_sleeps = CLua::MAX_THROTTLE_SLEEPS;
+            ++lua->throttle_info.kills;
             crawl_state.lua_script_killed = true;
             luaL_error(ls, BUGGY_SCRIPT_ERROR);
         }
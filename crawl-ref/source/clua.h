@@ -6,6 +6,7 @@ extern "C" {
 #include <lualib.h>
 }
 
+#include <chrono>
 #include <cstdarg>
 #include <cstdio>
 #include <map>
@@ -105,6 +106,7 @@ public:
     void save_persist();
     void load_persist();
     void gc();
+    void gc_idle();
 
     void setglobal(const char *name);
     void getglobal(const char *name);
@@ -161,6 +163,10 @@ public:
     int throttle_sleep_ms;
     int throttle_sleep_start, throttle_sleep_end;
     int n_throttle_sleeps;
+    // How long a call may run before the throttle starts to slow it down,
+    // and when the current outermost call started.
+    int throttle_grace_ms;
+    std::chrono::steady_clock::time_point throttle_start;
     int mixed_call_depth;
     int lua_call_depth;
     int max_mixed_call_depth;
@@ -168,6 +174,30 @@ public:
 
     long memory_used;
 
+    // Bumped whenever a new global is defined; see lua_hook.
+    unsigned int globals_generation;
+
+    // What the garbage collector has been up to, for debug.lua_gc_stats().
+    struct gc_stats
+    {
+        unsigned int idle_cycles = 0;  // collections finished by gc_idle()
+        unsigned int full_collections = 0;
+        unsigned int refused_allocations = 0;
+        double idle_ms = 0;            // time spent in gc_idle()
+        double longest_ms = 0;         // the longest single gc_idle()
+    };
+    gc_stats gc_info;
+
+    // How often the throttle has had to step in, for
+    // debug.lua_throttle_stats().
+    struct throttle_stats
+    {
+        unsigned int checks = 0;       // times the count hook ran
+        unsigned int sleeps = 0;       // times it slowed a script down
+        unsigned int kills = 0;        // scripts stopped as runaways
+    };
+    throttle_stats throttle_info;
+
     static const int MAX_THROTTLE_SLEEPS = 15;
 
 private:
@@ -176,6 +206,9 @@ private:
     sfset sourced_files;
     unsigned int uniqindex;
 
+    // The collector tuning options last applied, or -1.
+    int gc_pause_set, gc_stepmul_set;
+
     vector<lua_shutdown_listener*> shutdown_listeners;
 
 private:
@@ -239,6 +272,92 @@ private:
     static string new_fn_name();
 };
 
+struct item_def;
+struct monster_info;
+
+// The arguments lua_hook::call() knows how to push.
+void clua_push_hook_arg(lua_State *ls, const char *s);
+void clua_push_hook_arg(lua_State *ls, const string &s);
+void clua_push_hook_arg(lua_State *ls, int n);
+void clua_push_hook_arg(lua_State *ls, bool b);
+void clua_push_hook_arg(lua_State *ls, const item_def *item);
+void clua_push_hook_arg(lua_State *ls, monster_info *mi);
+// And the results lua_hook::call_returning() can take; a result of the wrong
+// type leaves @p result alone.
+void clua_get_hook_result(lua_State *ls, bool &result);
+void clua_get_hook_result(lua_State *ls, int &result);
+void clua_get_hook_result(lua_State *ls, string &result);
+
+// A global function that the game calls often, by name: c_message for every
+// message, ready() before every command, and so on. Most of them are never
+// defined, so when the hook finds no function it remembers that, and skips
+// the lookup and the call until some new global is defined. Arguments are
+// pushed by type, rather than by parsing a format string.
+//
+// The function itself is looked up on every call, since a script can
+// replace it at any time.
+class lua_hook
+{
+public:
+    explicit lua_hook(const char *name)
+        : m_name(name), m_missing(false), m_generation(0)
+    {
+    }
+
+    // Pushes the function and returns true, or pushes nothing and returns
+    // false if there isn't one.
+    bool push(CLua &vm);
+
+    // Whether there is a function to call, for callers that would otherwise
+    // have to build costly arguments for nothing.
+    bool defined(CLua &vm);
+
+    // Calls the hook. On success, the caller finds @p nret results on the
+    // stack, and is responsible for them.
+    template<typename... Args>
+    bool call(CLua &vm, int nret, Args... args)
+    {
+        if (!push(vm))
+            return false;
+        using expand = int[];
+        (void) expand { 0, (clua_push_hook_arg(vm.state(), args), 0)... };
+        return vm.callfn(nullptr, sizeof...(args), nret);
+    }
+
+    // Calls the hook for a single result, stored in @p result.
+    template<typename R, typename... Args>
+    bool call_returning(CLua &vm, R &result, Args... args)
+    {
+        lua_State *ls = vm.state();
+        if (!ls)
+            return false;
+        lua_stack_cleaner clean(ls);
+        if (!call(vm, 1, args...))
+            return false;
+        clua_get_hook_result(ls, result);
+        return true;
+    }
+
+    // Calls the hook for a single boolean result, or maybe if there is no
+    // hook, it failed, or it returned something else.
+    template<typename... Args>
+    maybe_bool callmaybe(CLua &vm, Args... args)
+    {
+        lua_State *ls = vm.state();
+        if (!ls)
+            return maybe_bool::maybe;
+        lua_stack_cleaner clean(ls);
+        if (!call(vm, 1, args...) || !lua_isboolean(ls, -1))
+            return maybe_bool::maybe;
+        return lua_toboolean(ls, -1);
+    }
+
+private:
+    const char *m_name;
+    bool m_missing;
+    unsigned int m_generation;
+};
+
 // Defined in main.cc
 #ifdef DEBUG_GLOBALS
 #define clua (*real_clua)
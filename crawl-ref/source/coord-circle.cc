@@ -97,6 +97,11 @@ const coord_def& circle_def::get_center() const
     return origin;
 }
 
+int circle_def::get_radius() const
+{
+    return global_los_radius ? get_los_radius() : radius;
+}
+
 bool circle_def::contains(const coord_def &p) const
 {
     if (!bbox.contains(p))
@@ -62,6 +62,8 @@ public:
     bool contains(const coord_def &p) const PURE;
     const rect_def& get_bbox() const PURE;
     const coord_def& get_center() const PURE;
+    // No contained point is further than this from the centre in rdist.
+    int get_radius() const PURE;
 
 private:
     void init(int param, circle_type ctype);
@@ -0,0 +1,147 @@
+/**
+ * @file
+ * @brief A container for things with at most one per square of the map.
+**/
+
+#pragma once
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "coord.h"
+#include "fixedarray.h"
+
+using std::deque;
+using std::pair;
+using std::vector;
+
+// Things on a level by position, such as its clouds, traps and shops. As far
+// as its users go it behaves like a map<coord_def, T>, down to iterating in
+// coord_def order (which seeded level generation depends on), but finding
+// the one at a square is an array lookup rather than a tree search. Entries
+// stay where they are in memory until erased, so references to them survive
+// others being added.
+template<typename T>
+class coord_grid
+{
+public:
+    typedef coord_def key_type;
+    typedef T mapped_type;
+    typedef pair<coord_def, T> entry;
+
+    class iterator
+    {
+    public:
+        iterator(coord_grid *g, coord_def p) : grid(g), pos(p) { }
+
+        entry &operator*() const { return grid->store[grid->slot(pos) - 1]; }
+        entry *operator->() const { return &**this; }
+        iterator &operator++()
+        {
+            pos = grid->first_from(pos + coord_def(0, 1));
+            return *this;
+        }
+        bool operator==(const iterator &other) const
+        {
+            return pos == other.pos;
+        }
+        bool operator!=(const iterator &other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        coord_grid *grid;
+        coord_def pos;
+    };
+
+    coord_grid() : slot(0), column_count(0), count(0) { }
+
+    // The entry at p, adding an empty one if there isn't one yet.
+    T &operator[](const coord_def &p)
+    {
+        ASSERT(map_bounds(p));
+        if (!slot(p))
+        {
+            if (free_slots.empty())
+            {
+                store.emplace_back();
+                slot(p) = store.size();
+            }
+            else
+            {
+                slot(p) = free_slots.back() + 1;
+                free_slots.pop_back();
+            }
+            store[slot(p) - 1].first = p;
+            column_count[p.x]++;
+            count++;
+        }
+        return store[slot(p) - 1].second;
+    }
+
+    // The entry at p, or nullptr.
+    T *get(const coord_def &p)
+    {
+        if (!map_bounds(p) || !slot(p))
+            return nullptr;
+        return &store[slot(p) - 1].second;
+    }
+
+    iterator find(const coord_def &p)
+    {
+        return map_bounds(p) && slot(p) ? iterator(this, p) : end();
+    }
+
+    void erase(const coord_def &p)
+    {
+        if (!map_bounds(p) || !slot(p))
+            return;
+
+        const uint16_t index = slot(p) - 1;
+        store[index] = entry();
+        free_slots.push_back(index);
+        slot(p) = 0;
+        column_count[p.x]--;
+        count--;
+    }
+
+    void clear()
+    {
+        slot.init(0);
+        column_count.init(0);
+        store.clear();
+        free_slots.clear();
+        count = 0;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return !count; }
+
+    iterator begin() { return iterator(this, first_from(coord_def(0, 0))); }
+    iterator end() { return iterator(this, coord_def(GXM, 0)); }
+
+private:
+    // The first square at or after p, going down each column in turn, with
+    // an entry on it; or (GXM, 0) if there's none.
+    coord_def first_from(coord_def p) const
+    {
+        for (; p.x < GXM; ++p.x, p.y = 0)
+        {
+            if (!column_count[p.x])
+                continue;
+            for (; p.y < GYM; ++p.y)
+                if (slot(p))
+                    return p;
+        }
+        return coord_def(GXM, 0);
+    }
+
+    // 1 + the index in store of the entry at each square; 0 for none.
+    FixedArray<uint16_t, GXM, GYM> slot;
+    FixedVector<uint16_t, GXM> column_count;
+    deque<entry> store;
+    vector<uint16_t> free_slots;
+    size_t count;
+};
@@ -167,40 +167,83 @@ void random_rectangle_iterator::operator++(int)
 /*
  *  radius iterator
  */
+
+// The cost of a circle type and radius, as the budget the rows and columns
+// of offsets are paid for from.
+static int _radius_credit(int r, circle_type ctype)
+{
+    switch (ctype)
+    {
+    case C_CIRCLE: return r;
+    case C_POINTY: return r * r;
+    case C_ROUND:  return r * r + 1;
+    case C_SQUARE: return r;
+    }
+    return r;
+}
+
+/**
+ * The offsets a radius_iterator visits for one shape, in order: each row
+ * outwards from the center, and in each row each column outwards, in the
+ * SE, NE, SW and NW quadrants. Nothing further than the width or height of
+ * the map can be in bounds, so the offsets stop there.
+ */
+static const vector<coord_def> &_radius_offsets(int credit, bool is_square)
+{
+    static map<pair<int, bool>, vector<coord_def>> tables;
+    vector<coord_def> &offsets = tables[make_pair(credit, is_square)];
+    if (!offsets.empty())
+        return offsets;
+
+    const int base_cost = is_square ? 1 : -1;
+    const int inc_cost = is_square ? 0 : 2;
+
+    int y = 0;
+    int cost_y = base_cost;
+    int credit_y = credit;
+    do
+    {
+        int x = 0;
+        int cost_x = base_cost;
+        int credit_x = (is_square ? credit : credit_y);
+        do
+        {
+            offsets.emplace_back(x, y);
+            if (y)
+                offsets.emplace_back(x, -y);
+            if (x)
+            {
+                offsets.emplace_back(-x, y);
+                if (y)
+                    offsets.emplace_back(-x, -y);
+            }
+            x++;
+            credit_x -= (cost_x += inc_cost);
+        } while (credit_x >= 0 && x < GXM);
+
+        y++;
+        credit_y -= (cost_y += inc_cost);
+    } while (credit_y >= 0 && y < GYM);
+
+    return offsets;
+}
+
 radius_iterator::radius_iterator(const coord_def _center, int r,
                                  circle_type ctype,
                                  bool _exclude_center)
-    : state(RI_START),
-      center(_center),
+    : center(_center),
       los(LOS_NONE)
 {
-    ASSERT(map_bounds(_center));
-    switch (ctype)
-    {
-    case C_CIRCLE: credit = r; break;
-    case C_POINTY: credit = r * r; break;
-    case C_ROUND:  credit = r * r + 1; break;
-    case C_SQUARE: credit = r; break;
-    }
-    is_square = (ctype == C_SQUARE);
-    ++(*this);
-    if (_exclude_center)
-        ++(*this);
+    start(_radius_credit(r, ctype), ctype == C_SQUARE, _exclude_center);
 }
 
 radius_iterator::radius_iterator(const coord_def _center,
                                  los_type _los,
                                  bool _exclude_center)
-    : state(RI_START),
-      center(_center),
+    : center(_center),
       los(_los)
 {
-    ASSERT(map_bounds(_center));
-    credit = get_los_radius();
-    is_square = true;
-    ++(*this);
-    if (_exclude_center)
-        ++(*this);
+    start(get_los_radius(), true, _exclude_center);
 }
 
 radius_iterator::radius_iterator(const coord_def _center,
@@ -208,27 +251,25 @@ radius_iterator::radius_iterator(const coord_def _center,
                                  circle_type ctype,
                                  los_type _los,
                                  bool _exclude_center)
-    : state(RI_START),
-      center(_center),
+    : center(_center),
       los(_los)
 {
-    ASSERT(map_bounds(_center));
-    switch (ctype)
-    {
-    case C_CIRCLE: credit = r; break;
-    case C_POINTY: credit = r * r; break;
-    case C_ROUND:  credit = r * r + 1; break;
-    case C_SQUARE: credit = r; break;
-    }
-    is_square = (ctype == C_SQUARE);
+    start(_radius_credit(r, ctype), ctype == C_SQUARE, _exclude_center);
+}
+
+void radius_iterator::start(int credit, bool is_square, bool exclude_center)
+{
+    ASSERT(map_bounds(center));
+    offsets = &_radius_offsets(credit, is_square);
+    index = -1;
     ++(*this);
-    if (_exclude_center)
+    if (exclude_center)
         ++(*this);
 }
 
 radius_iterator::operator bool() const
 {
-    return state;
+    return index < (int) offsets->size();
 }
 
 coord_def radius_iterator::operator *() const
@@ -241,59 +282,19 @@ const coord_def* radius_iterator::operator->() const
     return &current;
 }
 
-#define coreturn(id) { state = id; return; case id:; }
-#define cobegin(id)  switch (state) { case id:
-#define coend(id)    coreturn(id); }
-#define ret_coord(dx, dy, id) do                                \
-    {                                                           \
-        current.x = center.x + (dx);                            \
-        current.y = center.y + (dy);                            \
-        if (!los || cell_see_cell(center, current, los))        \
-            coreturn(id);                                       \
-    } while (0)
-
 void radius_iterator::operator++()
 {
-    cobegin(RI_START);
-
-    base_cost = is_square ? 1 : -1;
-    inc_cost = is_square ? 0 : 2;
-
-    y = 0;
-    cost_y = base_cost;
-    credit_y = credit;
-
-    do
+    const int size = offsets->size();
+    while (++index < size)
     {
-        x = 0;
-        cost_x = base_cost;
-        credit_x = (is_square ? credit : credit_y);
-
-        do
+        current = center + (*offsets)[index];
+        if (current.x >= 0 && current.x < GXM
+            && current.y >= 0 && current.y < GYM
+            && (!los || cell_see_cell(center, current, los)))
         {
-            if (x + center.x < GXM)
-            {
-                if (y + center.y < GYM)
-                    ret_coord( x,  y, RI_SE);
-                if (y && y <= center.y)
-                    ret_coord( x, -y, RI_NE);
-            }
-            if (x && x <= center.x)
-            {
-                if (y + center.y < GYM)
-                    ret_coord(-x,  y, RI_SW);
-                if (y && y <= center.y)
-                    ret_coord(-x, -y, RI_NW);
-            }
-            x++;
-            credit_x -= (cost_x += inc_cost);
-        } while (credit_x >= 0);
-
-        y++;
-        credit_y -= (cost_y += inc_cost);
-    } while (credit_y >= 0);
-
-    coend(RI_DONE);
+            return;
+        }
+    }
 }
 
 void radius_iterator::operator++(int)
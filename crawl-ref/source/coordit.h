@@ -61,6 +61,10 @@ private:
  * The region can be a circle of any r²; furthermore, the cells can
  * be restricted to lie within LOS from the center (of any type)
  * centered at the same point), and to exclude the center.
+ *
+ * The cells are visited in a fixed order (the center, then outwards a row
+ * at a time), which random choices over them rely on. The offsets for each
+ * shape are only worked out the first time it is used.
  */
 class radius_iterator : public iterator<forward_iterator_tag, coord_def>
 {
@@ -80,11 +84,10 @@ public:
     void operator ++ (int);
 
 private:
-    enum costate { RI_DONE, RI_START, RI_SE, RI_NE, RI_SW, RI_NW };
-    int x, y, cost_x, cost_y, credit, credit_x, credit_y, base_cost, inc_cost;
-    bool is_square;
+    void start(int credit, bool is_square, bool exclude_center);
 
-    costate state;
+    const vector<coord_def> *offsets;
+    int index;
     coord_def center;
     los_type los;
     coord_def current;    // storage for operator->
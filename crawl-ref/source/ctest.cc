@@ -16,7 +16,12 @@
 #include "ctest.h"
 
 #include <algorithm>
+#include <chrono>
 #include <vector>
+#ifdef UNIX
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 #include "clua.h"
 #include "cluautil.h"
@@ -38,6 +43,8 @@
 #include "ng-init.h"
 #include "state.h"
 #include "stringutil.h"
+#include "syscalls.h"
+#include "tags.h"
 #include "xom.h"
 
 static const string test_dir = "test";
@@ -50,6 +57,21 @@ static int nsuccess = 0;
 typedef pair<string, string> file_error;
 static vector<file_error> failures;
 
+// How long each test took, in milliseconds.
+typedef pair<string, double> test_time;
+static vector<test_time> test_times;
+
+// The longest running tests are listed at the end of a run.
+#define SLOWEST_TESTS_SHOWN 10
+
+typedef std::chrono::steady_clock test_clock;
+
+static double _ms_since(test_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(test_clock::now()
+                                                     - start).count();
+}
+
 static void _reset_test_data()
 {
     ntests = 0;
@@ -135,7 +157,9 @@ static void run_test(const string &file)
     flush_prev_message();
 
     const string path(catpath(crawl_state.script? script_dir : test_dir, file));
+    const auto start = test_clock::now();
     dlua.execfile(path.c_str(), true, false);
+    test_times.emplace_back(file, _ms_since(start));
     if (dlua.error.empty())
         ++nsuccess;
     else
@@ -166,6 +190,7 @@ static void _run_test(const string &name, void (*func)())
         fprintf(stderr, "Running test #%d: '%s'.\n", ntests, name.c_str());
 
     ++ntests;
+    const auto start = test_clock::now();
     try
     {
         (*func)();
@@ -175,9 +200,166 @@ static void _run_test(const string &name, void (*func)())
     {
         failures.emplace_back(name, E.what());
     }
+    test_times.emplace_back(name, _ms_since(start));
 }
 #endif
 
+#ifdef UNIX
+// -test-jobs: the Lua tests are dealt out in turn between forked worker
+// processes. Every worker writes its counts, failures and timings to a
+// scratch file, which the parent adds to its own before reporting.
+
+static string _test_worker_file(int worker)
+{
+    return make_stringf("test-worker%d.tmp", worker);
+}
+
+static bool _write_test_results(const string &file)
+{
+    FILE *fp = fopen_u(file.c_str(), "wb");
+    if (!fp)
+        return false;
+
+    {
+        writer th(file, fp);
+        marshallInt(th, ntests);
+        marshallInt(th, nsuccess);
+        marshallInt(th, failures.size());
+        for (const file_error &fe : failures)
+        {
+            marshallString(th, fe.first);
+            marshallString4(th, fe.second);
+        }
+        marshallInt(th, test_times.size());
+        for (const test_time &time : test_times)
+        {
+            marshallString(th, time.first);
+            // To the microsecond.
+            marshallSigned(th, (int64_t) (time.second * 1000));
+        }
+    }
+    return !fclose(fp);
+}
+
+static bool _merge_test_results(const string &file)
+{
+    FILE *fp = fopen_u(file.c_str(), "rb");
+    if (!fp)
+        return false;
+
+    bool ok = true;
+    try
+    {
+        reader th(fp);
+        ntests += unmarshallInt(th);
+        nsuccess += unmarshallInt(th);
+        for (int i = unmarshallInt(th); i > 0; --i)
+        {
+            const string name = unmarshallString(th);
+            string error;
+            unmarshallString4(th, error);
+            failures.emplace_back(name, error);
+        }
+        for (int i = unmarshallInt(th); i > 0; --i)
+        {
+            const string name = unmarshallString(th);
+            test_times.emplace_back(name, unmarshallSigned(th) / 1000.0);
+        }
+    }
+    catch (short_read_exception &E)
+    {
+        ok = false;
+    }
+    fclose(fp);
+    return ok;
+}
+
+// Run the selected tests in crawl_state.test_jobs worker processes.
+static void _run_tests_parallel(const vector<string> &tests)
+{
+    vector<string> selected;
+    for (const string &test : tests)
+        if (_is_test_selected(test))
+            selected.push_back(test);
+
+    if (selected.empty())
+        return;
+
+    const int jobs = min<int>(crawl_state.test_jobs, selected.size());
+    vector<pid_t> workers;
+
+    // Don't let the workers inherit (and repeat) anything still buffered.
+    fflush(stdout);
+    fflush(stderr);
+
+    for (int i = 0; i < jobs; ++i)
+    {
+        const pid_t pid = fork();
+        if (pid == -1)
+        {
+            fprintf(stderr, "Couldn't fork test worker %d: %s\n", i,
+                    strerror(errno));
+            break;
+        }
+        if (pid)
+        {
+            workers.push_back(pid);
+            continue;
+        }
+
+        // Only report this worker's own tests.
+        ntests = 0;
+        nsuccess = 0;
+        failures.clear();
+        test_times.clear();
+
+        for (int j = i; j < (int) selected.size(); j += jobs)
+            run_test(selected[j]);
+
+        const bool ok = _write_test_results(_test_worker_file(i));
+        fflush(stdout);
+        fflush(stderr);
+        _exit(ok ? 0 : 1);
+    }
+
+    // Tests dealt to workers that couldn't be started run here instead.
+    for (int j = 0; j < (int) selected.size(); ++j)
+        if (j % jobs >= (int) workers.size())
+            run_test(selected[j]);
+
+    for (int i = 0, size = workers.size(); i < size; ++i)
+    {
+        int status = 0;
+        const bool exited = waitpid(workers[i], &status, 0) != -1
+                            && WIFEXITED(status) && !WEXITSTATUS(status);
+
+        const string file = _test_worker_file(i);
+        if (!exited || !_merge_test_results(file))
+        {
+            failures.emplace_back(make_stringf("test worker %d", i),
+                                  "worker died before reporting its tests");
+        }
+        unlink_u(file.c_str());
+    }
+}
+#endif
+
+static void _report_slowest_tests()
+{
+    vector<test_time> slowest = test_times;
+    sort(begin(slowest), end(slowest),
+         [](const test_time &a, const test_time &b)
+         {
+             return a.second > b.second;
+         });
+    if (slowest.size() > SLOWEST_TESTS_SHOWN)
+        slowest.resize(SLOWEST_TESTS_SHOWN);
+
+    fprintf(stderr, "Slowest %ss:\n", activity);
+    for (const test_time &time : slowest)
+        fprintf(stderr, "%10.1f ms  %s\n", time.second, time.first.c_str());
+}
+
 // Assumes curses has already been initialized.
 void run_tests()
 {
@@ -220,6 +402,14 @@ void run_tests()
         // reproducibility.
         sort(begin(tests), end(tests));
 
+#ifdef UNIX
+        if (crawl_state.test_jobs > 1 && !crawl_state.script
+            && !crawl_state.test_list)
+        {
+            _run_tests_parallel(tests);
+        }
+        else
+#endif
         for_each(tests.begin(), tests.end(), run_test);
 
         if (failures.empty() && !ntests && crawl_state.script)
@@ -239,6 +429,8 @@ void run_tests()
     if (crawl_state.test_list)
         end(0);
     cio_cleanup();
+    if (!crawl_state.script && !test_times.empty())
+        _report_slowest_tests();
     for (const file_error &fe : failures)
         fprintf(stderr, "%s error: %s\n", activity, fe.second.c_str());
 
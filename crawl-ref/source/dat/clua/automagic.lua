@@ -177,20 +177,20 @@ local function is_candidate_for_attack(x,y)
 end
 
 local function get_target()
-  local los_radius = you.los()
   local x, y, bestx, besty, best_info, new_info
   bestx = 0
   besty = 0
   best_info = nil
-  for x = -los_radius,los_radius do
-    for y = -los_radius,los_radius do
-      if is_candidate_for_attack(x, y) then
-        new_info = get_monster_info(x, y)
-        if (not best_info) or compare_monster_info(new_info, best_info) then
-          bestx = x
-          besty = y
-          best_info = new_info
-        end
+  -- Only cells with a visible monster are worth looking at; these come in
+  -- the same order as scanning x, then y, across line of sight.
+  for _, mon in ipairs(monster.get_monsters_in_view()) do
+    x, y = mon:x_pos(), mon:y_pos()
+    if is_candidate_for_attack(x, y) then
+      new_info = get_monster_info(x, y)
+      if (not best_info) or compare_monster_info(new_info, best_info) then
+        bestx = x
+        besty = y
+        best_info = new_info
       end
     end
   end
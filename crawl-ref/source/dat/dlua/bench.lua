@@ -0,0 +1,34 @@
+-- helper functions for the turn loop benchmarks in test/bench
+
+util.namespace("bench")
+
+crawl_require('dlua/stress.lua')
+
+-- Go to a level, make it busy and wake everything up.
+function bench.setup(place, spec, count)
+  debug.disable('death')
+  debug.disable('confirmations')
+  if place then
+    debug.go_to_level(place)
+  end
+  if spec then
+    bench.crowd(spec, count)
+  end
+  stress.awaken_level()
+end
+
+-- Put up to n monsters from spec on random open squares of the level.
+function bench.crowd(spec, n)
+  local gxm, gym = dgn.max_bounds()
+  local placed, tries = 0, 0
+  while placed < n and tries < n * 50 do
+    tries = tries + 1
+    local x = crawl.random_range(1, gxm - 2)
+    local y = crawl.random_range(1, gym - 2)
+    if dgn.is_passable(x, y) and dgn.mons_at(x, y) == nil
+       and dgn.create_monster(x, y, spec) then
+      placed = placed + 1
+    end
+  end
+  return placed
+end
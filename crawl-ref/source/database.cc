@@ -68,6 +68,10 @@ static string _query_database(TextDB &db, string key, bool canonicalise_key,
                               bool run_lua, bool untranslated = false);
 static void _add_entry(DBM *db, const string &k, string &v);
 
+// Where the "Regenerating db" notices go instead of mpr while
+// databaseSystemInit() runs off the main thread.
+static vector<string> *_db_notices = nullptr;
+
 static TextDB AllDBs[] =
 {
     TextDB("descriptions", "descript/",
@@ -158,6 +162,31 @@ static string _db_cache_path(string db, const char *lang)
     return savedir_versioned_path("db/" + db);
 }
 
+// Where an input file was found, and its mtime. Every database checks all
+// of its files on each init, and some files are shared between databases,
+// so each is only looked up (and stat()ed) once per databaseSystemInit().
+struct db_file_stamp
+{
+    string path;   // empty if it wasn't found
+    time_t mtime;
+};
+
+static map<string, db_file_stamp> _file_stamps;
+
+static const db_file_stamp &_file_stamp(const string &file, bool croak)
+{
+    auto it = _file_stamps.find(file);
+    if (it != _file_stamps.end())
+        return it->second;
+
+    db_file_stamp &stamp = _file_stamps[file];
+    // packagers who mess with mtime beware: you shouldn't put the db in
+    // a shared folder, as a fixed mtime will break this check.
+    stamp.path = datafile_path(file, croak);
+    stamp.mtime = stamp.path.empty() ? 0 : file_modtime(stamp.path);
+    return stamp;
+}
+
 // ----------------------------------------------------------------------
 // TextDB
 // ----------------------------------------------------------------------
@@ -214,10 +243,15 @@ void TextDB::init()
     }
 }
 
+static void _forget_search_index(DBM *database);
+static void _forget_weighted_entries(DBM *database);
+
 void TextDB::shutdown(bool recursive)
 {
     if (_db)
     {
+        _forget_search_index(_db);
+        _forget_weighted_entries(_db);
         dbm_close(_db);
         _db = nullptr;
     }
@@ -232,18 +266,14 @@ bool TextDB::_needs_update() const
 
     for (const string &file : _input_files)
     {
-        string full_input_path = _directory + file;
-        full_input_path = datafile_path(full_input_path, !_parent);
-        // packagers who mess with mtime beware: you shouldn't put the db in
-        // a shared folder, as a fixed mtime will break this check.
-        time_t mtime = file_modtime(full_input_path);
-        const bool exists = file_exists(full_input_path);
+        const db_file_stamp &stamp = _file_stamp(_directory + file, !_parent);
+        const bool exists = !stamp.path.empty();
         if (exists || !_parent)
         {
             if (exists)
                 no_files = false;
             char buf[20];
-            snprintf(buf, sizeof(buf), ":%" PRId64, (int64_t)mtime);
+            snprintf(buf, sizeof(buf), ":%" PRId64, (int64_t)stamp.mtime);
             ts += buf;
         }
     }
@@ -272,14 +302,23 @@ void TextDB::_regenerate_db()
 #ifdef DEBUG_DIAGNOSTICS
         printf("Regenerating db: %s [%s]\n", _db_name, Options.lang_name);
 #endif
-        mprf(MSGCH_PLAIN, "Regenerating db: %s [%s]", _db_name, Options.lang_name);
+        const string notice = make_stringf("Regenerating db: %s [%s]",
+                                           _db_name, Options.lang_name);
+        if (_db_notices)
+            _db_notices->push_back(notice);
+        else
+            mpr(notice);
     }
     else
     {
 #ifdef DEBUG_DIAGNOSTICS
         printf("Regenerating db: %s\n", _db_name);
 #endif
-        mprf(MSGCH_PLAIN, "Regenerating db: %s", _db_name);
+        const string notice = make_stringf("Regenerating db: %s", _db_name);
+        if (_db_notices)
+            _db_notices->push_back(notice);
+        else
+            mpr(notice);
     }
 
     string db_path = _db_cache_path(_db_name, lang());
@@ -295,22 +334,22 @@ void TextDB::_regenerate_db()
 #ifndef DGL_REWRITE_PROTECT_DB_FILES
     unlink_u(full_db_path.c_str());
 #endif
+    // Its snapshot too, which the new one replaces when the db is closed.
+    unlink_u((db_path + ".kv").c_str());
 
     string ts;
     if (!(_db = dbm_open(db_path.c_str(), O_RDWR | O_CREAT, 0660)))
         end(1, true, "Unable to open DB: %s", db_path.c_str());
     for (const string &file : _input_files)
     {
-        string full_input_path = _directory + file;
-        full_input_path = datafile_path(full_input_path, !_parent);
+        const db_file_stamp &stamp = _file_stamp(_directory + file, !_parent);
         char buf[20];
-        time_t mtime = file_modtime(full_input_path);
-        if (file_exists(full_input_path)
+        if (!stamp.path.empty()
             || !_parent) // english is mandatory
         {
-            snprintf(buf, sizeof(buf), ":%" PRId64, (int64_t)mtime);
+            snprintf(buf, sizeof(buf), ":%" PRId64, (int64_t)stamp.mtime);
             ts += buf;
-            _store_text_db(full_input_path, _db);
+            _store_text_db(stamp.path, _db);
         }
     }
     _add_entry(_db, "TIMESTAMP", ts);
@@ -325,10 +364,16 @@ void TextDB::_regenerate_db()
 
 #define NUM_DB ARRAYSZ(AllDBs)
 
-void databaseSystemInit()
+// If @p notices is given, the messages the databases would print are
+// added to it instead, so that this can run off the main thread.
+void databaseSystemInit(vector<string> *notices)
 {
+    _db_notices = notices;
+    _file_stamps.clear();
     for (unsigned int i = 0; i < NUM_DB; i++)
         AllDBs[i].init();
+    _file_stamps.clear();
+    _db_notices = nullptr;
 }
 
 void databaseSystemShutdown()
@@ -357,6 +402,141 @@ static datum _database_fetch(DBM *database, const string &key)
     return result;
 }
 
+// Every searchable entry of a database, read in on its first search, so
+// that later searches (each ?/ lookup does two) neither walk the DBM nor
+// fetch every body from it again. The lowercased copies let a search skip
+// most entries with a plain substring find before trying the regex.
+struct db_search_entry
+{
+    string key, body;
+    string lower_key, lower_body;
+};
+
+static map<DBM *, vector<db_search_entry>> search_indices;
+
+static string _ascii_lowercase(string s)
+{
+    for (char &c : s)
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+    return s;
+}
+
+static const vector<db_search_entry> &_search_index(DBM *database)
+{
+    auto found = search_indices.find(database);
+    if (found != search_indices.end())
+        return found->second;
+
+    vector<db_search_entry> &entries = search_indices[database];
+    for (datum dbKey = dbm_firstkey(database); dbKey.dptr != nullptr;
+         dbKey = dbm_nextkey(database))
+    {
+        string key((const char *)dbKey.dptr, dbKey.dsize);
+        if (key.find("__") != string::npos)
+            continue;
+
+        datum dbBody = dbm_fetch(database, dbKey);
+        string body((const char *)dbBody.dptr, dbBody.dsize);
+
+        db_search_entry entry;
+        entry.lower_key = _ascii_lowercase(key);
+        entry.lower_body = _ascii_lowercase(body);
+        entry.key = move(key);
+        entry.body = move(body);
+        entries.push_back(move(entry));
+    }
+    return entries;
+}
+
+static void _forget_search_index(DBM *database)
+{
+    search_indices.erase(database);
+}
+
+/**
+ * The longest run of plain ASCII text that anything @p regex matches must
+ * contain, lowercased, or "" if there isn't one that is easy to be sure of.
+ * Only text outside groups counts, and alternation anywhere gives up.
+ */
+static string _required_text(const string &regex)
+{
+    if (regex.find('|') != string::npos)
+        return "";
+
+    string best, run;
+    int depth = 0;
+    const auto end_run = [&]() {
+        if (run.length() > best.length())
+            best = run;
+        run.clear();
+    };
+
+    for (size_t i = 0; i < regex.length(); ++i)
+    {
+        const char c = regex[i];
+        switch (c)
+        {
+        case '?': case '*': case '{':
+            // The character before might not be there at all.
+            if (!run.empty())
+                run.pop_back();
+            end_run();
+            if (c == '{')
+                while (i + 1 < regex.length() && regex[i] != '}')
+                    ++i;
+            break;
+        case '+':
+            end_run();
+            break;
+        case '(':
+            ++depth;
+            end_run();
+            break;
+        case ')':
+            --depth;
+            end_run();
+            break;
+        case '[':
+            end_run();
+            // Skip the class; a ']' first in it is part of it.
+            if (i + 1 < regex.length() && regex[i + 1] == '^')
+                ++i;
+            if (i + 1 < regex.length() && regex[i + 1] == ']')
+                ++i;
+            while (i + 1 < regex.length() && regex[i + 1] != ']')
+                ++i;
+            ++i;
+            break;
+        case '\\':
+            // Escaped punctuation is itself; anything else is a class or an
+            // assertion.
+            if (i + 1 < regex.length() && depth == 0
+                && ispunct(static_cast<unsigned char>(regex[i + 1])))
+            {
+                run += regex[++i];
+            }
+            else
+            {
+                end_run();
+                ++i;
+            }
+            break;
+        case '.': case '^': case '$':
+            end_run();
+            break;
+        default:
+            if (depth == 0 && static_cast<unsigned char>(c) < 0x80)
+                run += c;
+            else
+                end_run();
+            break;
+        }
+    }
+    end_run();
+    return _ascii_lowercase(best);
+}
+
 static vector<string> _database_find_keys(DBM *database,
                                           const string &regex,
                                           bool ignore_case,
@@ -365,20 +545,20 @@ static vector<string> _database_find_keys(DBM *database,
     text_pattern             tpat(regex, ignore_case);
     vector<string> matches;
 
-    datum dbKey = dbm_firstkey(database);
-
-    while (dbKey.dptr != nullptr)
+    const string required = _required_text(regex);
+    for (const db_search_entry &entry : _search_index(database))
     {
-        string key((const char *)dbKey.dptr, dbKey.dsize);
-
-        if (tpat.matches(key)
-            && key.find("__") == string::npos
-            && (filter == nullptr || !(*filter)(key, "")))
+        if (!required.empty() && ignore_case
+            && entry.lower_key.find(required) == string::npos)
         {
-            matches.push_back(key);
+            continue;
         }
 
-        dbKey = dbm_nextkey(database);
+        if (tpat.matches(entry.key)
+            && (filter == nullptr || !(*filter)(entry.key, "")))
+        {
+            matches.push_back(entry.key);
+        }
     }
 
     return matches;
@@ -392,23 +572,20 @@ static vector<string> _database_find_bodies(DBM *database,
     text_pattern             tpat(regex, ignore_case);
     vector<string> matches;
 
-    datum dbKey = dbm_firstkey(database);
-
-    while (dbKey.dptr != nullptr)
+    const string required = _required_text(regex);
+    for (const db_search_entry &entry : _search_index(database))
     {
-        string key((const char *)dbKey.dptr, dbKey.dsize);
-
-        datum dbBody = dbm_fetch(database, dbKey);
-        string body((const char *)dbBody.dptr, dbBody.dsize);
-
-        if (tpat.matches(body)
-            && key.find("__") == string::npos
-            && (filter == nullptr || !(*filter)(key, body)))
+        if (!required.empty() && ignore_case
+            && entry.lower_body.find(required) == string::npos)
         {
-            matches.push_back(key);
+            continue;
         }
 
-        dbKey = dbm_nextkey(database);
+        if (tpat.matches(entry.body)
+            && (filter == nullptr || !(*filter)(entry.key, entry.body)))
+        {
+            matches.push_back(entry.key);
+        }
     }
 
     return matches;
@@ -546,10 +723,31 @@ static void _store_text_db(const string &in, DBM *db)
     _parse_text_db(inf, db);
 }
 
-static string _chooseStrByWeight(const string &entry, int fixed_weight = -1)
+// An entry split into its weighted alternatives, as _chooseStrByWeight()
+// picks from them. Speech and shout lookups try many keys for every
+// utterance, most of which aren't in the database, so both the parsed
+// entries and the misses are kept for as long as the database is open.
+struct weighted_entry
 {
     vector<string> parts;
-    vector<int>    weights;
+    vector<int>    weights; // cumulative
+    int            total_weight;
+    const char    *error;   // if the entry is malformed
+};
+
+// A null entry is a key that isn't there.
+static map<DBM *, map<string, unique_ptr<weighted_entry>>> weighted_entries;
+
+// Speech keys are built from monster names, so there is no fixed bound on
+// how many are tried; start again past this many.
+#define MAX_WEIGHTED_ENTRIES 4096
+
+static unique_ptr<weighted_entry> _parse_weighted_entry(const string &entry)
+{
+    unique_ptr<weighted_entry> parsed(new weighted_entry);
+    vector<string> &parts = parsed->parts;
+    vector<int>    &weights = parsed->weights;
+    parsed->error = nullptr;
 
     vector<string> lines = split_string("\n", entry, false, true);
 
@@ -571,7 +769,10 @@ static string _chooseStrByWeight(const string &entry, int fixed_weight = -1)
         {
             i++;
             if (i == size)
-                return "BUG, WEIGHT AT END OF ENTRY";
+            {
+                parsed->error = "BUG, WEIGHT AT END OF ENTRY";
+                return parsed;
+            }
         }
         else
             weight = 10;
@@ -590,17 +791,55 @@ static string _chooseStrByWeight(const string &entry, int fixed_weight = -1)
     }
 
     if (parts.empty())
-        return "BUG, EMPTY ENTRY";
+        parsed->error = "BUG, EMPTY ENTRY";
+    parsed->total_weight = total_weight;
+    return parsed;
+}
+
+// The parsed entry for key in database, or nullptr if there is none.
+static const weighted_entry *_weighted_entry(DBM *database, const string &key)
+{
+    if (!database)
+        return nullptr;
+
+    auto &entries = weighted_entries[database];
+    auto found = entries.find(key);
+    if (found != entries.end())
+        return found->second.get();
+
+    if (entries.size() >= MAX_WEIGHTED_ENTRIES)
+        entries.clear();
+
+    unique_ptr<weighted_entry> &cached = entries[key];
+    datum result = _database_fetch(database, key);
+    if (result.dsize > 0)
+    {
+        cached = _parse_weighted_entry(
+            string((const char *)result.dptr, result.dsize));
+    }
+    return cached.get();
+}
+
+static void _forget_weighted_entries(DBM *database)
+{
+    weighted_entries.erase(database);
+}
+
+static string _chooseStrByWeight(const weighted_entry &entry,
+                                 int fixed_weight = -1)
+{
+    if (entry.error)
+        return entry.error;
 
     int choice = 0;
     if (fixed_weight != -1)
-        choice = fixed_weight % total_weight;
+        choice = fixed_weight % entry.total_weight;
     else
-        choice = random2(total_weight);
+        choice = random2(entry.total_weight);
 
-    for (int i = 0, size = parts.size(); i < size; i++)
-        if (choice < weights[i])
-            return parts[i];
+    for (int i = 0, size = entry.parts.size(); i < size; i++)
+        if (choice < entry.weights[i])
+            return entry.parts[i];
 
     return "BUG, NO STRING CHOSEN";
 }
@@ -617,14 +856,14 @@ static string _getWeightedString(TextDB &db, const string &key,
     lowercase(canonical_key);
 
     // Query the DB.
-    datum result;
+    const weighted_entry *entry = nullptr;
 
     if (db.translation)
-        result = _database_fetch(db.translation->get(), canonical_key);
-    if (result.dsize <= 0)
-        result = _database_fetch(db.get(), canonical_key);
+        entry = _weighted_entry(db.translation->get(), canonical_key);
+    if (!entry)
+        entry = _weighted_entry(db.get(), canonical_key);
 
-    if (result.dsize <= 0)
+    if (!entry && !suffix.empty())
     {
         // Try ignoring the suffix.
         canonical_key = key;
@@ -632,18 +871,15 @@ static string _getWeightedString(TextDB &db, const string &key,
 
         // Query the DB.
         if (db.translation)
-            result = _database_fetch(db.translation->get(), canonical_key);
-        if (result.dsize <= 0)
-            result = _database_fetch(db.get(), canonical_key);
-
-        if (result.dsize <= 0)
-            return "";
+            entry = _weighted_entry(db.translation->get(), canonical_key);
+        if (!entry)
+            entry = _weighted_entry(db.get(), canonical_key);
     }
 
-    // Cons up a (C++) string to return. The caller must release it.
-    string str = string((const char *)result.dptr, result.dsize);
+    if (!entry)
+        return "";
 
-    return _chooseStrByWeight(str, fixed_weight);
+    return _chooseStrByWeight(*entry, fixed_weight);
 }
 
 static void _call_recursive_replacement(string &str, TextDB &db,
@@ -27,7 +27,7 @@ extern "C" {
 
 #define DPTR_COERCE char *
 
-void databaseSystemInit();
+void databaseSystemInit(vector<string> *notices = nullptr);
 void databaseSystemShutdown();
 
 typedef bool (*db_find_filter)(string key, string body);
@@ -7,6 +7,12 @@
 
 #include "dbg-maps.h"
 
+#include <chrono>
+#ifdef UNIX
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 #include "branch.h"
 #include "chardump.h"
 #include "crash.h"
@@ -15,9 +21,12 @@
 #include "env.h"
 #include "initfile.h"
 #include "item-prop.h" // initialise_item_sets
+#include "json.h"
+#include "json-wrapper.h"
 #include "libutil.h"
 #include "maps.h"
 #include "message.h"
+#include "node-pool.h"
 #include "ng-init.h"
 #include "player.h"
 #include "shopping.h"
@@ -25,6 +34,7 @@
 #include "stringutil.h"
 #include "syscalls.h"
 #include "tag-version.h"
+#include "tags.h"
 #include "view.h"
 
 #ifdef DEBUG_STATISTICS
@@ -48,11 +58,54 @@ static int levels_tried = 0, levels_failed = 0;
 static int build_attempts = 0, level_vetoes = 0;
 // Map from message to counts.
 static map<string, int> veto_messages;
+// Map from message to the milliseconds spent on attempts it vetoed.
+static map<string, double> veto_millis;
+static double total_veto_millis = 0;
+static chrono::steady_clock::time_point build_start;
+
+// Stage profile of builder(). Time is inclusive of nested stages; Lua time
+// is counted against the innermost stage; vetoes against the last stage
+// begun before the veto.
+struct stage_profile
+{
+    int runs = 0;
+    int vetoes = 0;
+    double ms = 0;
+    double lua_ms = 0;
+};
+static map<string, stage_profile> stage_profiles;
+static const char *current_stage = nullptr;
+static const char *last_stage = nullptr;
+
+// Time spent placing each map, and the part of that spent in its Lua.
+struct vault_profile
+{
+    int placements = 0;
+    double ms = 0;
+    double lua_ms = 0;
+};
+static map<string, vault_profile> vault_profiles;
+
+// Layout type (as in env.level_layout_types) to vetoed builds using it.
+static map<string, int> layout_vetoes;
+// The most memory any worker's builder node pools held; see node-pool.h.
+static size_t worker_pool_peak = 0;
+
+// Which -mapstat-parallel worker this process is, or -1 if not forked.
+static int mapstat_worker = -1;
+
+static double _ms_since(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(
+               chrono::steady_clock::now() - start).count();
+}
 
 void mapstat_report_map_build_start()
 {
     build_attempts++;
     map_builds[level_id::current()].first++;
+    build_start = chrono::steady_clock::now();
+    last_stage = nullptr;
 }
 
 void mapstat_report_map_veto(const string &message)
@@ -60,6 +113,59 @@ void mapstat_report_map_veto(const string &message)
     level_vetoes++;
     ++veto_messages[message];
     map_builds[level_id::current()].second++;
+
+    const double ms = _ms_since(build_start);
+    veto_millis[message] += ms;
+    total_veto_millis += ms;
+
+    if (last_stage)
+        stage_profiles[last_stage].vetoes++;
+    for (const string &layout : env.level_layout_types)
+        layout_vetoes[layout]++;
+}
+
+mapstat_stage::mapstat_stage(const char *_name)
+    : name(crawl_state.map_stat_gen ? _name : nullptr),
+      outer(current_stage), start(chrono::steady_clock::now())
+{
+    if (!name)
+        return;
+    current_stage = last_stage = name;
+    stage_profiles[name].runs++;
+}
+
+mapstat_stage::~mapstat_stage()
+{
+    if (!name)
+        return;
+    stage_profiles[name].ms += _ms_since(start);
+    current_stage = outer;
+}
+
+mapstat_map_timer::mapstat_map_timer(const map_def &_map, bool _lua)
+    : map(crawl_state.map_stat_gen ? &_map : nullptr), lua(_lua),
+      start(chrono::steady_clock::now())
+{
+}
+
+mapstat_map_timer::~mapstat_map_timer()
+{
+    if (!map)
+        return;
+
+    const double ms = _ms_since(start);
+    vault_profile &prof = vault_profiles[map->name];
+    if (lua)
+    {
+        prof.lua_ms += ms;
+        if (current_stage)
+            stage_profiles[current_stage].lua_ms += ms;
+    }
+    else
+    {
+        prof.placements++;
+        prof.ms += ms;
+    }
 }
 
 static bool _is_disconnected_level()
@@ -237,8 +343,13 @@ bool mapstat_build_levels()
 {
     if (!generated_levels.size())
         _dungeon_places();
-    printf("Iteration: ");
-    fflush(stdout);
+    // Only the first parallel worker reports progress on stdout.
+    const bool progress = mapstat_worker <= 0;
+    if (progress)
+    {
+        printf("Iteration: ");
+        fflush(stdout);
+    }
     for (int i = 0; i < SysEnv.map_gen_iters; ++i)
     {
         clear_messages();
@@ -249,8 +360,11 @@ bool mapstat_build_levels()
              last_error.empty() ? "" : (" (" + last_error + ")").c_str(),
              (unsigned int)use_count.size(), build_attempts, level_vetoes,
              build_attempts ? level_vetoes * 100.0 / build_attempts : 0.0);
-        printf("%d..", i + 1);
-        fflush(stdout);
+        if (progress)
+        {
+            printf("%d..", i + 1);
+            fflush(stdout);
+        }
         dlua.callfn("dgn_clear_data", "");
         you.uniq_map_tags.clear();
         you.uniq_map_names.clear();
@@ -266,11 +380,324 @@ bool mapstat_build_levels()
         if (crawl_state.obj_stat_gen)
             objstat_iteration_stats();
     }
-    printf("Finished.\n");
-    fflush(stdout);
+    if (progress)
+    {
+        printf("Finished.\n");
+        fflush(stdout);
+    }
     return true;
 }
 
+#ifdef UNIX
+// -mapstat-parallel: the iterations are shared out between forked worker
+// processes, each seeded differently. Every worker writes its tallies to a
+// scratch file, which the parent merges into its own before writing the
+// report.
+
+static string _worker_stats_file(int worker)
+{
+    return make_stringf("mapstat-worker%d.tmp", worker);
+}
+
+static void _marshall_key(writer &th, const string &key)
+{
+    marshallString(th, key);
+}
+
+static void _marshall_key(writer &th, const level_id &key)
+{
+    marshall_level_id(th, key);
+}
+
+static void _unmarshall_key(reader &th, string &key)
+{
+    key = unmarshallString(th);
+}
+
+static void _unmarshall_key(reader &th, level_id &key)
+{
+    key = unmarshall_level_id(th);
+}
+
+template<typename K>
+static void _marshall_counts(writer &th, const map<K, int> &counts)
+{
+    marshallInt(th, counts.size());
+    for (const auto &entry : counts)
+    {
+        _marshall_key(th, entry.first);
+        marshallInt(th, entry.second);
+    }
+}
+
+template<typename K>
+static void _merge_counts(reader &th, map<K, int> &counts)
+{
+    for (int i = unmarshallInt(th); i > 0; --i)
+    {
+        K key;
+        _unmarshall_key(th, key);
+        counts[key] += unmarshallInt(th);
+    }
+}
+
+template<typename K, typename V>
+static void _marshall_sets(writer &th, const map<K, set<V>> &sets)
+{
+    marshallInt(th, sets.size());
+    for (const auto &entry : sets)
+    {
+        _marshall_key(th, entry.first);
+        marshallInt(th, entry.second.size());
+        for (const V &val : entry.second)
+            _marshall_key(th, val);
+    }
+}
+
+template<typename K, typename V>
+static void _merge_sets(reader &th, map<K, set<V>> &sets)
+{
+    for (int i = unmarshallInt(th); i > 0; --i)
+    {
+        K key;
+        _unmarshall_key(th, key);
+        set<V> &vals = sets[key];
+        for (int j = unmarshallInt(th); j > 0; --j)
+        {
+            V val;
+            _unmarshall_key(th, val);
+            vals.insert(val);
+        }
+    }
+}
+
+// Milliseconds are kept to the microsecond.
+static void _marshall_millis(writer &th, double ms)
+{
+    marshallSigned(th, (int64_t) (ms * 1000));
+}
+
+static double _unmarshall_millis(reader &th)
+{
+    return unmarshallSigned(th) / 1000.0;
+}
+
+static bool _write_worker_stats(const string &file)
+{
+    FILE *fp = fopen_u(file.c_str(), "wb");
+    if (!fp)
+        return false;
+
+    {
+        writer th(file, fp);
+        marshallInt(th, levels_tried);
+        marshallInt(th, levels_failed);
+        marshallInt(th, build_attempts);
+        marshallInt(th, level_vetoes);
+        _marshall_counts(th, try_count);
+        _marshall_counts(th, use_count);
+        _marshall_counts(th, success_count);
+        _marshall_counts(th, level_mapcounts);
+        _marshall_counts(th, veto_messages);
+        _marshall_sets(th, level_mapsused);
+        _marshall_sets(th, map_levelsused);
+
+        marshallInt(th, map_builds.size());
+        for (const auto &entry : map_builds)
+        {
+            marshall_level_id(th, entry.first);
+            marshallInt(th, entry.second.first);
+            marshallInt(th, entry.second.second);
+        }
+
+        _marshall_millis(th, total_veto_millis);
+        marshallInt(th, veto_millis.size());
+        for (const auto &entry : veto_millis)
+        {
+            marshallString(th, entry.first);
+            _marshall_millis(th, entry.second);
+        }
+
+        marshallInt(th, errors.size());
+        for (const auto &entry : errors)
+        {
+            marshallString(th, entry.first);
+            marshallString(th, entry.second);
+        }
+        marshallString(th, last_error);
+
+        marshallInt(th, stage_profiles.size());
+        for (const auto &entry : stage_profiles)
+        {
+            marshallString(th, entry.first);
+            marshallInt(th, entry.second.runs);
+            marshallInt(th, entry.second.vetoes);
+            _marshall_millis(th, entry.second.ms);
+            _marshall_millis(th, entry.second.lua_ms);
+        }
+        marshallInt(th, vault_profiles.size());
+        for (const auto &entry : vault_profiles)
+        {
+            marshallString(th, entry.first);
+            marshallInt(th, entry.second.placements);
+            _marshall_millis(th, entry.second.ms);
+            _marshall_millis(th, entry.second.lua_ms);
+        }
+        _marshall_counts(th, layout_vetoes);
+        marshallSigned(th, max(node_pool::peak_bytes(), worker_pool_peak));
+        if (crawl_state.obj_stat_gen)
+            objstat_marshall_worker_stats(th);
+    }
+    return !fclose(fp);
+}
+
+static bool _merge_worker_stats(const string &file)
+{
+    FILE *fp = fopen_u(file.c_str(), "rb");
+    if (!fp)
+        return false;
+
+    bool ok = true;
+    try
+    {
+        reader th(fp);
+        levels_tried += unmarshallInt(th);
+        levels_failed += unmarshallInt(th);
+        build_attempts += unmarshallInt(th);
+        level_vetoes += unmarshallInt(th);
+        _merge_counts(th, try_count);
+        _merge_counts(th, use_count);
+        _merge_counts(th, success_count);
+        _merge_counts(th, level_mapcounts);
+        _merge_counts(th, veto_messages);
+        _merge_sets(th, level_mapsused);
+        _merge_sets(th, map_levelsused);
+
+        for (int i = unmarshallInt(th); i > 0; --i)
+        {
+            pair<int, int> &builds = map_builds[unmarshall_level_id(th)];
+            builds.first += unmarshallInt(th);
+            builds.second += unmarshallInt(th);
+        }
+
+        total_veto_millis += _unmarshall_millis(th);
+        for (int i = unmarshallInt(th); i > 0; --i)
+        {
+            const string message = unmarshallString(th);
+            veto_millis[message] += _unmarshall_millis(th);
+        }
+
+        for (int i = unmarshallInt(th); i > 0; --i)
+        {
+            const string map_name = unmarshallString(th);
+            const string err = unmarshallString(th);
+            errors.insert(make_pair(map_name, err));
+        }
+        const string err = unmarshallString(th);
+        if (!err.empty())
+            last_error = err;
+
+        for (int i = unmarshallInt(th); i > 0; --i)
+        {
+            stage_profile &prof = stage_profiles[unmarshallString(th)];
+            prof.runs += unmarshallInt(th);
+            prof.vetoes += unmarshallInt(th);
+            prof.ms += _unmarshall_millis(th);
+            prof.lua_ms += _unmarshall_millis(th);
+        }
+        for (int i = unmarshallInt(th); i > 0; --i)
+        {
+            vault_profile &prof = vault_profiles[unmarshallString(th)];
+            prof.placements += unmarshallInt(th);
+            prof.ms += _unmarshall_millis(th);
+            prof.lua_ms += _unmarshall_millis(th);
+        }
+        _merge_counts(th, layout_vetoes);
+        worker_pool_peak = max(worker_pool_peak,
+                               (size_t) unmarshallSigned(th));
+        if (crawl_state.obj_stat_gen)
+            objstat_merge_worker_stats(th);
+    }
+    catch (short_read_exception &E)
+    {
+        ok = false;
+    }
+    fclose(fp);
+    return ok;
+}
+
+/**
+ * Run mapstat_build_levels() in SysEnv.map_gen_jobs worker processes and
+ * merge what they found into this process's stats.
+ *
+ * @returns True if every worker built all of its iterations.
+ */
+bool mapstat_build_levels_parallel()
+{
+    const int jobs = min(SysEnv.map_gen_jobs, SysEnv.map_gen_iters);
+    const int iters = SysEnv.map_gen_iters;
+    const uint64_t base_seed = crawl_state.seed;
+    vector<pid_t> workers;
+
+    // Don't let the workers inherit (and repeat) anything still buffered.
+    fflush(stdout);
+    fflush(stderr);
+
+    for (int i = 0; i < jobs; ++i)
+    {
+        const pid_t pid = fork();
+        if (pid == -1)
+        {
+            fprintf(stderr, "Couldn't fork mapstat worker %d: %s\n", i,
+                    strerror(errno));
+            break;
+        }
+        if (pid)
+        {
+            workers.push_back(pid);
+            continue;
+        }
+
+        mapstat_worker = i;
+        SysEnv.map_gen_iters = iters / jobs + (i < iters % jobs);
+        Options.seed = base_seed + i;
+        rng::reset();
+
+        const bool ok = mapstat_build_levels()
+                        && _write_worker_stats(_worker_stats_file(i));
+        fflush(stdout);
+        fflush(stderr);
+        _exit(ok ? 0 : 1);
+    }
+
+    bool ok = (int) workers.size() == jobs;
+    for (int i = 0, size = workers.size(); i < size; ++i)
+    {
+        int status = 0;
+        if (waitpid(workers[i], &status, 0) == -1
+            || !WIFEXITED(status) || WEXITSTATUS(status))
+        {
+            fprintf(stderr, "Mapstat worker %d failed; its stats are "
+                    "not included.\n", i);
+            ok = false;
+        }
+
+        const string file = _worker_stats_file(i);
+        if (!_merge_worker_stats(file) && WIFEXITED(status)
+            && !WEXITSTATUS(status))
+        {
+            fprintf(stderr, "Couldn't read %s.\n", file.c_str());
+            ok = false;
+        }
+        unlink_u(file.c_str());
+    }
+    SysEnv.map_gen_iters = iters;
+    printf("Finished %d worker(s).\n", (int) workers.size());
+    fflush(stdout);
+    return ok;
+}
+#endif
+
 void mapstat_report_map_try(const map_def &map)
 {
     try_count[map.name]++;
@@ -323,6 +750,108 @@ static void _check_mapless(const level_id &lid, vector<level_id> &mapless)
         mapless.push_back(lid);
 }
 
+static void _write_stage_profile(FILE *outf)
+{
+    if (stage_profiles.empty())
+        return;
+
+    fprintf(outf, "\n\nBuilder stages (runs, vetoes, ms, Lua ms; time "
+                  "includes nested stages):\n");
+    for (const auto &entry : stage_profiles)
+    {
+        const stage_profile &prof = entry.second;
+        fprintf(outf, "%-20s %8d %6d %10.1f %10.1f\n", entry.first.c_str(),
+                prof.runs, prof.vetoes, prof.ms, prof.lua_ms);
+    }
+
+    if (!layout_vetoes.empty())
+    {
+        fprintf(outf, "\n\nVetoes by layout:\n");
+        multimap<int, string> sorted;
+        for (const auto &entry : layout_vetoes)
+            sorted.insert(make_pair(entry.second, entry.first));
+        for (auto i = sorted.rbegin(); i != sorted.rend(); ++i)
+            fprintf(outf, "%6d %s\n", i->first, i->second.c_str());
+    }
+
+    const int max_maps = 50;
+    fprintf(outf, "\n\nSlowest maps to place, top %d (placements, ms, "
+                  "Lua ms, mean ms):\n", max_maps);
+    multimap<double, string> slowest;
+    for (const auto &entry : vault_profiles)
+        slowest.insert(make_pair(entry.second.ms, entry.first));
+    int count = 0;
+    for (auto i = slowest.rbegin(); i != slowest.rend() && count < max_maps;
+         ++i)
+    {
+        const vault_profile &prof = vault_profiles[i->second];
+        fprintf(outf, "%3d) %6d %10.1f %10.1f %8.3f %s\n", ++count,
+                prof.placements, prof.ms, prof.lua_ms,
+                prof.placements ? prof.ms / prof.placements : 0.0,
+                i->second.c_str());
+    }
+}
+
+// The same profile, complete and machine-readable, for tools.
+static void _write_stage_profile_json()
+{
+    JsonWrapper json(json_mkobject());
+
+    JsonNode *stages(json_mkobject());
+    for (const auto &entry : stage_profiles)
+    {
+        JsonNode *stage(json_mkobject());
+        json_append_member(stage, "runs", json_mknumber(entry.second.runs));
+        json_append_member(stage, "vetoes",
+                           json_mknumber(entry.second.vetoes));
+        json_append_member(stage, "ms", json_mknumber(entry.second.ms));
+        json_append_member(stage, "lua_ms",
+                           json_mknumber(entry.second.lua_ms));
+        json_append_member(stages, entry.first.c_str(), stage);
+    }
+    json_append_member(json.node, "stages", stages);
+
+    JsonNode *maps(json_mkobject());
+    for (const auto &entry : vault_profiles)
+    {
+        JsonNode *vault(json_mkobject());
+        json_append_member(vault, "placements",
+                           json_mknumber(entry.second.placements));
+        json_append_member(vault, "ms", json_mknumber(entry.second.ms));
+        json_append_member(vault, "lua_ms",
+                           json_mknumber(entry.second.lua_ms));
+        json_append_member(maps, entry.first.c_str(), vault);
+    }
+    json_append_member(json.node, "maps", maps);
+
+    JsonNode *vetoes(json_mkobject());
+    for (const auto &entry : veto_messages)
+    {
+        JsonNode *veto(json_mkobject());
+        json_append_member(veto, "count", json_mknumber(entry.second));
+        json_append_member(veto, "ms",
+                           json_mknumber(veto_millis[entry.first]));
+        json_append_member(vetoes, entry.first.c_str(), veto);
+    }
+    json_append_member(json.node, "vetoes", vetoes);
+
+    JsonNode *layouts(json_mkobject());
+    for (const auto &entry : layout_vetoes)
+        json_append_member(layouts, entry.first.c_str(),
+                           json_mknumber(entry.second));
+    json_append_member(json.node, "layout_vetoes", layouts);
+
+    const char *out_file = "mapstat-profile.json";
+    FILE *outf = fopen_u(out_file, "w");
+    if (!outf)
+    {
+        fprintf(stderr, "Couldn't write %s.\n", out_file);
+        return;
+    }
+    fprintf(outf, "%s\n", json.to_string().c_str());
+    fclose(outf);
+}
+
 static void _write_map_stats()
 {
     const char *out_file = "mapstat.log";
@@ -333,6 +862,8 @@ static void _write_map_stats()
     fprintf(outf, "Levels attempted: %d, built: %d, failed: %d\n",
             levels_tried, levels_tried - levels_failed,
             levels_failed);
+    fprintf(outf, "Peak builder node pool: %zu KB\n",
+            max(node_pool::peak_bytes(), worker_pool_peak) / 1024);
     if (!errors.empty())
     {
         fprintf(outf, "\n\nMap errors:\n");
@@ -400,15 +931,21 @@ static void _write_map_stats()
                     vetoes, tries, vetoes * 100.0 / tries);
         }
 
-        fprintf(outf, "\n\nVeto reasons:\n");
+        fprintf(outf, "\n\nVeto reasons (count, ms spent on vetoed builds; "
+                      "%.0f ms in all):\n", total_veto_millis);
         multimap<int, string> sortedreasons;
         for (const auto &entry : veto_messages)
             sortedreasons.insert(make_pair(entry.second, entry.first));
 
         for (auto i = sortedreasons.rbegin(); i != sortedreasons.rend(); ++i)
-            fprintf(outf, "%3d) %s\n", i->first, i->second.c_str());
+        {
+            fprintf(outf, "%3d) %8.1f ms %s\n", i->first,
+                    veto_millis[i->second], i->second.c_str());
+        }
     }
 
+    _write_stage_profile(outf);
+
     if (!unused_maps.empty() && !SysEnv.map_gen_range)
     {
         fprintf(outf, "\n\nUnused maps:\n\n");
@@ -479,6 +1016,7 @@ static void _write_map_stats()
         fprintf(outf, "==================\n\n");
     }
     fclose(outf);
+    _write_stage_profile_json();
     printf("\n");
 }
 
@@ -528,7 +1066,12 @@ void mapstat_generate_stats()
            (int) generated_levels.size(), branch_count);
     fflush(stdout);
 
-    mapstat_build_levels();
+#ifdef UNIX
+    if (SysEnv.map_gen_jobs > 1)
+        mapstat_build_levels_parallel();
+    else
+#endif
+        mapstat_build_levels();
 
     _write_map_stats();
     printf("Map stats complete.\n");
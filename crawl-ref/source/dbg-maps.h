@@ -7,6 +7,8 @@
 
 #ifdef DEBUG_STATISTICS
 
+#include <chrono>
+
 class map_def;
 void mapstat_report_map_try(const map_def &map);
 void mapstat_report_map_use(const map_def &map);
@@ -16,5 +18,39 @@ void mapstat_report_map_build_start();
 void mapstat_report_map_veto(const string &message);
 void mapstat_generate_stats();
 bool mapstat_build_levels();
+#ifdef UNIX
+bool mapstat_build_levels_parallel();
+#endif
 bool mapstat_find_forced_map();
+
+// Times one stage of builder() for the mapstat stage profile, from
+// construction to destruction (including when a veto unwinds it). Stages
+// may nest; a stage's time includes the stages run inside it.
+class mapstat_stage
+{
+public:
+    mapstat_stage(const char *name);
+    ~mapstat_stage();
+private:
+    const char *name;
+    const char *outer;
+    chrono::steady_clock::time_point start;
+};
+
+// Times placing a map (lua = false) or running one of its Lua chunks
+// (lua = true) for the per-vault profile.
+class mapstat_map_timer
+{
+public:
+    mapstat_map_timer(const map_def &map, bool lua);
+    ~mapstat_map_timer();
+private:
+    const map_def *map;
+    bool lua;
+    chrono::steady_clock::time_point start;
+};
+
+# define MAPSTAT_STAGE(name) mapstat_stage mapstat_stage_timer(name)
+#else
+# define MAPSTAT_STAGE(name)
 #endif
@@ -40,6 +40,7 @@
 #include "stringutil.h"
 #include "syscalls.h"
 #include "tag-version.h"
+#include "tags.h"
 #include "version.h"
 
 #ifdef DEBUG_STATISTICS
@@ -1013,6 +1014,115 @@ void objstat_iteration_stats()
     }
 }
 
+// The stat tables of a -mapstat-parallel worker, for the parent to add to
+// its own. Keys are level ids, field names, or an enum or sub type.
+static void _marshall_stat_key(writer &th, const level_id &key)
+{
+    marshall_level_id(th, key);
+}
+
+static void _marshall_stat_key(writer &th, const string &key)
+{
+    marshallString(th, key);
+}
+
+template<typename K>
+static void _marshall_stat_key(writer &th, K key)
+{
+    marshallInt(th, static_cast<int>(key));
+}
+
+static void _unmarshall_stat_key(reader &th, level_id &key)
+{
+    key = unmarshall_level_id(th);
+}
+
+static void _unmarshall_stat_key(reader &th, string &key)
+{
+    key = unmarshallString(th);
+}
+
+template<typename K>
+static void _unmarshall_stat_key(reader &th, K &key)
+{
+    key = static_cast<K>(unmarshallInt(th));
+}
+
+static void _marshall_stats(writer &th, int value)
+{
+    marshallInt(th, value);
+}
+
+template<typename K, typename V>
+static void _marshall_stats(writer &th, const map<K, V> &stats)
+{
+    marshallInt(th, stats.size());
+    for (const auto &entry : stats)
+    {
+        _marshall_stat_key(th, entry.first);
+        _marshall_stats(th, entry.second);
+    }
+}
+
+// The fields of one object: the extremes are kept, and everything else
+// (counts, sums and sums of squares) adds up.
+static void _merge_stats(reader &th, map<string, int> &stats)
+{
+    for (int i = unmarshallInt(th); i > 0; --i)
+    {
+        const string field = unmarshallString(th);
+        const int value = unmarshallInt(th);
+        auto it = stats.find(field);
+        if (it == stats.end())
+            stats[field] = value;
+        else if (ends_with(field, "Min"))
+            it->second = min(it->second, value);
+        else if (ends_with(field, "Max"))
+            it->second = max(it->second, value);
+        else
+            it->second += value;
+    }
+}
+
+// Brand counts.
+static void _merge_stats(reader &th, map<int, int> &stats)
+{
+    for (int i = unmarshallInt(th); i > 0; --i)
+    {
+        const int brand = unmarshallInt(th);
+        stats[brand] += unmarshallInt(th);
+    }
+}
+
+template<typename K, typename V>
+static void _merge_stats(reader &th, map<K, V> &stats)
+{
+    for (int i = unmarshallInt(th); i > 0; --i)
+    {
+        K key;
+        _unmarshall_stat_key(th, key);
+        _merge_stats(th, stats[key]);
+    }
+}
+
+void objstat_marshall_worker_stats(writer &th)
+{
+    _marshall_stats(th, item_recs);
+    _marshall_stats(th, brand_recs);
+    _marshall_stats(th, monster_recs);
+    _marshall_stats(th, feature_recs);
+    _marshall_stats(th, spell_recs);
+}
+
+void objstat_merge_worker_stats(reader &th)
+{
+    _merge_stats(th, item_recs);
+    _merge_stats(th, brand_recs);
+    _merge_stats(th, monster_recs);
+    _merge_stats(th, feature_recs);
+    _merge_stats(th, spell_recs);
+}
+
 static FILE * _open_stat_file(string stat_file)
 {
     FILE *stat_fh = nullptr;
@@ -1392,7 +1502,13 @@ void objstat_generate_stats()
 
     _init_stats();
 
+    fflush(stdout);
+#ifdef UNIX
+    if (SysEnv.map_gen_jobs > 1 ? mapstat_build_levels_parallel()
+                                : mapstat_build_levels())
+#else
     if (mapstat_build_levels())
+#endif
     {
         _write_object_stats();
         printf("Object statistics complete.\n");
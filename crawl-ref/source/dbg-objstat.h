@@ -11,4 +11,9 @@ void objstat_generate_stats();
 void objstat_record_monster(const monster *mons);
 void objstat_record_feature(dungeon_feature_type feat_type, bool vault);
 void objstat_iteration_stats();
+
+class writer;
+class reader;
+void objstat_marshall_worker_stats(writer &th);
+void objstat_merge_worker_stats(reader &th);
 #endif
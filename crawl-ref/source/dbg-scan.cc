@@ -9,6 +9,7 @@
 
 #include <cerrno>
 #include <cmath>
+#include <set>
 #include <sstream>
 
 #include "artefact.h"
@@ -25,10 +26,12 @@
 #include "item-prop.h"
 #include "item-status-flag-type.h"
 #include "items.h"
+#include "level-id.h"
 #include "libutil.h"
 #include "maps.h"
 #include "message.h"
 #include "mon-util.h"
+#include "options.h"
 #include "shopping.h"
 #include "state.h"
 #include "stepdown.h"
@@ -41,167 +44,312 @@
 
 #ifdef DEBUG_ITEM_SCAN
 
-void debug_item_scan()
+// Walk the stack at pos, marking the items in it as visited.
+static void _check_item_stack(const coord_def &pos,
+                              FixedBitVector<MAX_ITEMS> &visited)
 {
-    int   i;
-    char  name[256];
-
-    FixedBitVector<MAX_ITEMS> visited;
-
-    // First we're going to check all the stacks on the level:
-    for (rectangle_iterator ri(0); ri; ++ri)
+    // Looking for infinite stacks (ie more links than items allowed)
+    // and for items which have bad coordinates (can't find their stack)
+    for (int obj = env.igrid(pos); obj != NON_ITEM; obj = env.item[obj].link)
     {
-        // Unlinked temporary items.
-        if (*ri == coord_def())
-            continue;
-
-        // Looking for infinite stacks (ie more links than items allowed)
-        // and for items which have bad coordinates (can't find their stack)
-        for (int obj = env.igrid(*ri); obj != NON_ITEM; obj = env.item[obj].link)
+        if (obj < 0 || obj > MAX_ITEMS)
         {
-            if (obj < 0 || obj > MAX_ITEMS)
+            if (env.igrid(pos) == obj)
             {
-                if (env.igrid(*ri) == obj)
-                {
-                    mprf(MSGCH_ERROR, "env.igrid has invalid item index %d "
-                                      "at (%d, %d)",
-                         obj, ri->x, ri->y);
-                }
-                else
-                {
-                    mprf(MSGCH_ERROR, "Item in stack at (%d, %d) has "
-                                      "invalid link %d",
-                         ri->x, ri->y, obj);
-                }
-                break;
+                mprf(MSGCH_ERROR, "env.igrid has invalid item index %d "
+                                  "at (%d, %d)",
+                     obj, pos.x, pos.y);
             }
-
-            // Check for invalid (zero quantity) items that are linked in.
-            if (!env.item[obj].defined())
+            else
             {
-                debug_dump_item(env.item[obj].name(DESC_PLAIN).c_str(), obj, env.item[obj],
-                           "Linked invalid item at (%d,%d)!", ri->x, ri->y);
+                mprf(MSGCH_ERROR, "Item in stack at (%d, %d) has "
+                                  "invalid link %d",
+                     pos.x, pos.y, obj);
             }
+            break;
+        }
 
-            // Check that item knows what stack it's in.
-            if (env.item[obj].pos != *ri)
-            {
-                debug_dump_item(env.item[obj].name(DESC_PLAIN).c_str(), obj, env.item[obj],
-                           "Item position incorrect at (%d,%d)!", ri->x, ri->y);
-            }
+        // Check for invalid (zero quantity) items that are linked in.
+        if (!env.item[obj].defined())
+        {
+            debug_dump_item(env.item[obj].name(DESC_PLAIN).c_str(), obj, env.item[obj],
+                       "Linked invalid item at (%d,%d)!", pos.x, pos.y);
+        }
 
-            // If we run into a premarked item we're in real trouble,
-            // this will also keep this from being an infinite loop.
-            if (visited[obj])
-            {
-                mprf(MSGCH_ERROR,
-                     "Potential INFINITE STACK at (%d, %d)", ri->x, ri->y);
-                break;
-            }
-            visited.set(obj);
+        // Check that item knows what stack it's in.
+        if (env.item[obj].pos != pos)
+        {
+            debug_dump_item(env.item[obj].name(DESC_PLAIN).c_str(), obj, env.item[obj],
+                       "Item position incorrect at (%d,%d)!", pos.x, pos.y);
+        }
+
+        // If we run into a premarked item we're in real trouble,
+        // this will also keep this from being an infinite loop.
+        if (visited[obj])
+        {
+            mprf(MSGCH_ERROR,
+                 "Potential INFINITE STACK at (%d, %d)", pos.x, pos.y);
+            break;
         }
+        visited.set(obj);
     }
+}
 
-    // Now scan all the items on the level:
-    for (i = 0; i < MAX_ITEMS; ++i)
-    {
-        if (!env.item[i].defined())
-            continue;
+// Check item i, whose square's stack (if it's on the floor) should already
+// have been walked.
+static void _check_item(int i, const FixedBitVector<MAX_ITEMS> &visited)
+{
+    if (!env.item[i].defined())
+        return;
 
-        strlcpy(name, env.item[i].name(DESC_PLAIN).c_str(), sizeof(name));
+    char name[256];
+    strlcpy(name, env.item[i].name(DESC_PLAIN).c_str(), sizeof(name));
 
-        const monster* mon = env.item[i].holding_monster();
+    const monster* mon = env.item[i].holding_monster();
 
-        // Don't check (-1, -1) player items or (-2, -2) monster items
-        // (except to make sure that the monster is alive).
-        if (env.item[i].pos.origin())
-            debug_dump_item(name, i, env.item[i], "Unlinked temporary item:");
-        else if (mon != nullptr && mon->type == MONS_NO_MONSTER)
-            debug_dump_item(name, i, env.item[i], "Unlinked item held by dead monster:");
-        else if ((env.item[i].pos.x > 0 || env.item[i].pos.y > 0) && !visited[i])
-        {
-            debug_dump_item(name, i, env.item[i], "Unlinked item:");
+    // Don't check (-1, -1) player items or (-2, -2) monster items
+    // (except to make sure that the monster is alive).
+    if (env.item[i].pos.origin())
+        debug_dump_item(name, i, env.item[i], "Unlinked temporary item:");
+    else if (mon != nullptr && mon->type == MONS_NO_MONSTER)
+        debug_dump_item(name, i, env.item[i], "Unlinked item held by dead monster:");
+    else if ((env.item[i].pos.x > 0 || env.item[i].pos.y > 0) && !visited[i])
+    {
+        debug_dump_item(name, i, env.item[i], "Unlinked item:");
 
-            if (!in_bounds(env.item[i].pos))
-            {
-                mprf(MSGCH_ERROR, "Item position (%d, %d) is out of bounds",
-                     env.item[i].pos.x, env.item[i].pos.y);
-            }
-            else
-            {
-                mprf("env.igrid(%d,%d) = %d",
-                     env.item[i].pos.x, env.item[i].pos.y, env.igrid(env.item[i].pos));
-            }
+        if (!in_bounds(env.item[i].pos))
+        {
+            mprf(MSGCH_ERROR, "Item position (%d, %d) is out of bounds",
+                 env.item[i].pos.x, env.item[i].pos.y);
+        }
+        else
+        {
+            mprf("env.igrid(%d,%d) = %d",
+                 env.item[i].pos.x, env.item[i].pos.y, env.igrid(env.item[i].pos));
+        }
 
-            // Let's check to see if it's an errant monster object:
-            for (int j = 0; j < MAX_MONSTERS; ++j)
+        // Let's check to see if it's an errant monster object:
+        for (int j = 0; j < MAX_MONSTERS; ++j)
+        {
+            monster& mons(env.mons[j]);
+            for (mon_inv_iterator ii(mons); ii; ++ii)
             {
-                monster& mons(env.mons[j]);
-                for (mon_inv_iterator ii(mons); ii; ++ii)
+                if (ii->index() == i)
                 {
-                    if (ii->index() == i)
-                    {
-                        mprf("Held by monster #%d: %s at (%d,%d)",
-                             j, mons.name(DESC_A, true).c_str(),
-                             mons.pos().x, mons.pos().y);
-                    }
+                    mprf("Held by monster #%d: %s at (%d,%d)",
+                         j, mons.name(DESC_A, true).c_str(),
+                         mons.pos().x, mons.pos().y);
                 }
             }
         }
+    }
 
-        // Current bad items of interest:
-        //   -- armour and weapons with large enchantments/illegal special vals
-        //
-        //   -- items described as questionable (the class 100 bug)
-        //
-        //   -- eggplant is an illegal throwing weapon
-        //
-        //   -- items described as buggy (typically adjectives out of range)
-        //      (note: covers buggy, bugginess, buggily, whatever else)
-        //
-        // Theoretically some of these could match random names.
-        //
-        if (strstr(name, "questionable") != nullptr
-            || strstr(name, "eggplant") != nullptr
-            || strstr(name, "buggy") != nullptr
-            || strstr(name, "buggi") != nullptr)
-        {
-            debug_dump_item(name, i, env.item[i], "Bad item:");
-        }
-        else if (abs(env.item[i].plus) > 30 &&
-                    (env.item[i].base_type == OBJ_WEAPONS
-                     || env.item[i].base_type == OBJ_ARMOUR))
-        {
-            debug_dump_item(name, i, env.item[i], "Bad plus:");
-        }
-        else if (!is_artefact(env.item[i])
-                 && (env.item[i].base_type == OBJ_WEAPONS
-                        && env.item[i].brand >= NUM_SPECIAL_WEAPONS
-                     || env.item[i].base_type == OBJ_ARMOUR
-                        && env.item[i].brand >= NUM_SPECIAL_ARMOURS))
-        {
-            debug_dump_item(name, i, env.item[i], "Bad special value:");
-        }
-        else if (env.item[i].flags & ISFLAG_SUMMONED && in_bounds(env.item[i].pos))
-            debug_dump_item(name, i, env.item[i], "Summoned item on floor:");
+    // Current bad items of interest:
+    //   -- armour and weapons with large enchantments/illegal special vals
+    //
+    //   -- items described as questionable (the class 100 bug)
+    //
+    //   -- eggplant is an illegal throwing weapon
+    //
+    //   -- items described as buggy (typically adjectives out of range)
+    //      (note: covers buggy, bugginess, buggily, whatever else)
+    //
+    // Theoretically some of these could match random names.
+    //
+    if (strstr(name, "questionable") != nullptr
+        || strstr(name, "eggplant") != nullptr
+        || strstr(name, "buggy") != nullptr
+        || strstr(name, "buggi") != nullptr)
+    {
+        debug_dump_item(name, i, env.item[i], "Bad item:");
+    }
+    else if (abs(env.item[i].plus) > 30 &&
+                (env.item[i].base_type == OBJ_WEAPONS
+                 || env.item[i].base_type == OBJ_ARMOUR))
+    {
+        debug_dump_item(name, i, env.item[i], "Bad plus:");
+    }
+    else if (!is_artefact(env.item[i])
+             && (env.item[i].base_type == OBJ_WEAPONS
+                    && env.item[i].brand >= NUM_SPECIAL_WEAPONS
+                 || env.item[i].base_type == OBJ_ARMOUR
+                    && env.item[i].brand >= NUM_SPECIAL_ARMOURS))
+    {
+        debug_dump_item(name, i, env.item[i], "Bad special value:");
     }
+    else if (env.item[i].flags & ISFLAG_SUMMONED && in_bounds(env.item[i].pos))
+        debug_dump_item(name, i, env.item[i], "Summoned item on floor:");
+}
+
+// Quickly scan a monster for "program bug"s.
+static void _check_monster_name(int i)
+{
+    const monster& mons = env.mons[i];
 
-    // Quickly scan monsters for "program bug"s.
-    for (i = 0; i < MAX_MONSTERS; ++i)
+    if (mons.type == MONS_NO_MONSTER)
+        return;
+
+    if (mons.name(DESC_PLAIN, true).find("questionable") != string::npos)
     {
-        const monster& mons = env.mons[i];
+        mprf(MSGCH_ERROR, "Program bug detected!");
+        mprf(MSGCH_ERROR,
+             "Buggy monster detected: monster #%d; position (%d,%d)",
+             i, mons.pos().x, mons.pos().y);
+    }
+}
+
+void debug_item_scan()
+{
+    FixedBitVector<MAX_ITEMS> visited;
 
-        if (mons.type == MONS_NO_MONSTER)
+    // First we're going to check all the stacks on the level:
+    for (rectangle_iterator ri(0); ri; ++ri)
+    {
+        // Unlinked temporary items.
+        if (*ri == coord_def())
             continue;
 
-        if (mons.name(DESC_PLAIN, true).find("questionable") != string::npos)
+        _check_item_stack(*ri, visited);
+    }
+
+    // Now scan all the items on the level:
+    for (int i = 0; i < MAX_ITEMS; ++i)
+        _check_item(i, visited);
+
+    for (int i = 0; i < MAX_MONSTERS; ++i)
+        _check_monster_name(i);
+}
+
+// What the incremental scan remembers of an item from the last scan. If
+// any of it has changed, the item has been touched since.
+struct item_scan_mark
+{
+    object_class_type base_type;
+    uint8_t sub_type;
+    short plus;
+    short plus2;
+    int special;
+    short quantity;
+    iflags_t flags;
+    coord_def pos;
+    short link;
+
+    item_scan_mark() = default;
+    item_scan_mark(const item_def &item)
+        : base_type(item.base_type), sub_type(item.sub_type),
+          plus(item.plus), plus2(item.plus2), special(item.special),
+          quantity(item.quantity), flags(item.flags), pos(item.pos),
+          link(item.link)
+    {
+    }
+
+    bool operator==(const item_scan_mark &other) const
+    {
+        return base_type == other.base_type && sub_type == other.sub_type
+               && plus == other.plus && plus2 == other.plus2
+               && special == other.special && quantity == other.quantity
+               && flags == other.flags && pos == other.pos
+               && link == other.link;
+    }
+};
+
+// And of a monster, as far as its name goes.
+struct mons_name_mark
+{
+    monster_type type;
+    monster_type base_type;
+    mid_t mid;
+
+    mons_name_mark() = default;
+    mons_name_mark(const monster &mons)
+        : type(mons.type), base_type(mons.base_monster), mid(mons.mid)
+    {
+    }
+
+    bool operator==(const mons_name_mark &other) const
+    {
+        return type == other.type && base_type == other.base_type
+               && mid == other.mid;
+    }
+};
+
+static level_id _item_scan_level;
+static int _item_scans_since_full = 0;
+static FixedArray<int, GXM, GYM> _item_scan_igrid;
+static FixedVector<item_scan_mark, MAX_ITEMS> _item_scan_items;
+static FixedVector<mons_name_mark, MAX_MONSTERS> _item_scan_names;
+
+static void _mark_item_scan()
+{
+    _item_scan_level = level_id::current();
+    _item_scans_since_full = 0;
+    for (rectangle_iterator ri(0); ri; ++ri)
+        _item_scan_igrid(*ri) = env.igrid(*ri);
+    for (int i = 0; i < MAX_ITEMS; ++i)
+        _item_scan_items[i] = item_scan_mark(env.item[i]);
+    for (int i = 0; i < MAX_MONSTERS; ++i)
+        _item_scan_names[i] = mons_name_mark(env.mons[i]);
+}
+
+/**
+ * Check the stacks and items that have changed since the last call, and
+ * monsters whose names might have; every debug_scan_interval calls, or on a
+ * new level, check everything as debug_item_scan() does.
+ */
+void debug_item_scan_changes()
+{
+    if (!Options.debug_scan_interval
+        || ++_item_scans_since_full >= Options.debug_scan_interval
+        || _item_scan_level != level_id::current())
+    {
+        debug_item_scan();
+        _mark_item_scan();
+        return;
+    }
+
+    FixedBitVector<MAX_ITEMS> visited;
+    FixedBitVector<MAX_ITEMS> touched_items;
+    set<coord_def> touched_stacks;
+
+    for (rectangle_iterator ri(0); ri; ++ri)
+    {
+        if (*ri != coord_def() && _item_scan_igrid(*ri) != env.igrid(*ri))
         {
-            mprf(MSGCH_ERROR, "Program bug detected!");
-            mprf(MSGCH_ERROR,
-                 "Buggy monster detected: monster #%d; position (%d,%d)",
-                 i, mons.pos().x, mons.pos().y);
+            touched_stacks.insert(*ri);
+            _item_scan_igrid(*ri) = env.igrid(*ri);
         }
     }
+
+    for (int i = 0; i < MAX_ITEMS; ++i)
+    {
+        const item_scan_mark mark(env.item[i]);
+        if (mark == _item_scan_items[i])
+            continue;
+
+        // An item leaving a stack or joining one touches both.
+        touched_items.set(i);
+        if (in_bounds(_item_scan_items[i].pos))
+            touched_stacks.insert(_item_scan_items[i].pos);
+        if (in_bounds(mark.pos))
+            touched_stacks.insert(mark.pos);
+        _item_scan_items[i] = mark;
+    }
+
+    for (const coord_def &pos : touched_stacks)
+        _check_item_stack(pos, visited);
+
+    for (int i = 0; i < MAX_ITEMS; ++i)
+        if (touched_items[i])
+            _check_item(i, visited);
+
+    for (int i = 0; i < MAX_MONSTERS; ++i)
+    {
+        const mons_name_mark mark(env.mons[i]);
+        if (mark == _item_scan_names[i])
+            continue;
+        _check_monster_name(i);
+        _item_scan_names[i] = mark;
+    }
 }
 #endif
 
@@ -265,244 +413,240 @@ static string _vault_desc(const coord_def pos)
     return out;
 }
 
-void debug_mons_scan()
+// What a monster scan found, for the report at the end of it.
+struct mons_scan_result
 {
     vector<coord_def> bogus_pos;
     vector<int>       bogus_idx;
-
+    vector<int>       floating_mons;
+    FixedBitVector<MAX_MONSTERS> is_floating;
     bool warned = false;
-    for (int y = 0; y < GYM; ++y)
-        for (int x = 0; x < GXM; ++x)
+};
+
+static void _check_mgrid_cell(const coord_def &pos, mons_scan_result &res)
+{
+    const int mons = env.mgrid(pos);
+    if (mons == NON_MONSTER)
+        return;
+
+    if (invalid_monster_index(mons))
+    {
+        mprf(MSGCH_ERROR, "env.mgrid at (%d, %d) has invalid monster "
+                          "index %d",
+             pos.x, pos.y, mons);
+        return;
+    }
+
+    const monster* m = &env.mons[mons];
+    if (m->pos() != pos)
+    {
+        res.bogus_pos.push_back(pos);
+        res.bogus_idx.push_back(mons);
+
+        _announce_level_prob(res.warned);
+        mprf(MSGCH_WARN,
+             "Bogosity: env.mgrid at (%d,%d) points at %s, "
+             "but monster is at (%d,%d)",
+             pos.x, pos.y, m->name(DESC_PLAIN, true).c_str(),
+             m->pos().x, m->pos().y);
+        if (!m->alive())
+            mprf(MSGCH_WARN, "Additionally, it isn't alive.");
+        res.warned = true;
+    }
+    else if (!m->alive())
+    {
+        _announce_level_prob(res.warned);
+        mprf_nocap(MSGCH_ERROR,
+             "env.mgrid at (%d,%d) points at dead monster %s",
+             pos.x, pos.y, m->name(DESC_PLAIN, true).c_str());
+        res.warned = true;
+    }
+}
+
+static void _check_monster(int i, mons_scan_result &res)
+{
+    const monster* m = &env.mons[i];
+    if (!m->alive())
+        return;
+
+    ASSERT(m->mid > 0);
+    coord_def pos = m->pos();
+
+    if (invalid_monster_type(m->type))
+    {
+        mprf(MSGCH_ERROR, "Bogus monster type %d at (%d, %d), midx = %d",
+                          m->type, pos.x, pos.y, i);
+    }
+
+    if (!in_bounds(pos))
+    {
+        mprf(MSGCH_ERROR, "Out of bounds monster: %s at (%d, %d), "
+                          "midx = %d",
+             m->full_name(DESC_PLAIN).c_str(),
+             pos.x, pos.y, i);
+    }
+    else if (env.mgrid(pos) != i)
+    {
+        res.floating_mons.push_back(i);
+        res.is_floating.set(i);
+
+        _announce_level_prob(res.warned);
+        mprf(MSGCH_WARN, "Floating monster: %s at (%d,%d), midx = %d",
+             m->full_name(DESC_PLAIN).c_str(),
+             pos.x, pos.y, i);
+        res.warned = true;
+        for (int j = 0; j < MAX_MONSTERS; ++j)
         {
-            const int mons = env.mgrid[x][y];
-            if (mons == NON_MONSTER)
+            if (i == j)
                 continue;
 
-            if (invalid_monster_index(mons))
-            {
-                mprf(MSGCH_ERROR, "env.mgrid at (%d, %d) has invalid monster "
-                                  "index %d",
-                     x, y, mons);
+            const monster* m2 = &env.mons[j];
+
+            if (m2->pos() != m->pos())
                 continue;
-            }
 
-            const monster* m = &env.mons[mons];
-            const coord_def pos(x, y);
-            if (m->pos() != pos)
+            string full = m2->full_name(DESC_PLAIN);
+            if (m2->alive())
             {
-                bogus_pos.push_back(pos);
-                bogus_idx.push_back(mons);
-
-                _announce_level_prob(warned);
-                mprf(MSGCH_WARN,
-                     "Bogosity: env.mgrid at (%d,%d) points at %s, "
-                     "but monster is at (%d,%d)",
-                     x, y, m->name(DESC_PLAIN, true).c_str(),
-                     m->pos().x, m->pos().y);
-                if (!m->alive())
-                    mprf(MSGCH_WARN, "Additionally, it isn't alive.");
-                warned = true;
+                mprf(MSGCH_WARN, "Also at (%d, %d): %s, midx = %d",
+                     pos.x, pos.y, full.c_str(), j);
             }
-            else if (!m->alive())
+            else if (m2->type != MONS_NO_MONSTER)
             {
-                _announce_level_prob(warned);
-                mprf_nocap(MSGCH_ERROR,
-                     "env.mgrid at (%d,%d) points at dead monster %s",
-                     x, y, m->name(DESC_PLAIN, true).c_str());
-                warned = true;
+                mprf(MSGCH_WARN, "Dead mon also at (%d, %d): %s,"
+                                 "midx = %d",
+                     pos.x, pos.y, full.c_str(), j);
             }
         }
+    } // if (env.mgrid(m->pos()) != i)
 
-    ASSERT(you.type == MONS_PLAYER);
-    ASSERT(you.mid == MID_PLAYER);
-
-    vector<int> floating_mons;
-    bool             is_floating[MAX_MONSTERS];
-
-    for (int i = 0; i < MAX_MONSTERS; ++i)
+    if (feat_is_wall(env.grid(pos)))
     {
-        is_floating[i] = false;
+#if defined(DEBUG_FATAL)
+        // if we're going to dump, point out the culprit
+        env.pgrid(pos) |= FPROP_HIGHLIGHT;
+#endif
+        mprf(MSGCH_ERROR, "Monster %s in %s at (%d, %d)%s",
+             m->full_name(DESC_PLAIN).c_str(),
+             dungeon_feature_name(env.grid(pos)),
+             pos.x, pos.y,
+             _vault_desc(pos).c_str());
+    }
 
-        const monster* m = &env.mons[i];
-        if (!m->alive())
+    for (int j = 0; j < NUM_MONSTER_SLOTS; ++j)
+    {
+        const int idx = m->inv[j];
+        if (idx == NON_ITEM)
             continue;
 
-        ASSERT(m->mid > 0);
-        coord_def pos = m->pos();
-
-        if (invalid_monster_type(m->type))
+        if (idx < 0 || idx > MAX_ITEMS)
         {
-            mprf(MSGCH_ERROR, "Bogus monster type %d at (%d, %d), midx = %d",
-                              m->type, pos.x, pos.y, i);
+            mprf(MSGCH_ERROR, "Monster %s (%d, %d) has invalid item "
+                              "index %d in slot %d.",
+                 m->full_name(DESC_PLAIN).c_str(),
+                 pos.x, pos.y, idx, j);
+            continue;
         }
+        item_def &item(env.item[idx]);
 
-        if (!in_bounds(pos))
+        if (!item.defined())
         {
-            mprf(MSGCH_ERROR, "Out of bounds monster: %s at (%d, %d), "
-                              "midx = %d",
+            _announce_level_prob(res.warned);
+            res.warned = true;
+            mprf(MSGCH_WARN, "Monster %s (%d, %d) holding invalid item in "
+                             "slot %d (midx = %d)",
                  m->full_name(DESC_PLAIN).c_str(),
-                 pos.x, pos.y, i);
+                 pos.x, pos.y, j, i);
+            continue;
         }
-        else if (env.mgrid(pos) != i)
-        {
-            floating_mons.push_back(i);
-            is_floating[i] = true;
-
-            _announce_level_prob(warned);
-            mprf(MSGCH_WARN, "Floating monster: %s at (%d,%d), midx = %d",
-                 m->full_name(DESC_PLAIN).c_str(),
-                 pos.x, pos.y, i);
-            warned = true;
-            for (int j = 0; j < MAX_MONSTERS; ++j)
-            {
-                if (i == j)
-                    continue;
-
-                const monster* m2 = &env.mons[j];
 
-                if (m2->pos() != m->pos())
-                    continue;
+        const monster* holder = item.holding_monster();
 
-                string full = m2->full_name(DESC_PLAIN);
-                if (m2->alive())
-                {
-                    mprf(MSGCH_WARN, "Also at (%d, %d): %s, midx = %d",
-                         pos.x, pos.y, full.c_str(), j);
-                }
-                else if (m2->type != MONS_NO_MONSTER)
-                {
-                    mprf(MSGCH_WARN, "Dead mon also at (%d, %d): %s,"
-                                     "midx = %d",
-                         pos.x, pos.y, full.c_str(), j);
-                }
-            }
-        } // if (env.mgrid(m->pos()) != i)
-
-        if (feat_is_wall(env.grid(pos)))
+        if (holder == nullptr)
         {
-#if defined(DEBUG_FATAL)
-            // if we're going to dump, point out the culprit
-            env.pgrid(pos) |= FPROP_HIGHLIGHT;
-#endif
-            mprf(MSGCH_ERROR, "Monster %s in %s at (%d, %d)%s",
-                 m->full_name(DESC_PLAIN).c_str(),
-                 dungeon_feature_name(env.grid(pos)),
-                 pos.x, pos.y,
-                 _vault_desc(pos).c_str());
+            _announce_level_prob(res.warned);
+            res.warned = true;
+            debug_dump_item(item.name(DESC_PLAIN, false, true).c_str(),
+                        idx, item,
+                       "Monster %s (%d, %d) holding non-monster "
+                       "item (midx = %d)",
+                       m->full_name(DESC_PLAIN).c_str(),
+                       pos.x, pos.y, i);
+            continue;
         }
 
-        for (int j = 0; j < NUM_MONSTER_SLOTS; ++j)
+        if (holder != m)
         {
-            const int idx = m->inv[j];
-            if (idx == NON_ITEM)
-                continue;
-
-            if (idx < 0 || idx > MAX_ITEMS)
-            {
-                mprf(MSGCH_ERROR, "Monster %s (%d, %d) has invalid item "
-                                  "index %d in slot %d.",
-                     m->full_name(DESC_PLAIN).c_str(),
-                     pos.x, pos.y, idx, j);
-                continue;
-            }
-            item_def &item(env.item[idx]);
-
-            if (!item.defined())
-            {
-                _announce_level_prob(warned);
-                warned = true;
-                mprf(MSGCH_WARN, "Monster %s (%d, %d) holding invalid item in "
-                                 "slot %d (midx = %d)",
-                     m->full_name(DESC_PLAIN).c_str(),
-                     pos.x, pos.y, j, i);
-                continue;
-            }
-
-            const monster* holder = item.holding_monster();
-
-            if (holder == nullptr)
-            {
-                _announce_level_prob(warned);
-                warned = true;
-                debug_dump_item(item.name(DESC_PLAIN, false, true).c_str(),
-                            idx, item,
-                           "Monster %s (%d, %d) holding non-monster "
-                           "item (midx = %d)",
-                           m->full_name(DESC_PLAIN).c_str(),
-                           pos.x, pos.y, i);
-                continue;
-            }
+            _announce_level_prob(res.warned);
+            res.warned = true;
+            mprf(MSGCH_WARN, "Monster %s (%d, %d) [midx = %d] holding "
+                             "item %s, but item thinks it's held by "
+                             "monster %s (%d, %d) [midx = %d]",
+                 m->full_name(DESC_PLAIN).c_str(),
+                 m->pos().x, m->pos().y, i,
+                 item.name(DESC_PLAIN).c_str(),
+                 holder->full_name(DESC_PLAIN).c_str(),
+                 holder->pos().x, holder->pos().y, holder->mindex());
 
-            if (holder != m)
+            bool found = false;
+            for (int k = 0; k < NUM_MONSTER_SLOTS; ++k)
             {
-                _announce_level_prob(warned);
-                warned = true;
-                mprf(MSGCH_WARN, "Monster %s (%d, %d) [midx = %d] holding "
-                                 "item %s, but item thinks it's held by "
-                                 "monster %s (%d, %d) [midx = %d]",
-                     m->full_name(DESC_PLAIN).c_str(),
-                     m->pos().x, m->pos().y, i,
-                     item.name(DESC_PLAIN).c_str(),
-                     holder->full_name(DESC_PLAIN).c_str(),
-                     holder->pos().x, holder->pos().y, holder->mindex());
-
-                bool found = false;
-                for (int k = 0; k < NUM_MONSTER_SLOTS; ++k)
+                if (holder->inv[k] == idx)
                 {
-                    if (holder->inv[k] == idx)
-                    {
-                        mprf(MSGCH_WARN, "Other monster thinks it's holding the item, too.");
-                        found = true;
-                        break;
-                    }
+                    mprf(MSGCH_WARN, "Other monster thinks it's holding the item, too.");
+                    found = true;
+                    break;
                 }
-                if (!found)
-                    mprf(MSGCH_WARN, "Other monster isn't holding it, though.");
-            } // if (holder != m)
-        } // for (int j = 0; j < NUM_MONSTER_SLOTS; j++)
+            }
+            if (!found)
+                mprf(MSGCH_WARN, "Other monster isn't holding it, though.");
+        } // if (holder != m)
+    } // for (int j = 0; j < NUM_MONSTER_SLOTS; j++)
 
-        monster* m1 = monster_by_mid(m->mid);
-        if (m1 != m)
+    monster* m1 = monster_by_mid(m->mid);
+    if (m1 != m)
+    {
+        if (!m1)
+            die("mid cache bogosity: no monster for %d", m->mid);
+        else if (m1->mid == m->mid)
         {
-            if (!m1)
-                die("mid cache bogosity: no monster for %d", m->mid);
-            else if (m1->mid == m->mid)
-            {
-                mprf(MSGCH_ERROR,
-                     "Error: monster %s(%d) has same mid as %s(%d) (%d)",
-                     m->name(DESC_PLAIN, true).c_str(), m->mindex(),
-                     m1->name(DESC_PLAIN, true).c_str(), m1->mindex(), m->mid);
-            }
-            else
-                die("mid cache bogosity: wanted %d got %d", m->mid, m1->mid);
+            mprf(MSGCH_ERROR,
+                 "Error: monster %s(%d) has same mid as %s(%d) (%d)",
+                 m->name(DESC_PLAIN, true).c_str(), m->mindex(),
+                 m1->name(DESC_PLAIN, true).c_str(), m1->mindex(), m->mid);
         }
+        else
+            die("mid cache bogosity: wanted %d got %d", m->mid, m1->mid);
+    }
 
-        if (you.constricted_by == m->mid && (!m->constricting
-              || m->constricting->find(MID_PLAYER) == m->constricting->end()))
+    if (you.constricted_by == m->mid && (!m->constricting
+          || m->constricting->find(MID_PLAYER) == m->constricting->end()))
+    {
+        mprf(MSGCH_ERROR, "Error: constricting[you] entry missing for monster %s(%d)",
+             m->name(DESC_PLAIN, true).c_str(), m->mindex());
+    }
+
+    if (m->constricted_by)
+    {
+        const actor *h = actor_by_mid(m->constricted_by);
+        if (!h)
         {
-            mprf(MSGCH_ERROR, "Error: constricting[you] entry missing for monster %s(%d)",
+            mprf(MSGCH_ERROR, "Error: constrictor missing for monster %s(%d)",
                  m->name(DESC_PLAIN, true).c_str(), m->mindex());
         }
-
-        if (m->constricted_by)
+        else if (!h->constricting
+                 || h->constricting->find(m->mid) == h->constricting->end())
         {
-            const actor *h = actor_by_mid(m->constricted_by);
-            if (!h)
-            {
-                mprf(MSGCH_ERROR, "Error: constrictor missing for monster %s(%d)",
-                     m->name(DESC_PLAIN, true).c_str(), m->mindex());
-            }
-            else if (!h->constricting
-                     || h->constricting->find(m->mid) == h->constricting->end())
-            {
-                mprf(MSGCH_ERROR, "Error: constricting[%s(mindex=%d mid=%d)] "
-                                  "entry missing for monster %s(mindex=%d mid=%d)",
-                     m->name(DESC_PLAIN, true).c_str(), m->mindex(), m->mid,
-                     h->name(DESC_PLAIN, true).c_str(), h->mindex(), h->mid);
-            }
+            mprf(MSGCH_ERROR, "Error: constricting[%s(mindex=%d mid=%d)] "
+                              "entry missing for monster %s(mindex=%d mid=%d)",
+                 m->name(DESC_PLAIN, true).c_str(), m->mindex(), m->mid,
+                 h->name(DESC_PLAIN, true).c_str(), h->mindex(), h->mid);
         }
-    } // for (int i = 0; i < MAX_MONSTERS; ++i)
+    }
+}
 
+static void _check_mid_cache()
+{
     for (const auto &entry : env.mid_cache)
     {
         unsigned short idx = entry.second;
@@ -515,7 +659,11 @@ void debug_mons_scan()
                 m.mid);
         }
     }
+}
 
+// Check the player's square, and say where any problems found were.
+static void _finish_mons_scan(const mons_scan_result &res)
+{
     if (in_bounds(you.pos()))
         if (const monster* m = monster_at(you.pos()))
             if (!m->submerged() && !fedhas_passthrough(m))
@@ -525,7 +673,7 @@ void debug_mons_scan()
             }
 
     // No problems?
-    if (!warned)
+    if (!res.warned)
         return;
 
     // If this wasn't the result of generating a level then there's nothing
@@ -548,7 +696,7 @@ void debug_mons_scan()
 
     mpr("");
 
-    for (int idx : floating_mons)
+    for (int idx : res.floating_mons)
     {
         const monster* mon = &env.mons[idx];
         vector<string> vaults = _in_vaults(mon->pos());
@@ -568,10 +716,10 @@ void debug_mons_scan()
 
     mpr("");
 
-    for (unsigned int i = 0; i < bogus_pos.size(); ++i)
+    for (unsigned int i = 0; i < res.bogus_pos.size(); ++i)
     {
-        const coord_def pos = bogus_pos[i];
-        const int       idx = bogus_idx[i];
+        const coord_def pos = res.bogus_pos[i];
+        const int       idx = res.bogus_idx[i];
         const monster* mon = &env.mons[idx];
 
         string str = make_stringf("Bogus env.mgrid (%d, %d) pointing to %s", pos.x,
@@ -588,7 +736,7 @@ void debug_mons_scan()
         }
 
         // Don't report on same monster twice.
-        if (is_floating[idx])
+        if (res.is_floating[idx])
             continue;
 
         str    = "Monster pointed to";
@@ -607,6 +755,126 @@ void debug_mons_scan()
     // Force the dev to notice problems. :P
     more();
 }
+
+void debug_mons_scan()
+{
+    mons_scan_result res;
+
+    for (int y = 0; y < GYM; ++y)
+        for (int x = 0; x < GXM; ++x)
+            _check_mgrid_cell(coord_def(x, y), res);
+
+    ASSERT(you.type == MONS_PLAYER);
+    ASSERT(you.mid == MID_PLAYER);
+
+    for (int i = 0; i < MAX_MONSTERS; ++i)
+        _check_monster(i, res);
+
+    _check_mid_cache();
+    _finish_mons_scan(res);
+}
+
+// What the incremental scan remembers of a monster from the last scan.
+struct mons_scan_mark
+{
+    monster_type type;
+    mid_t mid;
+    coord_def pos;
+    FixedVector<short, NUM_MONSTER_SLOTS> inv;
+    mid_t constricted_by;
+
+    mons_scan_mark() = default;
+    mons_scan_mark(const monster &mons)
+        : type(mons.type), mid(mons.mid), pos(mons.pos()), inv(mons.inv),
+          constricted_by(mons.constricted_by)
+    {
+    }
+
+    bool operator==(const mons_scan_mark &other) const
+    {
+        if (type != other.type || mid != other.mid || pos != other.pos
+            || constricted_by != other.constricted_by)
+        {
+            return false;
+        }
+        for (int i = 0; i < NUM_MONSTER_SLOTS; ++i)
+            if (inv[i] != other.inv[i])
+                return false;
+        return true;
+    }
+};
+
+static level_id _mons_scan_level;
+static int _mons_scans_since_full = 0;
+static FixedArray<unsigned short, GXM, GYM> _mons_scan_mgrid;
+static FixedVector<mons_scan_mark, MAX_MONSTERS> _mons_scan_mons;
+
+static void _mark_mons_scan()
+{
+    _mons_scan_level = level_id::current();
+    _mons_scans_since_full = 0;
+    for (rectangle_iterator ri(0); ri; ++ri)
+        _mons_scan_mgrid(*ri) = env.mgrid(*ri);
+    for (int i = 0; i < MAX_MONSTERS; ++i)
+        _mons_scan_mons[i] = mons_scan_mark(env.mons[i]);
+}
+
+/**
+ * Check the squares of env.mgrid and the monsters that have changed since
+ * the last call; every debug_scan_interval calls, or on a new level, check
+ * everything as debug_mons_scan() does.
+ */
+void debug_mons_scan_changes()
+{
+    if (!Options.debug_scan_interval
+        || ++_mons_scans_since_full >= Options.debug_scan_interval
+        || _mons_scan_level != level_id::current())
+    {
+        debug_mons_scan();
+        _mark_mons_scan();
+        return;
+    }
+
+    mons_scan_result res;
+    set<coord_def> touched_cells;
+
+    for (rectangle_iterator ri(0); ri; ++ri)
+    {
+        if (_mons_scan_mgrid(*ri) != env.mgrid(*ri))
+        {
+            touched_cells.insert(*ri);
+            _mons_scan_mgrid(*ri) = env.mgrid(*ri);
+        }
+    }
+
+    FixedBitVector<MAX_MONSTERS> touched_mons;
+    for (int i = 0; i < MAX_MONSTERS; ++i)
+    {
+        const mons_scan_mark mark(env.mons[i]);
+        if (mark == _mons_scan_mons[i])
+            continue;
+
+        // A monster that moved touches the squares it left and entered.
+        touched_mons.set(i);
+        if (in_bounds(_mons_scan_mons[i].pos))
+            touched_cells.insert(_mons_scan_mons[i].pos);
+        if (in_bounds(mark.pos))
+            touched_cells.insert(mark.pos);
+        _mons_scan_mons[i] = mark;
+    }
+
+    for (const coord_def &pos : touched_cells)
+        _check_mgrid_cell(pos, res);
+
+    ASSERT(you.type == MONS_PLAYER);
+    ASSERT(you.mid == MID_PLAYER);
+
+    for (int i = 0; i < MAX_MONSTERS; ++i)
+        if (touched_mons[i])
+            _check_monster(i, res);
+
+    _finish_mons_scan(res);
+}
 #endif
 
 /**
@@ -6,5 +6,7 @@
 #pragma once
 
 void debug_item_scan();
+void debug_item_scan_changes();
 void debug_mons_scan();
+void debug_mons_scan_changes();
 void check_map_validity();
@@ -7,10 +7,13 @@
 
 #include "dbg-util.h"
 
+#include "act-iter.h"
 #include "artefact.h"
+#include "coordit.h"
 #include "directn.h"
 #include "dungeon.h"
 #include "format.h"
+#include "hash.h"
 #include "item-name.h"
 #include "libutil.h"
 #include "macro.h"
@@ -68,6 +71,59 @@ vector<string> level_vault_names(bool force_all)
     return result;
 }
 
+static uint64_t _hash_string(uint64_t hash, const string &str)
+{
+    return hash3(hash, str.size(), hash32(str.data(), str.size()));
+}
+
+static uint64_t _hash_item(uint64_t hash, const item_def &item)
+{
+    hash = hash3(hash, item.base_type, item.sub_type);
+    hash = hash3(hash, item.plus, item.plus2);
+    hash = hash3(hash, item.special, item.rnd);
+    hash = hash3(hash, item.quantity, item.flags);
+    return hash3(hash, item.pos.x, item.pos.y);
+}
+
+/**
+ * A hash of what was generated on the current level: the features, shops,
+ * items and monsters. The same seed should give every level the same hash
+ * in every build; see scripts/seed_hashes.lua.
+ */
+uint64_t level_hash()
+{
+    uint64_t hash = hash3(you.where_are_you, you.depth, 0);
+
+    for (rectangle_iterator ri(0); ri; ++ri)
+    {
+        hash = hash3(hash, env.grid(*ri), env.pgrid(*ri).flags);
+        const shop_struct *shop = shop_at(*ri);
+        if (!shop)
+            continue;
+        hash = hash3(hash, shop->type, shop->greed);
+        hash = _hash_string(hash, shop->shop_name);
+        for (const item_def &item : shop->stock)
+            hash = _hash_item(hash, item);
+    }
+
+    for (int i = 0; i < MAX_ITEMS; ++i)
+        if (env.item[i].defined())
+            hash = _hash_item(hash3(hash, i, 0), env.item[i]);
+
+    for (monster_iterator mi; mi; ++mi)
+    {
+        hash = hash3(hash, mi->type, mi->base_monster);
+        hash = hash3(hash, mi->pos().x, mi->pos().y);
+        hash = hash3(hash, mi->hit_points, mi->max_hit_points);
+        hash = hash3(hash, mi->number, mi->attitude);
+        hash = _hash_string(hash, mi->mname);
+        for (int slot = 0; slot < NUM_MONSTER_SLOTS; ++slot)
+            hash = hash3(hash, slot, mi->inv[slot]);
+    }
+
+    return hash;
+}
+
 void debug_dump_levgen()
 {
     if (crawl_state.game_is_arena())
@@ -39,3 +39,4 @@ void wizard_toggle_dprf();
 void debug_list_vacant_keys();
 
 vector<string> level_vault_names(bool force_all=false);
+uint64_t level_hash();
@@ -240,6 +240,41 @@ string process_description(const describe_info &inf, bool include_title)
     return desc;
 }
 
+#ifdef USE_TILE_LOCAL
+// Mouseover text is asked for again on every mouse motion, and a monster
+// or spell description is not cheap to build. Nothing that they describe
+// can change while tiles waits for input, so they are kept by subject
+// until the next time it might have.
+static unordered_map<string, string> _description_cache;
+
+/**
+ * Look up a description in the cache, building it if need be.
+ *
+ * @param key       What is being described, and by whom; e.g. "spell:12".
+ * @param describe  Builds the description if it isn't cached.
+ * @return          The description.
+ */
+string cached_description(const string &key, function<string()> describe)
+{
+    auto it = _description_cache.find(key);
+    if (it != _description_cache.end())
+        return it->second;
+
+    // The mouse only covers so much between inputs, but don't let it grow
+    // without end if something fails to invalidate the cache.
+    if (_description_cache.size() >= 256)
+        _description_cache.clear();
+
+    return _description_cache[key] = describe();
+}
+
+/// Forget cached descriptions, since the game state might have changed.
+void invalidate_description_cache()
+{
+    _description_cache.clear();
+}
+#endif
+
 const char* jewellery_base_ability_string(int subtype)
 {
     switch (subtype)
@@ -108,6 +108,11 @@ int show_description(const string &body, const tile_def *tile = nullptr);
 int show_description(const describe_info &inf, const tile_def *tile = nullptr);
 string process_description(const describe_info &inf, bool include_title = true);
 
+#ifdef USE_TILE_LOCAL
+string cached_description(const string &key, function<string()> describe);
+void invalidate_description_cache();
+#endif
+
 const char* get_size_adj(const size_type size, bool ignore_medium = false);
 
 const char* jewellery_base_ability_string(int subtype);
@@ -17,6 +17,8 @@ dgn_event_dispatcher dungeon_events;
 void dgn_event_dispatcher::clear()
 {
     global_event_mask = 0;
+    position_event_mask = 0;
+    alarm_squares.reset();
     listeners.clear();
     for (int y = 0; y < GYM; ++y)
         for (int x = 0; x < GXM; ++x)
@@ -26,6 +28,7 @@ void dgn_event_dispatcher::clear()
 void dgn_event_dispatcher::clear_listeners_at(const coord_def &pos)
 {
     grid_triggers[pos.x][pos.y].reset(nullptr);
+    alarm_squares.set(pos, false);
 }
 
 void dgn_event_dispatcher::move_listeners(
@@ -33,11 +36,20 @@ void dgn_event_dispatcher::move_listeners(
 {
     // Any existing listeners at to will be discarded. YHBW.
     grid_triggers[to.x][to.y] = std::move(grid_triggers[from.x][from.y]);
+    const bool had_alarm = alarm_squares(from);
+    alarm_squares.set(from, false);
+    alarm_squares.set(to, had_alarm);
 }
 
 bool dgn_event_dispatcher::has_listeners_at(const coord_def &pos) const
 {
-    return grid_triggers[pos.x][pos.y].get();
+    return alarm_squares(pos);
+}
+
+bool dgn_event_dispatcher::has_alarm(const dgn_event &e,
+                                     const coord_def &pos) const
+{
+    return (position_event_mask & e.type) && alarm_squares(pos);
 }
 
 bool dgn_event_dispatcher::fire_vetoable_position_event(
@@ -50,6 +62,9 @@ bool dgn_event_dispatcher::fire_vetoable_position_event(
 bool dgn_event_dispatcher::fire_vetoable_position_event(
     const dgn_event &et, const coord_def &pos)
 {
+    if (!has_alarm(et, pos))
+        return true;
+
     dgn_square_alarm *alarm = grid_triggers[pos.x][pos.y].get();
     if (alarm && (alarm->eventmask & et.type))
     {
@@ -71,6 +86,9 @@ void dgn_event_dispatcher::fire_position_event(
 void dgn_event_dispatcher::fire_position_event(
     const dgn_event &et, const coord_def &pos)
 {
+    if (!has_alarm(et, pos))
+        return;
+
     dgn_square_alarm *alarm = grid_triggers[pos.x][pos.y].get();
     if (alarm && (alarm->eventmask & et.type))
     {
@@ -122,7 +140,11 @@ void dgn_event_dispatcher::register_listener_at(unsigned mask,
                                                 dgn_event_listener *listener)
 {
     if (!grid_triggers[c.x][c.y].get())
+    {
         grid_triggers[c.x][c.y].reset(new dgn_square_alarm);
+        alarm_squares.set(c);
+    }
+    position_event_mask |= mask;
 
     dgn_square_alarm *alarm = grid_triggers[c.x][c.y].get();
     alarm->eventmask |= mask;
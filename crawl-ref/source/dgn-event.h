@@ -7,6 +7,7 @@
 
 #include <list>
 
+#include "bitary.h"
 #include "player.h"
 
 // Keep event names in l-dgnevt.cc in sync.
@@ -96,7 +97,8 @@ struct dgn_listener_def
 class dgn_event_dispatcher
 {
 public:
-    dgn_event_dispatcher() : global_event_mask(0), grid_triggers()
+    dgn_event_dispatcher() : global_event_mask(0), position_event_mask(0),
+                             alarm_squares(), grid_triggers()
     {
     }
 
@@ -126,8 +128,15 @@ private:
                               dgn_event_listener *l);
     void remove_listener_at(const coord_def &pos, dgn_event_listener *l);
 
+    bool has_alarm(const dgn_event &e, const coord_def &pos) const;
+
 private:
     unsigned global_event_mask;
+    // Every event type any square has listened for, and which squares have
+    // alarms: position events nobody is waiting for, as most are, are
+    // turned away without touching grid_triggers.
+    unsigned position_event_mask;
+    FixedBitArray<GXM, GYM> alarm_squares;
     unique_ptr<dgn_square_alarm> grid_triggers[GXM][GYM];
     list<dgn_listener_def> listeners;
 };
@@ -54,32 +54,56 @@ void dgn_island_centred_at(const coord_def &c,
     }
 }
 
+// The weight of each square in a smoothing window, row by row: squares
+// count for less the further they are from the centre. Every window of one
+// radius is weighted the same, so this is only worked out when the radius
+// changes.
+static const vector<int> &_smoothing_weights(int radius)
+{
+    static int weights_radius = -1;
+    static vector<int> weights;
+    if (radius != weights_radius)
+    {
+        const int max_delta = radius * radius * 2 + 2;
+        weights.clear();
+        for (int dy = -radius; dy <= radius; ++dy)
+            for (int dx = -radius; dx <= radius; ++dx)
+                weights.push_back(max_delta - (dx * dx + dy * dy));
+        weights_radius = radius;
+    }
+    return weights;
+}
+
 void dgn_smooth_height_at(coord_def c, int radius, int max_height)
 {
     if (!in_bounds(c))
         return;
 
-    const int height = dgn_height_at(c);
-    if (max_height != DGN_UNDEFINED_HEIGHT && height > max_height)
+    const grid_heightmap &heights = *env.heightmap;
+    const int height = heights(c);
+    const bool capped = max_height != DGN_UNDEFINED_HEIGHT;
+    if (capped && height > max_height)
         return;
 
-    const int max_delta = radius * radius * 2 + 2;
+    // Away from the edges of the map the whole window is in bounds, and
+    // the squares needn't be checked one by one.
+    const bool inside = in_bounds(c.x - radius, c.y - radius)
+                        && in_bounds(c.x + radius, c.y + radius);
+    const vector<int> &weights = _smoothing_weights(radius);
     int divisor = 0;
     int total = 0;
+    int i = 0;
     for (int y = c.y - radius; y <= c.y + radius; ++y)
     {
-        for (int x = c.x - radius; x <= c.x + radius; ++x)
+        for (int x = c.x - radius; x <= c.x + radius; ++x, ++i)
         {
-            const coord_def p(x, y);
-            if (!in_bounds(p))
+            if (!inside && !in_bounds(x, y))
                 continue;
-            const int nheight = dgn_height_at(p);
-            if (max_height != DGN_UNDEFINED_HEIGHT && nheight > max_height)
+            const int nheight = heights[x][y];
+            if (capped && nheight > max_height)
                 continue;
-            const coord_def off = c - p;
-            const int weight = max_delta - off.abs();
-            divisor += weight;
-            total += nheight * weight;
+            divisor += weights[i];
+            total += nheight * weights[i];
         }
     }
     // Can't actually be zero currently unless someone passes a negative
@@ -7,6 +7,7 @@
 #include "dgn-proclayouts.h"
 
 #include <cmath>
+#include <memory>
 
 #include "coord.h"
 #include "coordit.h"
@@ -126,13 +127,48 @@ WastesLayout::operator()(const coord_def &p, const uint32_t offset) const
     return ProceduralSample(p, feat, min(sample.changepoint(), changepoint));
 }
 
+// The river's course is warped by two fBM fields that depend only on the
+// cell and seed, not on the offset, yet cost more than the rest of the
+// layout put together. The Abyss samples the same cells again every time
+// they change, so keep the warped coordinates of a 128x128 window of cells;
+// any one Abyss level fits in it without collisions. Each thread that
+// samples a layout gets its own window, as the Abyss can be sampled in the
+// background.
+struct river_warp
+{
+    bool valid;
+    coord_def p;
+    uint32_t seed;
+    double x, y;
+};
+
+static const river_warp &_river_warp(const coord_def &p, uint32_t seed)
+{
+    static thread_local std::unique_ptr<river_warp[]> warps;
+    if (!warps)
+        warps.reset(new river_warp[128 * 128]());
+
+    const double scalar = 90.0;
+    river_warp &warp = warps[(p.x & 127) << 7 | (p.y & 127)];
+    if (warp.valid && warp.p == p && warp.seed == seed)
+        return warp;
+
+    warp.valid = true;
+    warp.p = p;
+    warp.seed = seed;
+    warp.x = (p.x + perlin::fBM(p.x/4.0, p.y/4.0, seed, 5) * 3) / scalar;
+    warp.y = (p.y + perlin::fBM(p.x/4.0 + 3.7, p.y/4.0 + 1.9, seed + 4, 5) * 3) / scalar;
+    return warp;
+}
+
 ProceduralSample
 RiverLayout::operator()(const coord_def &p, const uint32_t offset) const
 {
     const double scale = 10000;
     const double scalar = 90.0;
-    double x = (p.x + perlin::fBM(p.x/4.0, p.y/4.0, seed, 5) * 3) / scalar;
-    double y = (p.y + perlin::fBM(p.x/4.0 + 3.7, p.y/4.0 + 1.9, seed + 4, 5) * 3) / scalar;
+    const river_warp &warp = _river_warp(p, seed);
+    double x = warp.x;
+    double y = warp.y;
     worley::noise_datum n = worley::noise(x, y, offset / scale + seed);
     const uint32_t changepoint = offset + _get_changepoint(n, scale);
     if ((n.id[0] ^ n.id[1] ^ seed) % 4)
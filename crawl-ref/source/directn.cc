@@ -103,9 +103,31 @@ static bool _want_target_monster(const monster *mon, targ_mode_type mode,
                                  targeter* hitfunc);
 static bool _find_monster(const coord_def& where, targ_mode_type mode,
                           bool need_path, int range, targeter *hitfunc);
+
+// What aiming at a square would hit, as far as picking a default target
+// goes.
+struct expl_aim
+{
+    bool valid;
+    aff_type self;
+    vector<pair<monster *, aff_type>> monsters;
+};
+
+// One search for a default target can go round every square in view
+// several times, asking for different things; this remembers what aiming
+// at each square would hit, since every set_aim() may trace a beam and its
+// explosion, and which monsters are worth hitting at all.
+struct expl_search
+{
+    map<coord_def, expl_aim> aims;
+    map<mid_t, bool> wanted;
+};
+
+
 static bool _find_monster_expl(const coord_def& where, targ_mode_type mode,
                                bool need_path, int range, targeter *hitfunc,
-                               aff_type mon_aff, aff_type allowed_self_aff);
+                               aff_type mon_aff, aff_type allowed_self_aff,
+                               expl_search *search = nullptr);
 static bool _find_shadow_step_mons(const coord_def& where, targ_mode_type mode,
                                    bool need_path, int range,
                                    targeter *hitfunc);
@@ -1098,10 +1120,13 @@ bool direction_chooser::find_default_monster_target(coord_def& result) const
         result = mons_target->pos();
         return true;
     }
+    // What aiming at each square would hit, for the searches below.
+    expl_search search;
     // If the previous targeted position is at all useful, use it.
     if (!Options.simple_targeting && hitfunc && !prefer_farthest
         && _find_monster_expl(you.prev_grd_targ, mode, needs_path,
-                              range, hitfunc, AFF_YES, AFF_MULTIPLE))
+                              range, hitfunc, AFF_YES, AFF_MULTIPLE,
+                              &search))
     {
         result = you.prev_grd_targ;
         return true;
@@ -1124,7 +1149,8 @@ bool direction_chooser::find_default_monster_target(coord_def& result) const
                                                        needs_path, range,
                                                        hitfunc,
                                                        // First try to bizap
-                                                       AFF_MULTIPLE, AFF_YES),
+                                                       AFF_MULTIPLE, AFF_YES,
+                                                       &search),
                                                   hitfunc)
                   || _find_square_wrapper(result, 1,
                                           bind(restricts == DIR_SHADOW_STEP ?
@@ -1157,7 +1183,8 @@ bool direction_chooser::find_default_monster_target(coord_def& result) const
                                        bind(_find_monster_expl,
                                             placeholders::_1, mode,
                                             needs_path, range, hitfunc,
-                                            mon_aff, allowed_self_aff),
+                                            mon_aff, allowed_self_aff,
+                                            &search),
                                        hitfunc);
                 if (success)
                 {
@@ -1475,7 +1502,7 @@ bool direction_chooser::pickup_item()
 {
     item_def *ii = nullptr;
     if (in_bounds(target()))
-        ii = env.map_knowledge(target()).item();
+        ii = env.map_knowledge(target()).mutable_item();
     if (!ii || !ii->is_valid(true))
     {
         mprf(MSGCH_EXAMINE_FILTER, "You can't see any item there.");
@@ -2878,9 +2905,38 @@ static bool _find_shadow_step_mons(const coord_def& where, targ_mode_type mode,
     return tgt.has_additional_sites(where);
 }
 
+static const expl_aim &_expl_aim_at(const coord_def& where, bool need_path,
+                                    targeter *hitfunc, expl_search &search)
+{
+    auto found = search.aims.find(where);
+    if (found != search.aims.end())
+        return found->second;
+
+    expl_aim &aim = search.aims[where];
+    // Not blocked by something, either.
+    aim.valid = hitfunc->valid_aim(where)
+                && !(need_path && _blocked_ray(where));
+    if (!aim.valid)
+        return aim;
+
+    aim.valid = hitfunc->set_aim(where);
+    if (!aim.valid)
+        return aim;
+
+    aim.self = hitfunc->is_affected(you.pos());
+    for (monster_near_iterator mi(&you); mi; ++mi)
+    {
+        const aff_type aff = hitfunc->is_affected(mi->pos());
+        if (aff != AFF_NO)
+            aim.monsters.emplace_back(*mi, aff);
+    }
+    return aim;
+}
+
 static bool _find_monster_expl(const coord_def& where, targ_mode_type mode,
                                bool need_path, int range, targeter *hitfunc,
-                               aff_type mon_aff, aff_type allowed_self_aff)
+                               aff_type mon_aff, aff_type allowed_self_aff,
+                               expl_search *search)
 {
     ASSERT(hitfunc);
 
@@ -2893,25 +2949,37 @@ static bool _find_monster_expl(const coord_def& where, targ_mode_type mode,
             return bool(x);
     }
 
-    if (!hitfunc->valid_aim(where))
-        return false;
+    if (!search)
+    {
+        expl_search once;
+        return _find_monster_expl(where, mode, need_path, range, hitfunc,
+                                  mon_aff, allowed_self_aff, &once);
+    }
 
-    // Target is blocked by something
-    if (need_path && _blocked_ray(where))
+    const bool known = search->aims.count(where);
+    const expl_aim &aim = _expl_aim_at(where, need_path, hitfunc, *search);
+    if (!aim.valid || aim.self > allowed_self_aff)
         return false;
 
-    if (hitfunc->set_aim(where))
+    for (const auto &hit : aim.monsters)
     {
-        if (hitfunc->is_affected(you.pos()) > allowed_self_aff)
-            return false;
-        for (monster_near_iterator mi(&you); mi; ++mi)
+        if (hit.second != mon_aff)
+            continue;
+
+        auto wanted = search->wanted.find(hit.first->mid);
+        if (wanted == search->wanted.end())
         {
-            if (hitfunc->is_affected(mi->pos()) == mon_aff
-                && _mons_is_valid_target(*mi, mode, range)
-                && _want_target_monster(*mi, mode, hitfunc))
-            {
-                    return true;
-            }
+            const bool want = _mons_is_valid_target(hit.first, mode, range)
+                              && _want_target_monster(hit.first, mode,
+                                                      hitfunc);
+            wanted = search->wanted.emplace(hit.first->mid, want).first;
+        }
+        if (wanted->second)
+        {
+            // Leave the targeter aimed here, as it would have been.
+            if (known)
+                hitfunc->set_aim(where);
+            return true;
         }
     }
     return false;
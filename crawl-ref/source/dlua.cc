@@ -178,6 +178,26 @@ int dlua_chunk::load(CLua &interp)
     return err;
 }
 
+// Replaces the source with its bytecode, so that loading the chunk later
+// (say, from the des cache) doesn't have to run the Lua parser again.
+// Chunks that don't compile are left as source, to report their errors
+// when they are next loaded.
+int dlua_chunk::compile(CLua &interp)
+{
+    if (!compiled.empty() || empty())
+        return 0;
+
+    lua_stack_cleaner cln(interp);
+    const int err = load(interp);
+    if (err)
+    {
+        compiled.clear();
+        return err;
+    }
+    chunk.clear();
+    return 0;
+}
+
 int dlua_chunk::run(CLua &interp)
 {
     int err = load(interp);
@@ -58,6 +58,7 @@ public:
     int load(CLua &interp);
     int run(CLua &interp);
     int load_call(CLua &interp, const char *function);
+    int compile(CLua &interp);
     void set_file(const string &s);
 
     const string &lua_string() const { return chunk; }
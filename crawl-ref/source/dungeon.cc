@@ -55,6 +55,7 @@
 #include "mon-place.h"
 #include "mon-poly.h"
 #include "nearby-danger.h"
+#include "node-pool.h"
 #include "notes.h"
 #include "place.h"
 #include "randbook.h"
@@ -73,6 +74,7 @@
 #include "timed-effects.h"
 #include "traps.h"
 #include "unique-creature-list-type.h"
+#include "unwind.h"
 #ifdef WIZARD
 #include "wiz-dgn.h"
 #endif
@@ -298,6 +300,10 @@ bool builder(bool enable_random_maps)
     unwind_var<coord_def> saved_position(you.position);
     you.position.reset();
 
+    // Pathfinding nodes are recycled through the build; give them back to
+    // the heap once the level is done.
+    ON_UNWIND { node_pool::release_all(); };
+
     // TODO: why are these globals?
     // Save a copy of unique creatures for vetoes.
     temp_unique_creatures = you.unique_creatures;
@@ -640,6 +646,7 @@ bool dgn_make_transporters_from_markers()
 // fixups.
 static void _dgn_postprocess_level()
 {
+    MAPSTAT_STAGE("postprocess");
     shoals_postprocess_level();
     _builder_assertions();
     _calc_density();
@@ -957,43 +964,26 @@ static bool _dgn_fill_zone(
     bool (*iswanted)(const coord_def &) = nullptr)
 {
     bool ret = false;
-    list<coord_def> points[2];
-    int cur = 0;
-    int found_points = 0;
 
     // No bounds checks, assuming the level has at least one layer of
     // rock border.
-
-    for (points[cur].push_back(start); !points[cur].empty();)
-    {
-        for (const auto &c : points[cur])
+    const int found_points = flood_fill(start,
+        [passable](const coord_def &c)
+        {
+            return !travel_point_distance[c.x][c.y] && passable(c);
+        },
+        [&](const coord_def &c)
         {
             travel_point_distance[c.x][c.y] = zone;
-            found_points++;
-
+            if (c != start)
+                record_point(c);
             if (iswanted && iswanted(c))
                 ret = true;
+        });
 
-            for (adjacent_iterator ai(c); ai; ++ai)
-            {
-                const coord_def& cp = *ai;
-                if (!map_bounds(cp)
-                    || travel_point_distance[cp.x][cp.y] || !passable(cp))
-                {
-                    continue;
-                }
-
-                travel_point_distance[cp.x][cp.y] = zone;
-                record_point(cp);
-                points[!cur].push_back(cp);
-            }
-        }
-
-        points[cur].clear();
-        cur = !cur;
-    }
     dprf("Zone %d contains %d points from seed %d,%d", zone, found_points,
         start.x, start.y);
+    UNUSED(found_points);
     return ret;
 }
 
@@ -1111,6 +1101,9 @@ static int _process_disconnected_zones(int x1, int y1, int x2, int y2,
     memset(travel_point_distance, 0, sizeof(travel_distance_grid_t));
     int nzones = 0;
     int ngood = 0;
+    // Reused from zone to zone.
+    vector<coord_def> zone_points;
+    vector<coord_def> coords;
     for (int y = y1; y <= y2 ; ++y)
     {
         for (int x = x1; x <= x2; ++x)
@@ -1122,12 +1115,18 @@ static int _process_disconnected_zones(int x1, int y1, int x2, int y2,
                 continue;
             }
 
-            int zone_size = 0;
-            auto inc_zone_size = [&zone_size](const coord_def &) { zone_size++; };
+            // Only needed if we might fill the zone; the seed isn't
+            // recorded by _dgn_fill_zone.
+            zone_points.clear();
+            auto record_point = [&zone_points, fill](const coord_def &c)
+            {
+                if (fill)
+                    zone_points.push_back(c);
+            };
 
             const bool found_exit_stair =
                 _dgn_fill_zone(coord_def(x, y), ++nzones,
-                               inc_zone_size,
+                               record_point,
                                passable,
                                choose_stairless ? (at_branch_bottom() ?
                                                    _is_upwards_exit_stair :
@@ -1138,32 +1137,32 @@ static int _process_disconnected_zones(int x1, int y1, int x2, int y2,
             if (choose_stairless && found_exit_stair)
                 ++ngood;
             else if (fill
-                && (fill_small_zones <= 0 || zone_size <= fill_small_zones))
+                && (fill_small_zones <= 0
+                    || (int)zone_points.size() <= fill_small_zones))
             {
                 // Don't fill in areas connected to vaults.
                 // We want vaults to be accessible; if the area is disconnected
                 // from the rest of the level, this will cause the level to be
                 // vetoed later on.
                 bool veto = false;
-                vector<coord_def> coords;
+                coords.clear();
                 dprf("Filling zone %d", nzones);
-                for (int fy = y1; fy <= y2 ; ++fy)
+                zone_points.emplace_back(x, y);
+                // Fill in the same (row-major) order as a scan of the level.
+                sort(zone_points.begin(), zone_points.end(),
+                     [](const coord_def &a, const coord_def &b)
+                     {
+                         return a.y < b.y || a.y == b.y && a.x < b.x;
+                     });
+                for (const coord_def &c : zone_points)
                 {
-                    for (int fx = x1; fx <= x2; ++fx)
+                    if (map_masked(c, MMT_VAULT))
                     {
-                        if (travel_point_distance[fx][fy] == nzones)
-                        {
-                            if (map_masked(coord_def(fx, fy), MMT_VAULT))
-                            {
-                                veto = true;
-                                break;
-                            }
-                            else if (!fill_check || fill_check(coord_def(fx, fy)))
-                                coords.emplace_back(fx, fy);
-                        }
-                    }
-                    if (veto)
+                        veto = true;
                         break;
+                    }
+                    else if (!fill_check || fill_check(c))
+                        coords.push_back(c);
                 }
                 if (!veto)
                 {
@@ -1196,11 +1195,129 @@ static int _process_disconnected_zones(int x1, int y1, int x2, int y2,
     return nzones - ngood;
 }
 
+// The zones of the whole level under one passability check, found with a
+// union-find over the passable squares. env.grid is written from too many
+// places (vaults, layouts, Lua) to keep this up to date on every write, so
+// instead it's keyed on the set of passable squares itself: checking that is
+// a single pass over the level, and when nothing has changed since the last
+// count (as between most vault placements) no zones are rebuilt at all.
+struct dgn_zone_map
+{
+    bool (*passable)(const coord_def &) = nullptr;
+    FixedBitArray<GXM, GYM> open;
+    // 0 for squares that aren't passable, otherwise 1..nzones.
+    FixedArray<int, GXM, GYM> zone;
+    int nzones = 0;
+};
+
+static int _zone_root(vector<int> &parent, int i)
+{
+    while (parent[i] != i)
+        i = parent[i] = parent[parent[i]];
+    return i;
+}
+
+static void _build_zone_map(dgn_zone_map &zones)
+{
+    vector<int> parent(GXM * GYM);
+    for (int y = 0; y < GYM; ++y)
+        for (int x = 0; x < GXM; ++x)
+        {
+            if (!zones.open(x, y))
+                continue;
+
+            const int i = y * GXM + x;
+            parent[i] = i;
+            // Join with the neighbours already visited: W, NW, N and NE.
+            const coord_def back[] = { {x - 1, y}, {x - 1, y - 1},
+                                       {x, y - 1}, {x + 1, y - 1} };
+            for (const coord_def &c : back)
+            {
+                if (!map_bounds(c) || !zones.open(c))
+                    continue;
+                const int a = _zone_root(parent, i);
+                const int b = _zone_root(parent, c.y * GXM + c.x);
+                if (a != b)
+                    parent[max(a, b)] = min(a, b);
+            }
+        }
+
+    // Roots come before the rest of their zone in scan order, so each zone
+    // is numbered when its first square is reached.
+    zones.zone.init(0);
+    zones.nzones = 0;
+    for (int y = 0; y < GYM; ++y)
+        for (int x = 0; x < GXM; ++x)
+        {
+            if (!zones.open(x, y))
+                continue;
+            const int root = _zone_root(parent, y * GXM + x);
+            zones.zone[x][y] = root == y * GXM + x
+                ? ++zones.nzones
+                : zones.zone[root % GXM][root / GXM];
+        }
+}
+
+static const dgn_zone_map &_dgn_zones(bool (*passable)(const coord_def &))
+{
+    // One for each of the passability checks counted without a fill.
+    static dgn_zone_map zone_maps[2];
+    static int next_map = 0;
+
+    FixedBitArray<GXM, GYM> open;
+    for (rectangle_iterator ri(0); ri; ++ri)
+        if (passable(*ri))
+            open.set(*ri);
+
+    dgn_zone_map *zones = nullptr;
+    for (dgn_zone_map &m : zone_maps)
+        if (m.passable == passable)
+            zones = &m;
+
+    if (zones && zones->open == open)
+        return *zones;
+
+    if (!zones)
+    {
+        zones = &zone_maps[next_map];
+        next_map = (next_map + 1) % ARRAYSZ(zone_maps);
+        zones->passable = passable;
+    }
+    zones->open = open;
+    _build_zone_map(*zones);
+    dprf("Rebuilt zone map: %d zones", zones->nzones);
+    return *zones;
+}
+
+// The same count as _process_disconnected_zones without a fill, from the
+// cached zone map.
+static int _count_zones(bool (*passable)(const coord_def &),
+                        bool choose_stairless)
+{
+    const dgn_zone_map &zones = _dgn_zones(passable);
+    if (!choose_stairless)
+        return zones.nzones;
+
+    bool (*has_stair)(const coord_def &) =
+        at_branch_bottom() ? _is_upwards_exit_stair : _is_exit_stair;
+    vector<bool> good(zones.nzones + 1, false);
+    int ngood = 0;
+    for (rectangle_iterator ri(0); ri; ++ri)
+    {
+        const int z = zones.zone(*ri);
+        if (z && !good[z] && has_stair(*ri))
+        {
+            good[z] = true;
+            ++ngood;
+        }
+    }
+    return zones.nzones - ngood;
+}
+
 int dgn_count_tele_zones(bool choose_stairless)
 {
     dprf("Counting teleport zones");
-    return _process_disconnected_zones(0, 0, GXM-1, GYM-1, choose_stairless,
-                                    DNGN_UNSEEN, _dgn_square_is_tele_connected);
+    return _count_zones(_dgn_square_is_tele_connected, choose_stairless);
 }
 
 // Count number of mutually isolated zones. If choose_stairless, only count
@@ -1209,10 +1326,21 @@ int dgn_count_tele_zones(bool choose_stairless)
 int dgn_count_disconnected_zones(bool choose_stairless,
                                  dungeon_feature_type fill)
 {
+    if (fill == DNGN_UNSEEN)
+        return _count_zones(_dgn_square_is_passable, choose_stairless);
+
     return _process_disconnected_zones(0, 0, GXM-1, GYM-1, choose_stairless,
                                        fill);
 }
 
+// Are a and b both passable and in the same zone, as counted by
+// dgn_count_disconnected_zones?
+bool dgn_zones_connected(const coord_def &a, const coord_def &b)
+{
+    const dgn_zone_map &zones = _dgn_zones(_dgn_square_is_passable);
+    return zones.zone(a) && zones.zone(a) == zones.zone(b);
+}
+
 static void _fill_small_disconnected_zones()
 {
     // debugging tip: change the feature to something like lava that will be
@@ -3004,6 +3132,7 @@ static bool _pan_level()
 // to place more vaults after this
 static bool _builder_by_type()
 {
+    MAPSTAT_STAGE("layout");
     if (player_in_branch(BRANCH_ABYSS))
     {
         generate_abyss();
@@ -3436,6 +3565,7 @@ static void _slime_connectivity_fixup()
 // Place vaults with CHANCE: that want to be placed on this level.
 static void _place_chance_vaults()
 {
+    MAPSTAT_STAGE("chance vaults");
     const level_id &lid(level_id::current());
     mapref_vector maps = random_chance_maps_in_depth(lid);
     // [ds] If there are multiple CHANCE maps that share an luniq_ or
@@ -3473,6 +3603,7 @@ static void _place_chance_vaults()
 
 static void _place_minivaults()
 {
+    MAPSTAT_STAGE("minivaults");
     const map_def *vault = nullptr;
     // First place the vault requested with &P
     if (you.props.exists(FORCE_MINIVAULT_KEY)
@@ -3768,6 +3899,7 @@ static bool _in_descent_parent(branch_type branch)
 
 static void _place_branch_entrances(bool use_vaults)
 {
+    MAPSTAT_STAGE("branch entrances");
     // Find what branch entrances are already placed, and what branch
     // entrances could be placed here.
     bool branch_entrance_placed[NUM_BRANCHES];
@@ -3874,6 +4006,7 @@ static void _place_branch_entrances(bool use_vaults)
 
 static void _place_extra_vaults()
 {
+    MAPSTAT_STAGE("extra vaults");
     int tries = 0;
     while (true)
     {
@@ -4102,6 +4235,7 @@ bool door_vetoed(const coord_def pos)
 
 static void _builder_monsters()
 {
+    MAPSTAT_STAGE("monsters");
     if (player_in_branch(BRANCH_TEMPLE))
         return;
 
@@ -4200,6 +4334,7 @@ static void _randomly_place_item(int item)
  */
 static void _builder_items()
 {
+    MAPSTAT_STAGE("items");
     int i = 0;
     object_class_type specif_type = OBJ_RANDOM;
     int items_levels = env.absdepth0;
@@ -5351,7 +5486,7 @@ static bool _dgn_place_one_monster(const vault_placement &place,
 }
 
 /* "Oddball grids" are handled in _vault_grid. */
-static dungeon_feature_type _glyph_to_feat(int glyph)
+static dungeon_feature_type _fixed_glyph_to_feat(int glyph)
 {
     return (glyph == 'x') ? DNGN_ROCK_WALL :
            (glyph == 'X') ? DNGN_PERMAROCK_WALL :
@@ -5361,12 +5496,6 @@ static dungeon_feature_type _glyph_to_feat(int glyph)
            (glyph == 'm') ? DNGN_CLEAR_ROCK_WALL :
            (glyph == 'n') ? DNGN_CLEAR_STONE_WALL :
            (glyph == 'o') ? DNGN_CLEAR_PERMAROCK_WALL :
-           // We make 't' correspond to the right tree type by branch.
-           (glyph == 't') ?
-               player_in_branch(BRANCH_SWAMP)          ? DNGN_MANGROVE :
-               player_in_branch(BRANCH_ABYSS)
-               || player_in_branch(BRANCH_PANDEMONIUM) ? DNGN_DEMONIC_TREE
-                                                       : DNGN_TREE :
            (glyph == '+') ? DNGN_CLOSED_DOOR :
            (glyph == '=') ? DNGN_RUNED_CLEAR_DOOR :
            (glyph == 'w') ? DNGN_DEEP_WATER :
@@ -5381,7 +5510,6 @@ static dungeon_feature_type _glyph_to_feat(int glyph)
            (glyph == ']') ? DNGN_STONE_STAIRS_DOWN_III :
            (glyph == '[') ? DNGN_STONE_STAIRS_UP_III :
            (glyph == 'A') ? DNGN_STONE_ARCH :
-           (glyph == 'C') ? _pick_an_altar() :   // f(x) elsewhere {dlb}
            (glyph == 'I') ? DNGN_ORCISH_IDOL :
            (glyph == 'G') ? DNGN_GRANITE_STATUE :
            (glyph == 'T') ? DNGN_FOUNTAIN_BLUE :
@@ -5392,6 +5520,34 @@ static dungeon_feature_type _glyph_to_feat(int glyph)
                           : DNGN_FLOOR; // includes everything else
 }
 
+// Every vault cell goes through here, and most of them are floor, which
+// the chain above only gets to last; so look the fixed glyphs up in a table.
+static dungeon_feature_type _glyph_to_feat(int glyph)
+{
+    // We make 't' correspond to the right tree type by branch.
+    if (glyph == 't')
+    {
+        return player_in_branch(BRANCH_SWAMP)          ? DNGN_MANGROVE :
+               player_in_branch(BRANCH_ABYSS)
+               || player_in_branch(BRANCH_PANDEMONIUM) ? DNGN_DEMONIC_TREE
+                                                       : DNGN_TREE;
+    }
+    if (glyph == 'C')
+        return _pick_an_altar();   // f(x) elsewhere {dlb}
+
+    static FixedVector<dungeon_feature_type, 128> glyph_feats;
+    static bool glyph_feats_ready = false;
+    if (!glyph_feats_ready)
+    {
+        for (int i = 0; i < (int) glyph_feats.size(); ++i)
+            glyph_feats[i] = _fixed_glyph_to_feat(i);
+        glyph_feats_ready = true;
+    }
+    if (glyph < 0 || glyph >= (int) glyph_feats.size())
+        return _fixed_glyph_to_feat(glyph);
+    return glyph_feats[glyph];
+}
+
 dungeon_feature_type map_feature_at(map_def *map, const coord_def &c,
                                     int rawfeat)
 {
@@ -5666,12 +5822,14 @@ struct coord_comparator
     }
 };
 
-typedef set<coord_def, coord_comparator> coord_set;
+// Its nodes come and go for nearly every square looked at.
+typedef set<coord_def, coord_comparator, pool_allocator<coord_def>> coord_set;
 
 static void _jtd_init_surrounds(coord_set &coords, uint32_t mapmask,
                                 const coord_def &c)
 {
-    vector<coord_def> cur;
+    coord_def cur[4];
+    int ncur = 0;
     for (orth_adjacent_iterator ai(c); ai; ++ai)
     {
         if (!in_bounds(*ai) || travel_point_distance[ai->x][ai->y]
@@ -5680,10 +5838,15 @@ static void _jtd_init_surrounds(coord_set &coords, uint32_t mapmask,
             continue;
         }
         // randomize the order in which we visit orthogonal directions
-        cur.insert(cur.begin() + random2(cur.size() + 1), *ai);
+        const int at = random2(ncur + 1);
+        for (int i = ncur; i > at; --i)
+            cur[i] = cur[i - 1];
+        cur[at] = *ai;
+        ++ncur;
     }
-    for (auto cc : cur)
+    for (int i = 0; i < ncur; ++i)
     {
+        const coord_def cc = cur[i];
         coords.insert(cc);
 
         const coord_def dp = cc - c;
@@ -7202,6 +7365,25 @@ void vault_placement::apply_grid()
     {
         bool clear = !map.has_tag("overwrite_floor_cell");
 
+        // Most glyphs have the same keyed spec (or none) wherever they are,
+        // so look each one up once instead of in both passes for every cell.
+        FixedVector<keyed_mapspec *, 128> glyph_specs(nullptr);
+        FixedBitVector<128> glyph_specs_known;
+        auto mapspec_at = [&](int glyph, const coord_def &dp)
+        {
+            if (glyph < 0 || glyph >= (int) glyph_specs.size()
+                || !map_lines::glyph_has_one_mapspec(glyph))
+            {
+                return map.mapspec_at(dp);
+            }
+            if (!glyph_specs_known[glyph])
+            {
+                glyph_specs[glyph] = map.mapspec_at(dp);
+                glyph_specs_known.set(glyph);
+            }
+            return glyph_specs[glyph];
+        };
+
         // NOTE: assumes *no* previous item (I think) or monster (definitely)
         // placement.
         for (rectangle_iterator ri(pos, pos + size - 1); ri; ++ri)
@@ -7227,7 +7409,7 @@ void vault_placement::apply_grid()
                 tile_clear_flavour(*ri);
             }
 
-            keyed_mapspec *mapsp = map.mapspec_at(dp);
+            keyed_mapspec *mapsp = mapspec_at(feat, dp);
             _vault_grid(*this, feat, *ri, mapsp);
 
             if (!crawl_state.generating_level)
@@ -7256,7 +7438,7 @@ void vault_placement::apply_grid()
             const coord_def dp = *ri - pos;
 
             const int feat = map.map.glyph(dp);
-            keyed_mapspec *mapsp = map.mapspec_at(dp);
+            keyed_mapspec *mapsp = mapspec_at(feat, dp);
 
             _vault_grid_mons(*this, feat, *ri, mapsp);
         }
@@ -7515,6 +7697,7 @@ unwind_vault_placement_mask::~unwind_vault_placement_mask()
 // mark all unexplorable squares, count the rest
 static void _calc_density()
 {
+    MAPSTAT_STAGE("density");
     int open = 0;
     for (rectangle_iterator ri(0); ri; ++ri)
     {
@@ -274,6 +274,7 @@ int dgn_count_disconnected_zones(
     dungeon_feature_type fill = DNGN_UNSEEN);
 
 int dgn_count_tele_zones(bool choose_stairless);
+bool dgn_zones_connected(const coord_def &a, const coord_def &b);
 
 void dgn_replace_area(const coord_def& p1, const coord_def& p2,
                       dungeon_feature_type replace,
@@ -21,6 +21,7 @@
 #include "god-passive.h"
 #include "ghost.h"
 #include "hints.h"
+#include "hiscores.h"
 #include "initfile.h"
 #include "invent.h"
 #include "item-prop.h"
@@ -35,6 +36,7 @@
 #include "stringutil.h"
 #include "tag-version.h"
 #include "tilepick.h"
+#include "turn-times.h"
 #include "view.h"
 #include "xom.h"
 #include "ui.h"
@@ -144,6 +146,7 @@ bool CrawlIsCrashing = false;
 NORETURN void end(int exit_code, bool print_error, const char *format, ...)
 {
     disable_other_crashes();
+    flush_milestones();
 
     // Let "error" go out of scope for valgrind's sake.
     {
@@ -173,6 +176,9 @@ NORETURN void end(int exit_code, bool print_error, const char *format, ...)
 #endif
 
         cio_cleanup();
+        if (crawl_state.print_turn_times)
+            fprintf(stderr, "%s", turn_times_description().c_str());
+        turn_times_stop_trace();
         msg::deinitialise_mpr_streams();
         _clear_globals_on_exit();
         databaseSystemShutdown();
@@ -210,6 +216,7 @@ NORETURN void end(int exit_code, bool print_error, const char *format, ...)
 void delete_files()
 {
     crawl_state.need_save = false;
+    unlink_save_summary(you.save->get_filename());
     you.save->unlink();
     delete you.save;
     you.save = 0;
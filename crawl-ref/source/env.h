@@ -6,6 +6,7 @@
 
 #include "cloud.h"
 #include "coord.h"
+#include "coord-grid.h"
 #include "fprop.h"
 #include "map-cell.h"
 #include "mapmark.h"
@@ -61,10 +62,10 @@ struct crawl_environment
 
     vector<coord_def>                        travel_trail;
 
-    map<coord_def, cloud_struct> cloud;
+    cloud_grid cloud;
 
-    map<coord_def, shop_struct> shop; // shop list
-    map<coord_def, trap_def> trap; // trap list
+    coord_grid<shop_struct> shop; // shop list
+    coord_grid<trap_def> trap; // trap list
 
     FixedVector< monster_type, MAX_MONS_ALLOC > mons_alloc;
     map_markers                              markers;
@@ -187,7 +187,7 @@ exclude_set::exclude_set()
 void exclude_set::clear()
 {
     exclude_roots.clear();
-    exclude_points.clear();
+    exclude_points.reset();
 }
 
 void exclude_set::erase(const coord_def &p)
@@ -197,15 +197,15 @@ void exclude_set::erase(const coord_def &p)
     if (it == exclude_roots.end())
         return;
 
-    travel_exclude old_ex = it->second;
     exclude_roots.erase(it);
 
     recompute_excluded_points();
 }
 
+// ex has just been constructed, which computed its LOS.
 void exclude_set::add_exclude(travel_exclude &ex)
 {
-    add_exclude_points(ex);
+    add_exclude_points(ex, true);
     exclude_roots[ex.pos] = ex;
 }
 
@@ -217,22 +217,25 @@ void exclude_set::add_exclude(const coord_def &p, int radius,
     add_exclude(ex);
 }
 
-void exclude_set::add_exclude_points(travel_exclude& ex)
+// If los_current, the caller has only just computed ex's LOS, so it isn't
+// worked out again.
+void exclude_set::add_exclude_points(travel_exclude& ex, bool los_current)
 {
     if (ex.radius == 0)
     {
-        exclude_points.insert(ex.pos);
+        if (map_bounds(ex.pos))
+            exclude_points.set(ex.pos);
         return;
     }
 
     if (!ex.uptodate)
         ex.set_los();
-    else
+    else if (!los_current)
         ex.los.update();
 
     for (radius_iterator ri(ex.pos, ex.radius, C_SQUARE); ri; ++ri)
         if (ex.affects(*ri))
-            exclude_points.insert(*ri);
+            exclude_points.set(*ri);
 }
 
 void exclude_set::update_excluded_points(bool recompute_los)
@@ -250,19 +253,19 @@ void exclude_set::update_excluded_points(bool recompute_los)
 
 void exclude_set::recompute_excluded_points(bool recompute_los)
 {
-    exclude_points.clear();
+    exclude_points.reset();
     for (iterator it = exclude_roots.begin(); it != exclude_roots.end(); ++it)
     {
         travel_exclude &ex = it->second;
         if (recompute_los)
             ex.set_los();
-        add_exclude_points(ex);
+        add_exclude_points(ex, recompute_los);
     }
 }
 
 bool exclude_set::is_excluded(const coord_def &p) const
 {
-    return exclude_points.count(p);
+    return map_bounds(p) && exclude_points(p);
 }
 
 bool exclude_set::is_exclude_root(const coord_def &p) const
@@ -319,6 +322,7 @@ static void _mark_excludes_non_updated(const coord_def &p)
 void init_exclusion_los()
 {
     curr_excludes.recompute_excluded_points(true);
+    invalidate_travel_terrain();
 }
 
 /*
@@ -336,6 +340,7 @@ void update_exclusion_los(vector<coord_def> changed)
         _mark_excludes_non_updated(c);
 
     curr_excludes.update_excluded_points(true);
+    invalidate_travel_terrain();
 }
 
 bool is_excluded(const coord_def &p, const exclude_set &exc)
@@ -421,6 +426,7 @@ void clear_excludes()
 
     curr_excludes.clear();
     clear_level_exclusion_annotation();
+    invalidate_travel_terrain();
 
 #ifdef USE_TILE
     for (const auto &entry : excludes)
@@ -467,6 +473,7 @@ void cycle_exclude_radius(const coord_def &p)
 void del_exclude(const coord_def &p)
 {
     curr_excludes.erase(p);
+    invalidate_travel_terrain();
     _exclude_update(p);
 }
 
@@ -530,6 +537,7 @@ void set_exclude(const coord_def &p, int radius, bool autoexcl, bool vaultexcl,
         curr_excludes.add_exclude(p, radius, autoexcl, desc, vaultexcl);
     }
 
+    invalidate_travel_terrain();
     if (!defer_updates)
         _exclude_update(p);
 }
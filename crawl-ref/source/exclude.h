@@ -87,13 +87,13 @@ public:
     iterator  end();
 
 private:
-    typedef set<coord_def> exclset;
-
     exclmap exclude_roots;
-    exclset exclude_points;
+    // Every square excluded by any of the roots, so that is_excluded(),
+    // which travel asks of every square it considers, is one bit test.
+    FixedBitArray<GXM, GYM> exclude_points;
 
 private:
-    void add_exclude_points(travel_exclude& ex);
+    void add_exclude_points(travel_exclude& ex, bool los_current = false);
 };
 
 extern exclude_set curr_excludes; // in travel.cc
@@ -14,6 +14,55 @@ static FixedVector<feature_def, NUM_SHOW_ITEMS> item_defs;
 static int feat_index[NUM_FEATURES];
 static feature_def invis_fd, cloud_fd;
 
+// The 'feature' option's overrides, indexed by feature, so that drawing
+// the map doesn't search Options' maps for every cell. Zero means not
+// overridden. Rebuilt whenever Options.glyph_overrides_version changes.
+struct feature_override
+{
+    char32_t symbol = 0;
+    char32_t magic_symbol = 0;
+    colour_t colour = 0;
+    colour_t unseen_colour = 0;
+    colour_t seen_colour = 0;
+    colour_t em_colour = 0;
+    colour_t seen_em_colour = 0;
+};
+static feature_override feat_overrides[NUM_FEATURES];
+static unsigned int feat_overrides_version = 0;
+
+static const feature_override &_feat_override(dungeon_feature_type feat)
+{
+    if (feat_overrides_version != Options.glyph_overrides_version)
+    {
+        for (feature_override &over : feat_overrides)
+            over = feature_override();
+
+        for (const auto &entry : Options.feature_symbol_overrides)
+        {
+            feature_override &over = feat_overrides[entry.first];
+            if (entry.second[0])
+                over.symbol = get_glyph_override(entry.second[0]);
+            if (entry.second[1])
+                over.magic_symbol = get_glyph_override(entry.second[1]);
+        }
+
+        for (const auto &entry : Options.feature_colour_overrides)
+        {
+            feature_override &over = feat_overrides[entry.first];
+            over.colour = entry.second.dcolour;
+            over.unseen_colour = entry.second.unseen_dcolour;
+            over.seen_colour = entry.second.seen_dcolour;
+            over.em_colour = entry.second.em_dcolour;
+            over.seen_em_colour = entry.second.seen_em_dcolour;
+        }
+
+        feat_overrides_version = Options.glyph_overrides_version;
+    }
+
+    ASSERT_RANGE(feat, 0, NUM_FEATURES);
+    return feat_overrides[feat];
+}
+
 /** What symbol should be used for this feature?
  *
  *  @returns The symbol from the 'feature' option if given, otherwise the
@@ -21,9 +70,8 @@ static feature_def invis_fd, cloud_fd;
  */
 char32_t feature_def::symbol() const
 {
-    auto over = map_find(Options.feature_symbol_overrides, feat);
-    if (over && (*over)[0])
-        return get_glyph_override((*over)[0]);
+    if (char32_t over = _feat_override(feat).symbol)
+        return over;
 
     return dchar_glyph(dchar);
 }
@@ -36,9 +84,8 @@ char32_t feature_def::symbol() const
  */
 char32_t feature_def::magic_symbol() const
 {
-    auto over = map_find(Options.feature_symbol_overrides, feat);
-    if (over && (*over)[1])
-        return get_glyph_override((*over)[1]);
+    if (char32_t over = _feat_override(feat).magic_symbol)
+        return over;
 
     if (magic_dchar != NUM_DCHAR_TYPES)
         return dchar_glyph(magic_dchar);
@@ -53,9 +100,8 @@ char32_t feature_def::magic_symbol() const
  */
 colour_t feature_def::colour() const
 {
-    auto ofeat = map_find(Options.feature_colour_overrides, feat);
-    if (ofeat && ofeat->dcolour)
-        return ofeat->dcolour;
+    if (colour_t over = _feat_override(feat).colour)
+        return over;
 
     return dcolour;
 }
@@ -67,9 +113,8 @@ colour_t feature_def::colour() const
  */
 colour_t feature_def::unseen_colour() const
 {
-    auto ofeat = map_find(Options.feature_colour_overrides, feat);
-    if (ofeat && ofeat->unseen_dcolour)
-        return ofeat->unseen_dcolour;
+    if (colour_t over = _feat_override(feat).unseen_colour)
+        return over;
 
     return unseen_dcolour;
 }
@@ -81,9 +126,8 @@ colour_t feature_def::unseen_colour() const
  */
 colour_t feature_def::seen_colour() const
 {
-    auto ofeat = map_find(Options.feature_colour_overrides, feat);
-    if (ofeat && ofeat->seen_dcolour)
-        return ofeat->seen_dcolour;
+    if (colour_t over = _feat_override(feat).seen_colour)
+        return over;
 
     return seen_dcolour;
 }
@@ -95,9 +139,8 @@ colour_t feature_def::seen_colour() const
  */
 colour_t feature_def::seen_em_colour() const
 {
-    auto ofeat = map_find(Options.feature_colour_overrides, feat);
-    if (ofeat && ofeat->seen_em_dcolour)
-        return ofeat->seen_em_dcolour;
+    if (colour_t over = _feat_override(feat).seen_em_colour)
+        return over;
 
     return seen_em_dcolour;
 }
@@ -109,9 +152,8 @@ colour_t feature_def::seen_em_colour() const
  */
 colour_t feature_def::em_colour() const
 {
-    auto ofeat = map_find(Options.feature_colour_overrides, feat);
-    if (ofeat && ofeat->em_dcolour)
-        return ofeat->em_dcolour;
+    if (colour_t over = _feat_override(feat).em_colour)
+        return over;
 
     return em_dcolour;
 }
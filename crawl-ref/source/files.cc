@@ -57,6 +57,7 @@
 #include "god-companions.h"
 #include "god-passive.h"
 #include "hints.h"
+#include "hiscores.h"
 #include "initfile.h"
 #include "item-name.h"
 #include "items.h"
@@ -93,6 +94,7 @@
 #include "tileview.h"
 #include "tiles-build-specific.h"
 #include "timed-effects.h"
+#include "turn-times.h"
 #include "ui.h"
 #include "unwind.h"
 #include "version.h"
@@ -113,6 +115,9 @@
 #include <FindDirectory.h>
 #endif
 
+// Rewrite the save on exit once this percentage of it is unused holes.
+#define SAVE_COMPACT_SLACK 25
+
 #define BONES_DIAGNOSTICS (defined(WIZARD) || defined(DEBUG_BONES) || defined(DEBUG_DIAGNOSTICS))
 
 #ifdef BONES_DIAGNOSTICS
@@ -139,8 +144,11 @@ static bool _ghost_version_compatible(const save_version &version);
 static bool _restore_tagged_chunk(package *save, const string &name,
                                   tag_type tag, const char* complaint);
 static player_save_info _read_character_info(package *save);
+static player_save_info _read_character_info(reader &inf,
+                                             const string &filename);
 
 static bool _convert_obsolete_species();
+static void _load_level(const level_id &level);
 
 const short GHOST_SIGNATURE = short(0xDC55);
 
@@ -705,7 +713,19 @@ static bool _readln(chunk_reader &rd, char *buf)
     return true;
 }
 
-static void _fill_player_doll(player_save_info &p, package *save)
+// The first line of the doll chunk of a save, which is all that save lists
+// look at.
+static bool _read_doll_line(package *save, string &line)
+{
+    chunk_reader fdoll(save, "tdl");
+    char fbuf[LINEMAX];
+    if (!_readln(fdoll, fbuf))
+        return false;
+    line = fbuf;
+    return true;
+}
+
+static void _fill_player_doll(player_save_info &p, const string *doll_line)
 {
     dolls_data equip_doll;
     for (unsigned int j = 0; j < TILEP_PART_MAX; ++j)
@@ -714,20 +734,14 @@ static void _fill_player_doll(player_save_info &p, package *save)
     equip_doll.parts[TILEP_PART_BASE]
         = tilep_species_to_base_tile(p.species, p.experience_level);
 
-    bool success = false;
-
-    chunk_reader fdoll(save, "tdl");
+    if (doll_line)
     {
         char fbuf[LINEMAX];
-        if (_readln(fdoll,fbuf))
-        {
-            tilep_scan_parts(fbuf, equip_doll, p.species, p.experience_level);
-            tilep_race_default(p.species, p.experience_level, &equip_doll);
-            success = true;
-        }
+        strlcpy(fbuf, doll_line->c_str(), sizeof(fbuf));
+        tilep_scan_parts(fbuf, equip_doll, p.species, p.experience_level);
+        tilep_race_default(p.species, p.experience_level, &equip_doll);
     }
-
-    if (!success) // Use default doll instead.
+    else // Use default doll instead.
     {
         job_type job = get_job_by_name(p.class_name.c_str());
         if (job == JOB_UNKNOWN)
@@ -739,6 +753,175 @@ static void _fill_player_doll(player_save_info &p, package *save)
 }
 #endif
 
+// Save lists read a small summary kept next to each save instead of opening
+// the package: a copy of its "chr" chunk and of the first line of its doll.
+// It is written once the save is closed, and only trusted while the save's
+// modification time and size are still what they were then.
+#define SAVE_SUMMARY_SUFFIX ".info"
+static const int SAVE_SUMMARY_VERSION = 1;
+static const size_t MAX_SAVE_SUMMARY_BLOB = 4096;
+
+struct save_summary
+{
+    vector<unsigned char> chr;
+    bool has_doll = false;      // the save has a "tdl" chunk
+    bool doll_read = false;     // and its first line is in doll
+    string doll;
+};
+
+static bool _save_file_stat(const string &path, int64_t &mtime, int64_t &size)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st))
+        return false;
+    mtime = st.st_mtime;
+    size = st.st_size;
+    return true;
+}
+
+static bool _get_save_summary(package *save, save_summary &summary)
+{
+    if (!save->has_chunk("chr"))
+        return false;
+
+    vector<char> chr;
+    chunk_reader rd(save, "chr");
+    rd.read_all(chr);
+    if (chr.size() > MAX_SAVE_SUMMARY_BLOB)
+        return false;
+    summary.chr.assign(chr.begin(), chr.end());
+
+#ifdef USE_TILE
+    summary.has_doll = save->has_chunk("tdl");
+    if (summary.has_doll)
+        summary.doll_read = _read_doll_line(save, summary.doll);
+#endif
+    return true;
+}
+
+static void _write_save_summary(const string &save_path,
+                                const save_summary &summary)
+{
+    int64_t mtime, size;
+    if (!_save_file_stat(save_path, mtime, size))
+        return;
+
+    vector<unsigned char> buf;
+    {
+        writer w(&buf);
+        marshallInt(w, SAVE_SUMMARY_VERSION);
+        marshallSigned(w, mtime);
+        marshallSigned(w, size);
+        marshallInt(w, summary.chr.size());
+        w.write(summary.chr.data(), summary.chr.size());
+        marshallBoolean(w, summary.has_doll);
+        marshallBoolean(w, summary.doll_read);
+        marshallInt(w, summary.doll.size());
+        w.write(summary.doll.data(), summary.doll.size());
+    }
+
+    const string path = save_path + SAVE_SUMMARY_SUFFIX;
+    FILE *fp = fopen_u(path.c_str(), "wb");
+    if (!fp)
+        return;
+    const bool written = fwrite(buf.data(), 1, buf.size(), fp) == buf.size();
+    // A summary that didn't make it out whole would only be ignored, but
+    // there's no point leaving it around.
+    if (fclose(fp) || !written)
+        unlink_u(path.c_str());
+}
+
+template<typename T>
+static bool _read_summary_blob(reader &inf, T &data)
+{
+    const int len = unmarshallInt(inf);
+    if (len < 0 || (size_t)len > MAX_SAVE_SUMMARY_BLOB)
+        return false;
+    data.resize(len);
+    if (len)
+        inf.read(&data[0], len);
+    return true;
+}
+
+static bool _read_save_summary(const string &save_path, save_summary &summary)
+{
+    int64_t mtime, size;
+    if (!_save_file_stat(save_path, mtime, size))
+        return false;
+
+    FILE *fp = fopen_u((save_path + SAVE_SUMMARY_SUFFIX).c_str(), "rb");
+    if (!fp)
+        return false;
+
+    bool valid = false;
+    try
+    {
+        reader inf(fp);
+        if (unmarshallInt(inf) == SAVE_SUMMARY_VERSION
+            && unmarshallSigned(inf) == mtime
+            && unmarshallSigned(inf) == size
+            && _read_summary_blob(inf, summary.chr))
+        {
+            summary.has_doll = unmarshallBoolean(inf);
+            summary.doll_read = unmarshallBoolean(inf);
+            valid = _read_summary_blob(inf, summary.doll);
+        }
+    }
+    catch (short_read_exception &E)
+    {
+        valid = false;
+    }
+    fclose(fp);
+    return valid;
+}
+
+void unlink_save_summary(const string &save_path)
+{
+    unlink_u((save_path + SAVE_SUMMARY_SUFFIX).c_str());
+}
+
+// Whether another process has the save open for playing, which the summary
+// can't tell.
+static bool _save_in_use(const string &path)
+{
+    int fd = open_u(path.c_str(), O_RDONLY | O_BINARY, 0666);
+    if (fd == -1)
+        return false;
+    const bool in_use = !lock_file(fd, false);
+    close(fd);
+    return in_use;
+}
+
+// The character info of a save, and its doll if asked for, from its summary
+// if that is still good and from the package otherwise. Throws
+// game_ended_condition if the save is in use, like opening it does.
+static player_save_info _read_save_info(const string &path, bool doll)
+{
+    UNUSED(doll);
+    save_summary summary;
+    if (!_save_in_use(path) && _read_save_summary(path, summary))
+    {
+        reader inf(summary.chr);
+        player_save_info p = _read_character_info(inf, path);
+#ifdef USE_TILE
+        if (doll && !p.name.empty() && summary.has_doll)
+            _fill_player_doll(p, summary.doll_read ? &summary.doll : nullptr);
+#endif
+        return p;
+    }
+
+    package save(path.c_str(), false);
+    player_save_info p = _read_character_info(&save);
+#ifdef USE_TILE
+    if (doll && !p.name.empty() && save.has_chunk("tdl"))
+    {
+        string line;
+        _fill_player_doll(p, _read_doll_line(&save, line) ? &line : nullptr);
+    }
+#endif
+    return p;
+}
+
 /*
  * Returns a list of the names of characters that are already saved for the
  * current user.
@@ -763,15 +946,16 @@ static vector<player_save_info> _find_saved_characters()
         {
             try
             {
-                package save(_get_savedir_path(filename).c_str(), false);
-                player_save_info p = _read_character_info(&save);
+#ifdef USE_TILE
+                const bool doll = Options.tile_menu_icons;
+#else
+                const bool doll = false;
+#endif
+                player_save_info p =
+                    _read_save_info(_get_savedir_path(filename), doll);
                 if (!p.name.empty())
                 {
                     p.filename = filename;
-#ifdef USE_TILE
-                    if (Options.tile_menu_icons && save.has_chunk("tdl"))
-                        _fill_player_doll(p, &save);
-#endif
                     chars.push_back(p);
                 }
             }
@@ -860,8 +1044,7 @@ static bool _append_save_info(JsonWrapper &json, const char *filename,
         return false;
     try
     {
-        package save(filename, false);
-        player_save_info p = _read_character_info(&save);
+        player_save_info p = _read_save_info(filename, false);
 
         // TODO: some json for the non-loadable case? I think this comes up
         // for save compat mismatches so shouldn't be relevant for webtiles
@@ -1832,37 +2015,10 @@ static bool _branch_pregenerates(branch_type b)
         branch_generation_order.end(), b) > 0;
 }
 
-/**
-* Generate dungeon branches in a stable order until the level `stopping_point`
-* is found; `stopping_point` will be generated if it doesn't already exist. If
-* it does exist, the function is a noop.
-*
-* If `stopping_point` is not in the generation order, it will be generated on
-* its own.
-*
-* To generate all generatable levels, pass a level_id with NUM_BRANCHES as the
-* branch.
-*
-* @return whether stopping_point generated; if stopping_point is NUM_BRANCHES,
-* whether the full pregen list completed. This will return false if all needed
-* levels are already generated, so the caller should check whether false is an
-* error case or trivial success (using the save chunk).
-*/
-bool pregen_dungeon(const level_id &stopping_point)
+// The levels that still need to be built, in order, up to and including
+// stopping_point. See pregen_dungeon().
+static vector<level_id> _levels_to_pregen(const level_id &stopping_point)
 {
-    // TODO: the is_valid() check here doesn't look quite right to me, but so
-    // far I can't get it to break anything...
-    if (stopping_point.is_valid()
-        || stopping_point.branch != NUM_BRANCHES &&
-           is_random_subbranch(stopping_point.branch) && you.wizard)
-    {
-        if (you.save->has_chunk(stopping_point.describe()))
-            return false;
-
-        if (!_branch_pregenerates(stopping_point.branch))
-            return generate_level(stopping_point);
-    }
-
     vector<level_id> to_generate;
     bool at_end = false;
     for (auto br : branch_generation_order)
@@ -1905,6 +2061,42 @@ bool pregen_dungeon(const level_id &stopping_point)
             break;
     }
 
+    return to_generate;
+}
+
+/**
+* Generate dungeon branches in a stable order until the level `stopping_point`
+* is found; `stopping_point` will be generated if it doesn't already exist. If
+* it does exist, the function is a noop.
+*
+* If `stopping_point` is not in the generation order, it will be generated on
+* its own.
+*
+* To generate all generatable levels, pass a level_id with NUM_BRANCHES as the
+* branch.
+*
+* @return whether stopping_point generated; if stopping_point is NUM_BRANCHES,
+* whether the full pregen list completed. This will return false if all needed
+* levels are already generated, so the caller should check whether false is an
+* error case or trivial success (using the save chunk).
+*/
+bool pregen_dungeon(const level_id &stopping_point)
+{
+    // TODO: the is_valid() check here doesn't look quite right to me, but so
+    // far I can't get it to break anything...
+    if (stopping_point.is_valid()
+        || stopping_point.branch != NUM_BRANCHES &&
+           is_random_subbranch(stopping_point.branch) && you.wizard)
+    {
+        if (you.save->has_chunk(stopping_point.describe()))
+            return false;
+
+        if (!_branch_pregenerates(stopping_point.branch))
+            return generate_level(stopping_point);
+    }
+
+    const vector<level_id> to_generate = _levels_to_pregen(stopping_point);
+
     if (to_generate.size() == 0)
     {
         dprf("levelgen: No valid levels to generate.");
@@ -1954,6 +2146,59 @@ bool pregen_dungeon(const level_id &stopping_point)
     }
 }
 
+/**
+ * With the pregen_ahead option, build the next level in the generation order
+ * while the player is on this one, so that taking the stairs to it only has
+ * to load it. The order is the one pregen_dungeon() uses, so what gets built
+ * is exactly what would have been built on arrival. Only levels at most one
+ * deeper than the current one are built early.
+ *
+ * @return whether a level was built.
+ */
+bool pregen_next_level()
+{
+    if (!Options.pregen_ahead
+        || !you.deterministic_levelgen
+        || !you.on_current_level
+        || crawl_state.generating_level
+        || !crawl_state.need_save
+        || !level_excursions_allowed()
+        || !_branch_pregenerates(you.where_are_you)
+        || player_in_branch(BRANCH_ZIGGURAT))
+    {
+        return false;
+    }
+
+    const vector<level_id> pending =
+        _levels_to_pregen(level_id(NUM_BRANCHES, -1));
+    if (pending.empty()
+        || pending[0].absdepth() > level_id::current().absdepth() + 1)
+    {
+        return false;
+    }
+
+    const level_id here = level_id::current();
+    dprf("Pregenerating %s ahead of the player.",
+         pending[0].describe().c_str());
+
+    // Make sure the last turn is on screen before the pause.
+    update_screen();
+#ifdef USE_TILE
+    tiles.redraw();
+#endif
+
+    save_level(here);
+    const bool built = generate_level(pending[0]);
+
+    // generate_level() puts you back, but leaves its level in env. Come
+    // back the way a level_excursion would.
+    _load_level(here);
+    travel_cache.get_level_info(here).set_level_excludes();
+    env.markers.activate_all(false);
+    you.on_current_level = true;
+    return built;
+}
+
 static void _rescue_player_from_wall()
 {
     // n.b. you.wizmode_teleported_into_rock would be better, but it is not
@@ -2555,13 +2800,26 @@ static void _save_game_exit()
     tiles.send_exit_reason("saved");
 #endif
 
+    const string save_path = you.save->get_filename();
+    save_summary summary;
+    const bool summarised = !Options.no_save
+                            && _get_save_summary(you.save, summary);
+
+    // Leaving is a good time to squeeze out holes left by rewritten levels.
+    you.save->compact(SAVE_COMPACT_SLACK);
     delete you.save;
     you.save = 0;
+
+    // Only now is the save as it will be found.
+    if (summarised)
+        _write_save_summary(save_path, summary);
 }
 
 void save_game(bool leave_game, const char *farewellmsg)
 {
+    TURN_PHASE(TP_SAVE);
     unwind_bool saving_game(crawl_state.saving_game, true);
+    flush_milestones();
     // Should you.no_save disable more here? Currently it entails an empty
     // package, and persists won't save, but there's a bunch of other stuff
     // that can.
@@ -2599,7 +2857,14 @@ void save_game(bool leave_game, const char *farewellmsg)
 #endif
         if (!crawl_state.disables[DIS_SAVE_CHECKPOINTS])
         {
+#ifdef __ANDROID__
+            // We may get killed while paused, so make sure it's on disk.
             you.save->commit();
+#else
+            // Don't make the player wait for the disk; the next commit or
+            // closing the save will wait instead.
+            you.save->commit(true);
+#endif
             save_game_prefs();
         }
         return;
@@ -2616,6 +2881,7 @@ void save_game(bool leave_game, const char *farewellmsg)
 // Saves the game without exiting.
 void save_game_state()
 {
+    TURN_PHASE(TP_SAVE);
     save_game(false);
     if (crawl_state.seen_hups)
         save_game(true);
@@ -2977,9 +3243,36 @@ static vector<ghost_demon> _load_ephemeral_ghosts()
     return results;
 }
 
+// Permastores already read, by path. A permastore is never claimed from,
+// only rewritten whole, so there is no need to read and unmarshall it again
+// for every ghost placed until it changes on disk.
+struct permastore_cache_entry
+{
+    time_t mtime;
+    off_t size;
+    vector<ghost_demon> ghosts;
+};
+static map<string, permastore_cache_entry> _permastore_cache;
+
 static vector<ghost_demon> _load_permastore_ghosts(bool backup_on_upgrade=false)
 {
-    return _load_ghosts_core(_bones_permastore_file(), backup_on_upgrade);
+    const string filename = _bones_permastore_file();
+    struct stat st;
+    if (filename.empty() || stat(filename.c_str(), &st) != 0)
+        return _load_ghosts_core(filename, backup_on_upgrade);
+
+    auto it = _permastore_cache.find(filename);
+    if (it != _permastore_cache.end()
+        && it->second.mtime == st.st_mtime && it->second.size == st.st_size)
+    {
+        _ghost_dprf("Using cached permastore %s", filename.c_str());
+        return it->second.ghosts;
+    }
+
+    vector<ghost_demon> ghosts = _load_ghosts_core(filename,
+                                                   backup_on_upgrade);
+    _permastore_cache[filename] = { st.st_mtime, st.st_size, ghosts };
+    return ghosts;
 }
 
 /**
@@ -3239,8 +3532,11 @@ static bool _restore_game(const string& filename)
 
     if (you.save->has_chunk(CHUNK("nts", "notes")))
     {
-        reader inf(you.save, CHUNK("nts", "notes"), minorVersion);
-        load_notes(inf);
+        vector<char> buf;
+        chunk_reader inf(you.save, CHUNK("nts", "notes"));
+        inf.read_all(buf);
+        load_notes_lazily(vector<unsigned char>(buf.begin(), buf.end()),
+                          minorVersion);
     }
 
     /* hints mode */
@@ -3491,7 +3787,12 @@ static bool _loadable_save_ver(int major, int minor)
 static player_save_info _read_character_info(package *save)
 {
     reader inf(save, "chr");
+    return _read_character_info(inf, save->get_filename());
+}
 
+static player_save_info _read_character_info(reader &inf,
+                                             const string &filename)
+{
     try
     {
         player_save_info result;
@@ -3501,7 +3802,7 @@ static player_save_info _read_character_info(package *save)
 
         unsigned int len = unmarshallInt(inf);
         if (len > 1024) // something is fishy
-            fail("Save file `%s` corrupted (info > 1KB)", save->get_filename().c_str());
+            fail("Save file `%s` corrupted (info > 1KB)", filename.c_str());
         vector<unsigned char> buf;
         buf.resize(len);
         inf.read(&buf[0], len);
@@ -3517,7 +3818,7 @@ static player_save_info _read_character_info(package *save)
         if (format > TAG_CHR_FORMAT)
         {
             fail("Incompatible character data from the future in `%s`",
-                                        save->get_filename().c_str());
+                                        filename.c_str());
         }
 
         result = tag_read_char_info(th, format, major, minor);
@@ -3532,7 +3833,7 @@ static player_save_info _read_character_info(package *save)
     }
     catch (short_read_exception &E)
     {
-        fail("Save file `%s` corrupted (short read)", save->get_filename().c_str());
+        fail("Save file `%s` corrupted (short read)", filename.c_str());
     };
 }
 
@@ -3755,6 +4056,8 @@ static vector<ghost_demon> _update_permastore(const vector<ghost_demon> &ghosts)
         tag_write_ghosts(outw, permastore);
 
         lk_close(ghost_file);
+        // Don't trust the modification time alone for a write of our own.
+        _permastore_cache.clear();
     }
     return leftovers;
 }
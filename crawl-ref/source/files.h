@@ -70,6 +70,7 @@ bool check_mkdir(const string &what, string *dir, bool silent = false);
 
 // Find saved games for all game types.
 vector<player_save_info> find_all_saved_characters();
+void unlink_save_summary(const string &save_path);
 
 NORETURN void print_save_json(const char *name);
 
@@ -91,6 +92,7 @@ void update_portal_entrances();
 void reset_portal_entrances();
 bool generate_level(const level_id &l);
 bool pregen_dungeon(const level_id &stopping_point);
+bool pregen_next_level();
 bool load_level(dungeon_feature_type stair_taken, load_mode_type load_mode,
                 const level_id& old_level);
 void delete_level(const level_id &level);
@@ -40,11 +40,47 @@
 #include "transform.h"
 #include "view.h"
 
+// Freed effects, by size in units of FINEFF_GRAIN bytes, ready to be handed
+// out again.
+static const size_t FINEFF_GRAIN = 8;
+static const size_t FINEFF_POOLED_SIZES = 32;
+static const size_t MAX_POOLED_FINEFFS = 16;
+static vector<void *> _fineff_pool[FINEFF_POOLED_SIZES];
+
+/*static*/ void *final_effect::operator new(size_t size)
+{
+    const size_t grains = (size + FINEFF_GRAIN - 1) / FINEFF_GRAIN;
+    if (grains >= FINEFF_POOLED_SIZES)
+        return ::operator new(size);
+
+    vector<void *> &pool = _fineff_pool[grains];
+    if (pool.empty())
+        return ::operator new(grains * FINEFF_GRAIN);
+
+    void *ptr = pool.back();
+    pool.pop_back();
+    return ptr;
+}
+
+/*static*/ void final_effect::operator delete(void *ptr, size_t size)
+{
+    const size_t grains = (size + FINEFF_GRAIN - 1) / FINEFF_GRAIN;
+    if (grains < FINEFF_POOLED_SIZES
+        && _fineff_pool[grains].size() < MAX_POOLED_FINEFFS)
+    {
+        _fineff_pool[grains].push_back(ptr);
+    }
+    else
+        ::operator delete(ptr);
+}
+
 /*static*/ void final_effect::schedule(final_effect *eff)
 {
     for (auto fe : env.final_effects)
     {
-        if (fe->mergeable(*eff))
+        // Only effects of the same kind ever merge, and comparing types
+        // is cheaper than asking.
+        if (typeid(*fe) == typeid(*eff) && fe->mergeable(*eff))
         {
             fe->merge(*eff);
             delete eff;
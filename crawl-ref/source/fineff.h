@@ -26,6 +26,10 @@ public:
 
     virtual void fire() = 0;
 
+    // Effects come and go many times a turn, so their memory is recycled.
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr, size_t size);
+
 protected:
     static void schedule(final_effect *eff);
 
@@ -1,12 +1,14 @@
 /**
  * @file
- * @brief flood_find template
+ * @brief flood_find and flood_fill templates
 **/
 
 #pragma once
 
 #include <vector>
 
+#include "bitary.h"
+#include "coord.h"
 #include "terrain.h"
 #include "travel.h"
 
@@ -174,3 +176,56 @@ bool flood_find<fgrd, bound_check>::path_flood(
 
     return false;
 }
+
+/**
+ * An allocation-free 8-way flood fill, for builder code that only needs to
+ * know which squares are connected to a start square. Unlike flood_find
+ * this doesn't go through travel_pathfind: the visited set is a bitset and
+ * the queue a fixed buffer the size of the level.
+ *
+ * Squares are visited in breadth-first order from start, which is always
+ * visited. A neighbour is visited if it's within map_bounds and
+ * passable(neighbour) holds; passable is called at most once per square.
+ * Fills may not be nested (visit must not start another one).
+ *
+ * @param start    the square to fill from.
+ * @param passable bool(const coord_def &): can the fill enter this square?
+ * @param visit    void(const coord_def &): called once for each square.
+ * @return the number of squares visited.
+ */
+template <typename passable_check, typename visitor>
+int flood_fill(const coord_def &start, passable_check passable,
+               visitor visit)
+{
+    static coord_def queue[GXM * GYM];
+    static FixedBitArray<GXM, GYM> seen;
+    static bool filling = false;
+    ASSERT(!filling);
+    filling = true;
+
+    seen.reset();
+    int head = 0, tail = 0;
+    queue[tail++] = start;
+    seen.set(start);
+
+    while (head < tail)
+    {
+        const coord_def c = queue[head++];
+        visit(c);
+
+        for (int yi = -1; yi <= 1; ++yi)
+            for (int xi = -1; xi <= 1; ++xi)
+            {
+                const coord_def cp(c.x + xi, c.y + yi);
+                if (!map_bounds(cp) || seen(cp))
+                    continue;
+                // Mark it even if impassable, so it's only checked once.
+                seen.set(cp);
+                if (passable(cp))
+                    queue[tail++] = cp;
+            }
+    }
+
+    filling = false;
+    return tail;
+}
@@ -22,10 +22,12 @@
 #include "unicode.h"
 #include "unwind.h"
 
-// maximum number of unique glyphs that can be rendered with this font at once; e.g. 4096, 256, 36
-#define MAX_GLYPHS 256
-// dimensions of glyph grid; GLYPHS_PER_ROWCOL^2 <= MAX_GLYPHS; e.g. 64, 16, 6
+// dimensions of the glyph grid when a font is configured; it doubles when
+// full, up to MAX_GLYPHS_PER_ROWCOL, after which glyphs are evicted.
 #define GLYPHS_PER_ROWCOL 16
+#define MAX_GLYPHS_PER_ROWCOL 64
+// how many measured strings to remember before starting afresh
+#define MAX_CACHED_WIDTHS 1024
 // char to use if we can't find it in the font (upside-down question mark)
 #define MISSING_CHAR 0xbf
 
@@ -61,7 +63,10 @@ FontWrapper* FontWrapper::create()
 }
 
 FTFontWrapper::FTFontWrapper() :
-    m_atlas(nullptr),
+    m_atlas_side(GLYPHS_PER_ROWCOL),
+    m_atlas_count(0),
+    m_atlas_clock(0),
+    m_atlas_generation(0),
     m_max_advance(0, 0),
     m_min_offset(0),
     charsz(1,1),
@@ -77,7 +82,6 @@ FTFontWrapper::FTFontWrapper() :
 
 FTFontWrapper::~FTFontWrapper()
 {
-    delete[] m_atlas;
     delete[] pixels;
     delete m_buf;
     if (face)
@@ -128,45 +132,21 @@ bool FTFontWrapper::configure_font()
     // the texture as a whole out to a power of 2, instead of each individual
     // character. Also, whilst GLES baulks at ALPHA8, there might be some
     // other compression format that we can use to get the size down a bit
-    m_ft_width  = GLYPHS_PER_ROWCOL * charsz.x;
-    m_ft_height = GLYPHS_PER_ROWCOL * charsz.y;
-
     delete[] pixels; // for repeated calls
 
     pixels = new unsigned char[4 * charsz.x * charsz.y];
-    memset(pixels, 0, sizeof(unsigned char) * 4 * charsz.x * charsz.y);
-
-    dprintf("new font tex %d x %d x 4 = %dpx %d bytes\n",
-            m_ft_width, m_ft_height, m_ft_width * m_ft_height,
-            4 * m_ft_width * m_ft_height);
-
-    // initialise empty texture of correct size
-    unwind_bool noscaling(Options.tile_filter_scaling, false);
-    m_tex.load_texture(nullptr, m_ft_width, m_ft_height, MIPMAP_NONE);
 
     m_glyphs.clear();
-
-    for (int i = 0; i < MAX_GLYPHS; i++)
-        m_atlas[i] = FontAtlasEntry();
+    m_width_cache.clear();
 
     // atlas[0] always contains a full-white block (never evicted)
     // this is currently used by colour_bar
-    {
-        for (int x = 0; x < m_max_advance.x; x++)
-            for (int y = 0; y < m_max_advance.y; y++)
-            {
-                unsigned int idx = x + y * m_max_advance.x;
-                idx *= 4;
-                pixels[idx]     = 255;
-                pixels[idx + 1] = 255;
-                pixels[idx + 2] = 255;
-                pixels[idx + 3] = 255;
-            }
-
-        bool success = m_tex.load_texture(pixels, charsz.x, charsz.y,
-                                          MIPMAP_NONE, 0, 0);
-        ASSERT(success);
-    }
+    m_atlas_side = GLYPHS_PER_ROWCOL;
+    m_atlas.assign(m_atlas_side * m_atlas_side, FontAtlasEntry());
+    m_atlas_count = 1;
+    m_atlas_clock = 0;
+    m_atlas_generation++;
+    load_atlas_texture();
 
     // precache common chars
     for (int i = 0x20; i < 0x7f; i++)
@@ -212,10 +192,6 @@ bool FTFontWrapper::load_font(const char *font_name, unsigned int font_size)
                    font_path.c_str(), size, error);
     }
 
-    m_atlas = new FontAtlasEntry[MAX_GLYPHS];
-    m_atlas_lru.clear();
-    m_atlas_lru.reserve(MAX_GLYPHS);
-
     return configure_font();
 }
 
@@ -255,6 +231,7 @@ FTFontWrapper::GlyphInfo& FTFontWrapper::get_glyph_info(char32_t ch)
         glyph.width = bmp->width;
         glyph.renderable = !!bmp->buffer;
         glyph.valid = true;
+        glyph.slot = 0;
     }
     return glyph;
 }
@@ -312,12 +289,73 @@ void FTFontWrapper::load_glyph(unsigned int c, char32_t uchar)
         unwind_bool noscaling(Options.tile_filter_scaling, false);
         bool success = m_tex.load_texture(pixels, charsz.x, charsz.y,
                             MIPMAP_NONE,
-                            (c % GLYPHS_PER_ROWCOL) * charsz.x,
-                            (c / GLYPHS_PER_ROWCOL) * charsz.y);
+                            (c % m_atlas_side) * charsz.x,
+                            (c / m_atlas_side) * charsz.y);
         ASSERT(success);
     }
 }
 
+/**
+ * Create the atlas texture for the current size of grid, and fill it: the
+ * white block, then every glyph mapped so far.
+ */
+void FTFontWrapper::load_atlas_texture()
+{
+    m_ft_width  = m_atlas_side * charsz.x;
+    m_ft_height = m_atlas_side * charsz.y;
+
+    dprintf("new font tex %d x %d x 4 = %dpx %d bytes\n",
+            m_ft_width, m_ft_height, m_ft_width * m_ft_height,
+            4 * m_ft_width * m_ft_height);
+
+    // initialise empty texture of correct size
+    unwind_bool noscaling(Options.tile_filter_scaling, false);
+    m_tex.unload_texture();
+    m_tex.load_texture(nullptr, m_ft_width, m_ft_height, MIPMAP_NONE);
+
+    memset(pixels, 0, sizeof(unsigned char) * 4 * charsz.x * charsz.y);
+    for (int x = 0; x < m_max_advance.x; x++)
+        for (int y = 0; y < m_max_advance.y; y++)
+        {
+            unsigned int idx = x + y * m_max_advance.x;
+            idx *= 4;
+            pixels[idx]     = 255;
+            pixels[idx + 1] = 255;
+            pixels[idx + 2] = 255;
+            pixels[idx + 3] = 255;
+        }
+
+    bool success = m_tex.load_texture(pixels, charsz.x, charsz.y,
+                                      MIPMAP_NONE, 0, 0);
+    ASSERT(success);
+
+    for (unsigned int c = 1; c < m_atlas_count; c++)
+        load_glyph(c, m_atlas[c].uchar);
+}
+
+/**
+ * Double the grid on each side, keeping the glyphs already in it. Large
+ * character sets (CJK translations, say) would otherwise keep evicting and
+ * reloading glyphs.
+ */
+void FTFontWrapper::grow_atlas()
+{
+    m_atlas_side *= 2;
+    m_atlas.resize(m_atlas_side * m_atlas_side);
+    load_atlas_texture();
+    m_atlas_generation++;
+}
+
+void FTFontWrapper::atlas_coords(unsigned int c, int width,
+                                 float &tex_sx, float &tex_sy,
+                                 float &tex_ex, float &tex_ey) const
+{
+    tex_sx = (float)((c % m_atlas_side) * charsz.x) / (float)m_ft_width;
+    tex_sy = (float)((c / m_atlas_side) * charsz.y) / (float)m_ft_height;
+    tex_ex = tex_sx + (float)width / (float)m_ft_width;
+    tex_ey = tex_sy + (float)m_max_advance.y / (float)m_ft_height;
+}
+
 unsigned int FTFontWrapper::map_unicode(char *ch)
 {
     char32_t c;
@@ -327,48 +365,75 @@ unsigned int FTFontWrapper::map_unicode(char *ch)
 
 unsigned int FTFontWrapper::map_unicode(char32_t uchar)
 {
-    unsigned int c = MAX_GLYPHS;
-    for (unsigned int i = 1; i < MAX_GLYPHS; i++)
-        if (m_atlas[i].uchar == uchar)
+    GlyphInfo &glyph = get_glyph_info(uchar);
+    unsigned int c = glyph.slot;
+
+    if (!c) // not found: need to load into atlas
+    {
+        if (m_atlas_count == m_atlas.size()
+            && m_atlas_side < MAX_GLYPHS_PER_ROWCOL)
         {
-            c = i;
-            break;
+            grow_atlas();
         }
 
-    if (c == MAX_GLYPHS) // not found: need to load into atlas
-    {
-        bool atlas_full = m_atlas_lru.size() == MAX_GLYPHS-1;
-        c = atlas_full ? m_atlas_lru[0] : m_atlas_lru.size()+1;
+        if (m_atlas_count < m_atlas.size())
+            c = m_atlas_count++;
+        else
+        {
+            // evict the least recently used glyph
+            c = 1;
+            for (unsigned int i = 2; i < m_atlas.size(); i++)
+                if (m_atlas[i].last_used < m_atlas[c].last_used)
+                    c = i;
+            get_glyph_info(m_atlas[c].uchar).slot = 0;
+            m_atlas_generation++;
+        }
         m_atlas[c].uchar = uchar;
+        glyph.slot = c;
         load_glyph(c, uchar);
         n_subst++;
     }
 
-    auto it = find(m_atlas_lru.begin(), m_atlas_lru.end(), (uint8_t)c);
-    if (it != m_atlas_lru.end())
-        m_atlas_lru.erase(it);
-    m_atlas_lru.push_back(c);
-
+    m_atlas[c].last_used = ++m_atlas_clock;
     return c;
 }
 
+/**
+ * Map every glyph of a string before storing any of it, so that if the
+ * atlas has to grow, it does so before anything in the buffer refers to it.
+ */
+void FTFontWrapper::map_string(const string &str)
+{
+    const char *sp = str.c_str();
+    char32_t c;
+    while (int s = utf8towc(&c, sp))
+    {
+        sp += s;
+        if (c != '\n' && get_glyph_info(c).renderable)
+            map_unicode(c);
+    }
+}
+
 void FTFontWrapper::render_textblock(unsigned int x_pos, unsigned int y_pos,
                                      char32_t *chars,
                                      uint8_t *colours,
                                      unsigned int width, unsigned int height,
                                      bool drop_shadow)
 {
-    if (!chars || !colours || !width || !height || !m_atlas)
+    if (!chars || !colours || !width || !height || m_atlas.empty())
         return;
 
+    // As map_string().
+    for (unsigned int j = 0; j < width * height; j++)
+        if (get_glyph_info(chars[j]).renderable)
+            map_unicode(chars[j]);
+
     coord_def adv(max(-m_min_offset, 0), 0);
     unsigned int i = 0;
 
     ASSERT(m_buf);
     m_buf->clear();
     n_subst = 0;
-
-    float texcoord_dy = (float)m_max_advance.y / (float)m_tex.height();
     for (unsigned int y = 0; y < height; y++)
     {
         for (unsigned int x = 0; x < width; x++)
@@ -396,10 +461,8 @@ void FTFontWrapper::render_textblock(unsigned int x_pos, unsigned int y_pos,
                 unsigned int c = map_unicode(chars[i]);
                 int this_width = glyph.width;
 
-                float tex_x = (float)(c % GLYPHS_PER_ROWCOL) / (float)GLYPHS_PER_ROWCOL;
-                float tex_y = (float)(c / GLYPHS_PER_ROWCOL) / (float)GLYPHS_PER_ROWCOL;
-                float tex_x2 = tex_x + (float)this_width / (float)m_tex.width();
-                float tex_y2 = tex_y + texcoord_dy;
+                float tex_x, tex_y, tex_x2, tex_y2;
+                atlas_coords(c, this_width, tex_x, tex_y, tex_x2, tex_y2);
 
                 GLWPrim rect(adv.x, adv.y - glyph.ascender + m_ascender,
                              adv.x + this_width, adv.y + m_max_advance.y - glyph.ascender + m_ascender);
@@ -417,7 +480,7 @@ void FTFontWrapper::render_textblock(unsigned int x_pos, unsigned int y_pos,
             adv.x += glyph.advance - glyph.offset;
 
             // See if we need to flush prematurely.
-            if (n_subst == MAX_GLYPHS - 1)
+            if (n_subst == (int) m_atlas.size() - 1)
             {
                 draw_m_buf(x_pos, y_pos, drop_shadow);
                 m_buf->clear();
@@ -511,6 +574,26 @@ unsigned int FTFontWrapper::string_width(const formatted_string &str, bool logic
 }
 
 unsigned int FTFontWrapper::string_width(const char *text, bool logical)
+{
+    unsigned int max_str_width = 0;
+
+    auto cached = m_width_cache.find(text);
+    if (cached != m_width_cache.end())
+        max_str_width = cached->second;
+    else
+    {
+        max_str_width = measure_width(text);
+        if (m_width_cache.size() >= MAX_CACHED_WIDTHS)
+            m_width_cache.clear();
+        m_width_cache.emplace(text, max_str_width);
+    }
+
+    return logical ? display_density.device_to_logical(max_str_width)
+                   : max_str_width;
+}
+
+// The width of a string in device pixels.
+unsigned int FTFontWrapper::measure_width(const char *text)
 {
     unsigned int base_width = max(-m_min_offset, 0);
     unsigned int max_str_width = 0;
@@ -535,9 +618,7 @@ unsigned int FTFontWrapper::string_width(const char *text, bool logical)
         }
     }
 
-    max_str_width = max(width + adjust, max_str_width);
-    return logical ? display_density.device_to_logical(max_str_width)
-                   : max_str_width;
+    return max(width + adjust, max_str_width);
 }
 
 // Find the position in `text` that does not exceed max_str_width, a width
@@ -780,6 +861,8 @@ void FTFontWrapper::store(FontBuffer &buf, float &x, float &y,
                           const string &str,
                           const VColour &fg, const VColour &bg, float orig_x)
 {
+    map_string(str);
+
     const char *sp = str.c_str();
     char32_t c;
     while (int s = utf8towc(&c, sp))
@@ -823,6 +906,10 @@ void FTFontWrapper::store(FontBuffer &buf, float &x, float &y,
 void FTFontWrapper::store(FontBuffer &buf, float &x, float &y,
                           const formatted_string &fs, float orig_x)
 {
+    for (const formatted_string::fs_op &op : fs.ops)
+        if (op.type == FSOP_TEXT)
+            map_string(op.text);
+
     int colour = LIGHTGREY;
     int bg = -1;
     for (const formatted_string::fs_op &op : fs.ops)
@@ -880,10 +967,8 @@ void FTFontWrapper::store(FontBuffer &buf, float &x, float &y,
     float pos_ey = y + (m_max_advance.y - glyph.ascender + m_ascender)
                    * density_mult;
 
-    float tex_sx = (float)(c % GLYPHS_PER_ROWCOL) / (float)GLYPHS_PER_ROWCOL;
-    float tex_sy = (float)(c / GLYPHS_PER_ROWCOL) / (float)GLYPHS_PER_ROWCOL;
-    float tex_ex = tex_sx + (float)this_width / (float)(GLYPHS_PER_ROWCOL*charsz.x);
-    float tex_ey = tex_sy + (float)m_max_advance.y / (float)(GLYPHS_PER_ROWCOL*charsz.y);
+    float tex_sx, tex_sy, tex_ex, tex_ey;
+    atlas_coords(c, this_width, tex_sx, tex_sy, tex_ex, tex_ey);
 
     GLWPrim rect(pos_sx, pos_sy, pos_ex, pos_ey);
     rect.set_tex(tex_sx, tex_sy, tex_ex, tex_ey);
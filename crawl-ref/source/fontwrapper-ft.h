@@ -4,6 +4,7 @@
 #ifdef USE_FT
 
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 #include <ft2build.h>
@@ -82,6 +83,10 @@ public:
                                    unsigned int max_height) override;
 
     virtual const GenericTexture *font_tex() const override;
+    virtual unsigned int atlas_generation() const override
+    {
+        return m_atlas_generation;
+    }
 
 protected:
     // Not overrides! These two have an additional orig_x parameter compared
@@ -95,11 +100,17 @@ protected:
                float orig_x);
 
     int find_index_before_width(const char *str, int max_width);
+    unsigned int measure_width(const char *text);
 
     unsigned int map_unicode(char *ch);
-    unsigned int map_unicode(char32_t uchar, bool update);
     unsigned int map_unicode(char32_t uchar);
+    void map_string(const string &str);
     void load_glyph(unsigned int c, char32_t uchar);
+    void load_atlas_texture();
+    void grow_atlas();
+    void atlas_coords(unsigned int c, int width,
+                      float &tex_sx, float &tex_sy,
+                      float &tex_ex, float &tex_ey) const;
     void draw_m_buf(unsigned int x_pos, unsigned int y_pos, bool drop_shadow);
 
     struct GlyphInfo
@@ -116,16 +127,29 @@ protected:
         // does glyph have any pixels?
         bool renderable;
         bool valid;
+
+        // where it is in the atlas, or 0 if it isn't
+        uint16_t slot;
     };
     vector<GlyphInfo> m_glyphs;
     GlyphInfo& get_glyph_info(char32_t ch);
 
     struct FontAtlasEntry
     {
-        char32_t uchar;
+        char32_t uchar = 0;
+        // m_atlas_clock when last mapped, for evicting the least recent
+        unsigned int last_used = 0;
     };
-    FontAtlasEntry *m_atlas;
-    vector<char32_t> m_atlas_lru;
+    // A square grid of m_atlas_side glyphs a side, which grows when full.
+    vector<FontAtlasEntry> m_atlas;
+    unsigned int m_atlas_side;
+    unsigned int m_atlas_count;
+    unsigned int m_atlas_clock;
+    unsigned int m_atlas_generation;
+
+    // Widths of recently measured strings, in device pixels. Menus and
+    // tooltips measure the same strings every frame.
+    unordered_map<string, unsigned int> m_width_cache;
 
     // count of glyph loads in the current text block
     int n_subst;
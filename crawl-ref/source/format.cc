@@ -179,7 +179,14 @@ void formatted_string::parse_string1(const string &s, formatted_string &fs,
 
         if (s[tag] != '<' || tag >= length - 1)
         {
-            currs += s[tag];
+            // Take the whole run of plain text up to the next tag at once,
+            // but no more than the check above allows for.
+            string::size_type run = s.find('<', tag + 1);
+            if (run == string::npos)
+                run = length;
+            run = min(run - tag, 999 - currs.size());
+            currs.append(s, tag, run);
+            tag += run - 1;
             continue;
         }
 
@@ -0,0 +1,932 @@
+#include "AppHdr.h"
+
+#ifdef USE_TILE_LOCAL
+#ifdef USE_GL
+#ifdef USE_GL3
+
+#include "glwrapper-gl3.h"
+
+#include <cstddef>
+
+#ifdef USE_GLES
+# include <GLES3/gl3.h>
+#elif defined(__APPLE__)
+# include <OpenGL/gl3.h>
+#else
+// The GL 1.2+ entry points; glwrapper-gl3 needs a GL library that exports
+// them, which opengl32 on Windows doesn't.
+# define GL_GLEXT_PROTOTYPES
+# include <SDL_opengl.h>
+#endif
+
+#include "options.h"
+#include "stringutil.h"
+#include "tilesdl.h"
+
+#ifdef __ANDROID__
+# include <android/log.h>
+#endif
+
+namespace opengl
+{
+    bool check_texture_size(const char *name, int width, int height)
+    {
+        int max_texture_size;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+        if (width > max_texture_size || height > max_texture_size)
+        {
+            mprf(MSGCH_ERROR,
+                "Texture %s is bigger than maximum driver texture size "
+                "(%d,%d vs. %d). Sprites from this texture will not display "
+                "properly.",
+                name, width, height, max_texture_size);
+            return false;
+        }
+        return true;
+    }
+
+    static string _gl_error_to_string(GLenum e)
+    {
+        switch (e)
+        {
+        case GL_NO_ERROR:
+            return "GL_NO_ERROR";
+        case GL_INVALID_ENUM:
+            return "GL_INVALID_ENUM";
+        case GL_INVALID_VALUE:
+            return "GL_INVALID_VALUE";
+        case GL_INVALID_OPERATION:
+            return "GL_INVALID_OPERATION";
+        case GL_INVALID_FRAMEBUFFER_OPERATION:
+            return "GL_INVALID_FRAMEBUFFER_OPERATION";
+        case GL_OUT_OF_MEMORY:
+            return "GL_OUT_OF_MEMORY (fatal)";
+        default:
+            return make_stringf("Unknown OpenGL error %d", e);
+        }
+    }
+
+    /**
+     * Log any opengl errors to console. Will crash if a really bad one occurs.
+     *
+     * @return true if there were any errors.
+     */
+    bool flush_opengl_errors()
+    {
+        GLenum e = GL_NO_ERROR;
+        bool fatal = false;
+        bool errors = false;
+        do
+        {
+            e = glGetError();
+            if (e != GL_NO_ERROR)
+            {
+                errors = true;
+                if (e == GL_OUT_OF_MEMORY)
+                    fatal = true;
+                mprf(MSGCH_ERROR, "OpenGL error %s",
+                                        _gl_error_to_string(e).c_str());
+            }
+        } while (e != GL_NO_ERROR);
+        if (fatal)
+            die("Fatal OpenGL error; giving up");
+        return errors;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Static functions from GLStateManager
+
+GLStateManager *glmanager = nullptr;
+
+void GLStateManager::init()
+{
+    if (glmanager)
+        return;
+
+    glmanager = new GL3StateManager();
+}
+
+void GLStateManager::shutdown()
+{
+    delete glmanager;
+    glmanager = nullptr;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Static functions from GLShapeBuffer
+
+GLShapeBuffer *GLShapeBuffer::create(bool texture, bool colour,
+                                     drawing_modes prim)
+{
+    return new GL3ShapeBuffer(texture, colour, prim);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Shaders
+
+#ifdef USE_GLES
+# define GLSL_VERSION "#version 300 es\n"
+# define GLSL_PRECISION "precision mediump float;\n"
+#else
+# define GLSL_VERSION "#version 330 core\n"
+# define GLSL_PRECISION ""
+#endif
+
+// Each instance is a rectangle, drawn as a four vertex triangle strip, or
+// a line, drawn as two vertices. The corners are picked out of the start
+// and end positions and texture coordinates by the vertex number. As in
+// glwrapper-ogl, a rectangle's start colour is at its top and its end
+// colour at its bottom. Positions are in (logical) pixels, as with the
+// glOrtho projection the fixed function renderer uses, less the origin of
+// the offscreen target being drawn to, if any.
+static const char *_vertex_shader = GLSL_VERSION R"(
+uniform vec2 u_viewport;
+uniform vec2 u_origin;
+uniform vec3 u_trans;
+uniform vec3 u_scale;
+uniform bool u_lines;
+
+layout(location = 0) in vec3 a_pos_s;
+layout(location = 1) in vec2 a_pos_e;
+layout(location = 2) in vec4 a_tex;
+layout(location = 3) in vec4 a_col_s;
+layout(location = 4) in vec4 a_col_e;
+
+out vec2 v_tex;
+out vec4 v_col;
+
+void main()
+{
+    vec2 pick;
+    if (u_lines)
+        pick = vec2(float(gl_VertexID));
+    else
+        pick = vec2(float(gl_VertexID >> 1), float(gl_VertexID & 1));
+
+    vec3 pos = vec3(mix(a_pos_s.xy, a_pos_e, pick), a_pos_s.z);
+    pos = pos * u_scale + u_trans;
+    pos.xy -= u_origin;
+    gl_Position = vec4(2.0 * pos.x / u_viewport.x - 1.0,
+                       1.0 - 2.0 * pos.y / u_viewport.y,
+                       -pos.z / 1000.0, 1.0);
+
+    v_tex = mix(a_tex.xy, a_tex.zw, pick);
+    v_col = mix(a_col_s, a_col_e, pick.y);
+}
+)";
+
+// Texturing modulates the colour, and the alpha test discards fragments
+// whose alpha equals the reference, as GL_MODULATE and
+// glAlphaFunc(GL_NOTEQUAL, ...) do.
+static const char *_fragment_shader = GLSL_VERSION GLSL_PRECISION R"(
+uniform sampler2D u_tex;
+uniform bool u_texture;
+uniform bool u_vert_colour;
+uniform vec4 u_colour;
+uniform bool u_alphatest;
+uniform float u_alpharef;
+
+in vec2 v_tex;
+in vec4 v_col;
+
+out vec4 frag_colour;
+
+void main()
+{
+    vec4 col = u_vert_colour ? v_col : u_colour;
+    if (u_texture)
+        col *= texture(u_tex, v_tex);
+    if (u_alphatest && col.a == u_alpharef)
+        discard;
+    frag_colour = col;
+}
+)";
+
+static GLuint _compile_shader(GLenum type, const char *source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint ok = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok)
+    {
+        char log[1024] = "";
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        die("Could not compile %s shader: %s",
+            type == GL_VERTEX_SHADER ? "vertex" : "fragment", log);
+    }
+    return shader;
+}
+
+static GLuint _link_program()
+{
+    const GLuint vs = _compile_shader(GL_VERTEX_SHADER, _vertex_shader);
+    const GLuint fs = _compile_shader(GL_FRAGMENT_SHADER, _fragment_shader);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glLinkProgram(program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok)
+    {
+        char log[1024] = "";
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+        die("Could not link shader program: %s", log);
+    }
+    return program;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Instance arrays, shared by GL3ShapeBuffer and the batches of GL3StateManager
+
+// Create a vertex array for instances, and its buffer. Both are left bound.
+static void _create_instance_array(GLuint *vao, GLuint *vbo)
+{
+    glGenVertexArrays(1, vao);
+    glGenBuffers(1, vbo);
+    glBindVertexArray(*vao);
+    glBindBuffer(GL_ARRAY_BUFFER, *vbo);
+
+    const GLsizei stride = sizeof(GL3Instance);
+    const struct
+    {
+        GLint size;
+        GLenum type;
+        GLboolean normalise;
+        size_t offset;
+    } attribs[] =
+    {
+        { 3, GL_FLOAT, GL_FALSE, offsetof(GL3Instance, pos_sx) },
+        { 2, GL_FLOAT, GL_FALSE, offsetof(GL3Instance, pos_ex) },
+        { 4, GL_FLOAT, GL_FALSE, offsetof(GL3Instance, tex_sx) },
+        { 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(GL3Instance, col_s) },
+        { 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(GL3Instance, col_e) },
+    };
+    for (unsigned int i = 0; i < ARRAYSZ(attribs); ++i)
+    {
+        glEnableVertexAttribArray(i);
+        glVertexAttribPointer(i, attribs[i].size, attribs[i].type,
+                              attribs[i].normalise, stride,
+                              (const void *) attribs[i].offset);
+        glVertexAttribDivisor(i, 1);
+    }
+}
+
+// Upload instances to the bound buffer, growing it if need be.
+static void _upload_instances(const vector<GL3Instance> &instances,
+                              size_t &capacity)
+{
+    const size_t bytes = instances.size() * sizeof(GL3Instance);
+    if (bytes > capacity)
+    {
+        glBufferData(GL_ARRAY_BUFFER, bytes, &instances[0], GL_DYNAMIC_DRAW);
+        capacity = bytes;
+    }
+    else
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, &instances[0]);
+}
+
+static void _draw_instances(bool lines, size_t count)
+{
+    if (lines)
+        glDrawArraysInstanced(GL_LINES, 0, 2, count);
+    else
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GL3StateManager
+
+GL3StateManager::GL3StateManager() :
+    m_trans(0, 0, 0),
+    m_scale(1, 1, 1),
+    m_target(0),
+    m_view_height(0),
+    m_lines(false),
+    m_vert_colour(false),
+    m_bound_texture(0),
+    m_queue_lines(false),
+    m_queue_colours(false),
+    m_batch_vao(0),
+    m_batch_vbo(0),
+    m_batch_capacity(0)
+{
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glClearColor(0.0, 0.0, 0.0, 1.0f);
+    glDepthFunc(GL_LEQUAL);
+
+    m_program = _link_program();
+    glUseProgram(m_program);
+    glDebug("glUseProgram");
+
+    m_u_viewport    = glGetUniformLocation(m_program, "u_viewport");
+    m_u_origin      = glGetUniformLocation(m_program, "u_origin");
+    m_u_trans       = glGetUniformLocation(m_program, "u_trans");
+    m_u_scale       = glGetUniformLocation(m_program, "u_scale");
+    m_u_lines       = glGetUniformLocation(m_program, "u_lines");
+    m_u_texture     = glGetUniformLocation(m_program, "u_texture");
+    m_u_vert_colour = glGetUniformLocation(m_program, "u_vert_colour");
+    m_u_colour      = glGetUniformLocation(m_program, "u_colour");
+    m_u_alphatest   = glGetUniformLocation(m_program, "u_alphatest");
+    m_u_alpharef    = glGetUniformLocation(m_program, "u_alpharef");
+
+    // Match the defaults of m_current_state, which are GL's.
+    glUniform1i(glGetUniformLocation(m_program, "u_tex"), 0);
+    glUniform2f(m_u_origin, 0, 0);
+    glUniform3f(m_u_trans, 0, 0, 0);
+    glUniform3f(m_u_scale, 1, 1, 1);
+    glUniform1i(m_u_lines, 0);
+    glUniform1i(m_u_texture, 0);
+    glUniform1i(m_u_vert_colour, 0);
+    glUniform4f(m_u_colour, 1, 1, 1, 1);
+    glUniform1i(m_u_alphatest, 0);
+    glUniform1f(m_u_alpharef, 0);
+    glDebug("glUniform");
+}
+
+GL3StateManager::~GL3StateManager()
+{
+    for (GL3ShapeBuffer *buf : m_queue)
+        buf->m_queued = false;
+    while (!m_targets.empty())
+        delete_target(m_targets.begin()->first);
+    if (m_batch_vao)
+    {
+        glDeleteBuffers(1, (GLuint*)&m_batch_vbo);
+        glDeleteVertexArrays(1, (GLuint*)&m_batch_vao);
+    }
+    glDeleteProgram(m_program);
+}
+
+void GL3StateManager::set(const GLState& state)
+{
+    if (state.texture != m_current_state.texture)
+        glUniform1i(m_u_texture, state.texture);
+
+    if (state.blend != m_current_state.blend)
+    {
+        if (state.blend)
+            glEnable(GL_BLEND);
+        else
+            glDisable(GL_BLEND);
+        glDebug("GL_BLEND");
+    }
+
+    if (state.depthtest != m_current_state.depthtest)
+    {
+        if (state.depthtest)
+            glEnable(GL_DEPTH_TEST);
+        else
+            glDisable(GL_DEPTH_TEST);
+        glDebug("GL_DEPTH_TEST");
+    }
+
+    if (state.alphatest != m_current_state.alphatest
+        || state.alpharef != m_current_state.alpharef)
+    {
+        glUniform1i(m_u_alphatest, state.alphatest);
+        // glAlphaFunc clamps its reference to [0, 1].
+        glUniform1f(m_u_alpharef, min((float) state.alpharef, 1.0f));
+        glDebug("u_alphatest");
+    }
+
+    if (state.colour != m_current_state.colour)
+    {
+        glUniform4f(m_u_colour, state.colour.r / 255.0f,
+                    state.colour.g / 255.0f, state.colour.b / 255.0f,
+                    state.colour.a / 255.0f);
+        glDebug("u_colour");
+    }
+
+    m_current_state = state;
+}
+
+void GL3StateManager::set_buffer_format(bool lines, bool colours)
+{
+    if (lines != m_lines)
+    {
+        glUniform1i(m_u_lines, lines);
+        m_lines = lines;
+    }
+    if (colours != m_vert_colour)
+    {
+        glUniform1i(m_u_vert_colour, colours);
+        m_vert_colour = colours;
+    }
+}
+
+void GL3StateManager::queue(GL3ShapeBuffer *buf, const GLState &state)
+{
+    const bool lines = buf->m_prim_type == GLW_LINES;
+    const bool colours = state.array_colour && buf->m_colour_verts;
+    if (!m_queue.empty()
+        && (!(state == m_queue_state) || lines != m_queue_lines
+            || colours != m_queue_colours))
+    {
+        flush();
+    }
+
+    m_queue.push_back(buf);
+    buf->m_queued = true;
+    m_queue_state = state;
+    m_queue_lines = lines;
+    m_queue_colours = colours;
+}
+
+void GL3StateManager::flush()
+{
+    if (m_queue.empty())
+        return;
+
+    set(m_queue_state);
+    set_buffer_format(m_queue_lines, m_queue_colours);
+
+    // A buffer on its own is drawn from its own, retained, vertex buffer.
+    if (m_queue.size() == 1)
+        m_queue[0]->draw_instances();
+    else
+    {
+        m_batch.clear();
+        for (const GL3ShapeBuffer *buf : m_queue)
+        {
+            m_batch.insert(m_batch.end(), buf->m_instances.begin(),
+                           buf->m_instances.end());
+        }
+        draw_batch(m_queue_lines);
+    }
+
+    for (GL3ShapeBuffer *buf : m_queue)
+        buf->m_queued = false;
+    m_queue.clear();
+}
+
+// Draw the instances in m_batch, with the state already set.
+void GL3StateManager::draw_batch(bool lines)
+{
+    if (!m_batch_vao)
+    {
+        _create_instance_array((GLuint*)&m_batch_vao, (GLuint*)&m_batch_vbo);
+        glDebug("glVertexAttribPointer");
+    }
+    else
+    {
+        glBindVertexArray(m_batch_vao);
+        glBindBuffer(GL_ARRAY_BUFFER, m_batch_vbo);
+    }
+    _upload_instances(m_batch, m_batch_capacity);
+    glDebug("glBufferData");
+    _draw_instances(lines, m_batch.size());
+    glDebug("glDrawArraysInstanced");
+}
+
+unsigned int GL3StateManager::create_target(int w, int h)
+{
+    if (w <= 0 || h <= 0)
+        return 0;
+
+    flush();
+
+    render_target t;
+    t.w = w;
+    t.h = h;
+    const int dw = logical_to_device(w);
+    const int dh = logical_to_device(h);
+
+    glGenTextures(1, (GLuint*)&t.tex);
+    glBindTexture(GL_TEXTURE_2D, t.tex);
+    m_bound_texture = t.tex;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, dw, dh, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, nullptr);
+
+    glGenRenderbuffers(1, (GLuint*)&t.depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, t.depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, dw, dh);
+
+    glGenFramebuffers(1, (GLuint*)&t.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, t.fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                           GL_TEXTURE_2D, t.tex, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                              GL_RENDERBUFFER, t.depth);
+    const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER)
+                          == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER,
+                      m_target ? m_targets[m_target].fbo : 0);
+    glDebug("glFramebufferTexture2D");
+
+    m_targets[t.fbo] = t;
+    if (!complete)
+    {
+        delete_target(t.fbo);
+        return 0;
+    }
+    return t.fbo;
+}
+
+void GL3StateManager::delete_target(unsigned int target)
+{
+    auto it = m_targets.find(target);
+    if (it == m_targets.end())
+        return;
+
+    flush();
+    if (m_target == target)
+        bind_target(0, 0, 0);
+
+    render_target &t = it->second;
+    if (m_bound_texture == t.tex)
+        m_bound_texture = 0;
+    glDeleteFramebuffers(1, (GLuint*)&t.fbo);
+    glDeleteRenderbuffers(1, (GLuint*)&t.depth);
+    glDeleteTextures(1, (GLuint*)&t.tex);
+    glDebug("glDeleteFramebuffers");
+    m_targets.erase(it);
+}
+
+void GL3StateManager::set_view(const coord_def &size,
+                               const coord_def &device_size,
+                               const coord_def &origin)
+{
+    glViewport(0, 0, device_size.x, device_size.y);
+    m_view_height = size.y;
+    m_target_pos = origin;
+
+    // For ease, vertex positions are pixel positions.
+    glUniform2f(m_u_viewport, size.x, size.y);
+    glUniform2f(m_u_origin, origin.x, origin.y);
+    glDebug("u_viewport");
+}
+
+void GL3StateManager::bind_target(unsigned int target, int x, int y)
+{
+    flush();
+
+    auto it = m_targets.find(target);
+    if (it == m_targets.end())
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        m_target = 0;
+        set_view(m_windowsz, m_drawablesz, coord_def(0, 0));
+        return;
+    }
+
+    const render_target &t = it->second;
+    glBindFramebuffer(GL_FRAMEBUFFER, t.fbo);
+    m_target = target;
+    const coord_def size(t.w, t.h);
+    set_view(size, coord_def(logical_to_device(t.w), logical_to_device(t.h)),
+             coord_def(x, y));
+
+    // Start from what the window is cleared to.
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glDebug("glBindFramebuffer");
+}
+
+// Copy a target to the window at (x, y). Its pixels replace what's there,
+// just as they replaced the cleared background when drawn.
+void GL3StateManager::draw_target(unsigned int target, int x, int y)
+{
+    auto it = m_targets.find(target);
+    if (it == m_targets.end())
+        return;
+    const render_target &t = it->second;
+
+    bind_texture(t.tex);
+    flush();
+
+    GLState state;
+    state.array_vertex = true;
+    state.array_texcoord = true;
+    state.texture = true;
+    state.blend = false;
+    set(state);
+    set_buffer_format(false, false);
+
+    GLW_3VF trans, scale;
+    get_transform(&trans, &scale);
+    set_transform({0, 0, 0}, {1, 1, 1});
+
+    // The target's first row is the bottom of what was drawn.
+    GL3Instance inst;
+    inst.pos_sx = x;
+    inst.pos_sy = y;
+    inst.pos_z = 0;
+    inst.pos_ex = x + t.w;
+    inst.pos_ey = y + t.h;
+    inst.tex_sx = 0;
+    inst.tex_sy = 1;
+    inst.tex_ex = 1;
+    inst.tex_ey = 0;
+    inst.col_s = inst.col_e = VColour::white;
+    m_batch.assign(1, inst);
+    draw_batch(false);
+
+    set_transform(trans, scale);
+}
+
+void GL3StateManager::set_transform(const GLW_3VF &trans, const GLW_3VF &scale)
+{
+    flush();
+    glUniform3f(m_u_trans, trans.x, trans.y, trans.z);
+    glUniform3f(m_u_scale, scale.x, scale.y, scale.z);
+    m_trans = trans;
+    m_scale = scale;
+}
+
+void GL3StateManager::reset_transform()
+{
+    set_transform({0,0,0}, {1,1,1});
+}
+
+void GL3StateManager::get_transform(GLW_3VF *trans, GLW_3VF *scale)
+{
+    if (trans)
+        *trans = m_trans;
+    if (scale)
+        *scale = m_scale;
+}
+
+int GL3StateManager::logical_to_device(int n) const
+{
+    return display_density.logical_to_device(n);
+}
+
+int GL3StateManager::device_to_logical(int n, bool round) const
+{
+    return display_density.device_to_logical(n, round);
+}
+
+void GL3StateManager::set_scissor(int x, int y, unsigned int w, unsigned int h)
+{
+    flush();
+    x -= m_target_pos.x;
+    y -= m_target_pos.y;
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(logical_to_device(x), logical_to_device(m_view_height-y-h),
+                logical_to_device(w), logical_to_device(h));
+}
+
+void GL3StateManager::reset_scissor()
+{
+    flush();
+    glDisable(GL_SCISSOR_TEST);
+}
+
+void GL3StateManager::reset_view_for_resize(const coord_def &windowsz,
+                                            const coord_def &drawablesz)
+{
+    flush();
+    m_windowsz = windowsz;
+    m_drawablesz = drawablesz;
+    if (!m_target)
+        set_view(m_windowsz, m_drawablesz, coord_def(0, 0));
+}
+
+void GL3StateManager::pixelstore_unpack_alignment(unsigned int bpp)
+{
+    glPixelStorei(GL_UNPACK_ALIGNMENT, bpp);
+    glDebug("glPixelStorei");
+}
+
+void GL3StateManager::delete_textures(size_t count, unsigned int *textures)
+{
+    flush();
+    m_bound_texture = 0;
+    glDeleteTextures(count, (GLuint*)textures);
+    glDebug("glDeleteTextures");
+}
+
+void GL3StateManager::generate_textures(size_t count, unsigned int *textures)
+{
+    glGenTextures(count, (GLuint*)textures);
+    glDebug("glGenTextures");
+}
+
+void GL3StateManager::bind_texture(unsigned int texture)
+{
+    // The floor, wall and feature pages share a texture, so this is often
+    // already bound.
+    if (texture == m_bound_texture)
+        return;
+
+    flush();
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glDebug("glBindTexture");
+    m_bound_texture = texture;
+}
+
+void GL3StateManager::load_texture(unsigned char *pixels, unsigned int width,
+                                   unsigned int height, MipMapOptions mip_opt,
+                                   int xoffset, int yoffset)
+{
+    // Assumptions...
+    const GLenum texture_format = GL_RGBA;
+    const GLenum format = GL_UNSIGNED_BYTE;
+    // Also assume that the texture is already bound using bind_texture
+
+    // Held back draws may use the old contents.
+    flush();
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    const GLint filter = Options.tile_filter_scaling ? GL_LINEAR : GL_NEAREST;
+    // TODO: should min react to Options.tile_filter_scaling?
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    mip_opt == MIPMAP_CREATE ? GL_LINEAR_MIPMAP_NEAREST
+                                             : filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glDebug("glTexParameteri");
+
+    if (xoffset >= 0 && yoffset >= 0)
+    {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, xoffset, yoffset, width, height,
+                        texture_format, format, pixels);
+        glDebug("glTexSubImage2D");
+    }
+    else
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0,
+                     texture_format, format, pixels);
+        glDebug("glTexImage2D");
+    }
+
+    if (mip_opt == MIPMAP_CREATE)
+    {
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glDebug("glGenerateMipmap");
+    }
+}
+
+void GL3StateManager::reset_view_for_redraw()
+{
+    flush();
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // As glwrapper-ogl does with its modelview matrix.
+    set_transform({0, 0, 1}, {1, 1, 1});
+}
+
+bool GL3StateManager::glDebug(const char* msg) const
+{
+#if defined(__ANDROID__) || defined(DEBUG_DIAGNOSTICS)
+    int e = glGetError();
+    if (e > 0)
+    {
+# ifdef __ANDROID__
+        __android_log_print(ANDROID_LOG_INFO, "Crawl.gl", "ERROR %x: %s", e, msg);
+# else
+        fprintf(stderr, "GL3StateManager ERROR %x: %s\n", e, msg);
+# endif
+        return true;
+    }
+#else
+    UNUSED(msg);
+#endif
+    return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GL3ShapeBuffer
+
+GL3ShapeBuffer::GL3ShapeBuffer(bool texture, bool colour, drawing_modes prim) :
+    m_prim_type(prim),
+    m_texture_verts(texture),
+    m_colour_verts(colour),
+    m_vao(0),
+    m_vbo(0),
+    m_vbo_capacity(0),
+    m_dirty(true),
+    m_queued(false)
+{
+    ASSERT(prim == GLW_RECTANGLE || prim == GLW_LINES);
+}
+
+GL3ShapeBuffer::~GL3ShapeBuffer()
+{
+    flush_queued();
+    if (m_vao)
+    {
+        glDeleteBuffers(1, (GLuint*)&m_vbo);
+        glDeleteVertexArrays(1, (GLuint*)&m_vao);
+    }
+}
+
+const char *GL3ShapeBuffer::print_statistics() const
+{
+    return nullptr;
+}
+
+unsigned int GL3ShapeBuffer::size() const
+{
+    // In vertices, as for glwrapper-ogl.
+    return m_instances.size() * (m_prim_type == GLW_LINES ? 2 : 4);
+}
+
+void GL3ShapeBuffer::flush_queued()
+{
+    if (m_queued)
+        glmanager->flush();
+}
+
+void GL3ShapeBuffer::add(const GLWPrim &rect)
+{
+    flush_queued();
+
+    GL3Instance inst;
+    inst.pos_sx = rect.pos_sx;
+    inst.pos_sy = rect.pos_sy;
+    inst.pos_z = rect.pos_z;
+    inst.pos_ex = rect.pos_ex;
+    inst.pos_ey = rect.pos_ey;
+    if (m_texture_verts)
+    {
+        inst.tex_sx = rect.tex_sx;
+        inst.tex_sy = rect.tex_sy;
+        inst.tex_ex = rect.tex_ex;
+        inst.tex_ey = rect.tex_ey;
+    }
+    else
+        inst.tex_sx = inst.tex_sy = inst.tex_ex = inst.tex_ey = 0.0f;
+    inst.col_s = m_colour_verts ? rect.col_s : VColour::white;
+    inst.col_e = m_colour_verts ? rect.col_e : VColour::white;
+
+    m_instances.push_back(inst);
+    m_dirty = true;
+}
+
+// Queue the buffer to be drawn; see GL3StateManager::queue().
+void GL3ShapeBuffer::draw(const GLState &state)
+{
+    if (m_instances.empty())
+        return;
+
+    if (!state.array_vertex)
+        return;
+
+    static_cast<GL3StateManager *>(glmanager)->queue(this, state);
+}
+
+void GL3ShapeBuffer::draw_instances()
+{
+    if (!m_vao)
+    {
+        _create_instance_array((GLuint*)&m_vao, (GLuint*)&m_vbo);
+        glDebug("glVertexAttribPointer");
+    }
+    else
+        glBindVertexArray(m_vao);
+
+    // Only upload what changed since the last draw: most buffers are drawn
+    // many times between changes.
+    if (m_dirty)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        _upload_instances(m_instances, m_vbo_capacity);
+        glDebug("glBufferData");
+        m_dirty = false;
+    }
+
+    _draw_instances(m_prim_type == GLW_LINES, m_instances.size());
+    glDebug("glDrawArraysInstanced");
+}
+
+void GL3ShapeBuffer::clear()
+{
+    flush_queued();
+    m_instances.clear();
+    m_dirty = true;
+}
+
+bool GL3ShapeBuffer::glDebug(const char* msg) const
+{
+#if defined(__ANDROID__) || defined(DEBUG_DIAGNOSTICS)
+    int e = glGetError();
+    if (e > 0)
+    {
+# ifdef __ANDROID__
+        __android_log_print(ANDROID_LOG_INFO, "Crawl.gl", "ERROR %x: %s", e, msg);
+# else
+        fprintf(stderr, "GL3ShapeBuffer ERROR %x: %s\n", e, msg);
+# endif
+        return true;
+    }
+#else
+    UNUSED(msg);
+#endif
+    return false;
+}
+
+#endif // USE_GL3
+#endif // USE_GL
+#endif // USE_TILE_LOCAL
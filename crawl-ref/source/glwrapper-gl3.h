@@ -0,0 +1,166 @@
+#pragma once
+
+#ifdef USE_TILE_LOCAL
+#ifdef USE_GL
+#ifdef USE_GL3
+
+#include <map>
+#include <vector>
+
+#include "glwrapper.h"
+
+using std::map;
+using std::vector;
+
+// The OpenGL 3.3 core (or OpenGL ES 3) renderer, built with USE_GL3 in
+// place of glwrapper-ogl. Instead of the fixed function pipeline, one
+// shader program draws everything; each rectangle or line is a single
+// instance, expanded into its corners by the vertex shader.
+
+// One rectangle or line; see the attributes in glwrapper-gl3.cc.
+struct GL3Instance
+{
+    float pos_sx, pos_sy, pos_z;
+    float pos_ex, pos_ey;
+    float tex_sx, tex_sy, tex_ex, tex_ey;
+    VColour col_s, col_e;
+};
+
+class GL3ShapeBuffer;
+
+class GL3StateManager : public GLStateManager
+{
+public:
+    GL3StateManager();
+    virtual ~GL3StateManager();
+
+    // State Manipulation
+    virtual void set(const GLState& state) override;
+    virtual void pixelstore_unpack_alignment(unsigned int bpp) override;
+    virtual void reset_view_for_redraw() override;
+    virtual void reset_view_for_resize(const coord_def &m_windowsz,
+                                       const coord_def &m_drawablesz) override;
+    virtual void set_transform(const GLW_3VF &trans, const GLW_3VF &scale) override;
+    virtual void reset_transform() override;
+    virtual void get_transform(GLW_3VF *trans, GLW_3VF *scale) override;
+    virtual void set_scissor(int x, int y, unsigned int w, unsigned int h) override;
+    virtual void reset_scissor() override;
+
+    // Texture-specific functions
+    virtual void delete_textures(size_t count, unsigned int *textures) override;
+    virtual void generate_textures(size_t count, unsigned int *textures) override;
+    virtual void bind_texture(unsigned int texture) override;
+    virtual void load_texture(unsigned char *pixels, unsigned int width,
+                              unsigned int height, MipMapOptions mip_opt,
+                              int xoffset=-1, int yoffset=-1) override;
+    int logical_to_device(int n) const override;
+    int device_to_logical(int n, bool round=true) const override;
+
+    // Set by GL3ShapeBuffer before drawing: what its instances hold.
+    void set_buffer_format(bool lines, bool colours);
+
+    // Draws are held back, so that a run of buffers with the same state,
+    // format and texture (the dungeon layers, say) goes out as one draw.
+    // Anything that changes what they would draw submits them first.
+    void queue(GL3ShapeBuffer *buf, const GLState &state);
+    virtual void flush() override;
+
+    virtual unsigned int create_target(int w, int h) override;
+    virtual void delete_target(unsigned int target) override;
+    virtual void bind_target(unsigned int target, int x, int y) override;
+    virtual void draw_target(unsigned int target, int x, int y) override;
+
+protected:
+    GLState m_current_state;
+    coord_def m_windowsz, m_drawablesz;
+    GLW_3VF m_trans, m_scale;
+
+    // What is being drawn to: the window, or an offscreen target.
+    struct render_target
+    {
+        unsigned int fbo, tex, depth;
+        int w, h;
+    };
+    map<unsigned int, render_target> m_targets;
+    unsigned int m_target;
+    coord_def m_target_pos;
+    int m_view_height;
+
+    unsigned int m_program;
+    // Uniform locations
+    int m_u_viewport, m_u_origin, m_u_trans, m_u_scale, m_u_lines;
+    int m_u_texture, m_u_vert_colour, m_u_colour;
+    int m_u_alphatest, m_u_alpharef;
+
+    // Uniform values last set, to skip setting them again.
+    bool m_lines, m_vert_colour;
+
+    unsigned int m_bound_texture;
+
+    // The held back draws; see queue().
+    vector<GL3ShapeBuffer *> m_queue;
+    GLState m_queue_state;
+    bool m_queue_lines, m_queue_colours;
+
+    // Instances of a run of several buffers, drawn from their own buffer.
+    vector<GL3Instance> m_batch;
+    unsigned int m_batch_vao;
+    unsigned int m_batch_vbo;
+    size_t m_batch_capacity;
+    void draw_batch(bool lines);
+
+    void set_view(const coord_def &size, const coord_def &device_size,
+                  const coord_def &origin);
+
+private:
+    bool glDebug(const char* msg) const;
+};
+
+class GL3ShapeBuffer : public GLShapeBuffer
+{
+public:
+    GL3ShapeBuffer(bool texture = false, bool colour = false,
+                   drawing_modes prim = GLW_RECTANGLE);
+    virtual ~GL3ShapeBuffer();
+
+    virtual const char *print_statistics() const override;
+    virtual unsigned int size() const override;
+
+    virtual void add(const GLWPrim &rect) override;
+    virtual void draw(const GLState &state) override;
+    virtual void clear() override;
+
+protected:
+    friend class GL3StateManager;
+
+    // Draw now, with the state already set.
+    void draw_instances();
+    // Submit any held back draw of this buffer before it changes.
+    void flush_queued();
+
+    drawing_modes m_prim_type;
+    bool m_texture_verts;
+    bool m_colour_verts;
+
+    vector<GL3Instance> m_instances;
+
+    // The vertex array and buffer are only created on the first draw, and
+    // the buffer is only uploaded again after the primitives change.
+    unsigned int m_vao;
+    unsigned int m_vbo;
+    size_t m_vbo_capacity;
+    bool m_dirty;
+
+    // Whether GL3StateManager is holding back a draw of this buffer.
+    bool m_queued;
+
+private:
+    bool glDebug(const char* msg) const;
+};
+
+struct HiDPIState;
+extern HiDPIState display_density;
+
+#endif // USE_GL3
+#endif // USE_GL
+#endif // USE_TILE_LOCAL
@@ -2,6 +2,7 @@
 
 #ifdef USE_TILE_LOCAL
 #ifdef USE_GL
+#ifndef USE_GL3
 
 #include "glwrapper-ogl.h"
 
@@ -641,5 +642,6 @@ bool OGLShapeBuffer::glDebug(const char* msg) const
     return false;
 }
 
+#endif // !USE_GL3
 #endif // USE_GL
 #endif // USE_TILE_LOCAL
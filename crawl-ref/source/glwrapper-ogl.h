@@ -2,6 +2,7 @@
 
 #ifdef USE_TILE_LOCAL
 #ifdef USE_GL
+#ifndef USE_GL3
 
 #include <vector>
 
@@ -77,5 +78,6 @@ private:
 struct HiDPIState;
 extern HiDPIState display_density;
 
+#endif // !USE_GL3
 #endif // USE_GL
 #endif // USE_TILE_LOCAL
@@ -163,6 +163,19 @@ public:
     virtual int logical_to_device(int n) const = 0;
     virtual int device_to_logical(int n, bool round=true) const = 0;
 
+    // Submit any draws held back to be merged, before the frame is shown.
+    virtual void flush() {}
+
+    // Offscreen targets, for regions that cache what they draw. A target
+    // covers w x h logical pixels from (x, y) of the window: while it is
+    // bound, drawing there lands in it instead. Renderers without them
+    // return 0 from create_target, and callers should draw directly.
+    virtual unsigned int create_target(int /*w*/, int /*h*/) { return 0; }
+    virtual void delete_target(unsigned int /*target*/) {}
+    // Bind 0 to draw to the window again.
+    virtual void bind_target(unsigned int /*target*/, int /*x*/, int /*y*/) {}
+    virtual void draw_target(unsigned int /*target*/, int /*x*/, int /*y*/) {}
+
     // Debug
 #ifdef ASSERTS
     static bool _valid(int num_verts, drawing_modes mode);
@@ -22,6 +22,10 @@
 #if defined(UNIX) || defined(TARGET_COMPILER_MINGW)
 #include <unistd.h>
 #endif
+#ifdef UNIX
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
 
 #include "branch.h"
 #include "chardump.h"
@@ -53,6 +57,7 @@
 #include "state.h"
 #include "status.h"
 #include "stringutil.h"
+#include "syscalls.h"
 #ifdef USE_TILE
  #include "tilepick.h"
 #endif
@@ -67,19 +72,30 @@ using namespace ui;
 
 #define SCORE_VERSION "0.1"
 
-// enough memory allocated to snarf in the scorefile entries
-static unique_ptr<scorefile_entry> hs_list[SCORE_FILE_ENTRIES];
-static int hs_list_size = 0;
+// A line of the scorefile. Inserting a score only needs the score of each
+// line, so the rest of it is only parsed when the entry is shown.
+struct hs_line
+{
+    string raw;
+    int score;
+    unique_ptr<scorefile_entry> entry;
+};
+
+// the scorefile entries, as read in
+static vector<hs_line> hs_list;
 static bool hs_list_initialized = false;
 
 static FILE *_hs_open(const char *mode, const string &filename);
 static void  _hs_close(FILE *handle);
 static bool  _hs_read(FILE *scores, scorefile_entry &dest);
-static void  _hs_write(FILE *scores, scorefile_entry &entry);
+static bool  _hs_read_line(FILE *scores, hs_line &dest);
+static void  _hs_read_list(FILE *scores);
+static scorefile_entry &_hs_entry(int index);
 static time_t _parse_time(const string &st);
 static string _xlog_escape(const string &s);
 static string _xlog_unescape(const string &s);
 static vector<string> _xlog_split_fields(const string &s);
+static int _xlog_score(const string &line);
 
 static string _score_file_name()
 {
@@ -108,9 +124,6 @@ int hiscores_new_entry(const scorefile_entry &ne)
     unwind_bool score_update(crawl_state.updating_scores, true);
 
     FILE *scores;
-    int i;
-    bool inserted = false;
-    int newest_entry = -1;
 
     // open highscore file (reading) -- nullptr is fatal!
     //
@@ -123,94 +136,156 @@ int hiscores_new_entry(const scorefile_entry &ne)
     // we're at the end of the file, seek back to beginning.
     fseek(scores, 0, SEEK_SET);
 
-    // read highscore file, inserting new entry at appropriate point,
-    for (i = 0; i < SCORE_FILE_ENTRIES; i++)
+    // Read the scores, and where each line starts: the new entry goes in
+    // before the first one it beats.
+    hs_list.clear();
+    hs_list_initialized = true;
+    int newest_entry = -1;
+    long insert_at = 0;
+    while (hs_list.size() < SCORE_FILE_ENTRIES)
     {
-        hs_list[i].reset(new scorefile_entry);
-        if (_hs_read(scores, *hs_list[i]) == false)
+        const long offset = ftell(scores);
+        hs_line line;
+        if (!_hs_read_line(scores, line))
+        {
+            if (newest_entry == -1)
+                insert_at = offset;
             break;
-
-        // compare points..
-        if (!inserted && ne.get_score() >= hs_list[i]->get_score())
+        }
+        if (newest_entry == -1 && ne.get_score() >= line.score)
         {
-            newest_entry = i;           // for later printing
-            inserted = true;
-            // copy read entry to i+1th position
-            // Fixed a nasty overflow bug here -- Sharp
-            if (i+1 < SCORE_FILE_ENTRIES)
-            {
-                hs_list[i + 1] = std::move(hs_list[i]);
-                hs_list[i].reset(new scorefile_entry(ne));
-                i++;
-            }
-            else
-                *hs_list[i] = ne; // copy new entry to current position
+            newest_entry = hs_list.size();
+            insert_at = offset;
         }
+        hs_list.push_back(move(line));
     }
 
-    // special case: lowest score, with room
-    if (!inserted && i < SCORE_FILE_ENTRIES)
-    {
-        newest_entry = i;
-        inserted = true;
-        // copy new entry
-        hs_list[i].reset(new scorefile_entry(ne));
-        i++;
-    }
-
-    hs_list_size = i;
-    hs_list_initialized = true;
+    // the lowest score, with room
+    if (newest_entry == -1 && hs_list.size() < SCORE_FILE_ENTRIES)
+        newest_entry = hs_list.size();
 
     // If we've still not inserted it, it's not a highscore.
-    if (!inserted)
+    if (newest_entry == -1)
     {
         _hs_close(scores);
         return -1;
     }
 
+    hs_line added;
+    added.entry.reset(new scorefile_entry(ne));
+    added.raw = added.entry->raw_string();
+    added.score = ne.get_score();
+    hs_list.insert(hs_list.begin() + newest_entry, move(added));
+    if (hs_list.size() > SCORE_FILE_ENTRIES)
+        hs_list.resize(SCORE_FILE_ENTRIES);
+
     // The old code closed and reopened the score file, leading to a
     // race condition where one Crawl process could overwrite the
-    // other's highscore. Now we truncate and rewrite the file without
-    // closing it.
-    if (ftruncate(fileno(scores), 0))
+    // other's highscore. Now we truncate the file without closing it,
+    // and only rewrite what comes after the new entry: the entries
+    // above it stay as they were.
+    if (ftruncate(fileno(scores), insert_at))
         end(1, true, "unable to truncate scorefile");
 
-    rewind(scores);
+    fseek(scores, insert_at, SEEK_SET);
 
     // write scorefile entries.
-    for (i = 0; i < hs_list_size; i++)
-    {
-        _hs_write(scores, *hs_list[i]);
-
-        // Leave in memory. Does this anyway if !inserted.
-        // Can write cleanup function if nessicary??
-        // hs_list[i].reset(nullptr);
-    }
+    for (size_t i = newest_entry; i < hs_list.size(); i++)
+        fputs(hs_list[i].raw.c_str(), scores);
 
     // close scorefile.
     _hs_close(scores);
     return newest_entry;
 }
 
-void logfile_new_entry(const scorefile_entry &ne)
+// Appends whole lines to an xlog file that other games append to at the
+// same time. On Unix it keeps the file open with O_APPEND, and a batch of
+// lines that goes out in one write() lands in one piece at the end of the
+// file without needing the lock. Anything else takes the lock, as before.
+class xlog_appender
 {
-    unwind_bool logfile_update(crawl_state.updating_scores, true);
+public:
+    xlog_appender() : fd(-1) { }
+    ~xlog_appender() { close_file(); }
+
+    bool append(const string &file, const string &lines)
+    {
+        if (lines.empty())
+            return true;
+#ifdef UNIX
+        if (lines.length() <= XLOG_ATOMIC_APPEND && open_file(file))
+        {
+            const ssize_t written = write(fd, lines.data(), lines.length());
+            if (written == (ssize_t) lines.length())
+                return true;
+            // Don't write any of it twice.
+            if (written > 0)
+                return locked_append(file, lines.substr(written));
+        }
+#endif
+        return locked_append(file, lines);
+    }
 
-    FILE *logfile;
-    scorefile_entry le = ne;
+private:
+    // Past this, a write() might not go out in one piece.
+    static const size_t XLOG_ATOMIC_APPEND = 4096;
+
+    int fd;
+    string path;
+
+#ifdef UNIX
+    bool open_file(const string &file)
+    {
+        // Reopen if the file has been moved away (say, rotated) or
+        // replaced since.
+        struct stat now, open_st;
+        if (fd != -1 && (file != path || stat(file.c_str(), &now)
+                         || fstat(fd, &open_st)
+                         || now.st_ino != open_st.st_ino
+                         || now.st_dev != open_st.st_dev))
+        {
+            close_file();
+        }
+        if (fd == -1)
+        {
+            fd = open_u(file.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0666);
+            path = file;
+        }
+        return fd != -1;
+    }
+#endif
 
-    // open logfile (appending) -- nullptr *is* fatal here.
-    logfile = _hs_open("a", _log_file_name());
-    if (logfile == nullptr)
+    void close_file()
     {
-        mprf(MSGCH_ERROR, "ERROR: failure writing to the logfile.");
-        return;
+#ifdef UNIX
+        if (fd != -1)
+            close(fd);
+#endif
+        fd = -1;
+    }
+
+    static bool locked_append(const string &file, const string &lines)
+    {
+        FILE *fp = lk_open("a", file);
+        if (!fp)
+            return false;
+        fputs(lines.c_str(), fp);
+        lk_close(fp);
+        return true;
     }
+};
+
+static xlog_appender logfile_appender;
+
+void logfile_new_entry(const scorefile_entry &ne)
+{
+    unwind_bool logfile_update(crawl_state.updating_scores, true);
 
-    _hs_write(logfile, le);
+    // Keep the milestones of the game in order before its end.
+    flush_milestones();
 
-    // close logfile.
-    _hs_close(logfile);
+    if (!logfile_appender.append(_log_file_name(), ne.raw_string()))
+        mprf(MSGCH_ERROR, "ERROR: failure writing to the logfile.");
 }
 
 template <class t_printf>
@@ -238,23 +313,13 @@ static void _hiscores_print_entry(const scorefile_entry &se,
 void hiscores_read_to_memory()
 {
     FILE *scores;
-    int i;
 
     // open highscore file (reading)
     scores = _hs_open("r", _score_file_name());
     if (scores == nullptr)
         return;
 
-    // read highscore file
-    for (i = 0; i < SCORE_FILE_ENTRIES; i++)
-    {
-        hs_list[i].reset(new scorefile_entry);
-        if (_hs_read(scores, *hs_list[i]) == false)
-            break;
-    }
-
-    hs_list_size = i;
-    hs_list_initialized = true;
+    _hs_read_list(scores);
 
     //close off
     _hs_close(scores);
@@ -304,7 +369,7 @@ string hiscores_print_list(int display_count, int format, int newest_entry, int&
     if (display_count <= 0)
         return "";
 
-    total_entries = hs_list_size;
+    total_entries = hs_list.size();
 
     int start = newest_entry - display_count / 2;
 
@@ -322,7 +387,7 @@ string hiscores_print_list(int display_count, int format, int newest_entry, int&
         if (i == newest_entry)
             ret += "<yellow>";
 
-        _hiscores_print_entry(*hs_list[i], i, format, [&ret](const char */*fmt*/, const char *s){
+        _hiscores_print_entry(_hs_entry(i), i, format, [&ret](const char */*fmt*/, const char *s){
             ret += string(s);
         });
 
@@ -466,19 +531,11 @@ void UIHiscoresMenu::_construct_hiscore_table()
     if (scores == nullptr)
         return;
 
-    int i;
-    // read highscore file
-    for (i = 0; i < SCORE_FILE_ENTRIES; i++)
-    {
-        hs_list[i].reset(new scorefile_entry);
-        if (_hs_read(scores, *hs_list[i]) == false)
-            break;
-    }
-
+    _hs_read_list(scores);
     _hs_close(scores);
 
-    for (int j=0; j<i; j++)
-        _add_hiscore_row(*hs_list[j], j);
+    for (int j = 0; j < (int) hs_list.size(); j++)
+        _add_hiscore_row(_hs_entry(j), j);
 }
 
 void UIHiscoresMenu::_add_hiscore_row(scorefile_entry& se, int id)
@@ -490,7 +547,7 @@ void UIHiscoresMenu::_add_hiscore_row(scorefile_entry& se, int id)
     tmp->set_margin_for_sdl(2);
     btn->set_child(std::move(tmp));
     btn->on_activate_event([id](const ActivateEvent&) {
-        _show_morgue(*hs_list[id]);
+        _show_morgue(_hs_entry(id));
         return true;
     });
     btn->on_focusin_event([this, se](const FocusEvent&) {
@@ -625,6 +682,49 @@ static bool _hs_read(FILE *scores, scorefile_entry &dest)
     return dest.parse(inbuf);
 }
 
+// Read a line as _hs_read() would, but only find its score.
+static bool _hs_read_line(FILE *scores, hs_line &dest)
+{
+    char inbuf[1500];
+    if (!scores || feof(scores))
+        return false;
+
+    if (!fgets(inbuf, sizeof inbuf, scores))
+        return false;
+
+    // As in scorefile_entry::parse(), which we'd fail later.
+    if (inbuf[0] == ':')
+    {
+        dprf("Corrupted xlog-line: %s", inbuf);
+        return false;
+    }
+
+    dest.raw = inbuf;
+    dest.score = _xlog_score(dest.raw);
+    dest.entry.reset();
+    return true;
+}
+
+static void _hs_read_list(FILE *scores)
+{
+    hs_list.clear();
+    hs_line line;
+    while (hs_list.size() < SCORE_FILE_ENTRIES && _hs_read_line(scores, line))
+        hs_list.push_back(move(line));
+    hs_list_initialized = true;
+}
+
+static scorefile_entry &_hs_entry(int index)
+{
+    hs_line &line = hs_list[index];
+    if (!line.entry)
+    {
+        line.entry.reset(new scorefile_entry);
+        line.entry->parse(line.raw);
+    }
+    return *line.entry;
+}
+
 static int _val_char(char digit)
 {
     return digit - '0';
@@ -650,11 +750,6 @@ static time_t _parse_time(const string &st)
     return mktime(&date);
 }
 
-static void _hs_write(FILE *scores, scorefile_entry &se)
-{
-    fprintf(scores, "%s", se.raw_string().c_str());
-}
-
 static const char *kill_method_names[] =
 {
     "mon", "pois", "cloud", "beam", "lava", "water",
@@ -2928,6 +3023,23 @@ static vector<string> _xlog_split_fields(const string &s)
     return fs;
 }
 
+// The sc field of a line, as xlog_fields would read it, without splitting
+// up the rest.
+static int _xlog_score(const string &line)
+{
+    int score = 0;
+    for (string::size_type start = 0; start < line.length();)
+    {
+        const string::size_type end = _xlog_next_separator(line, start);
+        if (!line.compare(start, 3, "sc="))
+            score = atoi(line.c_str() + start + 3);
+        if (end == string::npos)
+            break;
+        start = end + 1;
+    }
+    return score;
+}
+
 void xlog_fields::init(const string &line)
 {
     for (const string &field : _xlog_split_fields(line))
@@ -3036,6 +3148,12 @@ void sync_last_milestone()
 }
 #endif
 
+#ifdef DGL_MILESTONES
+// The milestones of this turn, for flush_milestones() to write together.
+static string pending_milestones;
+static xlog_appender milestone_appender;
+#endif
+
 /**
  * @brief Record the player reaching a milestone, if ::DGL_MILESTONES is defined.
  * @callergraph
@@ -3095,20 +3213,31 @@ void mark_milestone(const string &type, const string &milestone,
         return;
 #endif
 
-    const string xlog_line = xl.xlog_line();
-    const string milestone_file = _log_file_name(true);
-
-    if (FILE *fp = lk_open("a", milestone_file))
-    {
-        fprintf(fp, "%s\n", xlog_line.c_str());
-        lk_close(fp);
-    }
+    pending_milestones += xl.xlog_line() + "\n";
+    // A crash may not get as far as the end of the turn.
+    if (type == "crash")
+        flush_milestones();
 #endif
 #else
     UNUSED(type, milestone, origin_level, milestone_time);
 #endif // USE_TILE_WEB
 }
 
+/**
+ * @brief Write the milestones marked since the last call, all at once.
+ *
+ * Called at the end of each turn, and on saving or leaving the game.
+ */
+void flush_milestones()
+{
+#ifdef DGL_MILESTONES
+    if (pending_milestones.empty())
+        return;
+    milestone_appender.append(_log_file_name(true), pending_milestones);
+    pending_milestones.clear();
+#endif
+}
+
 #if defined(USE_TILE_WEB) || defined(DGL_WHEREIS)
 static xlog_fields _xlog_status(const char *status)
 {
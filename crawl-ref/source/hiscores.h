@@ -33,6 +33,7 @@ string hiscores_format_single_long(const scorefile_entry &se,
 
 void mark_milestone(const string &type, const string &milestone,
                     const string &origin_level = "", time_t t = 0);
+void flush_milestones();
 
 void update_whereis(const char *status = "active");
 
@@ -69,6 +69,7 @@
 #include "tag-version.h"
 #include "throw.h"
 #include "travel.h"
+#include "turn-times.h"
 #include "unwind.h"
 #include "version.h"
 #include "viewchar.h"
@@ -461,6 +462,12 @@ const vector<GameOption*> game_options::build_options_list()
         new BoolGameOption(SIMPLE_NAME(best_effort_brighten_background), false),
         new BoolGameOption(SIMPLE_NAME(best_effort_brighten_foreground), true),
         new BoolGameOption(SIMPLE_NAME(allow_extended_colours), true),
+        new BoolGameOption(SIMPLE_NAME(minimal_sgr), true),
+        new IntGameOption(SIMPLE_NAME(terminal_frame_rate), USING_DGL ? 30 : 0,
+                          0, 1000),
+        new IntGameOption(SIMPLE_NAME(lua_gc_pause), 0, 0, 1000),
+        new IntGameOption(SIMPLE_NAME(lua_gc_step_multiplier), 0, 0, 10000),
+        new IntGameOption(SIMPLE_NAME(lua_gc_idle_time), 2, 0, 100),
         new BoolGameOption(SIMPLE_NAME(regex_search), false),
         new BoolGameOption(SIMPLE_NAME(autopickup_search), false),
         new BoolGameOption(SIMPLE_NAME(show_newturn_mark), true),
@@ -739,6 +746,7 @@ const vector<GameOption*> game_options::build_options_list()
              {"classic", level_gen_type::classic},
              {"false", level_gen_type::classic}
             }, true),
+        new BoolGameOption(SIMPLE_NAME(pregen_ahead), false),
         new BoolGameOption(SIMPLE_NAME(single_column_item_menus), true),
 
 #ifdef DGL_SIMPLE_MESSAGING
@@ -950,6 +958,7 @@ const vector<GameOption*> game_options::build_options_list()
              {"false", WIZ_NO},
              {"never", WIZ_NEVER}},
              true),
+        new IntGameOption(SIMPLE_NAME(debug_scan_interval), 20, 0, 10000),
 
 #ifdef WIZARD
         new BoolGameOption(SIMPLE_NAME(fsim_csv), false),
@@ -958,6 +967,7 @@ const vector<GameOption*> game_options::build_options_list()
         new StringGameOption(SIMPLE_NAME(fsim_mode), ""),
         new StringGameOption(SIMPLE_NAME(fsim_mons), ""),
         new IntGameOption(SIMPLE_NAME(fsim_rounds), 4000, 1000, 500000),
+        new IntGameOption(SIMPLE_NAME(fsim_jobs), 1, 1, 64),
 #endif
 #if !defined(DGAMELAUNCH) || defined(DGL_REMEMBER_NAME)
         new BoolGameOption(SIMPLE_NAME(remember_name), true),
@@ -1651,6 +1661,9 @@ void game_options::reset_options()
     // Currently enabled by default for testing in trunk.
     if (Version::ReleaseType == VER_ALPHA)
         dump_order.push_back("turns_by_place");
+#ifdef DEBUG
+    dump_order.push_back("travel_stats");
+#endif
 
     use_animations = (UA_BEAM | UA_RANGE | UA_HP | UA_MONSTER_IN_SIGHT
                       | UA_PICKUP | UA_MONSTER | UA_PLAYER | UA_BRANCH_ENTRY
@@ -1669,6 +1682,7 @@ void game_options::reset_options()
 
     clear_feature_overrides();
     mon_glyph_overrides.clear();
+    glyph_overrides_changed();
     item_glyph_overrides.clear();
     item_glyph_cache.clear();
 
@@ -1683,10 +1697,19 @@ void game_options::clear_cset_overrides()
     memset(cset_override, 0, sizeof cset_override);
 }
 
+// Never goes back to an earlier value, even across game_options objects.
+static unsigned int _glyph_override_changes = 0;
+
+void game_options::glyph_overrides_changed()
+{
+    glyph_overrides_version = ++_glyph_override_changes;
+}
+
 void game_options::clear_feature_overrides()
 {
     feature_colour_overrides.clear();
     feature_symbol_overrides.clear();
+    glyph_overrides_changed();
 }
 
 char32_t get_glyph_override(int c)
@@ -1959,7 +1982,8 @@ void game_options::remove_mon_glyph_override(const string &text)
         matches.insert(m);
     }
     for (monster_type m : matches)
-        mon_glyph_overrides.erase(m);;
+        mon_glyph_overrides.erase(m);
+    glyph_overrides_changed();
 }
 
 void game_options::add_mon_glyph_override(const string &text, bool /*prepend*/)
@@ -1998,6 +2022,7 @@ void game_options::add_mon_glyph_override(const string &text, bool /*prepend*/)
     if (mdisp.ch || mdisp.col)
         for (monster_type m : matches)
             mon_glyph_overrides[m] = mdisp;
+    glyph_overrides_changed();
 }
 
 void game_options::remove_item_glyph_override(const string &text)
@@ -2046,6 +2071,7 @@ void game_options::remove_feature_override(const string &text)
         feature_colour_overrides.erase(f);
         feature_symbol_overrides.erase(f);
     }
+    glyph_overrides_changed();
 }
 
 void game_options::add_feature_override(const string &text, bool /*prepend*/)
@@ -2095,6 +2121,7 @@ void game_options::add_feature_override(const string &text, bool /*prepend*/)
         COL(6, seen_em_dcolour);
 #undef COL
     }
+    glyph_overrides_changed();
 }
 
 void game_options::add_cset_override(dungeon_char_type dc, int symbol)
@@ -2168,6 +2195,7 @@ static const char* lua_builtins[] =
     "clua/autofight.lua",
     "clua/automagic.lua",
     "clua/kills.lua",
+    "clua/autopickup.lua",
 };
 
 static const char* config_defaults[] =
@@ -2205,9 +2233,58 @@ void base_game_options::merge(const base_game_options &other)
 }
 
 
+// What the default option files leave the options as, and when those files
+// were last changed. read_init_file() runs at least twice for every game, and
+// a fork server (see zygote.cc) runs it for every game it starts, so instead
+// of reading and parsing them again each time, a copy is kept. The default
+// files hold no Lua (that is in clua/autopickup.lua), so the options are all
+// they change.
+struct default_options_cache
+{
+    vector<pair<string, time_t>> files;
+    unique_ptr<game_options> options;
+};
+
+static vector<pair<string, time_t>> _default_option_files()
+{
+    vector<pair<string, time_t>> files;
+    for (const char *def_file : config_defaults)
+    {
+        const string path = datafile_path(def_file);
+        files.emplace_back(path, file_modtime(path));
+    }
+    return files;
+}
+
+static void _read_default_options(bool runscripts)
+{
+    static default_options_cache cache;
+
+    const vector<pair<string, time_t>> files = _default_option_files();
+    if (cache.options && cache.files == files)
+    {
+        Options = *cache.options;
+        return;
+    }
+
+    for (const auto &file : files)
+        Options.include(file.first, false, runscripts);
+
+    cache.files = files;
+    cache.options.reset(new game_options(Options));
+}
+
+static unsigned int _options_generation = 0;
+
+unsigned int options_generation()
+{
+    return _options_generation;
+}
+
 void read_init_file(bool runscripts)
 {
     unwind_bool parsing_state(crawl_state.parsing_rc, true);
+    ++_options_generation;
 
     Options.reset_options();
     // XX why didn't this clear first
@@ -2225,8 +2302,7 @@ void read_init_file(bool runscripts)
     }
 
     // Load default options.
-    for (const char *def_file : config_defaults)
-        Options.include(datafile_path(def_file), false, runscripts);
+    _read_default_options(runscripts);
 
     // don't count anything up to here as customized
     Options.reset_loaded_state();
@@ -3622,6 +3698,7 @@ void base_game_options::set_from_defaults(const string &opt)
 ///             starting up a game.
 void base_game_options::read_option_line(const string &str, bool runscripts)
 {
+    ++_options_generation;
     opt_parse_state state = parse_option_line(str);
     if (!state.is_valid_option_line())
         return; // either invalid, or already handled directive
@@ -3833,7 +3910,10 @@ bool game_options::read_custom_option(opt_parse_state &state, bool runscripts)
     else if (key == "mon_glyph")
     {
         if (state.plain())
+        {
             mon_glyph_overrides.clear();
+            glyph_overrides_changed();
+        }
 
         state.ignore_prepend();
         split_parse(state, ",",
@@ -4553,12 +4633,14 @@ enum commandline_option_type
     CLO_MACRO,
     CLO_MAPSTAT,
     CLO_MAPSTAT_DUMP_DISCONNECT,
+    CLO_MAPSTAT_PARALLEL,
     CLO_OBJSTAT,
     CLO_ITERATIONS,
     CLO_FORCE_MAP,
     CLO_ARENA,
     CLO_DUMP_MAPS,
     CLO_TEST,
+    CLO_TEST_JOBS,
     CLO_SCRIPT,
     CLO_BUILDDB,
     CLO_HELP,
@@ -4595,8 +4677,11 @@ enum commandline_option_type
     CLO_WEBTILES_SOCKET,
     CLO_AWAIT_CONNECTION,
     CLO_PRINT_WEBTILES_OPTIONS,
+    CLO_ZYGOTE,
 #endif
     CLO_RESET_CACHE,
+    CLO_PRINT_STARTUP_TIMES,
+    CLO_PRINT_TURN_TIMES,
 
     CLO_NOPS
 };
@@ -4607,6 +4692,8 @@ static set<commandline_option_type> clo_headless_ok = {
     CLO_SCORES,
     CLO_BUILDDB,
     CLO_RESET_CACHE,
+    CLO_PRINT_STARTUP_TIMES,
+    CLO_PRINT_TURN_TIMES,
     CLO_HELP,
     CLO_VERSION,
     CLO_PLAYABLE_JSON, // JSON metadata for species, jobs, combos.
@@ -4621,11 +4708,13 @@ static set<commandline_option_type> clo_headless_ok = {
 #endif
     CLO_ARENA,
     CLO_TEST,
+    CLO_TEST_JOBS,
     CLO_SCRIPT,
 #ifdef USE_TILE_WEB
     CLO_WEBTILES_SOCKET,
     CLO_AWAIT_CONNECTION,
     CLO_PRINT_WEBTILES_OPTIONS,
+    CLO_ZYGOTE,
     CLO_SAVE_JSON,
     CLO_GAMETYPES_JSON,
 #endif
@@ -4635,7 +4724,8 @@ static const char *cmd_ops[] =
 {
     "scores", "name", "species", "background", "dir", "rc", "rcdir", "tscores",
     "vscores", "scorefile", "morgue", "macro", "mapstat", "dump-disconnect",
-    "objstat", "iters", "force-map", "arena", "dump-maps", "test", "script",
+    "mapstat-parallel", "objstat", "iters", "force-map", "arena", "dump-maps", "test",
+    "test-jobs", "script",
     "builddb", "help", "version", "seed", "pregen", "save-version", "sprint",
     "extra-opt-first", "extra-opt-last", "sprint-map", "edit-save",
     "print-charset", "tutorial", "wizard", "explore", "no-save",
@@ -4647,8 +4737,9 @@ static const char *cmd_ops[] =
 #endif
 #ifdef USE_TILE_WEB
     "webtiles-socket", "await-connection", "print-webtiles-options",
+    "zygote",
 #endif
-    "reset-cache",
+    "reset-cache", "print-startup-times", "print-turn-times",
 };
 
 
@@ -5450,6 +5541,7 @@ bool parse_args(int argc, char **argv, bool rc_only)
 
     SysEnv.rcdirs.clear();
     SysEnv.map_gen_iters = 0;
+    SysEnv.map_gen_jobs = 1;
 
     if (argc < 2)           // no args!
         return true;
@@ -5612,6 +5704,20 @@ bool parse_args(int argc, char **argv, bool rc_only)
 #else
             end(1, false, "%s", dbg_stat_err);
 #endif
+        case CLO_MAPSTAT_PARALLEL:
+#ifdef DEBUG_STATISTICS
+            if (!next_is_param || !isadigit(*next_arg))
+                end(1, false, "Integer argument required for -%s\n", arg);
+            else
+            {
+                SysEnv.map_gen_jobs = max(1, min(atoi(next_arg), 64));
+                nextUsed = true;
+            }
+#else
+            end(1, false, "%s", dbg_stat_err);
+#endif
+            break;
+
         case CLO_ITERATIONS:
 #ifdef DEBUG_STATISTICS
             if (!next_is_param || !isadigit(*next_arg))
@@ -5683,6 +5789,16 @@ bool parse_args(int argc, char **argv, bool rc_only)
             }
             break;
 
+        case CLO_TEST_JOBS:
+            if (!next_is_param || !isadigit(*next_arg))
+                end(1, false, "Integer argument required for -%s\n", arg);
+            else
+            {
+                crawl_state.test_jobs = max(1, min(atoi(next_arg), 64));
+                nextUsed = true;
+            }
+            break;
+
 #if defined(UNIX) || defined(USE_TILE_LOCAL)
         case CLO_HEADLESS:
             enter_headless_mode();
@@ -5733,6 +5849,19 @@ bool parse_args(int argc, char **argv, bool rc_only)
             crawl_state.use_des_cache = false;
             break;
 
+        case CLO_PRINT_STARTUP_TIMES:
+            if (next_is_param)
+                return false;
+            crawl_state.print_startup_times = true;
+            break;
+
+        case CLO_PRINT_TURN_TIMES:
+            if (next_is_param)
+                return false;
+            crawl_state.print_turn_times = true;
+            turn_times_update_active();
+            break;
+
         case CLO_GDB:
             crawl_state.no_gdb = 0;
             break;
@@ -5929,6 +6058,13 @@ bool parse_args(int argc, char **argv, bool rc_only)
                 end(0);
             }
             break;
+
+        case CLO_ZYGOTE:
+            if (!next_is_param)
+                return false;
+            crawl_state.zygote_socket = next_arg;
+            nextUsed = true;
+            break;
 #endif
 
         case CLO_PRINT_CHARSET:
@@ -24,6 +24,8 @@ job_type str_to_job(const string &str);
 
 string find_crawlrc();
 void read_init_file(bool runscript = false);
+// Changes whenever the options might have.
+unsigned int options_generation();
 
 struct newgame_def;
 newgame_def read_startup_prefs();
@@ -61,6 +63,7 @@ public:
     vector<string> cmd_args;
 
     int map_gen_iters;
+    int map_gen_jobs;
     unique_ptr<depth_ranges> map_gen_range;
 
     vector<string> extra_opts_first;
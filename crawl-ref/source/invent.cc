@@ -108,7 +108,14 @@ InvEntry::InvEntry(const item_def &i)
 
 int InvEntry::highlight_colour(bool temp) const
 {
-    return menu_colour(get_text(), item_prefix(*item, temp), tag, false);
+    const string entry_text = get_text();
+    int col;
+    if (!m_colour_memo.get(entry_text, tag, temp, col))
+    {
+        col = menu_colour(entry_text, item_prefix(*item, temp), tag, false);
+        m_colour_memo.set(entry_text, tag, temp, col);
+    }
+    return col;
 }
 
 const string &InvEntry::get_basename() const
@@ -42,6 +42,9 @@ struct item_def
         short stash_freshness; ///< where stash.cc stores corpse freshness
     };
 #pragma pack(pop)
+    // Here rather than with orig_place, where it would be followed by
+    // padding up to the alignment of inscription.
+    short          orig_monnum;
     union
     {
         // These must all be the same size!
@@ -75,7 +78,6 @@ struct item_def
     short  slot;
 
     level_id orig_place;
-    short    orig_monnum;
 
     string inscription;
 
@@ -83,9 +85,9 @@ struct item_def
 
 public:
     item_def() : base_type(OBJ_UNASSIGNED), sub_type(0), plus(0), plus2(0),
-                 special(0), rnd(0), quantity(0), flags(0),
+                 orig_monnum(0), special(0), rnd(0), quantity(0), flags(0),
                  pos(), link(NON_ITEM), slot(0), orig_place(),
-                 orig_monnum(0), inscription()
+                 inscription()
     {
     }
 
@@ -35,6 +35,7 @@
 #include "level-state-type.h"
 #include "libutil.h"
 #include "makeitem.h"
+#include "name-table.h"
 #include "notes.h"
 #include "options.h"
 #include "orb-type.h"
@@ -2044,6 +2045,18 @@ void check_if_everything_is_identified()
     you.props[IDENTIFIED_ALL_KEY] = true;
 }
 
+static uint32_t knowledge_generation = 0;
+
+uint32_t item_knowledge_generation()
+{
+    return knowledge_generation;
+}
+
+void item_knowledge_changed()
+{
+    ++knowledge_generation;
+}
+
 bool set_ident_type(item_def &item, bool identify, bool check_last)
 {
     if (is_artefact(item) || crawl_state.game_is_arena())
@@ -2085,6 +2098,7 @@ bool set_ident_type(object_class_type basetype, int subtype, bool identify,
         return false;
 
     you.type_ids[basetype][subtype] = identify;
+    item_knowledge_changed();
     maybe_mark_set_known(basetype, subtype);
     request_autoinscribe();
 
@@ -3407,15 +3421,14 @@ string menu_colour_item_name(const item_def &item, description_level_type desc)
     return make_stringf("<%s>%s</%s>", colour_z, item_name.c_str(), colour_z);
 }
 
-typedef map<string, item_kind> item_names_map;
-static item_names_map item_names_cache;
+static name_table<item_kind> item_names_cache;
 
 typedef map<unsigned, vector<string> > item_names_by_glyph_map;
 static item_names_by_glyph_map item_names_by_glyph_cache;
 
 void init_item_name_cache()
 {
-    item_names_cache.clear();
+    map<string, item_kind> names;
     item_names_by_glyph_cache.clear();
 
     for (int i = 0; i < NUM_OBJECT_CLASSES; i++)
@@ -3469,11 +3482,11 @@ void init_item_name_cache()
                     || base_type == OBJ_BOOKS && sub_type == BOOK_MANUAL
                         && is_removed_skill(static_cast<skill_type>(item.plus));
 
-                if (!item_names_cache.count(name))
+                if (!names.count(name))
                 {
                     // what would happen if we don't put removed items in the
                     // item name cache?
-                    item_names_cache[name] = { base_type, (uint8_t)sub_type,
+                    names[name] = { base_type, (uint8_t)sub_type,
                                                (int8_t)item.plus, 0 };
 
                     // only used for help lookup, skip removed items
@@ -3484,13 +3497,14 @@ void init_item_name_cache()
         }
     }
 
+    item_names_cache = name_table<item_kind>(names);
     ASSERT(!item_names_cache.empty());
 }
 
 item_kind item_kind_by_name(const string &name)
 {
-    return lookup(item_names_cache, lowercase_string(name),
-                  { OBJ_UNASSIGNED, 0, 0, 0 });
+    return item_names_cache.get(lowercase_string(name),
+                                { OBJ_UNASSIGNED, 0, 0, 0 });
 }
 
 vector<string> item_name_list_for_glyph(char32_t glyph)
@@ -147,6 +147,10 @@ bool get_ident_type(object_class_type basetype, int subtype);
 bool set_ident_type(item_def &item, bool identify, bool check_last=true);
 bool set_ident_type(object_class_type basetype, int subtype, bool identify,
                     bool check_last=true);
+// Goes up whenever you.type_ids changes, which changes how items are named
+// and drawn without changing the items themselves.
+uint32_t item_knowledge_generation();
+void item_knowledge_changed();
 
 string item_prefix(const item_def &item, bool temp = true);
 string menu_colour_item_name(const item_def &item,
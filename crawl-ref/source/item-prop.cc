@@ -118,7 +118,6 @@ static const vector<ego_weight_tuple> SHIELD_EGOS = {
 // Note: the Little-Giant range is used to make armours which are very
 // flexible and adjustable and can be worn by any player character...
 // providing they also pass the shape test, of course.
-static int Armour_index[NUM_ARMOURS];
 static const armour_def Armour_prop[] =
 {
     { ARM_ANIMAL_SKIN,          "animal skin",            2,   0,     3,
@@ -451,7 +450,6 @@ static const vector<brand_weight_tuple> HOLY_BRANDS = {
 };
 
 
-static int Weapon_index[NUM_WEAPONS];
 static const weapon_def Weapon_prop[] =
 {
     // Maces & Flails
@@ -775,7 +773,6 @@ struct missile_def
     int         price;
 };
 
-static int Missile_index[NUM_MISSILES];
 static const missile_def Missile_prop[] =
 {
     { MI_DART,          "dart",          0, 12, 3  },
@@ -831,6 +828,13 @@ static const food_def Food_prop[] =
 };
 #endif
 
+// The tables above are grouped for reading rather than in enum order, and
+// the properties of an item type get looked up very often, so they're
+// copied into these, indexed by the type itself, when the game starts.
+static armour_def Armour_by_type[NUM_ARMOURS];
+static weapon_def Weapon_by_type[NUM_WEAPONS];
+static missile_def Missile_by_type[NUM_MISSILES];
+
 struct item_set_def
 {
     string name;
@@ -863,14 +867,14 @@ void init_properties()
     COMPILE_CHECK(NUM_FOODS    == ARRAYSZ(Food_prop));
 #endif
 
-    for (int i = 0; i < NUM_ARMOURS; i++)
-        Armour_index[ Armour_prop[i].id ] = i;
+    for (const armour_def &arm : Armour_prop)
+        Armour_by_type[arm.id] = arm;
 
-    for (int i = 0; i < NUM_WEAPONS; i++)
-        Weapon_index[ Weapon_prop[i].id ] = i;
+    for (const weapon_def &wpn : Weapon_prop)
+        Weapon_by_type[wpn.id] = wpn;
 
-    for (int i = 0; i < NUM_MISSILES; i++)
-        Missile_index[ Missile_prop[i].id ] = i;
+    for (const missile_def &missile : Missile_prop)
+        Missile_by_type[missile.id] = missile;
 
 #if TAG_MAJOR_VERSION == 34
     for (int i = 0; i < NUM_FOODS; i++)
@@ -1217,7 +1221,7 @@ bool is_hard_helmet(const item_def &item)
 brand_type choose_weapon_brand(weapon_type wpn_type)
 {
     const vector<brand_weight_tuple> weights
-        = Weapon_prop[ Weapon_index[wpn_type] ].brand_weights;
+        = Weapon_by_type[wpn_type].brand_weights;
     if (!weights.size())
         return SPWPN_NORMAL;
 
@@ -1237,7 +1241,7 @@ brand_type choose_weapon_brand(weapon_type wpn_type)
 special_armour_type choose_armour_ego(armour_type arm_type)
 {
     const vector<ego_weight_tuple> weights
-        = Armour_prop[ Armour_index[arm_type] ].ego_weights;
+        = Armour_by_type[arm_type].ego_weights;
     if (!weights.size())
         return SPARM_NORMAL;
 
@@ -1468,7 +1472,7 @@ bool armour_is_special(const item_def &item)
 {
     ASSERT(item.base_type == OBJ_ARMOUR);
 
-    return !Armour_prop[ Armour_index[item.sub_type] ].mundane;
+    return !Armour_by_type[item.sub_type].mundane;
 }
 
 /**
@@ -1481,19 +1485,19 @@ bool armour_is_special(const item_def &item)
  */
 int armour_acq_weight(const armour_type armour)
 {
-    return Armour_prop[ Armour_index[armour] ].acquire_weight;
+    return Armour_by_type[armour].acquire_weight;
 }
 
 equipment_type get_armour_slot(const item_def &item)
 {
     ASSERT(item.base_type == OBJ_ARMOUR);
 
-    return Armour_prop[ Armour_index[item.sub_type] ].slot;
+    return Armour_by_type[item.sub_type].slot;
 }
 
 equipment_type get_armour_slot(armour_type arm)
 {
-    return Armour_prop[ Armour_index[arm] ].slot;
+    return Armour_by_type[arm].slot;
 }
 
 bool jewellery_is_amulet(const item_def &item)
@@ -1522,8 +1526,8 @@ bool jewellery_is_amulet(int sub_type)
  */
 static int _fit_armour_size(armour_type sub_type, size_type size)
 {
-    const size_type min = Armour_prop[ Armour_index[sub_type] ].fit_min;
-    const size_type max = Armour_prop[ Armour_index[sub_type] ].fit_max;
+    const size_type min = Armour_by_type[sub_type].fit_min;
+    const size_type max = Armour_by_type[sub_type].fit_max;
 
     if (size < min)
         return min - size;    // negative means levels too small
@@ -1685,7 +1689,7 @@ bool is_enchantable_armour(const item_def &arm, bool unknown)
 // ^^^ vvv "rarity" is exactly the wrong term - inverted...
 int weapon_rarity(int w_type)
 {
-    return Weapon_prop[Weapon_index[w_type]].commonness;
+    return Weapon_by_type[w_type].commonness;
 }
 
 int get_vorpal_type(const item_def &item)
@@ -1693,7 +1697,7 @@ int get_vorpal_type(const item_def &item)
     int ret = DVORP_NONE;
 
     if (item.base_type == OBJ_WEAPONS)
-        ret = (Weapon_prop[Weapon_index[item.sub_type]].dam_type & DAMV_MASK);
+        ret = (Weapon_by_type[item.sub_type].dam_type & DAMV_MASK);
 
     return ret;
 }
@@ -1701,7 +1705,7 @@ int get_vorpal_type(const item_def &item)
 int get_damage_type(const item_def &item)
 {
     if (item.base_type == OBJ_WEAPONS)
-        return Weapon_prop[Weapon_index[item.sub_type]].dam_type & DAM_MASK;
+        return Weapon_by_type[item.sub_type].dam_type & DAM_MASK;
 
     return DAM_BASH;
 }
@@ -1749,7 +1753,7 @@ hands_reqd_type basic_hands_reqd(const item_def &item, size_type size)
         return HANDS_ONE;
     if (is_unrandom_artefact(item, UNRAND_GYRE))
         return HANDS_TWO;
-    return size >= Weapon_prop[Weapon_index[wpn_type]].min_1h_size ? HANDS_ONE
+    return size >= Weapon_by_type[wpn_type].min_1h_size ? HANDS_ONE
                                                                    : HANDS_TWO;
 }
 
@@ -1783,7 +1787,7 @@ bool is_giant_club_type(int wpn_type)
  */
 bool is_ranged_weapon_type(int wpn_type)
 {
-    return Weapon_prop[Weapon_index[wpn_type]].ammo != MI_NONE;
+    return Weapon_by_type[wpn_type].ammo != MI_NONE;
 }
 
 /**
@@ -1941,7 +1945,7 @@ skill_type item_attack_skill(const item_def &item)
         ASSERT_RANGE(item.sub_type, 0, NUM_WEAPONS);
         if (is_unrandom_artefact(item, UNRAND_LOCHABER_AXE))
             return _lochaber_skill();
-        return Weapon_prop[ Weapon_index[item.sub_type] ].skill;
+        return Weapon_by_type[item.sub_type].skill;
     case OBJ_STAVES:
         return SK_STAVES;
     case OBJ_MISSILES:
@@ -2084,7 +2088,7 @@ bool is_weapon_wieldable(const item_def &item, size_type size)
                                                      : item.sub_type;
     // Check we aren't about to index with a bogus subtype for weapons
     ASSERT(item.base_type != OBJ_WEAPONS || subtype < get_max_subtype(item.base_type));
-    return Weapon_prop[Weapon_index[subtype]].min_2h_size <= size;
+    return Weapon_by_type[subtype].min_2h_size <= size;
 }
 
 //
@@ -2118,7 +2122,7 @@ bool is_slowed_by_armour(const item_def *item)
 const char *ammo_name(missile_type ammo)
 {
     return ammo < 0 || ammo >= NUM_MISSILES ? "eggplant"
-           : Missile_prop[ Missile_index[ammo] ].name;
+           : Missile_by_type[ammo].name;
 }
 
 bool is_launcher_ammo(const item_def &wpn)
@@ -2161,7 +2165,7 @@ void populate_fake_projectile(const item_def &wep, item_def &fake_proj)
 {
     ASSERT(is_weapon(wep) && is_ranged_weapon_type(wep.sub_type));
     fake_proj.base_type = OBJ_MISSILES;
-    fake_proj.sub_type  = Weapon_prop[Weapon_index[wep.sub_type]].ammo;
+    fake_proj.sub_type  = Weapon_by_type[wep.sub_type].ammo;
     fake_proj.quantity  = 1;
     fake_proj.rnd       = 1;
 }
@@ -2201,7 +2205,7 @@ bool ammo_never_destroyed(const item_def &missile)
  */
 int ammo_type_destroy_chance(int missile_type)
 {
-    return Missile_prop[ Missile_index[missile_type] ].mulch_rate;
+    return Missile_by_type[missile_type].mulch_rate;
 }
 
 /**
@@ -2212,7 +2216,7 @@ int ammo_type_destroy_chance(int missile_type)
  */
 int ammo_type_damage(int missile_type)
 {
-    return Missile_prop[ Missile_index[missile_type] ].dam;
+    return Missile_by_type[missile_type].dam;
 }
 
 
@@ -2690,40 +2694,40 @@ int property(const item_def &item, int prop_type)
             switch (prop_type)
             {
             case PWPN_DAMAGE:
-                return Weapon_prop[ Weapon_index[item.sub_type] ].dam
+                return Weapon_by_type[item.sub_type].dam
                        + artefact_property(item, ARTP_BASE_DAM);
             case PWPN_HIT:
-                return Weapon_prop[ Weapon_index[item.sub_type] ].hit
+                return Weapon_by_type[item.sub_type].hit
                        + artefact_property(item, ARTP_BASE_ACC);
             case PWPN_SPEED:
-                return Weapon_prop[ Weapon_index[item.sub_type] ].speed
+                return Weapon_by_type[item.sub_type].speed
                        + artefact_property(item, ARTP_BASE_DELAY);
             }
         }
         if (prop_type == PWPN_DAMAGE)
-            return Weapon_prop[ Weapon_index[item.sub_type] ].dam;
+            return Weapon_by_type[item.sub_type].dam;
         else if (prop_type == PWPN_HIT)
-            return Weapon_prop[ Weapon_index[item.sub_type] ].hit;
+            return Weapon_by_type[item.sub_type].hit;
         else if (prop_type == PWPN_SPEED)
-            return Weapon_prop[ Weapon_index[item.sub_type] ].speed;
+            return Weapon_by_type[item.sub_type].speed;
         else if (prop_type == PWPN_ACQ_WEIGHT)
-            return Weapon_prop[ Weapon_index[item.sub_type] ].acquire_weight;
+            return Weapon_by_type[item.sub_type].acquire_weight;
         break;
 
     case OBJ_MISSILES:
         if (prop_type == PWPN_DAMAGE)
-            return Missile_prop[ Missile_index[item.sub_type] ].dam;
+            return Missile_by_type[item.sub_type].dam;
         break;
 
     case OBJ_STAVES:
         weapon_sub = WPN_STAFF;
 
         if (prop_type == PWPN_DAMAGE)
-            return Weapon_prop[ Weapon_index[weapon_sub] ].dam;
+            return Weapon_by_type[weapon_sub].dam;
         else if (prop_type == PWPN_HIT)
-            return Weapon_prop[ Weapon_index[weapon_sub] ].hit;
+            return Weapon_by_type[weapon_sub].hit;
         else if (prop_type == PWPN_SPEED)
-            return Weapon_prop[ Weapon_index[weapon_sub] ].speed;
+            return Weapon_by_type[weapon_sub].speed;
         break;
 
     default:
@@ -2747,9 +2751,9 @@ int armour_prop(int armour, int prop_type)
     switch (prop_type)
     {
         case PARM_AC:
-            return Armour_prop[ Armour_index[armour] ].ac;
+            return Armour_by_type[armour].ac;
         case PARM_EVASION:
-            return Armour_prop[ Armour_index[armour] ].ev;
+            return Armour_by_type[armour].ev;
         default:
             return 0; // !?
     }
@@ -3016,11 +3020,11 @@ string item_base_name(object_class_type type, int sub_type)
     switch (type)
     {
     case OBJ_WEAPONS:
-        return Weapon_prop[Weapon_index[sub_type]].name;
+        return Weapon_by_type[sub_type].name;
     case OBJ_MISSILES:
-        return Missile_prop[Missile_index[sub_type]].name;
+        return Missile_by_type[sub_type].name;
     case OBJ_ARMOUR:
-        return Armour_prop[Armour_index[sub_type]].name;
+        return Armour_by_type[sub_type].name;
     case OBJ_JEWELLERY:
         return jewellery_is_amulet(sub_type) ? "amulet" : "ring";
     case OBJ_TALISMANS:
@@ -3032,7 +3036,7 @@ string item_base_name(object_class_type type, int sub_type)
 
 const char* weapon_base_name(weapon_type subtype)
 {
-    return Weapon_prop[Weapon_index[subtype]].name;
+    return Weapon_by_type[subtype].name;
 }
 
 void remove_whitespace(string &str)
@@ -3214,7 +3218,7 @@ static inline int _get_armour_flag(armflags_t all, armour_flag res)
  */
 static armflags_t _armour_type_flags(const uint8_t arm)
 {
-    return Armour_prop[ Armour_index[arm] ].flags;
+    return Armour_by_type[arm].flags;
 }
 
 /**
@@ -3238,7 +3242,7 @@ int armour_type_prop(const uint8_t arm, const armour_flag prop)
  */
 int weapon_base_price(weapon_type type)
 {
-    return Weapon_prop[ Weapon_index[type] ].price;
+    return Weapon_by_type[type].price;
 }
 
 /**
@@ -3249,7 +3253,7 @@ int weapon_base_price(weapon_type type)
  */
 int missile_base_price(missile_type type)
 {
-    return Missile_prop[ Missile_index[type] ].price;
+    return Missile_by_type[type].price;
 }
 
 /**
@@ -3262,7 +3266,7 @@ int missile_base_price(missile_type type)
  */
 int armour_base_price(armour_type type)
 {
-    return Armour_prop[ Armour_index[type] ].price;
+    return Armour_by_type[type].price;
 }
 
 static string _item_set_key(item_set_type typ)
@@ -95,10 +95,93 @@ static bool _merge_items_into_inv(item_def &it, int quant_got,
 static bool will_autopickup   = false;
 static bool will_autoinscribe = false;
 
+// Bumped whenever what the player knows about items changes.
+static unsigned int knowledge_generation = 0;
+
+// An item's autopickup name takes its full name, its prefixes and a Lua
+// annotation, and the same items get looked at again and again: by explore,
+// by the stash tracker, and by the tiles view on every redraw. So the names
+// are remembered, by what the item is and where, until the turn ends or the
+// player learns something about items.
+struct autopickup_name_entry
+{
+    bool used = false;
+    int turn = 0;
+    unsigned int generation = 0;
+
+    object_class_type base_type = OBJ_UNASSIGNED;
+    uint8_t sub_type = 0;
+    short plus = 0, plus2 = 0;
+    int special = 0;
+    uint8_t rnd = 0;
+    short quantity = 0;
+    iflags_t flags = 0;
+    coord_def pos;
+    short link = 0;
+    unsigned int num_props = 0;
+    string inscription;
+
+    string name;
+
+    bool is(const item_def &item) const
+    {
+        return used && turn == you.num_turns
+               && generation == knowledge_generation
+               && base_type == item.base_type && sub_type == item.sub_type
+               && plus == item.plus && plus2 == item.plus2
+               && special == item.special && rnd == item.rnd
+               && quantity == item.quantity && flags == item.flags
+               && pos == item.pos && link == _link(item)
+               && num_props == item.props.size()
+               && inscription == item.inscription;
+    }
+
+    void set(const item_def &item, const string &item_name)
+    {
+        used = true;
+        turn = you.num_turns;
+        generation = knowledge_generation;
+        base_type = item.base_type;
+        sub_type = item.sub_type;
+        plus = item.plus;
+        plus2 = item.plus2;
+        special = item.special;
+        rnd = item.rnd;
+        quantity = item.quantity;
+        flags = item.flags;
+        pos = item.pos;
+        link = _link(item);
+        num_props = item.props.size();
+        inscription = item.inscription;
+        name = item_name;
+    }
+
+    // The link only matters to the name (being equipped) in the inventory;
+    // on the floor it is the next item of the pile.
+    static short _link(const item_def &item)
+    {
+        return in_inventory(item) ? item.link : 0;
+    }
+};
+
+static const int NUM_AUTOPICKUP_NAMES = 256;
+static autopickup_name_entry autopickup_names[NUM_AUTOPICKUP_NAMES];
+
 static inline string _autopickup_item_name(const item_def &item)
 {
-    return userdef_annotate_item(STASH_LUA_SEARCH_ANNOTATE, &item)
-           + item_prefix(item, false) + " " + item.name(DESC_PLAIN);
+    const unsigned int slot = (item.base_type * 31 + item.sub_type) * 31
+                              + item.special * 7 + item.rnd * 3
+                              + item.pos.x * 97 + item.pos.y * 101
+                              + item.quantity + item.plus;
+    autopickup_name_entry &entry
+        = autopickup_names[slot % NUM_AUTOPICKUP_NAMES];
+    if (!entry.is(item))
+    {
+        entry.set(item,
+                  userdef_annotate_item(STASH_LUA_SEARCH_ANNOTATE, &item)
+                  + item_prefix(item, false) + " " + item.name(DESC_PLAIN));
+    }
+    return entry.name;
 }
 
 // Used to be called "unlink_items", but all it really does is make
@@ -1543,6 +1626,25 @@ bool is_stackable_item(const item_def &item)
     return false;
 }
 
+/**
+ * Whether an item is unchanged since a copy of it was taken: cheaper than
+ * building and comparing the known-info copies, for displays that only want
+ * to redo the items that changed. What the player knows of an item type can
+ * change without the item doing so; see item_knowledge_generation().
+ */
+bool same_item_state(const item_def &a, const item_def &b)
+{
+    return a.base_type == b.base_type
+           && a.sub_type == b.sub_type
+           && a.plus == b.plus
+           && a.plus2 == b.plus2
+           && a.special == b.special
+           && a.quantity == b.quantity
+           && a.flags == b.flags
+           && a.inscription == b.inscription
+           && a.props.size() == b.props.size();
+}
+
 bool items_similar(const item_def &item1, const item_def &item2)
 {
     // Base and sub-types must always be the same to stack.
@@ -1604,8 +1706,9 @@ bool items_stack(const item_def &item1, const item_def &item2)
 
 static int _userdef_find_free_slot(const item_def &i)
 {
+    static lua_hook assign_invletter("c_assign_invletter");
     int slot = -1;
-    if (!clua.callfn("c_assign_invletter", "i>d", &i, &slot))
+    if (!assign_invletter.call_returning(clua, slot, &i))
         return -1;
 
     return slot;
@@ -2871,6 +2974,12 @@ bool need_to_autoinscribe()
 void request_autoinscribe(bool do_inscribe)
 {
     will_autoinscribe = do_inscribe;
+    ++knowledge_generation;
+}
+
+unsigned int item_knowledge_generation()
+{
+    return knowledge_generation;
 }
 
 void autoinscribe()
@@ -2944,8 +3053,8 @@ static bool _is_option_autopickup(const item_def &item, bool ignore_force)
                                                 ? "{gold}"
                                                 : _autopickup_item_name(item);
 
-    maybe_bool res = clua.callmaybefn("ch_force_autopickup", "is",
-                                      &item, iname.c_str());
+    static lua_hook force_autopickup("ch_force_autopickup");
+    maybe_bool res = force_autopickup.callmaybe(clua, &item, iname);
     if (!clua.error.empty())
     {
         mprf(MSGCH_ERROR, "ch_force_autopickup failed: %s",
@@ -2956,9 +3065,11 @@ static bool _is_option_autopickup(const item_def &item, bool ignore_force)
         return bool(res);
 
     // Check for initial settings
-    for (const pair<text_pattern, bool>& option : Options.force_autopickup)
-        if (option.first.matches(iname))
-            return option.second;
+    static pattern_list_matcher<pair<text_pattern, bool>> exceptions;
+    const int exception = exceptions.first_match(Options.force_autopickup, 0,
+                                                 iname);
+    if (exception >= 0)
+        return Options.force_autopickup[exception].second;
 
     return Options.autopickups[item.base_type];
 }
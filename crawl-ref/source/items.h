@@ -66,6 +66,7 @@ void clear_item_pickup_flags(item_def &item);
 bool is_stackable_item(const item_def &item);
 bool items_similar(const item_def &item1, const item_def &item2);
 bool items_stack(const item_def &item1, const item_def &item2);
+bool same_item_state(const item_def &a, const item_def &b);
 void get_gold(const item_def& item, int quant, bool quiet);
 
 item_def *find_floor_item(object_class_type cls, int sub_type = -1);
@@ -153,6 +154,8 @@ int find_free_slot(const item_def &i);
 
 bool need_to_autoinscribe();
 void request_autoinscribe(bool do_inscribe = true);
+// Changes whenever what the player knows about items might have.
+unsigned int item_knowledge_generation();
 void autoinscribe();
 
 bool item_is_equipped(const item_def &item, bool quiver_too = false);
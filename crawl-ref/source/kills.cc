@@ -67,8 +67,16 @@ void KillMaster::save(writer& outf) const
         categorized_kills[i].save(outf);
 }
 
+static unsigned int kill_generation = 0;
+
+unsigned int kills_generation()
+{
+    return kill_generation;
+}
+
 void KillMaster::load(reader& inf)
 {
+    ++kill_generation;
     const auto version = get_save_version(inf);
     const auto major = version.major, minor = version.minor;
 
@@ -93,6 +101,7 @@ void KillMaster::record_kill(const monster* mon, int killer, bool ispet)
         ispet            ? KC_FRIENDLY :
                            KC_OTHER;
     categorized_kills[kc].record_kill(mon);
+    ++kill_generation;
 }
 
 int KillMaster::total_kills() const
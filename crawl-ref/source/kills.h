@@ -182,3 +182,6 @@ private:
     void add_kill_info(string &, vector<kill_exp> &,
                        int count, const char *c, bool separator) const;
 };
+
+// Changes whenever a kill is recorded or the kills are loaded.
+unsigned int kills_generation();
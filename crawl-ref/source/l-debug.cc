@@ -5,27 +5,34 @@
 
 #include "l-libs.h"
 
+#include <chrono>
+
 #include "act-iter.h"
 #include "branch.h"
 #include "chardump.h"
 #include "cluautil.h"
 #include "coordit.h"
 #include "dbg-util.h"
+#include "dgn-proclayouts.h"
 #include "dungeon.h"
 #include "files.h"
 #include "god-wrath.h"
 #include "los.h"
+#include "losglobal.h"
 #include "maps.h"
 #include "message.h"
 #include "mon-act.h"
 #include "mon-cast.h"
 #include "mon-death.h"
+#include "mon-pathfind.h"
 #include "mon-poly.h"
 #include "ng-setup.h"
+#include "ray.h"
 #include "religion.h"
 #include "stairs.h"
 #include "state.h"
 #include "stringutil.h"
+#include "terrain.h"
 #include "tileview.h"
 #include "unique-creature-list-type.h"
 #include "unwind.h"
@@ -75,6 +82,28 @@ LUAFN(debug_goto_place)
 
 LUAWRAP(debug_dungeon_setup, initial_dungeon_setup())
 
+// Go to a level as the wizard interlevel travel command does, generating
+// it and saving the game on the way.
+LUAFN(debug_go_to_level)
+{
+#ifdef WIZARD
+    try
+    {
+        const level_id id = level_id::parse_level_id(luaL_checkstring(ls, 1));
+        if (id.depth < 1 || id.depth > brdepth[id.branch])
+            return luaL_argerror(ls, 1, "no such level");
+        wizard_go_to_level(id);
+    }
+    catch (const bad_level_id &err)
+    {
+        luaL_error(ls, err.what());
+    }
+#else
+    luaL_error(ls, "go_to_level needs a wizard build");
+#endif
+    return 0;
+}
+
 LUAFN(debug_enter_dungeon)
 {
     UNUSED(ls);
@@ -123,6 +152,247 @@ LUAFN(debug_reveal_mimics)
 
 LUAWRAP(debug_los_changed, los_changed())
 
+LUAFN(debug_ray_cache_stats)
+{
+    unsigned int hits, misses;
+    ray_cache_stats(hits, misses);
+    lua_pushnumber(ls, hits);
+    lua_pushnumber(ls, misses);
+    return 2;
+}
+
+// What the garbage collector of user scripts has been doing; see
+// CLua::gc_idle().
+LUAFN(debug_lua_gc_stats)
+{
+    const CLua::gc_stats &stats = clua.gc_info;
+    lua_newtable(ls);
+    lua_pushnumber(ls, lua_gc(clua.state(), LUA_GCCOUNT, 0));
+    lua_setfield(ls, -2, "heap_kb");
+    lua_pushnumber(ls, stats.idle_cycles);
+    lua_setfield(ls, -2, "idle_cycles");
+    lua_pushnumber(ls, stats.full_collections);
+    lua_setfield(ls, -2, "full_collections");
+    lua_pushnumber(ls, stats.refused_allocations);
+    lua_setfield(ls, -2, "refused_allocations");
+    lua_pushnumber(ls, stats.idle_ms);
+    lua_setfield(ls, -2, "idle_ms");
+    lua_pushnumber(ls, stats.longest_ms);
+    lua_setfield(ls, -2, "longest_ms");
+    return 1;
+}
+
+// How often the throttle has run, slowed down and stopped user scripts; see
+// _clua_throttle_hook().
+LUAFN(debug_lua_throttle_stats)
+{
+    const CLua::throttle_stats &stats = clua.throttle_info;
+    lua_newtable(ls);
+    lua_pushnumber(ls, stats.checks);
+    lua_setfield(ls, -2, "checks");
+    lua_pushnumber(ls, stats.sleeps);
+    lua_setfield(ls, -2, "sleeps");
+    lua_pushnumber(ls, stats.kills);
+    lua_setfield(ls, -2, "kills");
+    return 1;
+}
+
+// How many monsters were alive in the last monster turn, and how many times
+// one was queued to act.
+LUAFN(debug_monster_schedule_stats)
+{
+    unsigned int active, scheduled;
+    monster_schedule_stats(active, scheduled);
+    lua_pushnumber(ls, active);
+    lua_pushnumber(ls, scheduled);
+    return 2;
+}
+
+static volatile int _bench_sink;
+
+// Time count full passes of monster_iterator over the current level, doing
+// what the per-turn scans do with each monster. Returns nanoseconds per pass,
+// the number of monsters seen in a pass and how many slots it has to cover.
+LUAFN(debug_monster_iter_bench)
+{
+    const int count = luaL_safe_checkint(ls, 1);
+    if (count <= 0)
+        return luaL_argerror(ls, 1, "count must be positive");
+
+    trim_monster_slots();
+
+    int seen = 0;
+    int energy = 0;
+    const auto start = chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i)
+    {
+        seen = 0;
+        for (monster_iterator mi; mi; ++mi)
+        {
+            seen++;
+            energy += mi->speed_increment + mi->pos().x;
+        }
+    }
+    const double ns = chrono::duration<double, nano>(
+                          chrono::steady_clock::now() - start).count();
+    // Keep the loop from being optimised away.
+    _bench_sink = energy;
+
+    lua_pushnumber(ls, ns / count);
+    lua_pushnumber(ls, seen);
+    lua_pushnumber(ls, monster_slot_limit());
+    return 3;
+}
+
+// Time one of the LOS primitives ("losight", "cell_see_cell", "find_ray" or
+// "invalidate_los_around") from count random points on the current level.
+// Returns nanoseconds per call and the number of cache misses: LOS
+// recomputations for cell_see_cell, ray cache misses for find_ray.
+LUAFN(debug_los_bench)
+{
+    const string what = luaL_checkstring(ls, 1);
+    const int count = luaL_safe_checkint(ls, 2);
+    if (what != "losight" && what != "cell_see_cell" && what != "find_ray"
+        && what != "invalidate_los_around")
+    {
+        return luaL_argerror(ls, 1, "unknown LOS function");
+    }
+    if (count <= 0)
+        return luaL_argerror(ls, 2, "count must be positive");
+
+    // Pick the points beforehand so that the RNG isn't timed. Origins
+    // avoid walls where they can; targets are anywhere within LOS range.
+    vector<pair<coord_def, coord_def>> points(count);
+    for (auto &pq : points)
+    {
+        int tries = 0;
+        do
+            pq.first = random_in_bounds();
+        while (cell_is_solid(pq.first) && ++tries < 100);
+
+        do
+        {
+            pq.second = pq.first
+                        + coord_def(random_range(-LOS_RADIUS, LOS_RADIUS),
+                                    random_range(-LOS_RADIUS, LOS_RADIUS));
+        }
+        while (!in_bounds(pq.second));
+    }
+
+    unsigned int hits, ray_misses;
+    ray_cache_stats(hits, ray_misses);
+    const unsigned int los_misses = los_cache_misses();
+
+    los_grid grid;
+    ray_def ray;
+    const auto start = chrono::steady_clock::now();
+    for (const auto &pq : points)
+    {
+        if (what == "losight")
+            losight(grid, pq.first);
+        else if (what == "cell_see_cell")
+            cell_see_cell(pq.first, pq.second, LOS_DEFAULT);
+        else if (what == "find_ray")
+            find_ray(pq.first, pq.second, ray, opc_default);
+        else
+            invalidate_los_around(pq.first);
+    }
+    const double ns = chrono::duration<double, nano>(
+                          chrono::steady_clock::now() - start).count();
+
+    unsigned int misses = 0;
+    if (what == "cell_see_cell")
+        misses = los_cache_misses() - los_misses;
+    else if (what == "find_ray")
+    {
+        unsigned int new_misses;
+        ray_cache_stats(hits, new_misses);
+        misses = new_misses - ray_misses;
+    }
+
+    lua_pushnumber(ls, ns / count);
+    lua_pushnumber(ls, misses);
+    return 2;
+}
+
+// Time count monster pathfinders, as monsters tracking the player make
+// them: each between two random squares with floor at most range (default
+// LOS_DEFAULT_RANGE) apart, searching no further than range from the
+// target. Returns nanoseconds per pathfinder, including making it, and how
+// many paths were found.
+LUAFN(debug_pathfind_bench)
+{
+    const int count = luaL_safe_checkint(ls, 1);
+    const int range = lua_isnumber(ls, 2) ? luaL_safe_checkint(ls, 2)
+                                          : LOS_DEFAULT_RANGE;
+    if (count <= 0)
+        return luaL_argerror(ls, 1, "count must be positive");
+    if (range <= 0)
+        return luaL_argerror(ls, 2, "range must be positive");
+
+    // Pick the points beforehand so that the RNG isn't timed.
+    vector<pair<coord_def, coord_def>> points(count);
+    for (auto &pq : points)
+    {
+        int tries = 0;
+        do
+            pq.first = random_in_bounds();
+        while (!feat_has_solid_floor(env.grid(pq.first)) && ++tries < 100);
+
+        tries = 0;
+        do
+        {
+            pq.second = pq.first + coord_def(random_range(-range, range),
+                                             random_range(-range, range));
+        }
+        while (!in_bounds(pq.second)
+               || !feat_has_solid_floor(env.grid(pq.second)) && ++tries < 100);
+    }
+
+    int found = 0;
+    const auto start = chrono::steady_clock::now();
+    for (const auto &pq : points)
+    {
+        monster_pathfind mp;
+        mp.set_range(range);
+        if (mp.init_pathfind(pq.first, pq.second))
+            found++;
+    }
+    const double ns = chrono::duration<double, nano>(
+                          chrono::steady_clock::now() - start).count();
+
+    lua_pushnumber(ls, ns / count);
+    lua_pushnumber(ls, found);
+    return 2;
+}
+
+// Replace the level with one of the procedural layouts ("chaos",
+// "newabyss", "forest" or "underworld"), for tests that want terrain the
+// normal builder doesn't make.
+LUAFN(debug_proc_layout)
+{
+    const string name = luaL_checkstring(ls, 1);
+    const uint32_t seed = lua_isnumber(ls, 2) ? luaL_safe_checkint(ls, 2)
+                                              : rng::get_uint32();
+
+    unique_ptr<ProceduralLayout> layout;
+    if (name == "chaos")
+        layout.reset(new ChaosLayout(seed));
+    else if (name == "newabyss")
+        layout.reset(new NewAbyssLayout(seed));
+    else if (name == "forest")
+        layout.reset(new ForestLayout());
+    else if (name == "underworld")
+        layout.reset(new UnderworldLayout());
+    else
+        return luaL_argerror(ls, 1, "unknown layout");
+
+    for (rectangle_iterator ri(1); ri; ++ri)
+        env.grid(*ri) = (*layout)(*ri).feat();
+    los_changed();
+    return 0;
+}
+
 LUAFN(debug_builder_ignore_depth)
 {
     const bool b = lua_toboolean(ls, 1);
@@ -148,6 +418,15 @@ LUAFN(debug_vault_names)
     return 1;
 }
 
+// A hash of everything generated on the current level, as a hex string
+// (Lua numbers can't hold all 64 bits).
+LUAFN(debug_level_hash)
+{
+    const string hash = make_stringf("%016" PRIx64, level_hash());
+    lua_pushstring(ls, hash.c_str());
+    return 1;
+}
+
 LUAFN(_debug_test_explore)
 {
     UNUSED(ls);
@@ -479,6 +758,7 @@ const struct luaL_reg debug_dlib[] =
 { "goto_place", debug_goto_place },
 { "dungeon_setup", debug_dungeon_setup },
 { "enter_dungeon", debug_enter_dungeon },
+{ "go_to_level", debug_go_to_level },
 { "down_stairs", debug_down_stairs },
 { "up_stairs", debug_up_stairs },
 { "flush_map_memory", debug_flush_map_memory },
@@ -486,8 +766,15 @@ const struct luaL_reg debug_dlib[] =
 { "generate_level", debug_generate_level },
 { "reveal_mimics", debug_reveal_mimics },
 { "los_changed", debug_los_changed },
+{ "ray_cache_stats", debug_ray_cache_stats },
+{ "lua_gc_stats", debug_lua_gc_stats },
+{ "lua_throttle_stats", debug_lua_throttle_stats },
+{ "los_bench", debug_los_bench },
+{ "pathfind_bench", debug_pathfind_bench },
+{ "proc_layout", debug_proc_layout },
 { "dump_map", debug_dump_map },
 { "vault_names", debug_vault_names },
+{ "level_hash", debug_level_hash },
 { "test_explore", _debug_test_explore },
 { "bouncy_beam", debug_bouncy_beam },
 { "cull_monsters", debug_cull_monsters},
@@ -495,6 +782,8 @@ const struct luaL_reg debug_dlib[] =
 { "dismiss_monsters", debug_dismiss_monsters},
 { "god_wrath", debug_god_wrath},
 { "handle_monster_move", debug_handle_monster_move },
+{ "monster_schedule_stats", debug_monster_schedule_stats },
+{ "monster_iter_bench", debug_monster_iter_bench },
 { "save_uniques", debug_save_uniques },
 { "randomize_uniques", debug_randomize_uniques },
 { "reset_uniques", debug_reset_uniques },
@@ -623,6 +623,13 @@ static int _dgn_count_tele_zones(lua_State *ls)
     PLUARET(number, dgn_count_tele_zones(true));
 }
 
+static int _dgn_zones_connected(lua_State *ls)
+{
+    COORDS(a, 1, 2);
+    COORDS(b, 3, 4);
+    PLUARET(boolean, dgn_zones_connected(a, b));
+}
+
 static void dlua_push_coordinates(lua_State *ls, const coord_def &c)
 {
     lua_pushnumber(ls, c.x);
@@ -1831,6 +1838,7 @@ const struct luaL_reg dgn_dlib[] =
 { "has_exit_from", dgn_has_exit_from },
 { "count_disconnected_zones", _dgn_count_disconnected_zones },
 { "count_tele_zones", _dgn_count_tele_zones },
+{ "zones_connected", _dgn_zones_connected },
 { "gly_point", dgn_gly_point },
 { "gly_points", dgn_gly_points },
 { "original_map", dgn_original_map },
@@ -163,6 +163,66 @@ static void _border_area(map_lines &lines, int x1, int y1, int x2, int y2, char
         lines(x1, y) = border, lines(x2, y) = border;
 }
 
+// Which cells of a map are in a glyph set, a byte each, so that the
+// neighbours of a whole row of cells can be counted in one tight loop.
+class glyph_plane
+{
+public:
+    glyph_plane(const map_lines &lines, const glyph_set &glyphs)
+        : width(lines.width()), cells(lines.width() * lines.height())
+    {
+        for (int y = 0; y < lines.height(); ++y)
+            for (int x = 0; x < width; ++x)
+                cells[y * width + x] = glyphs(lines(x, y));
+    }
+
+    bool operator()(int x, int y) const
+    {
+        return cells[y * width + x];
+    }
+
+    void set(int x, int y, bool in_set)
+    {
+        cells[y * width + x] = in_set;
+    }
+
+    // The number of orthogonal (or, if boxy, all eight) neighbours of a
+    // cell not on the edge of the map that are in the set.
+    int count(int x, int y, bool boxy) const
+    {
+        const uint8_t *row = &cells[y * width + x];
+        int n = row[-width] + row[width] + row[-1] + row[1];
+        if (boxy)
+            n += row[-width - 1] + row[-width + 1]
+                 + row[width - 1] + row[width + 1];
+        return n;
+    }
+
+    // As count(), for each of the cells x1..x2 in row y, into counts[x].
+    void count_row(int y, int x1, int x2, bool boxy,
+                   vector<uint8_t> &counts) const
+    {
+        const uint8_t *above = &cells[(y - 1) * width];
+        const uint8_t *row = above + width;
+        const uint8_t *below = row + width;
+        counts.resize(width);
+        for (int x = x1; x <= x2; ++x)
+            counts[x] = above[x] + below[x] + row[x - 1] + row[x + 1];
+        if (boxy)
+        {
+            for (int x = x1; x <= x2; ++x)
+            {
+                counts[x] += above[x - 1] + above[x + 1]
+                             + below[x - 1] + below[x + 1];
+            }
+        }
+    }
+
+private:
+    int width;
+    vector<uint8_t> cells;
+};
+
 // Does what count_passable_neighbors does, but in C++ form.
 static int _count_passable_neighbors(lua_State *ls, map_lines &lines, int x,
                                      int y, const char *passable = traversable_glyphs)
@@ -181,9 +241,9 @@ static int _count_passable_neighbors(lua_State *ls, map_lines &lines, int x,
 }
 
 static vector<coord_def> _get_pool_seed_positions(
-                                                vector<vector<int> > pool_index,
-                                                int pool_size,
-                                                int min_separation)
+                                        const vector<vector<int> > &pool_index,
+                                        int pool_size,
+                                        int min_separation)
 {
     const int NO_POOL   = 999997; // must match dgn_add_pools
 
@@ -644,25 +704,27 @@ LUAFN(dgn_fill_disconnected)
 
     travel_distance_grid_t tpd;
     memset(tpd, 0, sizeof(tpd));
+    const glyph_set passable_glyphs(passable ? passable : "");
 
     int nzones = 0;
+    vector<coord_def> zone_points;
     for (rectangle_iterator ri(tl, br); ri; ++ri)
     {
         const coord_def c = *ri;
-        if (tpd[c.x][c.y] || passable && !strchr(passable, lines(c)))
+        if (tpd[c.x][c.y] || passable && !passable_glyphs(lines(c)))
             continue;
 
-        if (lines.fill_zone(tpd, c, tl, br, ++nzones, wanted, passable))
+        zone_points.clear();
+        if (lines.fill_zone(tpd, c, tl, br, ++nzones, wanted, passable,
+                            &zone_points))
+        {
             continue;
+        }
 
         // If wanted wasn't found, fill every passable square that
         // we just found with the 'fill' glyph.
-        for (rectangle_iterator f(tl, br); f; ++f)
-        {
-            const coord_def fc = *f;
-            if (tpd[fc.x][fc.y] == nzones)
-                lines(fc) = fill;
-        }
+        for (const coord_def &fc : zone_points)
+            lines(fc) = fill;
     }
 
     return 0;
@@ -1366,24 +1428,22 @@ LUAFN(dgn_remove_isolated_glyphs)
     if (y2 >= lines.height() - 1)
         y2 = lines.height() - 2;
 
+    // Kept up to date as glyphs are replaced, since that can leave their
+    // neighbours isolated in turn. Nothing on the border changes, so the
+    // neighbours of x1..x2 and y1..y2 are all on the map.
+    const glyph_set found(find);
+    glyph_plane plane(lines, found);
+    const bool replace_found = found(replace);
+
     for (int y = y1; y <= y2; ++y)
         for (int x = x1; x <= x2; ++x)
-            if (strchr(find, lines(x, y)) && x_chance_in_y(percent, 100))
+            if (plane(x, y) && x_chance_in_y(percent, 100))
             {
-                bool do_replace = true;
-                for (radius_iterator ri(coord_def(x, y), 1,
-                                        (boxy ? C_ROUND : C_POINTY),
-                                        true); ri; ++ri)
+                if (!plane.count(x, y, boxy))
                 {
-                    if (_valid_coord(ls, lines, ri->x, ri->y, false))
-                        if (strchr(find, lines(*ri)))
-                        {
-                            do_replace = false;
-                            break;
-                        }
-                }
-                if (do_replace)
                     lines(x, y) = replace;
+                    plane.set(x, y, replace_found);
+                }
             }
 
     return 0;
@@ -1439,24 +1499,24 @@ LUAFN(dgn_widen_paths)
     // We do not replace this as we go to avoid favouring some directions.
     vector<coord_def> coord_to_replace;
 
+    // Nothing changes until the end, so whole rows of neighbours can be
+    // counted at once; nothing on the border changes, so they are all on
+    // the map.
+    const glyph_set found(find);
+    const glyph_plane passable_plane(lines, glyph_set(passable));
+    vector<uint8_t> neighbours;
+
     for (int y = y1; y <= y2; ++y)
+    {
+        passable_plane.count_row(y, x1, x2, boxy, neighbours);
         for (int x = x1; x <= x2; ++x)
-            if (strchr(find, lines(x, y)))
+            if (found(lines(x, y)))
             {
-                int neighbour_count = 0;
-                for (radius_iterator ri(coord_def(x, y), 1,
-                                        (boxy ? C_ROUND : C_POINTY),
-                                        true); ri; ++ri)
-                {
-                    if (_valid_coord(ls, lines, ri->x, ri->y, false))
-                        if (strchr(passable, lines(*ri)))
-                            neighbour_count++;
-                }
-
                 // store this coordinate if needed
-                if (x_chance_in_y(percent_for_neighbours[neighbour_count], 100))
+                if (x_chance_in_y(percent_for_neighbours[neighbours[x]], 100))
                     coord_to_replace.emplace_back(x, y);
             }
+    }
 
     // now go through and actually replace the positions
     for (coord_def c : coord_to_replace)
@@ -1960,6 +2020,7 @@ LUAFN(dgn_smear_map)
     const int max_test_per_iteration = 10;
     int sanity = 0;
     int max_sanity = iterations * max_test_per_iteration;
+    const glyph_set onto_glyphs(onto);
 
     for (int i = 0; i < iterations; i++)
     {
@@ -1976,7 +2037,7 @@ LUAFN(dgn_smear_map)
                 mc.x = random_range(x1+border, y2-border);
                 mc.y = random_range(y1+border, y2-border);
             }
-            while (onto[0] && !strchr(onto, lines(mc)));
+            while (onto[0] && !onto_glyphs(lines(mc)));
 
             // Is there a "smear" feature along the diagonal from mc?
             diagonals = lines(mc.x + 1, mc.y + 1) == smear
@@ -2015,6 +2076,7 @@ LUAFN(dgn_spotty_map)
     const int max_test_per_iteration = 10;
     int sanity = 0;
     int max_sanity = iterations * max_test_per_iteration;
+    const glyph_set replaced(replace);
 
     for (int i = 0; i < iterations; i++)
     {
@@ -2027,20 +2089,20 @@ LUAFN(dgn_spotty_map)
             x = random_range(x1 + border, x2 - border);
             y = random_range(y1 + border, y2 - border);
         }
-        while (strchr(replace, lines(x, y))
-               && strchr(replace, lines(x-1, y))
-               && strchr(replace, lines(x+1, y))
-               && strchr(replace, lines(x, y-1))
-               && strchr(replace, lines(x, y+1))
-               && strchr(replace, lines(x-2, y))
-               && strchr(replace, lines(x+2, y))
-               && strchr(replace, lines(x, y-2))
-               && strchr(replace, lines(x, y+2)));
+        while (replaced(lines(x, y))
+               && replaced(lines(x-1, y))
+               && replaced(lines(x+1, y))
+               && replaced(lines(x, y-1))
+               && replaced(lines(x, y+1))
+               && replaced(lines(x-2, y))
+               && replaced(lines(x+2, y))
+               && replaced(lines(x, y-2))
+               && replaced(lines(x, y+2)));
 
         for (radius_iterator ai(coord_def(x, y), boxy ? 2 : 1, C_CIRCLE,
                                 false); ai; ++ai)
         {
-            if (strchr(replace, lines(*ai)))
+            if (replaced(lines(*ai)))
                 lines(*ai) = fill;
         }
     }
@@ -2100,11 +2162,12 @@ LUAFN(dgn_add_pools)
     //       a fixedarray because we don't know the size at
     //       compile time.
 
+    const glyph_set replaced(replace);
     vector<vector<int> > pool_index(size_x, vector<int>(size_y, FORBIDDEN));
     for (int x = 0; x < size_x; x++)
         for (int y = 0; y < size_y; y++)
         {
-            if (strchr(replace, lines(x + x1, y + y1)))
+            if (replaced(lines(x + x1, y + y1)))
                 pool_index[x][y] = NO_POOL;
         }
 
@@ -73,6 +73,7 @@ const struct luaL_reg los_dlib[] =
 LUAFN(ray_start)
 {
     RAY(ls, 1, ray);
+    ray->sync();
     lua_pushnumber(ls, ray->r.start.x);
     lua_pushnumber(ls, ray->r.start.y);
     return 2;
@@ -81,6 +82,7 @@ LUAFN(ray_start)
 LUAFN(ray_dir)
 {
     RAY(ls, 1, ray);
+    ray->sync();
     lua_pushnumber(ls, ray->r.dir.x);
     lua_pushnumber(ls, ray->r.dir.y);
     return 2;
@@ -13,6 +13,7 @@
 #include "fight.h"
 #include "l-defs.h"
 #include "libutil.h" // map_find
+#include "los.h"
 #include "mon-book.h"
 #include "mon-pick.h"
 #include "mon-place.h"
@@ -912,9 +913,42 @@ LUAFN(mi_get_monster_at)
     return 1;
 }
 
+/*** Get information about every monster the player can see.
+ * They come column by column from the west, and north to south in each
+ * column, just as a scan of the player's line of sight with get_monster_at
+ * would find them; but this is much cheaper than calling that for every
+ * cell.
+ * @treturn {monster.info,...}
+ * @function get_monsters_in_view
+ */
+LUAFN(mi_get_monsters_in_view)
+{
+    const int r = get_los_radius();
+    lua_newtable(ls);
+    int index = 0;
+    for (int x = -r; x <= r; ++x)
+        for (int y = -r; y <= r; ++y)
+        {
+            const coord_def p = player2grid(coord_def(x, y));
+            if (!map_bounds(p) || !you.see_cell(p)
+                || env.mgrid(p) == NON_MONSTER)
+            {
+                continue;
+            }
+            monster* m = &env.mons[env.mgrid(p)];
+            if (!m->visible_to(&you))
+                continue;
+            monster_info mi(m);
+            lua_push_moninf(ls, &mi);
+            lua_rawseti(ls, -2, ++index);
+        }
+    return 1;
+}
+
 static const struct luaL_reg mon_lib[] =
 {
     { "get_monster_at", mi_get_monster_at },
+    { "get_monsters_in_view", mi_get_monsters_in_view },
 
     { nullptr, nullptr }
 };
@@ -190,6 +190,59 @@ LUAFN(l_set_travel_trail)
     return 0;
 }
 
+// The seed of the last travel.fill_distances, so that distance_at can tell
+// it (at distance 0) from squares that weren't reached.
+static coord_def distance_seed;
+
+/*** Fill the travel distance field from a square.
+ * Finds the travel distance from the given square to every square reachable
+ * from it in one go, to be read with distance_at afterward instead of
+ * pathing to each square separately. The field is only good until the next
+ * travel or explore.
+ * Uses player-centered coordinates.
+ * @tparam[opt=0] int x
+ * @tparam[opt=0] int y
+ * @function fill_distances
+ */
+LUAFN(l_fill_distances)
+{
+    coord_def s;
+    if (lua_gettop(ls) > 1)
+    {
+        s.x = luaL_safe_checkint(ls, 1);
+        s.y = luaL_safe_checkint(ls, 2);
+    }
+    const coord_def p = player2grid(s);
+    if (!in_known_map_bounds(p))
+        return luaL_error(ls, "Coordinates out of bounds: (%d, %d)", s.x, s.y);
+    distance_seed = p;
+    fill_travel_point_distance(p);
+    return 0;
+}
+
+/*** The travel distance to a square, from the last fill_distances.
+ * Uses player-centered coordinates.
+ * @tparam int x
+ * @tparam int y
+ * @treturn int|nil the distance, or nil if the square couldn't be reached
+ * @function distance_at
+ */
+LUAFN(l_distance_at)
+{
+    coord_def s;
+    s.x = luaL_safe_checkint(ls, 1);
+    s.y = luaL_safe_checkint(ls, 2);
+    const coord_def p = player2grid(s);
+    if (!map_bounds(p))
+        return 0;
+    if (p == distance_seed)
+        PLUARET(number, 0);
+    const int dist = travel_point_distance[p.x][p.y];
+    if (dist <= 0)
+        return 0;
+    PLUARET(number, dist);
+}
+
 static const struct luaL_reg travel_lib[] =
 {
     { "set_exclude", l_set_exclude },
@@ -202,6 +255,8 @@ static const struct luaL_reg travel_lib[] =
     { "set_waypoint", l_set_waypoint },
     { "clear_travel_trail", l_clear_travel_trail },
     { "set_travel_trail", l_set_travel_trail },
+    { "fill_distances", l_fill_distances },
+    { "distance_at", l_distance_at },
 
     { nullptr, nullptr }
 };
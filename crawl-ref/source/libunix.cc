@@ -20,6 +20,7 @@
 
 #include <cassert>
 #include <cctype>
+#include <chrono>
 #include <clocale>
 #include <cstdarg>
 #include <cstdio>
@@ -27,6 +28,7 @@
 #include <cstring>
 #include <cwchar>
 #include <langinfo.h>
+#include <poll.h>
 #include <term.h>
 #include <termios.h>
 #include <unistd.h>
@@ -330,6 +332,84 @@ static void init_pair_safe(short pair, short f, short b);
 
 static bool cursor_is_enabled = true;
 
+// What puttext() last drew in each cell of the screen, so that redrawing
+// the view only goes through curses where it changed. Anything else that
+// writes to a cell forgets it there.
+struct shadow_cell
+{
+    char32_t glyph;
+    int colour;
+};
+#define SHADOW_UNKNOWN char32_t(~0U)
+static vector<shadow_cell> shadow_screen;
+static int shadow_cols = 0;
+
+static void shadow_forget(int y, int x, int count)
+{
+    if (y < 0 || x < 0 || x >= shadow_cols
+        || (y + 1) * shadow_cols > (int) shadow_screen.size())
+    {
+        return;
+    }
+    count = min(count, shadow_cols - x);
+    for (int i = 0; i < count; i++)
+        shadow_screen[y * shadow_cols + x + i].glyph = SHADOW_UNKNOWN;
+}
+
+static void shadow_forget_all()
+{
+    for (shadow_cell &cell : shadow_screen)
+        cell.glyph = SHADOW_UNKNOWN;
+}
+
+// With terminal_frame_rate set, update_screen() writes to the terminal at
+// most that often, and leaves the rest pending until the next write, key
+// read or real delay.
+static bool screen_pending = false;
+static chrono::steady_clock::time_point last_screen_write;
+
+static void write_screen()
+{
+    // Refreshing the default colors helps keep colors synced in ttyrecs.
+    curs_set_default_colors();
+    refresh();
+    screen_pending = false;
+    last_screen_write = chrono::steady_clock::now();
+}
+
+static void write_pending_screen()
+{
+    if (screen_pending && stdscr)
+        write_screen();
+}
+
+static void screen_changed()
+{
+    const int rate = Options.terminal_frame_rate;
+    if (rate > 0 && chrono::steady_clock::now() - last_screen_write
+                    < chrono::milliseconds(1000 / rate))
+    {
+        screen_pending = true;
+    }
+    else
+        write_screen();
+}
+
+// A blank without highlights looks the same whatever its foreground.
+static bool _plain_blank(char32_t glyph, int colour)
+{
+    return (glyph == ' ' || !glyph) && !(colour & COLFLAG_MASK);
+}
+
+static bool _shadow_matches(const shadow_cell &drawn, char32_t glyph,
+                            int colour)
+{
+    if (drawn.glyph == glyph && drawn.colour == colour)
+        return true;
+    return Options.minimal_sgr && _plain_blank(drawn.glyph, drawn.colour)
+           && _plain_blank(glyph, colour);
+}
+
 static unsigned int convert_to_curses_style(int chattr)
 {
     switch (chattr & CHATTR_ATTRMASK)
@@ -521,6 +601,8 @@ static int _get_key_from_curses()
 
     wint_t c;
 
+    write_pending_screen();
+
 #ifdef USE_TILE_WEB
     refresh();
 
@@ -918,6 +1000,7 @@ void console_shutdown()
 
     // resetty();
     endwin();
+    shadow_screen.clear();
 
     tcsetattr(0, TCSAFLUSH, &def_term);
 #ifdef CURSES_USE_KEYPAD
@@ -974,6 +1057,7 @@ void putwch(char32_t chr)
     {
         if (!c)
             c = ' ';
+        shadow_forget(getcury(stdscr), getcurx(stdscr), max(wcwidth(c), 1));
         // TODO: recognize unsupported characters and try to transliterate
         addnwstr(&c, 1);
     }
@@ -990,15 +1074,76 @@ void puttext(int x1, int y1, const crawl_view_buffer &vbuf)
 {
     const screen_cell_t *cell = vbuf;
     const coord_def size = vbuf.size();
+
+    if (_headless_mode || !stdscr)
+    {
+        for (int y = 0; y < size.y; ++y)
+        {
+            cgotoxy(x1, y1 + y);
+            for (int x = 0; x < size.x; ++x)
+            {
+                put_colour_ch(cell->colour, cell->glyph);
+                cell++;
+            }
+        }
+        return;
+    }
+
+    if (shadow_cols != COLS || (int) shadow_screen.size() != LINES * COLS)
+    {
+        shadow_cols = COLS;
+        shadow_screen.assign(LINES * COLS, { SHADOW_UNKNOWN, 0 });
+    }
+
     for (int y = 0; y < size.y; ++y)
     {
         cgotoxy(x1, y1 + y);
-        for (int x = 0; x < size.x; ++x)
+        const int sy = getcury(stdscr);
+        const int sx = getcurx(stdscr);
+        const int width = min(size.x, shadow_cols - sx);
+        shadow_cell *drawn = &shadow_screen[sy * shadow_cols + sx];
+
+        int last_colour = -1;
+        bool moved = false;
+        for (int x = 0; x < width; ++x, ++cell, ++drawn)
         {
+            const char32_t glyph = cell->glyph;
+            int colour = cell->colour;
+
+            if (_shadow_matches(*drawn, glyph, colour))
+            {
+                moved = true;
+                continue;
+            }
+
+            // Blanks take the colour already set, rather than asking for
+            // a foreground that wouldn't show anyway.
+            if (Options.minimal_sgr && last_colour != -1
+                && _plain_blank(glyph, colour)
+                && !(last_colour & COLFLAG_MASK))
+            {
+                colour = last_colour;
+            }
+
+            if (moved)
+            {
+                move(sy, sx + x);
+                moved = false;
+            }
+            if (colour != last_colour)
+            {
+                textcolour(colour);
+                last_colour = colour;
+            }
             // headless check handled in putwch, which this calls
-            put_colour_ch(cell->colour, cell->glyph);
-            cell++;
+            putwch(glyph);
+
+            // Wide characters spill into the next cell, so don't trust
+            // either of them.
+            if (wcwidth(glyph ? glyph : ' ') == 1)
+                *drawn = { glyph, colour };
         }
+        cell += size.x - width;
     }
 }
 
@@ -1011,11 +1156,7 @@ void update_screen()
 {
     // In objstat, headless, and similar modes, there might not be a screen to update.
     if (stdscr)
-    {
-        // Refreshing the default colors helps keep colors synced in ttyrecs.
-        curs_set_default_colors();
-        refresh();
-    }
+        screen_changed();
 
 #ifdef USE_TILE_WEB
     tiles.set_need_redraw();
@@ -1028,6 +1169,7 @@ void clear_to_end_of_line()
     {
         textcolour(LIGHTGREY);
         textbackground(BLACK);
+        shadow_forget(getcury(stdscr), getcurx(stdscr), shadow_cols);
         clrtoeol(); // shouldn't move cursor pos
     }
 
@@ -1087,6 +1229,7 @@ void clrscr_sys()
     textcolour(LIGHTGREY);
     textbackground(BLACK);
     clear();
+    shadow_forget_all();
 #ifdef DGAMELAUNCH
     if (!_suppress_dgl_clrscr)
     {
@@ -1819,6 +1962,7 @@ void fakecursorxy(int x, int y)
 
     cchar_t c = character_at(y_curses, x_curses);
     flip_colour(c);
+    shadow_forget(y_curses, x_curses, 1);
     write_char_at(y_curses, x_curses, c);
     // the above still results in changes to the return values for wherex and
     // wherey, so set the cursor region to ensure that the cursor position is
@@ -1848,15 +1992,21 @@ void delay(unsigned int time)
         return;
 
 #ifdef USE_TILE_WEB
-    tiles.redraw();
-    if (time)
+    if (tiles.redraw_paced() && time)
     {
         tiles.send_message("{\"msg\":\"delay\",\"t\":%d}", time);
         tiles.flush_messages();
     }
 #endif
 
-    refresh();
+    // A frame shown for no time at all is just another screen update.
+    if (stdscr && !time)
+        screen_changed();
+    else
+    {
+        write_pending_screen();
+        refresh();
+    }
     if (time)
         usleep(time * 1000);
 }
@@ -1893,6 +2043,16 @@ bool kbhit()
 #ifndef USE_TILE_WEB
     int i;
 
+    // Reading from curses writes the screen out first, which would undo
+    // terminal_frame_rate while travelling; don't unless there's input.
+    // (Keys curses has already read in are found by the next real read.)
+    if (Options.terminal_frame_rate > 0)
+    {
+        struct pollfd in = { 0, POLLIN, 0 };
+        if (poll(&in, 1, 0) <= 0)
+            return false;
+    }
+
     nodelay(stdscr, TRUE);
     timeout(0);  // apparently some need this to guarantee non-blocking -- bwr
     i = get_wch(&c);
@@ -46,6 +46,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <set>
 
 #include "areas.h"
 #include "coord.h"
@@ -54,6 +55,8 @@
 #include "losglobal.h"
 #include "mon-act.h"
 #include "mpr.h"
+#include "player.h"
+#include "turn-times.h"
 
 // These determine what rays are cast in the precomputation,
 // and affect start-up time significantly.
@@ -64,8 +67,8 @@
 // These store all unique (in terms of footprint) full rays.
 // The footprint of ray=fullray[i] consists of ray.length cells,
 // stored in ray_coords[ray.start..ray.length-1].
-// These are filled during precomputation (_register_ray).
-// XXX: fullrays is not needed anymore after precomputation.
+// These are filled during precomputation (_register_ray); fullrays is
+// emptied once the blockrays have been made from it.
 struct los_ray;
 static vector<los_ray> fullrays;
 static vector<coord_def> ray_coords;
@@ -76,6 +79,9 @@ static vector<coord_def> ray_coords;
 // words, blockrays(p)[i] is set iff an opaque cell p blocks
 // the cellray with index i.
 static vector<coord_def> cellray_ends;
+// Cellrays are sorted by the rdist of their end cell, so those
+// ending within radius r are exactly the first n_rays_within[r].
+static int n_rays_within[LOS_MAX_RANGE+1];
 typedef FixedArray<bit_vector*, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1> blockrays_t;
 static blockrays_t blockrays;
 
@@ -86,25 +92,24 @@ struct cellray;
 static FixedArray<vector<cellray>, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1> min_cellrays;
 
 // Temporary arrays used in losight() to track which rays
-// are blocked or have seen a smoke cloud.
-// Allocated when doing the precomputations.
-static bit_vector *dead_rays     = nullptr;
-static bit_vector *smoke_rays    = nullptr;
+// are blocked or have seen a smoke cloud. Every thread that works
+// out LOS gets its own, the first time it does.
+static thread_local unique_ptr<bit_vector> dead_rays;
+static thread_local unique_ptr<bit_vector> smoke_rays;
 
 class quadrant_iterator : public rectangle_iterator
 {
 public:
-    quadrant_iterator()
-        : rectangle_iterator(coord_def(0,0),
-                             coord_def(LOS_MAX_RANGE, LOS_MAX_RANGE))
+    quadrant_iterator(int r = LOS_MAX_RANGE)
+        : rectangle_iterator(coord_def(0,0), coord_def(r, r))
     {
     }
 };
 
 void clear_rays_on_exit()
 {
-    delete dead_rays;
-    delete smoke_rays;
+    dead_rays.reset();
+    smoke_rays.reset();
     for (quadrant_iterator qi; qi; ++qi)
         delete blockrays(*qi);
 }
@@ -181,24 +186,15 @@ struct los_ray : public ray_def
     }
 };
 
-// Check if the passed rays have identical footprint.
-static bool _is_same_ray(los_ray ray, vector<coord_def> newray)
-{
-    if (ray.length != newray.size())
-        return false;
-    for (unsigned int i = 0; i < ray.length; i++)
-        if (ray[i] != newray[i])
-            return false;
-    return true;
-}
+// Footprints of all rays in fullrays, to weed out duplicates without
+// comparing against every ray registered so far. Only needed during the
+// precomputation.
+static set<vector<coord_def>> *ray_footprints = nullptr;
 
 // Check if the passed ray has already been created.
-static bool _is_duplicate_ray(vector<coord_def> newray)
+static bool _is_duplicate_ray(const vector<coord_def> &newray)
 {
-    for (los_ray lray : fullrays)
-        if (_is_same_ray(lray, newray))
-            return true;
-    return false;
+    return !ray_footprints->insert(newray).second;
 }
 
 // A cellray given by fullray and index of end-point.
@@ -313,7 +309,7 @@ static vector<int> _find_minimal_cellrays()
     FixedArray<list<cellray>, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1> minima;
     list<cellray>::iterator min_it;
 
-    for (los_ray ray : fullrays)
+    for (los_ray &ray : fullrays)
     {
         for (unsigned int i = 0; i < ray.length; ++i)
         {
@@ -393,7 +389,7 @@ static void _create_blockrays()
     for (quadrant_iterator qi; qi; ++qi)
         all_blockrays(*qi) = new bit_vector(n_cellrays);
 
-    for (los_ray ray : fullrays)
+    for (los_ray &ray : fullrays)
     {
         for (unsigned int i = 0; i < ray.length; ++i)
         {
@@ -410,9 +406,22 @@ static void _create_blockrays()
     // Determine minimal cellrays and store their indices in ray_coords.
     vector<int> min_indices = _find_minimal_cellrays();
     const int n_min_rays    = min_indices.size();
+    // Order them by distance, so that a reduced LOS radius only has
+    // to look at a prefix of the rays.
+    stable_sort(min_indices.begin(), min_indices.end(),
+                [](int a, int b)
+                {
+                    return ray_coords[a].rdist() < ray_coords[b].rdist();
+                });
     cellray_ends.resize(n_min_rays);
     for (int i = 0; i < n_min_rays; ++i)
         cellray_ends[i] = ray_coords[min_indices[i]];
+    for (int r = 0, i = 0; r <= LOS_MAX_RANGE; ++r)
+    {
+        while (i < n_min_rays && cellray_ends[i].rdist() <= r)
+            ++i;
+        n_rays_within[r] = i;
+    }
 
     // Compress blockrays accordingly.
     for (quadrant_iterator qi; qi; ++qi)
@@ -429,11 +438,10 @@ static void _create_blockrays()
     for (quadrant_iterator qi; qi; ++qi)
         delete all_blockrays(*qi);
 
-    dead_rays  = new bit_vector(n_min_rays);
-    smoke_rays = new bit_vector(n_min_rays);
-
     dprf("Cellrays: %d Fullrays: %u Minimal cellrays: %u",
           n_cellrays, (unsigned int)fullrays.size(), n_min_rays);
+
+    vector<los_ray>().swap(fullrays);
 }
 
 static int _gcd(int x, int y)
@@ -464,6 +472,7 @@ static void raycast()
     // Creating all rays for first quadrant
     // We have a considerable amount of overkill.
     done_raycast = true;
+    ray_footprints = new set<vector<coord_def>>;
 
     // register perpendiculars FIRST, to make them top choice
     // when selecting beams
@@ -503,6 +512,9 @@ static void raycast()
         }
     }
 
+    delete ray_footprints;
+    ray_footprints = nullptr;
+
     // Now create the appropriate blockrays array
     _create_blockrays();
 }
@@ -622,9 +634,99 @@ struct opacity_trans : public opacity_func
 // If cycle is false, find the first fitting ray. If it is true,
 // assume that ray is appropriately filled in, and look for the next
 // ray. We only ever use ray.cycle_idx.
+// Recently found rays.  AI code looks for the same rays over and over in a
+// turn (targeting, then tracers, then the actual spell), so keep the last
+// few, for the opacity_funcs that depend on nothing but the level. Entries
+// are good for as long as no opacity has changed, and at most for a turn.
+struct ray_cache_entry
+{
+    coord_def source, target;
+    const opacity_func *opc;
+    uint32_t generation;
+    int turn;
+    bool found;
+    ray_def ray;
+};
+#define RAY_CACHE_SIZE 256
+static ray_cache_entry ray_cache[RAY_CACHE_SIZE];
+static unsigned int ray_cache_hit_count = 0, ray_cache_miss_count = 0;
+
+static bool _ray_cacheable(const opacity_func &opc)
+{
+    return &opc == &opc_default || &opc == &opc_no_trans
+           || &opc == &opc_solid || &opc == &opc_solid_see
+           || &opc == &opc_fullyopaque || &opc == &opc_fully_no_trans;
+}
+
+static ray_cache_entry &_ray_cache_slot(const coord_def& source,
+                                        const coord_def& target,
+                                        const opacity_func &opc)
+{
+    unsigned int h = (source.x * GYM + source.y) * 2654435761U;
+    h ^= (target.x * GYM + target.y) * 40503U;
+    h ^= reinterpret_cast<uintptr_t>(&opc) >> 4;
+    return ray_cache[(h ^ h >> 16) % RAY_CACHE_SIZE];
+}
+
+void ray_cache_stats(unsigned int &hits, unsigned int &misses)
+{
+    hits = ray_cache_hit_count;
+    misses = ray_cache_miss_count;
+}
+
+size_t los_ray_bytes()
+{
+    size_t bytes = ray_coords.capacity() * sizeof(coord_def)
+                   + cellray_ends.capacity() * sizeof(coord_def)
+                   + sizeof(ray_cache);
+    for (quadrant_iterator qi; qi; ++qi)
+    {
+        bytes += min_cellrays(*qi).capacity() * sizeof(cellray);
+        if (blockrays(*qi))
+            bytes += (cellray_ends.size() + 7) / 8;
+    }
+    return bytes;
+}
+
+static bool _find_ray(const coord_def& source, const coord_def& target,
+                      ray_def& ray, const opacity_func& opc, int range,
+                      bool cycle);
+
 bool find_ray(const coord_def& source, const coord_def& target,
               ray_def& ray, const opacity_func& opc, int range,
               bool cycle)
+{
+    // Cycling depends on the ray passed in; the range check is cheaper
+    // than the cache.
+    if (cycle || !_ray_cacheable(opc) || (target - source).rdist() > range)
+        return _find_ray(source, target, ray, opc, range, cycle);
+
+    ray_cache_entry &entry = _ray_cache_slot(source, target, opc);
+    if (entry.opc == &opc && entry.source == source && entry.target == target
+        && entry.generation == los_opacity_generation()
+        && entry.turn == you.num_turns)
+    {
+        ray_cache_hit_count++;
+        if (entry.found)
+            ray = entry.ray;
+        return entry.found;
+    }
+
+    ray_cache_miss_count++;
+    entry.found = _find_ray(source, target, entry.ray, opc, range, false);
+    entry.source = source;
+    entry.target = target;
+    entry.opc = &opc;
+    entry.generation = los_opacity_generation();
+    entry.turn = you.num_turns;
+    if (entry.found)
+        ray = entry.ray;
+    return entry.found;
+}
+
+static bool _find_ray(const coord_def& source, const coord_def& target,
+                      ray_def& ray, const opacity_func& opc, int range,
+                      bool cycle)
 {
     if (target == source || !map_bounds(source) || !map_bounds(target))
         return false;
@@ -649,6 +751,12 @@ bool find_ray(const coord_def& source, const coord_def& target,
     ray.r.start.x += source.x;
     ray.r.start.y += source.y;
 
+    // Step along the precomputed footprint rather than retracing it:
+    // that's cheaper, and it's the path the opacity checks above used.
+    const los_ray &path = min_cellrays(abs)[ray.cycle_idx].ray;
+    ray.set_path(&ray_coords[path.start], path.length, source,
+                 coord_def(signx, signy));
+
     return true;
 }
 
@@ -685,12 +793,10 @@ dungeon_feature_type ray_blocker(const coord_def& source,
 void fallback_ray(const coord_def& source, const coord_def& target,
                   ray_def& ray)
 {
-    ray.r.start.x = source.x + 0.5;
-    ray.r.start.y = source.y + 0.5;
-    coord_def diff = target - source;
-    ray.r.dir.x = diff.x;
-    ray.r.dir.y = diff.y;
-    ray.on_corner = false;
+    const int cycle_idx = ray.cycle_idx;
+    const coord_def diff = target - source;
+    ray = ray_def(geom::ray(source.x + 0.5, source.y + 0.5, diff.x, diff.y));
+    ray.cycle_idx = cycle_idx;
 }
 
 // Is p2 visible from p1, disregarding half-opaque objects?
@@ -735,12 +841,15 @@ bool cell_see_cell_nocache(const coord_def& p1, const coord_def& p2)
 
 static void _losight_quadrant(los_grid& sh, const los_param& dat, int sx, int sy)
 {
-    const unsigned int num_cellrays = cellray_ends.size();
+    // Cells beyond the radius only block rays that end beyond it,
+    // which we don't look at, so both loops stop there.
+    const int radius = max(0, min(dat.max_radius(), LOS_MAX_RANGE));
+    const unsigned int num_cellrays = n_rays_within[radius];
 
-    dead_rays->reset();
-    smoke_rays->reset();
+    dead_rays->reset(num_cellrays);
+    smoke_rays->reset(num_cellrays);
 
-    for (quadrant_iterator qi; qi; ++qi)
+    for (quadrant_iterator qi(radius); qi; ++qi)
     {
         coord_def p = coord_def(sx*(qi->x), sy*(qi->y));
         if (!dat.los_bounds(p))
@@ -750,12 +859,12 @@ static void _losight_quadrant(los_grid& sh, const los_param& dat, int sx, int sy
         {
         case OPC_OPAQUE:
             // Block the appropriate rays.
-            *dead_rays |= *blockrays(*qi);
+            dead_rays->or_with(*blockrays(*qi), num_cellrays);
             break;
         case OPC_HALF:
             // Block rays which have already seen a cloud.
-            *dead_rays  |= (*smoke_rays & *blockrays(*qi));
-            *smoke_rays |= *blockrays(*qi);
+            dead_rays->or_and(*smoke_rays, *blockrays(*qi), num_cellrays);
+            smoke_rays->or_with(*blockrays(*qi), num_cellrays);
             break;
         default:
             break;
@@ -764,17 +873,15 @@ static void _losight_quadrant(los_grid& sh, const los_param& dat, int sx, int sy
 
     // Ray calculation done. Now work out which cells in this
     // quadrant are visible.
-    for (unsigned int rayidx = 0; rayidx < num_cellrays; ++rayidx)
+    // Only the rays that are still alive matter: their end cells are visible.
+    for (unsigned int rayidx = dead_rays->next_unset(0, num_cellrays);
+         rayidx < num_cellrays;
+         rayidx = dead_rays->next_unset(rayidx + 1, num_cellrays))
     {
-        // make the cells seen by this ray at this point visible
-        if (!dead_rays->get(rayidx))
-        {
-            // This ray is alive, thus the end cell is visible.
-            const coord_def p = coord_def(sx * cellray_ends[rayidx].x,
-                                          sy * cellray_ends[rayidx].y);
-            if (dat.los_bounds(p))
-                sh(p) = true;
-        }
+        const coord_def p = coord_def(sx * cellray_ends[rayidx].x,
+                                      sy * cellray_ends[rayidx].y);
+        if (dat.los_bounds(p))
+            sh(p) = true;
     }
 }
 
@@ -795,6 +902,11 @@ struct los_param_funcs : public los_param
         return map_bounds(p + center) && bounds.contains(p);
     }
 
+    int max_radius() const override
+    {
+        return bounds.get_radius();
+    }
+
     opacity_type opacity(const coord_def& p) const override
     {
         return opc(p + center);
@@ -804,12 +916,18 @@ struct los_param_funcs : public los_param
 void losight(los_grid& sh, const coord_def& center,
              const opacity_func& opc, const circle_def& bounds)
 {
+    TURN_PHASE(TP_LOS);
     const los_param& dat = los_param_funcs(center, opc, bounds);
 
     sh.init(false);
 
     // Do precomputations if necessary.
     raycast();
+    if (!dead_rays)
+    {
+        dead_rays.reset(new bit_vector(cellray_ends.size()));
+        smoke_rays.reset(new bit_vector(cellray_ends.size()));
+    }
 
     const int quadrant_x[4] = {  1, -1, -1,  1 };
     const int quadrant_y[4] = {  1,  1, -1, -1 };
@@ -868,15 +986,24 @@ void los_monster_died(const monster* mon)
     }
 }
 
+static uint32_t terrain_generation = 0;
+
+uint32_t los_terrain_generation()
+{
+    return terrain_generation;
+}
+
 // Might want to pass new/old terrain.
 void los_terrain_changed(const coord_def& p)
 {
+    terrain_generation++;
     invalidate_los_around(p);
     _handle_los_change();
 }
 
 void los_changed()
 {
+    terrain_generation++;
     mons_reset_just_seen();
     invalidate_los();
     _handle_los_change();
@@ -28,6 +28,7 @@ bool find_ray(const coord_def& source, const coord_def& target,
 bool exists_ray(const coord_def& source, const coord_def& target,
                 const opacity_func &opc, int range = LOS_MAX_RANGE);
 dungeon_feature_type ray_blocker(const coord_def& source, const coord_def& target);
+void ray_cache_stats(unsigned int &hits, unsigned int &misses);
 
 void fallback_ray(const coord_def& source, const coord_def& target,
                   ray_def& ray);
@@ -37,6 +38,8 @@ bool cell_see_cell_nocache(const coord_def& p1, const coord_def& p2);
 typedef SquareArray<bool, LOS_MAX_RANGE> los_grid;
 
 void clear_rays_on_exit();
+// The memory held by the precomputed rays and the ray cache.
+size_t los_ray_bytes();
 void losight(los_grid& sh, const coord_def& center,
              const opacity_func &opc = opc_default,
              const circle_def &bds = BDS_DEFAULT);
@@ -45,4 +48,7 @@ void los_actor_moved(const actor* act, const coord_def& oldpos);
 void los_monster_died(const monster* mon);
 void los_terrain_changed(const coord_def& p);
 void los_changed();
+// Bumped by los_terrain_changed() and los_changed(), for caches of things
+// worked out from terrain.
+uint32_t los_terrain_generation();
 opacity_type mons_opacity(const monster* mon, los_type how);
@@ -3,9 +3,10 @@
 #include "losglobal.h"
 
 #include "coord.h"
-#include "coordit.h"
 #include "libutil.h"
 #include "los-def.h"
+#include "player.h"
+#include "tasks.h"
 
 #define LOS_KNOWN 4
 
@@ -13,9 +14,51 @@ typedef uint8_t losfield_t;
 typedef losfield_t halflos_t[LOS_MAX_RANGE+1][2*LOS_MAX_RANGE+1];
 static const int o_half_x = 0;
 static const int o_half_y = LOS_MAX_RANGE;
-typedef halflos_t globallos_t[GXM][GYM];
 
-static globallos_t globallos;
+// A table marked stale by invalidate_los_around() is cleared when next
+// looked at.
+struct halflos_table
+{
+    bool stale;
+    halflos_t los;
+};
+
+// Tables are only made for the cells LOS is actually looked up from, which
+// on most levels is a small part of the map, and all of them are let go of
+// by invalidate_los(), on entering a level among other times. They come in
+// blocks that stay where they are, since cell_see_cell() holds on to one
+// while filling in others; globallos holds 1 + the index of each cell's
+// table, or 0 if it has none.
+#define LOS_TABLE_BLOCK 256
+static uint16_t globallos[GXM][GYM];
+static vector<unique_ptr<halflos_table[]>> los_table_blocks;
+static int los_tables_used = 0;
+
+static uint16_t _new_los_table()
+{
+    COMPILE_CHECK(GXM * GYM < 65536);
+    if (los_tables_used % LOS_TABLE_BLOCK == 0)
+        los_table_blocks.emplace_back(new halflos_table[LOS_TABLE_BLOCK]());
+    return ++los_tables_used;
+}
+
+static halflos_table &_los_table(uint16_t index)
+{
+    return los_table_blocks[(index - 1) / LOS_TABLE_BLOCK]
+                           [(index - 1) % LOS_TABLE_BLOCK];
+}
+
+// Bumped by every change of opacity anywhere, for caches that can't afford
+// to care where.
+static uint32_t opacity_generation = 0;
+
+static void _flush_los_batch();
+
+uint32_t los_opacity_generation()
+{
+    _flush_los_batch();
+    return opacity_generation;
+}
 
 static losfield_t* _lookup_globallos(const coord_def& p, const coord_def& q)
 {
@@ -27,10 +70,22 @@ static losfield_t* _lookup_globallos(const coord_def& p, const coord_def& q)
     if (diff.rdist() > LOS_RADIUS)
         return nullptr;
     // p < q iff p.x < q.x || p.x == q.x && p.y < q.y
+    coord_def origin = p;
     if (diff < coord_def(0, 0))
-        return &globallos[q.x][q.y][-diff.x + o_half_x][-diff.y + o_half_y];
-    else
-        return &globallos[p.x][p.y][ diff.x + o_half_x][ diff.y + o_half_y];
+    {
+        origin = q;
+        diff = -diff;
+    }
+    uint16_t &index = globallos[origin.x][origin.y];
+    if (!index)
+        index = _new_los_table();
+    halflos_table &table = _los_table(index);
+    if (table.stale)
+    {
+        memset(table.los, 0, sizeof(table.los));
+        table.stale = false;
+    }
+    return &table.los[diff.x + o_half_x][diff.y + o_half_y];
 }
 
 static void _save_los(los_def* los, los_type l)
@@ -58,73 +113,292 @@ static void _save_los(los_def* los, los_type l)
         }
 }
 
-// Opacity at p has changed.
-void invalidate_los_around(const coord_def& p)
+static const opacity_func& _los_opacity(los_type l)
+{
+    switch (l)
+    {
+    case LOS_DEFAULT:
+        return opc_default;
+    case LOS_NO_TRANS:
+        return opc_no_trans;
+    case LOS_SOLID:
+        return opc_solid;
+    case LOS_SOLID_SEE:
+        return opc_solid_see;
+    default:
+        die("invalid opacity");
+    }
+}
+
+// The opacity of every cell for each los_type, two bits apiece, looked up
+// from the opacity_funcs on first use and forgotten whenever the LOS cache
+// is.  Working out LOS from many origins then costs an array lookup per cell
+// instead of a feature check, a cloud map search and a monster lookup.
+struct opacity_cell
+{
+    uint8_t known;     // los_types whose opacity is in opc
+    uint8_t opc;
+};
+static opacity_cell opacity_plane[GXM][GYM];
+
+static int _los_index(los_type l)
+{
+    switch (l)
+    {
+    case LOS_DEFAULT:   return 0;
+    case LOS_NO_TRANS:  return 1;
+    case LOS_SOLID:     return 2;
+    case LOS_SOLID_SEE: return 3;
+    default:
+        die("invalid opacity");
+    }
+}
+
+static opacity_type _plane_opacity(const coord_def& p, los_type l)
+{
+    COMPILE_CHECK(NUM_OPACITIES <= 4);
+    opacity_cell &cell = opacity_plane[p.x][p.y];
+    const int shift = 2 * _los_index(l);
+    if (!(cell.known & l))
+    {
+        cell.opc = (cell.opc & ~(3 << shift)) | _los_opacity(l)(p) << shift;
+        cell.known |= l;
+    }
+    return static_cast<opacity_type>(cell.opc >> shift & 3);
+}
+
+class opacity_plane_func : public opacity_func
+{
+public:
+    opacity_plane_func(los_type l) : los(l) {}
+
+    CLONE(opacity_plane_func)
+
+    opacity_type operator()(const coord_def& p) const override
+    {
+        return _plane_opacity(p, los);
+    }
+
+private:
+    los_type los;
+};
+
+// Opacity has changed somewhere in the rectangle from tl to br.
+static void _invalidate_los_in(const coord_def& tl, const coord_def& br)
 {
-    int x1 = max(p.x - LOS_MAX_RANGE, 0);
-    int y1 = max(p.y - LOS_MAX_RANGE, 0);
-    int x2 = min(p.x, GXM - 1);
-    int y2 = min(p.y + LOS_MAX_RANGE, GYM - 1);
+    opacity_generation++;
+
+    // Terrain is sometimes changed without telling us.  Forget the opacity
+    // of everything the LOS cleared below can reach, so that it comes out
+    // just as if it were computed from scratch.
+    const int r = 2 * LOS_MAX_RANGE;
+    const int py1 = max(tl.y - r, 0);
+    const int py2 = min(br.y + r, GYM - 1);
+    for (int x = max(tl.x - r, 0); x <= min(br.x + r, GXM - 1); x++)
+    {
+        memset(&opacity_plane[x][py1], 0,
+               (py2 - py1 + 1) * sizeof(opacity_cell));
+    }
+
+    int x1 = max(tl.x - LOS_MAX_RANGE, 0);
+    int y1 = max(tl.y - LOS_MAX_RANGE, 0);
+    int x2 = min(br.x, GXM - 1);
+    int y2 = min(br.y + LOS_MAX_RANGE, GYM - 1);
     for (int y = y1; y <= y2; y++)
         for (int x = x1; x <= x2; x++)
-            memset(globallos[x][y], 0, sizeof(halflos_t));
+            if (globallos[x][y])
+                _los_table(globallos[x][y]).stale = true;
 }
 
-void invalidate_los()
+// An open batch and the rectangle of changes it's holding back, if any.
+static int los_batch_depth = 0;
+static bool los_batch_pending = false;
+static coord_def los_batch_tl, los_batch_br;
+
+// A batch's rectangle grows no wider or taller than this; changes further
+// apart are invalidated separately, rather than everything in between.
+#define LOS_BATCH_SPAN LOS_MAX_RANGE
+
+static void _flush_los_batch()
 {
-    for (rectangle_iterator ri(0); ri; ++ri)
-        memset(globallos[ri->x][ri->y], 0, sizeof(halflos_t));
+    if (!los_batch_pending)
+        return;
+    los_batch_pending = false;
+    _invalidate_los_in(los_batch_tl, los_batch_br);
 }
 
-static void _update_globallos_at(const coord_def& p, los_type l)
+void los_batch_begin()
 {
-    switch (l)
+    los_batch_depth++;
+}
+
+void los_batch_end()
+{
+    ASSERT(los_batch_depth > 0);
+    if (!--los_batch_depth)
+        _flush_los_batch();
+}
+
+// Opacity at p has changed.
+void invalidate_los_around(const coord_def& p)
+{
+    if (!los_batch_depth)
     {
-    case LOS_DEFAULT:
-        {
-            los_def los(p, opc_default);
-            los.update();
-            _save_los(&los, l);
-            break;
-        }
-    case LOS_NO_TRANS:
-        {
-            los_def los(p, opc_no_trans);
-            los.update();
-            _save_los(&los, l);
-            break;
-        }
-    case LOS_SOLID:
+        _invalidate_los_in(p, p);
+        return;
+    }
+
+    if (los_batch_pending)
+    {
+        const coord_def tl(min(los_batch_tl.x, p.x), min(los_batch_tl.y, p.y));
+        const coord_def br(max(los_batch_br.x, p.x), max(los_batch_br.y, p.y));
+        if (br.x - tl.x <= LOS_BATCH_SPAN && br.y - tl.y <= LOS_BATCH_SPAN)
         {
-            los_def los(p, opc_solid);
-            los.update();
-            _save_los(&los, l);
-            break;
+            los_batch_tl = tl;
+            los_batch_br = br;
+            return;
         }
-    case LOS_SOLID_SEE:
+        _flush_los_batch();
+    }
+
+    los_batch_pending = true;
+    los_batch_tl = los_batch_br = p;
+}
+
+void invalidate_los()
+{
+    // Everything is forgotten anyway.
+    los_batch_pending = false;
+    opacity_generation++;
+    memset(opacity_plane, 0, sizeof(opacity_plane));
+    memset(globallos, 0, sizeof(globallos));
+    los_table_blocks.clear();
+    los_tables_used = 0;
+}
+
+size_t los_cache_bytes()
+{
+    return sizeof(globallos) + sizeof(opacity_plane)
+           + los_table_blocks.size() * LOS_TABLE_BLOCK
+             * sizeof(halflos_table);
+}
+
+size_t los_cache_full_bytes()
+{
+    return GXM * GYM * sizeof(halflos_table) + sizeof(opacity_plane);
+}
+
+static unsigned int los_miss_count = 0;
+
+unsigned int los_cache_misses()
+{
+    return los_miss_count;
+}
+
+static void _update_globallos_at(const coord_def& p, los_type l)
+{
+    los_miss_count++;
+    los_def los(p, opacity_plane_func(l));
+    los.update();
+    _save_los(&los, l);
+}
+
+// Below this many origins, starting tasks costs more than it saves.
+#define MIN_PARALLEL_LOS 16
+#define LOS_TASKS 4
+
+// Look up the opacity of every cell LOS from any of origins could reach, so
+// that working it out afterwards only reads opacity_plane.
+static void _fill_opacity_plane(const vector<coord_def>& origins, los_type l)
+{
+    coord_def tl(GXM, GYM), br(-1, -1);
+    for (const coord_def &p : origins)
+    {
+        tl.x = min(tl.x, p.x);
+        tl.y = min(tl.y, p.y);
+        br.x = max(br.x, p.x);
+        br.y = max(br.y, p.y);
+    }
+    for (int x = max(tl.x - LOS_MAX_RANGE, 0);
+         x <= min(br.x + LOS_MAX_RANGE, GXM - 1); x++)
+    {
+        for (int y = max(tl.y - LOS_MAX_RANGE, 0);
+             y <= min(br.y + LOS_MAX_RANGE, GYM - 1); y++)
         {
-            los_def los(p, opc_solid_see);
-            los.update();
-            _save_los(&los, l);
-            break;
+            _plane_opacity(coord_def(x, y), l);
         }
-    default:
-        die("invalid opacity");
     }
 }
 
+static void _update_los(los_def *from, los_def *to)
+{
+    for (los_def *los = from; los != to; ++los)
+        los->update();
+}
+
+void cache_los_from(const vector<coord_def>& origins, los_type l)
+{
+    _flush_los_batch();
+    vector<coord_def> todo;
+    for (const coord_def &p : origins)
+    {
+        const losfield_t* flags = _lookup_globallos(p, p);
+        if (flags && !(*flags & (l << LOS_KNOWN)))
+            todo.push_back(p);
+    }
+
+    if (todo.size() < MIN_PARALLEL_LOS)
+    {
+        for (const coord_def &p : todo)
+            _update_globallos_at(p, l);
+        return;
+    }
+
+    // Nothing changes the level while this runs, and once the opacities
+    // are in opacity_plane, LOS only reads that and the ray tables, so the
+    // origins can be split between tasks. The first is done here, which also
+    // makes sure the rays are precomputed before any task wants them. The
+    // results are saved in order, as they would have been one by one.
+    _fill_opacity_plane(todo, l);
+    vector<los_def> results;
+    results.reserve(todo.size());
+    for (const coord_def &p : todo)
+        results.emplace_back(p, opacity_plane_func(l));
+    results[0].update();
+
+    vector<task_ticket> tasks;
+    const size_t per_task = (todo.size() - 1 + LOS_TASKS - 1) / LOS_TASKS;
+    for (size_t first = 1; first < results.size(); first += per_task)
+    {
+        los_def *from = results.data() + first;
+        los_def *to = results.data() + min(first + per_task, results.size());
+        tasks.push_back(task_start([from, to] { _update_los(from, to); },
+                                   "los"));
+    }
+    for (task_ticket &task : tasks)
+        task.wait();
+
+    los_miss_count += results.size();
+    for (los_def &los : results)
+        _save_los(&los, l);
+}
+
 bool cell_see_cell(const coord_def& p, const coord_def& q, los_type l)
 {
     if (l == LOS_NONE)
         return true;
 
+    _flush_los_batch();
+
     losfield_t* flags = _lookup_globallos(p, q);
 
     if (!flags)
         return false; // outside range
 
+    // LOS is symmetric, so either end will do.  Prefer the player's, which
+    // is going to be needed for the display anyway.
     if (!(*flags & (l << LOS_KNOWN)))
-        _update_globallos_at(p, l);
+        _update_globallos_at(q == you.pos() ? q : p, l);
 
     ASSERT(*flags & (l << LOS_KNOWN));
     return *flags & l;
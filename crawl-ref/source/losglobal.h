@@ -5,4 +5,28 @@
 void invalidate_los_around(const coord_def& p);
 void invalidate_los();
 
+void los_batch_begin();
+void los_batch_end();
+
+// While one of these is in scope, invalidate_los_around() only notes where
+// opacity changed; nearby changes are then invalidated together, just before
+// anything next reads the LOS cache or when the last batch ends. What the
+// LOS cache answers is the same as without it.
+struct los_invalidation_batch
+{
+    los_invalidation_batch() { los_batch_begin(); }
+    ~los_invalidation_batch() { los_batch_end(); }
+};
+uint32_t los_opacity_generation();
+// How many times a cell's LOS has had to be computed, for profiling.
+unsigned int los_cache_misses();
+// The memory the LOS cache holds now, and would with every cell's in it.
+size_t los_cache_bytes();
+size_t los_cache_full_bytes();
+
+// Work out LOS from many points at once, ahead of cell_see_cell() needing
+// it. The level lookups are shared, and many points are split between
+// background tasks; the results are the same.
+void cache_los_from(const vector<coord_def>& origins, los_type l);
+
 bool cell_see_cell(const coord_def& p, const coord_def& q, los_type l);
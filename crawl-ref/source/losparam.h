@@ -174,5 +174,8 @@ public:
     // (including boundary) and within the LOS area
     virtual bool los_bounds(const coord_def& p) const = 0;
 
+    // No cell further than this (in rdist) from the centre is in bounds.
+    virtual int max_radius() const { return LOS_MAX_RANGE; }
+
     virtual opacity_type opacity(const coord_def& p) const = 0;
 };
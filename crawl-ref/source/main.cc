@@ -129,6 +129,7 @@
 #include "stringutil.h"
 #include "tags.h"
 #include "target.h"
+#include "tasks.h"
 #include "terrain.h"
 #include "throw.h"
 #ifdef USE_TILE
@@ -139,6 +140,7 @@
 #include "transform.h"
 #include "traps.h"
 #include "travel.h"
+#include "turn-times.h"
 #include "uncancel.h"
 #include "version.h"
 #include "viewchar.h"
@@ -152,6 +154,9 @@
 #include "wizard.h" // handle_wizard_command() and enter_explore_mode()
 #include "xom.h" // XOM_CLOUD_TRAIL_TYPE_KEY
 #include "zot.h"
+#ifdef USE_TILE_WEB
+#include "zygote.h"
+#endif
 
 // ----------------------------------------------------------------------
 // Globals whose construction/destruction order needs to be managed
@@ -248,6 +253,11 @@ int main(int argc, char *argv[])
         fprintf(stderr, "Webtiles require an UTF-8 locale.\n");
         exit(1);
     }
+
+    // Have a fork server run the game, if there is one; otherwise carry on
+    // and run it here.
+    if (argc >= 3 && !strcmp(argv[1], "-zygote-connect"))
+        zygote_connect(argc, argv);
 #endif
 #ifdef DEBUG_GLOBALS
     real_Options = new game_options();
@@ -293,6 +303,20 @@ int main(int argc, char *argv[])
     // make sure all the expected data directories exist
     validate_basedirs();
 
+#ifdef USE_TILE_WEB
+    if (!crawl_state.zygote_socket.empty())
+    {
+        // Returns only in a forked game, with that game's arguments.
+        zygote_serve(crawl_state.zygote_socket, argc, argv);
+        if (!parse_args(argc, argv, true))
+        {
+            _show_commandline_options_help();
+            return 1;
+        }
+        validate_basedirs();
+    }
+#endif
+
     {
         // Read the init file -- first pass. This pass ignores lua. It'll get
         // reread with lua on starting a game.
@@ -360,7 +384,7 @@ static void _reset_game()
     clear_level_target();
     overview_clear();
     clear_message_window();
-    note_list.clear();
+    clear_notes();
     msg::deinitialise_mpr_streams();
     quiver::reset_state();
 
@@ -560,6 +584,13 @@ static void _show_commandline_options_help()
 #endif
     // XX should this really be advertised outside of debug builds?
     puts("  -headless           force headless mode (no pty)");
+    puts("  -print-startup-times  time each phase of startup, on stderr");
+    puts("  -print-turn-times     time the phases of turns, on stderr at exit");
+#ifdef USE_TILE_WEB
+    puts("  -zygote <socket>    preload, then fork a game per request on <socket>");
+    puts("  -zygote-connect <socket> <args>  run the game given by <args> in the");
+    puts("                      -zygote server on <socket>, or here if there is none");
+#endif
     puts("  -script <name>      run script matching <name> in ./scripts");
 #ifdef DEBUG_STATISTICS
 #ifndef DEBUG_DIAGNOSTICS
@@ -573,6 +604,9 @@ static void _show_commandline_options_help()
     puts("  -dump-disconnect    In mapstat when a disconnected level is "
          "generated, dump");
     puts("      map to map.dump and exit");
+    puts("  -mapstat-parallel <num>  For -mapstat, split the iterations "
+         "between <num>");
+    puts("      worker processes and merge their stats");
     puts("  -objstat [<levels>] run monster and item stats on the given range "
          "of levels");
     puts("      Defaults to entire dungeon; same level syntax as -mapstat.");
@@ -780,6 +814,7 @@ static void _set_removed_types_as_identified()
     for (auto entry : removed_items)
         if (item_type_has_ids(entry.first))
             you.type_ids(entry) = true;
+    item_knowledge_changed();
 }
 
 // Set up the running variables for the current run.
@@ -1188,7 +1223,8 @@ static void _input()
                 mprf(MSGCH_ERROR, "Infinite lua loop detected, aborting.");
             else if (!crawl_state.lua_ready_throttled)
             {
-                if (!clua.callfn("ready", 0, 0) && !clua.error.empty())
+                static lua_hook ready("ready");
+                if (!ready.call(clua, 0) && !clua.error.empty())
                 {
                     // if ready() has been killed once, it is considered
                     // buggy and should not run again. Note: the sequencing is
@@ -1206,6 +1242,7 @@ static void _input()
 
                 }
             }
+            clua.gc_idle();
         }
 
 #ifdef WATCHDOG
@@ -1216,6 +1253,15 @@ static void _input()
         // Flush messages and display message window.
         msgwin_new_cmd();
 
+        // Nothing to do until the next command: get ahead on levelgen, and
+        // on anything else that was left for a quiet moment.
+        if (!has_pending_input() && !kbhit() && !you.running)
+        {
+            pregen_next_level();
+            abyss_sample_next_shift();
+            idle_tasks_run(IDLE_TASK_MS);
+        }
+
         crawl_state.waiting_for_command = true;
         c_input_reset(true);
 
@@ -2548,6 +2594,8 @@ static void _update_still_winds()
 
 void world_reacts()
 {
+    TURN_PHASE(TP_WORLD_REACTS);
+
     // All markers should be activated at this point.
     ASSERT(!env.markers.need_activate());
 
@@ -2687,6 +2735,8 @@ void world_reacts()
     // the loudest noise tracking for the next world_reacts cycle.
     you.los_noise_last_turn = you.los_noise_level;
     you.los_noise_level = 0;
+
+    flush_milestones();
 }
 
 static command_type _get_next_cmd()
@@ -2696,10 +2746,10 @@ static command_type _get_next_cmd()
 #endif
 
 #ifdef DEBUG_ITEM_SCAN
-    debug_item_scan();
+    debug_item_scan_changes();
 #endif
 #ifdef DEBUG_MONS_SCAN
-    debug_mons_scan();
+    debug_mons_scan_changes();
 #endif
 
     _center_cursor();
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <utility>
+
 #include "enum.h"
 #include "mon-info.h"
 #include "tag-version.h"
@@ -54,6 +56,24 @@ struct cloud_info
     killer_type killer;
 };
 
+// The item, monster and cloud details of a map_cell, shared between its
+// copies: env.map_knowledge gets copied wholesale (webtiles keeps the map
+// it last sent, and levels are copied on transitions), and most of these
+// never change afterwards. A map_cell only ever replaces its details, or
+// copies them first if they are shared (see the mutable_ accessors).
+template<typename T>
+struct map_cell_detail
+{
+    // Builds the value in place from whatever T is built from, so that a
+    // monster_info (say) needn't be built and then copied in.
+    template<typename... Args>
+    explicit map_cell_detail(Args&&... args)
+        : refs(1), value(std::forward<Args>(args)...) { }
+
+    int refs;
+    T value;
+};
+
 /*
  * A map_cell stores what the player knows about a cell.
  * These go in env.map_knowledge.
@@ -68,41 +88,29 @@ struct map_cell
     map_cell(const map_cell& c)
     {
         memcpy(this, &c, sizeof(map_cell));
-        if (_cloud)
-            _cloud = new cloud_info(*_cloud);
-        if (_mons)
-            _mons = new monster_info(*_mons);
-        if (_item)
-            _item = new item_def(*_item);
+        _share(_cloud);
+        _share(_mons);
+        _share(_item);
     }
 
     ~map_cell()
     {
-        if (_cloud)
-            delete _cloud;
-        if (!(flags & MAP_DETECTED_MONSTER) && _mons)
-            delete _mons;
-        if (_item)
-            delete _item;
+        _release(_cloud);
+        _release(_mons);
+        _release(_item);
     }
 
     map_cell& operator=(const map_cell& c)
     {
         if (&c == this)
             return *this;
-        if (_cloud)
-            delete _cloud;
-        if (_mons)
-            delete _mons;
-        if (_item)
-            delete _item;
+        _share(c._cloud);
+        _share(c._mons);
+        _share(c._item);
+        _release(_cloud);
+        _release(_mons);
+        _release(_item);
         memcpy(this, &c, sizeof(map_cell));
-        if (_cloud)
-            _cloud = new cloud_info(*_cloud);
-        if (_mons)
-            _mons = new monster_info(*_mons);
-        if (_item)
-            _item = new item_def(*_item);
         return *this;
     }
 
@@ -151,9 +159,14 @@ struct map_cell
         _trap = tr;
     }
 
-    item_def* item() const
+    const item_def* item() const
     {
-        return _item;
+        return _item ? &_item->value : nullptr;
+    }
+
+    item_def* mutable_item()
+    {
+        return _unshare(_item);
     }
 
     bool detected_item() const
@@ -171,7 +184,7 @@ struct map_cell
     void set_item(const item_def& ii, bool more_items)
     {
         clear_item();
-        _item = new item_def(ii);
+        _item = new map_cell_detail<item_def>(ii);
         if (more_items)
             flags |= MAP_MORE_ITEMS;
     }
@@ -180,31 +193,39 @@ struct map_cell
 
     void clear_item()
     {
-        if (_item)
-        {
-            delete _item;
-            _item = 0;
-        }
+        _release(_item);
         flags &= ~(MAP_DETECTED_ITEM | MAP_MORE_ITEMS);
     }
 
     monster_type monster() const
     {
         if (_mons)
-            return _mons->type;
+            return _mons->value.type;
         else
             return MONS_NO_MONSTER;
     }
 
-    monster_info* monsterinfo() const
+    const monster_info* monsterinfo() const
     {
-        return _mons;
+        return _mons ? &_mons->value : nullptr;
+    }
+
+    monster_info* mutable_monsterinfo()
+    {
+        return _unshare(_mons);
     }
 
     void set_monster(const monster_info& mi)
     {
         clear_monster();
-        _mons = new monster_info(mi);
+        _mons = new map_cell_detail<monster_info>(mi);
+    }
+
+    // As set_monster(monster_info(mons)), without the copy.
+    void set_monster(const class monster* mons)
+    {
+        clear_monster();
+        _mons = new map_cell_detail<monster_info>(mons);
     }
 
     bool detected_monster() const
@@ -220,8 +241,9 @@ struct map_cell
     void set_detected_monster(monster_type mons)
     {
         clear_monster();
-        _mons = new monster_info(MONS_SENSED);
-        _mons->base_type = mons;
+        monster_info mi(MONS_SENSED);
+        mi.base_type = mons;
+        _mons = new map_cell_detail<monster_info>(mi);
         flags |= MAP_DETECTED_MONSTER;
     }
 
@@ -233,16 +255,14 @@ struct map_cell
 
     void clear_monster()
     {
-        if (_mons)
-            delete _mons;
+        _release(_mons);
         flags &= ~(MAP_DETECTED_MONSTER | MAP_INVISIBLE_MONSTER);
-        _mons = 0;
     }
 
     cloud_type cloud() const
     {
         if (_cloud)
-            return _cloud->type;
+            return _cloud->value.type;
         else
             return CLOUD_NONE;
     }
@@ -250,30 +270,30 @@ struct map_cell
     unsigned cloud_colour() const
     {
         if (_cloud)
-            return _cloud->colour;
+            return _cloud->value.colour;
         else
             return 0;
     }
 
-    cloud_info* cloudinfo() const
+    const cloud_info* cloudinfo() const
+    {
+        return _cloud ? &_cloud->value : nullptr;
+    }
+
+    cloud_info* mutable_cloudinfo()
     {
-        return _cloud;
+        return _unshare(_cloud);
     }
 
     void set_cloud(const cloud_info& ci)
     {
-        if (_cloud)
-            delete _cloud;
-        _cloud = new cloud_info(ci);
+        _release(_cloud);
+        _cloud = new map_cell_detail<cloud_info>(ci);
     }
 
     void clear_cloud()
     {
-        if (_cloud)
-        {
-            delete _cloud;
-            _cloud = 0;
-        }
+        _release(_cloud);
     }
 
     bool update_cloud_state();
@@ -314,7 +334,36 @@ private:
     dungeon_feature_type _feat:8;
     colour_t _feat_colour;
     trap_type _trap:8;
-    cloud_info* _cloud;
-    item_def* _item;
-    monster_info* _mons;
+    map_cell_detail<cloud_info>* _cloud;
+    map_cell_detail<item_def>* _item;
+    map_cell_detail<monster_info>* _mons;
+
+    template<typename T>
+    static void _share(map_cell_detail<T> *detail)
+    {
+        if (detail)
+            detail->refs++;
+    }
+
+    template<typename T>
+    static void _release(map_cell_detail<T> *&detail)
+    {
+        if (detail && !--detail->refs)
+            delete detail;
+        detail = nullptr;
+    }
+
+    // Make our own copy of a shared detail, so that it can be changed.
+    template<typename T>
+    static T *_unshare(map_cell_detail<T> *&detail)
+    {
+        if (!detail)
+            return nullptr;
+        if (detail->refs > 1)
+        {
+            detail->refs--;
+            detail = new map_cell_detail<T>(detail->value);
+        }
+        return &detail->value;
+    }
 };
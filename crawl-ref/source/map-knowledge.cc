@@ -18,16 +18,54 @@
 #include "travel.h"
 #include "view.h"
 
+#ifdef USE_TILE
+// Nesting depth of map_knowledge_batch, and the cells it has yet to update.
+static int _batch_depth = 0;
+static FixedBitArray<GXM, GYM> _batch_minimap;
+#endif
+
+map_knowledge_batch::map_knowledge_batch()
+{
+#ifdef USE_TILE
+    _batch_depth++;
+#endif
+}
+
+map_knowledge_batch::~map_knowledge_batch()
+{
+#ifdef USE_TILE
+    if (--_batch_depth)
+        return;
+
+    for (rectangle_iterator ri(0); ri; ++ri)
+        if (_batch_minimap(*ri))
+            tiles.update_minimap(*ri);
+    _batch_minimap.reset();
+#endif
+}
+
+#ifdef USE_TILE
+// Knowledge of gc may have changed the explore horizon, so update adjacent
+// minimap squares as well.
+static void _update_minimap_around(const coord_def gc)
+{
+    for (adjacent_iterator ai(gc, false); ai; ++ai)
+    {
+        if (!_batch_depth)
+            tiles.update_minimap(*ai);
+        else if (map_bounds(*ai))
+            _batch_minimap.set(*ai);
+    }
+}
+#endif
+
 void set_terrain_mapped(const coord_def gc)
 {
     map_cell* cell = &env.map_knowledge(gc);
     cell->flags &= (~MAP_CHANGED_FLAG);
     cell->flags |= MAP_MAGIC_MAPPED_FLAG;
 #ifdef USE_TILE
-    // This may have changed the explore horizon, so update adjacent minimap
-    // squares as well.
-    for (adjacent_iterator ai(gc, false); ai; ++ai)
-        tiles.update_minimap(*ai);
+    _update_minimap_around(gc);
 #endif
 }
 
@@ -137,10 +175,7 @@ void set_terrain_seen(const coord_def pos)
     cell->flags |= MAP_SEEN_FLAG;
 
 #ifdef USE_TILE
-    // This may have changed the explore horizon, so update adjacent minimap
-    // squares as well.
-    for (adjacent_iterator ai(pos, false); ai; ++ai)
-        tiles.update_minimap(*ai);
+    _update_minimap_around(pos);
 #endif
 }
 
@@ -167,9 +202,10 @@ void map_cell::set_detected_item()
 {
     clear_item();
     flags |= MAP_DETECTED_ITEM;
-    _item = new item_def();
-    _item->base_type = OBJ_DETECTED;
-    _item->rnd       = 1;
+    item_def item;
+    item.base_type = OBJ_DETECTED;
+    item.rnd       = 1;
+    _item = new map_cell_detail<item_def>(item);
 }
 
 static bool _floor_mf(map_feature mf)
@@ -304,8 +340,8 @@ bool map_cell::update_cloud_state()
         return false; // we're already up-to-date
 
     // player non-opaque clouds vanish instantly out of los
-    if (_cloud && _cloud->killer == KILL_YOU_MISSILE
-        && !is_opaque_cloud(_cloud->type))
+    if (_cloud && _cloud->value.killer == KILL_YOU_MISSILE
+        && !is_opaque_cloud(_cloud->value.type))
     {
         clear_cloud();
         return true;
@@ -8,6 +8,21 @@
 void set_terrain_mapped(const coord_def c);
 void set_terrain_seen(const coord_def c);
 
+/**
+ * @brief Batch the display updates of a bulk change of map knowledge.
+ *
+ * set_terrain_mapped() and set_terrain_seen() update the minimap around
+ * each cell they touch, so mapping a whole level updates every cell nine
+ * times over. While one of these is in scope, those updates are collected
+ * instead, and each cell is updated once when it goes out of scope.
+ */
+class map_knowledge_batch
+{
+public:
+    map_knowledge_batch();
+    ~map_knowledge_batch();
+};
+
 void set_terrain_visible(const coord_def c);
 void clear_terrain_visibility();
 
@@ -20,6 +20,7 @@
 #include "cluautil.h"
 #include "colour.h"
 #include "coordit.h"
+#include "dbg-maps.h"
 #include "describe.h"
 #include "dgn-height.h"
 #include "dungeon.h"
@@ -28,6 +29,7 @@
 #include "tile-env.h"
 #include "english.h"
 #include "files.h"
+#include "flood-find.h"
 #include "initfile.h"
 #include "item-prop.h"
 #include "item-status-flag-type.h"
@@ -1175,9 +1177,10 @@ void map_lines::clear()
 
 void map_lines::subst(string &s, subst_spec &spec)
 {
-    string::size_type pos = 0;
-    while ((pos = s.find_first_of(spec.key, pos)) != string::npos)
-        s[pos++] = spec.value();
+    const glyph_set keys(spec.key);
+    for (char &c : s)
+        if (keys(c))
+            c = spec.value();
 }
 
 void map_lines::subst(subst_spec &spec)
@@ -1226,12 +1229,13 @@ void map_lines::fill_mask_matrix(const string &glyphs,
     ASSERT(tl.x <= br.x);
     ASSERT(tl.y <= br.y);
 
+    const glyph_set masked(glyphs);
     for (int y = tl.y; y <= br.y; ++y)
         for (int x = tl.x; x <= br.x; ++x)
         {
             int ox = x - tl.x;
             int oy = y - tl.y;
-            flags(ox, oy) = (strchr(glyphs.c_str(), (*this)(x, y)) != nullptr);
+            flags(ox, oy) = masked((*this)(x, y));
         }
 }
 
@@ -1537,28 +1541,26 @@ void map_lines::resolve_shuffle(const string &shufflage)
     if (toshuffle.empty() || shuffled.empty())
         return;
 
+    // What each glyph becomes; the first place a glyph is shuffled from
+    // wins, as with find().
+    char to[256];
+    for (int i = 0; i < 256; ++i)
+        to[i] = static_cast<char>(i);
+    for (int i = toshuffle.length() - 1; i >= 0; --i)
+        to[static_cast<unsigned char>(toshuffle[i])] = shuffled[i];
+
     for (string &s : lines)
-    {
         for (char &c : s)
-        {
-            string::size_type pos = toshuffle.find(c);
-            if (pos != string::npos)
-                c = shuffled[pos];
-        }
-    }
+            c = to[static_cast<unsigned char>(c)];
 }
 
 void map_lines::clear(const string &clearchars)
 {
+    const glyph_set cleared(clearchars);
     for (string &s : lines)
-    {
         for (char &c : s)
-        {
-            string::size_type pos = clearchars.find(c);
-            if (pos != string::npos)
+            if (cleared(c))
                 c = ' ';
-        }
-    }
 }
 
 void map_lines::normalise(char fillch)
@@ -1572,8 +1574,6 @@ void map_lines::normalise(char fillch)
 // of the dimensions is greater than the lesser of GXM,GYM.
 void map_lines::rotate(bool clockwise)
 {
-    vector<string> newlines;
-
     // normalise() first for convenience.
     normalise();
 
@@ -1585,14 +1585,12 @@ void map_lines::rotate(bool clockwise)
               ye = clockwise? -1 : (int) lines.size(),
               yi = clockwise? -1 : 1;
 
-    for (int i = xs; i != xe; i += xi)
+    vector<string> newlines(map_width, string(lines.size(), ' '));
+    for (int i = xs, y = 0; i != xe; i += xi, ++y)
     {
-        string line;
-
-        for (int j = ys; j != ye; j += yi)
-            line += lines[j][i];
-
-        newlines.push_back(line);
+        string &line = newlines[y];
+        for (int j = ys, x = 0; j != ye; j += yi, ++x)
+            line[x] = lines[j][i];
     }
 
     if (overlay)
@@ -1600,12 +1598,12 @@ void map_lines::rotate(bool clockwise)
         auto new_overlay = make_unique<overlay_matrix>(lines.size(), map_width);
         for (int i = xs, y = 0; i != xe; i += xi, ++y)
             for (int j = ys, x = 0; j != ye; j += yi, ++x)
-                (*new_overlay)(x, y) = (*overlay)(i, j);
+                (*new_overlay)(x, y) = std::move((*overlay)(i, j));
         overlay = std::move(new_overlay);
     }
 
     map_width = lines.size();
-    lines     = newlines;
+    lines.swap(newlines);
     rotate_markers(clockwise);
     solid_checked = false;
 }
@@ -1658,11 +1656,7 @@ void map_lines::vmirror()
     const int midpoint = vsize / 2;
 
     for (int i = 0; i < midpoint; ++i)
-    {
-        string temp = lines[i];
-        lines[i] = lines[vsize - 1 - i];
-        lines[vsize - 1 - i] = temp;
-    }
+        lines[i].swap(lines[vsize - 1 - i]);
 
     if (overlay)
     {
@@ -1903,56 +1897,39 @@ bool map_lines::find_bounds(const char *str, coord_def &tl, coord_def &br) const
 
 bool map_lines::fill_zone(travel_distance_grid_t &tpd, const coord_def &start,
                           const coord_def &tl, const coord_def &br, int zone,
-                          const char *wanted, const char *passable) const
+                          const char *wanted, const char *passable,
+                          vector<coord_def> *zone_points) const
 {
     // This is the map_lines equivalent of _dgn_fill_zone.
     // It's unfortunately extremely similar, but not close enough to combine.
 
     bool ret = false;
-    list<coord_def> points[2];
-    int cur = 0;
-
-    for (points[cur].push_back(start); !points[cur].empty();)
-    {
-        for (const auto &c : points[cur])
+    flood_fill(start,
+        [&](const coord_def &cp)
+        {
+            return cp.x >= tl.x && cp.x <= br.x
+                && cp.y >= tl.y && cp.y <= br.y
+                && in_bounds(cp) && !tpd[cp.x][cp.y]
+                && (!passable || strchr(passable, (*this)(cp)));
+        },
+        [&](const coord_def &c)
         {
             tpd[c.x][c.y] = zone;
-
             ret |= (wanted && strchr(wanted, (*this)(c)) != nullptr);
-
-            for (int yi = -1; yi <= 1; ++yi)
-                for (int xi = -1; xi <= 1; ++xi)
-                {
-                    if (!xi && !yi)
-                        continue;
-
-                    const coord_def cp(c.x + xi, c.y + yi);
-                    if (cp.x < tl.x || cp.x > br.x
-                        || cp.y < tl.y || cp.y > br.y
-                        || !in_bounds(cp) || tpd[cp.x][cp.y]
-                        || passable && !strchr(passable, (*this)(cp)))
-                    {
-                        continue;
-                    }
-
-                    tpd[cp.x][cp.y] = zone;
-                    points[!cur].push_back(cp);
-                }
-        }
-
-        points[cur].clear();
-        cur = !cur;
-    }
+            if (zone_points)
+                zone_points->push_back(c);
+        });
     return ret;
 }
 
 int map_lines::count_feature_in_box(const coord_def &tl, const coord_def &br,
                                     const char *feat) const
 {
+    const glyph_set feats(feat);
     int result = 0;
     for (rectangle_iterator ri(tl, br); ri; ++ri)
     {
-        if (strchr(feat, (*this)(*ri)))
+        if (feats((*this)(*ri)))
             result++;
     }
 
@@ -2422,6 +2399,17 @@ void map_def::read_full(reader& inf)
     epilogue.read(inf);
 }
 
+// Store the Lua chunks as bytecode, for the des cache.
+void map_def::compile_lua()
+{
+    prelude.compile(dlua);
+    mapchunk.compile(dlua);
+    main.compile(dlua);
+    validate.compile(dlua);
+    veto.compile(dlua);
+    epilogue.compile(dlua);
+}
+
 int map_def::weight(const level_id &lid) const
 {
     return _weight.depth_value(lid);
@@ -2580,6 +2568,9 @@ void map_def::set_file(const string &s)
 string map_def::run_lua(bool run_main)
 {
     dlua_set_map mset(this);
+#ifdef DEBUG_STATISTICS
+    mapstat_map_timer timer(*this, true);
+#endif
 
     int err = prelude.load(dlua);
     if (err == E_CHUNK_LOAD_FAILURE)
@@ -2670,6 +2661,9 @@ bool map_def::test_lua_boolchunk(dlua_chunk &chunk, bool defval,
 {
     bool result = defval;
     dlua_set_map mset(this);
+#ifdef DEBUG_STATISTICS
+    mapstat_map_timer timer(*this, true);
+#endif
 
     int err = chunk.load(dlua);
     if (err == E_CHUNK_LOAD_FAILURE)
@@ -3523,10 +3517,11 @@ string map_def::apply_subvault(string_spec &spec)
         if (!orig)
             return make_stringf("No vault found for tag '%s'", tag.c_str());
 
+        // Load the body into vdefs, as _write_vault() does, so that
+        // later tries copy it instead of reading the .dsc again.
+        const_cast<map_def *>(orig)->load();
         map_def vault = *orig;
 
-        vault.load();
-
         // Temporarily set the subvault mask so this subvault can know
         // that it is being generated as a subvault.
         vault.svmask = &flags;
@@ -147,6 +147,27 @@ typedef vector<glyph_weighted_replacement_t> glyph_replacements_t;
 
 class map_lines;
 
+// A set of glyphs, to test map cells against with a table lookup rather
+// than a strchr() of the glyph string each time.
+class glyph_set
+{
+public:
+    explicit glyph_set(const char *glyphs) : members()
+    {
+        for (; *glyphs; ++glyphs)
+            members[static_cast<unsigned char>(*glyphs)] = true;
+    }
+    explicit glyph_set(const string &glyphs) : glyph_set(glyphs.c_str()) { }
+
+    bool operator()(char c) const
+    {
+        return members[static_cast<unsigned char>(c)];
+    }
+
+private:
+    bool members[256];
+};
+
 class subst_spec
 {
 public:
@@ -422,6 +443,11 @@ public:
 
     const keyed_mapspec *mapspec_at(const coord_def &c) const;
     keyed_mapspec *mapspec_at(const coord_def &c);
+    // Whether mapspec_at() is the same for every cell with this glyph.
+    static bool glyph_has_one_mapspec(int glyph)
+    {
+        return glyph != SUBVAULT_GLYPH;
+    }
 
     string add_key_item(const string &s);
     string add_key_mons(const string &s);
@@ -433,9 +459,12 @@ public:
     // Extend map dimensions with glyph 'fill' to minimum width and height.
     void extend(int min_width, int min_height, char fill);
 
+    // Marks the zone connected to start in tpd, optionally listing its
+    // squares in zone_points; returns whether it contains a wanted glyph.
     bool fill_zone(travel_distance_grid_t &tpd, const coord_def &start,
                    const coord_def &tl, const coord_def &br, int zone,
-                   const char *wanted, const char *passable) const;
+                   const char *wanted, const char *passable,
+                   vector<coord_def> *zone_points = nullptr) const;
 
     int count_feature_in_box(const coord_def &tl, const coord_def &br,
                              const char *feat) const;
@@ -1209,6 +1238,7 @@ public:
     void read_index(reader&);
     void read_full(reader&);
     void read_maplines(reader&);
+    void compile_lua();
 
     void set_file(const string &s);
     string run_lua(bool skip_main);
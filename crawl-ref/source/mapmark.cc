@@ -1076,22 +1076,35 @@ void map_markers::activate_markers_at(coord_def p)
 void map_markers::add(map_marker *marker)
 {
     markers.insert(dgn_pos_marker(marker->pos, marker));
+    markers_by_type[marker->get_type()].insert(
+        dgn_pos_marker(marker->pos, marker));
     have_inactive_markers = true;
 }
 
-void map_markers::unlink_marker(const map_marker *marker)
+void map_markers::erase_entry(dgn_marker_map &map, const map_marker *marker)
 {
-    auto els = markers.equal_range(marker->pos);
+    auto els = map.equal_range(marker->pos);
     for (auto i = els.first; i != els.second; ++i)
     {
         if (i->second == marker)
         {
-            markers.erase(i);
+            map.erase(i);
             break;
         }
     }
 }
 
+void map_markers::unlink_marker(const map_marker *marker)
+{
+    erase_entry(markers, marker);
+    erase_entry(markers_by_type[marker->get_type()], marker);
+}
+
+bool map_markers::has_properties(map_marker_type type)
+{
+    return type == MAT_LUA_MARKER || type == MAT_WIZ_PROPS;
+}
+
 void map_markers::check_empty()
 {
     if (markers.empty())
@@ -1114,8 +1127,10 @@ void map_markers::remove_markers_at(const coord_def &c,
         auto todel = i++;
         if (type == MAT_ANY || todel->second->get_type() == type)
         {
-            delete todel->second;
+            map_marker *marker = todel->second;
+            erase_entry(markers_by_type[marker->get_type()], marker);
             markers.erase(todel);
+            delete marker;
         }
     }
     check_empty();
@@ -1123,20 +1138,17 @@ void map_markers::remove_markers_at(const coord_def &c,
 
 map_marker *map_markers::find(const coord_def &c, map_marker_type type)
 {
-    auto els = markers.equal_range(c);
-    for (auto i = els.first; i != els.second; ++i)
-        if (type == MAT_ANY || i->second->get_type() == type)
-            return i->second;
-    return nullptr;
+    const dgn_marker_map &from = type == MAT_ANY ? markers
+                                                 : markers_by_type[type];
+    auto i = from.lower_bound(c);
+    return i == from.end() || i->first != c ? nullptr : i->second;
 }
 
 map_marker *map_markers::find(map_marker_type type)
 {
-    for (const auto &entry : markers)
-        if (type == MAT_ANY || entry.second->get_type() == type)
-            return entry.second;
-
-    return nullptr;
+    const dgn_marker_map &from = type == MAT_ANY ? markers
+                                                 : markers_by_type[type];
+    return from.empty() ? nullptr : from.begin()->second;
 }
 
 void map_markers::move(const coord_def &from, const coord_def &to)
@@ -1149,6 +1161,7 @@ void map_markers::move(const coord_def &from, const coord_def &to)
     {
         auto curr = i++;
         tmarkers.push_back(curr->second);
+        erase_entry(markers_by_type[curr->second->get_type()], curr->second);
         markers.erase(curr);
     }
 
@@ -1169,12 +1182,12 @@ void map_markers::move_marker(map_marker *marker, const coord_def &to)
 
 vector<map_marker*> map_markers::get_all(map_marker_type mat)
 {
+    const dgn_marker_map &from = mat == MAT_ANY ? markers
+                                                : markers_by_type[mat];
     vector<map_marker*> rmarkers;
-    for (const auto &entry : markers)
-    {
-        if (mat == MAT_ANY || entry.second->get_type() == mat)
-            rmarkers.push_back(entry.second);
-    }
+    rmarkers.reserve(from.size());
+    for (const auto &entry : from)
+        rmarkers.push_back(entry.second);
     return rmarkers;
 }
 
@@ -1185,6 +1198,8 @@ vector<map_marker*> map_markers::get_all(const string &key, const string &val)
     for (const auto &entry : markers)
     {
         map_marker*  marker = entry.second;
+        if (!has_properties(marker->get_type()))
+            continue;
         const string prop   = marker->property(key);
 
         if (val.empty() && !prop.empty() || !val.empty() && val == prop)
@@ -1221,11 +1236,36 @@ string map_markers::property_at(const coord_def &c, map_marker_type type,
     return "";
 }
 
+/**
+ * Where the markers that can have properties are.
+ *
+ * @return The squares, in the order a rectangle_iterator over the level
+ *         would visit them.
+ */
+vector<coord_def> map_markers::property_positions() const
+{
+    vector<coord_def> positions;
+    for (map_marker_type type : { MAT_LUA_MARKER, MAT_WIZ_PROPS })
+        for (const auto &entry : markers_by_type[type])
+            positions.push_back(entry.first);
+
+    sort(positions.begin(), positions.end(),
+         [](const coord_def &a, const coord_def &b)
+         {
+             return a.y < b.y || a.y == b.y && a.x < b.x;
+         });
+    positions.erase(unique(positions.begin(), positions.end()),
+                    positions.end());
+    return positions;
+}
+
 void map_markers::clear()
 {
     for (auto &entry : markers)
         delete entry.second;
     markers.clear();
+    for (auto &typed : markers_by_type)
+        typed.clear();
     check_empty();
 }
 
@@ -1293,12 +1333,12 @@ vector<coord_def> find_marker_positions_by_prop(const string &prop,
                                                 unsigned maxresults)
 {
     vector<coord_def> marker_positions;
-    for (rectangle_iterator i(0, 0); i; ++i)
+    for (const coord_def &pos : env.markers.property_positions())
     {
-        const string value = env.markers.property_at(*i, MAT_ANY, prop);
+        const string value = env.markers.property_at(pos, MAT_ANY, prop);
         if (!value.empty() && (expected.empty() || value == expected))
         {
-            marker_positions.push_back(*i);
+            marker_positions.push_back(pos);
             if (maxresults && marker_positions.size() >= maxresults)
                 return marker_positions;
         }
@@ -1311,9 +1351,9 @@ vector<map_marker*> find_markers_by_prop(const string &prop,
                                          unsigned maxresults)
 {
     vector<map_marker*> markers;
-    for (rectangle_iterator pos(0, 0); pos; ++pos)
+    for (const coord_def &pos : env.markers.property_positions())
     {
-        for (map_marker *mark : env.markers.get_markers_at(*pos))
+        for (map_marker *mark : env.markers.get_markers_at(pos))
         {
             const string value(mark->property(prop));
             if (!value.empty() && (expected.empty() || value == expected))
@@ -62,6 +62,8 @@ public:
     virtual void write(writer &) const;
     virtual void read(reader &);
     virtual string debug_describe() const = 0;
+    // Only Lua and wizard property markers have properties; see
+    // map_markers::has_properties() if another type gains them.
     virtual string property(const string &pname) const;
 
     static map_marker *read_marker(reader &);
@@ -369,6 +371,7 @@ public:
     string property_at(const coord_def &c, map_marker_type type,
                        const char *key)
     { return property_at(c, type, string(key)); }
+    vector<coord_def> property_positions() const;
     void clear();
 
     void write(writer &) const;
@@ -381,9 +384,14 @@ private:
     void init_from(const map_markers &);
     void unlink_marker(const map_marker *);
     void check_empty();
+    static bool has_properties(map_marker_type type);
+    static void erase_entry(dgn_marker_map &map, const map_marker *marker);
 
 private:
     dgn_marker_map markers;
+    // The same markers again, split up by type, and each in the same order
+    // as in markers; so that looking for one type doesn't go through all.
+    dgn_marker_map markers_by_type[NUM_MAP_MARKER_TYPES];
     bool have_inactive_markers;
 };
 
@@ -10,6 +10,8 @@
 #include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <unordered_map>
 #include <sys/param.h>
 #include <sys/types.h>
 #if defined(UNIX) || defined(TARGET_COMPILER_MINGW)
@@ -26,6 +28,7 @@
 #include "files.h"
 #include "mapmark.h"
 #include "message.h"
+#include "place.h"
 #include "state.h"
 #include "stringutil.h"
 #include "syscalls.h"
@@ -66,7 +69,12 @@ point_vector map_anchor_points;
 //////////////////////////////////////////////////////////////////////////
 // New style vault definitions
 
-static map_vector vdefs;
+// A deque, so that the maps read late (see _load_deferred_maps()) don't
+// move the ones already handed out.
+static deque<map_def> vdefs;
+
+static bool _have_deferred_maps();
+static void _load_deferred_maps();
 
 // Parameter array that vault code can use.
 string_vector map_parameters;
@@ -107,6 +115,7 @@ map_section_type vault_main(vault_placement &place, const map_def *vault,
 #ifdef DEBUG_STATISTICS
     if (crawl_state.map_stat_gen)
         mapstat_report_map_try(*vault);
+    mapstat_map_timer timer(*vault, false);
 #endif
 
     // Return value of MAP_NONE forces dungeon.cc to regenerate the
@@ -740,6 +749,11 @@ const map_def *find_map_by_name(const string &name)
         if (mapdef.name == name)
             return &mapdef;
 
+    if (_have_deferred_maps())
+    {
+        _load_deferred_maps();
+        return find_map_by_name(name);
+    }
     return nullptr;
 }
 
@@ -753,6 +767,7 @@ void strip_all_maps()
 
 vector<string> find_map_matches(const string &name)
 {
+    _load_deferred_maps();
     vector<string> matches;
 
     for (const map_def &mapdef : vdefs)
@@ -761,6 +776,85 @@ vector<string> find_map_matches(const string &name)
     return matches;
 }
 
+typedef vector<unsigned> vault_indices;
+
+// Candidate lists for map selection, so that a query only has to look at
+// maps that could possibly match it: by tag, and, filled in as levels are
+// asked about, by the levels a map's DEPTH or PLACE allows. The level lists
+// depend on the branch layout too, so they remember the depths they were
+// made for. Every list is in vdefs order, so selection is unchanged.
+// Anything that changes vdefs calls _invalidate_map_index().
+struct level_map_index
+{
+    int absdepth;
+    int brdepth;
+    vault_indices by_depth;
+    vault_indices by_place;
+};
+
+static unordered_map<string, vault_indices> _maps_by_tag;
+static bool _maps_by_tag_built = false;
+static map<level_id, level_map_index> _maps_by_level;
+static const vault_indices _no_maps;
+
+static void _invalidate_map_index()
+{
+    _maps_by_tag.clear();
+    _maps_by_tag_built = false;
+    _maps_by_level.clear();
+}
+
+// The maps with every tag in tag_set.
+static const vault_indices &_maps_with_tags(const unordered_set<string> &tag_set)
+{
+    if (!_maps_by_tag_built)
+    {
+        for (unsigned i = 0, size = vdefs.size(); i < size; ++i)
+            for (const string &tag : vdefs[i].get_tags_unsorted())
+                _maps_by_tag[tag].push_back(i);
+        _maps_by_tag_built = true;
+    }
+
+    // Any one tag's list will do; the caller checks the rest.
+    const vault_indices *best = &_no_maps;
+    for (const string &tag : tag_set)
+    {
+        auto it = _maps_by_tag.find(tag);
+        if (it == _maps_by_tag.end())
+            return _no_maps;
+        if (best == &_no_maps || it->second.size() < best->size())
+            best = &it->second;
+    }
+    return *best;
+}
+
+static const level_map_index &_maps_for_level(const level_id &place)
+{
+    const int absdepth = absdungeon_depth(place.branch, place.depth);
+    const int branch_depth = brdepth[place.branch];
+
+    auto it = _maps_by_level.find(place);
+    if (it != _maps_by_level.end() && it->second.absdepth == absdepth
+        && it->second.brdepth == branch_depth)
+    {
+        return it->second;
+    }
+
+    level_map_index &index = _maps_by_level[place];
+    index.absdepth = absdepth;
+    index.brdepth = branch_depth;
+    index.by_depth.clear();
+    index.by_place.clear();
+    for (unsigned i = 0, size = vdefs.size(); i < size; ++i)
+    {
+        if (vdefs[i].is_usable_in(place))
+            index.by_depth.push_back(i);
+        if (vdefs[i].place.is_usable_in(place))
+            index.by_place.push_back(i);
+    }
+    return index;
+}
+
 mapref_vector find_maps_for_tag(const string &tag,
                                 bool check_depth,
                                 bool check_used)
@@ -769,8 +863,12 @@ mapref_vector find_maps_for_tag(const string &tag,
     level_id place = level_id::current();
     unordered_set<string> tag_set = parse_tags(tag);
 
-    for (const map_def &mapdef : vdefs)
+    if (_maps_with_tags(tag_set).empty() && _have_deferred_maps())
+        _load_deferred_maps();
+
+    for (unsigned i : _maps_with_tags(tag_set))
     {
+        const map_def &mapdef = vdefs[i];
         if (mapdef.has_all_tags(tag_set.begin(), tag_set.end())
             && !mapdef.has_tag("dummy")
             && (!check_depth || _debug_ignore_depth
@@ -798,6 +896,8 @@ private:
 public:
     bool accept(const map_def &md) const;
     void announce(const map_def *map) const;
+    const vault_indices *candidates() const;
+    bool wants_deferred_maps() const;
 
     bool valid() const
     {
@@ -952,6 +1052,32 @@ bool map_selector::accept(const map_def &mapdef) const
     }
 }
 
+// The maps accept() could possibly take, or nullptr to try them all.
+const vault_indices *map_selector::candidates() const
+{
+    switch (sel)
+    {
+    case PLACE:
+        return &_maps_for_level(place).by_place;
+    case DEPTH:
+    case DEPTH_AND_CHANCE:
+        return &_maps_for_level(place).by_depth;
+    case TAG:
+        return &_maps_with_tags(parse_tags(tag));
+    default:
+        return nullptr;
+    }
+}
+
+// Whether this could want a map that a normal startup leaves out: only
+// sprint and the tutorial use them, but a tag no loaded map has might be
+// on one of them too.
+bool map_selector::wants_deferred_maps() const
+{
+    return crawl_state.game_is_sprint() || crawl_state.game_is_tutorial()
+           || sel == TAG && _maps_with_tags(parse_tags(tag)).empty();
+}
+
 void map_selector::announce(const map_def *vault) const
 {
 #ifdef DEBUG_DIAGNOSTICS
@@ -992,17 +1118,27 @@ string vault_chance_tag(const map_def &map)
     return "";
 }
 
-typedef vector<unsigned> vault_indices;
-
 static vault_indices _eligible_maps_for_selector(const map_selector &sel)
 {
     vault_indices eligible;
 
+    if (_have_deferred_maps() && sel.wants_deferred_maps())
+        _load_deferred_maps();
+
     if (sel.valid())
     {
-        for (unsigned i = 0, size = vdefs.size(); i < size; ++i)
-            if (sel.accept(vdefs[i]))
-                eligible.push_back(i);
+        if (const vault_indices *candidates = sel.candidates())
+        {
+            for (unsigned i : *candidates)
+                if (sel.accept(vdefs[i]))
+                    eligible.push_back(i);
+        }
+        else
+        {
+            for (unsigned i = 0, size = vdefs.size(); i < size; ++i)
+                if (sel.accept(vdefs[i]))
+                    eligible.push_back(i);
+        }
     }
 
     return eligible;
@@ -1220,6 +1356,7 @@ const map_def *random_map_for_tag(const string &tag,
 
 int map_count()
 {
+    _load_deferred_maps();
     return vdefs.size();
 }
 
@@ -1239,6 +1376,58 @@ map_load_info_t lc_loaded_maps;
 
 static set<string> map_files_read;
 
+// Files in these directories only have maps for sprint, the tutorial and
+// the tests, which find them by name or by tags of their own. A normal
+// startup leaves them out: they're read the first time they might be
+// wanted, at the end of vdefs. Nothing a normal game can choose moves.
+static const char *_deferred_map_dirs[] =
+{
+    "des/sprint/", "des/tutorial/", "des/test/",
+};
+static bool _defer_maps = false;
+static vector<string> _deferred_map_files;
+
+static bool _is_deferred_map_file(const string &file)
+{
+    for (const char *dir : _deferred_map_dirs)
+        if (starts_with(file, dir))
+            return true;
+    return false;
+}
+
+static bool _have_deferred_maps()
+{
+    return !_deferred_map_files.empty();
+}
+
+static void _run_global_prelude(dlua_chunk &chunk)
+{
+    if (!chunk.empty())
+    {
+        if (chunk.load_call(dlua, nullptr))
+            mprf(MSGCH_ERROR, "Lua error: %s", chunk.orig_error().c_str());
+    }
+}
+
+static void _load_deferred_maps()
+{
+    if (_deferred_map_files.empty())
+        return;
+
+    dprf("Loading %u deferred map files",
+         (unsigned int)_deferred_map_files.size());
+
+    vector<string> files;
+    files.swap(_deferred_map_files);
+    const size_t first_prelude = global_preludes.size();
+    for (const string &file : files)
+        read_map(file);
+
+    // Their preludes missed run_map_global_preludes().
+    for (size_t i = first_prelude; i < global_preludes.size(); ++i)
+        _run_global_prelude(global_preludes[i]);
+}
+
 extern int yylineno;
 
 static void _reset_map_parser()
@@ -1361,6 +1550,7 @@ static bool _load_map_index(const string& cache, const string &base,
     const int nmaps = unmarshallShort(inf);
     const int nexist = vdefs.size();
     vdefs.resize(nexist + nmaps, map_def());
+    _invalidate_map_index();
     for (int i = 0; i < nmaps; ++i)
     {
         map_def &vdef(vdefs[nexist + i]);
@@ -1469,6 +1659,12 @@ static void _write_map_cache(const string &filename, size_t vs, size_t ve,
 
     file_lock deslock(descache_base + ".lk", "wb");
 
+    // Every game runs the preludes, and most of the other chunks get run
+    // sooner or later, so compile them once here rather than on each load.
+    lc_global_prelude.compile(dlua);
+    for (size_t i = vs; i < ve; ++i)
+        vdefs[i].compile_lua();
+
     _write_map_prelude(descache_base, mtime);
     _write_map_full(descache_base, vs, ve, mtime);
     _write_map_index(descache_base, vs, ve, mtime);
@@ -1506,13 +1702,20 @@ static void _parse_maps(const string &s)
     yyparse();
     fclose(dat);
 
-    global_preludes.push_back(lc_global_prelude);
-
+    // Writing the cache compiles the global prelude, so keep that copy.
     _write_map_cache(cache_name, file_start, vdefs.size(), mtime);
+
+    global_preludes.push_back(lc_global_prelude);
 }
 
 void read_map(const string &file)
 {
+    if (_defer_maps && _is_deferred_map_file(file))
+    {
+        _deferred_map_files.push_back(file);
+        return;
+    }
+
     _parse_maps(lc_desfile = datafile_path(file));
     _dgn_flush_map_environments();
     // Force GC to prevent heap from swelling unnecessarily.
@@ -1521,6 +1724,11 @@ void read_map(const string &file)
 
 void read_maps()
 {
+    // -builddb has to write every cache, and tests and scripts might want
+    // any map.
+    unwind_bool defer(_defer_maps, !crawl_state.build_db && !crawl_state.test
+                                   && !crawl_state.script
+                                   && !crawl_state.dump_maps);
     if (dlua.execfile("dlua/loadmaps.lua", true, true, true))
         end(1, false, "Lua error: %s", dlua.error.c_str());
 
@@ -1547,7 +1755,9 @@ void reread_maps()
 
     // BOOM!
     vdefs.clear();
+    _invalidate_map_index();
     map_files_read.clear();
+    _deferred_map_files.clear();
     read_maps();
 }
 
@@ -1566,22 +1776,19 @@ void add_parsed_map(const map_def &md)
 
     map.fixup();
     vdefs.push_back(map);
+    _invalidate_map_index();
 }
 
 void run_map_global_preludes()
 {
     for (dlua_chunk &chunk : global_preludes)
-    {
-        if (!chunk.empty())
-        {
-            if (chunk.load_call(dlua, nullptr))
-                mprf(MSGCH_ERROR, "Lua error: %s", chunk.orig_error().c_str());
-        }
-    }
+        _run_global_prelude(chunk);
 }
 
 void run_map_local_preludes()
 {
+    // Preludes can set tags and depths.
+    _invalidate_map_index();
     for (map_def &vdef : vdefs)
     {
         if (!vdef.prelude.empty())
@@ -59,7 +59,7 @@
 class maybe_bool
 {
 protected:
-    enum class mbool_t { t, f, maybe } value;
+    enum class mbool_t : unsigned char { t, f, maybe } value;
     constexpr maybe_bool(const mbool_t val)
         : value(val)
     { }
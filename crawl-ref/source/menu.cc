@@ -17,7 +17,9 @@
 #include "env.h"
 #include "tile-env.h"
 #include "hints.h"
+#include "initfile.h"
 #include "invent.h"
+#include "items.h"
 #include "libutil.h"
 #include "macro.h"
 #include "message.h"
@@ -2412,26 +2414,26 @@ bool MonsterMenuEntry::get_tiles(vector<tile_def>& tileset) const
         tileset.emplace_back(TILE_HALO_GD_NEUTRAL);
     else if (m->neutral())
         tileset.emplace_back(TILE_HALO_NEUTRAL);
-    else if (Options.tile_show_threat_levels.find("unusual") != string::npos
+    else if (tile_show_threat_level("unusual")
              && m->has_unusual_items())
         tileset.emplace_back(TILE_THREAT_UNUSUAL);
     else
         switch (m->threat)
         {
         case MTHRT_TRIVIAL:
-            if (Options.tile_show_threat_levels.find("trivial") != string::npos)
+            if (tile_show_threat_level("trivial"))
                 tileset.emplace_back(TILE_THREAT_TRIVIAL);
             break;
         case MTHRT_EASY:
-            if (Options.tile_show_threat_levels.find("easy") != string::npos)
+            if (tile_show_threat_level("easy"))
                 tileset.emplace_back(TILE_THREAT_EASY);
             break;
         case MTHRT_TOUGH:
-            if (Options.tile_show_threat_levels.find("tough") != string::npos)
+            if (tile_show_threat_level("tough"))
                 tileset.emplace_back(TILE_THREAT_TOUGH);
             break;
         case MTHRT_NASTY:
-            if (Options.tile_show_threat_levels.find("nasty") != string::npos)
+            if (tile_show_threat_level("nasty"))
                 tileset.emplace_back(TILE_THREAT_NASTY);
             break;
         default:
@@ -3255,6 +3257,9 @@ bool Menu::cycle_headers(bool forward)
 }
 
 #ifdef USE_TILE_WEB
+// Items sent up front in a menu message; see webtiles_write_menu().
+static constexpr int webtiles_menu_chunk_size = 100;
+
 void Menu::webtiles_write_menu(bool replace) const
 {
     if (crawl_state.doing_prev_cmd_again)
@@ -3276,11 +3281,22 @@ void Menu::webtiles_write_menu(bool replace) const
     int count = items.size();
     int start = 0;
     int end = start + count;
+    int first_entry = get_first_visible();
+
+    // Long menus (stash searches, say) only send the items around where
+    // the menu opens; the client shows placeholders for the rest, and asks
+    // for them with request_menu_range as they scroll into view.
+    if (count > webtiles_menu_chunk_size)
+    {
+        const int centre = is_set(MF_START_AT_END) ? count : first_entry;
+        start = max(0, min(centre - webtiles_menu_chunk_size / 2,
+                           count - webtiles_menu_chunk_size));
+        end = start + webtiles_menu_chunk_size;
+    }
 
     tiles.json_write_int("total_items", count);
     tiles.json_write_int("chunk_start", start);
 
-    int first_entry = get_first_visible();
     if (first_entry != 0 && !is_set(MF_START_AT_END))
         tiles.json_write_int("jump_to", first_entry);
 
@@ -3486,6 +3502,45 @@ int menu_colour(const string &text, const string &prefix, const string &tag, boo
     return -1;
 }
 
+bool menu_colour_memo::get(const string &text, const string &tag, bool temp,
+                           int &colour) const
+{
+    if (!m_valid || m_turn != you.num_turns
+        || m_options != options_generation()
+        || m_knowledge != item_knowledge_generation()
+        || m_temp != temp || m_text != text || m_tag != tag)
+    {
+        return false;
+    }
+    colour = m_colour;
+    return true;
+}
+
+void menu_colour_memo::set(const string &text, const string &tag, bool temp,
+                           int colour)
+{
+    m_valid = true;
+    m_turn = you.num_turns;
+    m_options = options_generation();
+    m_knowledge = item_knowledge_generation();
+    m_temp = temp;
+    m_text = text;
+    m_tag = tag;
+    m_colour = colour;
+}
+
+int MenuEntry::highlight_colour(bool) const
+{
+    const string entry_text = get_text();
+    int col;
+    if (!m_colour_memo.get(entry_text, tag, false, col))
+    {
+        col = menu_colour(entry_text, "", tag);
+        m_colour_memo.set(entry_text, tag, false, col);
+    }
+    return col;
+}
+
 int MenuHighlighter::entry_colour(const MenuEntry *entry) const
 {
     return entry->colour != MENU_ITEM_STOCK_COLOUR ? entry->colour
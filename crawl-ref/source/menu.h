@@ -94,6 +94,27 @@ int menu_colour(const string &itemtext,
                 bool strict=true);
 
 const int MENU_ITEM_STOCK_COLOUR = LIGHTGREY;
+
+// The last menu_colour() of a menu entry, so that drawing and scrolling a
+// long menu doesn't match every entry against every menu_colour again. It
+// holds until the entry's text or tag, the options or what the player knows
+// about items change, or a turn passes.
+class menu_colour_memo
+{
+public:
+    bool get(const string &text, const string &tag, bool temp,
+             int &colour) const;
+    void set(const string &text, const string &tag, bool temp, int colour);
+
+private:
+    bool m_valid = false;
+    string m_text, m_tag;
+    bool m_temp = false;
+    unsigned int m_options = 0, m_knowledge = 0;
+    int m_turn = 0;
+    int m_colour = -1;
+};
+
 class MenuEntry
 {
 public:
@@ -174,10 +195,7 @@ public:
     virtual string get_text() const;
     void wrap_text(int width=MIN_COLS);
 
-    virtual int highlight_colour(bool /*unused in superclass*/ = false) const
-    {
-        return menu_colour(get_text(), "", tag);
-    }
+    virtual int highlight_colour(bool /*unused in superclass*/ = false) const;
 
     virtual bool selected() const;
     virtual void select(int qty = -1);
@@ -194,6 +212,7 @@ public:
 protected:
     virtual string _get_text_preface() const;
     bool m_enabled;
+    mutable menu_colour_memo m_colour_memo;
 };
 
 class ToggleableMenuEntry : public MenuEntry
@@ -7,7 +7,9 @@
 
 #include "message.h"
 
+#include <memory>
 #include <sstream>
+#include <unordered_map>
 
 #include "areas.h"
 #include "colour.h"
@@ -62,14 +64,78 @@ static bool _ends_in_punctuation(const string& text)
     }
 }
 
+/**
+ * The text of a message, interned: every message with the same text shares
+ * one copy of it, which goes away with the last message that uses it. The
+ * copy also keeps the text with its colour tags parsed out, which merging
+ * and joining messages look at over and over.
+ */
+class message_text
+{
+public:
+    message_text() { }
+    message_text(const string &text) : m_entry(_intern(text)) { }
+
+    const string &text() const { return m_entry ? m_entry->text : _empty; }
+    const string &pure() const { return m_entry ? m_entry->pure : _empty; }
+
+    // Interned, so the same text is the same entry.
+    bool operator==(const message_text &other) const
+    {
+        return m_entry == other.m_entry;
+    }
+
+private:
+    struct entry
+    {
+        string text;
+        string pure;
+    };
+
+    typedef unordered_map<string, weak_ptr<const entry>> pool_t;
+
+    static pool_t &_pool()
+    {
+        // Never destroyed, so that messages still alive at exit can forget
+        // their entries.
+        static pool_t *pool = new pool_t;
+        return *pool;
+    }
+
+    static shared_ptr<const entry> _intern(const string &text)
+    {
+        weak_ptr<const entry> &slot = _pool()[text];
+        shared_ptr<const entry> found = slot.lock();
+        if (found)
+            return found;
+
+        entry *e = new entry;
+        e->text = text;
+        e->pure = formatted_string::parse_string(text).tostring();
+        found.reset(e, [](const entry *gone)
+                       {
+                           _pool().erase(gone->text);
+                           delete gone;
+                       });
+        slot = found;
+        return found;
+    }
+
+    static const string _empty;
+
+    shared_ptr<const entry> m_entry;
+};
+
+const string message_text::_empty;
+
 struct message_particle
 {
-    string text;        /// text of message (tagged string...)
+    message_text text;  /// text of message (tagged string...)
     int repeats;        /// Number of times the message is in succession (x2)
 
-    string pure_text() const
+    const string &pure_text() const
     {
-        return formatted_string::parse_string(text).tostring();
+        return text.pure();
     }
 
     string with_repeats() const
@@ -78,7 +144,7 @@ struct message_particle
         string rep = "";
         if (repeats > 1)
             rep = make_stringf(" x%d", repeats);
-        return text + rep;
+        return text.text() + rep;
     }
 
     string pure_text_with_repeats() const
@@ -319,7 +385,7 @@ public:
      * Append the contents of `buf` to the current buffer.
      * If `buf` has cycled, this will overwrite the entire contents of `this`.
      */
-    void append(const circ_vec<T, SIZE> buf)
+    void append(const circ_vec<T, SIZE> &buf)
     {
         const int buf_size = buf.filled_size();
         for (int i = 0; i < buf_size; i++)
@@ -869,7 +935,7 @@ public:
         return msgs;
     }
 
-    void append_store(store_t store)
+    void append_store(const store_t &store)
     {
         msgs.append(store);
         const int msgs_to_print = store.filled_size();
@@ -1360,15 +1426,44 @@ void dprf(diag_type param, const char *format, ...)
 
 static bool _updating_view = false;
 
+// What pattern_list_matcher needs from the message option lists.
+static int pattern_entry_channel(const message_filter &mf)
+{
+    return mf.channel;
+}
+
+static const text_pattern *pattern_entry_pattern(const message_filter &mf)
+{
+    return &mf.pattern;
+}
+
+static int pattern_entry_channel(const message_colour_mapping &mcm)
+{
+    return mcm.message.channel;
+}
+
+static const text_pattern *pattern_entry_pattern(
+    const message_colour_mapping &mcm)
+{
+    return mcm.valid() ? &mcm.message.pattern : nullptr;
+}
+
+static pattern_list_matcher<message_filter>
+    _force_more_matcher(NUM_MESSAGE_CHANNELS);
+static pattern_list_matcher<message_filter>
+    _flash_screen_matcher(NUM_MESSAGE_CHANNELS);
+static pattern_list_matcher<message_colour_mapping>
+    _message_colour_matcher(NUM_MESSAGE_CHANNELS);
+static pattern_list_matcher<text_pattern>
+    _note_message_matcher(NUM_MESSAGE_CHANNELS);
+
 static bool _check_option(const string& line, msg_channel_type channel,
-                          const vector<message_filter>& option)
+                          const vector<message_filter>& option,
+                          pattern_list_matcher<message_filter> &matcher)
 {
     if (crawl_state.generating_level)
         return false;
-    return any_of(begin(option),
-                  end(option),
-                  bind(mem_fn(&message_filter::is_filtered),
-                       placeholders::_1, channel, line));
+    return matcher.first_match(option, channel, line) >= 0;
 }
 
 static bool _check_more(const string& line, msg_channel_type channel)
@@ -1378,7 +1473,8 @@ static bool _check_more(const string& line, msg_channel_type channel)
     // crash here in order to find the real bug?
     if (!you.on_current_level)
         return false;
-    return _check_option(line, channel, Options.force_more_message);
+    return _check_option(line, channel, Options.force_more_message,
+                         _force_more_matcher);
 }
 
 static bool _check_flash_screen(const string& line, msg_channel_type channel)
@@ -1388,7 +1484,8 @@ static bool _check_flash_screen(const string& line, msg_channel_type channel)
     // crash here in order to find the real bug?
     if (!you.on_current_level)
         return false;
-    return _check_option(line, channel, Options.flash_screen_message);
+    return _check_option(line, channel, Options.flash_screen_message,
+                         _flash_screen_matcher);
 }
 
 static bool _check_join(const string& /*line*/, msg_channel_type channel)
@@ -1567,8 +1664,8 @@ static void _mpr(string text, msg_channel_type channel, int param, bool nojoin,
     if (!_doing_c_message_hook)
     {
         unwind_bool no_reentry(_doing_c_message_hook, true);
-        clua.callfn("c_message", "ss", text.c_str(),
-                                        channel_to_str(channel).c_str());
+        static lua_hook c_message("c_message");
+        c_message.call(clua, 0, text, channel_to_str(channel));
     }
 
     bool domore = _check_more(text, channel);
@@ -1772,21 +1869,14 @@ static void mpr_check_patterns(const string& message,
 {
     if (crawl_state.generating_level)
         return;
-    for (const text_pattern &pat : Options.note_messages)
+    if (channel != MSGCH_EQUIPMENT && channel != MSGCH_FLOOR_ITEMS
+        && channel != MSGCH_MULTITURN_ACTION
+        && channel != MSGCH_EXAMINE && channel != MSGCH_EXAMINE_FILTER
+        && channel != MSGCH_TUTORIAL && channel != MSGCH_DGL_MESSAGE
+        && _note_message_matcher.first_match(Options.note_messages, channel,
+                                             message) >= 0)
     {
-        if (channel == MSGCH_EQUIPMENT || channel == MSGCH_FLOOR_ITEMS
-            || channel == MSGCH_MULTITURN_ACTION
-            || channel == MSGCH_EXAMINE || channel == MSGCH_EXAMINE_FILTER
-            || channel == MSGCH_TUTORIAL || channel == MSGCH_DGL_MESSAGE)
-        {
-            continue;
-        }
-
-        if (pat.matches(message))
-        {
-            take_note(Note(NOTE_MESSAGE, channel, param, message));
-            break;
-        }
+        take_note(Note(NOTE_MESSAGE, channel, param, message));
     }
 
     if (channel != MSGCH_DIAGNOSTICS && channel != MSGCH_EQUIPMENT)
@@ -1832,14 +1922,10 @@ static msg_colour_type prepare_message(const string& imsg,
 
     if (!crawl_state.generating_level)
     {
-        for (const message_colour_mapping &mcm : Options.message_colour_mappings)
-        {
-            if (mcm.valid() && mcm.message.is_filtered(channel, imsg))
-            {
-                colour = mcm.colour;
-                break;
-            }
-        }
+        const int mapping = _message_colour_matcher.first_match(
+            Options.message_colour_mappings, channel, imsg);
+        if (mapping >= 0)
+            colour = Options.message_colour_mappings[mapping].colour;
     }
 
     return colour;
@@ -2170,7 +2256,7 @@ string get_last_messages(int mcount, bool full)
     mcount = min(mcount, NUM_STORED_MESSAGES);
     for (int i = -1; mcount > 0; --i)
     {
-        const message_line msg = msgs[i];
+        const message_line &msg = msgs[i];
         if (!msg)
             break;
         if (full || is_channel_dumpworthy(msg.channel))
@@ -2200,7 +2286,7 @@ bool recent_error_messages()
     int mcount = NUM_STORED_MESSAGES;
     for (int i = -1; mcount > 0; --i, --mcount)
     {
-        const message_line msg = msgs[i];
+        const message_line &msg = msgs[i];
         if (!msg)
             break;
         if (msg.channel == MSGCH_ERROR)
@@ -2213,7 +2299,7 @@ bool recent_error_messages()
 // messages. They'll be ignored when restoring.
 void save_messages(writer& outf)
 {
-    store_t msgs = buffer.get_store();
+    const store_t &msgs = buffer.get_store();
     marshallInt(outf, msgs.size());
     for (int i = 0; i < msgs.size(); ++i)
     {
@@ -2260,7 +2346,7 @@ static void _replay_messages_core(formatted_scroller &hist)
 {
     flush_prev_message();
 
-    const store_t msgs = buffer.get_store();
+    const store_t &msgs = buffer.get_store();
     formatted_string lines;
     for (int i = 0; i < msgs.size(); ++i)
         if (channel_message_history(msgs[i].channel))
@@ -67,6 +67,7 @@
 #include "throw.h"
 #include "timed-effects.h"
 #include "traps.h"
+#include "turn-times.h"
 #include "viewchar.h"
 #include "view.h"
 
@@ -554,8 +555,33 @@ static void _set_mons_move_dir(const monster* mons,
 
 typedef FixedArray< bool, 3, 3 > move_array;
 
+// What mon_can_move_to_pos() needs to know about the monster itself, rather
+// than the square: worked out once when all the squares around a monster
+// are checked, instead of once for each of them.
+struct move_context
+{
+    explicit move_context(const monster* mons)
+        : in_sanctuary(is_sanctuary(mons->pos())),
+          digs(_mons_can_cast_dig(mons, false)),
+          habitat(mons_primary_habitat(*mons)),
+          current_damages(-1)
+    {
+    }
+
+    bool in_sanctuary;
+    bool digs;
+    habitat_type habitat;
+    // Whether the monster's own square is next to a damaging wall; -1 until
+    // it is first needed.
+    int current_damages;
+};
+
+static bool _mon_can_move_to_pos(const monster* mons, const coord_def& delta,
+                                 bool just_check, move_context &ctx);
+
 static void _fill_good_move(const monster* mons, move_array* good_move)
 {
+    move_context ctx(mons);
     for (int count_x = 0; count_x < 3; count_x++)
         for (int count_y = 0; count_y < 3; count_y++)
         {
@@ -570,7 +596,8 @@ static void _fill_good_move(const monster* mons, move_array* good_move)
             }
 
             (*good_move)[count_x][count_y] =
-                mon_can_move_to_pos(mons, coord_def(count_x-1, count_y-1));
+                _mon_can_move_to_pos(mons, coord_def(count_x-1, count_y-1),
+                                     false, ctx);
         }
 }
 
@@ -1620,6 +1647,7 @@ static bool _mons_take_special_action(monster &mons, int old_energy)
 
 void handle_monster_move(monster* mons)
 {
+    TURN_PHASE(TP_MONSTER_MOVE);
     ASSERT(mons); // XXX: change to monster &mons
     const monsterentry* entry = get_monster_data(mons->type);
     if (!entry)
@@ -2279,16 +2307,46 @@ static void _post_monster_move(monster* mons)
         monster_die(*mons, KILL_MISC, NON_MONSTER);
 }
 
-priority_queue<pair<monster *, int>,
-               vector<pair<monster *, int> >,
-               MonsterActionQueueCompare> monster_queue;
+// A heap of monsters waiting to act, with the speed_increment each had when
+// queued; the same ordering std::priority_queue would give, but the storage
+// is sized once and kept between turns.
+static vector<pair<monster *, int>> monster_queue;
+
+// What handle_monsters() did on its last call.
+static unsigned int last_active_monsters = 0;
+static unsigned int last_scheduled_monsters = 0;
+
+static void _schedule_monster(monster* mons)
+{
+    if (monster_queue.capacity() < MAX_MONSTERS)
+        monster_queue.reserve(MAX_MONSTERS * 2);
+    monster_queue.emplace_back(mons, mons->speed_increment);
+    push_heap(monster_queue.begin(), monster_queue.end(),
+              MonsterActionQueueCompare());
+    last_scheduled_monsters++;
+}
+
+static pair<monster *, int> _next_scheduled_monster()
+{
+    pop_heap(monster_queue.begin(), monster_queue.end(),
+             MonsterActionQueueCompare());
+    const pair<monster *, int> next = monster_queue.back();
+    monster_queue.pop_back();
+    return next;
+}
 
 // Inserts a monster into the monster queue (needed to ensure that any monsters
 // given energy or an action by a effect can actually make use of that energy
 // this round)
 void queue_monster_for_action(monster* mons)
 {
-    monster_queue.emplace(mons, mons->speed_increment);
+    _schedule_monster(mons);
+}
+
+void monster_schedule_stats(unsigned int &active, unsigned int &scheduled)
+{
+    active = last_active_monsters;
+    scheduled = last_scheduled_monsters;
 }
 
 static void _clear_monster_flags()
@@ -2363,13 +2421,34 @@ static void _display_just_seen()
  */
 void handle_monsters(bool with_noise)
 {
+    TURN_PHASE(TP_MONSTERS);
+    static vector<coord_def> lookers;
+    lookers.clear();
+    last_scheduled_monsters = 0;
+
+    // Nothing is being placed right now, so empty slots at the top of
+    // env.mons can be dropped from monster_iterator's range.
+    trim_monster_slots();
+
+    last_active_monsters = 0;
     for (monster_iterator mi; mi; ++mi)
     {
         _pre_monster_move(**mi);
-        if (!invalid_monster(*mi) && mi->alive() && mi->has_action_energy())
-            monster_queue.emplace(*mi, mi->speed_increment);
+        if (!invalid_monster(*mi) && mi->alive())
+        {
+            last_active_monsters++;
+            if (mi->has_action_energy())
+            {
+                _schedule_monster(*mi);
+                if (!mi->asleep())
+                    lookers.push_back(mi->pos());
+            }
+        }
     }
 
+    // Nearly every monster that acts checks what it can see first.
+    cache_los_from(lookers, LOS_DEFAULT);
+
     int tries = 0; // infinite loop protection, shouldn't be ever needed
     while (!monster_queue.empty())
     {
@@ -2377,12 +2456,12 @@ void handle_monsters(bool with_noise)
         {
             die("infinite handle_monsters() loop, mons[0 of %d] is %s",
                 (int)monster_queue.size(),
-                monster_queue.top().first->name(DESC_PLAIN, true).c_str());
+                monster_queue.front().first->name(DESC_PLAIN, true).c_str());
         }
 
-        monster *mon = monster_queue.top().first;
-        const int oldspeed = monster_queue.top().second;
-        monster_queue.pop();
+        monster *mon;
+        int oldspeed;
+        tie(mon, oldspeed) = _next_scheduled_monster();
 
         if (invalid_monster(mon) || !mon->alive() || !mon->has_action_energy())
             continue;
@@ -2401,7 +2480,7 @@ void handle_monsters(bool with_noise)
         }
 
         if (mon->has_action_energy())
-            monster_queue.emplace(mon, mon->speed_increment);
+            _schedule_monster(mon);
 
         // If the player got banished, discard pending monster actions.
         if (you.banished)
@@ -2783,7 +2862,8 @@ static bool _mons_can_displace(const monster* mpusher,
 // Returns true if the monster should try to avoid that position
 // because of taking damage from damaging walls.
 static bool _check_damaging_walls(const monster *mon,
-                                  const coord_def &targ)
+                                  const coord_def &targ,
+                                  move_context &ctx)
 {
     const bool have_slimy = env.level_state & LSTATE_SLIMY_WALL;
     const bool have_icy   = env.level_state & LSTATE_ICY_WALL;
@@ -2806,11 +2886,14 @@ static bool _check_damaging_walls(const monster *mon,
     if (!target_damages)
         return false;
 
-    const bool current_damages = count_adjacent_slime_walls(mon->pos())
-        + count_adjacent_icy_walls(mon->pos());
+    if (ctx.current_damages < 0)
+    {
+        ctx.current_damages = count_adjacent_slime_walls(mon->pos())
+            + count_adjacent_icy_walls(mon->pos()) ? 1 : 0;
+    }
 
     // We're already taking damage, so moving into damage is fine.
-    if (current_damages)
+    if (ctx.current_damages)
         return false;
 
     // The monster needs to have a purpose to risk taking damage.
@@ -2827,6 +2910,13 @@ static bool _check_damaging_walls(const monster *mon,
 // calls from is_trap_safe when checking the surrounding squares of a trap.
 bool mon_can_move_to_pos(const monster* mons, const coord_def& delta,
                          bool just_check)
+{
+    move_context ctx(mons);
+    return _mon_can_move_to_pos(mons, delta, just_check, ctx);
+}
+
+static bool _mon_can_move_to_pos(const monster* mons, const coord_def& delta,
+                                 bool just_check, move_context &ctx)
 {
     const coord_def targ = mons->pos() + delta;
 
@@ -2837,18 +2927,18 @@ bool mon_can_move_to_pos(const monster* mons, const coord_def& delta,
     // Non-friendly and non-good neutral monsters won't enter
     // sanctuaries.
     if (is_sanctuary(targ)
-        && !is_sanctuary(mons->pos())
+        && !ctx.in_sanctuary
         && !mons->wont_attack())
     {
         return false;
     }
 
     // Inside a sanctuary don't attack anything!
-    if (is_sanctuary(mons->pos()) && actor_at(targ))
+    if (ctx.in_sanctuary && actor_at(targ))
         return false;
 
     const dungeon_feature_type target_grid = env.grid(targ);
-    const habitat_type habitat = mons_primary_habitat(*mons);
+    const habitat_type habitat = ctx.habitat;
 
     // No monster may enter the open sea.
     if (feat_is_endless(target_grid))
@@ -2862,10 +2952,10 @@ bool mon_can_move_to_pos(const monster* mons, const coord_def& delta,
     if (mons_avoids_cloud(mons, targ))
         return false;
 
-    if (_check_damaging_walls(mons, targ))
+    if (_check_damaging_walls(mons, targ, ctx))
         return false;
 
-    const bool digs = _mons_can_cast_dig(mons, false);
+    const bool digs = ctx.digs;
     if ((target_grid == DNGN_ROCK_WALL || target_grid == DNGN_CLEAR_ROCK_WALL)
            && (mons->can_burrow() || digs)
         || mons->type == MONS_SPATIAL_MAELSTROM
@@ -3472,6 +3562,7 @@ static bool _monster_move(monster* mons)
     if (mmov.origin() && !mons->confused())
         return false;
 
+    move_context ctx(mons);
     for (int count_x = 0; count_x < 3; count_x++)
         for (int count_y = 0; count_y < 3; count_y++)
         {
@@ -3490,7 +3581,8 @@ static bool _monster_move(monster* mons)
                 deep_water_available = true;
 
             good_move[count_x][count_y] =
-                mon_can_move_to_pos(mons, coord_def(count_x-1, count_y-1));
+                _mon_can_move_to_pos(mons, coord_def(count_x-1, count_y-1),
+                                     false, ctx);
         }
 
     // Now we know where we _can_ move.
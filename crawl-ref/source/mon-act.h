@@ -35,5 +35,8 @@ void handle_monsters(bool with_noise = false);
 void handle_monster_move(monster* mon);
 
 void queue_monster_for_action(monster* mons);
+// How many monsters were alive, and how many times one was queued to act,
+// in the last handle_monsters().
+void monster_schedule_stats(unsigned int &active, unsigned int &scheduled);
 
 #define ENERGY_SUBMERGE(entry) (max(entry->energy_usage.swim / 2, 1))
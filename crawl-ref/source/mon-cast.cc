@@ -2200,7 +2200,7 @@ static int _tension_door_closed(set<coord_def> door,
 {
     // this unwind is a bit heavy, but because out-of-los clouds dissipate
     // instantly, they can be wiped out by these door tests.
-    unwind_var<map<coord_def, cloud_struct>> cloud_state(env.cloud);
+    unwind_var<cloud_grid> cloud_state(env.cloud);
     _set_door(door, DNGN_CLOSED_DOOR);
     const int new_tension = get_tension(GOD_NO_GOD);
     _set_door(door, old_feat);
@@ -3832,6 +3832,19 @@ static mon_spell_slot _find_spell_prospect(const monster &mons,
     return hspell_pass[i];
 }
 
+// Tracers fired while one monster decides what to cast. The same spell is
+// often set up and traced again at the same target (a second attempt, or
+// once in the emergency pass and once normally); nothing moves in between,
+// so the first result stands.
+struct spell_trace
+{
+    spell_type spell;
+    coord_def target;
+    beam_type flavour;
+    bolt beam;
+};
+static vector<spell_trace> _spell_traces;
+
 /**
  * Would it be a good idea for the given monster to cast the given spell?
  *
@@ -3847,8 +3860,24 @@ static bool _should_cast_spell(const monster &mons, spell_type spell,
     // beam-type spells requiring tracers
     if (get_spell_flags(spell) & spflag::needs_tracer)
     {
-        const bool explode = spell_is_direct_explosion(spell);
-        fire_tracer(&mons, beem, explode);
+        if (mons_wont_fire(mons, beem, ignore_good_idea))
+            return false;
+
+        auto traced = find_if(_spell_traces.begin(), _spell_traces.end(),
+                              [&](const spell_trace &t)
+                              {
+                                  return t.spell == spell
+                                         && t.target == beem.target
+                                         && t.flavour == beem.flavour;
+                              });
+        if (traced != _spell_traces.end())
+            beem = traced->beam;
+        else
+        {
+            const bool explode = spell_is_direct_explosion(spell);
+            fire_tracer(&mons, beem, explode);
+            _spell_traces.push_back({spell, beem.target, beem.flavour, beem});
+        }
         // Good idea?
         return mons_should_fire(beem, ignore_good_idea);
     }
@@ -4105,6 +4134,7 @@ bool handle_mon_spell(monster* mons)
     }
 
     const monster_spells hspell_pass = _find_usable_spells(*mons);
+    _spell_traces.clear();
 
     // If no useful spells... cast no spell.
     if (!hspell_pass.size())
@@ -140,6 +140,10 @@ mon_enchant monster::get_ench(enchant_type ench1,
 
     for (int e = ench1; e <= ench2; ++e)
     {
+        // Most lookups are for enchantments the monster doesn't have.
+        if (!ench_cache[e])
+            continue;
+
         auto i = enchantments.find(static_cast<enchant_type>(e));
 
         if (i != enchantments.end())
@@ -151,7 +155,7 @@ mon_enchant monster::get_ench(enchant_type ench1,
 
 void monster::update_ench(const mon_enchant &ench)
 {
-    if (ench.ench != ENCH_NONE)
+    if (ench.ench != ENCH_NONE && ench_cache[ench.ench])
     {
         if (mon_enchant *curr_ench = map_find(enchantments, ench.ench))
             *curr_ench = ench;
@@ -1980,14 +1984,19 @@ void monster::apply_enchantments()
 
     // We process an enchantment only if it existed both at the start of this
     // function and when getting to it in order; any enchantment can add, modify
-    // or remove others -- or even itself.
-    FixedBitVector<NUM_ENCHANTMENTS> ec = ench_cache;
+    // or remove others -- or even itself. Monsters rarely have more than a
+    // few, so take them from the list rather than scanning every type.
+    enchant_type ec[NUM_ENCHANTMENTS];
+    int count = 0;
+    for (const auto &entry : enchantments)
+        ec[count++] = entry.first;
 
     // The ordering in enchant_type makes sure that "super-enchantments"
-    // like berserk time out before their parts.
-    for (int i = 0; i < NUM_ENCHANTMENTS; ++i)
-        if (ec[i] && has_ench(static_cast<enchant_type>(i)))
-            apply_enchantment(enchantments.find(static_cast<enchant_type>(i))->second);
+    // like berserk time out before their parts; the list is kept in that
+    // order.
+    for (int i = 0; i < count; ++i)
+        if (has_ench(ec[i]))
+            apply_enchantment(enchantments.find(ec[i])->second);
 }
 
 // Used to adjust time durations in calc_duration() for monster speed.
@@ -1740,11 +1740,8 @@ int monster_info::spell_hd(spell_type spell) const
 
 unsigned monster_info::colour(bool base_colour) const
 {
-    if (!base_colour && Options.mon_glyph_overrides.count(type)
-        && Options.mon_glyph_overrides[type].col)
-    {
-        return Options.mon_glyph_overrides[type].col;
-    }
+    if (!base_colour && mons_glyph_override(type).col)
+        return mons_glyph_override(type).col;
     else if (_colour == COLOUR_INHERIT)
         return mons_class_colour(type);
     else
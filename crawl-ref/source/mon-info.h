@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 #include <vector>
 
 #include "enchant-type.h"
@@ -293,14 +294,13 @@ struct monster_info : public monster_info_base
     explicit monster_info(monster_type p_type,
                           monster_type p_base_type = MONS_NO_MONSTER);
 
+    // Copies share the items of the original, since nothing changes them
+    // once the monster_info is built.
     monster_info(const monster_info& mi)
     : monster_info_base(mi), i_ghost(mi.i_ghost)
     {
         for (unsigned i = 0; i <= MSLOT_LAST_VISIBLE_SLOT; ++i)
-        {
-            if (mi.inv[i])
-                inv[i].reset(new item_def(*mi.inv[i]));
-        }
+            inv[i] = mi.inv[i];
     }
 
     monster_info& operator=(const monster_info& p)
@@ -318,7 +318,7 @@ struct monster_info : public monster_info_base
                    bool verbose = true) const;
 
     /* only real equipment is visible, miscellany is for mimic items */
-    unique_ptr<item_def> inv[MSLOT_LAST_VISIBLE_SLOT + 1];
+    shared_ptr<item_def> inv[MSLOT_LAST_VISIBLE_SLOT + 1];
 
     struct
     {
@@ -9,6 +9,7 @@
 #include "fprop.h"
 #include "item-prop.h"
 #include "items.h"
+#include "level-id.h"
 #include "libutil.h"
 #include "los-def.h"
 #include "losglobal.h"
@@ -89,6 +90,73 @@ bool target_is_unreachable(monster* mon)
            || mon->travel_target == MTRAV_KNOWN_UNREACHABLE;
 }
 
+// Flows towards this turn's pathfinding targets. Hostiles chasing the same
+// target with the same mons_movement_class() and range share one, rather
+// than each searching from scratch.
+struct shared_flow
+{
+    coord_def target;
+    uint32_t movement;
+    int range;
+    unique_ptr<monster_pathfind> flow;
+};
+
+static vector<shared_flow> _shared_flows;
+static int _shared_flows_time = -1;
+static level_id _shared_flows_level;
+static const size_t MAX_SHARED_FLOWS = 8;
+
+static const monster_pathfind &_shared_flow(const monster* mon,
+                                            const coord_def &targpos,
+                                            int range)
+{
+    if (_shared_flows_time != you.elapsed_time
+        || _shared_flows_level != level_id::current())
+    {
+        _shared_flows.clear();
+        _shared_flows_time = you.elapsed_time;
+        _shared_flows_level = level_id::current();
+    }
+
+    const uint32_t movement = mons_movement_class(mon);
+    for (const shared_flow &sf : _shared_flows)
+        if (sf.target == targpos && sf.movement == movement
+            && sf.range == range)
+        {
+            return *sf.flow;
+        }
+
+    if (_shared_flows.size() >= MAX_SHARED_FLOWS)
+        _shared_flows.erase(_shared_flows.begin());
+
+    shared_flow sf;
+    sf.target = targpos;
+    sf.movement = movement;
+    sf.range = range;
+    sf.flow = make_unique<monster_pathfind>();
+    sf.flow->set_range(range);
+    sf.flow->init_flow(mon, targpos);
+    _shared_flows.push_back(std::move(sf));
+    return *_shared_flows.back().flow;
+}
+
+// Find mon's path to targpos in mp, from a shared flow where we can.
+static bool _init_pathfind(monster* mon, const coord_def &targpos, int range,
+                           monster_pathfind &mp)
+{
+    mp.set_range(range);
+
+    // Friendly summons stay in sight, and thorn hunters path through their
+    // briars; neither moves like anyone else.
+    if (!mon->friendly() && mon->type != MONS_THORN_HUNTER
+        && mp.init_from_flow(mon, _shared_flow(mon, targpos, range)))
+    {
+        return true;
+    }
+
+    return mp.init_pathfind(mon, targpos);
+}
+
 //#define DEBUG_PATHFIND
 
 // Check whether there's an unobstructed path to our foe,
@@ -212,9 +280,8 @@ bool try_pathfind(monster* mon)
          targpos.x, targpos.y, range);
 #endif
     monster_pathfind mp;
-    mp.set_range(range);
 
-    if (mp.init_pathfind(mon, targpos))
+    if (_init_pathfind(mon, targpos, range, mp))
     {
         mon->travel_path = mp.calc_waypoints();
         if (!mon->travel_path.empty())
@@ -2,12 +2,19 @@
 
 #include "mon-pathfind.h"
 
+#include <map>
+#include <queue>
+
+#include "coordit.h"
 #include "directn.h"
 #include "env.h"
+#include "hash.h"
+#include "level-id.h"
 #include "los.h"
 #include "misc.h"
 #include "mon-movetarget.h"
 #include "mon-place.h"
+#include "mon-util.h"
 #include "religion.h"
 #include "state.h"
 #include "terrain.h"
@@ -19,13 +26,13 @@
 // The pathfinding is an implementation of the A* algorithm. Beginning at the
 // monster position we check all neighbours of a given grid, estimate the
 // distance needed for any shortest path including this grid and push the
-// result into a hash. We can then easily access all points with the shortest
-// distance estimates and then check _their_ neighbours and so on.
+// result into a bucket queue. We can then easily access all points with the
+// shortest distance estimates and then check _their_ neighbours and so on.
 // The algorithm terminates once we reach the destination since - because
-// of the sorting of grids by shortest distance in the hash - there can be no
+// of the sorting of grids by shortest distance in the queue - there can be no
 // path between start and target that is shorter than the current one. There
 // could be other paths that have the same length but that has no real impact.
-// If the hash has been cleared and the start grid has not been encountered,
+// If the queue has been emptied and the start grid has not been encountered,
 // then there's no path that matches the requirements fed into monster_pathfind.
 // (These requirements are usually preference of habitat of a specific monster
 // or a limit of the distance between start and any grid on the path.)
@@ -60,16 +67,331 @@ int mons_tracking_range(const monster* mon)
     return range;
 }
 
+// Everything about a hostile monster that decides where monster_pathfind
+// lets it go and what each step costs, as far as we can tell without a
+// particular square to look at.
+uint32_t mons_movement_class(const monster* mon)
+{
+    uint8_t traits[NUM_FEATURES + 5];
+    for (int f = 0; f < NUM_FEATURES; ++f)
+        traits[f] = mon->is_habitable_feat(static_cast<dungeon_feature_type>(f));
+
+    const coord_def nowhere;
+    traits[NUM_FEATURES] = mon->can_pass_through_feat(DNGN_FLOOR)
+                           && (mons_can_open_door(*mon, nowhere)
+                               || mons_can_eat_door(*mon, nowhere)
+                               || mons_can_destroy_door(*mon, nowhere));
+    traits[NUM_FEATURES + 1] = mon->ground_level();
+    traits[NUM_FEATURES + 2] = mons_primary_habitat(*mon);
+    traits[NUM_FEATURES + 3] = mons_habitat(*mon, true);
+    traits[NUM_FEATURES + 4] = mons_intel(*mon);
+    return hash32(traits, sizeof(traits));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// path_hierarchy
+//
+// For long paths the level is cut into square clusters. Each movement class
+// gets a graph of the squares where it can cross from one cluster into the
+// next, with the distances between the crossings of each cluster. A search
+// over that graph picks the crossings to head for, and ordinary searches
+// from one crossing to the next, each about a cluster long, fill in the
+// path. Graphs are rebuilt when terrain changes.
+
+static const int PATH_CLUSTER = 10;
+static const int CLUSTERS_X = (GXM + PATH_CLUSTER - 1) / PATH_CLUSTER;
+static const int CLUSTERS_Y = (GYM + PATH_CLUSTER - 1) / PATH_CLUSTER;
+
+static int _path_cluster(const coord_def &c)
+{
+    return c.x / PATH_CLUSTER + c.y / PATH_CLUSTER * CLUSTERS_X;
+}
+
+static coord_def _cluster_corner(const coord_def &c)
+{
+    return coord_def(c.x - c.x % PATH_CLUSTER, c.y - c.y % PATH_CLUSTER);
+}
+
+typedef int cluster_distances[PATH_CLUSTER][PATH_CLUSTER];
+
+class path_hierarchy
+{
+public:
+    path_hierarchy(const monster* mon);
+
+    bool find(monster_pathfind &mp, vector<coord_def> &crossings) const;
+
+    uint32_t movement;
+    level_id level;
+    uint32_t generation;
+
+private:
+    struct edge
+    {
+        int to;
+        int cost;
+    };
+
+    static void flood_cluster(monster_pathfind &mp, const coord_def &from,
+                              cluster_distances &dist);
+    int node_at(const coord_def &c);
+    void add_crossings(monster_pathfind &mp, const coord_def &base,
+                       const coord_def &along, const coord_def &across);
+
+    vector<coord_def> nodes;
+    vector<vector<edge>> edges;
+    map<coord_def, int> node_index;
+    vector<int> cluster_nodes[CLUSTERS_X * CLUSTERS_Y];
+};
+
+// Distances from "from" to the rest of its cluster for mp's monster, moving
+// only within the cluster.
+void path_hierarchy::flood_cluster(monster_pathfind &mp, const coord_def &from,
+                                   cluster_distances &dist)
+{
+    const coord_def corner = _cluster_corner(from);
+    for (int x = 0; x < PATH_CLUSTER; ++x)
+        for (int y = 0; y < PATH_CLUSTER; ++y)
+            dist[x][y] = INFINITE_DISTANCE;
+
+    typedef pair<int, coord_def> queued;
+    priority_queue<queued, vector<queued>, greater<queued>> queue;
+    dist[from.x - corner.x][from.y - corner.y] = 0;
+    queue.emplace(0, from);
+    while (!queue.empty())
+    {
+        const queued top = queue.top();
+        queue.pop();
+        const coord_def p = top.second;
+        if (top.first != dist[p.x - corner.x][p.y - corner.y])
+            continue;
+
+        for (adjacent_iterator ai(p); ai; ++ai)
+        {
+            const coord_def q = *ai - corner;
+            if (q.x < 0 || q.y < 0 || q.x >= PATH_CLUSTER
+                || q.y >= PATH_CLUSTER
+                || !in_bounds(*ai) || !mp.traversable_memoized(*ai))
+            {
+                continue;
+            }
+
+            mp.pos = p;
+            const int d = top.first + mp.travel_cost(*ai);
+            if (d < dist[q.x][q.y])
+            {
+                dist[q.x][q.y] = d;
+                queue.emplace(d, *ai);
+            }
+        }
+    }
+}
+
+int path_hierarchy::node_at(const coord_def &c)
+{
+    auto it = node_index.find(c);
+    if (it != node_index.end())
+        return it->second;
+
+    const int n = nodes.size();
+    nodes.push_back(c);
+    edges.emplace_back();
+    cluster_nodes[_path_cluster(c)].push_back(n);
+    node_index[c] = n;
+    return n;
+}
+
+// One pair of crossings for each run of squares along a cluster edge,
+// starting at base and going in direction along, where mp's monster can
+// step across (towards across) into the next cluster.
+void path_hierarchy::add_crossings(monster_pathfind &mp, const coord_def &base,
+                                   const coord_def &along,
+                                   const coord_def &across)
+{
+    int run = 0;
+    for (int i = 0; i <= PATH_CLUSTER; ++i)
+    {
+        const coord_def c = base + along * i;
+        const bool open = i < PATH_CLUSTER
+                          && in_bounds(c) && in_bounds(c + across)
+                          && mp.traversable_memoized(c)
+                          && mp.traversable_memoized(c + across);
+        if (open)
+        {
+            run++;
+            continue;
+        }
+        if (!run)
+            continue;
+
+        const coord_def mid = base + along * (i - 1 - run / 2);
+        const int a = node_at(mid);
+        const int b = node_at(mid + across);
+        mp.pos = mid;
+        edges[a].push_back({b, mp.travel_cost(mid + across)});
+        mp.pos = mid + across;
+        edges[b].push_back({a, mp.travel_cost(mid)});
+        run = 0;
+    }
+}
+
+path_hierarchy::path_hierarchy(const monster* mon)
+    : movement(mons_movement_class(mon)), level(level_id::current()),
+      generation(los_terrain_generation())
+{
+    monster_pathfind mp;
+    mp.mons = mon;
+    mp.traverse_unmapped = false;
+    mp.traverse_in_sight = false;
+    for (int i = 0; i < GXM; i++)
+        for (int j = 0; j < GYM; j++)
+            mp.traversable_cache[i][j] = maybe_bool::maybe;
+
+    for (int cx = 0; cx < CLUSTERS_X; ++cx)
+        for (int cy = 0; cy < CLUSTERS_Y; ++cy)
+        {
+            const coord_def corner(cx * PATH_CLUSTER, cy * PATH_CLUSTER);
+            if (cx + 1 < CLUSTERS_X)
+            {
+                add_crossings(mp, corner + coord_def(PATH_CLUSTER - 1, 0),
+                              coord_def(0, 1), coord_def(1, 0));
+            }
+            if (cy + 1 < CLUSTERS_Y)
+            {
+                add_crossings(mp, corner + coord_def(0, PATH_CLUSTER - 1),
+                              coord_def(1, 0), coord_def(0, 1));
+            }
+        }
+
+    cluster_distances dist;
+    for (const vector<int> &cluster : cluster_nodes)
+        for (int from : cluster)
+        {
+            flood_cluster(mp, nodes[from], dist);
+            const coord_def corner = _cluster_corner(nodes[from]);
+            for (int to : cluster)
+            {
+                const coord_def p = nodes[to] - corner;
+                if (to != from && dist[p.x][p.y] != INFINITE_DISTANCE)
+                    edges[from].push_back({to, dist[p.x][p.y]});
+            }
+        }
+}
+
+// The crossings to head for on the way from mp.start to mp.target, for
+// mp's monster; false if there's no route through the clusters, or start
+// and target share one.
+bool path_hierarchy::find(monster_pathfind &mp,
+                          vector<coord_def> &crossings) const
+{
+    const int from_cluster = _path_cluster(mp.start);
+    const int to_cluster = _path_cluster(mp.target);
+    if (from_cluster == to_cluster)
+        return false;
+
+    cluster_distances from_start, to_target;
+    flood_cluster(mp, mp.start, from_start);
+    // Distances to the target are taken to be the same as from it.
+    flood_cluster(mp, mp.target, to_target);
+    const coord_def start_corner = _cluster_corner(mp.start);
+    const coord_def target_corner = _cluster_corner(mp.target);
+
+    // A* over the crossings, with the target as an extra node.
+    const int goal = nodes.size();
+    vector<int> best(goal + 1, INFINITE_DISTANCE);
+    vector<int> came_from(goal + 1, -1);
+    typedef pair<int, int> queued;
+    priority_queue<queued, vector<queued>, greater<queued>> queue;
+
+    auto reach = [&](int n, int d, int from)
+    {
+        if (d >= best[n])
+            return;
+        best[n] = d;
+        came_from[n] = from;
+        const int h = n == goal ? 0 : grid_distance(nodes[n], mp.target);
+        queue.emplace(d + h, n);
+    };
+
+    for (int n : cluster_nodes[from_cluster])
+    {
+        const coord_def p = nodes[n] - start_corner;
+        if (from_start[p.x][p.y] != INFINITE_DISTANCE)
+            reach(n, from_start[p.x][p.y], -1);
+    }
+
+    while (!queue.empty())
+    {
+        const int n = queue.top().second;
+        queue.pop();
+        if (n == goal)
+            break;
+
+        for (const edge &e : edges[n])
+            reach(e.to, best[n] + e.cost, n);
+
+        if (_path_cluster(nodes[n]) == to_cluster)
+        {
+            const coord_def p = nodes[n] - target_corner;
+            if (to_target[p.x][p.y] != INFINITE_DISTANCE)
+                reach(goal, best[n] + to_target[p.x][p.y], n);
+        }
+    }
+
+    if (best[goal] == INFINITE_DISTANCE)
+        return false;
+
+    crossings.clear();
+    for (int n = came_from[goal]; n != -1; n = came_from[n])
+        crossings.push_back(nodes[n]);
+    reverse(crossings.begin(), crossings.end());
+    return true;
+}
+
+static vector<unique_ptr<path_hierarchy>> _hierarchies;
+static const size_t MAX_HIERARCHIES = 8;
+
+static const path_hierarchy &_path_hierarchy(const monster* mon)
+{
+    const level_id here = level_id::current();
+    const uint32_t generation = los_terrain_generation();
+    erase_if(_hierarchies, [&](const unique_ptr<path_hierarchy> &h)
+                           { return h->level != here
+                                    || h->generation != generation; });
+
+    const uint32_t movement = mons_movement_class(mon);
+    for (const auto &h : _hierarchies)
+        if (h->movement == movement)
+            return *h;
+
+    if (_hierarchies.size() >= MAX_HIERARCHIES)
+        _hierarchies.erase(_hierarchies.begin());
+    _hierarchies.push_back(make_unique<path_hierarchy>(mon));
+    return *_hierarchies.back();
+}
+
+// Bucket queues left behind by finished pathfinders. Monsters tracking the
+// player make a pathfinder every few turns, each needing one.
+static vector<vector<vector<coord_def>>> _open_pool;
+static const size_t MAX_POOLED_QUEUES = 4;
+
 //#define DEBUG_PATHFIND
 monster_pathfind::monster_pathfind()
     : mons(nullptr), start(), target(), pos(), allow_diagonals(true),
       traverse_unmapped(false), range(0), min_length(0), max_length(0),
-      dist(), prev(), hash(), traversable_cache()
+      dist(), prev(), open(), traversable_cache()
 {
+    if (!_open_pool.empty())
+    {
+        open.swap(_open_pool.back());
+        _open_pool.pop_back();
+    }
 }
 
 monster_pathfind::~monster_pathfind()
 {
+    if (_open_pool.size() < MAX_POOLED_QUEUES)
+        _open_pool.push_back(std::move(open));
 }
 
 void monster_pathfind::set_range(int r)
@@ -108,6 +430,18 @@ bool monster_pathfind::init_pathfind(const monster* mon, coord_def dest,
         return true;
     }
 
+    // Long unlimited searches go through the cluster graph first. Thorn
+    // hunters path through their own briars, which the graph knows nothing
+    // about.
+    if ((!range || range >= GXM) && allow_diagonals && !traverse_unmapped
+        && !traverse_in_sight
+        && mon->type != MONS_THORN_HUNTER
+        && grid_distance(start, target) > PATH_CLUSTER * 2
+        && hierarchical_path())
+    {
+        return true;
+    }
+
     return start_pathfind(msg);
 }
 
@@ -136,6 +470,10 @@ bool monster_pathfind::start_pathfind(bool msg)
     //       a wall.
 
     max_length = min_length = grid_distance(pos, target);
+    // Empty the buckets a previous search (ours, or a pooled queue's last
+    // owner) may have left, keeping their storage.
+    for (vector<coord_def> &bucket : open)
+        bucket.clear();
     for (int i = 0; i < GXM; i++)
         for (int j = 0; j < GYM; j++)
         {
@@ -149,7 +487,7 @@ bool monster_pathfind::start_pathfind(bool msg)
     do
     {
         // Calculate the distance to all neighbours of the current position,
-        // and add them to the hash, if they haven't already been looked at.
+        // and add them to the queue, if they haven't already been looked at.
         success = calc_path_to_neighbours();
         if (success)
             return true;
@@ -238,7 +576,7 @@ bool monster_pathfind::calc_path_to_neighbours()
             if (old_dist == INFINITE_DISTANCE)
             {
 #ifdef DEBUG_PATHFIND
-                mprf("Adding (%d,%d) to hash (total dist = %d)",
+                mprf("Adding (%d,%d) to queue (total dist = %d)",
                      npos.x, npos.y, total);
 #endif
                 add_new_pos(npos, total);
@@ -280,18 +618,19 @@ bool monster_pathfind::calc_path_to_neighbours()
 }
 
 // Starting at known min_length (minimum total estimated path distance), check
-// the hash for existing vectors, then pick the last entry of the first vector
-// that matches. Update min_length, if necessary.
+// the queue for non-empty buckets, then pick the last entry of the first one.
+// Update min_length, if necessary.
 bool monster_pathfind::get_best_position()
 {
-    for (int i = min_length; i <= max_length; i++)
+    const int last = min(max_length, (int) open.size() - 1);
+    for (int i = min_length; i <= last; i++)
     {
-        if (!hash[i].empty())
+        if (!open[i].empty())
         {
             if (i > min_length)
                 min_length = i;
 
-            vector<coord_def> &vec = hash[i];
+            vector<coord_def> &vec = open[i];
             // Pick the last position pushed into the vector as it's most
             // likely to be close to the target.
             pos = vec[vec.size()-1];
@@ -313,8 +652,198 @@ bool monster_pathfind::get_best_position()
     return false;
 }
 
+// A Dijkstra flood outwards from dest, with dist[] holding distances *to*
+// dest, under the same range limits start_pathfind() applies.
+void monster_pathfind::init_flow(const monster* mon, coord_def dest)
+{
+    mons   = mon;
+    start  = dest;
+    target = dest;
+    pos    = dest;
+    allow_diagonals   = true;
+    traverse_unmapped = false;
+    traverse_in_sight = false;
+
+    for (vector<coord_def> &bucket : open)
+        bucket.clear();
+    for (int i = 0; i < GXM; i++)
+        for (int j = 0; j < GYM; j++)
+        {
+            dist[i][j] = INFINITE_DISTANCE;
+            traversable_cache[i][j] = maybe_bool::maybe;
+        }
+
+    dist[dest.x][dest.y] = 0;
+    min_length = max_length = 0;
+    add_new_pos(dest, 0);
+
+    while (get_best_position())
+    {
+        const coord_def q = pos;
+        // Already reached by a shorter route.
+        if (dist[q.x][q.y] != min_length)
+            continue;
+
+        for (adjacent_iterator ai(q); ai; ++ai)
+        {
+            const coord_def p = *ai;
+            if (!in_bounds(p) || !traversable_memoized(p))
+                continue;
+
+            if (range && estimated_cost(p) > range)
+                continue;
+
+            // The cost of stepping from p to q.
+            pos = p;
+            const int distance = dist[q.x][q.y] + travel_cost(q);
+            if (range && distance > range * 2)
+                continue;
+
+            if (distance < dist[p.x][p.y])
+            {
+                dist[p.x][p.y] = distance;
+                add_new_pos(p, distance);
+                if (distance > max_length)
+                    max_length = distance;
+            }
+        }
+    }
+}
+
+// Walks down flow's distances from mon to flow's target, setting prev[] as
+// start_pathfind() would. Each step is checked against mon's own idea of
+// where it can go, since monsters sharing a flow only move alike as far as
+// we can tell; returns false if mon has to find its own way.
+bool monster_pathfind::init_from_flow(const monster* mon,
+                                      const monster_pathfind &flow)
+{
+    mons   = mon;
+    start  = mon->pos();
+    target = flow.target;
+    allow_diagonals   = true;
+    traverse_unmapped = false;
+    traverse_in_sight = false;
+
+    if (start == target)
+        return true;
+
+    if (flow.dist[start.x][start.y] == INFINITE_DISTANCE)
+        return false;
+
+    for (int i = 0; i < GXM; i++)
+        for (int j = 0; j < GYM; j++)
+            traversable_cache[i][j] = maybe_bool::maybe;
+
+    // Prefer orthogonal steps on ties, with a random rotation against bias,
+    // as calc_path_to_neighbours() does.
+    const int rotate = random2(4) * 2;
+    coord_def here = start;
+    while (here != target)
+    {
+        int best_dir = -1;
+        int best_total = INFINITE_DISTANCE;
+        for (int idir = 1; idir < 8; (idir += 2) == 9 && (idir = 0))
+        {
+            const int dir = (idir + rotate) % 8;
+            const coord_def next = here + Compass[dir];
+            if (!in_bounds(next)
+                || flow.dist[next.x][next.y] >= flow.dist[here.x][here.y])
+            {
+                continue;
+            }
+
+            if (next != target && !traversable_memoized(next))
+                continue;
+
+            if (range && estimated_cost(next) > range)
+                continue;
+
+            pos = here;
+            const int total = flow.dist[next.x][next.y] + travel_cost(next);
+            if (total <= best_total)
+            {
+                best_total = total;
+                best_dir = dir;
+            }
+        }
+
+        if (best_dir == -1)
+            return false;
+
+        here += Compass[best_dir];
+        prev[here.x][here.y] = (best_dir + 4) % 8;
+    }
+
+    pos = start;
+    return true;
+}
+
 // Using the prev vector backtrack from start to target to find all steps to
 // take along the shortest path.
+// Finds a path from start to target by way of the crossings path_hierarchy
+// picks, searching properly only from each crossing to the next. Leaves
+// prev[] as start_pathfind() would along the path, for backtrack(). False
+// if any part of that fails, in which case a full search is needed.
+bool monster_pathfind::hierarchical_path()
+{
+    for (int i = 0; i < GXM; i++)
+        for (int j = 0; j < GYM; j++)
+            traversable_cache[i][j] = maybe_bool::maybe;
+
+    vector<coord_def> crossings;
+    if (!_path_hierarchy(mons).find(*this, crossings))
+        return false;
+    crossings.push_back(target);
+
+    vector<coord_def> path(1, start);
+    for (const coord_def &next : crossings)
+    {
+        if (next == path.back())
+            continue;
+
+        monster_pathfind leg;
+        leg.mons = mons;
+        leg.start = leg.pos = path.back();
+        leg.target = next;
+        leg.allow_diagonals = true;
+        leg.traverse_unmapped = false;
+        leg.traverse_in_sight = false;
+        leg.range = PATH_CLUSTER * 2;
+        if (!leg.start_pathfind())
+            return false;
+
+        const vector<coord_def> steps = leg.backtrack();
+        path.insert(path.end(), steps.begin() + 1, steps.end());
+    }
+
+    // Legs can double back over each other near a crossing; cut out the
+    // loops that makes.
+    map<coord_def, int> seen;
+    vector<coord_def> route;
+    for (const coord_def &c : path)
+    {
+        auto it = seen.find(c);
+        if (it != seen.end())
+        {
+            for (size_t i = it->second + 1; i < route.size(); ++i)
+                seen.erase(route[i]);
+            route.resize(it->second + 1);
+            continue;
+        }
+        seen[c] = route.size();
+        route.push_back(c);
+    }
+
+    for (size_t i = 1; i < route.size(); ++i)
+    {
+        const coord_def back = route[i - 1] - route[i];
+        for (int dir = 0; dir < 8; ++dir)
+            if (Compass[dir] == back)
+                prev[route[i].x][route[i].y] = dir;
+    }
+    return true;
+}
+
 vector<coord_def> monster_pathfind::backtrack()
 {
 #ifdef DEBUG_PATHFIND
@@ -495,16 +1024,18 @@ int monster_pathfind::estimated_cost(coord_def p)
 
 void monster_pathfind::add_new_pos(coord_def npos, int total)
 {
-    hash[total].push_back(npos);
+    if (total >= (int) open.size())
+        open.resize(total + 1);
+    open[total].push_back(npos);
 }
 
 void monster_pathfind::update_pos(coord_def npos, int total)
 {
-    // Find hash position of old distance and delete it,
-    // then call_add_new_pos.
+    // Find the bucket for the old distance and delete it from there,
+    // then call add_new_pos.
     int old_total = dist[npos.x][npos.y] + estimated_cost(npos);
 
-    vector<coord_def> &vec = hash[old_total];
+    vector<coord_def> &vec = open[old_total];
     for (unsigned int i = 0; i < vec.size(); i++)
     {
         if (vec[i] == npos)
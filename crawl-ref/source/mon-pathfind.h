@@ -2,7 +2,6 @@
 
 #include "coord-def.h"
 #include "defines.h"
-#include "fixedvector.h"
 #include "maybe-bool.h"
 #include <unordered_map>
 #include <vector>
@@ -12,9 +11,12 @@ using std::vector;
 class monster;
 
 int mons_tracking_range(const monster* mon);
+uint32_t mons_movement_class(const monster* mon);
 
 class monster_pathfind
 {
+    friend class path_hierarchy;
+
 public:
     monster_pathfind();
     virtual ~monster_pathfind();
@@ -31,9 +33,16 @@ public:
     vector<coord_def> backtrack();
     vector<coord_def> calc_waypoints();
 
+    // Instead of finding one path, work out the distance to dest from
+    // everywhere within range of it, for hostile monsters that move like
+    // mon. init_from_flow() then finds their paths without searching.
+    void init_flow(const monster* mon, coord_def dest);
+    bool init_from_flow(const monster* mon, const monster_pathfind &flow);
+
 protected:
     // protected methods
     bool calc_path_to_neighbours();
+    bool hierarchical_path();
     bool traversable(const coord_def& p);
     bool traversable_memoized(const coord_def& p);
     int  travel_cost(coord_def npos);
@@ -71,10 +80,13 @@ protected:
 
     // The array of distances from start to any already tried point.
     int dist[GXM][GYM];
-    // An array to store where we came from on a given shortest path.
-    int prev[GXM][GYM];
+    // The Compass direction we came from on a given shortest path.
+    int8_t prev[GXM][GYM];
 
-    FixedVector<vector<coord_def>, GXM * GYM> hash;
+    // Positions still to be looked at, bucketed by their estimated total
+    // path length. The buckets are borrowed from a pool and reused, so that
+    // making a pathfinder doesn't mean allocating one per possible length.
+    vector<vector<coord_def>> open;
 
     maybe_bool traversable_cache[GXM][GYM];
 };
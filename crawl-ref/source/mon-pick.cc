@@ -64,13 +64,59 @@ monster_type pick_monster_by_hash(branch_type branch, uint32_t hash)
     return population[branch][hash % population[branch].size()].value;
 }
 
+// The running total of rarities of a branch's population at one depth. A
+// pick that nothing vetoes then finds, for the same roll, the same monster
+// as random_picker::pick() would, by a binary search rather than by working
+// out every rarity again.
+struct pick_table
+{
+    vector<int> cumulative;
+    vector<monster_type> monsters;
+};
+
+static const pick_table &_pick_table(const level_id &place)
+{
+    static map<level_id, pick_table> tables;
+
+    auto it = tables.find(place);
+    if (it != tables.end())
+        return it->second;
+
+    pick_table &table = tables[place];
+    monster_picker picker;
+    int total = 0;
+    for (const pop_entry &pop : population[place.branch])
+    {
+        if (place.depth < pop.minr || place.depth > pop.maxr)
+            continue;
+
+        const int rar = picker.rarity_at(pop, place.depth);
+        ASSERTM(rar > 0, "Rarity %d: %d at level %d", rar, pop.value,
+                place.depth);
+        total += rar;
+        table.cumulative.push_back(total);
+        table.monsters.push_back(pop.value);
+    }
+    return table;
+}
+
 monster_type pick_monster(level_id place, mon_pick_vetoer veto)
 {
 #ifdef ASSERTS
     if (!place.is_valid())
         die("trying to pick a monster from %s", place.describe().c_str());
 #endif
-    return pick_monster_from(population[place.branch], place.depth, veto);
+    if (veto)
+        return pick_monster_from(population[place.branch], place.depth, veto);
+
+    const pick_table &table = _pick_table(place);
+    if (table.monsters.empty())
+        return MONS_0;
+
+    const int roll = random2(table.cumulative.back());
+    auto it = upper_bound(table.cumulative.begin(), table.cumulative.end(),
+                          roll);
+    return table.monsters[it - table.cumulative.begin()];
 }
 
 monster_type pick_monster(level_id place, monster_picker &picker, mon_pick_vetoer veto)
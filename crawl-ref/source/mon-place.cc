@@ -906,21 +906,35 @@ static monster* _place_monster_aux(const mgen_data &mg, const monster *leader,
     }
     else
     {
+        // Every try lands in the 7x7 box around mg.pos, and nothing changes
+        // between tries; so each square is only checked the first time it
+        // comes up. A crowded box used to be checked a thousand times over
+        // for each band member, with a search for nearby stairs each time
+        // for PROX_AWAY_FROM_STAIRS. The rolls are the same as ever.
+        maybe_bool tried[7][7];
+        for (auto &column : tried)
+            for (auto &square : column)
+                square = maybe_bool::maybe;
+
         int i;
         // We'll try 1000 times for a good spot.
         for (i = 0; i < 1000; ++i)
         {
-            fpos = mg.pos;
-            fpos.x += random_range(-3, 3);
-            fpos.y += random_range(-3, 3);
+            const int dx = random_range(-3, 3);
+            const int dy = random_range(-3, 3);
+            fpos = mg.pos + coord_def(dx, dy);
 
+            maybe_bool &good = tried[dx + 3][dy + 3];
             // Place members within LOS_SOLID of their leader.
             // TODO nfm - allow placing around corners but not across walls.
-            if ((leader == 0 || cell_see_cell(fpos, leader->pos(), LOS_SOLID))
-                && _valid_monster_generation_location(mg, fpos))
+            if (good == maybe_bool::maybe)
             {
-                break;
+                good = (leader == 0
+                        || cell_see_cell(fpos, leader->pos(), LOS_SOLID))
+                       && _valid_monster_generation_location(mg, fpos);
             }
+            if (good == maybe_bool::t)
+                break;
         }
 
         // Did we really try 1000 times?
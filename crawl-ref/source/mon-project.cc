@@ -59,6 +59,7 @@ spret cast_iood(actor *caster, int pow, bolt *beam, float vx, float vy,
     if (beam)
     {
         beam->choose_ray();
+        beam->ray.sync();
 #ifdef DEBUG_DIAGNOSTICS
         const coord_def pos = caster->pos();
         dprf("beam (%d,%d)+t*(%d,%d)  ray (%f,%f)+t*(%f,%f)",
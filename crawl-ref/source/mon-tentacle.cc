@@ -209,10 +209,10 @@ const monster& get_tentacle_head(const monster& mon)
 
 static void _establish_connection(monster* tentacle,
                                   monster* head,
-                                  set<position_node>::iterator path,
+                                  const position_node * path,
                                   monster_type connector_type)
 {
-    const position_node * last = &(*path);
+    const position_node * last = path;
     const position_node * current = last->last;
 
     // Tentacle is adjacent to the end position, not much to do.
@@ -546,12 +546,69 @@ static bool _tentacle_pathfind(monster* tentacle,
     return path_found;
 }
 
+// Try to reuse the chain the tentacle had before moving, old_chain being
+// the squares its end and then each segment were on, going inwards. The
+// end is joined to the innermost segment it's next to (or moved onto), and
+// the chain is cut short at the first segment next to the base, which
+// covers the usual moves of reaching one step further, retracting one step,
+// staying put, and the head stepping along. The squares kept must still be
+// free. Returns false, leaving the full search to be done, if that doesn't
+// give a chain; otherwise path holds the squares in between, outwards in.
+static bool _repair_tentacle_path(const coord_def & new_pos,
+                                  const coord_def & base_position,
+                                  const monster* tentacle,
+                                  const vector<coord_def> & old_chain,
+                                  vector<coord_def> & path)
+{
+    path.clear();
+    if (adjacent(new_pos, base_position))
+        return true;
+
+    int start = -1;
+    for (int i = old_chain.size() - 1; i >= 0; --i)
+    {
+        if (old_chain[i] == new_pos)
+        {
+            start = i + 1;
+            break;
+        }
+        if (adjacent(old_chain[i], new_pos))
+        {
+            start = i;
+            break;
+        }
+    }
+    if (start < 0)
+        return false;
+
+    for (int i = start; i < (int) old_chain.size(); ++i)
+    {
+        const coord_def &pos = old_chain[i];
+        if (pos == base_position)
+            break;
+        if (pos == new_pos
+            || !in_bounds(pos)
+            || !tentacle->is_habitable(pos)
+            || actor_at(pos))
+        {
+            return false;
+        }
+        path.push_back(pos);
+        if (adjacent(pos, base_position))
+            return true;
+    }
+
+    // The base has moved away from what's left of the old chain.
+    return false;
+}
+
 static bool _try_tentacle_connect(const coord_def & new_pos,
                                   const coord_def & base_position,
                                   monster* tentacle,
                                   monster* head,
                                   tentacle_connect_constraints & connect_costs,
-                                  monster_type connect_type)
+                                  monster_type connect_type,
+                                  const vector<coord_def> & old_chain)
 {
     // Nothing to do here.
     // Except fix the tentacle end's pointer, idiot.
@@ -564,6 +621,28 @@ static bool _try_tentacle_connect(const coord_def & new_pos,
         return true;
     }
 
+    // Most moves only change the chain at its ends, so patch up the old one
+    // rather than searching for a new one each turn.
+    vector<coord_def> repaired;
+    if (_repair_tentacle_path(new_pos, base_position, tentacle, old_chain,
+                              repaired))
+    {
+        // Nodes run from the end inwards, each pointing at the one before,
+        // as a search from the end would leave them.
+        vector<position_node> nodes(repaired.size() + 2);
+        nodes[0].pos = new_pos;
+        for (unsigned int i = 0; i < repaired.size(); ++i)
+        {
+            nodes[i + 1].pos = repaired[i];
+            nodes[i + 1].last = &nodes[i];
+        }
+        nodes.back().pos = base_position;
+        nodes.back().last = &nodes[nodes.size() - 2];
+
+        _establish_connection(tentacle, head, &nodes.back(), connect_type);
+        return true;
+    }
+
     int start_level = 0;
     // This condition should never miss
     if (auto constraint = map_find(*connect_costs.connection_constraints,
@@ -591,7 +670,7 @@ static bool _try_tentacle_connect(const coord_def & new_pos,
     if (candidates.empty())
         return false;
 
-    _establish_connection(tentacle, head, candidates[0], connect_type);
+    _establish_connection(tentacle, head, &*candidates[0], connect_type);
 
     return true;
 }
@@ -653,7 +732,8 @@ static void _collect_foe_positions(monster *mons,
 // give the kraken head's position as a retract pos.
 static int _collect_connection_data(monster* start_monster,
                map<coord_def, set<int> > & connection_data,
-               coord_def & retract_pos)
+               coord_def & retract_pos,
+               vector<coord_def> & chain)
 {
     int current_count = 0;
     monster* current_mon = start_monster;
@@ -663,6 +743,7 @@ static int _collect_connection_data(monster* start_monster,
 
     while (current_mon)
     {
+        chain.push_back(current_mon->pos());
         for (adjacent_iterator adj_it(current_mon->pos(), false);
              adj_it; ++adj_it)
         {
@@ -721,10 +802,12 @@ void move_solo_tentacle(monster* tentacle)
 
     coord_def retract_pos;
     map<coord_def, set<int> > connection_data;
+    vector<coord_def> old_chain;
 
     int visited_count = _collect_connection_data(tentacle,
                                                  connection_data,
-                                                 retract_pos);
+                                                 retract_pos,
+                                                 old_chain);
 
     bool retract_found = retract_pos.x != -1 && retract_pos.y != -1;
 
@@ -902,7 +985,8 @@ void move_solo_tentacle(monster* tentacle)
     bool connected = _try_tentacle_connect(new_pos, base_position,
                                            tentacle, tentacle,
                                            connect_costs,
-                                           mons_tentacle_child_type(tentacle));
+                                           mons_tentacle_child_type(tentacle),
+                                           old_chain);
 
     if (!connected)
     {
@@ -964,6 +1048,7 @@ void move_child_tentacles(monster* mons)
 
         tentacle_connect_constraints connect_costs;
         map<coord_def, set<int> > connection_data;
+        vector<coord_def> old_chain;
 
         monster* current_mon = tentacle;
         int current_count = 0;
@@ -972,6 +1057,7 @@ void move_child_tentacles(monster* mons)
 
         while (current_mon)
         {
+            old_chain.push_back(current_mon->pos());
             for (adjacent_iterator adj_it(current_mon->pos(), false);
                  adj_it; ++adj_it)
             {
@@ -1094,7 +1180,8 @@ void move_child_tentacles(monster* mons)
         bool connected = _try_tentacle_connect(new_pos, mons->pos(),
                                 tentacle, mons,
                                 connect_costs,
-                                mons_tentacle_child_type(tentacle));
+                                mons_tentacle_child_type(tentacle),
+                                old_chain);
 
         // Can't connect, usually the head moved and invalidated our position
         // in some way. Should look into this more at some point -cao
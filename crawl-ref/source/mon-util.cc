@@ -52,6 +52,7 @@
 #include "mon-poly.h"
 #include "mon-tentacle.h"
 #include "mutant-beast.h"
+#include "name-table.h"
 #include "notes.h"
 #include "options.h"
 #include "random.h"
@@ -72,7 +73,10 @@
 #include "unicode.h"
 #include "unwind.h"
 
-static FixedVector < int, NUM_MONSTERS > mon_entry;
+// The mondata entry for each monster type, and a copy of its flags, which
+// get tested far more often than anything else in it.
+static FixedVector < monsterentry *, NUM_MONSTERS > mon_entry;
+static FixedVector < monclass_flags_t, NUM_MONSTERS > mon_class_flags;
 
 struct mon_display
 {
@@ -196,14 +200,14 @@ monster_type random_monster_at_grid(const coord_def& p, bool species)
                               : valid_mons[ random2(valid_mons.size()) ];
 }
 
-typedef map<string, monster_type> mon_name_map;
-static mon_name_map Mon_Name_Cache;
+static name_table<monster_type> Mon_Name_Cache;
 
 void init_mon_name_cache()
 {
     if (!Mon_Name_Cache.empty())
         return;
 
+    map<string, monster_type> names;
     for (const monsterentry &me : mondata)
     {
         string name = me.name;
@@ -215,7 +219,7 @@ void init_mon_name_cache()
         // Deal sensibly with duplicate entries; refuse or allow the
         // insert, depending on which should take precedence. Some
         // uniques of multiple forms can get away with this, though.
-        if (Mon_Name_Cache.count(name))
+        if (names.count(name))
         {
             if (mon == MONS_PLAYER_SHADOW
                 || mon == MONS_BAI_SUZHEN_DRAGON
@@ -229,8 +233,9 @@ void init_mon_name_cache()
                 die("Un-handled duplicate monster name: %s", name.c_str());
         }
 
-        Mon_Name_Cache[name] = mon;
+        names[name] = mon;
     }
+    Mon_Name_Cache = name_table<monster_type>(names);
 }
 
 static const char *_mon_entry_name(size_t idx)
@@ -247,9 +252,7 @@ monster_type get_monster_by_name(string name, bool substring)
 
     if (!substring)
     {
-        if (monster_type *mc = map_find(Mon_Name_Cache, name))
-            return *mc;
-        return MONS_PROGRAM_BUG;
+        return Mon_Name_Cache.get(name, MONS_PROGRAM_BUG);
     }
 
     size_t idx = find_earliest_match(name, (size_t) 0, ARRAYSZ(mondata),
@@ -261,17 +264,20 @@ monster_type get_monster_by_name(string name, bool substring)
 void init_monsters()
 {
     // First, fill static array with dummy values. {dlb}
-    mon_entry.init(-1);
+    mon_entry.init(nullptr);
 
     // Next, fill static array with location of entry in mondata[]. {dlb}:
-    for (unsigned int i = 0; i < MONDATASIZE; ++i)
-        mon_entry[mondata[i].mc] = i;
+    for (monsterentry &me : mondata)
+        mon_entry[me.mc] = &me;
 
     // Finally, monsters yet with dummy entries point to TTTSNB(tm). {dlb}:
-    for (int &entry : mon_entry)
-        if (entry == -1)
+    for (monsterentry *&entry : mon_entry)
+        if (!entry)
             entry = mon_entry[MONS_PROGRAM_BUG];
 
+    for (int mc = 0; mc < NUM_MONSTERS; ++mc)
+        mon_class_flags[mc] = mon_entry[mc]->bitfields;
+
     init_monster_symbols();
 }
 
@@ -442,8 +448,7 @@ monster* monster_at(const coord_def &pos)
 /// Are any of the bits set?
 bool mons_class_flag(monster_type mc, monclass_flags_t bits)
 {
-    const monsterentry * const me = get_monster_data(mc);
-    return me && (me->bitfields & bits);
+    return mc >= 0 && mc < NUM_MONSTERS && (mon_class_flags[mc] & bits);
 }
 
 int monster::wearing(equipment_type slot, int sub_type) const
@@ -1570,13 +1575,40 @@ bool mons_resists_drowning(monster_type type, monster_type base)
     return mons_is_unbreathing(type) || ht == HT_WATER || ht == HT_AMPHIBIOUS;
 }
 
-char32_t mons_char(monster_type mc)
+// Options.mon_glyph_overrides by monster type, so that drawing monsters
+// doesn't search the map each time; see _feat_override() in feature.cc.
+static cglyph_t mon_overrides[NUM_MONSTERS];
+static unsigned int mon_overrides_version = 0;
+
+/**
+ * The glyph and colour the mon_glyph option gives a monster type.
+ *
+ * @param mc    The monster type.
+ * @return      The override; either field is 0 where it isn't overridden.
+ */
+const cglyph_t &mons_glyph_override(monster_type mc)
 {
-    if (Options.mon_glyph_overrides.count(mc)
-        && Options.mon_glyph_overrides[mc].ch)
+    static const cglyph_t none(0, 0);
+
+    if (mon_overrides_version != Options.glyph_overrides_version)
     {
-        return Options.mon_glyph_overrides[mc].ch;
+        for (cglyph_t &over : mon_overrides)
+            over = none;
+        for (const auto &entry : Options.mon_glyph_overrides)
+            if (entry.first >= 0 && entry.first < NUM_MONSTERS)
+                mon_overrides[entry.first] = entry.second;
+        mon_overrides_version = Options.glyph_overrides_version;
     }
+
+    if (mc < 0 || mc >= NUM_MONSTERS)
+        return none;
+    return mon_overrides[mc];
+}
+
+char32_t mons_char(monster_type mc)
+{
+    if (char32_t over = mons_glyph_override(mc).ch)
+        return over;
     else
         return monster_symbols[mc].glyph;
 }
@@ -1606,12 +1638,8 @@ int mons_class_colour(monster_type mc)
     ASSERT_smc();
     // Player monster is a dummy monster used only for display purposes, so
     // it's ok to override it here.
-    if (mc == MONS_PLAYER
-        && Options.mon_glyph_overrides.count(MONS_PLAYER)
-        && Options.mon_glyph_overrides[MONS_PLAYER].col)
-    {
-        return Options.mon_glyph_overrides[MONS_PLAYER].col;
-    }
+    if (mc == MONS_PLAYER && mons_glyph_override(MONS_PLAYER).col)
+        return mons_glyph_override(MONS_PLAYER).col;
     else
         return monster_symbols[mc].colour;
 }
@@ -3220,7 +3248,7 @@ bool give_monster_proper_name(monster& mon, bool orcs_only)
 monsterentry *get_monster_data(monster_type mc)
 {
     if (mc >= 0 && mc < NUM_MONSTERS)
-        return &mondata[mon_entry[mc]];
+        return mon_entry[mc];
     else
         return nullptr;
 }
@@ -3688,6 +3716,20 @@ bool mons_should_fire(bolt &beam, bool ignore_good_idea)
     return beam.good_to_fire() >= ai_action::good();
 }
 
+// Whether mons_should_fire() is sure to turn down mons firing beam, however
+// the tracer turns out, so that there's no need to fire one.
+bool mons_wont_fire(const monster &mons, const bolt &beam,
+                    bool ignore_good_idea)
+{
+    if (_beneficial_beam_flavour(beam.flavour))
+        return false;
+
+    if (is_sanctuary(you.pos()) || is_sanctuary(mons.pos()))
+        return true;
+
+    return !ignore_good_idea && mons.friendly() && beam.target == you.pos();
+}
+
 /**
  * Can monsters use the given spell effectively from range? (If a monster has
  * the given spell, should it try to keep its distance from its enemies?)
@@ -330,6 +330,7 @@ void name_zombie(monster& mon, const monster& orig);
 
 int mons_power(monster_type mc);
 
+const cglyph_t &mons_glyph_override(monster_type mc);
 char32_t mons_char(monster_type mc);
 char mons_base_char(monster_type mc);
 
@@ -347,6 +348,8 @@ void mons_pacify(monster& mon, mon_attitude_type att = ATT_GOOD_NEUTRAL,
                  bool no_xp = false);
 
 bool mons_should_fire(bolt &beam, bool ignore_good_idea = false);
+bool mons_wont_fire(const monster &mons, const bolt &beam,
+                    bool ignore_good_idea = false);
 
 bool mons_has_los_ability(monster_type mon_type);
 bool mons_has_ranged_spell(const monster& mon, bool attack_only = false,
@@ -122,6 +122,10 @@ monster &monster::operator = (const monster& mon)
 
 void monster::reset()
 {
+    // Whatever goes into this slot next, monster_iterator has to see it.
+    if (this >= env.mons.buffer() && this < env.mons.buffer() + MAX_MONSTERS)
+        note_monster_slot(mindex());
+
     mname.clear();
     enchantments.clear();
     ench_cache.reset();
@@ -0,0 +1,80 @@
+/**
+ * @file
+ * @brief Compact, read-only tables of names.
+**/
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+using std::map;
+using std::pair;
+using std::string;
+using std::vector;
+
+// A sorted, immutable name -> value table, for the lookup caches built at
+// startup (item, monster and spell names). It is built in one go from a
+// map, after which every name lives in a single string pool and each entry
+// is an offset into it, rather than a tree node with a string of its own.
+// Lookups are a binary search.
+template<typename T>
+class name_table
+{
+public:
+    name_table() { }
+
+    explicit name_table(const map<string, T> &names)
+    {
+        m_entries.reserve(names.size());
+        for (const auto &name : names)
+        {
+            m_entries.emplace_back(m_pool.size(), name.second);
+            m_pool += name.first;
+            m_pool += '\0';
+        }
+        m_pool.shrink_to_fit();
+    }
+
+    const T *find(const string &name) const
+    {
+        auto it = lower_bound(m_entries.begin(), m_entries.end(), name,
+                              [this](const entry &e, const string &key)
+                              {
+                                  return key.compare(_name(e)) > 0;
+                              });
+        if (it == m_entries.end() || name != _name(*it))
+            return nullptr;
+        return &it->second;
+    }
+
+    T get(const string &name, T unknown) const
+    {
+        const T *value = find(name);
+        return value ? *value : unknown;
+    }
+
+    bool empty() const { return m_entries.empty(); }
+    size_t size() const { return m_entries.size(); }
+
+    void clear()
+    {
+        m_pool.clear();
+        m_entries.clear();
+    }
+
+private:
+    typedef pair<unsigned int, T> entry;
+
+    const char *_name(const entry &e) const
+    {
+        return m_pool.c_str() + e.first;
+    }
+
+    string m_pool;
+    vector<entry> m_entries;
+};
@@ -9,6 +9,7 @@
 
 #include <cfloat>
 #include <cmath>
+#include <unordered_map>
 
 #include "abyss.h"
 #include "act-iter.h"
@@ -89,7 +90,7 @@ static bool _mons_has_path_to_player(const monster* mon)
     return false;
 }
 
-bool mons_can_hurt_player(const monster* mon)
+static bool _mons_can_hurt_player(const monster* mon)
 {
     // FIXME: This takes into account whether the player knows the map!
     //        It should, for the purposes of i_feel_safe. [rob]
@@ -115,6 +116,40 @@ bool mons_can_hurt_player(const monster* mon)
     return false;
 }
 
+// Whether monsters could hurt the player, as worked out since time last
+// passed. Run, rest and explore ask about every monster in view on each
+// step, and so does every monster_info, so without this the same
+// pathfinding gets done many times over between two player turns. A
+// verdict is only kept while neither the monster nor the player moves.
+static struct
+{
+    int elapsed_time = -1;
+    level_id place;
+    coord_def you_pos;
+    unordered_map<mid_t, pair<coord_def, bool>> verdicts;
+} _hurt_cache;
+
+bool mons_can_hurt_player(const monster* mon)
+{
+    if (_hurt_cache.elapsed_time != you.elapsed_time
+        || _hurt_cache.place != level_id::current()
+        || _hurt_cache.you_pos != you.pos())
+    {
+        _hurt_cache.elapsed_time = you.elapsed_time;
+        _hurt_cache.place = level_id::current();
+        _hurt_cache.you_pos = you.pos();
+        _hurt_cache.verdicts.clear();
+    }
+
+    auto it = _hurt_cache.verdicts.find(mon->mid);
+    if (it != _hurt_cache.verdicts.end() && it->second.first == mon->pos())
+        return it->second.second;
+
+    const bool can_hurt = _mons_can_hurt_player(mon);
+    _hurt_cache.verdicts[mon->mid] = make_pair(mon->pos(), can_hurt);
+    return can_hurt;
+}
+
 // Returns true if a monster can be considered safe regardless
 // of distance.
 static bool _mons_is_always_safe(const monster *mon)
@@ -148,7 +183,9 @@ bool mons_is_safe(const monster* mon, const bool want_move,
                            // monsters capable of throwing or zapping wands.
                            || !mons_can_hurt_player(mon)));
 
-    if (consider_user_options)
+    static lua_hook mon_is_safe("ch_mon_is_safe");
+    // Most players don't define the hook, and a monster_info isn't cheap.
+    if (consider_user_options && mon_is_safe.defined(clua))
     {
         bool moving = you_are_delayed()
                        && current_delay()->is_run()
@@ -159,9 +196,8 @@ bool mons_is_safe(const monster* mon, const bool want_move,
         bool result = is_safe;
 
         monster_info mi(mon, MILEV_SKIP_SAFE);
-        if (clua.callfn("ch_mon_is_safe", "Ibbd>b",
-                        &mi, is_safe, moving, dist,
-                        &result))
+        if (mon_is_safe.call_returning(clua, result, &mi, is_safe, moving,
+                                       dist))
         {
             is_safe = result;
         }
@@ -330,8 +366,11 @@ bool i_feel_safe(bool announce, bool want_move, bool just_monsters,
 
 bool can_rest_here(bool announce)
 {
-    // XXX: consider doing a check for whether your regen is *ever* inhibited
-    // before iterating over each monster.
+    // Resting checks this every turn; don't look at every monster in view
+    // when none of them could stop it.
+    if (!regeneration_can_be_inhibited())
+        return true;
+
     vector<monster*> visible;
     bool sensed = false;
     for (monster_near_iterator mi(you.pos(), LOS_NO_TRANS); mi; ++mi)
@@ -0,0 +1,93 @@
+/**
+ * @file
+ * @brief An allocator for node-based containers that recycles its nodes.
+**/
+
+#include "AppHdr.h"
+
+#include "node-pool.h"
+
+#include <map>
+
+// Nodes per block.
+#define NODE_POOL_BLOCK 1024
+
+size_t node_pool::total_bytes = 0;
+size_t node_pool::peak = 0;
+
+static map<size_t, node_pool *> &_pools()
+{
+    static map<size_t, node_pool *> pools;
+    return pools;
+}
+
+node_pool &node_pool::of_size(size_t node_size)
+{
+    // Room for the free list link, and keep every node suitably aligned.
+    const size_t align = 2 * sizeof(void *);
+    node_size = max(node_size, sizeof(void *));
+    node_size = (node_size + align - 1) / align * align;
+
+    node_pool *&pool = _pools()[node_size];
+    if (!pool)
+        pool = new node_pool(node_size);
+    return *pool;
+}
+
+node_pool::node_pool(size_t node_size)
+    : size(node_size), in_use(0), block_used(NODE_POOL_BLOCK),
+      free_list(nullptr)
+{
+}
+
+void *node_pool::get()
+{
+    ++in_use;
+    if (free_list)
+    {
+        void *node = free_list;
+        free_list = *static_cast<void **>(node);
+        return node;
+    }
+
+    if (block_used == NODE_POOL_BLOCK)
+    {
+        blocks.push_back(static_cast<char *>(
+            ::operator new(NODE_POOL_BLOCK * size)));
+        block_used = 0;
+        total_bytes += NODE_POOL_BLOCK * size;
+        peak = max(peak, total_bytes);
+    }
+    return blocks.back() + size * block_used++;
+}
+
+void node_pool::put(void *node)
+{
+    ASSERT(in_use);
+    --in_use;
+    *static_cast<void **>(node) = free_list;
+    free_list = node;
+}
+
+void node_pool::release()
+{
+    if (in_use)
+        return;
+    for (char *block : blocks)
+        ::operator delete(block);
+    total_bytes -= blocks.size() * NODE_POOL_BLOCK * size;
+    blocks.clear();
+    block_used = NODE_POOL_BLOCK;
+    free_list = nullptr;
+}
+
+void node_pool::release_all()
+{
+    for (auto &entry : _pools())
+        entry.second->release();
+}
+
+size_t node_pool::peak_bytes()
+{
+    return peak;
+}
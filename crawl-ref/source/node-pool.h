@@ -0,0 +1,90 @@
+/**
+ * @file
+ * @brief An allocator for node-based containers that recycles its nodes.
+**/
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+using std::vector;
+
+// All nodes of one size come from one pool: they are carved out of large
+// blocks, and freed ones go on a list to be handed out again rather than
+// back to the heap. The level builder's pathfinding inserts and erases a
+// set node for nearly every square it looks at, which would otherwise be as
+// many trips to malloc and free.
+class node_pool
+{
+public:
+    static node_pool &of_size(size_t node_size);
+
+    void *get();
+    void put(void *node);
+
+    // Give every block back to the heap, in every pool that has no node in
+    // use; called between builder attempts.
+    static void release_all();
+    // The most memory all the pools have held at once.
+    static size_t peak_bytes();
+
+private:
+    explicit node_pool(size_t node_size);
+    void release();
+
+    size_t size;
+    size_t in_use;
+    vector<char *> blocks;
+    size_t block_used;          // nodes handed out from the last block
+    void *free_list;
+
+    static size_t total_bytes;
+    static size_t peak;
+};
+
+// A std::allocator stand-in that takes single nodes from node_pool.
+template<typename T>
+struct pool_allocator
+{
+    typedef T value_type;
+
+    pool_allocator() { }
+    template<typename U>
+    pool_allocator(const pool_allocator<U> &) { }
+
+    T *allocate(size_t n)
+    {
+        if (n != 1)
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        return static_cast<T *>(pool().get());
+    }
+
+    void deallocate(T *p, size_t n)
+    {
+        if (n != 1)
+            ::operator delete(p);
+        else
+            pool().put(p);
+    }
+
+private:
+    static node_pool &pool()
+    {
+        static node_pool &nodes = node_pool::of_size(sizeof(T));
+        return nodes;
+    }
+};
+
+template<typename T, typename U>
+bool operator==(const pool_allocator<T> &, const pool_allocator<U> &)
+{
+    return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const pool_allocator<T> &, const pool_allocator<U> &)
+{
+    return false;
+}
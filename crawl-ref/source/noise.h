@@ -144,4 +144,7 @@ private:
     FixedArray<noise_cell, GXM, GYM> cells;
     vector<noise_t> noises;
     int affected_actor_count;
+    // The cells the noise reached last step and will reach next; kept
+    // here so their storage is reused.
+    vector<coord_def> noise_perimeter[2];
 };
@@ -31,6 +31,27 @@
 vector<Note> note_list;
 int last_screen_turn = -1;
 
+// The notes chunk of a restored game, not unmarshalled until something
+// needs to look at note_list.  See load_notes_lazily().
+static vector<unsigned char> undecoded_notes;
+static int undecoded_notes_minor = TAG_MINOR_INVALID;
+
+// The marshalled form of the first encoded_notes_count notes of note_list,
+// in the current format, without the header: notes are only ever added, so
+// a save only has to marshall those taken since the last one.
+static vector<unsigned char> encoded_notes;
+static size_t encoded_notes_count = 0;
+
+static unsigned int note_generation = 0;
+
+unsigned int notes_generation()
+{
+    return note_generation;
+}
+
+// The version and count at the start of a notes chunk.
+#define NOTES_HEADER_SIZE 8
+
 static bool _is_highest_skill(int skill)
 {
     for (int i = 0; i < NUM_SKILLS; ++i)
@@ -149,6 +170,7 @@ static bool _is_noteworthy(const Note& note)
     if (note.type == NOTE_DUNGEON_LEVEL_CHANGE)
         return _is_noteworthy_dlevel(note.place);
 
+    ensure_notes_loaded();
     for (const Note &oldnote : note_list)
     {
         if (oldnote.type != note.type)
@@ -497,6 +519,7 @@ void take_note(const Note& note, bool force)
     if (notes_active && (force || _is_noteworthy(note)))
     {
         note_list.push_back(note);
+        ++note_generation;
         note.check_milestone();
     }
 }
@@ -506,12 +529,57 @@ void activate_notes(bool active)
     notes_active = active;
 }
 
+// How many notes a chunk holds, if it is in the current format.
+static bool _current_notes_chunk(const vector<unsigned char> &chunk,
+                                 int minor, int &count)
+{
+    if (minor != TAG_MINOR_VERSION || chunk.size() < NOTES_HEADER_SIZE)
+        return false;
+    reader inf(chunk, minor);
+    if (unmarshallInt(inf) != NOTES_VERSION_NUMBER)
+        return false;
+    count = unmarshallInt(inf);
+    return true;
+}
+
 void save_notes(writer& outf)
 {
+    // Nothing has looked at the old notes since they were loaded: write them
+    // back as they were, followed by any taken since.
+    int old_count;
+    if (!undecoded_notes.empty()
+        && _current_notes_chunk(undecoded_notes, undecoded_notes_minor,
+                                old_count))
+    {
+        marshallInt(outf, NOTES_VERSION_NUMBER);
+        marshallInt(outf, old_count + note_list.size());
+        outf.write(undecoded_notes.data() + NOTES_HEADER_SIZE,
+                   undecoded_notes.size() - NOTES_HEADER_SIZE);
+        for (const Note &note : note_list)
+            note.save(outf);
+        return;
+    }
+
+    ensure_notes_loaded();
+
+    // Something started the list over.
+    if (encoded_notes_count > note_list.size())
+    {
+        encoded_notes.clear();
+        encoded_notes_count = 0;
+    }
+    if (encoded_notes_count < note_list.size())
+    {
+        writer encoded(&encoded_notes);
+        for (size_t i = encoded_notes_count; i < note_list.size(); ++i)
+            note_list[i].save(encoded);
+        encoded_notes_count = note_list.size();
+    }
+
     marshallInt(outf, NOTES_VERSION_NUMBER);
     marshallInt(outf, note_list.size());
-    for (const Note &note : note_list)
-        note.save(outf);
+    if (!encoded_notes.empty())
+        outf.write(encoded_notes.data(), encoded_notes.size());
 }
 
 void load_notes(reader& inf)
@@ -528,6 +596,54 @@ void load_notes(reader& inf)
     }
 }
 
+// Keep the raw notes chunk around and unmarshall it only once note_list is
+// first needed, as most sessions never look at old notes.  Notes taken in
+// the meantime are appended to note_list and end up after the old ones.
+void load_notes_lazily(vector<unsigned char> data, int minorVersion)
+{
+    undecoded_notes.swap(data);
+    undecoded_notes_minor = minorVersion;
+    ++note_generation;
+}
+
+void ensure_notes_loaded()
+{
+    if (undecoded_notes.empty())
+        return;
+
+    vector<Note> taken_since;
+    taken_since.swap(note_list);
+    {
+        reader inf(undecoded_notes, undecoded_notes_minor);
+        load_notes(inf);
+    }
+
+    // The chunk already holds the marshalled old notes.
+    int old_count;
+    encoded_notes.clear();
+    encoded_notes_count = 0;
+    if (_current_notes_chunk(undecoded_notes, undecoded_notes_minor,
+                             old_count)
+        && old_count == (int) note_list.size())
+    {
+        encoded_notes.assign(undecoded_notes.begin() + NOTES_HEADER_SIZE,
+                             undecoded_notes.end());
+        encoded_notes_count = note_list.size();
+    }
+
+    note_list.insert(note_list.end(), taken_since.begin(), taken_since.end());
+    vector<unsigned char>().swap(undecoded_notes);
+}
+
+void clear_notes()
+{
+    note_list.clear();
+    vector<unsigned char>().swap(undecoded_notes);
+    vector<unsigned char>().swap(encoded_notes);
+    encoded_notes_count = 0;
+    ++note_generation;
+}
+
 void make_user_note()
 {
     char buf[400];
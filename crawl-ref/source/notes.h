@@ -96,6 +96,11 @@ bool notes_are_active();
 void take_note(const Note& note, bool force = false);
 void save_notes(writer&);
 void load_notes(reader&);
+void load_notes_lazily(vector<unsigned char> data, int minorVersion);
+void ensure_notes_loaded();
+void clear_notes();
+// Changes whenever a note is taken, or the notes are loaded or cleared.
+unsigned int notes_generation();
 void make_user_note();
 
 /**
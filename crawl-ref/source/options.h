@@ -400,6 +400,9 @@ public:
     map<dungeon_feature_type, feature_def> feature_colour_overrides;
     map<dungeon_feature_type, FixedVector<char32_t, 2> > feature_symbol_overrides;
     map<monster_type, cglyph_t> mon_glyph_overrides;
+    // Changes whenever the feature or monster overrides do, for the tables
+    // built from them by feature.cc and mon-util.cc.
+    unsigned int glyph_overrides_version;
     char32_t cset_override[NUM_DCHAR_TYPES];
     typedef pair<string, cglyph_t> item_glyph_override_type;
     vector<item_glyph_override_type > item_glyph_overrides;
@@ -421,6 +424,7 @@ public:
     string game_seed; // string version of the rc option
     uint64_t    seed_from_rc;
     level_gen_type pregen_dungeon;
+    bool        pregen_ahead;   // Build the next level while awaiting input.
 
 #ifdef DGL_SIMPLE_MESSAGING
     bool        messaging;      // Check for messages.
@@ -529,6 +533,12 @@ public:
     bool        best_effort_brighten_background; // Allow bg brighten attempts.
     bool        best_effort_brighten_foreground; // Allow fg brighten attempts.
     bool        allow_extended_colours; // Use more than 8 terminal colours.
+    bool        minimal_sgr;    // Draw blanks without changing colour.
+    int         terminal_frame_rate; // Most screen writes a second, or 0.
+
+    int         lua_gc_pause;   // Collector tuning for user Lua scripts,
+    int         lua_gc_step_multiplier; // as lua_gc() takes it (0 to leave
+    int         lua_gc_idle_time; // alone), and ms to spend on it when idle.
     bool        macro_meta_entry; // Allow user to use numeric sequences when
                                   // creating macros
     int         autofight_warning;      // Amount of real time required between
@@ -570,6 +580,7 @@ public:
 
     wizard_option_type wiz_mode;      // no, never, start in wiz mode
     wizard_option_type explore_mode;  // no, never, start in explore mode
+    int            debug_scan_interval; // inputs between full debug scans
 
     bool           no_save;    // don't use persistent save files
     bool           no_player_bones;   // don't save player's info in bones files
@@ -785,6 +796,7 @@ public:
     string      fsim_mode;
     bool        fsim_csv;
     int         fsim_rounds;
+    int         fsim_jobs;
     string      fsim_mons;
     vector<string> fsim_scale;
     vector<string> fsim_kit;
@@ -906,6 +918,7 @@ public:
     newgame_def game;      // Choices for new game.
 
 private:
+    void glyph_overrides_changed();
     void clear_feature_overrides();
     void clear_cset_overrides();
     void add_cset_override(dungeon_char_type dc, int symbol);
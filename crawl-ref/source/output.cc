@@ -1238,17 +1238,37 @@ static void _get_status_lights(vector<status_light>& out)
             _add_status_light_to_out(status, out);
 }
 
+// What _print_status_lights() last put on screen, and where. The lights are
+// asked for on every input, but rarely change; draw_border() clears the
+// screen and so forgets them.
+static vector<status_light> _drawn_lights;
+static int _drawn_lights_y = -1;
+static int _drawn_lights_width = -1;
+
+static bool _same_lights(const vector<status_light> &a,
+                         const vector<status_light> &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i)
+        if (a[i].colour != b[i].colour || a[i].text != b[i].text)
+            return false;
+    return true;
+}
+
 static void _print_status_lights(int y)
 {
     vector<status_light> lights;
-    static int last_number_of_lights = 0;
     _get_status_lights(lights);
-    if (lights.empty() && last_number_of_lights == 0)
+    if (y == _drawn_lights_y && crawl_view.hudsz.x == _drawn_lights_width
+        && _same_lights(lights, _drawn_lights))
     {
         you.redraw_status_lights = false;
         return;
     }
-    last_number_of_lights = lights.size();
+    _drawn_lights = lights;
+    _drawn_lights_y = y;
+    _drawn_lights_width = crawl_view.hudsz.x;
 
     size_t line_cur = y;
     const size_t line_end = crawl_view.hudsz.y+1;
@@ -1578,6 +1598,7 @@ void draw_border()
 
     CGOTOXY(1,1, GOTO_CRT);
     clrscr();
+    _drawn_lights_y = -1;
 
     textcolour(Options.status_caption_colour);
 
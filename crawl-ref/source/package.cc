@@ -16,6 +16,29 @@ Notes:
 * Readers always get the last complete (but not necessarily committed) write
   (ie, READ_UNCOMMITTED) at the time they started; it is safe to continue
   reading even if the chunk has been changed since.
+* commit(true) writes the directory right away, but the flushes and the header
+  update that makes it current happen on a background thread.  Until that
+  finishes (finish_commit(), called by anything that needs the commit to be
+  done, including the next commit), blocks the old directory refers to stay
+  reserved, so a crash still leaves either the old or the new state intact.
+* With PARALLEL_COMPRESS, writers obtained from writer() merely buffer what
+  they're given.  When one is closed, its data is deflated by a background
+  task (up to MAX_COMPRESS_JOBS at a time), and the results are appended to
+  the file in the order the writers were closed.  Anything that looks at the
+  directory waits for them first, so to callers this is indistinguishable
+  from compressing in place; reading or looking for one chunk only waits
+  for that chunk's queued writes.  The package also remembers what it last
+  got for each chunk (up to MAX_LAST_WRITTEN bytes in total); a chunk
+  rewritten with the very same contents isn't written again, and readers of
+  a chunk it remembers are served from memory rather than the file.
+* With USE_MMAP, the file is mapped on load and readers walk the block chain
+  directly out of the mapping.  Once anything is written, readers started
+  afterwards go back to read() until the next commit() refreshes the mapping;
+  blocks in use by a reader are never overwritten, so readers already
+  walking the mapping stay valid.
+* compact() copies everything into a fresh file next to the save and renames
+  it over the original, so a crash in the middle leaves just a stray .tmp
+  file and the old save intact.
 */
 
 #include "AppHdr.h"
@@ -32,12 +55,24 @@ Notes:
 #if defined(UNIX) || defined(TARGET_COMPILER_MINGW)
 #include <unistd.h>
 #endif
+#ifdef USE_MMAP
+#include <sys/mman.h>
+#endif
+#ifdef ASYNC_COMMIT
+#include <cerrno>
+#endif
+#ifdef ASYNC_COMMIT
+#include "threads.h"
+#endif
 
 #include "end.h"
 #include "endianness.h"
 #include "errors.h"
 #include "syscalls.h"
 #include "libutil.h" // map_find
+#ifdef PARALLEL_COMPRESS
+#include "tasks.h"
+#endif
 
 // debugging defines
 #undef  FSCK_VERBOSE
@@ -59,7 +94,10 @@ static plen_t htole(plen_t x)
 #define dprintf(...) do {} while (0)
 #endif
 
-#define PACKAGE_VERSION 1
+// Version 2 adds a codec byte to every directory entry. It's written only
+// when some chunk isn't zlib, so builds without zstd keep writing saves that
+// older versions can read.
+#define PACKAGE_VERSION 2
 #define PACKAGE_MAGIC   0x53534344 /* "DCSS" */
 
 struct file_header
@@ -81,11 +119,95 @@ typedef pair<plen_t, plen_t> bm_p;
 typedef map<plen_t, bm_p> bm_t;
 typedef map<plen_t, plen_t> fb_t;
 
+#ifdef ASYNC_COMMIT
+struct pending_commit
+{
+    int fd;
+    file_header head;
+    // chains unlinked before this commit; they may be freed only after it
+    vector<plen_t> unlinked;
+    thread_t thread;
+    const char *error;
+    int error_no;
+};
+
+static void *_write_header_async(void *arg)
+{
+    pending_commit *pc = (pending_commit *)arg;
+
+    // Same as package::write_header(), but without touching the file offset
+    // the main thread keeps writing blocks at.
+    if (fdatasync(pc->fd))
+        pc->error = "flush error while saving";
+    else if (pwrite(pc->fd, &pc->head, sizeof(pc->head), 0)
+             != sizeof(pc->head))
+    {
+        pc->error = "write error while saving";
+    }
+    else if (fdatasync(pc->fd))
+        pc->error = "flush error while saving";
+    pc->error_no = errno;
+
+    return 0;
+}
+#endif
+
+#ifdef PARALLEL_COMPRESS
+#define MAX_COMPRESS_JOBS 4
+#define MAX_LAST_WRITTEN (4 * 1024 * 1024)
+
+struct compress_job
+{
+    string name;
+    chunk_codec codec;
+    vector<char> data; // raw until the job is done, compressed after
+    task_ticket task;
+    const char *error;
+};
+
+static void _compress_chunk(compress_job *job)
+{
+#ifdef USE_ZSTD
+    if (job->codec == CODEC_ZSTD)
+    {
+        vector<char> out(ZSTD_compressBound(job->data.size()));
+        size_t len = ZSTD_compress(&out[0], out.size(), job->data.data(),
+                                   job->data.size(), ZSTD_CLEVEL_DEFAULT);
+        if (ZSTD_isError(len))
+            job->error = ZSTD_getErrorName(len);
+        else
+            out.resize(len);
+        job->data.swap(out);
+        return;
+    }
+#endif
+
+    uLongf len = compressBound(job->data.size());
+    vector<char> out(len);
+    int res = compress2((Bytef*)&out[0], &len,
+                        (const Bytef*)job->data.data(), job->data.size(),
+                        Z_DEFAULT_COMPRESSION);
+    if (res != Z_OK)
+        job->error = zError(res);
+    out.resize(len);
+    job->data.swap(out);
+}
+#endif
+
 package::package(const char* file, bool writeable, bool empty)
   : n_users(0), dirty(false), aborted(false)
 #ifdef DO_FSYNC
     , tmp(false)
 #endif
+#ifdef ASYNC_COMMIT
+    , pending(nullptr)
+#endif
+#ifdef PARALLEL_COMPRESS
+    , last_written_size(0)
+#endif
+#ifdef USE_MMAP
+    , map_base(nullptr), map_len(0), map_users(0), map_stale(false)
+#endif
 {
     dprintf("package: initializing file=\"%s\" rw=%d\n", file, writeable);
     ASSERT(writeable || !empty);
@@ -136,6 +258,15 @@ package::package()
 #ifdef DO_FSYNC
     , tmp(true)
 #endif
+#ifdef ASYNC_COMMIT
+    , pending(nullptr)
+#endif
+#ifdef PARALLEL_COMPRESS
+    , last_written_size(0)
+#endif
+#ifdef USE_MMAP
+    , map_base(nullptr), map_len(0), map_users(0), map_stale(false)
+#endif
 {
     dprintf("package: initializing tmp file\n");
     filename = "[tmp]";
@@ -180,12 +311,45 @@ void package::load()
     if (len == -1)
         sysfail("save file (%s) is not seekable", filename.c_str());
     file_len = len;
+#ifdef USE_MMAP
+    map_file();
+#endif
     read_directory(htole(head.start), head.version);
 
     if (rw)
         load_traces();
 }
 
+#ifdef USE_MMAP
+void package::map_file()
+{
+    ASSERT(!map_base);
+    ASSERT(!map_users);
+    map_stale = false;
+    if (file_len <= sizeof(file_header))
+        return;
+
+    void *m = mmap(nullptr, file_len, PROT_READ, MAP_SHARED, fd, 0);
+    if (m == MAP_FAILED)
+    {
+        // Not fatal, just use read() instead.
+        dprintf("package: can't map the file, falling back to read()\n");
+        return;
+    }
+    map_base = (const char*)m;
+    map_len = file_len;
+}
+
+void package::unmap_file()
+{
+    ASSERT(!map_users || CrawlIsCrashing);
+    if (map_base)
+        munmap((void*)map_base, map_len);
+    map_base = nullptr;
+    map_len = 0;
+}
+#endif
+
 void package::load_traces()
 {
     ASSERT(!dirty);
@@ -215,11 +379,14 @@ package::~package()
         // only place that can be legitimately call things in wrong order.
 
     if (rw && !aborted)
-    {
         commit();
-        if (ftruncate(fd, file_len))
-            sysfail("failed to update save file");
-    }
+    finish_compression();
+    finish_commit();
+#ifdef USE_MMAP
+    unmap_file();
+#endif
+    if (rw && !aborted && ftruncate(fd, file_len))
+        sysfail("failed to update save file");
 
     // all errors here should be cached write errors
     if (fd != -1)
@@ -231,9 +398,11 @@ package::~package()
     dprintf("package: closed\n");
 }
 
-void package::commit()
+void package::commit(bool async)
 {
     ASSERT(rw);
+    finish_commit();
+    finish_compression();
     if (!dirty)
         return;
     ASSERT(!aborted);
@@ -242,11 +411,80 @@ void package::commit()
     fsck();
 #endif
 
+    uint8_t version;
+    plen_t start = write_directory(version);
+    new_chunks.clear();
+    dirty = false;
+
+#ifdef ASYNC_COMMIT
+    if (async && !tmp)
+    {
+        pending = new pending_commit;
+        pending->fd = fd;
+        pending->head.magic = htole(PACKAGE_MAGIC);
+        pending->head.version = version;
+        memset(&pending->head.padding, 0, sizeof(pending->head.padding));
+        pending->head.start = htole(start);
+        pending->unlinked.swap(unlinked_blocks);
+        pending->error = nullptr;
+        pending->error_no = 0;
+        if (!thread_create_joinable(&pending->thread, _write_header_async,
+                                    pending))
+        {
+            return;
+        }
+
+        // No thread for us, do it the slow way.
+        unlinked_blocks.swap(pending->unlinked);
+        delete pending;
+        pending = nullptr;
+    }
+#else
+    UNUSED(async);
+#endif
+
+    write_header(start, version);
+    collect_blocks();
+    committed();
+}
+
+// Wait for a background commit(true) to hit the disk.
+void package::finish_commit()
+{
+#ifdef ASYNC_COMMIT
+    if (!pending)
+        return;
+
+    thread_join(pending->thread);
+    const char *error = pending->error;
+    int error_no = pending->error_no;
+    vector<plen_t> unlinked;
+    unlinked.swap(pending->unlinked);
+    delete pending;
+    pending = nullptr;
+
+    if (aborted)
+        return;
+    if (error)
+    {
+        errno = error_no;
+        sysfail("%s", error);
+    }
+
+    // Chains unlinked since the commit started must wait for the next one.
+    for (plen_t at : unlinked)
+        free_block_chain(at);
+    committed();
+#endif
+}
+
+void package::write_header(plen_t start, uint8_t version)
+{
     file_header head;
     head.magic = htole(PACKAGE_MAGIC);
-    head.version = PACKAGE_VERSION;
+    head.version = version;
     memset(&head.padding, 0, sizeof(head.padding));
-    head.start = htole(write_directory());
+    head.start = htole(start);
 #ifdef DO_FSYNC
     // We need a barrier before updating the link to point at the new directory.
     if (!tmp && fdatasync(fd))
@@ -259,10 +497,20 @@ void package::commit()
     if (!tmp && fdatasync(fd))
         sysfail("flush error while saving");
 #endif
+}
 
-    new_chunks.clear();
-    collect_blocks();
-    dirty = false;
+// The header now points at the new directory.
+void package::committed()
+{
+#ifdef USE_MMAP
+    // Pick up the blocks written since the file was mapped.  If a reader is
+    // still walking the old mapping, leave it be; new readers will use read().
+    if (map_stale && !map_users)
+    {
+        unmap_file();
+        map_file();
+    }
+#endif
 
 #ifdef COSTLY_ASSERTS
     fsck();
@@ -279,13 +527,154 @@ void package::seek(plen_t to)
         sysfail("failed to seek inside the save file");
 }
 
+void package::read_block_header(plen_t at, plen_t &len, plen_t &next)
+{
+    block_header bl;
+#ifdef USE_MMAP
+    if (map_base && !map_stale)
+    {
+        if (at > map_len || map_len - at < sizeof(block_header))
+            corrupted("save file corrupted -- block past eof");
+        memcpy(&bl, map_base + at, sizeof(block_header));
+    }
+    else
+#endif
+    {
+        seek(at);
+        ssize_t res = ::read(fd, &bl, sizeof(block_header));
+        if (res < 0)
+            sysfail("error reading the save file");
+        if (res != sizeof(block_header))
+            corrupted("save file corrupted -- block past eof");
+    }
+    len  = htole(bl.len);
+    next = htole(bl.next);
+}
+
 chunk_writer* package::writer(const string &name)
 {
+#ifdef PARALLEL_COMPRESS
+    return new chunk_writer(this, name, chunk_writer::WM_DEFER,
+                            DEFAULT_CODEC);
+#else
     return new chunk_writer(this, name);
+#endif
+}
+
+#ifdef PARALLEL_COMPRESS
+void package::queue_compression(const string &name, chunk_codec codec,
+                                vector<char> &data)
+{
+    if (unchanged(name, data))
+    {
+        dprintf("chunk %s is unchanged, not rewriting\n", name.c_str());
+        return;
+    }
+
+    // Keep the number of threads down, and the memory held by the buffers.
+    finish_compression(MAX_COMPRESS_JOBS - 1);
+
+    compress_job *job = new compress_job;
+    job->name = name;
+    job->codec = codec;
+    job->data.swap(data);
+    job->error = nullptr;
+    job->task = task_start([job] { _compress_chunk(job); }, "compress");
+    compress_jobs.push_back(job);
+}
+
+// Is data what the chunk already holds (or will, once the queue is written)?
+// If not, remember it for next time.
+bool package::unchanged(const string &name, const vector<char> &data)
+{
+    auto last = last_written.find(name);
+    if (last != last_written.end())
+    {
+        if (*last->second == data)
+            return true;
+        last_written_size -= last->second->size();
+        last_written.erase(last);
+    }
+
+    if (data.size() > MAX_LAST_WRITTEN)
+        return false;
+    // Make room by dropping the biggest entries, typically old levels.
+    while (last_written_size + data.size() > MAX_LAST_WRITTEN)
+    {
+        auto biggest = last_written.begin();
+        for (auto it = last_written.begin(); it != last_written.end(); ++it)
+            if (it->second->size() > biggest->second->size())
+                biggest = it;
+        last_written_size -= biggest->second->size();
+        last_written.erase(biggest);
+    }
+    last_written[name] = make_shared<const vector<char> >(data);
+    last_written_size += data.size();
+    return false;
+}
+
+void package::forget_written(const string &name)
+{
+    auto last = last_written.find(name);
+    if (last == last_written.end())
+        return;
+    last_written_size -= last->second->size();
+    last_written.erase(last);
+}
+#endif
+
+// Write out chunks queued by deferred writers, oldest first, until at most
+// keep remain.
+void package::finish_compression(size_t keep)
+{
+#ifdef PARALLEL_COMPRESS
+    while (compress_jobs.size() > keep)
+    {
+        compress_job *job = compress_jobs.front();
+        compress_jobs.erase(compress_jobs.begin());
+        job->task.wait();
+
+        if (!aborted && job->error)
+        {
+            const char *error = job->error;
+            delete job;
+            fail("save file compression failed: %s", error);
+        }
+        if (!aborted)
+        {
+            chunk_writer cw(this, job->name, chunk_writer::WM_PRECOMPRESSED,
+                            job->codec);
+            cw.write(job->data.data(), job->data.size());
+        }
+        delete job;
+    }
+#else
+    UNUSED(keep);
+#endif
+}
+
+// Write out queued chunks up to the last one named name, so that it can be
+// read. Later chunks stay with their threads: a level being loaded needn't
+// wait for the one just left to finish deflating.
+void package::finish_compression_of(const string &name)
+{
+#ifdef PARALLEL_COMPRESS
+    for (size_t i = compress_jobs.size(); i > 0; --i)
+    {
+        if (compress_jobs[i - 1]->name == name)
+        {
+            finish_compression(compress_jobs.size() - i);
+            return;
+        }
+    }
+#else
+    UNUSED(name);
+#endif
 }
 
 chunk_reader* package::reader(const string &name)
 {
+    finish_compression_of(name);
     if (plen_t *ch = map_find(directory, name))
         return new chunk_reader(this, *ch);
     return 0;
@@ -359,10 +748,14 @@ plen_t package::alloc_block(plen_t &size)
     return at;
 }
 
-void package::finish_chunk(const string &name, plen_t at)
+void package::finish_chunk(const string &name, plen_t at, chunk_codec codec)
 {
     free_chunk(name);
     directory[name] = at;
+    if (codec == CODEC_ZLIB)
+        codecs.erase(name);
+    else
+        codecs[name] = codec;
     new_chunks.insert(at);
     dirty = true;
 }
@@ -384,29 +777,50 @@ void package::free_chunk(const string &name)
 
 void package::delete_chunk(const string &name)
 {
+    finish_compression();
+#ifdef PARALLEL_COMPRESS
+    forget_written(name);
+#endif
     free_chunk(name);
     directory.erase(name);
+    codecs.erase(name);
 }
 
-plen_t package::write_directory()
+string package::directory_data(const directory_t &dir_entries,
+                               uint8_t &version)
 {
-    delete_chunk("");
-
+    version = codecs.empty() ? 1 : 2;
     stringstream dir;
-    for (const auto &entry : directory)
+    for (const auto &entry : dir_entries)
     {
+        if (entry.first.empty())
+            continue;
         uint8_t name_len = entry.first.length();
         dir.write((const char*)&name_len, sizeof(name_len));
         dir.write(&entry.first[0], entry.first.length());
         plen_t start = htole(entry.second);
         dir.write((const char*)&start, sizeof(plen_t));
+        if (version >= 2)
+        {
+            const chunk_codec *codec = map_find(codecs, entry.first);
+            uint8_t c = codec ? *codec : CODEC_ZLIB;
+            dir.write((const char*)&c, sizeof(c));
+        }
     }
 
     ASSERT(dir.str().size());
-    dprintf("writing directory (%u bytes)\n", (unsigned int)dir.str().size());
+    return dir.str();
+}
+
+plen_t package::write_directory(uint8_t &version)
+{
+    delete_chunk("");
+
+    const string dir = directory_data(directory, version);
+    dprintf("writing directory (%u bytes)\n", (unsigned int)dir.size());
     {
         chunk_writer dch(this, "");
-        dch.write(&dir.str()[0], dir.str().size());
+        dch.write(&dir[0], dir.size());
     }
 
     return directory[""];
@@ -540,6 +954,7 @@ void package::read_directory(plen_t start, uint8_t version)
         }
         break;
     case 1:
+    case 2:
         uint8_t name_len;
         plen_t bstart;
         while (plen_t res = rd.read(&name_len, sizeof(name_len)))
@@ -553,6 +968,16 @@ void package::read_directory(plen_t start, uint8_t version)
             if (rd.read(&bstart, sizeof(bstart)) != sizeof(bstart))
                 corrupted("save file corrupted -- truncated directory");
             directory[chname] = htole(bstart);
+            if (version >= 2)
+            {
+                uint8_t codec;
+                if (rd.read(&codec, sizeof(codec)) != sizeof(codec))
+                    corrupted("save file corrupted -- truncated directory");
+                if (codec >= NUM_CODECS)
+                    corrupted("save file corrupted -- unknown codec %u", codec);
+                if (codec != CODEC_ZLIB)
+                    codecs[chname] = (chunk_codec)codec;
+            }
             dprintf("* %s\n", chname.c_str());
         }
         break;
@@ -564,11 +989,13 @@ void package::read_directory(plen_t start, uint8_t version)
 
 bool package::has_chunk(const string &name)
 {
+    finish_compression_of(name);
     return !name.empty() && directory.count(name);
 }
 
 vector<string> package::list_chunks()
 {
+    finish_compression();
     vector<string> list;
     list.reserve(directory.size());
     for (const auto &entry : directory)
@@ -582,16 +1009,8 @@ void package::trace_chunk(plen_t start)
 {
     while (start)
     {
-        block_header bl;
-        seek(start);
-        ssize_t res = ::read(fd, &bl, sizeof(block_header));
-        if (res < 0)
-            sysfail("error reading the save file");
-        if (res != sizeof(block_header))
-            corrupted("save file corrupted -- block past eof");
-
-        plen_t len  = htole(bl.len);
-        plen_t next = htole(bl.next);
+        plen_t len, next;
+        read_block_header(start, len, next);
         plen_t end  = start + len + sizeof(block_header);
         dprintf("{at %u size %u+header}\n", start, len);
 
@@ -620,19 +1039,146 @@ void package::abort()
     // this point are ignored (assuming we already failed). All writes since
     // the last commit() are lost.
     aborted = true;
+    finish_compression();
+#ifdef PARALLEL_COMPRESS
+    last_written.clear();
+    last_written_size = 0;
+#endif
 }
 
 void package::unlink()
 {
     abort();
+    finish_commit();
+#ifdef USE_MMAP
+    unmap_file();
+#endif
     close(fd);
     fd = -1;
     ::unlink_u(filename.c_str());
 }
 
+// Rewrite the save with every chunk in a single block, back to back, and
+// swap it in for the original.  Done only if slack (holes left by freed
+// blocks) is above max_slack_percent of the file.  Needs the package to be
+// committed and unused; returns whether anything was done.
+bool package::compact(plen_t max_slack_percent)
+{
+    ASSERT(rw);
+    commit();
+    finish_commit();
+#ifdef DO_FSYNC
+    if (tmp)
+        return false;
+#endif
+    if (n_users || aborted)
+        return false;
+    if (get_slack() <= (uint64_t)file_len * max_slack_percent / 100)
+        return false;
+
+    dprintf("package: compacting, slack %u of %u\n", get_slack(), file_len);
+    const string tmpname = filename + ".tmp";
+    int nfd = open_u(tmpname.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_BINARY,
+                     0666);
+    if (nfd == -1)
+        return false;
+    if (!lock_file(nfd, true))
+    {
+        close(nfd);
+        unlink_u(tmpname.c_str());
+        return false;
+    }
+
+    directory_t new_dir;
+    bm_t new_blocks;
+    plen_t at = sizeof(file_header);
+    bool ok = true;
+    vector<char> data;
+    auto put = [&](const void *buf, plen_t len, plen_t where)
+    {
+        ok = ok && lseek(nfd, where, SEEK_SET) == (off_t)where
+                && ::write(nfd, buf, len) == (ssize_t)len;
+    };
+    auto put_block = [&](plen_t len, const void *contents) -> plen_t
+    {
+        block_header bl;
+        bl.len = htole(len);
+        bl.next = 0;
+        put(&bl, sizeof(bl), at);
+        put(contents, len, at + sizeof(bl));
+        new_blocks[at] = bm_p(len, 0);
+        plen_t start = at;
+        at += sizeof(bl) + len;
+        return start;
+    };
+
+    for (const auto &entry : directory)
+    {
+        if (entry.first.empty() || !ok)
+            continue;
+        // The compressed stream doesn't care where block boundaries are.
+        data.clear();
+        for (plen_t bl = entry.second; bl; bl = block_map[bl].second)
+        {
+            const plen_t len = block_map[bl].first;
+            data.resize(data.size() + len);
+            seek(bl + sizeof(block_header));
+            if (::read(fd, &data[data.size() - len], len) != (ssize_t)len)
+                corrupted("save file corrupted -- block past eof");
+        }
+        new_dir[entry.first] = put_block(data.size(), data.data());
+    }
+
+    uint8_t version;
+    const string dir = directory_data(new_dir, version);
+    uLongf zlen = compressBound(dir.size());
+    data.resize(zlen);
+    ok = ok && compress2((Bytef*)&data[0], &zlen, (const Bytef*)dir.data(),
+                         dir.size(), Z_DEFAULT_COMPRESSION) == Z_OK;
+    const plen_t dir_start = put_block(zlen, data.data());
+    new_dir[""] = dir_start;
+
+    file_header head;
+    head.magic = htole(PACKAGE_MAGIC);
+    head.version = version;
+    memset(&head.padding, 0, sizeof(head.padding));
+    head.start = htole(dir_start);
+    put(&head, sizeof(head), 0);
+#ifdef DO_FSYNC
+    ok = ok && !fdatasync(nfd);
+#endif
+    if (!ok || rename_u(tmpname.c_str(), filename.c_str()))
+    {
+        dprintf("package: compaction failed, keeping the old file\n");
+        close(nfd);
+        unlink_u(tmpname.c_str());
+        return false;
+    }
+
+    // The new file is in place; switch over to it.
+#ifdef USE_MMAP
+    unmap_file();
+#endif
+    close(fd);
+    fd = nfd;
+    file_len = at;
+    directory.swap(new_dir);
+    block_map.swap(new_blocks);
+    free_blocks.clear();
+    unlinked_blocks.clear();
+#ifdef USE_MMAP
+    map_file();
+#endif
+#ifdef COSTLY_ASSERTS
+    fsck();
+#endif
+    return true;
+}
+
 // the amount of free space not at the end of file
 plen_t package::get_slack()
 {
+    finish_compression();
     load_traces();
 
     plen_t slack = 0;
@@ -643,6 +1189,7 @@ plen_t package::get_slack()
 
 plen_t package::get_chunk_fragmentation(const string &name)
 {
+    finish_compression();
     load_traces();
     ASSERT(directory.count(name)); // not has_chunk(), "" is valid
     plen_t frags = 0;
@@ -659,6 +1206,7 @@ plen_t package::get_chunk_fragmentation(const string &name)
 
 plen_t package::get_chunk_compressed_length(const string &name)
 {
+    finish_compression();
     load_traces();
     ASSERT(directory.count(name)); // not has_chunk(), "" is valid
     plen_t len = 0;
@@ -674,7 +1222,20 @@ plen_t package::get_chunk_compressed_length(const string &name)
 }
 
 chunk_writer::chunk_writer(package *parent, const string &_name)
-    : first_block(0), cur_block(0), block_len(0)
+    : mode(WM_COMPRESS), codec(_name.empty() ? CODEC_ZLIB : DEFAULT_CODEC),
+      first_block(0), cur_block(0), block_len(0)
+{
+    init(parent, _name);
+}
+
+chunk_writer::chunk_writer(package *parent, const string &_name,
+                           write_mode _mode, chunk_codec _codec)
+    : mode(_mode), codec(_codec), first_block(0), cur_block(0), block_len(0)
+{
+    init(parent, _name);
+}
+
+void chunk_writer::init(package *parent, const string &_name)
 {
     ASSERT(parent);
     ASSERT(!parent->aborted);
@@ -682,21 +1243,52 @@ chunk_writer::chunk_writer(package *parent, const string &_name)
     // If you need more, please change {read,write}_directory().
     ASSERT(MAX_CHUNK_NAME_LENGTH < 256);
     ASSERT(_name.length() < MAX_CHUNK_NAME_LENGTH);
+    // The directory must be readable without knowing its codec.
+    ASSERT(!_name.empty() || codec == CODEC_ZLIB);
 
     dprintf("chunk_writer(%s): starting\n", _name.c_str());
     pkg = parent;
     pkg->n_users++;
     name = _name;
+#ifdef USE_MMAP
+    // The mapping no longer covers everything readers may be asked for.
+    pkg->map_stale = true;
+#endif
+
+#ifdef PARALLEL_COMPRESS
+    // Written behind the cache's back.
+    if (mode == WM_COMPRESS)
+        pkg->forget_written(name);
+#endif
 
 #ifdef USE_ZLIB
+    if (mode != WM_COMPRESS)
+        return;
+
+#define ZB_SIZE 32768
+    z_buffer = (Bytef*)malloc(ZB_SIZE);
+#ifdef USE_ZSTD
+    if (codec == CODEC_ZSTD)
+    {
+        zcs = ZSTD_createCStream();
+        if (!zcs)
+            fail("save file compression failed during init");
+        size_t res = ZSTD_initCStream(zcs, ZSTD_CLEVEL_DEFAULT);
+        if (ZSTD_isError(res))
+        {
+            fail("save file compression failed during init: %s",
+                 ZSTD_getErrorName(res));
+        }
+        return;
+    }
+#endif
     zs.data_type = Z_BINARY;
     zs.zalloc    = 0;
     zs.zfree     = 0;
     zs.opaque    = Z_NULL;
     if (deflateInit(&zs, Z_DEFAULT_COMPRESSION))
         fail("save file compression failed during init: %s", zs.msg);
-#define ZB_SIZE 32768
-    zs.next_out  = z_buffer = (Bytef*)malloc(ZB_SIZE);
+    zs.next_out  = z_buffer;
     zs.avail_out = ZB_SIZE;
 #endif
 }
@@ -711,31 +1303,74 @@ chunk_writer::~chunk_writer()
     {
 #ifdef USE_ZLIB
         // ignore errors, they're not relevant anymore
-        deflateEnd(&zs);
-        free(z_buffer);
+        if (mode == WM_COMPRESS)
+        {
+#ifdef USE_ZSTD
+            if (codec == CODEC_ZSTD)
+                ZSTD_freeCStream(zcs);
+            else
+#endif
+            deflateEnd(&zs);
+            free(z_buffer);
+        }
 #endif
         return;
     }
 
+#ifdef PARALLEL_COMPRESS
+    if (mode == WM_DEFER)
+    {
+        pkg->queue_compression(name, codec, deferred);
+        return;
+    }
+#endif
+
 #ifdef USE_ZLIB
-    zs.avail_in = 0;
-    int res;
-    do
+    if (mode == WM_COMPRESS)
     {
-        res = deflate(&zs, Z_FINISH);
-        if (res != Z_STREAM_END && res != Z_OK && res != Z_BUF_ERROR)
-            fail("save file compression failed: %s", zs.msg);
-        raw_write(z_buffer, zs.next_out - z_buffer);
-        zs.next_out = z_buffer;
-        zs.avail_out = ZB_SIZE;
-    } while (res != Z_STREAM_END);
-    if (deflateEnd(&zs) != Z_OK)
-        fail("save file compression failed during clean-up: %s", zs.msg);
-    free(z_buffer);
+#ifdef USE_ZSTD
+        if (codec == CODEC_ZSTD)
+        {
+            size_t res;
+            do
+            {
+                ZSTD_outBuffer out = { z_buffer, ZB_SIZE, 0 };
+                res = ZSTD_endStream(zcs, &out);
+                if (ZSTD_isError(res))
+                {
+                    fail("save file compression failed: %s",
+                         ZSTD_getErrorName(res));
+                }
+                raw_write(z_buffer, out.pos);
+            } while (res);
+            ZSTD_freeCStream(zcs);
+        }
+        else
+#endif
+        {
+            zs.avail_in = 0;
+            int res;
+            do
+            {
+                res = deflate(&zs, Z_FINISH);
+                if (res != Z_STREAM_END && res != Z_OK && res != Z_BUF_ERROR)
+                    fail("save file compression failed: %s", zs.msg);
+                raw_write(z_buffer, zs.next_out - z_buffer);
+                zs.next_out = z_buffer;
+                zs.avail_out = ZB_SIZE;
+            } while (res != Z_STREAM_END);
+            if (deflateEnd(&zs) != Z_OK)
+            {
+                fail("save file compression failed during clean-up: %s",
+                     zs.msg);
+            }
+        }
+        free(z_buffer);
+    }
 #endif
     if (cur_block)
         finish_block(0);
-    pkg->finish_chunk(name, first_block);
+    pkg->finish_chunk(name, first_block, codec);
 }
 
 void chunk_writer::raw_write(const void *data, plen_t len)
@@ -782,6 +1417,39 @@ void chunk_writer::write(const void *data, plen_t len)
     ASSERT(data);
     ASSERT(!pkg->aborted);
 
+#ifdef PARALLEL_COMPRESS
+    if (mode == WM_DEFER)
+    {
+        deferred.insert(deferred.end(), (const char*)data,
+                        (const char*)data + len);
+        return;
+    }
+    if (mode == WM_PRECOMPRESSED)
+    {
+        raw_write(data, len);
+        return;
+    }
+#endif
+
+#ifdef USE_ZSTD
+    if (codec == CODEC_ZSTD)
+    {
+        ZSTD_inBuffer in = { data, len, 0 };
+        while (in.pos < in.size)
+        {
+            ZSTD_outBuffer out = { z_buffer, ZB_SIZE, 0 };
+            size_t res = ZSTD_compressStream(zcs, &out, &in);
+            if (ZSTD_isError(res))
+            {
+                fail("save file compression failed: %s",
+                     ZSTD_getErrorName(res));
+            }
+            raw_write(z_buffer, out.pos);
+        }
+        return;
+    }
+#endif
+
 #ifdef USE_ZLIB
     zs.next_in  = (Bytef*)data;
     zs.avail_in = len;
@@ -802,18 +1470,53 @@ void chunk_writer::write(const void *data, plen_t len)
 #endif
 }
 
-void chunk_reader::init(plen_t start)
+void chunk_reader::init(plen_t start, chunk_codec _codec)
 {
     ASSERT(!pkg->aborted);
+#ifndef USE_ZSTD
+    if (_codec == CODEC_ZSTD)
+    {
+        corrupted("save file (%s) uses zstd compression, which this build "
+                  "doesn't support", pkg->filename.c_str());
+    }
+#endif
+    codec = _codec;
+#ifdef PARALLEL_COMPRESS
+    recent_at = 0;
+#endif
     pkg->n_users++;
     pkg->reader_count[start]++;
     first_block = next_block = start;
     block_left = 0;
+#ifdef USE_MMAP
+    mapped = pkg->map_base && !pkg->map_stale;
+    if (mapped)
+        pkg->map_users++;
+#endif
 
 #ifdef USE_ZLIB
     if (!start)
         corrupted("save file corrupted -- zlib header missing");
+    eof = false;
 
+#ifdef USE_ZSTD
+    if (codec == CODEC_ZSTD)
+    {
+        zds = ZSTD_createDStream();
+        if (!zds)
+            fail("save file decompression failed during init");
+        size_t res = ZSTD_initDStream(zds);
+        if (ZSTD_isError(res))
+        {
+            fail("save file decompression failed during init: %s",
+                 ZSTD_getErrorName(res));
+        }
+        zin.src  = nullptr;
+        zin.size = 0;
+        zin.pos  = 0;
+        return;
+    }
+#endif
     zs.zalloc    = 0;
     zs.zfree     = 0;
     zs.opaque    = Z_NULL;
@@ -821,7 +1524,6 @@ void chunk_reader::init(plen_t start)
     zs.avail_in  = 0;
     if (inflateInit(&zs))
         fail("save file decompression failed during init: %s", zs.msg);
-    eof = false;
 #endif
 }
 
@@ -830,7 +1532,7 @@ chunk_reader::chunk_reader(package *parent, plen_t start)
     ASSERT(parent);
     dprintf("chunk_reader[%u]: starting\n", start);
     pkg = parent;
-    init(start);
+    init(start, CODEC_ZLIB);
 }
 
 chunk_reader::chunk_reader(package *parent, const string &_name)
@@ -840,16 +1542,34 @@ chunk_reader::chunk_reader(package *parent, const string &_name)
         corrupted("save file corrupted -- chunk \"%s\" missing", _name.c_str());
     dprintf("chunk_reader(%s): starting\n", _name.c_str());
     pkg = parent;
-    init(parent->directory[_name]);
+    const chunk_codec *ch_codec = map_find(parent->codecs, _name);
+    init(parent->directory[_name], ch_codec ? *ch_codec : CODEC_ZLIB);
+#ifdef PARALLEL_COMPRESS
+    // A level just left, say, when going back up the stairs.
+    if (auto last = map_find(parent->last_written, _name))
+        recent = *last;
+#endif
 }
 
 chunk_reader::~chunk_reader()
 {
     dprintf("chunk_reader: closing\n");
 
+#ifdef USE_ZSTD
+    if (codec == CODEC_ZSTD)
+        ZSTD_freeDStream(zds);
+    else
+#endif
 #ifdef USE_ZLIB
     if (inflateEnd(&zs) != Z_OK)
         fail("save file decompression failed during clean-up: %s", zs.msg);
+#endif
+#ifdef USE_MMAP
+    if (mapped)
+    {
+        ASSERT(pkg->map_users > 0);
+        pkg->map_users--;
+    }
 #endif
     ASSERT(pkg->reader_count[first_block] > 0);
     if (!--pkg->reader_count[first_block])
@@ -858,8 +1578,52 @@ chunk_reader::~chunk_reader()
     pkg->n_users--;
 }
 
+#ifdef USE_MMAP
+// Returns a pointer to up to len bytes of the chunk inside the mapping,
+// limited to the rest of the current block. Nothing is copied.
+plen_t chunk_reader::raw_map(const void *&data, plen_t len)
+{
+    ASSERT(mapped);
+    if (!block_left)
+    {
+        if (!next_block)
+            return 0;
+
+        off = next_block + sizeof(block_header);
+        pkg->read_block_header(next_block, block_left, next_block);
+        // This reeks of on-disk corruption (zeroed data).
+        if (!block_left)
+            corrupted("save file corrupted -- empty block");
+        if (off > pkg->map_len || pkg->map_len - off < block_left)
+            corrupted("save file corrupted -- block past eof");
+    }
+
+    plen_t s = len;
+    if (s > block_left)
+        s = block_left;
+    data = pkg->map_base + off;
+    off += s;
+    block_left -= s;
+    return s;
+}
+#endif
+
 plen_t chunk_reader::raw_read(void *data, plen_t len)
 {
+#ifdef USE_MMAP
+    if (mapped)
+    {
+        plen_t done = 0;
+        const void *src;
+        while (plen_t s = raw_map(src, len - done))
+        {
+            memcpy((char*)data + done, src, s);
+            done += s;
+        }
+        return done;
+    }
+#endif
+
     void *buf = data;
     while (len)
     {
@@ -868,23 +1632,13 @@ plen_t chunk_reader::raw_read(void *data, plen_t len)
             if (!next_block)
                 return (char*)buf - (char*)data;
 
-            block_header bl;
-            pkg->seek(next_block);
-            ssize_t res = ::read(pkg->fd, &bl, sizeof(block_header));
-            if (res < 0)
-                sysfail("error reading the save file");
-            if (res != sizeof(block_header))
-                corrupted("save file corrupted -- block past eof");
-
             off = next_block + sizeof(block_header);
-            block_left = htole(bl.len);
-            next_block = htole(bl.next);
+            pkg->read_block_header(next_block, block_left, next_block);
             // This reeks of on-disk corruption (zeroed data).
             if (!block_left)
                 corrupted("save file corrupted -- empty block");
         }
-        else
-            pkg->seek(off);
+        pkg->seek(off);
 
         plen_t s = len;
         if (s > block_left)
@@ -904,17 +1658,80 @@ plen_t chunk_reader::raw_read(void *data, plen_t len)
     return (char*)buf - (char*)data;
 }
 
+#ifdef USE_ZLIB
+// Get the next piece of compressed data: a whole block straight from the
+// mapping if we have one, a bufferful otherwise.
+plen_t chunk_reader::next_input(const void *&data)
+{
+#ifdef USE_MMAP
+    if (mapped)
+        return raw_map(data, (plen_t)-1);
+#endif
+    data = z_buffer;
+    return raw_read(z_buffer, sizeof(z_buffer));
+}
+#endif
+
+#ifdef USE_ZSTD
+plen_t chunk_reader::zstd_read(void *data, plen_t len)
+{
+    ZSTD_outBuffer out = { data, len, 0 };
+    while (out.pos < out.size)
+    {
+        // The decompressor may still be holding output even once the input
+        // has run out, so that's an error only if it makes no progress.
+        bool input_left = true;
+        if (zin.pos == zin.size)
+        {
+            zin.size = next_input(zin.src);
+            zin.pos = 0;
+            input_left = zin.size;
+        }
+        const size_t done = out.pos;
+        size_t res = ZSTD_decompressStream(zds, &out, &zin);
+        if (ZSTD_isError(res))
+        {
+            corrupted("save file decompression failed: %s",
+                      ZSTD_getErrorName(res));
+        }
+        if (!res)
+        {
+            eof = true;
+            break;
+        }
+        if (!input_left && out.pos == done)
+            corrupted("save file corrupted -- block truncated");
+    }
+    return out.pos;
+}
+#endif
+
 plen_t chunk_reader::read(void *data, plen_t len)
 {
     ASSERT(data);
     if (pkg->aborted)
         return 0;
 
+#ifdef PARALLEL_COMPRESS
+    if (recent)
+    {
+        const plen_t s = min<plen_t>(len, recent->size() - recent_at);
+        if (s)
+            memcpy(data, recent->data() + recent_at, s);
+        recent_at += s;
+        return s;
+    }
+#endif
+
 #ifdef USE_ZLIB
     if (!len)
         return 0;
     if (eof)
         return 0;
+#ifdef USE_ZSTD
+    if (codec == CODEC_ZSTD)
+        return zstd_read(data, len);
+#endif
 
     zs.next_out  = (Bytef*)data;
     zs.avail_out = len;
@@ -922,8 +1739,9 @@ plen_t chunk_reader::read(void *data, plen_t len)
     {
         if (!zs.avail_in)
         {
-            zs.next_in  = z_buffer;
-            zs.avail_in = raw_read(z_buffer, sizeof(z_buffer));
+            const void *src;
+            zs.avail_in = next_input(src);
+            zs.next_in  = (Bytef*)src;
             if (!zs.avail_in)
                 corrupted("save file corrupted -- block truncated");
         }
@@ -944,14 +1762,18 @@ plen_t chunk_reader::read(void *data, plen_t len)
 
 void chunk_reader::read_all(vector<char> &data)
 {
-#define SPACE 1024
-    plen_t s, at;
-    do
+    // Grow the window geometrically, so a big chunk takes only a few calls
+    // to inflate rather than one per kilobyte.
+    plen_t space = 1024, s, at;
+    while (true)
     {
         at = data.size();
-        data.resize(at + SPACE);
-        s = read(&data[at], SPACE);
-    } while (s == SPACE);
+        data.resize(at + space);
+        s = read(&data[at], space);
+        if (s < space)
+            break;
+        if (space < 1024 * 1024)
+            space *= 2;
+    }
     data.resize(at + s);
-#undef SPACE
 }
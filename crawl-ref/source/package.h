@@ -3,12 +3,16 @@
 #define USE_ZLIB
 
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
 #ifdef USE_ZLIB
 #include <zlib.h>
 #endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
 
 using std::map;
 using std::pair;
@@ -20,23 +24,82 @@ using std::vector;
 #define DO_FSYNC
 #endif
 
+// Read committed blocks straight out of a read-only mapping of the file
+// instead of going through seek() + read() for every block.
+#if defined(UNIX) && !defined(NO_MMAP)
+#define USE_MMAP
+#endif
+
+// Let commit(true) leave the flushes and the header update to a background
+// thread. Pointless without DO_FSYNC, and needs pwrite().
+#if defined(DO_FSYNC) && defined(UNIX) && !defined(NO_ASYNC_COMMIT)
+#define ASYNC_COMMIT
+#endif
+
+// Writers from package::writer() only buffer their data; it is deflated on
+// worker threads once they're closed.
+#if defined(USE_ZLIB) && !defined(NO_PARALLEL_COMPRESS)
+#define PARALLEL_COMPRESS
+#endif
+
 #define MAX_CHUNK_NAME_LENGTH 255
 
 typedef uint32_t plen_t;
 
+// What a chunk's data is compressed with. Recorded in the directory, so a
+// save can mix chunks written by builds with different codecs.
+enum chunk_codec
+{
+    CODEC_ZLIB,
+    CODEC_ZSTD,
+    NUM_CODECS,
+};
+
+// New chunks get this; the directory itself always uses zlib.
+#ifdef USE_ZSTD
+#define DEFAULT_CODEC CODEC_ZSTD
+#else
+#define DEFAULT_CODEC CODEC_ZLIB
+#endif
+
 class package;
+#ifdef ASYNC_COMMIT
+struct pending_commit;
+#endif
+#ifdef PARALLEL_COMPRESS
+struct compress_job;
+#endif
 
 class chunk_writer
 {
 private:
+    enum write_mode
+    {
+        WM_COMPRESS,      // deflate as we go
+#ifdef PARALLEL_COMPRESS
+        WM_DEFER,         // just buffer, a worker will deflate it all
+        WM_PRECOMPRESSED, // the data is deflated already
+#endif
+    };
+    chunk_writer(package *parent, const string &_name, write_mode _mode,
+                 chunk_codec _codec);
+    void init(package *parent, const string &_name);
     package *pkg;
     string name;
+    write_mode mode;
+    chunk_codec codec;
     plen_t first_block;
     plen_t cur_block;
     plen_t block_len;
 #ifdef USE_ZLIB
     z_stream zs;
     Bytef *z_buffer;
+#endif
+#ifdef USE_ZSTD
+    ZSTD_CStream *zcs;
+#endif
+#ifdef PARALLEL_COMPRESS
+    vector<char> deferred;
 #endif
     void raw_write(const void *data, plen_t len);
     void finish_block(plen_t next);
@@ -51,16 +114,37 @@ class chunk_reader
 {
 private:
     chunk_reader(package *parent, plen_t start);
-    void init(plen_t start);
+    void init(plen_t start, chunk_codec _codec);
     package *pkg;
+    chunk_codec codec;
     plen_t first_block, next_block;
     plen_t off, block_left;
+#ifdef USE_MMAP
+    bool mapped;
+#endif
 #ifdef USE_ZLIB
     bool eof;
     z_stream zs;
     Bytef z_buffer[32768];
+#endif
+#ifdef USE_ZSTD
+    ZSTD_DStream *zds;
+    ZSTD_inBuffer zin;
+    plen_t zstd_read(void *data, plen_t len);
+#endif
+#ifdef PARALLEL_COMPRESS
+    // The chunk's contents as last written, if the package still has them:
+    // then there's no need to read and inflate it again.
+    shared_ptr<const vector<char> > recent;
+    plen_t recent_at;
 #endif
     plen_t raw_read(void *data, plen_t len);
+#ifdef USE_ZLIB
+    plen_t next_input(const void *&data);
+#endif
+#ifdef USE_MMAP
+    plen_t raw_map(const void *&data, plen_t len);
+#endif
 public:
     chunk_reader(package *parent, const string &_name);
     ~chunk_reader();
@@ -77,12 +161,14 @@ public:
     ~package();
     chunk_writer* writer(const string &name);
     chunk_reader* reader(const string &name);
-    void commit();
+    void commit(bool async = false);
+    void finish_commit();
     void delete_chunk(const string &name);
     bool has_chunk(const string &name);
     vector<string> list_chunks();
     void abort();
     void unlink();
+    bool compact(plen_t max_slack_percent = 0);
     string get_filename() { return filename; }
 
     // statistics
@@ -102,20 +188,49 @@ private:
     bool tmp;
 #endif
     map<string, plen_t> directory;
+    map<string, chunk_codec> codecs; // chunks not using CODEC_ZLIB
     map<plen_t, plen_t> free_blocks;
     vector<plen_t> unlinked_blocks;
     map<plen_t, pair<plen_t, plen_t> > block_map;
     set<plen_t> new_chunks;
     map<plen_t, uint32_t> reader_count;
+#ifdef ASYNC_COMMIT
+    pending_commit *pending;
+#endif
+#ifdef PARALLEL_COMPRESS
+    vector<compress_job *> compress_jobs;
+    // uncompressed contents of recently written chunks, to skip rewrites
+    // (kept shared, so that readers can go on using one that is replaced)
+    map<string, shared_ptr<const vector<char> > > last_written;
+    size_t last_written_size;
+    bool unchanged(const string &name, const vector<char> &data);
+    void forget_written(const string &name);
+    void queue_compression(const string &name, chunk_codec codec,
+                           vector<char> &data);
+#endif
+    void finish_compression(size_t keep = 0);
+    void finish_compression_of(const string &name);
+#ifdef USE_MMAP
+    const char *map_base;
+    plen_t map_len;
+    int map_users;
+    bool map_stale;
+    void map_file();
+    void unmap_file();
+#endif
     plen_t extend_block(plen_t at, plen_t size, plen_t by);
     plen_t alloc_block(plen_t &size);
-    void finish_chunk(const string &name, plen_t at);
+    void finish_chunk(const string &name, plen_t at, chunk_codec codec);
     void free_chunk(const string &name);
-    plen_t write_directory();
+    string directory_data(const map<string, plen_t> &dir, uint8_t &version);
+    plen_t write_directory(uint8_t &version);
+    void write_header(plen_t start, uint8_t version);
+    void committed();
     void collect_blocks();
     void free_block_chain(plen_t at);
     void free_block(plen_t at, plen_t size);
     void seek(plen_t to);
+    void read_block_header(plen_t at, plen_t &len, plen_t &next);
     void fsck();
     void read_directory(plen_t start, uint8_t version);
     void trace_chunk(plen_t start);
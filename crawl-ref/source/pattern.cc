@@ -193,6 +193,45 @@ pattern_match text_pattern::match_location(const char *s, int length) const
         return pattern_match::failed(string(s));
 }
 
+/**
+ * Can this (valid) pattern go into join_patterns() and mean the same there?
+ * Not if it has back references, which the groups of the patterns before
+ * it would renumber, or a \Q that would quote the rest of the join.
+ */
+bool pattern_is_joinable(const string &pattern)
+{
+    for (size_t i = 0; i + 1 < pattern.size(); ++i)
+    {
+        if (pattern[i] != '\\')
+            continue;
+        const char next = pattern[++i];
+        if (next >= '1' && next <= '9')
+            return false;
+#ifdef REGEX_PCRE
+        if (next == 'g' || next == 'k' || next == 'Q')
+            return false;
+#endif
+    }
+    return true;
+}
+
+/// A pattern matching anything that one of @p patterns does.
+string join_patterns(const vector<string> &patterns)
+{
+    string joined;
+    for (const string &pattern : patterns)
+    {
+        if (!joined.empty())
+            joined += '|';
+#ifdef REGEX_PCRE
+        joined += "(?:" + pattern + ")";
+#else
+        joined += "(" + pattern + ")";
+#endif
+    }
+    return joined;
+}
+
 const plaintext_pattern &plaintext_pattern::operator= (const string &spattern)
 {
     if (pattern == spattern)
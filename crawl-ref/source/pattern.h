@@ -1,5 +1,14 @@
 #pragma once
 
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+using std::pair;
+using std::string;
+using std::vector;
+
 class pattern_match
 {
 public:
@@ -116,6 +125,8 @@ public:
         return pattern;
     }
 
+    bool ignores_case() const { return ignore_case; }
+
 private:
     string pattern;
     mutable void *compiled_pattern;
@@ -123,6 +134,208 @@ private:
     bool ignore_case;
 };
 
+bool pattern_is_joinable(const string &pattern);
+string join_patterns(const vector<string> &patterns);
+
+// What pattern_list_matcher needs from the entries of a list: the channel
+// the entry applies to (-1 for every one), and its pattern, or nullptr if
+// the entry never matches. An empty pattern matches everything. Lists of
+// other kinds of entries add overloads of their own, next to their use.
+inline int pattern_entry_channel(const text_pattern &)
+{
+    return -1;
+}
+
+inline const text_pattern *pattern_entry_pattern(const text_pattern &pat)
+{
+    return pat.valid() ? &pat : nullptr;
+}
+
+template<typename V>
+int pattern_entry_channel(const pair<text_pattern, V> &)
+{
+    return -1;
+}
+
+template<typename V>
+const text_pattern *pattern_entry_pattern(const pair<text_pattern, V> &entry)
+{
+    return pattern_entry_pattern(entry.first);
+}
+
+/**
+ * Finds the first entry of a list of patterns (such as force_more_message
+ * or autopickup_exceptions) that matches a string.
+ *
+ * The patterns that apply to a channel are joined into one regex, built the
+ * first time that channel is checked. Most strings match none of them, and
+ * that one regex rules them all out at once; only when it matches are they
+ * tried in turn. The few patterns that can't be joined are always tried in
+ * turn. The last answers are remembered too, since the same strings come up
+ * again and again. Everything is rebuilt when the list changes.
+ */
+template<typename T>
+class pattern_list_matcher
+{
+public:
+    explicit pattern_list_matcher(int num_channels = 1)
+        : m_num_channels(num_channels), m_channels(num_channels)
+    {
+    }
+
+    // The index in @p list of the first match, or -1.
+    int first_match(const vector<T> &list, int channel, const string &text)
+    {
+        if (!_same_source(list))
+            _rebuild(list);
+
+        recent &cached = m_recent[std::hash<string>()(text) % NUM_RECENT];
+        if (cached.used && cached.channel == channel && cached.text == text)
+            return cached.result;
+
+        channel_matcher &cm = m_channels[channel];
+        if (!cm.built)
+            _build(list, channel, cm);
+
+        bool joined_match = false;
+        for (const text_pattern &joined : cm.joined)
+            if (!joined.empty() && joined.matches(text))
+                joined_match = true;
+
+        int result = -1;
+        for (size_t i = 0; i < cm.entries.size(); ++i)
+        {
+            if (!joined_match && !cm.loose[i])
+                continue;
+
+            const text_pattern *pat
+                = pattern_entry_pattern(list[cm.entries[i]]);
+            if (pat->empty() || pat->matches(text))
+            {
+                result = cm.entries[i];
+                break;
+            }
+        }
+
+        cached.used = true;
+        cached.channel = channel;
+        cached.text = text;
+        cached.result = result;
+        return result;
+    }
+
+private:
+    struct source_entry
+    {
+        int channel;
+        string pattern;
+        bool icase;
+    };
+
+    struct channel_matcher
+    {
+        bool built = false;
+        // The entries for this channel, in order, and whether each has to
+        // be tried even when the joined patterns don't match.
+        vector<int> entries;
+        vector<bool> loose;
+        // By case sensitivity.
+        text_pattern joined[2];
+    };
+
+    struct recent
+    {
+        bool used = false;
+        int channel = 0;
+        string text;
+        int result = -1;
+    };
+    static const int NUM_RECENT = 64;
+
+    int m_num_channels;
+    vector<source_entry> m_source;
+    vector<channel_matcher> m_channels;
+    recent m_recent[NUM_RECENT];
+
+    static source_entry _source_entry(const T &entry)
+    {
+        const text_pattern *pat = pattern_entry_pattern(entry);
+        return { pattern_entry_channel(entry), pat ? pat->tostring() : "",
+                 pat && pat->ignores_case() };
+    }
+
+    bool _same_source(const vector<T> &list) const
+    {
+        if (list.size() != m_source.size())
+            return false;
+        for (size_t i = 0; i < list.size(); ++i)
+        {
+            const source_entry entry = _source_entry(list[i]);
+            if (entry.channel != m_source[i].channel
+                || entry.icase != m_source[i].icase
+                || entry.pattern != m_source[i].pattern)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void _rebuild(const vector<T> &list)
+    {
+        m_source.clear();
+        for (const T &entry : list)
+            m_source.push_back(_source_entry(entry));
+        m_channels.assign(m_num_channels, channel_matcher());
+        for (recent &cached : m_recent)
+            cached.used = false;
+    }
+
+    static void _build(const vector<T> &list, int channel,
+                       channel_matcher &cm)
+    {
+        vector<string> joinable[2];
+        for (size_t i = 0; i < list.size(); ++i)
+        {
+            const int entry_channel = pattern_entry_channel(list[i]);
+            const text_pattern *pat = pattern_entry_pattern(list[i]);
+            if (!pat || entry_channel != channel && entry_channel != -1)
+                continue;
+            // Invalid patterns never match.
+            if (!pat->empty() && !pat->valid())
+                continue;
+
+            const bool loose = pat->empty()
+                               || !pattern_is_joinable(pat->tostring());
+            if (!loose)
+                joinable[pat->ignores_case()].push_back(pat->tostring());
+            cm.entries.push_back(i);
+            cm.loose.push_back(loose);
+        }
+
+        for (int icase = 0; icase < 2; ++icase)
+        {
+            if (joinable[icase].empty())
+                continue;
+            cm.joined[icase] = text_pattern(join_patterns(joinable[icase]),
+                                            icase);
+            // If they won't go together after all, try them all in turn.
+            if (!cm.joined[icase].valid())
+            {
+                cm.joined[icase] = text_pattern();
+                for (size_t i = 0; i < cm.entries.size(); ++i)
+                {
+                    const text_pattern *pat
+                        = pattern_entry_pattern(list[cm.entries[i]]);
+                    if (pat->ignores_case() == bool(icase))
+                        cm.loose[i] = true;
+                }
+            }
+        }
+        cm.built = true;
+    }
+};
+
 class plaintext_pattern : public base_pattern
 {
 public:
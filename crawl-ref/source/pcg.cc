@@ -8,13 +8,13 @@
  * TODO: should we eventually switch to just directly using the official c++
  * implementation?
  *
- * PcgRNG::PcgRNG() and get_uint32 are derived/modified from M.E. O'Neill's
+ * PcgRNG::PcgRNG() and get_uint32 (in pcg.h) are derived/modified from M.E. O'Neill's
  * minimal PCG implementation:
  *    https://github.com/imneme/pcg-c-basic/blob/master/pcg_basic.c
  * Original source is (c) 2014 Melissa O'Neill <oneill@pcg-random.org>
  * Licensed under Apache License 2.0
  *
- * get_bounded_uint32 is derived/modified from an implementation by Melissa
+ * get_bounded_uint32 (also in pcg.h) is derived/modified from an implementation by Melissa
  * O'Neill of an algorithm by Daniel Lemire as part of a comparison of bounded
  * random functions:
  *    http://www.pcg-random.org/posts/bounded-rands.html
@@ -29,70 +29,12 @@
 
 namespace rng
 {
-    /**
-     * Generate a uniformly distributed 32-bit random number.
-     */
-    uint32_t PcgRNG::get_uint32()
-    {
-        count_++;
-        uint64_t oldstate = state_;
-        // Advance internal state. Use the 'official' multiplier. Don't change
-        // this without carefully consulting official sources, as not all
-        // multipliers are ok: see
-        // http://www.pcg-random.org/posts/critiquing-pcg-streams.html
-        state_ = oldstate * static_cast<uint64_t>(6364136223846793005ULL)
-                                                                + (inc_|1);
-        // Calculate output function (XSH RR), uses old state for max ILP
-        uint32_t xorshifted = ((oldstate >> 18u) ^ oldstate) >> 27u;
-        uint32_t rot = oldstate >> 59u;
-        return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
-    }
-
     uint64_t
     PcgRNG::get_uint64()
     {
         return static_cast<uint64_t>(get_uint32()) << 32 | get_uint32();
     }
 
-    /**
-     * Generate a uniformly distributed number, r, where 0 <= r < range.
-     * This uses a technique due to Daniel Lemire, with implementation and
-     * additional tweaks from Melissa O'Neil. It's designed to avoid /,% for
-     * small values of `range`.
-     *
-     * See:
-     *  http://www.pcg-random.org/posts/bounded-rands.html
-     *  https://lemire.me/blog/2016/06/27/a-fast-alternative-to-the-modulo-reduction/
-     *  https://arxiv.org/abs/1805.10941 or https://dl.acm.org/citation.cfm?id=3230636
-     */
-    uint32_t PcgRNG::get_bounded_uint32(uint32_t range)
-    {
-        uint32_t x = get_uint32();
-        uint64_t m = uint64_t(x) * uint64_t(range);
-        uint32_t l = uint32_t(m);
-        if (l < range)
-        {
-            // TODO: will this generate warnings somewhere? the PCG c++
-            // implementation has a different version of this step that may be
-            // useful.
-            uint32_t t = -range;
-
-            if (t >= range)
-            {
-                t -= range;
-                if (t >= range)
-                    t %= range;
-            }
-            while (l < t)
-            {
-                x = get_uint32();
-                m = uint64_t(x) * uint64_t(range);
-                l = uint32_t(m);
-            }
-        }
-        return m >> 32;
-    }
-
     // Initialization values only.
     // don't generate unseeded versions of this. But if you must, go get the
     // constants from the official PCG implementation...
@@ -608,6 +608,22 @@ static void _decrement_simple_duration(duration_type dur, int delay)
 }
 
 
+/**
+ * The durations that simply tick down over time, found once rather than by
+ * looking every duration up each turn.
+ */
+static const vector<duration_type> &_simple_durations()
+{
+    static vector<duration_type> durs;
+    if (durs.empty())
+    {
+        for (int i = 0; i < NUM_DURATIONS; ++i)
+            if (duration_decrements_normally((duration_type) i))
+                durs.push_back((duration_type) i);
+    }
+    return durs;
+}
+
 /**
  * Decrement player durations based on how long the player's turn lasted in aut.
  */
@@ -845,9 +861,18 @@ static void _decrement_durations()
     }
 
     // these should be after decr_ambrosia, transforms, liquefying, etc.
-    for (int i = 0; i < NUM_DURATIONS; ++i)
-        if (duration_decrements_normally((duration_type) i))
-            _decrement_simple_duration((duration_type) i, delay);
+    for (duration_type dur : _simple_durations())
+    {
+        if (you.duration[dur])
+            _decrement_simple_duration(dur, delay);
+        else
+        {
+            // The expiry fuzz has always been rolled for every one of
+            // these, in effect or not; keep doing so, so that seeds play
+            // out the same.
+            duration_expire_offset(dur);
+        }
+    }
 }
 
 static void _handle_emergency_flight()
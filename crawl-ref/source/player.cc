@@ -44,6 +44,7 @@
 #include "hints.h"
 #include "hiscores.h"
 #include "invent.h"
+#include "item-name.h"
 #include "item-prop.h"
 #include "items.h"
 #include "item-use.h"
@@ -1186,15 +1187,21 @@ static bool _mons_inhibits_regen(const monster &m)
                 && !m.submerged();
 }
 
+/// Could nearby monsters inhibit the player's hp regeneration at all?
+bool regeneration_can_be_inhibited()
+{
+    // used mainly for resting: don't add anything here that can be waited off
+    return you.get_mutation_level(MUT_INHIBITED_REGENERATION) == 1
+           || you.duration[DUR_COLLAPSE]
+           || (you.has_mutation(MUT_VAMPIRISM) && !you.vampire_alive);
+}
+
 /// Is the player's hp regeneration inhibited by nearby monsters?
 /// If the optional monster argument is provided, instead check whether that
 /// specific monster inhibits regeneration.
 bool regeneration_is_inhibited(const monster *m)
 {
-    // used mainly for resting: don't add anything here that can be waited off
-    if (you.get_mutation_level(MUT_INHIBITED_REGENERATION) == 1
-        || you.duration[DUR_COLLAPSE]
-        || (you.has_mutation(MUT_VAMPIRISM) && !you.vampire_alive))
+    if (regeneration_can_be_inhibited())
     {
         if (m)
             return _mons_inhibits_regen(*m);
@@ -3536,19 +3543,19 @@ int slaying_bonus(bool throwing, bool random)
 // a given property. Slow if any randarts are worn, so avoid where
 // possible. If `matches' is non-nullptr, items with nonzero property are
 // pushed onto *matches.
-int player::scan_artefacts(artefact_prop_type which_property,
-                           vector<const item_def *> *matches) const
+static int _scan_artefacts(const player &p, artefact_prop_type which_property,
+                           vector<const item_def *> *matches)
 {
     int retval = 0;
 
     for (int i = EQ_FIRST_EQUIP; i < NUM_EQUIP; ++i)
     {
-        if (melded[i] || equip[i] == -1)
+        if (p.melded[i] || p.equip[i] == -1)
             continue;
 
-        const int eq = equip[i];
+        const int eq = p.equip[i];
 
-        const item_def &item = inv[eq];
+        const item_def &item = p.inv[eq];
 
         // Only weapons give their effects when in our hands.
         if (i == EQ_WEAPON
@@ -3569,17 +3576,58 @@ int player::scan_artefacts(artefact_prop_type which_property,
             matches->push_back(&item);
     }
 
-    if (you.active_talisman.defined() && is_artefact(you.active_talisman))
+    if (p.active_talisman.defined() && is_artefact(p.active_talisman))
     {
-        const int val = artefact_property(you.active_talisman, which_property);
+        const int val = artefact_property(p.active_talisman, which_property);
         retval += val;
         if (matches && val)
-            matches->push_back(&you.active_talisman);
+            matches->push_back(&p.active_talisman);
     }
 
     return retval;
 }
 
+void player::invalidate_artefact_cache() const
+{
+    artp_known.reset();
+}
+
+int player::scan_artefacts(artefact_prop_type which_property,
+                           vector<const item_def *> *matches) const
+{
+    // Callers wanting the items themselves are rare; don't cache for them.
+    if (matches)
+        return _scan_artefacts(*this, which_property, matches);
+
+    for (int i = EQ_FIRST_EQUIP; i < NUM_EQUIP; ++i)
+    {
+        if (artp_equip[i] != equip[i] || artp_melded[i] != melded[i])
+        {
+            artp_known.reset();
+            artp_equip = equip;
+            artp_melded = melded;
+            break;
+        }
+    }
+
+    if (!artp_known[which_property])
+    {
+        artp_totals[which_property] = _scan_artefacts(*this, which_property,
+                                                      nullptr);
+        artp_known.set(which_property);
+    }
+#ifdef DEBUG
+    else
+    {
+        ASSERTM(artp_totals[which_property]
+                    == _scan_artefacts(*this, which_property, nullptr),
+                "stale artefact property %d", which_property);
+    }
+#endif
+
+    return artp_totals[which_property];
+}
+
 bool player::using_talisman(const item_def &talisman) const
 {
     if (!active_talisman.defined())
@@ -5156,6 +5204,7 @@ player::player()
 
     equip.init(-1);
     melded.reset();
+    artp_known.reset();
     unrand_reacts.reset();
     activated.reset();
     last_unequip = -1;
@@ -5284,6 +5333,7 @@ player::player()
     dactions.clear();
     level_stack.clear();
     type_ids.init(false);
+    item_knowledge_changed();
 
     banished_by.clear();
     banished_power = 0;
@@ -665,6 +665,7 @@ public:
         override;
     int scan_artefacts(artefact_prop_type which_property,
                        vector<const item_def *> *matches = nullptr) const override;
+    void invalidate_artefact_cache() const;
 
     int infusion_amount() const;
 
@@ -941,6 +942,13 @@ protected:
     void _removed_fearmonger(bool quiet = false);
     bool _possible_fearmonger(const monster* mon) const;
 
+    // scan_artefacts() totals, kept while equip and melded are what they
+    // were when the totals were taken. Anything else that changes them
+    // (the talisman, loading a game) calls invalidate_artefact_cache().
+    mutable FixedVector<int, ARTP_NUM_PROPERTIES> artp_totals;
+    mutable FixedBitVector<ARTP_NUM_PROPERTIES> artp_known;
+    mutable FixedVector<int8_t, NUM_EQUIP> artp_equip;
+    mutable FixedBitVector<NUM_EQUIP> artp_melded;
 };
 
 class monster;
@@ -1014,6 +1022,7 @@ int player_channeling();
 int player_prot_life(bool allow_random = true, bool temp = true,
                      bool items = true);
 
+bool regeneration_can_be_inhibited();
 bool regeneration_is_inhibited(const monster *m=nullptr);
 int player_regen();
 int player_mp_regen();
@@ -274,8 +274,14 @@ int roll_dice(int num, int size)
     {
         ret += num;     // since random2() is zero based
 
-        for (int i = 0; i < num; i++)
-            ret += random2(size);
+        // The same draws as calling random2(size) num times, without looking
+        // up the generator for each one.
+        if (size > 1)
+        {
+            rng::PcgRNG &rng = rng::current_generator();
+            for (int i = 0; i < num; i++)
+                ret += rng.get_bounded_uint32(size);
+        }
     }
 
     return ret;
@@ -331,8 +337,9 @@ int random2avg(int max, int rolls)
 {
     int sum = random2(max);
 
+    rng::PcgRNG &rng = rng::current_generator();
     for (int i = 0; i < (rolls - 1); i++)
-        sum += random2(max + 1);
+        sum += max + 1 > 1 ? rng.get_bounded_uint32(max + 1) : 0;
 
     return sum / rolls;
 }
@@ -340,8 +347,12 @@ int random2avg(int max, int rolls)
 int random2min(int max, int rolls)
 {
     int res = random2(max);
+    if (max <= 1)
+        return res;
+
+    rng::PcgRNG &rng = rng::current_generator();
     for (int i = 0; i < (rolls -1); i++)
-        res = min(res, random2(max));
+        res = min(res, (int) rng.get_bounded_uint32(max));
 
     return res;
 }
@@ -349,8 +360,12 @@ int random2min(int max, int rolls)
 int random2max(int ran, int rolls)
 {
     int res = random2(ran);
+    if (ran <= 1)
+        return res;
+
+    rng::PcgRNG &rng = rng::current_generator();
     for (int i = 0; i < (rolls -1); i++)
-        res = max(res, random2(ran));
+        res = max(res, (int) rng.get_bounded_uint32(ran));
 
     return res;
 }
@@ -381,9 +396,17 @@ int biased_random2(int max, int n)
  */
 int binomial(unsigned n_trials, unsigned trial_prob, unsigned scale)
 {
+    // As x_chance_in_y(trial_prob, scale) for each trial: nothing is drawn
+    // when the outcome is certain.
+    if (trial_prob == 0 || !n_trials)
+        return 0;
+    if (trial_prob >= scale)
+        return n_trials;
+
     int count = 0;
+    rng::PcgRNG &rng = rng::current_generator();
     for (unsigned i = 0; i < n_trials; ++i)
-        if (::x_chance_in_y(trial_prob, scale))
+        if (rng.get_bounded_uint32(scale) < trial_prob)
             count++;
 
     return count;
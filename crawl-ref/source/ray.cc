@@ -102,8 +102,39 @@ static coord_def floor_vec(const geom::vector &v)
     return coord_def(x, y);
 }
 
+void ray_def::set_path(const coord_def *cells, int length,
+                       const coord_def &origin, const coord_def &sign)
+{
+    ASSERT(!on_corner);
+    ASSERT(floor_vec(r.start) == origin);
+    path = cells;
+    path_length = length;
+    path_pos = 0;
+    path_origin = origin;
+    path_sign = sign;
+}
+
+void ray_def::sync()
+{
+    if (!path)
+        return;
+
+    const int steps = path_pos;
+    path = nullptr;
+    for (int i = 0; i < steps; ++i)
+        advance();
+}
+
 coord_def ray_def::pos() const
 {
+    if (path)
+    {
+        if (!path_pos)
+            return path_origin;
+        const coord_def c = path[path_pos - 1];
+        return path_origin + coord_def(path_sign.x * c.x, path_sign.y * c.y);
+    }
+
     ASSERT(_valid());
     // XXX: pretty arbitrary if we're just on a corner.
     return floor_vec(r.start);
@@ -177,6 +208,8 @@ static bool _advance_from_non_diamond(geom::ray *r)
 // The ray is in a legal state to be passed around externally.
 bool ray_def::_valid() const
 {
+    if (path)
+        return path_pos >= 0 && path_pos <= path_length;
     return isfinite(r.start.x) && isfinite(r.start.y)
            && isfinite(r.dir.x) && isfinite(r.dir.y)
            && (on_corner && is_corner(r.start) && bad_corner(r)
@@ -194,6 +227,17 @@ static geom::vector _normalize(const geom::vector &v)
 // is a good ray so far.
 bool ray_def::advance()
 {
+    if (path)
+    {
+        if (path_pos < path_length)
+        {
+            // Precomputed paths never touch corners.
+            path_pos++;
+            return true;
+        }
+        sync();
+    }
+
     ASSERT(_valid());
     r.dir = _normalize(r.dir);
     if (on_corner)
@@ -226,6 +270,13 @@ bool ray_def::advance()
 
 void ray_def::regress()
 {
+    if (path && path_pos > 0)
+    {
+        path_pos--;
+        return;
+    }
+    sync();
+
     ASSERT(_valid());
     r.dir = -r.dir;
     advance();
@@ -475,6 +526,7 @@ static geom::ray _bounce_corner(const geom::ray &rorig, const coord_def &side,
 // Nudge an on-corner ray to be inside the diamond.
 void ray_def::nudge_inside()
 {
+    sync();
     ASSERT(on_corner);
     geom::vector centre(pos().x + 0.5, pos().y + 0.5);
     // Move a little bit towards cell center.
@@ -485,6 +537,7 @@ void ray_def::nudge_inside()
 
 void ray_def::bounce(const reflect_grid &rg)
 {
+    sync();
     ASSERT(_valid());
     ASSERT(!rg(coord_def(0,0))); // The cell we bounce from is not solid.
 #ifdef ASSERTS
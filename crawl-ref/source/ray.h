@@ -13,13 +13,15 @@ typedef SquareArray<bool,1> reflect_grid;
 
 struct ray_def
 {
+    // While the ray is following a path (see set_path), r still describes
+    // the start of it; call sync() before looking at r.
     geom::ray r;
     bool on_corner;
     int cycle_idx;
 
-    ray_def() : on_corner(false), cycle_idx(-1) {}
+    ray_def() : on_corner(false), cycle_idx(-1), path(nullptr) {}
     ray_def(const geom::ray& _r)
-        : r(_r), on_corner(false), cycle_idx(-1) {}
+        : r(_r), on_corner(false), cycle_idx(-1), path(nullptr) {}
 
     coord_def pos() const;
     bool advance();
@@ -27,5 +29,21 @@ struct ray_def
     void nudge_inside();
     void regress();
 
+    // Follow precomputed cells instead of tracing the geometry: the i-th
+    // advance() from here moves to origin + sign * cells[i-1], with sign
+    // a (+-1, +-1) quadrant mirror. The cells must be exactly those that
+    // r passes through. Past the last cell, the ray goes back to r.
+    void set_path(const coord_def *cells, int length,
+                  const coord_def &origin, const coord_def &sign);
+    // Bring r up to date with the cells we've stepped along.
+    void sync();
+
     bool _valid() const;
+
+private:
+    const coord_def *path;
+    int path_length;
+    int path_pos;
+    coord_def path_origin;
+    coord_def path_sign;
 };
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <algorithm>
+#include <string>
 #ifdef USE_TILE
  #include <png.h>
 #endif
@@ -291,4 +292,45 @@ bool write_png(const char *filename, tile_colour *pixels,
 
     return true;
 }
+
+// The header is "CRTX", then the format version, width and height as
+// little-endian 32-bit numbers, then the RGBA pixels row by row.
+static bool _write_u32(FILE *fp, unsigned int n)
+{
+    const unsigned char bytes[4] = { (unsigned char)(n & 0xff),
+                                     (unsigned char)((n >> 8) & 0xff),
+                                     (unsigned char)((n >> 16) & 0xff),
+                                     (unsigned char)((n >> 24) & 0xff) };
+    return fwrite(bytes, 1, 4, fp) == 4;
+}
+
+bool write_texture(const char *png_filename, tile_colour *pixels,
+                   unsigned int width, unsigned int height)
+{
+    string filename = png_filename;
+    const size_t ext = filename.rfind(".png");
+    if (ext != string::npos)
+        filename.erase(ext);
+    filename += ".tex";
+
+    FILE *fp = fopen(filename.c_str(), "wb");
+    if (!fp)
+    {
+        fprintf(stderr, "Error: Can't open file '%s' for write.\n",
+                filename.c_str());
+        return false;
+    }
+
+    const size_t size = (size_t)width * height;
+    bool success = fwrite("CRTX", 1, 4, fp) == 4
+                   && _write_u32(fp, 1)
+                   && _write_u32(fp, width)
+                   && _write_u32(fp, height)
+                   && fwrite(pixels, sizeof(tile_colour), size, fp) == size;
+    fclose(fp);
+
+    if (!success)
+        fprintf(stderr, "Error: failed to write '%s'.\n", filename.c_str());
+    return success;
+}
 #endif
@@ -78,4 +78,9 @@ public:
 
 bool write_png(const char *filename, tile_colour *pixels,
                unsigned int width, unsigned int height);
+// Write the pixels uncompressed, in the container that local tiles load in
+// place of the PNG if it can; see SDLWrapper::load_texture. The file is
+// named after the PNG, with .tex in place of .png.
+bool write_texture(const char *png_filename, tile_colour *pixels,
+                   unsigned int width, unsigned int height);
 #endif
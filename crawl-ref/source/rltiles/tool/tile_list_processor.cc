@@ -923,6 +923,55 @@ void tile_list_processor::add_abstracts(
     }
 }
 
+// The image of an abstract list is an atlas of the pages it names, stacked
+// top to bottom in order, so that local tiles can draw them from a single
+// texture. Each page starts at the sum of the heights of those above it;
+// see ImageManager::load_textures.
+bool tile_list_processor::write_atlas(const char *filename)
+{
+#ifdef USE_TILE
+    vector<tile*> pages;
+    int width = 0;
+    int height = 0;
+    for (const string_pair &abstract : m_abstract)
+    {
+        string page = abstract.first + ".png";
+        tile *img = new tile();
+        pages.push_back(img);
+        if (!img->load(page))
+        {
+            fprintf(stderr, "Error: couldn't load '%s' for '%s'.\n",
+                    page.c_str(), filename);
+            for (tile *t : pages)
+                delete t;
+            return false;
+        }
+        width = max(width, img->width());
+        height += img->height();
+    }
+
+    tile_colour *pixels = new tile_colour[width * height];
+    memset(pixels, 0, width * height * sizeof(tile_colour));
+
+    int sy = 0;
+    for (tile *img : pages)
+    {
+        for (int y = 0; y < img->height(); y++)
+            for (int x = 0; x < img->width(); x++)
+                pixels[x + (sy+y)*width] = img->get_pixel(x, y);
+        sy += img->height();
+        delete img;
+    }
+
+    bool success = write_png(filename, pixels, width, height)
+                   && write_texture(filename, pixels, width, height);
+    delete[] pixels;
+    return success;
+#else
+    return true;
+#endif
+}
+
 bool tile_list_processor::write_data(bool image, bool code)
 {
     if (m_name == "")
@@ -966,20 +1015,8 @@ bool tile_list_processor::write_data(bool image, bool code)
                 if (!m_page.write_image(filename))
                     return false;
             }
-            else
-            {
-                // Write an empty file.
-                char filename[1024];
-                snprintf(filename, sizeof(filename), "%s.png", lcname.c_str());
-                FILE *fp = fopen(filename, "w");
-                if (!fp)
-                {
-                    fprintf(stderr, "Error: couldn't open '%s' for write.\n",
-                            filename);
-                    return false;
-                }
-                fclose(fp);
-            }
+            else if (!write_atlas(filename))
+                return false;
         }
     }
 
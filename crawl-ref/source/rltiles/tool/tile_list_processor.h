@@ -21,6 +21,7 @@ protected:
     bool process_line(char *read_line, const char *list_file, int line);
     void add_image(tile &img, const char *enumname);
     void recolour(tile &img);
+    bool write_atlas(const char *filename);
 
     void add_abstracts(
         FILE *fp,
@@ -163,7 +163,8 @@ bool tile_page::write_image(const char *filename)
             }
     }
 
-    bool success = write_png(filename, pixels, m_width, m_height);
+    bool success = write_png(filename, pixels, m_width, m_height)
+                   && write_texture(filename, pixels, m_width, m_height);
     delete[] pixels;
     return success;
 #else
@@ -0,0 +1,93 @@
+-- Times the LOS primitives over a fixed set of layouts: the debug_los test
+-- maps, some ordinary levels, and procedural caves with and without smoke.
+--
+-- Usage: los_bench [<calls per function>]
+
+local args = script.simple_args()
+local calls = tonumber(args[1] or 20000)
+if not calls or calls <= 0 then
+  script.usage("Usage: los_bench [<calls per function>]")
+end
+
+local functions = { "losight", "cell_see_cell", "find_ray",
+                    "invalidate_los_around" }
+
+-- Use the same points every run, so that numbers can be compared.
+debug.reset_rng(1)
+
+local totals = { }
+for _, f in ipairs(functions) do
+  totals[f] = { ns = 0, misses = 0, runs = 0 }
+end
+
+local function report(name, results)
+  local line = string.format("%-24s", name)
+  for _, f in ipairs(functions) do
+    line = line .. string.format(" %10.0f", results[f].ns)
+    if f == "cell_see_cell" or f == "find_ray" then
+      line = line .. string.format(" %7d", results[f].misses)
+    end
+  end
+  crawl.stderr(line)
+end
+
+local function bench_level(name)
+  local results = { }
+  for _, f in ipairs(functions) do
+    -- Start each function cold, as a new turn would.
+    debug.los_changed()
+    local ns, misses = debug.los_bench(f, calls)
+    results[f] = { ns = ns, misses = misses }
+    totals[f].ns = totals[f].ns + ns
+    totals[f].misses = totals[f].misses + misses
+    totals[f].runs = totals[f].runs + 1
+  end
+  report(name, results)
+end
+
+local function add_smoke(clouds)
+  for i = 1, clouds do
+    local x = crawl.random_range(1, dgn.GXM - 2)
+    local y = crawl.random_range(1, dgn.GYM - 2)
+    if not feat.is_solid(dgn.grid(x, y)) then
+      dgn.place_cloud(x, y, "grey smoke", 10)
+    end
+  end
+end
+
+crawl.stderr(string.format("%d calls per function; ns/call (misses)", calls))
+crawl.stderr(string.format("%-24s %10s %10s %7s %10s %7s %10s", "layout",
+                           "losight", "csc", "miss", "find_ray", "miss", "inval"))
+
+local map = dgn.map_by_tag("debug_los")
+assert(map, "Could not find debug-los maps (tag 'debug_los')")
+while map do
+  dgn.reset_level()
+  dgn.tags(map, "no_rotate no_vmirror no_hmirror no_pool_fixup")
+  dgn.with_map_anchors(30, 30, function ()
+                                 return dgn.place_map(map, true, true)
+                               end)
+  bench_level(dgn.name(map))
+  map = dgn.map_by_tag("debug_los")
+end
+
+for _, place in ipairs({ "D:1", "D:8", "Lair:1", "Elf:1" }) do
+  debug.goto_place(place)
+  test.regenerate_level()
+  bench_level(place)
+end
+
+for _, layout in ipairs({ "chaos", "newabyss", "forest" }) do
+  dgn.reset_level()
+  debug.proc_layout(layout, 1)
+  bench_level(layout)
+  add_smoke(60)
+  bench_level(layout .. " + smoke")
+end
+
+local mean = { }
+for _, f in ipairs(functions) do
+  mean[f] = { ns = totals[f].ns / totals[f].runs, misses = totals[f].misses }
+end
+crawl.stderr("")
+report("mean ns (total misses)", mean)
@@ -0,0 +1,49 @@
+-- Times full passes of monster_iterator, on ordinary levels and on the same
+-- levels packed with as many monsters as will fit, then after dismissing
+-- them again.
+--
+-- Usage: mon_iter_bench [<passes per run>]
+
+local args = script.simple_args()
+local passes = tonumber(args[1] or 20000)
+if not passes or passes <= 0 then
+  script.usage("Usage: mon_iter_bench [<passes per run>]")
+end
+
+debug.reset_rng(1)
+
+local fillers = { "rat", "goblin", "orc", "jackal", "hobgoblin" }
+
+local function pack_level()
+  local want = dgn.max_monsters() - 10
+  local placed, tries = 0, 0
+  while placed < want and tries < want * 20 do
+    tries = tries + 1
+    local x = crawl.random_range(1, dgn.GXM - 2)
+    local y = crawl.random_range(1, dgn.GYM - 2)
+    local spec = fillers[crawl.random_range(1, #fillers)]
+    if not feat.is_solid(dgn.grid(x, y)) and not dgn.mons_at(x, y)
+       and dgn.create_monster(x, y, spec) then
+      placed = placed + 1
+    end
+  end
+end
+
+local function bench(name)
+  local ns, seen, slots = debug.monster_iter_bench(passes)
+  crawl.stderr(string.format("%-24s %10.0f %8d %8d", name, ns, seen, slots))
+end
+
+crawl.stderr(string.format("%d passes per run", passes))
+crawl.stderr(string.format("%-24s %10s %8s %8s", "level", "ns/pass",
+                           "monsters", "slots"))
+
+for _, place in ipairs({ "D:1", "Abyss:1", "Pan" }) do
+  debug.goto_place(place)
+  test.regenerate_level()
+  bench(place)
+  pack_level()
+  bench(place .. " packed")
+  dgn.dismiss_monsters()
+  bench(place .. " dismissed")
+end
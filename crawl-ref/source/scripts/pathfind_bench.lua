@@ -0,0 +1,60 @@
+-- Times monster pathfinding over some ordinary levels and procedural
+-- caves, at the tracking ranges animals and humanoids use.
+--
+-- Usage: pathfind_bench [<pathfinders per run>]
+
+local args = script.simple_args()
+local calls = tonumber(args[1] or 2000)
+if not calls or calls <= 0 then
+  script.usage("Usage: pathfind_bench [<pathfinders per run>]")
+end
+
+-- mons_tracking_range() for animals and humanoids, and for humanoids
+-- native to the branch with a marked foe.
+local ranges = { 5, 7, 50 }
+
+-- Use the same points every run, so that numbers can be compared.
+debug.reset_rng(1)
+
+local totals = { }
+for _, r in ipairs(ranges) do
+  totals[r] = { ns = 0, runs = 0 }
+end
+
+local function bench_level(name)
+  local line = string.format("%-16s", name)
+  for _, r in ipairs(ranges) do
+    local ns, found = debug.pathfind_bench(calls, r)
+    totals[r].ns = totals[r].ns + ns
+    totals[r].runs = totals[r].runs + 1
+    line = line .. string.format(" %10.0f %6d", ns, found)
+  end
+  crawl.stderr(line)
+end
+
+crawl.stderr(string.format("%d pathfinders per run; ns/pathfinder (paths found)",
+                           calls))
+local header = string.format("%-16s", "layout")
+for _, r in ipairs(ranges) do
+  header = header .. string.format(" %10s %6s", "range " .. r, "found")
+end
+crawl.stderr(header)
+
+for _, place in ipairs({ "D:1", "D:8", "Lair:1", "Elf:1" }) do
+  debug.goto_place(place)
+  test.regenerate_level()
+  bench_level(place)
+end
+
+for _, layout in ipairs({ "chaos", "newabyss", "forest" }) do
+  dgn.reset_level()
+  debug.proc_layout(layout, 1)
+  bench_level(layout)
+end
+
+local mean = string.format("%-16s", "mean ns")
+for _, r in ipairs(ranges) do
+  mean = mean .. string.format(" %10.0f %6s", totals[r].ns / totals[r].runs, "")
+end
+crawl.stderr("")
+crawl.stderr(mean)
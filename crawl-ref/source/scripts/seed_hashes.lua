@@ -0,0 +1,67 @@
+-- Print a hash of every pregenerated level for some seeds, to check that
+-- seeded dungeons come out the same from one build to the next.
+--
+-- Like seed_explorer.lua, this needs a debug build and util/fake_pty:
+--   util/fake_pty ./crawl -script seed_hashes.lua 1 2 3 [-depth <depth>]
+--
+-- Each line is "<seed> <level> <hash>", where the hash covers the level's
+-- features, shops, items and monsters (see level_hash() in dbg-util.cc).
+-- util/seed-hashes runs a process per seed in parallel and collects the
+-- output in order, which is quicker for more than a few seeds.
+
+crawl_require('dlua/explorer.lua')
+
+local args = crawl.script_args()
+local seeds = { }
+local max_depth = explorer.level_to_gendepth("Tomb:3")
+local i = 1
+while i <= #args do
+    if args[i] == "-depth" then
+        max_depth = explorer.to_gendepth(args[i + 1] or "")
+        if max_depth == nil then
+            script.usage("<depth> must be a level name/branch, a number, "
+                         .. "or 'all'!")
+        end
+        i = i + 1
+    else
+        seeds[#seeds + 1] = args[i]
+    end
+    i = i + 1
+end
+
+if #seeds == 0 then
+    script.usage("Usage: seed_hashes.lua <seed> [<seed> ...] "
+                 .. "[-depth <depth>]")
+end
+
+local function hash_place(seed, lvl)
+    if not dgn.br_exists(string.match(lvl, "[^:]+")) then
+        return false
+    end
+    debug.goto_place(lvl)
+    debug.generate_level()
+    crawl.stderr(seed .. " " .. lvl .. " " .. debug.level_hash())
+    return true
+end
+
+for _, seed in ipairs(seeds) do
+    -- strings, so that seeds keep all 64 bits
+    local used = debug.reset_rng(tostring(seed))
+    dgn.reset_level()
+    debug.flush_map_memory()
+    debug.dungeon_setup()
+    for depth, lvl in ipairs(explorer.generation_order) do
+        if depth > max_depth or crawl.seen_hups() > 0 then
+            break
+        end
+        if hash_place(used, lvl) then
+            local where = you.where()
+            for _, port in ipairs(explorer.portal_order) do
+                if where == dgn.level_name(dgn.br_entrance(port)) then
+                    hash_place(used, port)
+                    debug.goto_place(where)
+                end
+            end
+        end
+    end
+end
@@ -36,7 +36,10 @@
 #include "view.h"
 #include "viewchar.h"
 
-static noise_grid _noise_grid;
+// The grid noises are registered on, and reset grids to take its place
+// while the noises on it propagate.
+static unique_ptr<noise_grid> _noise_grid(new noise_grid);
+static vector<unique_ptr<noise_grid>> _spare_noise_grids;
 static void _actor_apply_noise(actor *act,
                                const coord_def &apparent_source,
                                int noise_intensity_millis);
@@ -822,16 +825,23 @@ void yell(const actor* mon)
 
 void apply_noises()
 {
-    // [ds] This copying isn't awesome, but we cannot otherwise handle
-    // the case where one set of noises wakes up monsters who then let
-    // out yips of their own, modifying _noise_grid while it is in the
-    // middle of propagate_noise().
-    if (_noise_grid.dirty())
+    // One set of noises can wake up monsters who then let out yips of
+    // their own, so _noise_grid mustn't change while it is in the middle
+    // of propagate_noise(). Swap a clean grid in for those to go on.
+    if (_noise_grid->dirty())
     {
-        noise_grid copy = _noise_grid;
-        // Reset the main grid.
-        _noise_grid.reset();
-        copy.propagate_noise();
+        unique_ptr<noise_grid> pending = move(_noise_grid);
+        if (_spare_noise_grids.empty())
+            _noise_grid.reset(new noise_grid);
+        else
+        {
+            _noise_grid = move(_spare_noise_grids.back());
+            _spare_noise_grids.pop_back();
+        }
+
+        pending->propagate_noise();
+        pending->reset();
+        _spare_noise_grids.push_back(move(pending));
     }
 }
 
@@ -877,7 +887,7 @@ bool noisy(int original_loudness, const coord_def& where,
     // Add +1 to scaled_loudness so that all squares adjacent to a
     // sound of loudness 1 will hear the sound.
     const string noise_msg(msg ? msg : "");
-    _noise_grid.register_noise(
+    _noise_grid->register_noise(
         noise_t(where, noise_msg, (scaled_loudness + 1) * multiplier, who,
                 fake_noise));
 
@@ -915,10 +925,8 @@ bool fake_noisy(int loudness, const coord_def& where)
 
 // Currently noise attenuation depends solely on the feature in question.
 // Permarock walls are assumed to completely kill noise.
-static int _noise_attenuation_millis(const coord_def &pos)
+static int _feat_noise_attenuation_millis(dungeon_feature_type feat)
 {
-    const dungeon_feature_type feat = env.grid(pos);
-
     if (feat_is_permarock(feat))
         return NOISE_ATTENUATION_COMPLETE;
 
@@ -930,6 +938,24 @@ static int _noise_attenuation_millis(const coord_def &pos)
                                           1);
 }
 
+// Looked up once per cell the noise reaches, so worked out for every
+// feature in advance.
+static int _noise_attenuation_millis(const coord_def &pos)
+{
+    static int attenuation[NUM_FEATURES];
+    static bool filled = false;
+    if (!filled)
+    {
+        for (int f = 0; f < NUM_FEATURES; ++f)
+        {
+            attenuation[f] = _feat_noise_attenuation_millis(
+                                 static_cast<dungeon_feature_type>(f));
+        }
+        filled = true;
+    }
+    return attenuation[env.grid(pos)];
+}
+
 noise_cell::noise_cell()
     : neighbour_delta(0, 0), noise_id(-1), noise_intensity_millis(0),
       noise_travel_distance(0)
@@ -1010,8 +1036,9 @@ void noise_grid::propagate_noise()
     dprf(DIAG_NOISE, "noise_grid: %u noises to apply",
          (unsigned int)noises.size());
 #endif
-    vector<coord_def> noise_perimeter[2];
     int circ_index = 0;
+    noise_perimeter[0].clear();
+    noise_perimeter[1].clear();
 
     for (const noise_t &noise : noises)
         noise_perimeter[circ_index].push_back(noise.noise_source);
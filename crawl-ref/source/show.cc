@@ -115,58 +115,59 @@ static void _update_feat_at(const coord_def &gp)
     if (feat_is_trap(feat))
         trap = get_trap_type(gp);
 
-    env.map_knowledge(gp).set_feature(feat, colour, trap);
+    map_cell &cell = env.map_knowledge(gp);
+    cell.set_feature(feat, colour, trap);
 
     if (haloed(gp))
-        env.map_knowledge(gp).flags |= MAP_HALOED;
+        cell.flags |= MAP_HALOED;
 
     if (umbraed(gp))
-        env.map_knowledge(gp).flags |= MAP_UMBRAED;
+        cell.flags |= MAP_UMBRAED;
 
     if (silenced(gp))
-        env.map_knowledge(gp).flags |= MAP_SILENCED;
+        cell.flags |= MAP_SILENCED;
 
     if (liquefied(gp, false))
-        env.map_knowledge(gp).flags |= MAP_LIQUEFIED;
+        cell.flags |= MAP_LIQUEFIED;
 
     if (orb_haloed(gp))
-        env.map_knowledge(gp).flags |= MAP_ORB_HALOED;
+        cell.flags |= MAP_ORB_HALOED;
 
     if (quad_haloed(gp))
-        env.map_knowledge(gp).flags |= MAP_QUAD_HALOED;
+        cell.flags |= MAP_QUAD_HALOED;
 
     if (disjunction_haloed(gp))
-        env.map_knowledge(gp).flags |= MAP_DISJUNCT;
+        cell.flags |= MAP_DISJUNCT;
 
     if (is_sanctuary(gp))
     {
         if (testbits(env.pgrid(gp), FPROP_SANCTUARY_1))
-            env.map_knowledge(gp).flags |= MAP_SANCTUARY_1;
+            cell.flags |= MAP_SANCTUARY_1;
         else if (testbits(env.pgrid(gp), FPROP_SANCTUARY_2))
-            env.map_knowledge(gp).flags |= MAP_SANCTUARY_2;
+            cell.flags |= MAP_SANCTUARY_2;
     }
 
     if (you.get_beholder(gp))
-        env.map_knowledge(gp).flags |= MAP_WITHHELD;
+        cell.flags |= MAP_WITHHELD;
 
     if (you.get_fearmonger(gp))
-        env.map_knowledge(gp).flags |= MAP_WITHHELD;
+        cell.flags |= MAP_WITHHELD;
 
     if (you.is_nervous() && you.see_cell(gp) && !monster_at(gp))
-        env.map_knowledge(gp).flags |= MAP_WITHHELD;
+        cell.flags |= MAP_WITHHELD;
 
     if ((feat_is_stone_stair(feat)
          || feat_is_escape_hatch(feat))
         && is_exclude_root(gp))
     {
-        env.map_knowledge(gp).flags |= MAP_EXCLUDED_STAIRS;
+        cell.flags |= MAP_EXCLUDED_STAIRS;
     }
 
     if (is_bloodcovered(gp))
-        env.map_knowledge(gp).flags |= MAP_BLOODY;
+        cell.flags |= MAP_BLOODY;
 
     if (env.level_state & LSTATE_SLIMY_WALL && slime_wall_neighbour(gp))
-        env.map_knowledge(gp).flags |= MAP_CORRODING;
+        cell.flags |= MAP_CORRODING;
 
     // We want to give non-solid terrain and the icy walls themselves MAP_ICY
     // so we can properly recolor both.
@@ -176,11 +177,11 @@ static void _update_feat_at(const coord_def &gp)
                 && count_adjacent_icy_walls(gp)
                 && you.see_cell_no_trans(gp)))
     {
-        env.map_knowledge(gp).flags |= MAP_ICY;
+        cell.flags |= MAP_ICY;
     }
 
     if (emphasise(gp))
-        env.map_knowledge(gp).flags |= MAP_EMPHASIZE;
+        cell.flags |= MAP_EMPHASIZE;
 
     // Tell the world first.
     dungeon_events.fire_position_event(DET_PLAYER_IN_LOS, gp);
@@ -429,8 +430,7 @@ static void _update_monster(monster* mons)
     if (mons->visible_to(&you))
     {
         mons->ensure_has_client_id();
-        monster_info mi(mons);
-        env.map_knowledge(gp).set_monster(mi);
+        env.map_knowledge(gp).set_monster(mons);
         return;
     }
 
@@ -531,6 +531,7 @@ void force_show_update_at(const coord_def &gp, layers_type layers)
 void show_init(layers_type layers)
 {
     clear_terrain_visibility();
+    invalidate_travel_terrain();
     if (crawl_state.game_is_arena())
     {
         for (rectangle_iterator ri(crawl_view.vgrdc, LOS_MAX_RANGE); ri; ++ri)
@@ -544,16 +545,28 @@ void show_init(layers_type layers)
 
     ASSERT(you.on_current_level);
 
-    vector <coord_def> update_locs;
+    // This runs on every redraw, so the list of cells is kept for the next
+    // call rather than allocated each time. It's taken out while in use, in
+    // case one of the position events below leads back here.
+    static vector<coord_def> spare_locs;
+    vector<coord_def> update_locs;
+    update_locs.swap(spare_locs);
+    update_locs.clear();
+
+    // Everything the iterator gives is in view, which is the first thing
+    // show_update_at() would check.
     for (vision_iterator ri(you); ri; ++ri)
     {
-        show_update_at(*ri, layers);
+        env.map_knowledge(*ri).clear_data();
+        force_show_update_at(*ri, layers);
         update_locs.push_back(*ri);
     }
 
     // Need to clear these update flags now so they don't persist.
     for (coord_def loc : update_locs)
         env.map_knowledge(loc).flags &= ~MAP_INVISIBLE_UPDATE;
+
+    spare_locs.swap(update_locs);
 }
 
 // Emphasis may change while off-level. This catches up.
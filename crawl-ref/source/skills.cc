@@ -875,30 +875,24 @@ void reset_training()
     // In automatic mode, we fill the array with the content of the queue.
     if (you.auto_training)
     {
-        for (auto sk : you.exercises)
-        {
-            if (skill_trained(sk))
-            {
-                you.training[sk] += you.train[sk];
-                empty = false;
-            }
-        }
-
-        // We count the practise events in the other queue.
-        FixedVector<unsigned int, NUM_SKILLS> exer_all;
+        // This runs on every exercise, so count the practise events in each
+        // queue first, and only then look at the few skills they name.
+        FixedVector<unsigned int, NUM_SKILLS> exer, exer_all;
+        exer.init(0);
         exer_all.init(0);
+        for (auto sk : you.exercises)
+            ++exer[sk];
         for (auto sk : you.exercises_all)
-        {
-            if (skill_trained(sk))
-            {
-                exer_all[sk] += you.train[sk];
-                empty = false;
-            }
-        }
+            ++exer_all[sk];
 
-        // We keep the highest of the 2 numbers.
         for (int sk = 0; sk < NUM_SKILLS; ++sk)
-            you.training[sk] = max(you.training[sk], exer_all[sk]);
+        {
+            if (!exer[sk] && !exer_all[sk] || !skill_trained(sk))
+                continue;
+            empty = false;
+            // We keep the highest of the 2 numbers.
+            you.training[sk] = max(exer[sk], exer_all[sk]) * you.train[sk];
+        }
 
         // The selected skills have not been exercised recently. Give them all
         // a default weight of 1 (or 2 for focus skills).
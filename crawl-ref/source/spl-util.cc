@@ -25,7 +25,9 @@
 #include "item-prop.h"
 #include "level-state-type.h"
 #include "libutil.h"
+#include "losglobal.h"
 #include "message.h"
+#include "name-table.h"
 #include "notes.h"
 #include "options.h"
 #include "orb.h"
@@ -139,7 +141,7 @@ void init_spell_descs()
     }
 }
 
-typedef map<string, spell_type> spell_name_map;
+typedef name_table<spell_type> spell_name_map;
 
 static spell_name_map &_get_spell_name_cache()
 {
@@ -149,7 +151,7 @@ static spell_name_map &_get_spell_name_cache()
 
 void init_spell_name_cache()
 {
-    spell_name_map &cache = _get_spell_name_cache();
+    map<string, spell_type> names;
     for (int i = 0; i < NUM_SPELLS; i++)
     {
         spell_type type = static_cast<spell_type>(i);
@@ -160,8 +162,9 @@ void init_spell_name_cache()
         const char *sptitle = spell_title(type);
         ASSERT(sptitle);
         const string spell_name = lowercase_string(sptitle);
-        cache[spell_name] = type;
+        names[spell_name] = type;
     }
+    _get_spell_name_cache() = spell_name_map(names);
 }
 
 bool spell_data_initialized()
@@ -177,7 +180,7 @@ spell_type spell_by_name(string name, bool partial_match)
     lowercase(name);
 
     if (!partial_match)
-        return lookup(_get_spell_name_cache(), name, SPELL_NO_SPELL);
+        return _get_spell_name_cache().get(name, SPELL_NO_SPELL);
 
     const spell_type sp = find_earliest_match(name, SPELL_NO_SPELL, NUM_SPELLS,
                                               is_valid_spell, spell_title);
@@ -781,6 +784,7 @@ void apply_area_cloud(cloud_func func, const coord_def& where,
     targeter_cloud place(agent, ctype, GDM, number, number);
     if (!place.set_aim(where))
         return;
+    los_invalidation_batch los_batch;
     unsigned int dist = 0;
     while (number > 0)
     {
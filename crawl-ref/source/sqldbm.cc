@@ -7,11 +7,16 @@
 
 #include "sqldbm.h"
 
+#include <algorithm>
 #include <cstring>
 #include <fcntl.h>
 #if defined(UNIX) || defined(TARGET_COMPILER_MINGW)
 #include <unistd.h>
 #endif
+#ifdef USE_DB_SNAPSHOT
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 #include "end.h"
 #include "syscalls.h"
@@ -50,6 +55,9 @@ private:
 SQL_DBM::SQL_DBM(const string &dbname, bool _readonly, bool do_open)
     : error(), errc(SQLITE_OK), db(nullptr), s_insert(nullptr), s_remove(nullptr),
       s_query(nullptr), s_iterator(nullptr), dbfile(dbname), readonly(_readonly)
+#ifdef USE_DB_SNAPSHOT
+      , snap_base(nullptr), snap_len(0), snap_count(0), snap_iter(0)
+#endif
 {
     if (do_open && !dbfile.empty())
         open();
@@ -74,6 +82,10 @@ int SQL_DBM::ec(int err)
 
 bool SQL_DBM::is_open() const
 {
+#ifdef USE_DB_SNAPSHOT
+    if (snap_base)
+        return true;
+#endif
     return !!db;
 }
 
@@ -93,6 +105,11 @@ int SQL_DBM::open(const string &s)
     if (dbfile.find(".db") != dbfile.length() - 3)
         dbfile += ".db";
 
+#ifdef USE_DB_SNAPSHOT
+    if (readonly && open_snapshot())
+        return ec(SQLITE_OK);
+#endif
+
 /*
 From SQLite's documentation:
 
@@ -146,10 +163,18 @@ int SQL_DBM::init_schema()
 
 void SQL_DBM::close()
 {
+#ifdef USE_DB_SNAPSHOT
+    close_snapshot();
+#endif
     if (db)
     {
         if (!readonly)
+        {
             sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+#ifdef USE_DB_SNAPSHOT
+            write_snapshot();
+#endif
+        }
         finalise_query(&s_insert);
         finalise_query(&s_remove);
         finalise_query(&s_query);
@@ -248,6 +273,25 @@ int SQL_DBM::do_query(const string &key, string *result)
 
 string SQL_DBM::query(const string &key)
 {
+#ifdef USE_DB_SNAPSHOT
+    if (snap_base)
+    {
+        // Binary search, in the order write_snapshot() sorted by.
+        uint32_t lo = 0, hi = snap_count;
+        while (lo < hi)
+        {
+            const uint32_t mid = lo + (hi - lo) / 2;
+            const int cmp = snapshot_key(mid).compare(key);
+            if (!cmp)
+                return snapshot_value(mid);
+            if (cmp < 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return "";
+    }
+#endif
     string result;
     for (sqlite_retry_iterator ri; ri;
          ri.check(do_query(key, &result)))
@@ -257,6 +301,13 @@ string SQL_DBM::query(const string &key)
 
 unique_ptr<string> SQL_DBM::firstkey()
 {
+#ifdef USE_DB_SNAPSHOT
+    if (snap_base)
+    {
+        snap_iter = 0;
+        return nextkey();
+    }
+#endif
     if (init_iterator() != SQLITE_OK)
     {
         unique_ptr<string> result;
@@ -269,6 +320,14 @@ unique_ptr<string> SQL_DBM::firstkey()
 unique_ptr<string> SQL_DBM::nextkey()
 {
     unique_ptr<string> result;
+#ifdef USE_DB_SNAPSHOT
+    if (snap_base)
+    {
+        if (snap_iter < snap_count)
+            result.reset(new string(snapshot_key(snap_iter++)));
+        return result;
+    }
+#endif
     if (s_iterator)
     {
         if (ec(sqlite3_step(s_iterator)) == SQLITE_ROW)
@@ -319,6 +378,156 @@ int SQL_DBM::prepare_query(sqlite3_stmt **q, const char *sql)
 #endif
 }
 
+#ifdef USE_DB_SNAPSHOT
+// A snapshot is this header, then snap_count entries sorted by key, then the
+// keys and values they point into, in native byte order: it is written by
+// the host that reads it, whenever its .db is.
+static const char SNAPSHOT_MAGIC[8] = { 'C', 'R', 'D', 'B', 'S', 'N', 'P', '1' };
+
+struct snapshot_header
+{
+    char     magic[8];
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct snapshot_entry
+{
+    uint32_t key_off, key_len;
+    uint32_t value_off, value_len;
+};
+
+static string _snapshot_path(const string &dbfile)
+{
+    return dbfile.substr(0, dbfile.length() - 3) + ".kv";
+}
+
+bool SQL_DBM::open_snapshot()
+{
+    const string path = _snapshot_path(dbfile);
+
+    // One older than the .db is stale: something else wrote the .db since.
+    struct stat db_stat, snap_stat;
+    if (stat(dbfile.c_str(), &db_stat) || stat(path.c_str(), &snap_stat)
+        || snap_stat.st_mtime < db_stat.st_mtime
+        || (size_t) snap_stat.st_size < sizeof(snapshot_header))
+    {
+        return false;
+    }
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    void *m = mmap(nullptr, snap_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED)
+        return false;
+
+    const snapshot_header *head = static_cast<const snapshot_header *>(m);
+    if (memcmp(head->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC))
+        || sizeof(snapshot_header)
+           + (uint64_t) head->count * sizeof(snapshot_entry)
+           > (uint64_t) snap_stat.st_size)
+    {
+        munmap(m, snap_stat.st_size);
+        return false;
+    }
+
+    snap_base = static_cast<const char *>(m);
+    snap_len = snap_stat.st_size;
+    snap_count = head->count;
+    snap_iter = 0;
+    return true;
+}
+
+void SQL_DBM::close_snapshot()
+{
+    if (snap_base)
+        munmap((void *) snap_base, snap_len);
+    snap_base = nullptr;
+    snap_len = 0;
+    snap_count = 0;
+}
+
+// Entries are only checked as they are used, so that opening stays O(1);
+// one pointing outside the file reads as empty.
+string SQL_DBM::snapshot_key(uint32_t i) const
+{
+    const snapshot_entry *entries = reinterpret_cast<const snapshot_entry *>(
+        snap_base + sizeof(snapshot_header));
+    const snapshot_entry &e = entries[i];
+    if ((uint64_t) e.key_off + e.key_len > snap_len)
+        return "";
+    return string(snap_base + e.key_off, e.key_len);
+}
+
+string SQL_DBM::snapshot_value(uint32_t i) const
+{
+    const snapshot_entry *entries = reinterpret_cast<const snapshot_entry *>(
+        snap_base + sizeof(snapshot_header));
+    const snapshot_entry &e = entries[i];
+    if ((uint64_t) e.value_off + e.value_len > snap_len)
+        return "";
+    return string(snap_base + e.value_off, e.value_len);
+}
+
+// Write the snapshot of a database that has just been committed. It goes to
+// a temporary file first, so that readers find either none or all of it;
+// without one they just use the .db.
+void SQL_DBM::write_snapshot()
+{
+    vector<pair<string, string>> contents;
+    sqlite3_stmt *all = nullptr;
+    if (prepare_query(&all, "SELECT key, value FROM dbm") != SQLITE_OK)
+        return;
+    while (sqlite3_step(all) == SQLITE_ROW)
+    {
+        const char *key = (const char *) sqlite3_column_text(all, 0);
+        const char *value = (const char *) sqlite3_column_text(all, 1);
+        contents.emplace_back(key ? key : "", value ? value : "");
+    }
+    finalise_query(&all);
+    sort(contents.begin(), contents.end());
+
+    snapshot_header head;
+    memcpy(head.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    head.count = contents.size();
+    head.reserved = 0;
+
+    vector<snapshot_entry> entries;
+    string blob;
+    uint64_t off = sizeof(snapshot_header)
+                   + contents.size() * sizeof(snapshot_entry);
+    for (const auto &kv : contents)
+    {
+        snapshot_entry e;
+        e.key_off = off + blob.length();
+        e.key_len = kv.first.length();
+        blob += kv.first;
+        e.value_off = off + blob.length();
+        e.value_len = kv.second.length();
+        blob += kv.second;
+        entries.push_back(e);
+    }
+    if (off + blob.length() > UINT32_MAX)
+        return;
+
+    const string path = _snapshot_path(dbfile);
+    const string tmp = path + ".tmp";
+    FILE *f = fopen_u(tmp.c_str(), "wb");
+    if (!f)
+        return;
+    const bool ok = fwrite(&head, sizeof(head), 1, f) == 1
+                    && (entries.empty()
+                        || fwrite(entries.data(), sizeof(snapshot_entry),
+                                  entries.size(), f) == entries.size())
+                    && fwrite(blob.data(), 1, blob.length(), f)
+                       == blob.length();
+    if (fclose(f) || !ok || rename_u(tmp.c_str(), path.c_str()))
+        unlink_u(tmp.c_str());
+}
+#endif
+
 ////////////////////////////////////////////////////////////////////////
 
 sql_datum::sql_datum() : dptr(nullptr), dsize(0), need_free(false)
@@ -7,6 +7,8 @@
 
 #include "startup.h"
 
+#include <chrono>
+
 #include "abyss.h"
 #include "arena.h"
 #include "branch.h"
@@ -52,6 +54,7 @@
 #include "status.h"
 #include "stringutil.h"
 #include "terrain.h"
+#include "threads.h"
 #ifdef USE_TILE
  #include "tilepick.h"
  #include "tilepick-p.h"
@@ -71,6 +74,11 @@
 
 using namespace ui;
 
+// Load the databases alongside the maps; see db_loader.
+#ifndef NO_ASYNC_INIT
+#define ASYNC_INIT
+#endif
+
 static void _loading_message(string m)
 {
     mpr(m.c_str());
@@ -79,18 +87,92 @@ static void _loading_message(string m)
 #endif
 }
 
-// Initialise a whole lot of stuff...
-static void _initialize()
+typedef chrono::steady_clock startup_clock;
+
+static double _ms_since(startup_clock::time_point start)
 {
-    Options.fixup_options();
+    return chrono::duration<double, milli>(startup_clock::now() - start)
+           .count();
+}
 
-    you.symbol = MONS_PLAYER;
-    msg::initialise_mpr_streams();
+static void _report_phase(const char *name, double ms)
+{
+    if (crawl_state.print_startup_times)
+        fprintf(stderr, "startup: %-28s %8.1f ms\n", name, ms);
+}
 
-    rng::seed(); // don't use any chosen seed yet
+// For -print-startup-times: time one phase of _initialize().
+template<typename F>
+static void _phase(const char *name, F f)
+{
+    const auto start = startup_clock::now();
+    f();
+    _report_phase(name, _ms_since(start));
+}
 
-    clua.init_libraries();
+// The databases are loaded (and regenerated if their sources changed) on a
+// thread of their own while the main thread reads the maps: neither uses
+// the other, and both are mostly file I/O. The worker must not touch the
+// message window, so its notices wait in db_notices until it is joined.
+struct db_loader
+{
+    vector<string> db_notices;
+    double ms;
+#ifdef ASYNC_INIT
+    thread_t thread;
+    bool threaded;
+#endif
+
+    db_loader() : ms(0)
+#ifdef ASYNC_INIT
+        , threaded(false)
+#endif
+    {
+    }
+
+    void run()
+    {
+        const auto start = startup_clock::now();
+        databaseSystemInit(&db_notices);
+        ms = _ms_since(start);
+    }
+
+    void start()
+    {
+#ifdef ASYNC_INIT
+        threaded = !thread_create_joinable(&thread, _run_thread, this);
+        if (threaded)
+            return;
+#endif
+        run();
+    }
+
+    void join()
+    {
+#ifdef ASYNC_INIT
+        if (threaded)
+            thread_join(thread);
+        threaded = false;
+#endif
+        for (const string &notice : db_notices)
+            mpr(notice);
+        db_notices.clear();
+        _report_phase("databases", ms);
+    }
+
+#ifdef ASYNC_INIT
+    static void *_run_thread(void *arg)
+    {
+        static_cast<db_loader *>(arg)->run();
+        return nullptr;
+    }
+#endif
+};
 
+// These all fill in global tables, some of them from each other, so
+// they stay on the main thread and in order.
+static void _init_tables()
+{
     init_char_table(Options.char_set);
     init_show_table();
     init_monster_symbols();
@@ -106,9 +188,10 @@ static void _initialize()
     // and init_show_table() have been called, so that the glyphs will
     // be set to use with item_names_by_glyph_cache.
     init_item_name_cache();
+}
 
-    unwind_bool no_more(crawl_state.show_more_prompt, false);
-
+static void _init_game_arrays()
+{
     // Init item array.
     for (int i = 0; i < MAX_ITEMS; ++i)
         init_item(i);
@@ -123,9 +206,37 @@ static void _initialize()
 
     you.unique_creatures.reset();
     you.unique_items.init(UNIQ_NOT_EXISTS);
+}
+
+// Set by startup_preload(): the dungeon Lua is set up and the maps are
+// read, so the next _initialize() can skip both.
+static bool _maps_preloaded = false;
+
+// Initialise a whole lot of stuff...
+static void _initialize()
+{
+    const auto init_start = startup_clock::now();
+    const bool preloaded = _maps_preloaded;
+    _maps_preloaded = false;
+
+    Options.fixup_options();
+
+    you.symbol = MONS_PLAYER;
+    msg::initialise_mpr_streams();
+
+    rng::seed(); // don't use any chosen seed yet
+
+    _phase("lua libraries", [] { clua.init_libraries(); });
+
+    _phase("tables and name caches", _init_tables);
+
+    unwind_bool no_more(crawl_state.show_more_prompt, false);
+
+    _init_game_arrays();
 
     // Set up the Lua interpreter for the dungeon builder.
-    init_dungeon_lua();
+    if (!preloaded)
+        _phase("dungeon lua", [] { init_dungeon_lua(); });
 
 #ifdef USE_TILE_LOCAL
     // Draw the splash screen before the database gets initialised as that
@@ -136,19 +247,29 @@ static void _initialize()
 
     // Initialise internal databases.
     _loading_message("Loading databases...");
-    databaseSystemInit();
+    db_loader dbs;
+    dbs.start();
 
     _loading_message("Loading spells and features...");
-    init_feat_desc_cache();
-    init_spell_name_cache();
+    _phase("spell and feature caches", []
+    {
+        init_feat_desc_cache();
+        init_spell_name_cache();
 #ifdef DEBUG
-    validate_spellbooks();
+        validate_spellbooks();
 #endif
+    });
 
     // Read special levels and vaults.
-    _loading_message("Loading maps...");
-    read_maps();
-    run_map_global_preludes();
+    if (!preloaded)
+    {
+        _loading_message("Loading maps...");
+        _phase("maps", [] { read_maps(); });
+    }
+
+    dbs.join();
+    _phase("map preludes", [] { run_map_global_preludes(); });
+    _report_phase("total", _ms_since(init_start));
 
     if (crawl_state.build_db)
         end(0);
@@ -1012,6 +1133,28 @@ static bool _exit_type_allows_menu_bypass(game_exit exit)
 }
 #endif
 
+/**
+ * Do the slow parts of _initialize() that don't depend on the player's
+ * options, for a fork server (see zygote.cc) to share with every game it
+ * forks. The databases are brought up to date, but closed again: their
+ * handles must not be shared between processes. Each game reopens them.
+ */
+void startup_preload()
+{
+    rng::seed();
+    _phase("tables and name caches", _init_tables);
+    _init_game_arrays();
+    _phase("dungeon lua", [] { init_dungeon_lua(); });
+    _phase("databases", []
+    {
+        databaseSystemInit();
+        databaseSystemShutdown();
+    });
+    _phase("maps", [] { read_maps(); });
+    crawl_state.use_des_cache = true;
+    _maps_preloaded = true;
+}
+
 bool startup_step()
 {
     _initialize();
@@ -26,6 +26,7 @@
 #include "feature.h"
 #include "god-passive.h"
 #include "hints.h"
+#include "initfile.h"
 #include "invent.h"
 #include "item-prop.h"
 #include "item-status-flag-type.h"
@@ -164,6 +165,24 @@ static void _fully_identify_item(item_def *item)
         set_ident_type(*item, true);
 }
 
+bool stash_search_index::current() const
+{
+    return m_valid
+           && m_knowledge == item_knowledge_generation()
+           && m_options == options_generation()
+           && m_lua == clua.globals_generation;
+}
+
+vector<stash_item_search_text> &stash_search_index::rebuild()
+{
+    m_entries.clear();
+    m_valid = true;
+    m_knowledge = item_knowledge_generation();
+    m_options = options_generation();
+    m_lua = clua.globals_generation;
+    return m_entries;
+}
+
 // ----------------------------------------------------------------------
 // Stash
 // ----------------------------------------------------------------------
@@ -236,11 +255,53 @@ bool Stash::unmark_trapping_nets()
     for (auto &item : items)
         if (item_is_stationary_net(item))
             item.net_placed = false, changed = true;
+    if (changed)
+        search_index.invalidate();
     return changed;
 }
 
+static bool _is_rottable(const item_def &item);
+
+// Whether kept is still a copy of the item seen on the square. A corpse's
+// copy keeps its rot in stash_freshness, so that isn't compared.
+static bool _same_pile_item(const item_def &seen, const item_def &kept)
+{
+    return seen.base_type == kept.base_type
+           && seen.sub_type == kept.sub_type
+           && seen.plus == kept.plus
+           && (seen.plus2 == kept.plus2 || _is_rottable(seen))
+           && seen.special == kept.special
+           && seen.quantity == kept.quantity
+           && seen.flags == kept.flags
+           && seen.link == kept.link
+           && seen.get_colour() == kept.get_colour()
+           && seen.inscription == kept.inscription;
+}
+
+// Whether the pile on the square is the one copied into items last time,
+// so that update() needn't copy it again.
+bool Stash::pile_unchanged()
+{
+    if (!pile_copied)
+        return false;
+
+    size_t i = 0;
+    for (stack_iterator si(pos, true); si; ++si)
+    {
+        god_id_item(*si);
+        maybe_identify_base_type(*si);
+        if (si->flags & ISFLAG_UNOBTAINABLE)
+            continue;
+        if (i == items.size() || !_same_pile_item(*si, items[i]))
+            return false;
+        ++i;
+    }
+    return i == items.size();
+}
+
 void Stash::update()
 {
+
     feat = env.grid(pos);
     trap = NUM_TRAPS;
 
@@ -261,11 +322,12 @@ void Stash::update()
 
     int previous_size = items.size();
 
-    // Zap existing items
-    items.clear();
-
     if (!_grid_has_perceived_item(pos))
     {
+        if (!items.empty())
+            search_index.invalidate();
+        items.clear();
+        pile_copied = false;
         visited = true;
         return;
     }
@@ -277,6 +339,16 @@ void Stash::update()
     item_def *pitem = &env.item[you.visible_igrd(pos)];
     hints_first_item(*pitem);
 
+    if (pile_unchanged())
+    {
+        visited = visited || pos == you.pos() || !greedy;
+        return;
+    }
+
+    // Zap existing items
+    items.clear();
+    search_index.invalidate();
+
     bool glowing_item_on_square = false;
     bool artefact_item_on_square = false;
     // Now, grab all items on that square and fill our vector
@@ -305,8 +377,10 @@ void Stash::update()
     const bool artefact_greed   = artefact_item_on_square
                                 && (Options.explore_greedy_visit & EG_ARTEFACT);
 
+    pile_copied = true;
+    greedy = stack_greed || glowing_greed || artefact_greed;
     visited = pos == you.pos()
-              || !(stack_greed || glowing_greed || artefact_greed)
+              || !greedy
               || current_size <= previous_size && visited;
 }
 
@@ -388,6 +462,29 @@ string Stash::feature_description() const
     return feat_desc;
 }
 
+const vector<stash_item_search_text> &Stash::search_text() const
+{
+    if (search_index.current()
+        && search_index.entries().size() == items.size())
+    {
+        return search_index.entries();
+    }
+
+    vector<stash_item_search_text> &entries = search_index.rebuild();
+    for (const item_def &item : items)
+    {
+        stash_item_search_text entry;
+        entry.name = stash_item_name(item);
+        entry.text = stash_annotate_item(STASH_LUA_SEARCH_ANNOTATE, &item)
+                     + " " + entry.name;
+        entry.has_desc = is_dumpable_artefact(item);
+        if (entry.has_desc)
+            entry.desc = chardump_desc(item);
+        entries.push_back(move(entry));
+    }
+    return entries;
+}
+
 vector<stash_search_result> Stash::matches_search(
     const string &prefix, const base_pattern &search) const
 {
@@ -395,16 +492,16 @@ vector<stash_search_result> Stash::matches_search(
     if (empty())
         return results;
 
-    for (const item_def &item : items)
+    const vector<stash_item_search_text> &text = search_text();
+    for (size_t i = 0; i < items.size(); ++i)
     {
-        const string s   = stash_item_name(item);
-        const string ann = stash_annotate_item(STASH_LUA_SEARCH_ANNOTATE, &item);
-        if (search.matches(prefix + " " + ann + " " + s)
-            || is_dumpable_artefact(item) && search.matches(chardump_desc(item)))
+        const item_def &item = items[i];
+        if (search.matches(prefix + " " + text[i].text)
+            || text[i].has_desc && search.matches(text[i].desc))
         {
             stash_search_result res;
             res.match_type = MATCH_ITEM;
-            res.match = s;
+            res.match = text[i].name;
             res.primary_sort = item.name(DESC_QUALNAME);
             res.item = item;
             results.push_back(res);
@@ -446,8 +543,11 @@ void Stash::_update_corpses(int rot_time)
         if (new_rot <= _min_rot(item))
         {
             items.erase(items.begin() + i);
+            search_index.invalidate();
             continue;
         }
+        if (item.stash_freshness != new_rot)
+            search_index.invalidate();
         item.stash_freshness = static_cast<short>(new_rot);
     }
 }
@@ -463,6 +563,7 @@ void Stash::_update_identification()
 
 void Stash::add_item(item_def &item, bool add_to_front)
 {
+    search_index.invalidate();
     if (_is_rottable(item))
         StashTrack.update_corpses();
 
@@ -574,6 +675,8 @@ void Stash::load(reader& inf)
 
     // Zap out item vector, in case it's in use (however unlikely)
     items.clear();
+    search_index.invalidate();
+    pile_copied = false;
     // Read in the items
     for (int i = 0; i < count; ++i)
     {
@@ -630,6 +733,28 @@ void ShopInfo::show_menu(const level_pos& pos) const
     ::shop(const_cast<shop_struct&>(shop), pos);
 }
 
+const vector<stash_item_search_text> &ShopInfo::search_text() const
+{
+    if (search_index.current()
+        && search_index.entries().size() == shop.stock.size())
+    {
+        return search_index.entries();
+    }
+
+    vector<stash_item_search_text> &entries = search_index.rebuild();
+    for (const item_def &item : shop.stock)
+    {
+        stash_item_search_text entry;
+        entry.name = shop_item_name(item);
+        entry.text = stash_annotate_item(STASH_LUA_SEARCH_ANNOTATE, &item)
+                     + " " + entry.name;
+        entry.desc = shop_item_desc(item);
+        entry.has_desc = true;
+        entries.push_back(move(entry));
+    }
+    return entries;
+}
+
 vector<stash_search_result> ShopInfo::matches_search(
     const string &prefix, const base_pattern &search) const
 {
@@ -655,19 +780,17 @@ vector<stash_search_result> ShopInfo::matches_search(
         }
     }
 
-    for (const item_def &item : shop.stock)
+    const vector<stash_item_search_text> &text = search_text();
+    for (size_t i = 0; i < shop.stock.size(); ++i)
     {
-        const string sname = shop_item_name(item);
-        const string ann   = stash_annotate_item(STASH_LUA_SEARCH_ANNOTATE,
-                                                 &item);
-
-        if (search.matches(prefix + " " + ann + " " + sname +
+        const item_def &item = shop.stock[i];
+        if (search.matches(prefix + " " + text[i].text +
                                                     " {" + shoptitle + "}")
-            || search.matches(shop_item_desc(item)))
+            || search.matches(text[i].desc))
         {
             stash_search_result res;
             res.match_type = MATCH_ITEM;
-            res.match = sname;
+            res.match = text[i].name;
             res.primary_sort = item.name(DESC_QUALNAME);
             res.item = item;
             res.pos.pos = shop.pos;
@@ -713,16 +836,22 @@ level_id LevelStashes::where() const
 
 Stash *LevelStashes::find_stash(coord_def c)
 {
+    if (!map_bounds(c) || !m_occupied(c))
+        return nullptr;
     return map_find(m_stashes, c);
 }
 
 const Stash *LevelStashes::find_stash(coord_def c) const
 {
+    if (!map_bounds(c) || !m_occupied(c))
+        return nullptr;
     return map_find(m_stashes, c);
 }
 
 const ShopInfo *LevelStashes::find_shop(const coord_def& c) const
 {
+    if (!map_bounds(c) || !m_occupied(c))
+        return nullptr;
     for (const ShopInfo &shop : m_shops)
         if (shop.is_at(c))
             return &shop;
@@ -762,9 +891,19 @@ ShopInfo &LevelStashes::get_shop(const coord_def& c)
     shop_struct shop = *shop_at(c);
     shop.stock.clear(); // You can't see it from afar.
     m_shops.emplace_back(shop);
+    _update_occupied(c);
     return m_shops.back();
 }
 
+void LevelStashes::_update_occupied(const coord_def &c)
+{
+    bool occupied = m_stashes.count(c);
+    for (const ShopInfo &shop : m_shops)
+        if (shop.is_at(c))
+            occupied = true;
+    m_occupied.set(c, occupied);
+}
+
 // Updates the stash at p. Returns true if there was a stash at p, false
 // otherwise.
 bool LevelStashes::update_stash(const coord_def& c)
@@ -799,12 +938,17 @@ void LevelStashes::move_stash(const coord_def& from, const coord_def& to)
     s->pos = to;
     m_stashes[s->pos] = *s;
     m_stashes.erase(old_pos);
+    _update_occupied(old_pos);
+    _update_occupied(to);
 }
 
 // Removes a Stash from the level.
 void LevelStashes::kill_stash(const Stash &s)
 {
-    m_stashes.erase(s.pos);
+    // s may be the stash being erased.
+    const coord_def pos = s.pos;
+    m_stashes.erase(pos);
+    _update_occupied(pos);
 }
 
 void LevelStashes::add_stash(coord_def p)
@@ -820,7 +964,10 @@ void LevelStashes::add_stash(coord_def p)
     {
         Stash new_stash(p);
         if (!new_stash.empty())
+        {
             m_stashes[new_stash.pos] = new_stash;
+            _update_occupied(new_stash.pos);
+        }
     }
 }
 
@@ -957,12 +1104,16 @@ void LevelStashes::load(reader& inf)
     m_place.load(inf);
 
     m_stashes.clear();
+    m_occupied.reset();
     for (int i = 0; i < size; ++i)
     {
         Stash s;
         s.load(inf);
         if (!s.empty())
+        {
             m_stashes[s.pos] = s;
+            m_occupied.set(s.pos);
+        }
     }
 
     m_shops.clear();
@@ -971,6 +1122,7 @@ void LevelStashes::load(reader& inf)
     {
         m_shops.emplace_back();
         m_shops.back().load(inf);
+        m_occupied.set(m_shops.back().shop.pos);
     }
 }
 
@@ -980,6 +1132,7 @@ void LevelStashes::remove_shop(const coord_def& c)
         if (m_shops[i].is_at(c))
         {
             m_shops.erase(m_shops.begin() + i);
+            _update_occupied(c);
             return;
         }
 }
@@ -17,6 +17,34 @@ class reader;
 class writer;
 
 struct stash_search_result;
+
+// What a search matches one item of a stash or shop against. Building it
+// takes several names and a Lua call per item, so it is built on the first
+// search after the items change, and kept until they change again or what
+// is known about items (or the options or Lua that annotate them) does.
+struct stash_item_search_text
+{
+    string name;        // as the results show it
+    string text;        // annotations and name
+    string desc;        // the artefact or shop description
+    bool has_desc;
+};
+
+class stash_search_index
+{
+public:
+    bool current() const;
+    void invalidate() { m_valid = false; }
+    // Start over, for the current item knowledge.
+    vector<stash_item_search_text> &rebuild();
+    const vector<stash_item_search_text> &entries() const { return m_entries; }
+
+private:
+    vector<stash_item_search_text> m_entries;
+    bool m_valid = false;
+    unsigned int m_knowledge = 0, m_options = 0, m_lua = 0;
+};
+
 class Stash
 {
 public:
@@ -64,6 +92,8 @@ private:
     void _update_corpses(int rot_time);
     void _update_identification();
     void add_item(item_def &item, bool add_to_front = false);
+    bool pile_unchanged();
+    const vector<stash_item_search_text> &search_text() const;
 
 private:
     bool visited;      // Is this correct to the best of our knowledge?
@@ -73,6 +103,13 @@ private:
     trap_type trap;
 
     vector<item_def> items;
+    mutable stash_search_index search_index;
+
+    // Whether items were copied from the square by update(), rather than
+    // loaded, and whether they would make explore visit it then; an update
+    // that finds the same pile keeps both.
+    bool pile_copied = false;
+    bool greedy = false;
 
     static bool are_items_same(const item_def &, const item_def &,
                                bool exact = false);
@@ -103,6 +140,10 @@ public:
 private:
     string shop_item_name(const item_def &it) const;
     string shop_item_desc(const item_def &it) const;
+    const vector<stash_item_search_text> &search_text() const;
+
+    // Buying from a shop replaces its ShopInfo, and with it this.
+    mutable stash_search_index search_index;
 
     friend class ST_ItemIterator;
 };
@@ -218,6 +259,7 @@ private:
     void _update_corpses(int rot_time);
     void _update_identification();
     void _waypoint_search(int n, vector<stash_search_result> &results) const;
+    void _update_occupied(const coord_def &c);
 
     typedef map<coord_def, Stash> stashes_t;
     typedef vector<ShopInfo> shops_t;
@@ -227,6 +269,11 @@ private:
     stashes_t m_stashes;
     shops_t m_shops;
 
+    // The squares that have a stash or a shop, so that the great majority
+    // of squares, which have neither, can be ruled out without a search.
+    // Explore looks at every square it floods through.
+    FixedBitArray<GXM, GYM> m_occupied;
+
     friend class StashTracker;
     friend class ST_ItemIterator;
 };
@@ -42,8 +42,11 @@ game_state::game_state()
       obj_stat_gen(false), type(GAME_TYPE_NORMAL),
       last_type(GAME_TYPE_UNSPECIFIED), last_game_exit(game_exit::unknown),
       marked_as_won(false), arena_suspended(false),
-      generating_level(false), dump_maps(false), test(false), script(false),
-      build_db(false), use_des_cache(true), tests_selected(),
+      generating_level(false), dump_maps(false), test(false), test_jobs(1),
+      script(false),
+      build_db(false), use_des_cache(true), print_startup_times(false),
+      print_turn_times(false),
+      tests_selected(),
 #ifdef DGAMELAUNCH
       throttle(true),
       bypassed_startup_menu(true),
@@ -84,9 +84,15 @@ struct game_state
     bool dump_maps;         // Dump map Lua to stderr on fresh parse.
     bool test;              // Set if we want to run self-tests and exit.
     bool test_list;         // Show available tests and exit.
+    int test_jobs;          // Processes to share the Lua tests between.
     bool script;            // Set if we want to run a Lua script and exit.
     bool build_db;          // Set if we want to rebuild the db and exit.
     bool use_des_cache;
+    bool print_startup_times; // Time the phases of startup, on stderr.
+    bool print_turn_times;  // Time the phases of turns; see turn-times.h.
+#ifdef USE_TILE_WEB
+    string zygote_socket;   // Set if we are to be a fork server; see zygote.cc.
+#endif
     vector<string> tests_selected; // Tests to be run.
     vector<string> script_args;    // Arguments to scripts.
 
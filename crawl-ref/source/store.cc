@@ -1262,6 +1262,15 @@ static map<string, int> accesses;
 //////////////////
 // Misc functions
 
+// The map needs a string to search with. Rather than building a new one
+// for every literal key, reuse this one's buffer.
+static const string &_key_string(const char *key)
+{
+    static string scratch;
+    scratch.assign(key);
+    return scratch;
+}
+
 bool CrawlHashTable::exists(const string &key) const
 {
     ACCESS(key);
@@ -1269,6 +1278,17 @@ bool CrawlHashTable::exists(const string &key) const
     return find(key) != end();
 }
 
+bool CrawlHashTable::exists(const char *key) const
+{
+    // Most tables are empty; don't bother copying the key for those.
+    if (empty())
+    {
+        ACCESS(key);
+        return false;
+    }
+    return exists(_key_string(key));
+}
+
 void CrawlHashTable::assert_validity() const
 {
 #ifdef DEBUG
@@ -1341,6 +1361,11 @@ CrawlStoreValue& CrawlHashTable::get_value(const string &key)
     return map::operator[](key);
 }
 
+CrawlStoreValue& CrawlHashTable::get_value(const char *key)
+{
+    return get_value(_key_string(key));
+}
+
 const CrawlStoreValue& CrawlHashTable::get_value(const string &key) const
 {
     ASSERT_VALIDITY();
@@ -1355,6 +1380,11 @@ const CrawlStoreValue& CrawlHashTable::get_value(const string &key) const
     return store;
 }
 
+const CrawlStoreValue& CrawlHashTable::get_value(const char *key) const
+{
+    return get_value(_key_string(key));
+}
+
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 
@@ -250,18 +250,21 @@ public:
     void read(reader &);
 
     bool exists(const string &key) const;
+    bool exists(const char *key) const;
 
     void assert_validity() const;
 
+    // Keys are nearly always string literals (the _KEY macros); the const
+    // char * overloads look them up without allocating a string each time.
+
     // NOTE: If the const versions of get_value() or [] are given a
     // key which doesn't exist, they will assert.
     const CrawlStoreValue& get_value(const string &key) const;
-    const CrawlStoreValue& get_value(const char *key) const
-    { return get_value(string(key)); }
+    const CrawlStoreValue& get_value(const char *key) const;
     const CrawlStoreValue& operator[] (const string &key) const
     { return get_value(key); }
     const CrawlStoreValue& operator[] (const char *key) const
-    { return get_value(string(key)); }
+    { return get_value(key); }
 
     // NOTE: If get_value() or [] is given a key which doesn't exist
     // in the table, an unset/empty CrawlStoreValue will be created
@@ -271,11 +274,10 @@ public:
     // then trying to assign a different type to the CrawlStoreValue
     // will assert.
     CrawlStoreValue& get_value(const string &key);
-    CrawlStoreValue& get_value(const char *key)
-    { return get_value(string(key)); }
+    CrawlStoreValue& get_value(const char *key);
     using map::operator[];
     CrawlStoreValue& operator[] (const char *key)
-    { return get_value(string(key)); }
+    { return get_value(key); }
 };
 
 // A CrawlVector is the vector version of CrawlHashTable, except that
@@ -39,9 +39,32 @@ size_t strlcpy(char *dst, const char *src, size_t n)
 #endif
 
 
+// Whether s is plain ascii, in which case lowercasing can be done a byte at
+// a time, in place. Like the general case, this stops at a NUL.
+static bool _lowercase_ascii(string &s)
+{
+    size_t len = 0;
+    for (char ch : s)
+    {
+        if (!ch)
+            break;
+        if (static_cast<unsigned char>(ch) >= 0x80)
+            return false;
+        len++;
+    }
+    s.resize(len);
+    for (char &ch : s)
+        ch = toalower(ch);
+    return true;
+}
+
 string lowercase_string(const string &s)
 {
-    string res;
+    string res = s;
+    if (_lowercase_ascii(res))
+        return res;
+
+    res.clear();
     char32_t c;
     char buf[4];
     for (const char *tp = s.c_str(); int len = utf8towc(&c, tp); tp += len)
@@ -60,7 +83,8 @@ string lowercase_string(const string &s)
 
 string &lowercase(string &s)
 {
-    s = lowercase_string(s);
+    if (!_lowercase_ascii(s))
+        s = lowercase_string(s);
     return s;
 }
 
@@ -295,16 +319,25 @@ bool strip_suffix(string &s, const string &suffix)
 string replace_all(string s, const string &find, const string &repl)
 {
     ASSERT(!find.empty());
-    string::size_type start = 0;
-    string::size_type found;
+    string::size_type found = s.find(find);
+    if (found == string::npos)
+        return s;
 
-    while ((found = s.find(find, start)) != string::npos)
+    // Build the result in one pass, rather than shifting the rest of the
+    // string along for each replacement.
+    string res;
+    res.reserve(s.size());
+    string::size_type start = 0;
+    do
     {
-        s.replace(found, find.length(), repl);
-        start = found + repl.length();
+        res.append(s, start, found - start);
+        res += repl;
+        start = found + find.length();
     }
+    while ((found = s.find(find, start)) != string::npos);
+    res.append(s, start, string::npos);
 
-    return s;
+    return res;
 }
 
 // Replaces all occurrences of any of the characters in tofind with the
@@ -449,7 +482,7 @@ static void add_segment(vector<string> &segs, string s, bool trim,
         trim_string(s);
 
     if (accept_empty || !s.empty())
-        segs.push_back(s);
+        segs.push_back(std::move(s));
 }
 
 set<size_t> find_escapes(const string &s)
@@ -505,9 +538,27 @@ vector<string> split_string(const string &sep, string s, bool trim_segments,
 {
     vector<string> segments;
     int separator_length = sep.length();
-    set<size_t> escapes; // annoying to have to always create...
-    if (ignore_escapes)
-        escapes = find_escapes(s);
+
+    // Without escapes, segments can be cut straight out of s.
+    if (!ignore_escapes)
+    {
+        size_t start = 0;
+        size_t found;
+        while (nsplits && (found = s.find(sep, start)) != string::npos)
+        {
+            add_segment(segments, s.substr(start, found - start),
+                        trim_segments, accept_empty_segments);
+            start = found + separator_length;
+
+            if (nsplits > 0)
+                --nsplits;
+        }
+        add_segment(segments, s.substr(start), trim_segments,
+                    accept_empty_segments);
+        return segments;
+    }
+
+    set<size_t> escapes = find_escapes(s);
 
     size_t pos = 0;
     size_t original_pos = 0; // original position of s[0]
@@ -21,6 +21,7 @@
 # include <fcntl.h>
 # include <sys/types.h>
 # include <sys/stat.h>
+# include <sys/resource.h>
 #endif
 
 #include "files.h"
@@ -558,3 +559,29 @@ int open_u(const char *pathname, int flags, mode_t mode)
     return open(OUTS(pathname), flags, mode);
 #endif
 }
+
+void process_memory(size_t &resident, size_t &peak)
+{
+    resident = 0;
+    peak = 0;
+#ifndef TARGET_OS_WINDOWS
+# ifdef __linux__
+    if (FILE *statm = fopen("/proc/self/statm", "r"))
+    {
+        unsigned long size, pages;
+        if (fscanf(statm, "%lu %lu", &size, &pages) == 2)
+            resident = pages * sysconf(_SC_PAGESIZE);
+        fclose(statm);
+    }
+# endif
+    struct rusage usage;
+    if (!getrusage(RUSAGE_SELF, &usage))
+    {
+# ifdef __APPLE__
+        peak = usage.ru_maxrss;
+# else
+        peak = usage.ru_maxrss * 1024L;
+# endif
+    }
+#endif
+}
@@ -14,6 +14,10 @@ bool unlock_file(int fd);
 
 bool read_urandom(char *buf, int len);
 
+// The memory the process has resident now, and the most it has had, in
+// bytes; either is 0 where the system won't say.
+void process_memory(size_t &resident, size_t &peak);
+
 #ifdef TARGET_OS_WINDOWS
 # ifndef UNIX
 void alarm(unsigned int seconds);
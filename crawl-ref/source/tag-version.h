@@ -291,6 +291,7 @@ enum tag_minor_version
     TAG_MINOR_NO_SPECIAL_ENERGY,   // Remove some unused monster energy types.
     TAG_MINOR_MON_SH_INFO,         // Store SH in mon-info.
     TAG_MINOR_RAMPAGE_HEAL,        // Adjust Armataur mutations for healpage.
+    TAG_MINOR_BULK_GRIDS,          // Run-length encode level grids in bulk.
 #endif
     NUM_TAG_MINORS,
     TAG_MINOR_VERSION = NUM_TAG_MINORS - 1
@@ -115,7 +115,7 @@ extern abyss_state abyssal_state;
 
 reader::reader(const string &_read_filename, int minorVersion)
     : _filename(_read_filename), _chunk(0), _pbuf(nullptr), _read_offset(0),
-      _minorVersion(minorVersion), _safe_read(false)
+      _buf_pos(0), _buf_len(0), _minorVersion(minorVersion), _safe_read(false)
 {
     _file       = fopen_u(_filename.c_str(), "rb");
     opened_file = !!_file;
@@ -123,7 +123,7 @@ reader::reader(const string &_read_filename, int minorVersion)
 
 reader::reader(package *save, const string &chunkname, int minorVersion)
     : _file(0), _chunk(0), opened_file(false), _pbuf(0), _read_offset(0),
-     _minorVersion(minorVersion), _safe_read(false)
+     _buf_pos(0), _buf_len(0), _minorVersion(minorVersion), _safe_read(false)
 {
     ASSERT(save);
     _chunk = new chunk_reader(save, chunkname);
@@ -170,8 +170,16 @@ static NORETURN void _short_read(bool safe_read)
     die_noline("short read while reading save");
 }
 
-// Reads input in network byte order, from a file or buffer.
-unsigned char reader::readByte()
+bool reader::fill_buffer()
+{
+    _buf_pos = 0;
+    _buf_len = _chunk->read(_buffer, sizeof(_buffer));
+    return _buf_len;
+}
+
+// Reads input in network byte order, from a file or buffer.  The common case
+// of a chunk with read-ahead left is handled inline by readByte().
+unsigned char reader::read_byte_slow()
 {
     if (_file)
     {
@@ -182,10 +190,9 @@ unsigned char reader::readByte()
     }
     else if (_chunk)
     {
-        unsigned char buf;
-        if (_chunk->read(&buf, 1) != 1)
+        if (!fill_buffer())
             _short_read(_safe_read);
-        return buf;
+        return _buffer[_buf_pos++];
     }
     else
     {
@@ -209,8 +216,27 @@ void reader::read(void *data, size_t size)
     }
     else if (_chunk)
     {
-        if (_chunk->read(data, size) != size)
-            _short_read(_safe_read);
+        const size_t avail = min<size_t>(_buf_len - _buf_pos, size);
+        memcpy(data, _buffer + _buf_pos, avail);
+        _buf_pos += avail;
+        data = (char*)data + avail;
+        size -= avail;
+        if (!size)
+            return;
+
+        // Big reads go straight to the chunk, small ones through the buffer.
+        if (size >= sizeof(_buffer))
+        {
+            if (_chunk->read(data, size) != size)
+                _short_read(_safe_read);
+        }
+        else
+        {
+            if (!fill_buffer() || _buf_len < size)
+                _short_read(_safe_read);
+            memcpy(data, _buffer, size);
+            _buf_pos = size;
+        }
     }
     else
     {
@@ -223,12 +249,6 @@ void reader::read(void *data, size_t size)
     }
 }
 
-int reader::getMinorVersion() const
-{
-    ASSERT(_minorVersion != TAG_MINOR_INVALID);
-    return _minorVersion;
-}
-
 void reader::setMinorVersion(int minorVersion)
 {
     _minorVersion = minorVersion;
@@ -237,7 +257,7 @@ void reader::setMinorVersion(int minorVersion)
 void reader::fail_if_not_eof(const string &name)
 {
     char dummy;
-    if (_chunk ? _chunk->read(&dummy, 1) :
+    if (_chunk ? _buf_pos < _buf_len || _chunk->read(&dummy, 1) :
         _file ? (fgetc(_file) != EOF) :
         _read_offset >= _pbuf->size())
     {
@@ -255,13 +275,34 @@ void writer::check_ok(bool ok)
     }
 }
 
-void writer::writeByte(unsigned char ch)
+writer::~writer()
+{
+    if (_chunk)
+    {
+        flush();
+        delete _chunk;
+    }
+}
+
+void writer::flush()
+{
+    if (_buffered)
+        _chunk->write(_buffer, _buffered);
+    _buffered = 0;
+}
+
+// The common case of a chunk with room left in the buffer is handled inline
+// by writeByte().
+void writer::write_byte_slow(unsigned char ch)
 {
     if (failed)
         return;
 
     if (_chunk)
-        _chunk->write(&ch, 1);
+    {
+        flush();
+        _buffer[_buffered++] = ch;
+    }
     else if (_file)
         check_ok(fputc(ch, _file) != EOF);
     else
@@ -274,7 +315,17 @@ void writer::write(const void *data, size_t size)
         return;
 
     if (_chunk)
-        _chunk->write(data, size);
+    {
+        if (_buffered + size > sizeof(_buffer))
+            flush();
+        if (size >= sizeof(_buffer))
+            _chunk->write(data, size);
+        else
+        {
+            memcpy(_buffer + _buffered, data, size);
+            _buffered += size;
+        }
+    }
     else if (_file)
         check_ok(fwrite(data, 1, size, _file) == size);
     else
@@ -564,6 +615,8 @@ static void _unmarshall_vector(reader& th, vector<T>& vec, U T_unmarshall)
 {
     vec.clear();
     const int num_to_read = unmarshallInt(th);
+    if (num_to_read > 0)
+        vec.reserve(num_to_read);
     for (int i = 0; i < num_to_read; ++i)
         vec.push_back(T_unmarshall(th));
 }
@@ -812,6 +865,73 @@ static void _run_length_decode(reader &th, unmarshall um, grid &g,
     }
 }
 
+// Whole-grid counterparts of the above for the big per-level arrays: the
+// cells (in the x-major order FixedArray keeps them in) are run-length
+// encoded into a buffer that is written in one go, prefixed by its length so
+// the reader can fetch it in one go too.  Runs are a UByte count followed by
+// the value in `bytes` bytes, network order like marshallShort/marshallInt.
+template <typename T, int WIDTH, int HEIGHT, typename Get>
+static void _marshall_fixed_array(writer &th,
+                                  const FixedArray<T, WIDTH, HEIGHT> &a,
+                                  int bytes, Get get)
+{
+    vector<unsigned char> buf;
+    auto put_run = [&](int run, uint32_t value)
+    {
+        buf.push_back(run);
+        for (int i = bytes - 1; i >= 0; --i)
+            buf.push_back((value >> (i * 8)) & 0xFF);
+    };
+
+    uint32_t last = 0;
+    int nlast = 0;
+    for (int x = 0; x < WIDTH; ++x)
+        for (int y = 0; y < HEIGHT; ++y)
+        {
+            const uint32_t value = get(a[x][y]);
+            CHECK_INITIALIZED(value);
+            if (nlast && (value != last || nlast == 255))
+            {
+                put_run(nlast, last);
+                nlast = 0;
+            }
+            last = value;
+            nlast++;
+        }
+    put_run(nlast, last);
+
+    marshallInt(th, buf.size());
+    th.write(buf.data(), buf.size());
+}
+
+template <typename T, int WIDTH, int HEIGHT, typename Set>
+static void _unmarshall_fixed_array(reader &th,
+                                    FixedArray<T, WIDTH, HEIGHT> &a,
+                                    int bytes, Set set)
+{
+    const int len = unmarshallInt(th);
+    if (len <= 0)
+        throw short_read_exception();
+    vector<unsigned char> buf(len);
+    th.read(buf.data(), len);
+
+    int offset = 0;
+    for (int at = 0; at + bytes < len;)
+    {
+        const int run = buf[at++];
+        uint32_t value = 0;
+        for (int i = 0; i < bytes; ++i)
+            value = value << 8 | buf[at++];
+
+        if (offset + run > WIDTH * HEIGHT)
+            throw short_read_exception();
+        for (int i = 0; i < run; ++i, ++offset)
+            set(a[offset / HEIGHT][offset % HEIGHT], value);
+    }
+    if (offset != WIDTH * HEIGHT)
+        throw short_read_exception();
+}
+
 union float_marshall_kludge
 {
     float    f_num;
@@ -849,15 +969,13 @@ void marshallString(writer &th, const string &data)
 
 string unmarshallString(reader &th)
 {
-    char buffer[SHRT_MAX]; // TODO: why doesn't this use int16_t?
-
     short len = unmarshallShort(th);
     ASSERT(len >= 0);
-    ASSERT(len <= (ssize_t)sizeof(buffer));
 
-    th.read(buffer, len);
-
-    return string(buffer, len);
+    string s(len, '\0');
+    if (len)
+        th.read(&s[0], len);
+    return s;
 }
 
 // This one must stay with a 16 bit signed big-endian length tag, to allow
@@ -1070,10 +1188,40 @@ static dungeon_feature_type rewrite_feature(dungeon_feature_type x,
     return x;
 }
 
+// rewrite_feature() of every feature a byte can hold, for the save version
+// and level being read. Every feature of a level goes through it, and most
+// of its checks only depend on those, so they are done once per table
+// instead of once per square.
+static const dungeon_feature_type *_feature_rewrites(int minor_version)
+{
+    static dungeon_feature_type table[256];
+    static int table_minor = TAG_MINOR_INVALID;
+    static branch_type table_branch = NUM_BRANCHES;
+    static int table_depth = -1;
+    static int table_slime_depth = -1;
+
+    if (minor_version != table_minor
+        || you.where_are_you != table_branch
+        || you.depth != table_depth
+        || brdepth[BRANCH_SLIME] != table_slime_depth)
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            table[i] = rewrite_feature(static_cast<dungeon_feature_type>(i),
+                                       minor_version);
+        }
+        table_minor = minor_version;
+        table_branch = you.where_are_you;
+        table_depth = you.depth;
+        table_slime_depth = brdepth[BRANCH_SLIME];
+    }
+    return table;
+}
+
 dungeon_feature_type unmarshallFeatureType(reader &th)
 {
-    dungeon_feature_type x = static_cast<dungeon_feature_type>(unmarshallUByte(th));
-    return rewrite_feature(x, th.getMinorVersion());
+    const uint8_t x = unmarshallUByte(th);
+    return _feature_rewrites(th.getMinorVersion())[x];
 }
 
 #if TAG_MAJOR_VERSION == 34
@@ -1081,7 +1229,10 @@ dungeon_feature_type unmarshallFeatureType(reader &th)
 static dungeon_feature_type unmarshallFeatureType_Info(reader &th)
 {
     dungeon_feature_type x = static_cast<dungeon_feature_type>(unmarshallUnsigned(th));
-    x = rewrite_feature(x, th.getMinorVersion());
+    if (x < 256)
+        x = _feature_rewrites(th.getMinorVersion())[x];
+    else
+        x = rewrite_feature(x, th.getMinorVersion());
 
     // There was a period of time when this function (only this one, not
     // unmarshallFeatureType) lacked some of the conversions now done by
@@ -2017,22 +2168,37 @@ static i_transit_list unmarshall_item_list(reader &th)
 }
 #endif
 
+static uint32_t _get_mask(unsigned int v)
+{
+    return v;
+}
+
+static void _set_mask(unsigned int &v, uint32_t value)
+{
+    v = value;
+}
+
 static void marshall_level_map_masks(writer &th)
 {
-    for (rectangle_iterator ri(0); ri; ++ri)
-    {
-        marshallInt(th, env.level_map_mask(*ri));
-        marshallInt(th, env.level_map_ids(*ri));
-    }
+    _marshall_fixed_array(th, env.level_map_mask, 4, _get_mask);
+    _marshall_fixed_array(th, env.level_map_ids, 4, _get_mask);
 }
 
 static void unmarshall_level_map_masks(reader &th)
 {
-    for (rectangle_iterator ri(0); ri; ++ri)
+#if TAG_MAJOR_VERSION == 34
+    if (th.getMinorVersion() < TAG_MINOR_BULK_GRIDS)
     {
-        env.level_map_mask(*ri) = unmarshallInt(th);
-        env.level_map_ids(*ri)  = unmarshallInt(th);
+        for (rectangle_iterator ri(0); ri; ++ri)
+        {
+            env.level_map_mask(*ri) = unmarshallInt(th);
+            env.level_map_ids(*ri)  = unmarshallInt(th);
+        }
+        return;
     }
+#endif
+    _unmarshall_fixed_array(th, env.level_map_mask, 4, _set_mask);
+    _unmarshall_fixed_array(th, env.level_map_ids, 4, _set_mask);
 }
 
 static void marshall_level_map_unique_ids(writer &th)
@@ -4299,7 +4465,7 @@ static void _tag_read_you_items(reader &th)
     else
 #endif
          unmarshallItem(th, you.active_talisman);
-
+    you.invalidate_artefact_cache();
 
     // Initialize cache of equipped unrand functions
     for (int i = EQ_FIRST_EQUIP; i < NUM_EQUIP; ++i)
@@ -4409,6 +4575,7 @@ static void _tag_read_you_items(reader &th)
         for (int j = count2; j < MAX_SUBTYPES; ++j)
             you.type_ids[i][j] = false;
     }
+    item_knowledge_changed();
 
 #if TAG_MAJOR_VERSION == 34
     if (th.getMinorVersion() < TAG_MINOR_ID_STATES)
@@ -4925,13 +5092,13 @@ static void _tag_construct_level(writer &th)
 
     CANARY;
 
+    _marshall_fixed_array(th, env.grid, 1,
+        [](dungeon_feature_type feat) -> uint32_t { return feat; });
     for (int count_x = 0; count_x < GXM; count_x++)
         for (int count_y = 0; count_y < GYM; count_y++)
-        {
-            marshallByte(th, env.grid[count_x][count_y]);
             marshallMapCell(th, env.map_knowledge[count_x][count_y]);
-            marshallInt(th, env.pgrid[count_x][count_y].flags);
-        }
+    _marshall_fixed_array(th, env.pgrid, 4,
+        [](const terrain_property_t &p) -> uint32_t { return p.flags; });
 
     marshallBoolean(th, !!env.map_forgotten);
     if (env.map_forgotten)
@@ -5753,7 +5920,7 @@ void marshallMapCell(writer &th, const map_cell &cell)
 
     if (flags & MAP_SERIALIZE_CLOUD)
     {
-        cloud_info* ci = cell.cloudinfo();
+        const cloud_info* ci = cell.cloudinfo();
         marshallUnsigned(th, ci->type);
         marshallUnsigned(th, ci->colour);
         marshallUnsigned(th, ci->duration);
@@ -6471,29 +6638,55 @@ static void _tag_read_level(reader &th)
 #if TAG_MAJOR_VERSION == 34
     vector<coord_def> transporters;
 #endif
+#if TAG_MAJOR_VERSION == 34
+    if (th.getMinorVersion() < TAG_MINOR_BULK_GRIDS)
+    {
+        for (int i = 0; i < gx; i++)
+            for (int j = 0; j < gy; j++)
+            {
+                env.grid[i][j] = unmarshallFeatureType(th);
+                unmarshallMapCell(th, env.map_knowledge[i][j]);
+                env.pgrid[i][j].flags = unmarshallInt(th);
+            }
+    }
+    else
+#endif
+    {
+        const dungeon_feature_type *rewrites
+            = _feature_rewrites(th.getMinorVersion());
+        _unmarshall_fixed_array(th, env.grid, 1,
+            [rewrites](dungeon_feature_type &feat, uint32_t value)
+            {
+                feat = rewrites[value & 0xff];
+            });
+        for (int i = 0; i < gx; i++)
+            for (int j = 0; j < gy; j++)
+                unmarshallMapCell(th, env.map_knowledge[i][j]);
+        _unmarshall_fixed_array(th, env.pgrid, 4,
+            [](terrain_property_t &p, uint32_t value)
+            {
+                p.flags = value;
+            });
+    }
+
     for (int i = 0; i < gx; i++)
         for (int j = 0; j < gy; j++)
         {
-            dungeon_feature_type feat = unmarshallFeatureType(th);
-            env.grid[i][j] = feat;
-            ASSERT(feat < NUM_FEATURES);
-
+            ASSERT(env.grid[i][j] < NUM_FEATURES);
 #if TAG_MAJOR_VERSION == 34
             // Save these for potential destination clean up.
             if (env.grid[i][j] == DNGN_TRANSPORTER)
                 transporters.push_back(coord_def(i, j));
 #endif
-            unmarshallMapCell(th, env.map_knowledge[i][j]);
             // Fixup positions
             if (env.map_knowledge[i][j].monsterinfo())
-                env.map_knowledge[i][j].monsterinfo()->pos = coord_def(i, j);
+                env.map_knowledge[i][j].mutable_monsterinfo()->pos = coord_def(i, j);
             if (env.map_knowledge[i][j].cloudinfo())
-                env.map_knowledge[i][j].cloudinfo()->pos = coord_def(i, j);
+                env.map_knowledge[i][j].mutable_cloudinfo()->pos = coord_def(i, j);
 
             env.map_knowledge[i][j].flags &= ~MAP_VISIBLE_FLAG;
             if (env.map_knowledge[i][j].seen())
                 env.map_seen.set(i, j);
-            env.pgrid[i][j].flags = unmarshallInt(th);
 
             env.mgrid[i][j] = NON_MONSTER;
         }
@@ -49,29 +49,39 @@ enum tag_type   // used during save/load process to identify data blocks
  * writer API
  * *********************************************************************** */
 
+// Readers and writers of package chunks go through a buffer of this size
+// rather than calling into the package for every byte.
+#define TAG_BUFFER_SIZE 4096
+
 class writer
 {
 public:
     writer(const string &filename, FILE* output, bool ignore_errors = false)
         : _filename(filename), _file(output), _chunk(0),
-          _ignore_errors(ignore_errors), _pbuf(0), failed(false)
+          _ignore_errors(ignore_errors), _pbuf(0), _buffered(0), failed(false)
     {
         ASSERT(output);
     }
     writer(vector<unsigned char>* poutput)
         : _filename(), _file(0), _chunk(0), _ignore_errors(false),
-          _pbuf(poutput), failed(false) { ASSERT(poutput); }
+          _pbuf(poutput), _buffered(0), failed(false) { ASSERT(poutput); }
     writer(package *save, const string &chunkname)
         : _filename(), _file(0), _chunk(0), _ignore_errors(false),
-          failed(false)
+          _pbuf(0), _buffered(0), failed(false)
     {
         ASSERT(save);
         _chunk = save->writer(chunkname);
     }
 
-    ~writer() { if (_chunk) delete _chunk; }
+    ~writer();
 
-    void writeByte(unsigned char byte);
+    void writeByte(unsigned char byte)
+    {
+        if (_chunk && _buffered < sizeof(_buffer))
+            _buffer[_buffered++] = byte;
+        else
+            write_byte_slow(byte);
+    }
     void write(const void *data, size_t size);
     long tell();
 
@@ -79,6 +89,8 @@ public:
 
 private:
     void check_ok(bool ok);
+    void write_byte_slow(unsigned char byte);
+    void flush();
 
 private:
     string _filename;
@@ -88,6 +100,10 @@ private:
 
     vector<unsigned char>* _pbuf;
 
+    // pending output for _chunk
+    unsigned char _buffer[TAG_BUFFER_SIZE];
+    size_t _buffered;
+
     bool failed;
 };
 
@@ -116,19 +132,31 @@ public:
     reader(const string &filename, int minorVersion = TAG_MINOR_INVALID);
     reader(FILE* input, int minorVersion = TAG_MINOR_INVALID)
         : _file(input), _chunk(0), opened_file(false), _pbuf(0),
-          _read_offset(0), _minorVersion(minorVersion), _safe_read(false) {}
+          _read_offset(0), _buf_pos(0), _buf_len(0),
+          _minorVersion(minorVersion), _safe_read(false) {}
     reader(const vector<unsigned char>& input,
            int minorVersion = TAG_MINOR_INVALID)
         : _file(0), _chunk(0), opened_file(false), _pbuf(&input),
-          _read_offset(0), _minorVersion(minorVersion), _safe_read(false) {}
+          _read_offset(0), _buf_pos(0), _buf_len(0),
+          _minorVersion(minorVersion), _safe_read(false) {}
     reader(package *save, const string &chunkname,
            int minorVersion = TAG_MINOR_INVALID);
     ~reader();
 
-    unsigned char readByte();
+    unsigned char readByte()
+    {
+        if (_buf_pos < _buf_len)
+            return _buffer[_buf_pos++];
+        return read_byte_slow();
+    }
     void read(void *data, size_t size);
     void advance(size_t size);
-    int getMinorVersion() const;
+    // Inline: the loaders check it for nearly every field they read.
+    int getMinorVersion() const
+    {
+        ASSERT(_minorVersion != TAG_MINOR_INVALID);
+        return _minorVersion;
+    }
     void setMinorVersion(int minorVersion);
     bool valid() const;
     void fail_if_not_eof(const string &name);
@@ -138,6 +166,10 @@ public:
 
     void set_safe_read(bool setting) { _safe_read = setting; }
 
+private:
+    unsigned char read_byte_slow();
+    bool fill_buffer();
+
 private:
     string _filename;
     FILE* _file;
@@ -145,6 +177,9 @@ private:
     bool  opened_file;
     const vector<unsigned char>* _pbuf;
     unsigned int _read_offset;
+    // input read ahead from _chunk
+    unsigned char _buffer[TAG_BUFFER_SIZE];
+    unsigned int _buf_pos, _buf_len;
     int _minorVersion;
     // always throw an exception rather than dying when reading past EOF
     bool _safe_read;
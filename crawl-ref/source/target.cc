@@ -283,16 +283,12 @@ void targeter_beam::set_explosion_aim(bolt tempbeam)
 {
     set_explosion_target(tempbeam);
     tempbeam.use_target_as_pos = true;
-    exp_map_min.init(INT_MAX);
-    tempbeam.determine_affected_cells(exp_map_min, coord_def(), 0,
-                                      min_expl_rad, true, true);
+    tempbeam.explosion_cells(exp_map_min, min_expl_rad);
     if (max_expl_rad == min_expl_rad)
         exp_map_max = exp_map_min;
     else
     {
-        exp_map_max.init(INT_MAX);
-        tempbeam.determine_affected_cells(exp_map_max, coord_def(), 0,
-                                          max_expl_rad, true, true);
+        tempbeam.explosion_cells(exp_map_max, max_expl_rad);
     }
 }
 
@@ -481,16 +477,12 @@ bool targeter_smite::set_aim(coord_def a)
         bolt beam;
         beam.target = a;
         beam.use_target_as_pos = true;
-        exp_map_min.init(INT_MAX);
-        beam.determine_affected_cells(exp_map_min, coord_def(), 0,
-                                      exp_range_min, true, true);
+        beam.explosion_cells(exp_map_min, exp_range_min);
         if (exp_range_min == exp_range_max)
             exp_map_max = exp_map_min;
         else
         {
-            exp_map_max.init(INT_MAX);
-            beam.determine_affected_cells(exp_map_max, coord_def(), 0,
-                    exp_range_max, true, true);
+            beam.explosion_cells(exp_map_max, exp_range_max);
         }
     }
     return true;
@@ -814,9 +806,7 @@ bool targeter_unravelling::set_aim(coord_def a)
     bolt beam;
     beam.target = a;
     beam.use_target_as_pos = true;
-    exp_map_min.init(INT_MAX);
-    beam.determine_affected_cells(exp_map_min, coord_def(), 0,
-                                  exp_range_min, true, true);
+    beam.explosion_cells(exp_map_min, exp_range_min);
     exp_map_max = exp_map_min;
 
     return true;
@@ -930,9 +920,7 @@ bool targeter_fragment::set_aim(coord_def a)
     }
 
     tempbeam.use_target_as_pos = true;
-    exp_map_min.init(INT_MAX);
-    tempbeam.determine_affected_cells(exp_map_min, coord_def(), 0,
-            exp_range_min, true, true);
+    tempbeam.explosion_cells(exp_map_min, exp_range_min);
 
     // Min and max ranges are always identical.
     exp_map_max = exp_map_min;
@@ -1754,9 +1742,7 @@ bool targeter_monster_sequence::set_aim(coord_def a)
         {
             passed_through_mons = true;
             tempbeam.use_target_as_pos = true;
-            exp_map.init(INT_MAX);
-            tempbeam.determine_affected_cells(exp_map, coord_def(), 0,
-                                              0, true, true);
+            tempbeam.explosion_cells(exp_map, 0);
         }
         else
             last_cell_has_mons = false;
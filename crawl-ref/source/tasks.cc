@@ -0,0 +1,320 @@
+/**
+ * @file
+ * @brief A small pool of worker threads for background work, and a queue
+ *        of main thread work to be done while waiting for input.
+**/
+
+#include "AppHdr.h"
+
+#include "tasks.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <map>
+
+#include "stringutil.h"
+#ifdef TASK_THREADS
+# include "threads.h"
+#endif
+
+using std::deque;
+using std::map;
+
+typedef std::chrono::steady_clock task_clock;
+
+static double _ms_between(task_clock::time_point start,
+                          task_clock::time_point end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+struct task_state
+{
+    function<void()> work;
+    const char *name;
+    task_clock::time_point queued;
+    bool started = false;
+    bool finished = false;
+};
+
+// The work the pool is for (deflating save chunks and the like) comes a few
+// pieces at a time, so a few threads are enough; they're only started once
+// there's work waiting and every one already running is busy.
+#define MAX_TASK_WORKERS 4
+
+// Counts and times for one name of task.
+struct task_kind_stats
+{
+    unsigned int started = 0;
+    unsigned int by_caller = 0;     // run by wait() before a worker got to it
+    double wait_ms = 0;             // from task_start() to running
+    double longest_wait_ms = 0;
+    double run_ms = 0;
+    double longest_run_ms = 0;
+};
+
+static map<string, task_kind_stats> _task_stats;
+static size_t _most_queued = 0;
+static unsigned int _running = 0;
+
+static unsigned int _idle_steps = 0;
+static double _idle_ms = 0;
+
+#ifdef TASK_THREADS
+// _lock guards the queue, the tasks' flags and the counts above.
+static mutex_t _lock;
+static cond_t _task_queued;
+static cond_t _task_finished;
+static bool _pool_started = false;
+static int _workers = 0;
+static int _waiting_workers = 0;
+static deque<shared_ptr<task_state>> _queue;
+static thread_local bool _on_worker = false;
+#endif
+
+// Run a task on this thread. With threads, _lock is held on entry and exit,
+// but not while the work runs.
+static void _run(task_state &task)
+{
+    const auto start = task_clock::now();
+    task_kind_stats &stats = _task_stats[task.name];
+    const double wait_ms = _ms_between(task.queued, start);
+    stats.wait_ms += wait_ms;
+    stats.longest_wait_ms = max(stats.longest_wait_ms, wait_ms);
+    task.started = true;
+    ++_running;
+
+#ifdef TASK_THREADS
+    mutex_unlock(_lock);
+#endif
+    task.work();
+    const double run_ms = _ms_between(start, task_clock::now());
+#ifdef TASK_THREADS
+    mutex_lock(_lock);
+#endif
+
+    // Let go of whatever the work held on to now, not when the last
+    // ticket goes.
+    task.work = nullptr;
+    task.finished = true;
+    --_running;
+    stats.run_ms += run_ms;
+    stats.longest_run_ms = max(stats.longest_run_ms, run_ms);
+#ifdef TASK_THREADS
+    cond_wake(_task_finished);
+#endif
+}
+
+#ifdef TASK_THREADS
+static void *_worker(void *)
+{
+    _on_worker = true;
+    mutex_lock(_lock);
+    while (true)
+    {
+        if (_queue.empty())
+        {
+            ++_waiting_workers;
+            cond_wait(_task_queued, _lock);
+            --_waiting_workers;
+            continue;
+        }
+        shared_ptr<task_state> task = _queue.front();
+        _queue.pop_front();
+        _run(*task);
+    }
+    return nullptr;
+}
+
+static void _start_pool()
+{
+    if (_pool_started)
+        return;
+    mutex_init(_lock);
+    cond_init(_task_queued);
+    cond_init(_task_finished);
+    _pool_started = true;
+}
+#endif
+
+bool task_on_worker()
+{
+#ifdef TASK_THREADS
+    return _on_worker;
+#else
+    return false;
+#endif
+}
+
+task_ticket task_start(function<void()> work, const char *name)
+{
+    ASSERT(!task_on_worker());
+
+    shared_ptr<task_state> task = std::make_shared<task_state>();
+    task->work = work;
+    task->name = name;
+    task->queued = task_clock::now();
+
+#ifdef TASK_THREADS
+    _start_pool();
+    mutex_lock(_lock);
+    _task_stats[name].started++;
+    _queue.push_back(task);
+    _most_queued = max(_most_queued, _queue.size());
+    if (_waiting_workers)
+        cond_wake(_task_queued);
+    else if (_workers < MAX_TASK_WORKERS)
+    {
+        // The workers are never joined: they wait for work until the game
+        // exits. If one can't be started, wait() runs the task instead.
+        thread_t thread;
+        if (!thread_create_joinable(&thread, _worker, nullptr))
+            ++_workers;
+    }
+    mutex_unlock(_lock);
+#else
+    _task_stats[name].started++;
+    _run(*task);
+#endif
+
+    return task_ticket(task);
+}
+
+bool task_ticket::done() const
+{
+    if (!state)
+        return true;
+#ifdef TASK_THREADS
+    mutex_lock(_lock);
+    const bool finished = state->finished;
+    mutex_unlock(_lock);
+    return finished;
+#else
+    return state->finished;
+#endif
+}
+
+void task_ticket::wait()
+{
+    if (!state)
+        return;
+    ASSERT(!task_on_worker());
+
+#ifdef TASK_THREADS
+    mutex_lock(_lock);
+    if (!state->started)
+    {
+        auto queued = find(_queue.begin(), _queue.end(), state);
+        ASSERT(queued != _queue.end());
+        _queue.erase(queued);
+        _task_stats[state->name].by_caller++;
+        _run(*state);
+    }
+    while (!state->finished)
+        cond_wait(_task_finished, _lock);
+    mutex_unlock(_lock);
+#else
+    ASSERT(state->finished);
+#endif
+}
+
+struct idle_task
+{
+    function<bool()> step;
+    const char *name;
+};
+
+static deque<idle_task> _idle_tasks;
+
+void idle_task_add(function<bool()> step, const char *name)
+{
+    ASSERT(!task_on_worker());
+    _idle_tasks.push_back({step, name});
+}
+
+bool idle_tasks_pending()
+{
+    return !_idle_tasks.empty();
+}
+
+void idle_tasks_run(int ms)
+{
+    ASSERT(!task_on_worker());
+    if (_idle_tasks.empty())
+        return;
+
+    const auto start = task_clock::now();
+    double elapsed = 0;
+    do
+    {
+        // A step may add idle tasks of its own, so don't hold on to
+        // references into the queue across it.
+        function<bool()> step = _idle_tasks.front().step;
+        const bool more = step();
+        _idle_steps++;
+        if (!more)
+            _idle_tasks.pop_front();
+        elapsed = _ms_between(start, task_clock::now());
+    }
+    while (!_idle_tasks.empty() && elapsed < ms);
+    _idle_ms += elapsed;
+}
+
+string tasks_description()
+{
+#ifdef TASK_THREADS
+    if (_pool_started)
+        mutex_lock(_lock);
+    const size_t queued = _queue.size();
+    const int workers = _workers;
+#else
+    const size_t queued = 0;
+    const int workers = 0;
+#endif
+
+    string desc = make_stringf("Background tasks: %d workers, %zu queued, "
+                               "%u running, at most %zu queued at once\n",
+                               workers, queued, _running, _most_queued);
+    if (!_task_stats.empty())
+    {
+        desc += make_stringf("%-12s %8s %9s %10s %10s %10s %10s\n",
+                             "task", "started", "by caller", "wait ms",
+                             "max wait", "run ms", "max run");
+    }
+    for (const auto &kind : _task_stats)
+    {
+        const task_kind_stats &s = kind.second;
+        desc += make_stringf("%-12s %8u %9u %10.3f %10.3f %10.3f %10.3f\n",
+                             kind.first.c_str(), s.started, s.by_caller,
+                             s.started ? s.wait_ms / s.started : 0.0,
+                             s.longest_wait_ms,
+                             s.started ? s.run_ms / s.started : 0.0,
+                             s.longest_run_ms);
+    }
+#ifdef TASK_THREADS
+    if (_pool_started)
+        mutex_unlock(_lock);
+#endif
+
+    desc += make_stringf("Idle tasks: %zu pending, %u steps in %.1f ms\n",
+                         _idle_tasks.size(), _idle_steps, _idle_ms);
+    return desc;
+}
+
+string tasks_overlay_summary()
+{
+#ifdef TASK_THREADS
+    if (!_pool_started)
+        return "";
+    mutex_lock(_lock);
+    const size_t queued = _queue.size();
+    const unsigned int running = _running;
+    mutex_unlock(_lock);
+    if (!queued && !running)
+        return "";
+    return make_stringf("tasks q%zu r%u", queued, running);
+#else
+    return "";
+#endif
+}
@@ -0,0 +1,105 @@
+/**
+ * @file
+ * @brief A small pool of worker threads for background work, and a queue
+ *        of main thread work to be done while waiting for input.
+**/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+using std::function;
+using std::shared_ptr;
+using std::string;
+
+// Without TASK_THREADS, background tasks are simply run when they're started.
+#ifndef NO_TASK_THREADS
+#define TASK_THREADS
+#endif
+
+// Work given to task_start() runs on a worker thread, at any time until it
+// is waited for. It must not touch game state (you, env, the map, monsters,
+// items, Lua, the message window or the display): work on copies it was
+// given, and let the main thread act on the result after wait(). Everything
+// else stays on the main thread; to use spare time there, see
+// idle_task_add().
+
+struct task_state;
+
+// A handle on a started task.
+class task_ticket
+{
+public:
+    task_ticket() { }
+
+    // Has it finished? Never blocks.
+    bool done() const;
+    // Wait for it to finish. A task no worker has picked up yet is run by
+    // the caller instead.
+    void wait();
+    bool valid() const { return bool(state); }
+
+private:
+    explicit task_ticket(shared_ptr<task_state> _state) : state(_state) { }
+    friend task_ticket task_start(function<void()> work, const char *name);
+
+    shared_ptr<task_state> state;
+};
+
+task_ticket task_start(function<void()> work, const char *name = "task");
+
+// A task with a result, which get() waits for.
+template<typename T>
+class task_future
+{
+public:
+    task_future() { }
+
+    bool done() const { return ticket.done(); }
+    T &get()
+    {
+        ticket.wait();
+        return *value;
+    }
+
+private:
+    task_future(task_ticket _ticket, shared_ptr<T> _value)
+        : ticket(_ticket), value(_value)
+    {
+    }
+    template<typename U>
+    friend task_future<U> task_async(function<U()> work, const char *name);
+
+    task_ticket ticket;
+    shared_ptr<T> value;
+};
+
+template<typename T>
+task_future<T> task_async(function<T()> work, const char *name = "task")
+{
+    shared_ptr<T> value = std::make_shared<T>();
+    task_ticket ticket = task_start([work, value] { *value = work(); }, name);
+    return task_future<T>(ticket, value);
+}
+
+// Main thread work to do while the game waits for the player's next
+// command, a little at a time: each call of step may do a slice of the work,
+// and returns false once there's nothing more to do. Unlike background
+// tasks, steps may use game state; they're run in the order they were added.
+void idle_task_add(function<bool()> step, const char *name = "idle");
+// Run idle steps for up to ms milliseconds; at least one, if any are queued.
+void idle_tasks_run(int ms);
+// How long the main loop gives them before each command: short enough that
+// a key pressed meanwhile isn't noticeably late.
+#define IDLE_TASK_MS 5
+bool idle_tasks_pending();
+
+// Is this a worker thread?
+bool task_on_worker();
+
+// Counts and times, for the wizard turn times command and its overlay.
+string tasks_description();
+// The tasks waiting and running, in a few words; empty if there are none.
+string tasks_overlay_summary();
@@ -91,10 +91,12 @@ static inline int win32_thread_create_detached(thread_t *th,
     return !*th;
 }
 
-#define cond_t HANDLE
-#define cond_init(x) {(x)=CreateEvent(0, 0, 0, 0);}
-#define cond_destroy(x) CloseHandle(x);
-#define cond_wait(x,m) {mutex_unlock(m);WaitForSingleObject(x, INFINITE);mutex_lock(m);}
-#define cond_wake(x) PulseEvent(x)
+// A wake between unlocking and waiting on an event would be lost, so use
+// a real condition variable (Vista and later).
+#define cond_t CONDITION_VARIABLE
+#define cond_init(x) InitializeConditionVariable(&x)
+#define cond_destroy(x)
+#define cond_wait(x,m) SleepConditionVariableCS(&x, &m, INFINITE)
+#define cond_wake(x) WakeConditionVariable(&x)
 
 #endif
@@ -19,7 +19,8 @@ VertBuffer::VertBuffer(bool texture, bool colour, const GenericTexture *tex,
     m_tex(tex),
     m_prim(prim),
     m_colour_verts(colour),
-    m_texture_verts(texture)
+    m_texture_verts(texture),
+    m_record(nullptr)
 {
     m_vert_buf = GLShapeBuffer::create(texture, m_colour_verts, m_prim);
     ASSERT(m_vert_buf);
@@ -63,6 +64,14 @@ void VertBuffer::clear()
 void VertBuffer::add_primitive(const GLWPrim &rect)
 {
     m_vert_buf->add(rect);
+    if (m_record)
+        m_record->push_back(rect);
+}
+
+void VertBuffer::add_primitives(const vector<GLWPrim> &prims)
+{
+    for (const GLWPrim &rect : prims)
+        m_vert_buf->add(rect);
 }
 
 unsigned int VertBuffer::size() const
@@ -28,8 +28,13 @@ public:
 
     // State Manipulation
     void add_primitive(const GLWPrim &rect);
+    void add_primitives(const vector<GLWPrim> &prims);
     void clear();
 
+    // While set, every primitive added is also appended to *prims, so that
+    // it can be added again later with add_primitives().
+    void record_to(vector<GLWPrim> *prims) { m_record = prims; }
+
     // Note: this could invalidate previous additions if they were
     // from a different texture.
     // But we leave it here as a convenience and because it is required to set
@@ -44,6 +49,7 @@ protected:
     drawing_modes m_prim;
     bool m_colour_verts;
     bool m_texture_verts;
+    vector<GLWPrim> *m_record;
 };
 
 class FontBuffer : public VertBuffer
@@ -97,6 +103,9 @@ public:
     void draw() const;
     void clear();
 
+    VertBuffer &below_water() { return m_below_water; }
+    VertBuffer &above_water() { return m_above_water; }
+
 protected:
     int m_water_level;
 
@@ -29,6 +29,14 @@ DungeonCellBuffer::DungeonCellBuffer(const ImageManager *im) :
     m_buf_icons(&im->get_texture(TEX_ICONS)),
     m_buf_glyphs(im->get_glyph_font())
 {
+    m_layers = { &m_buf_floor, &m_buf_wall, &m_buf_feat,
+                 &m_buf_feat_trans.below_water(),
+                 &m_buf_feat_trans.above_water(),
+                 &m_buf_doll.below_water(), &m_buf_doll.above_water(),
+                 &m_buf_main_trans.below_water(),
+                 &m_buf_main_trans.above_water(),
+                 &m_buf_main, &m_buf_spells, &m_buf_skills, &m_buf_commands,
+                 &m_buf_icons };
 }
 
 static bool _in_water(const packed_cell &cell)
@@ -106,6 +114,58 @@ void DungeonCellBuffer::add(const packed_cell &cell, int x, int y)
     }
 }
 
+// Whether redrawing `a` and `b` gives the same primitives. Player and
+// mcache tiles depend on more than the cell (the doll, and mcache indices
+// get reused), so they never match.
+static bool _same_cell(const packed_cell &a, const packed_cell &b)
+{
+    const tileidx_t fg_idx = a.fg & TILE_FLAG_MASK;
+    if (fg_idx >= TILEP_MCACHE_START || fg_idx == TILEP_PLAYER)
+        return false;
+    return a == b
+           && !memcmp(&a.flv, &b.flv, sizeof(a.flv))
+           && a.icons == b.icons;
+}
+
+void DungeonCellBuffer::reset_retained(int slots)
+{
+    m_retained.clear();
+    m_retained.resize(slots);
+    m_glyph_generation = get_glyph_font()->atlas_generation();
+}
+
+bool DungeonCellBuffer::glyphs_moved()
+{
+    return get_glyph_font()->atlas_generation() != m_glyph_generation;
+}
+
+void DungeonCellBuffer::add_retained(const packed_cell &cell, int x, int y,
+                                     int slot)
+{
+    ASSERT_RANGE(slot, 0, (int) m_retained.size());
+    retained_cell &rc = m_retained[slot];
+
+    if (rc.valid && _same_cell(rc.cell, cell))
+    {
+        for (unsigned int i = 0; i < m_layers.size(); ++i)
+            m_layers[i]->add_primitives(rc.prims[i]);
+        return;
+    }
+
+    rc.prims.resize(m_layers.size());
+    for (unsigned int i = 0; i < m_layers.size(); ++i)
+    {
+        rc.prims[i].clear();
+        m_layers[i]->record_to(&rc.prims[i]);
+    }
+    add(cell, x, y);
+    for (VertBuffer *layer : m_layers)
+        layer->record_to(nullptr);
+
+    rc.cell = cell;
+    rc.valid = true;
+}
+
 void DungeonCellBuffer::add_monster(const monster_info &mon, int x, int y)
 {
     tileidx_t t    = tileidx_monster(mon);
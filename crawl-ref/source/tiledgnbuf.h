@@ -23,6 +23,14 @@ public:
     DungeonCellBuffer(const ImageManager *im);
 
     void add(const packed_cell &cell, int x, int y);
+    // As add(), but if the cell in view slot `slot` is the same as when
+    // it was last added, add the same primitives again instead of working
+    // them out afresh.
+    void add_retained(const packed_cell &cell, int x, int y, int slot);
+    void reset_retained(int slots);
+    int retained_slots() const { return m_retained.size(); }
+    // Whether the glyph font has moved its glyphs since reset_retained().
+    bool glyphs_moved();
     void add_monster(const monster_info &mon, int x, int y);
     void add_dngn_tile(int tileidx, int x, int y, bool in_water = false);
     void add_main_tile(int tileidx, int x, int y);
@@ -64,6 +72,18 @@ protected:
     TileBuffer m_buf_commands;
     TileBuffer m_buf_icons;
     FontBuffer m_buf_glyphs;
+
+    // Every buffer add() writes to, in the order they're drawn.
+    vector<VertBuffer *> m_layers;
+
+    struct retained_cell
+    {
+        bool valid = false;
+        packed_cell cell;
+        vector<vector<GLWPrim>> prims; // per layer
+    };
+    vector<retained_cell> m_retained;
+    unsigned int m_glyph_generation = 0;
 };
 
 #endif
@@ -71,4 +71,7 @@ public:
                                    unsigned int max_height) = 0;
 
    virtual const GenericTexture *font_tex() const = 0;
+   // Changes whenever glyphs move in font_tex(). Buffers stored before
+   // then draw the wrong glyphs until they are stored again.
+   virtual unsigned int atlas_generation() const = 0;
 };
@@ -155,9 +155,36 @@ mcache_manager::~mcache_manager()
     clear_all();
 }
 
+// What an entry draws: its tiles and offsets, its doll and whether it's
+// transparent. Entries with the same key can't be told apart.
+static string _entry_key(const mcache_entry &entry)
+{
+    string key;
+
+    tile_draw_info dinfo[mcache_entry::MAX_INFO_COUNT];
+    const int count = entry.info(&dinfo[0]);
+    key += (char) count;
+    for (int i = 0; i < count; ++i)
+    {
+        const int vals[3] = { (int) dinfo[i].idx, dinfo[i].ofs_x,
+                              dinfo[i].ofs_y };
+        key.append((const char *) vals, sizeof(vals));
+    }
+
+    key += entry.transparent() ? 't' : 'o';
+
+    if (const dolls_data *doll = entry.doll())
+    {
+        key += 'd';
+        key.append((const char *) doll->parts,
+                   sizeof(*doll->parts) * TILEP_PART_MAX);
+    }
+
+    return key;
+}
+
 unsigned int mcache_manager::register_monster(const monster_info& minf)
 {
-    // TODO enne - is it worth it to search against all mcache entries?
     // TODO enne - pool mcache types to avoid too much alloc/dealloc?
 
     mcache_entry *entry;
@@ -184,6 +211,17 @@ unsigned int mcache_manager::register_monster(const monster_info& minf)
     else
         return 0;
 
+    // The entry's tiles are its key, so it has to be built to find out
+    // whether it's already there; if it is, it's thrown away again.
+    string key = _entry_key(*entry);
+    auto found = m_lookup.find(key);
+    if (found != m_lookup.end())
+    {
+        delete entry;
+        m_last_used[found->second] = m_clock;
+        return TILEP_MCACHE_START + found->second;
+    }
+
     tileidx_t idx = ~0;
 
     for (unsigned int i = 0; i < m_entries.size(); i++)
@@ -200,26 +238,55 @@ unsigned int mcache_manager::register_monster(const monster_info& minf)
     {
         idx = m_entries.size();
         m_entries.push_back(entry);
+        m_keys.emplace_back();
+        m_last_used.push_back(0);
     }
 
+    m_last_used[idx] = m_clock;
+    m_lookup[key] = idx;
+    m_keys[idx] = move(key);
+
     return TILEP_MCACHE_START + idx;
 }
 
+void mcache_manager::remove(unsigned int idx)
+{
+    m_lookup.erase(m_keys[idx]);
+    m_keys[idx].clear();
+    delete m_entries[idx];
+    m_entries[idx] = nullptr;
+}
+
+// Unreferenced entries kept around for monsters that come back into view
+// looking the same; past this many, the least recently used go first.
+#define MAX_IDLE_ENTRIES 256
+
 void mcache_manager::clear_nonref()
 {
-    for (mcache_entry *&entry : m_entries)
-    {
-        if (!entry || entry->ref_count() > 0)
-            continue;
+    vector<unsigned int> idle;
+    for (unsigned int i = 0; i < m_entries.size(); i++)
+        if (m_entries[i] && m_entries[i]->ref_count() <= 0)
+            idle.push_back(i);
 
-        delete entry;
-        entry = nullptr;
+    if (idle.size() > MAX_IDLE_ENTRIES)
+    {
+        const size_t evict = idle.size() - MAX_IDLE_ENTRIES;
+        nth_element(idle.begin(), idle.begin() + evict, idle.end(),
+                    [this](unsigned int a, unsigned int b)
+                    { return m_last_used[a] < m_last_used[b]; });
+        for (size_t i = 0; i < evict; i++)
+            remove(idle[i]);
     }
+
+    m_clock++;
 }
 
 void mcache_manager::clear_all()
 {
     deleteAll(m_entries);
+    m_keys.clear();
+    m_last_used.clear();
+    m_lookup.clear();
 }
 
 mcache_entry *mcache_manager::get(tileidx_t tile)
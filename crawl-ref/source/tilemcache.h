@@ -6,6 +6,8 @@
 #ifdef USE_TILE
 #pragma once
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 struct dolls_data;
@@ -62,6 +64,7 @@ protected:
 class mcache_manager
 {
 public:
+    mcache_manager() : m_clock(0) {}
     ~mcache_manager();
 
     unsigned int register_monster(const monster_info& mon);
@@ -74,6 +77,18 @@ public:
 
 protected:
     vector<mcache_entry*> m_entries;
+
+    // Everything that looks the same shares one entry, so that a band of
+    // identically equipped orcs takes a single id, and keeps it from one
+    // turn to the next. m_keys holds what each entry draws (indexed like
+    // m_entries), m_lookup finds it again, and m_last_used is the value of
+    // m_clock (counting calls to clear_nonref) when it was last asked for.
+    vector<string> m_keys;
+    vector<unsigned int> m_last_used;
+    unordered_map<string, unsigned int> m_lookup;
+    unsigned int m_clock;
+
+    void remove(unsigned int idx);
 };
 
 // The global monster cache.
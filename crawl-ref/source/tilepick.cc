@@ -2081,6 +2081,37 @@ static tileidx_t _tileidx_monster_no_props(const monster_info& mon)
     }
 }
 
+/**
+ * Does the tile_show_threat_levels option ask for the given threat level to
+ * be marked? The option is searched for each name once, and the answers are
+ * kept until it changes, rather than searched again for every monster drawn.
+ *
+ * @param level One of "trivial", "easy", "tough", "nasty" or "unusual".
+ */
+bool tile_show_threat_level(const char *level)
+{
+    static const char * const names[] =
+        { "trivial", "easy", "tough", "nasty", "unusual" };
+    static string parsed;
+    static bool have_parsed = false;
+    static unsigned shown = 0;
+
+    if (!have_parsed || Options.tile_show_threat_levels != parsed)
+    {
+        parsed = Options.tile_show_threat_levels;
+        have_parsed = true;
+        shown = 0;
+        for (unsigned i = 0; i < ARRAYSZ(names); ++i)
+            if (parsed.find(names[i]) != string::npos)
+                shown |= 1 << i;
+    }
+
+    for (unsigned i = 0; i < ARRAYSZ(names); ++i)
+        if (!strcmp(level, names[i]))
+            return shown & (1 << i);
+    return parsed.find(level) != string::npos;
+}
+
 tileidx_t tileidx_monster(const monster_info& mons)
 {
     tileidx_t ch = _tileidx_monster_no_props(mons);
@@ -2104,26 +2135,26 @@ tileidx_t tileidx_monster(const monster_info& mons)
         ch |= TILE_FLAG_GD_NEUTRAL;
     else if (mons.neutral())
         ch |= TILE_FLAG_NEUTRAL;
-    else if (Options.tile_show_threat_levels.find("unusual") != string::npos
+    else if (tile_show_threat_level("unusual")
              && mons.has_unusual_items())
         ch |= TILE_FLAG_UNUSUAL;
     else
         switch (mons.threat)
         {
         case MTHRT_TRIVIAL:
-            if (Options.tile_show_threat_levels.find("trivial") != string::npos)
+            if (tile_show_threat_level("trivial"))
                 ch |= TILE_FLAG_TRIVIAL;
             break;
         case MTHRT_EASY:
-            if (Options.tile_show_threat_levels.find("easy") != string::npos)
+            if (tile_show_threat_level("easy"))
                 ch |= TILE_FLAG_EASY;
             break;
         case MTHRT_TOUGH:
-            if (Options.tile_show_threat_levels.find("tough") != string::npos)
+            if (tile_show_threat_level("tough"))
                 ch |= TILE_FLAG_TOUGH;
             break;
         case MTHRT_NASTY:
-            if (Options.tile_show_threat_levels.find("nasty") != string::npos)
+            if (tile_show_threat_level("nasty"))
                 ch |= TILE_FLAG_NASTY;
             break;
         default:
@@ -2261,12 +2292,17 @@ static const map<monster_info_flags, tileidx_t> status_icons = {
 
 set<tileidx_t> status_icons_for(const monster_info &mons)
 {
+    // Walked for every monster drawn; a flat copy is quicker to go through
+    // than the map's nodes.
+    static const vector<pair<monster_info_flags, tileidx_t>> icon_list(
+        status_icons.begin(), status_icons.end());
+
     set<tileidx_t> icons;
     if (mons.type == MONS_DANCING_WEAPON || mons.type == MONS_ANIMATED_ARMOUR)
         icons.insert(TILEI_ANIMATED_WEAPON);
     if (!mons.constrictor_name.empty())
         icons.insert(TILEI_CONSTRICTED);
-    for (auto status : status_icons)
+    for (const auto &status : icon_list)
         if (mons.is(status.first))
             icons.insert(status.second);
     return icons;
@@ -37,6 +37,7 @@ tileidx_t tileidx_out_of_bounds(int branch);
 void tileidx_out_of_los(tileidx_t *fg, tileidx_t *bg, tileidx_t *cloud, const coord_def& gc);
 
 tileidx_t tileidx_monster(const monster_info& mon);
+bool tile_show_threat_level(const char *level);
 tileidx_t tileidx_draco_base(const monster_info& mon);
 tileidx_t tileidx_draco_job(const monster_info& mon);
 tileidx_t tileidx_player_mons();
@@ -195,12 +195,21 @@ void DungeonRegion::pack_buffers()
     ASSERT(m_vbuf_sz.x == crawl_view.viewsz.x);
     ASSERT(m_vbuf_sz.y == crawl_view.viewsz.y);
 
+    // Cells that look the same as last time reuse their primitives, so
+    // idle animations only cost what actually changed.
+    const int slots = m_vbuf_sz.x * m_vbuf_sz.y;
+    if (m_buf_dngn.retained_slots() != slots || m_buf_dngn.glyphs_moved())
+        m_buf_dngn.reset_retained(slots);
+
     screen_cell_t *vbuf_cell = m_vbuf;
     for (int y = 0; y < crawl_view.viewsz.y; ++y)
         for (int x = 0; x < crawl_view.viewsz.x; ++x)
         {
             if (pack_tiles)
-                m_buf_dngn.add(vbuf_cell->tile, x, y);
+            {
+                m_buf_dngn.add_retained(vbuf_cell->tile, x, y,
+                                        y * m_vbuf_sz.x + x);
+            }
             if (pack_glyphs)
                 pack_glyph_at(vbuf_cell, x, y);
 
@@ -410,6 +419,8 @@ void DungeonRegion::recalculate()
     // needs to happen before superclass recalculate, and therefore can't
     // happen in on_resize
     config_glyph_font();
+    // Scale or layout changes: repack every cell.
+    m_buf_dngn.reset_retained(0);
 
     Region::recalculate();
 }
@@ -1002,21 +1013,27 @@ bool DungeonRegion::update_alt_text(string &alt)
     if (m_last_clicked_grid == gc)
         return false;
 
-    describe_info inf;
-    dungeon_feature_type feat = env.map_knowledge(gc).feat();
-    if (you.see_cell(gc))
-        get_square_desc(gc, inf);
-    else if (feat != DNGN_FLOOR && !feat_is_wall(feat) && !feat_is_tree(feat))
-        get_feature_desc(gc, inf);
-    else
+    alt = cached_description(make_stringf("dgn:%d,%d", gc.x, gc.y), [gc]()
     {
-        // For plain floor, output the stash description.
-        const string stash = get_stash_desc(gc);
-        if (!stash.empty())
-            inf.body << "\n" << stash;
-    }
+        describe_info inf;
+        dungeon_feature_type feat = env.map_knowledge(gc).feat();
+        if (you.see_cell(gc))
+            get_square_desc(gc, inf);
+        else if (feat != DNGN_FLOOR && !feat_is_wall(feat)
+                 && !feat_is_tree(feat))
+        {
+            get_feature_desc(gc, inf);
+        }
+        else
+        {
+            // For plain floor, output the stash description.
+            const string stash = get_stash_desc(gc);
+            if (!stash.empty())
+                inf.body << "\n" << stash;
+        }
 
-    alt = process_description(inf);
+        return process_description(inf);
+    });
 
     // Suppress floor description
     if (alt == "Floor.")
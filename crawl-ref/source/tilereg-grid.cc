@@ -132,6 +132,7 @@ int GridRegion::add_quad_char(char c, int x, int y,
 
 void GridRegion::render()
 {
+    const bool changed = m_dirty;
     if (m_dirty)
     {
         m_buf.clear();
@@ -146,8 +147,13 @@ void GridRegion::render()
 #ifdef DEBUG_TILES_REDRAW
     cprintf("rendering GridRegion\n");
 #endif
-    set_transform();
-    m_buf.draw();
+    // The tabs are redrawn on every mouse move, but only change when an
+    // item (or the cursor) does.
+    render_cached(changed, [this]
+    {
+        set_transform();
+        m_buf.draw();
+    });
     // XX implement glyph modes for sidebar UI
 
     draw_tag();
@@ -32,7 +32,8 @@
 #include "tilepick.h"
 #include "unicode.h"
 
-InventoryRegion::InventoryRegion(const TileRegionInit &init) : GridRegion(init)
+InventoryRegion::InventoryRegion(const TileRegionInit &init) : GridRegion(init),
+    m_slot_knowledge(item_knowledge_generation())
 {
 }
 
@@ -512,7 +513,18 @@ bool InventoryRegion::update_alt_text(string &alt)
         inf.title = "Previous page";
     }
     else
-        get_item_desc(*item, inf);
+    {
+        const bool floor = m_items[item_idx].flag & TILEI_FLAG_FLOOR;
+        alt = cached_description(
+            make_stringf("item:%s:%d", floor ? "floor" : "inv", idx),
+            [item]()
+            {
+                describe_info item_inf;
+                get_item_desc(*item, item_inf);
+                return process_description(item_inf);
+            });
+        return true;
+    }
 
     alt = process_description(inf);
     return true;
@@ -585,6 +597,26 @@ static void _fill_item_info(InventoryTile &desc, const item_def &item)
         desc.flag |= TILEI_FLAG_FLOOR;
 }
 
+// The tile for an inventory slot before the equipment and map flags, only
+// worked out again if the item, or what's known of its type, has changed.
+const InventoryTile &InventoryRegion::_inv_slot_tile(int slot)
+{
+    if (m_slot_knowledge != item_knowledge_generation())
+    {
+        m_slot_knowledge = item_knowledge_generation();
+        for (item_def &item : m_slot_item)
+            item.clear();
+    }
+
+    if (!same_item_state(m_slot_item[slot], you.inv[slot]))
+    {
+        m_slot_item[slot] = you.inv[slot];
+        m_slot_tile[slot] = InventoryTile();
+        _fill_item_info(m_slot_tile[slot], get_item_known_info(you.inv[slot]));
+    }
+    return m_slot_tile[slot];
+}
+
 void InventoryRegion::update()
 {
     m_items.clear();
@@ -633,8 +665,7 @@ void InventoryRegion::update()
                 continue;
             }
 
-            InventoryTile desc;
-            _fill_item_info(desc, get_item_known_info(you.inv[i]));
+            InventoryTile desc = _inv_slot_tile(i);
             desc.idx = i;
             if (disable_all)
                 desc.flag |= TILEI_FLAG_INVALID;
@@ -1,6 +1,8 @@
 #ifdef USE_TILE_LOCAL
 #pragma once
 
+#include "fixedvector.h"
+#include "item-def.h"
 #include "tilereg-grid.h"
 
 class InventoryRegion : public GridRegion
@@ -25,6 +27,13 @@ private:
     bool _is_next_button(int idx);
     bool _is_prev_button(int idx);
     int _real_item_count();
+    const InventoryTile &_inv_slot_tile(int slot);
+
+    // Each inventory slot's item as it was when its tile was last filled in,
+    // and that tile; see _inv_slot_tile().
+    FixedVector<item_def, ENDOFPACK> m_slot_item;
+    FixedVector<InventoryTile, ENDOFPACK> m_slot_tile;
+    uint32_t m_slot_knowledge;
 };
 
 #endif
@@ -101,18 +101,22 @@ void MapRegion::render()
 #ifdef DEBUG_TILES_REDRAW
     cprintf("rendering MapRegion\n");
 #endif
+    const bool changed = m_dirty;
     if (m_dirty)
     {
         pack_buffers();
         m_dirty = false;
     }
 
-    set_transform();
-    glmanager->set_scissor(sx, sy, wx, wy);
-    m_buf_map.draw();
-    set_transform(true);
-    m_buf_lines.draw();
-    glmanager->reset_scissor();
+    render_cached(changed, [this]
+    {
+        set_transform();
+        glmanager->set_scissor(sx, sy, wx, wy);
+        m_buf_map.draw();
+        set_transform(true);
+        m_buf_lines.draw();
+        glmanager->reset_scissor();
+    });
 }
 
 void MapRegion::recenter()
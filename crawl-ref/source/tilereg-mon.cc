@@ -18,6 +18,7 @@
 #include "rltiles/tiledef-dngn.h"
 #include "rltiles/tiledef-icons.h"
 #include "rltiles/tiledef-player.h"
+#include "stringutil.h"
 #include "tilepick.h"
 #include "tilereg-dgn.h"
 #include "tiles-build-specific.h"
@@ -131,13 +132,15 @@ bool MonsterRegion::update_alt_text(string &alt)
 
     const coord_def &gc = mon->pos;
 
-    describe_info inf;
     if (!you.see_cell(gc))
         return false;
 
-    get_square_desc(gc, inf);
-
-    alt = process_description(inf);
+    alt = cached_description(make_stringf("square:%d,%d", gc.x, gc.y), [gc]()
+    {
+        describe_info inf;
+        get_square_desc(gc, inf);
+        return process_description(inf);
+    });
     return true;
 }
 
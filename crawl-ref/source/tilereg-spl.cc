@@ -138,10 +138,12 @@ bool SpellRegion::update_alt_text(string &alt)
 
     const spell_type spell = (spell_type) idx;
 
-    describe_info inf;
-    get_spell_desc(spell, inf);
-
-    alt = process_description(inf);
+    alt = cached_description(make_stringf("spell:%d", spell), [spell]()
+    {
+        describe_info inf;
+        get_spell_desc(spell, inf);
+        return process_description(inf);
+    });
     return true;
 }
 
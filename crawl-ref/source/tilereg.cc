@@ -23,7 +23,9 @@ Region::Region() :
     sx(0),
     sy(0),
     ex(0),
-    ey(0)
+    ey(0),
+    m_cache_target(0),
+    m_cache_geometry()
 {
 }
 
@@ -121,6 +123,8 @@ void Region::recalculate()
 
 Region::~Region()
 {
+    if (m_cache_target && glmanager)
+        glmanager->delete_target(m_cache_target);
 }
 
 bool Region::inside(int x, int y)
@@ -147,6 +151,38 @@ bool Region::mouse_pos(int mouse_x, int mouse_y, int &cx, int &cy)
     return valid;
 }
 
+void Region::render_cached(bool changed, const function<void()> &draw)
+{
+    // Everything that moves what draw() puts where.
+    const array<int, 8> geometry =
+    {
+        sx, sy, ox, oy, dx, dy,
+        glmanager->logical_to_device(wx), glmanager->logical_to_device(wy)
+    };
+    if (geometry != m_cache_geometry)
+    {
+        if (m_cache_target)
+            glmanager->delete_target(m_cache_target);
+        m_cache_target = glmanager->create_target(wx, wy);
+        m_cache_geometry = geometry;
+        changed = true;
+    }
+
+    if (!m_cache_target)
+    {
+        draw();
+        return;
+    }
+
+    if (changed)
+    {
+        glmanager->bind_target(m_cache_target, sx, sy);
+        draw();
+        glmanager->bind_target(0, 0, 0);
+    }
+    glmanager->draw_target(m_cache_target, sx, sy);
+}
+
 void Region::set_transform(bool no_scaling)
 {
     GLW_3VF trans(sx + ox, sy + oy, 0);
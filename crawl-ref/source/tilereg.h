@@ -1,6 +1,12 @@
 #ifdef USE_TILE_LOCAL
 #pragma once
 
+#include <array>
+#include <functional>
+
+using std::array;
+using std::function;
+
 class ImageManager;
 struct wm_mouse_event;
 
@@ -65,6 +71,17 @@ protected:
     virtual void calculate_grid_size(int inner_x, int inner_y);
     virtual void on_resize() = 0;
     void set_transform(bool no_scaling = false);
+
+    // Draw the region through an offscreen copy, which draw() only fills
+    // again when `changed` or when the region has moved. This is for
+    // regions that change far less often than the screen is redrawn.
+    // draw() must stay within the region; where there are no offscreen
+    // targets, it is just called.
+    void render_cached(bool changed, const function<void()> &draw);
+
+private:
+    unsigned int m_cache_target;
+    array<int, 8> m_cache_geometry;
 };
 
 class FontWrapper;
@@ -9,6 +9,7 @@
 #include "cio.h"
 #include "command.h"
 #include "coord.h"
+#include "describe.h"
 #include "env.h"
 #include "files.h"
 #include "glwrapper.h"
@@ -608,6 +609,7 @@ int TilesFramework::getch_ck()
     m_tooltip.clear();
     m_region_msg->alt_text().clear();
     string prev_msg_alt_text = "";
+    invalidate_description_cache();
 
     if (need_redraw())
         redraw();
@@ -645,6 +647,12 @@ int TilesFramework::getch_ck()
                     set_need_redraw();
                 }
                 break;
+
+            case WME_NOEVENT:
+                // Some other change to the window (focus, the mouse leaving
+                // it) that needs no redraw.
+                continue;
+
             case WME_KEYDOWN:
                 key        = event.key.keysym.sym;
                 m_region_tile->place_cursor(CURSOR_MOUSE, NO_CURSOR);
@@ -714,6 +722,9 @@ int TilesFramework::getch_ck()
             case WME_MOUSEBUTTONUP:
             case WME_MOUSEBUTTONDOWN:
                 key = handle_mouse(event.mouse_event);
+                // A click can act (memorise a spell from its description,
+                // say) without leaving this loop.
+                invalidate_description_cache();
                 break;
 
             case WME_QUIT:
@@ -1343,9 +1354,20 @@ void TilesFramework::redraw()
 #ifdef DEBUG_TILES_REDRAW
     cprintf("\nredrawing tiles");
 #endif
-    m_need_redraw = false;
     if (in_headless_mode())
+    {
+        m_need_redraw = false;
+        return;
+    }
+
+    // Nothing can be seen of a hidden or minimised window, so don't spend
+    // anything on drawing it until it is shown again.
+    if (!wm->window_shown())
+    {
+        m_need_redraw = true;
         return;
+    }
+    m_need_redraw = false;
 
     glmanager->reset_view_for_redraw();
 
@@ -18,7 +18,8 @@ GenericTexture::GenericTexture() :
     m_width(0),
     m_height(0),
     m_orig_width(0),
-    m_orig_height(0)
+    m_orig_height(0),
+    m_shared(false)
 {
 }
 
@@ -32,9 +33,28 @@ void GenericTexture::unload_texture()
     if (!m_handle)
         return;
 
+    if (m_shared)
+    {
+        m_handle = 0;
+        m_shared = false;
+        return;
+    }
+
     glmanager->delete_textures(1, &m_handle);
 }
 
+void GenericTexture::share_texture(const GenericTexture &other)
+{
+    unload_texture();
+
+    m_handle = other.m_handle;
+    m_width = other.m_width;
+    m_height = other.m_height;
+    m_orig_width = other.m_orig_width;
+    m_orig_height = other.m_orig_height;
+    m_shared = true;
+}
+
 bool GenericTexture::load_texture(const char *filename,
                                   MipMapOptions mip_opt,
                                   tex_proc_func proc,
@@ -82,7 +102,7 @@ void GenericTexture::bind() const
 }
 
 TilesTexture::TilesTexture() :
-    GenericTexture(), m_tile_max(0), m_info_func(nullptr)
+    GenericTexture(), m_tile_max(0), m_info_func(nullptr), m_offset_y(0)
 {
 }
 
@@ -140,9 +160,9 @@ bool TilesTexture::get_coords(tileidx_t idx,
     pos_ey = pos_sy + (ey - sy) / tile_y;
 
     tex_sx = inf.sx / fwidth;
-    tex_sy = (inf.sy + sy - pos_sy_adjust) / fheight;
+    tex_sy = (m_offset_y + inf.sy + sy - pos_sy_adjust) / fheight;
     tex_ex = inf.ex / fwidth;
-    tex_ey = (inf.ey + ey - pos_ey_adjust) / fheight;
+    tex_ey = (m_offset_y + inf.ey + ey - pos_ey_adjust) / fheight;
 
     return true;
 }
@@ -173,15 +193,46 @@ ImageManager::~ImageManager()
     unload_textures();
 }
 
+// The height of a page as rltiles wrote it: the bottom of its lowest tile.
+static unsigned int _page_height(tileidx_t start, tileidx_t end,
+                                 tile_info_func *info_func)
+{
+    unsigned int height = 0;
+    for (tileidx_t idx = start; idx < end; ++idx)
+        height = max(height, (unsigned int) info_func(idx).ey);
+    return height;
+}
+
 bool ImageManager::load_textures(bool need_mips)
 {
     MipMapOptions mip = need_mips ?
         MIPMAP_CREATE : MIPMAP_NONE;
 
+    // rltiles stacks the floor, wall and feature pages in dngn.png, in that
+    // order. Drawing them all from the one texture lets the renderer merge
+    // the draws of their buffers. Without the atlas, load them separately.
+    const bool atlas = !datafile_path("dngn.png", false).empty();
+    if (atlas && !m_dngn_atlas.load_texture("dngn.png", mip))
+        return false;
+
     int i = 0;
     for (const auto &f : get_texture_filenames())
-        if (!m_textures[i++].load_texture(f.c_str(), mip))
+    {
+        if (atlas && i >= TEX_FLOOR && i <= TEX_FEAT)
+            m_textures[i++].share_texture(m_dngn_atlas);
+        else if (!m_textures[i++].load_texture(f.c_str(), mip))
             return false;
+    }
+
+    if (atlas)
+    {
+        const unsigned int floor_height =
+            _page_height(0, TILE_FLOOR_MAX, &tile_floor_info);
+        const unsigned int wall_height =
+            _page_height(TILE_FLOOR_MAX, TILE_WALL_MAX, &tile_wall_info);
+        m_textures[TEX_WALL].set_offset_y(floor_height);
+        m_textures[TEX_FEAT].set_offset_y(floor_height + wall_height);
+    }
 
     m_textures[TEX_FLOOR].set_info(TILE_FLOOR_MAX, &tile_floor_info);
     m_textures[TEX_WALL].set_info(TILE_DNGN_MAX, &tile_wall_info);
@@ -198,6 +249,7 @@ void ImageManager::unload_textures()
 {
     for (int i = 0; i < TEX_MAX; i++)
         m_textures[i].unload_texture();
+    m_dngn_atlas.unload_texture();
 }
 
 const TilesTexture &ImageManager::get_texture(TextureID t) const
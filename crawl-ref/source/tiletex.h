@@ -30,6 +30,9 @@ public:
     bool load_texture(unsigned char *pixels, unsigned int w, unsigned int h,
                       MipMapOptions mip_opt, int offsetx=-1, int offsety=-1);
     void unload_texture();
+    // Use a texture that has already been loaded. It is left for the
+    // other to unload.
+    void share_texture(const GenericTexture &other);
 
     unsigned int width() const { return m_width; }
     unsigned int height() const { return m_height; }
@@ -45,6 +48,8 @@ protected:
 
     unsigned int m_orig_width;
     unsigned int m_orig_height;
+
+    bool m_shared;
 };
 
 class TilesTexture : public GenericTexture
@@ -53,6 +58,8 @@ public:
     TilesTexture();
 
     void set_info(int max, tile_info_func *info);
+    // Where this texture's page starts, for a page of an atlas.
+    void set_offset_y(unsigned int offset_y) { m_offset_y = offset_y; }
     const tile_info &get_info(tileidx_t idx) const;
     bool get_coords(tileidx_t idx, int ofs_x, int ofs_y,
                            float &pos_sx, float &pos_sy,
@@ -65,6 +72,7 @@ public:
 protected:
     int m_tile_max;
     tile_info_func *m_info_func;
+    unsigned int m_offset_y;
 };
 
 class FontWrapper;
@@ -84,6 +92,8 @@ public:
 private:
     // XX just use vector??
     FixedVector<TilesTexture, TEX_MAX> m_textures;
+    // The floor, wall and feature pages, which share one texture.
+    GenericTexture m_dngn_atlas;
 };
 
 // TODO: This function should be moved elsewhere (where?) and called by
@@ -5,7 +5,6 @@
 
 #include "tileweb-text.h"
 
-#include "stringutil.h"
 #include "tiles-build-specific.h"
 #include "unicode.h"
 
@@ -61,6 +60,7 @@ void WebTextArea::resize(int x, int y)
         m_old_cbuf[i] = ' ';
         m_old_abuf[i] = 0;
     }
+    m_line_cache.assign(my, string());
 
     m_dirty = true;
 
@@ -91,6 +91,83 @@ void WebTextArea::put_character(char32_t chr, int fg, int bg, int x, int y)
     m_abuf[x + y * mx] = col;
 }
 
+static bool _is_blank(char32_t chr, uint8_t col)
+{
+    return chr == ' ' && ((col >> 4) & 0xF) == 0;
+}
+
+// Appends cells x0..x1 of line y as runs of one colour, each written as
+// `,col,"text"`. Blank cells join whatever run they are in, since their
+// foreground colour doesn't show.
+void WebTextArea::_write_runs(string &out, int y, int x0, int x1) const
+{
+    int last_col = -1;
+    for (int x = x0; x <= x1; ++x)
+    {
+        const char32_t chr = m_cbuf[x + y * mx];
+        int col = m_abuf[x + y * mx];
+        if (last_col != -1 && _is_blank(chr, col))
+            col = last_col;
+
+        if (col != last_col)
+        {
+            if (last_col != -1)
+                out.push_back('"');
+            out.push_back(',');
+            out += to_string(col);
+            out += ",\"";
+            last_col = col;
+        }
+
+        switch (chr)
+        {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        default:
+            if (chr < 0x20)
+                out.push_back(' ');
+            else
+            {
+                char buf[5];
+                out.append(buf, wctoutf8(buf, chr));
+            }
+            break;
+        }
+    }
+    if (last_col != -1)
+        out.push_back('"');
+}
+
+// The encoding of a whole line: 0 (its first column), then its runs up to
+// the last non-blank cell.
+const string &WebTextArea::_whole_line(int y)
+{
+    string &line = m_line_cache[y];
+    if (!line.empty())
+        return line;
+
+    int last = mx - 1;
+    while (last >= 0 && _is_blank(m_cbuf[last + y * mx], m_abuf[last + y * mx]))
+        last--;
+
+    line = "0";
+    if (last >= 0)
+        _write_runs(line, y, 0, last);
+    return line;
+}
+
+/**
+ * Send the lines that have changed, or with `force` every line that isn't
+ * blank, in a txt message. Each line is an array of its first column and
+ * then colour and text pairs: a line starting at column 0 replaces the
+ * whole line, otherwise only the cells from that column on that are
+ * included are changed, so a small change to a long line only sends the
+ * changed part of it.
+ */
 void WebTextArea::send(bool force)
 {
     if (m_cbuf == nullptr)
@@ -99,96 +176,58 @@ void WebTextArea::send(bool force)
         return;
     m_dirty = false;
 
-    int last_col = -1;
-    int space_count = 0;
-    bool dirty = false;
-    string html;
-
     bool sending = false;
+    string patch;
 
     for (int y = 0; y < my; ++y)
     {
-        last_col = -1;
-        space_count = 0;
-        dirty = false;
-        html.clear();
-
+        // The changed columns.
+        int x0 = -1, x1 = -1;
         for (int x = 0; x < mx; ++x)
         {
-            char32_t chr = m_cbuf[x + y * mx];
-            uint8_t col = m_abuf[x + y * mx];
-
-            if (chr != m_old_cbuf[x + y * mx] ||
-                col != m_old_abuf[x + y * mx])
-            {
-                dirty = true;
-                m_old_cbuf[x + y * mx] = chr;
-                m_old_abuf[x + y * mx] = col;
-            }
-
-            if (chr != ' ' || ((col >> 4) & 0xF) != 0)
+            const int i = x + y * mx;
+            if (m_cbuf[i] != m_old_cbuf[i] || m_abuf[i] != m_old_abuf[i])
             {
-                while (space_count)
-                {
-                    html.push_back(' ');
-                    space_count--;
-                }
+                if (x0 == -1)
+                    x0 = x;
+                x1 = x;
+                m_old_cbuf[i] = m_cbuf[i];
+                m_old_abuf[i] = m_abuf[i];
             }
+        }
 
-            if (col != last_col && chr != ' ')
-            {
-                if (last_col != -1)
-                    html += "</span>";
-                html += make_stringf("<span class=\\\"fg%d bg%d\\\">",
-                                     col & 0xf, (col >> 4) & 0xf);
-                last_col = col;
-            }
+        if (x0 != -1)
+            m_line_cache[y].clear();
 
-            if (chr == ' ' && ((col >> 4) & 0xF) == 0)
-                space_count++;
-            else
-            {
-                switch (chr)
-                {
-                case '<':
-                    html += "&lt;";
-                    break;
-                case '>':
-                    html += "&gt;";
-                    break;
-                case '&':
-                    html += "&amp;";
-                    break;
-                case '\\':
-                    html += "\\\\";
-                    break;
-                case '"':
-                    html += "&quot;";
-                    break;
-                default:
-                    char buf[5];
-                    buf[wctoutf8(buf, chr)] = 0;
-                    html += buf;
-                    break;
-                }
-            }
+        const string *line = nullptr;
+        if (force || x0 == 0)
+        {
+            line = &_whole_line(y);
+            // Blank lines only need sending if they weren't before.
+            if (x0 == -1 && *line == "0")
+                continue;
         }
-
-        if (dirty || (force && !html.empty()))
+        else if (x0 != -1)
         {
-            if (!sending)
-            {
-                tiles.write_message("{\"msg\":\"txt\",\"id\":\"%s\"",
-                                    m_client_side_name.c_str());
-                if (force)
-                    tiles.write_message(",\"clear\":true");
-                tiles.write_message(",\"lines\":{");
-                sending = true;
-            }
+            patch = to_string(x0);
+            _write_runs(patch, y, x0, x1);
+            line = &patch;
+        }
+        else
+            continue;
 
-            tiles.json_write_comma();
-            tiles.write_message("\"%u\":\"%s\"", y, html.c_str());
+        if (!sending)
+        {
+            tiles.write_message("{\"msg\":\"txt\",\"id\":\"%s\"",
+                                m_client_side_name.c_str());
+            if (force)
+                tiles.write_message(",\"clear\":true");
+            tiles.write_message(",\"lines\":{");
+            sending = true;
         }
+
+        tiles.json_write_comma();
+        tiles.write_message("\"%u\":[%s]", y, line->c_str());
     }
     if (sending)
     {
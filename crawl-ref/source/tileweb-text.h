@@ -2,6 +2,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 class WebTextArea
 {
@@ -30,6 +31,13 @@ protected:
 
     bool m_dirty;
 
+    // The encoding of each whole line as last sent, or empty if the line
+    // has changed since.
+    vector<string> m_line_cache;
+
+    void _write_runs(string &out, int y, int x0, int x1) const;
+    const string &_whole_line(int y);
+
     virtual void on_resize();
 };
 
@@ -25,9 +25,11 @@
 #include "english.h"
 #include "env.h"
 #include "files.h"
+#include "hash.h"
 #include "invent.h"
 #include "item-name.h"
 #include "item-prop.h" // is_weapon()
+#include "items.h"
 #include "json.h"
 #include "json-wrapper.h"
 #include "lang-fake.h"
@@ -61,6 +63,7 @@
 #include "tileview.h"
 #include "transform.h"
 #include "travel.h"
+#include "turn-times.h"
 #include "ui.h"
 #include "unicode.h"
 #include "unwind.h"
@@ -84,6 +87,10 @@ static unsigned int get_milliseconds()
 TilesFramework tiles;
 
 TilesFramework::TilesFramework() :
+      m_need_resync(false),
+      m_snapshot_gen(0),
+      m_output_gen(0),
+      m_capturing_snapshot(false),
       m_controlled_from_web(false),
       _send_lock(false),
       m_last_ui_state(UI_INIT),
@@ -95,6 +102,7 @@ TilesFramework::TilesFramework() :
       m_current_flash_colour(BLACK),
       m_next_flash_colour(BLACK),
       m_need_full_map(true),
+      m_packed_map(false),
       m_text_menu("menu_txt"),
       m_print_fg(15)
 {
@@ -102,6 +110,10 @@ TilesFramework::TilesFramework() :
     default_cell.tile.bg = TILE_FLAG_UNSEEN;
     m_current_view.fill(default_cell);
     m_next_view.fill(default_cell);
+
+    // Full map messages run to tens of kilobytes; clear() keeps the
+    // capacity, so this is usually the only allocation.
+    m_msg_buf.reserve(64 * 1024);
 }
 
 TilesFramework::~TilesFramework()
@@ -113,6 +125,14 @@ void TilesFramework::shutdown()
     if (m_sock_name.empty())
         return;
 
+    // Give receivers a couple of seconds to take anything still queued,
+    // such as the exit reason.
+    for (int tries = 0; tries < 40 && _output_queued(); ++tries)
+    {
+        usleep(50 * 1000);
+        _send_queued_output();
+    }
+
     close(m_sock);
     remove(m_sock_name.c_str());
 }
@@ -184,9 +204,186 @@ void TilesFramework::write_message(const char *format, ...)
         die("Webtiles message too long! (%d)", len);
     va_end(argp);
 
+    _start_message();
     m_msg_buf.append(buf);
 }
 
+// Messages start with {"msg":"<type>", or *{"msg":"<type>" for ones
+// addressed to the server.
+static string _message_type(const string &msg)
+{
+    const string key = "{\"msg\":\"";
+    const size_t start = msg.compare(0, key.size(), key) == 0 ? key.size()
+                       : msg.compare(1, key.size(), key) == 0 ? key.size() + 1
+                       : string::npos;
+    if (start == string::npos)
+        return "?";
+    const size_t end = msg.find('"', start);
+    if (end == string::npos)
+        return "?";
+    return (msg[0] == '*' ? "*" : "") + msg.substr(start, end - start);
+}
+
+void TilesFramework::_count_message()
+{
+    MessageStats &stats = m_msg_stats[_message_type(m_msg_buf)];
+    stats.count++;
+    stats.bytes += m_msg_buf.size();
+    stats.time += chrono::steady_clock::now() - m_msg_started;
+}
+
+void TilesFramework::send_stats()
+{
+    json_open_object();
+    json_write_string("msg", "webtiles_stats");
+    json_open_object("types");
+    for (const auto &entry : m_msg_stats)
+    {
+        json_open_object(entry.first);
+        json_write_int("count", entry.second.count);
+        // Kilobytes, to stay within an int.
+        json_write_int("kb", entry.second.bytes / 1024);
+        json_write_int("ms", chrono::duration_cast<chrono::milliseconds>(
+                                 entry.second.time).count());
+        json_close_object();
+    }
+    json_close_object();
+    json_close_object();
+    // Addressed to the server, which logs it.
+    m_msg_buf.insert(0, "*");
+    finish_message();
+}
+
+string TilesFramework::stats_description() const
+{
+    string desc = make_stringf("%-20s %8s %12s %10s %8s\n", "message",
+                               "count", "bytes", "ms", "avg B");
+    for (const auto &entry : m_msg_stats)
+    {
+        const MessageStats &stats = entry.second;
+        desc += make_stringf("%-20s %8u %12llu %10.1f %8llu\n",
+            entry.first.c_str(), stats.count,
+            (unsigned long long) stats.bytes,
+            chrono::duration<double, milli>(stats.time).count(),
+            (unsigned long long) (stats.count ? stats.bytes / stats.count
+                                              : 0));
+    }
+    return desc;
+}
+
+// A receiver that holds more than this much unsent output has its queue
+// dropped and is sent a full resync instead.
+static const size_t MAX_QUEUED_OUTPUT = 1024 * 1024;
+
+// Sends data to r in fragments of at most m_max_msg_size bytes, without
+// blocking. Returns the number of bytes sent, or -1 if the receiver has
+// gone away.
+int TilesFramework::_send_data(Receiver &r, const char *data, int len)
+{
+    int sent = 0;
+    while (sent < len)
+    {
+        const int fragment_size = min(len - sent, m_max_msg_size);
+        ssize_t retval = sendto(m_sock, data + sent, fragment_size,
+                                MSG_DONTWAIT, (sockaddr*) &r.addr,
+                                sizeof(sockaddr_un));
+        if (retval > 0)
+        {
+            sent += retval;
+            continue;
+        }
+
+        if (retval < 0 && errno == EINTR)
+            continue;
+        if (retval == 0 || errno == ENOBUFS || errno == EWOULDBLOCK
+            || errno == EAGAIN)
+        {
+#ifdef DEBUG_WEBSOCKETS
+            fprintf(stderr, "websocket: receiver busy, queueing %d bytes.\n",
+                    len - sent);
+#endif
+            break;
+        }
+        if (errno == ECONNREFUSED || errno == ENOENT)
+        {
+            // the other side is dead
+#ifdef DEBUG_WEBSOCKETS
+            fprintf(stderr, "websocket: send failed (%s), dropping receiver.\n",
+                    strerror(errno));
+#endif
+            return -1;
+        }
+        die("Socket write error: %s", strerror(errno));
+    }
+    return sent;
+}
+
+// Sends as much of r's queue as it will take. Returns false if the
+// receiver has gone away.
+bool TilesFramework::_send_queued(Receiver &r)
+{
+    while (!r.queue.empty())
+    {
+        const string &msg = r.queue.front();
+        const int sent = _send_data(r, msg.data() + r.sent,
+                                    msg.size() - r.sent);
+        if (sent < 0)
+            return false;
+
+        r.sent += sent;
+        r.queued -= sent;
+        if (r.sent < msg.size())
+            break;
+
+        r.queue.pop_front();
+        r.sent = 0;
+    }
+    return true;
+}
+
+// Drops queued messages that can be replaced by a resync: everything but
+// a partly sent message (the receiver would see half of it otherwise) and
+// messages for the server itself, which start with '*'.
+void TilesFramework::_trim_queue(Receiver &r)
+{
+    deque<string> kept;
+    for (unsigned int i = 0; i < r.queue.size(); ++i)
+    {
+        if (i == 0 && r.sent > 0 || r.queue[i][0] == '*')
+            kept.push_back(std::move(r.queue[i]));
+    }
+    r.queue.swap(kept);
+
+    r.queued = 0;
+    for (const string &msg : r.queue)
+        r.queued += msg.size();
+    if (!r.queue.empty())
+        r.queued -= r.sent;
+
+    dprf("Webtiles receiver fell behind; resyncing.");
+    m_need_resync = true;
+}
+
+void TilesFramework::_send_queued_output()
+{
+    for (unsigned int i = 0; i < m_receivers.size(); ++i)
+    {
+        if (!_send_queued(m_receivers[i]))
+        {
+            m_receivers.erase(m_receivers.begin() + i);
+            i--;
+        }
+    }
+}
+
+bool TilesFramework::_output_queued() const
+{
+    for (const Receiver &r : m_receivers)
+        if (!r.queue.empty())
+            return true;
+    return false;
+}
+
 void TilesFramework::finish_message()
 {
     if (m_msg_buf.size() == 0)
@@ -202,86 +399,55 @@ void TilesFramework::finish_message()
         return;
     }
 
+    _count_message();
+
+    // Messages for the server itself (starting with '*') don't change what
+    // the client shows.
+    if (m_capturing_snapshot)
+        m_snapshot.push_back(m_msg_buf);
+    else if (m_msg_buf[0] != '*')
+        ++m_output_gen;
+
     m_msg_buf.append("\n");
-    const char* fragment_start = m_msg_buf.data();
-    const char* data_end = m_msg_buf.data() + m_msg_buf.size();
-    int fragments = 0;
-    while (fragment_start < data_end)
+    for (unsigned int i = 0; i < m_receivers.size(); ++i)
     {
-        int fragment_size = data_end - fragment_start;
-        if (fragment_size > m_max_msg_size)
-            fragment_size = m_max_msg_size;
-        fragments++;
+        Receiver &r = m_receivers[i];
 
-        for (unsigned int i = 0; i < m_dest_addrs.size(); ++i)
+        // Anything already waiting has to go first.
+        bool alive = _send_queued(r);
+        int sent = 0;
+        if (alive && r.queue.empty())
         {
-            int retries = 30;
-            ssize_t sent = 0;
-            while (sent < fragment_size)
-            {
-                ssize_t retval = sendto(m_sock, fragment_start + sent,
-                    fragment_size - sent, 0, (sockaddr*) &m_dest_addrs[i],
-                    sizeof(sockaddr_un));
-#ifdef DEBUG_WEBSOCKETS
-                fprintf(stderr,
-                            "    trying to send fragment to client %d...", i);
-#endif
-                if (retval <= 0)
-                {
-                    const char *errmsg = retval == 0 ? "No bytes sent"
-                                                     : strerror(errno);
-                    if (--retries <= 0)
-                        die("Socket write error: %s", errmsg);
+            sent = _send_data(r, m_msg_buf.data(), m_msg_buf.size());
+            alive = sent >= 0;
+        }
 
-                    if (retval == 0 || errno == ENOBUFS || errno == EWOULDBLOCK
-                        || errno == EINTR || errno == EAGAIN)
-                    {
-                        // Wait for half a second at first (up to five), then
-                        // try again.
-                        const int sleep_time = retries > 25 ? 2 * 1000
-                                             : retries > 10 ? 500 * 1000
-                                             : 5000 * 1000;
-#ifdef DEBUG_WEBSOCKETS
-                        fprintf(stderr, "failed (%s), sleeping for %dms.\n",
-                                                    errmsg, sleep_time / 1000);
-#endif
-                        usleep(sleep_time);
-                    }
-                    else if (errno == ECONNREFUSED || errno == ENOENT)
-                    {
-                        // the other side is dead
-#ifdef DEBUG_WEBSOCKETS
-                        fprintf(stderr,
-                            "failed (%s), breaking.\n", errmsg);
-#endif
-                        m_dest_addrs.erase(m_dest_addrs.begin() + i);
-                        i--;
-                        break;
-                    }
-                    else
-                        die("Socket write error: %s", errmsg);
-                }
-                else
-                {
-#ifdef DEBUG_WEBSOCKETS
-                    fprintf(stderr, "fragment size %d sent.\n", fragment_size);
-#endif
-                    sent += retval;
-                }
-            }
+        if (!alive)
+        {
+            m_receivers.erase(m_receivers.begin() + i);
+            i--;
+            continue;
         }
 
-        fragment_start += fragment_size;
+        if (sent < (int) m_msg_buf.size())
+        {
+            // sent is only non-zero if this is now the front of the queue.
+            if (r.queue.empty())
+                r.sent = sent;
+            r.queue.push_back(m_msg_buf);
+            r.queued += m_msg_buf.size() - sent;
+            if (r.queued > MAX_QUEUED_OUTPUT)
+                _trim_queue(r);
+        }
     }
     m_msg_buf.clear();
     m_need_flush = true;
 #ifdef DEBUG_WEBSOCKETS
     // should the game actually crash in this case?
-    if (m_controlled_from_web && m_dest_addrs.size() == 0)
+    if (m_controlled_from_web && m_receivers.size() == 0)
         fprintf(stderr, "No open websockets after finish_message!!\n");
 
-    fprintf(stderr, "websocket: Sent %d bytes in %d fragments.\n",
-                                                initial_buf_size, fragments);
+    fprintf(stderr, "websocket: Sent %d bytes.\n", initial_buf_size);
 #endif
 }
 
@@ -302,6 +468,7 @@ void TilesFramework::send_message(const char *format, ...)
     }
     va_end(argp);
 
+    _start_message();
     m_msg_buf.append(buf);
 
     finish_message();
@@ -325,7 +492,7 @@ void TilesFramework::_await_connection()
     if (m_sock_name.empty())
         return;
 
-    while (m_dest_addrs.size() == 0)
+    while (m_receivers.empty())
         _receive_control_message();
 }
 
@@ -436,7 +603,8 @@ wint_t TilesFramework::_handle_control_message(sockaddr_un addr, string data)
         JsonWrapper primary = json_find_member(obj.node, "primary");
         primary.check(JSON_BOOL);
 
-        m_dest_addrs.push_back(addr);
+        m_receivers.emplace_back();
+        m_receivers.back().addr = addr;
         m_controlled_from_web = primary->bool_;
     }
     else if (msgtype == "key")
@@ -447,6 +615,17 @@ wint_t TilesFramework::_handle_control_message(sockaddr_un addr, string data)
         // TODO: remove this fixup call
         c = (int) keycode->number_;
     }
+    else if (msgtype == "map_encoding")
+    {
+        JsonWrapper packed = json_find_member(obj.node, "packed");
+        packed.check(JSON_BOOL);
+
+        if (packed->bool_ != m_packed_map)
+        {
+            m_packed_map = packed->bool_;
+            m_need_full_map = true;
+        }
+    }
     else if (msgtype == "spectator_joined")
     {
         flush_messages();
@@ -480,7 +659,8 @@ wint_t TilesFramework::_handle_control_message(sockaddr_un addr, string data)
         if (!m_menu_stack.empty() && m_menu_stack.back().type == UIStackFrame::MENU)
             m_menu_stack.back().menu->webtiles_scroll((int) first->number_, (int) hover->number_);
     }
-    else if (msgtype == "*request_menu_range")
+    else if (msgtype == "request_menu_range"
+             || msgtype == "*request_menu_range")
     {
         JsonWrapper start = json_find_member(obj.node, "start");
         start.check(JSON_NUMBER);
@@ -625,7 +805,13 @@ bool TilesFramework::await_input(wint_t& c, bool block)
             if (block)
             {
                 tiles.flush_messages();
-                result = select(maxfd + 1, &fds, nullptr, nullptr, nullptr);
+                // Wake up now and then to retry output a receiver couldn't
+                // take yet.
+                timeval retry;
+                retry.tv_sec = 0;
+                retry.tv_usec = 50 * 1000;
+                result = select(maxfd + 1, &fds, nullptr, nullptr,
+                                _output_queued() ? &retry : nullptr);
             }
             else
             {
@@ -638,8 +824,14 @@ bool TilesFramework::await_input(wint_t& c, bool block)
         }
         while (result == -1 && errno == EINTR);
 
+        _send_queued_output();
+
         if (result == 0)
+        {
+            if (block)
+                continue;
             return false;
+        }
         else if (result > 0)
         {
             if (!m_sock_name.empty() && FD_ISSET(m_sock, &fds))
@@ -1050,9 +1242,56 @@ static bool _update_statuses(player_info& c)
     return changed;
 }
 
+/**
+ * A cheap signature of the state the status lights are computed from.
+ * Everything fill_status_info() looks at either lives in the durations
+ * and attributes or only changes as game time passes, so while this stays
+ * the same the statuses don't need to be recomputed.
+ */
+static uint32_t _status_key()
+{
+    const int key[] =
+    {
+        (int) hash32(&you.duration[0], sizeof(int) * NUM_DURATIONS),
+        (int) hash32(&you.attribute[0], sizeof(int) * NUM_ATTRIBUTES),
+        you.num_turns,
+        you.elapsed_time,
+        you.pos().x,
+        you.pos().y,
+        (int) you.form,
+        (int) you.props.size(),
+        you.redraw_status_lights,
+    };
+    return hash32(key, sizeof(key));
+}
+
+/**
+ * A cheap signature of the player state that item display depends on
+ * besides the item itself: uselessness, evoker charges, corrosion and what
+ * is known of item types.
+ */
+static uint32_t _inv_key(uint32_t status_key)
+{
+    int8_t equip[NUM_EQUIP];
+    for (int i = 0; i < NUM_EQUIP; ++i)
+        equip[i] = you.melded[i] ? -1 : you.equip[i];
+
+    const int key[] =
+    {
+        (int) status_key,
+        (int) hash32(equip, sizeof(equip)),
+        you.experience_level,
+        Options.action_panel_glyphs,
+        (int) item_knowledge_generation(),
+    };
+    return hash32(key, sizeof(key));
+}
+
 player_info::player_info()
 {
     _state_ever_synced = false;
+    status_key = 0;
+    inv_key = 0;
     for (auto &eq : equip)
         eq = -1;
     position = coord_def(-1, -1);
@@ -1203,7 +1442,14 @@ void TilesFramework::_send_player(bool force_full)
         c.position = pos;
     }
 
-    if (force_full || _update_statuses(c))
+    // The status and inventory sections are the expensive ones; only
+    // recompute them when something they depend on has changed. A full
+    // send (spectator join) always compares everything.
+    const uint32_t status_key = _status_key();
+    const bool statuses_dirty = force_full || status_key != c.status_key;
+    c.status_key = status_key;
+
+    if (statuses_dirty && (_update_statuses(c) || force_full))
     {
         json_open_array("status");
         for (const status_info &status : c.status)
@@ -1230,14 +1476,23 @@ void TilesFramework::_send_player(bool force_full)
         json_close_array();
     }
 
+    const uint32_t inv_key = _inv_key(status_key);
+    const bool inv_dirty = force_full || inv_key != c.inv_key;
+    c.inv_key = inv_key;
+
     json_open_object("inv");
     for (unsigned int i = 0; i < ENDOFPACK; ++i)
     {
+        if (!inv_dirty && same_item_state(c.inv_raw[i], you.inv[i]))
+            continue;
+        c.inv_raw[i] = you.inv[i];
+
         json_open_object(to_string(i));
         item_def item = get_item_known_info(you.inv[i]);
         if ((char)i == you.equip[EQ_WEAPON] && is_weapon(item) && you.corrosion_amount())
             item.plus -= 4 * you.corrosion_amount();
-        _send_item(c.inv[i], item, c.inv_uselessness[i], force_full);
+        _send_item(c.inv[i], item, c.inv_uselessness[i], c.inv_name[i],
+                   c.inv_colour[i], force_full);
         json_close_object(true);
     }
     json_close_object(true);
@@ -1306,6 +1561,7 @@ static string _qty_field_name(const item_def &item)
 
 void TilesFramework::_send_item(item_def& current, const item_def& next,
                                 bool& current_uselessness,
+                                string& current_name, int& current_colour,
                                 bool force_full)
 {
     bool changed = false;
@@ -1368,11 +1624,8 @@ void TilesFramework::_send_item(item_def& current, const item_def& next,
     if (changed && defined)
     {
         string name = next.name(DESC_A, true, false, true);
-        if (force_full || current.name(DESC_A, true, false, true) != name
-            || xp_evoker_changed)
-        {
+        if (force_full || current_name != name || xp_evoker_changed)
             json_write_string("name", name);
-        }
 
         // -1 in this field means don't show. *note*: showing in the action
         // panel has undefined behavior for item types that don't have a
@@ -1382,18 +1635,11 @@ void TilesFramework::_send_item(item_def& current, const item_def& next,
 
         const string prefix = item_prefix(next);
         const int prefcol = menu_colour(next.name(DESC_INVENTORY), prefix, "inventory", false);
-        if (force_full)
+        if (force_full || current_colour != prefcol)
             json_write_int("col", macro_colour(prefcol));
-        else
-        {
-            const string current_prefix = item_prefix(current);
-            const int current_prefcol = menu_colour(
-                current.name(DESC_INVENTORY), current_prefix,
-                "inventory", false);
 
-            if (current_prefcol != prefcol)
-                json_write_int("col", macro_colour(prefcol));
-        }
+        current_name = name;
+        current_colour = prefcol;
 
         tileidx_t tile = tileidx_item(next);
         if (force_full || tileidx_item(current) != tile || xp_evoker_changed)
@@ -1550,73 +1796,170 @@ static inline unsigned _get_highlight(int col)
                                             : unsigned{CHATTR_NORMAL};
 }
 
+// Appends value in decimal, without going through printf.
+static void _append_int(string &buf, int value)
+{
+    char digits[12];
+    char *p = digits + sizeof(digits);
+    // Work with the magnitude as unsigned, so INT_MIN is safe.
+    unsigned int mag = value < 0 ? 0U - (unsigned int) value
+                                 : (unsigned int) value;
+    do
+    {
+        *--p = '0' + mag % 10;
+        mag /= 10;
+    }
+    while (mag);
+    if (value < 0)
+        *--p = '-';
+    buf.append(p, digits + sizeof(digits) - p);
+}
+
 void TilesFramework::write_tileidx(tileidx_t t)
 {
     // JS can only handle signed ints
     const int lo = t & 0xFFFFFFFF;
     const int hi = t >> 32;
     if (hi == 0)
-        tiles.write_message("%d", lo);
+        _append_int(m_msg_buf, lo);
     else
-        tiles.write_message("[%d,%d]", lo, hi);
+    {
+        m_msg_buf.push_back('[');
+        _append_int(m_msg_buf, lo);
+        m_msg_buf.push_back(',');
+        _append_int(m_msg_buf, hi);
+        m_msg_buf.push_back(']');
+    }
 }
 
-void TilesFramework::_send_cell(const coord_def &gc,
+// Bits of the mask that starts a packed cell, one for each of the values
+// that may follow it, in this order. Anything else that changed follows
+// them as an object in the usual format (with fg and bg left out of "t").
+enum packed_cell_field
+{
+    PACKED_POS    = 1 << 0, // x, y
+    PACKED_FEAT   = 1 << 1, // f
+    PACKED_MAPFT  = 1 << 2, // mf
+    PACKED_GLYPH  = 1 << 3, // g
+    PACKED_COLOUR = 1 << 4, // col
+    PACKED_FG     = 1 << 5, // t.fg
+    PACKED_BG     = 1 << 6, // t.bg
+};
+
+// Writes the changes to one cell, as an object or (with m_packed_map) as
+// an array. Returns false if nothing changed, in which case nothing is
+// written.
+bool TilesFramework::_send_cell(const coord_def &gc, bool send_pos,
                                 const screen_cell_t &current_sc, const screen_cell_t &next_sc,
                                 const map_cell &current_mc, const map_cell &next_mc,
                                 map<uint32_t, coord_def>& new_monster_locs,
                                 bool force_full)
 {
-    if (current_mc.feat() != next_mc.feat())
-        json_write_int("f", next_mc.feat());
+    const packed_cell &next_pc = next_sc.tile;
+    const packed_cell &current_pc = current_sc.tile;
+    const map_feature mf = get_cell_map_feature(gc);
+    const char32_t glyph = next_sc.glyph;
+    int col = next_sc.colour;
+    col = (_get_highlight(col) << 4) | macro_colour(col & 0xF);
 
-    if (next_mc.monsterinfo())
-        _send_monster(gc, next_mc.monsterinfo(), new_monster_locs, force_full);
-    else if (current_mc.monsterinfo())
-        json_write_null("mon");
-
-    map_feature mf = get_cell_map_feature(gc);
+    unsigned int changed = 0;
+    if (send_pos)
+        changed |= PACKED_POS;
+    if (current_mc.feat() != next_mc.feat())
+        changed |= PACKED_FEAT;
     if (get_cell_map_feature(current_mc) != mf)
-        json_write_int("mf", mf);
-
-    // Glyph and colour
-    char32_t glyph = next_sc.glyph;
+        changed |= PACKED_MAPFT;
     if (current_sc.glyph != glyph)
-    {
-        char buf[5];
-        buf[wctoutf8(buf, glyph)] = 0;
-        json_write_string("g", buf);
-    }
+        changed |= PACKED_GLYPH;
     if ((current_sc.colour != next_sc.colour
          || current_sc.glyph == ' ') && glyph != ' ')
     {
-        int col = next_sc.colour;
-        col = (_get_highlight(col) << 4) | macro_colour(col & 0xF);
-        json_write_int("col", col);
+        changed |= PACKED_COLOUR;
     }
+    if (next_pc.fg != current_pc.fg)
+        changed |= PACKED_FG;
+    if (next_pc.bg != current_pc.bg)
+        changed |= PACKED_BG;
+
+    char glyph_buf[5];
+    glyph_buf[wctoutf8(glyph_buf, glyph)] = 0;
+
+    if (m_packed_map)
+    {
+        json_open_array();
+        json_write_int(changed);
+        if (changed & PACKED_POS)
+        {
+            json_write_int(gc.x - m_origin.x);
+            json_write_int(gc.y - m_origin.y);
+        }
+        // A position alone doesn't count as a change.
+        if (!(changed & ~PACKED_POS))
+            json_treat_as_empty();
+        if (changed & PACKED_FEAT)
+            json_write_int(next_mc.feat());
+        if (changed & PACKED_MAPFT)
+            json_write_int(mf);
+        if (changed & PACKED_GLYPH)
+            json_write_string(glyph_buf);
+        if (changed & PACKED_COLOUR)
+            json_write_int(col);
+        if (changed & PACKED_FG)
+        {
+            json_write_comma();
+            write_tileidx(next_pc.fg);
+        }
+        if (changed & PACKED_BG)
+        {
+            json_write_comma();
+            write_tileidx(next_pc.bg);
+        }
+        json_open_object();
+    }
+    else
+    {
+        json_open_object();
+        if (changed & PACKED_POS)
+        {
+            json_write_int("x", gc.x - m_origin.x);
+            json_write_int("y", gc.y - m_origin.y);
+            json_treat_as_empty();
+        }
+        if (changed & PACKED_FEAT)
+            json_write_int("f", next_mc.feat());
+        if (changed & PACKED_MAPFT)
+            json_write_int("mf", mf);
+        if (changed & PACKED_GLYPH)
+            json_write_string("g", glyph_buf);
+        if (changed & PACKED_COLOUR)
+            json_write_int("col", col);
+    }
+
+    if (next_mc.monsterinfo())
+        _send_monster(gc, next_mc.monsterinfo(), new_monster_locs, force_full);
+    else if (current_mc.monsterinfo())
+        json_write_null("mon");
 
     json_open_object("t");
     {
         // Tile data
-        const packed_cell &next_pc = next_sc.tile;
-        const packed_cell &current_pc = current_sc.tile;
-
         const tileidx_t fg_idx = next_pc.fg & TILE_FLAG_MASK;
 
         const bool in_water = _in_water(next_pc);
-        bool fg_changed = false;
+        const bool fg_changed = changed & PACKED_FG;
 
-        if (next_pc.fg != current_pc.fg)
+        if (fg_changed)
         {
-            fg_changed = true;
-
-            json_write_name("fg");
-            write_tileidx(next_pc.fg);
+            if (!m_packed_map)
+            {
+                json_write_name("fg");
+                write_tileidx(next_pc.fg);
+            }
             if (get_tile_texture(fg_idx) == TEX_DEFAULT)
                 json_write_int("base", (int) tileidx_known_base_item(fg_idx));
         }
 
-        if (next_pc.bg != current_pc.bg)
+        if ((changed & PACKED_BG) && !m_packed_map)
         {
             json_write_name("bg");
             write_tileidx(next_pc.bg);
@@ -1698,7 +2041,11 @@ void TilesFramework::_send_cell(const coord_def &gc,
             {
                 mcache_entry *entry = mcache.get(fg_idx);
                 if (entry)
+                {
+                    const size_t start = m_msg_buf.size();
                     send_mcache(entry, in_water);
+                    _dedup_composite(start);
+                }
                 else
                 {
                     json_write_comma();
@@ -1719,6 +2066,7 @@ void TilesFramework::_send_cell(const coord_def &gc,
             }
             if (fg_changed || player_doll_changed)
             {
+                const size_t start = m_msg_buf.size();
                 send_doll(last_player_doll, in_water, false);
                 if (Options.tile_use_monster != MONS_0)
                 {
@@ -1747,6 +2095,7 @@ void TilesFramework::_send_cell(const coord_def &gc,
                 }
                 else
                     json_write_null("mcache");
+                _dedup_composite(start);
             }
         }
         else if (get_tile_texture(fg_idx) == TEX_PLAYER)
@@ -1793,6 +2142,48 @@ void TilesFramework::_send_cell(const coord_def &gc,
         }
     }
     json_close_object(true);
+
+    if (!m_packed_map)
+    {
+        const bool empty = json_is_empty();
+        json_close_object(true);
+        return !empty;
+    }
+
+    // The extras object, then the array.
+    json_close_object(true);
+    const bool empty = json_is_empty();
+    json_close_array(true);
+    return !empty;
+}
+
+// Most monsters' dolls and mcache entries are identical to ones sent
+// before, as the same monsters move around. With the packed encoding, the
+// definition written since `start` is given an id the first time it is
+// sent, and replaced by just that id afterwards.
+#define MAX_COMPOSITE_IDS 4096
+void TilesFramework::_dedup_composite(size_t start)
+{
+    if (!m_packed_map)
+        return;
+
+    // Whether it starts with a comma depends on what came before it.
+    if (start < m_msg_buf.size() && m_msg_buf[start] == ',')
+        start++;
+    string def = m_msg_buf.substr(start);
+
+    auto it = m_composite_ids.find(def);
+    if (it != m_composite_ids.end())
+    {
+        m_msg_buf.resize(start);
+        json_write_int("mc", it->second);
+    }
+    else if (m_composite_ids.size() < MAX_COMPOSITE_IDS)
+    {
+        const int id = m_composite_ids.size() + 1;
+        m_composite_ids.emplace(move(def), id);
+        json_write_int("mc", id);
+    }
 }
 
 void TilesFramework::_send_cursor(cursor_type type)
@@ -1809,30 +2200,33 @@ void TilesFramework::_send_cursor(cursor_type type)
     }
 }
 
+static void _mcache_ref_cell(const screen_cell_t &cell, bool inc)
+{
+    int fg_idx = cell.tile.fg & TILE_FLAG_MASK;
+    if (fg_idx >= TILEP_MCACHE_START)
+    {
+        mcache_entry *entry = mcache.get(fg_idx);
+        if (entry)
+        {
+            if (inc)
+                entry->inc_ref();
+            else
+                entry->dec_ref();
+        }
+    }
+}
+
 void TilesFramework::_mcache_ref(bool inc)
 {
     for (int y = 0; y < GYM; y++)
         for (int x = 0; x < GXM; x++)
-        {
-            coord_def gc(x, y);
-
-            int fg_idx = m_current_view(gc).tile.fg & TILE_FLAG_MASK;
-            if (fg_idx >= TILEP_MCACHE_START)
-            {
-                mcache_entry *entry = mcache.get(fg_idx);
-                if (entry)
-                {
-                    if (inc)
-                        entry->inc_ref();
-                    else
-                        entry->dec_ref();
-                }
-            }
-        }
+            _mcache_ref_cell(m_current_view(coord_def(x, y)), inc);
 }
 
 void TilesFramework::_send_map(bool force_full)
 {
+    TURN_PHASE(TP_SEND_MAP);
+
     // TODO: prevent in some other / better way?
     if (_send_lock)
         return;
@@ -1851,7 +2245,13 @@ void TilesFramework::_send_map(bool force_full)
     // cautionary note: this is used in heuristic ways in process_handler.py,
     // see `_is_full_map_msg`
     if (force_full)
+    {
         json_write_bool("clear", true);
+        m_composite_ids.clear();
+    }
+
+    if (m_packed_map)
+        json_write_bool("packed", true);
 
     if (force_full || you.on_current_level != m_player_on_level)
     {
@@ -1878,6 +2278,8 @@ void TilesFramework::_send_map(bool force_full)
 
     coord_def last_gc(0, 0);
     bool send_gc = true;
+    // Only these can now differ from what the client was last sent.
+    vector<coord_def> sent_cells;
 
     json_open_array("cells");
     for (int y = 0; y < GYM; y++)
@@ -1897,36 +2299,28 @@ void TilesFramework::_send_map(bool force_full)
             }
 
             mark_clean(gc);
+            sent_cells.push_back(gc);
 
             if (m_origin.equals(-1, -1))
                 m_origin = gc;
 
-            json_open_object();
-            if (send_gc
-                || last_gc.x + 1 != gc.x
-                || last_gc.y != gc.y)
-            {
-                json_write_int("x", x - m_origin.x);
-                json_write_int("y", y - m_origin.y);
-                json_treat_as_empty();
-            }
+            const bool send_pos = send_gc
+                                  || last_gc.x + 1 != gc.x
+                                  || last_gc.y != gc.y;
 
             const screen_cell_t& sc = force_full ? default_cell
                 : m_current_view(gc);
             const map_cell& mc = force_full ? default_map_cell
                 : m_current_map_knowledge(gc);
-            _send_cell(gc,
-                       sc,
-                       m_next_view(gc),
-                       mc, env.map_knowledge(gc),
-                       new_monster_locs, force_full);
-
-            if (!json_is_empty())
+            if (_send_cell(gc, send_pos,
+                           sc,
+                           m_next_view(gc),
+                           mc, env.map_knowledge(gc),
+                           new_monster_locs, force_full))
             {
                 send_gc = false;
                 last_gc = gc;
             }
-            json_close_object(true);
         }
     json_close_array(true);
 
@@ -1937,14 +2331,26 @@ void TilesFramework::_send_map(bool force_full)
     if (force_full)
         _send_cursor(CURSOR_MAP);
 
-    if (m_mcache_ref_done)
-        _mcache_ref(false);
-
-    m_current_map_knowledge = env.map_knowledge;
-    m_current_view = m_next_view;
+    // Copy just the cells that were sent, rather than the whole level.
+    // This is done after the loop, since _send_monster diffs against a
+    // monster's previous square.
+    for (const coord_def &gc : sent_cells)
+    {
+        if (m_mcache_ref_done)
+        {
+            // Take the new reference first, in case it's the same entry.
+            _mcache_ref_cell(m_next_view(gc), true);
+            _mcache_ref_cell(m_current_view(gc), false);
+        }
+        m_current_map_knowledge(gc) = env.map_knowledge(gc);
+        m_current_view(gc) = m_next_view(gc);
+    }
 
-    _mcache_ref(true);
-    m_mcache_ref_done = true;
+    if (!m_mcache_ref_done)
+    {
+        _mcache_ref(true);
+        m_mcache_ref_done = true;
+    }
 
     m_monster_locs = new_monster_locs;
 }
@@ -2108,6 +2514,29 @@ void TilesFramework::_send_messages()
   Send everything a newly joined spectator needs
  */
 void TilesFramework::_send_everything()
+{
+    // Spectators often join in bursts, or while the player is idle; then
+    // the last snapshot is still good.
+    if (!m_snapshot.empty() && m_snapshot_gen == m_output_gen)
+    {
+        unwind_bool replaying(m_capturing_snapshot, true);
+        vector<string> snapshot;
+        snapshot.swap(m_snapshot);
+        for (const string &msg : snapshot)
+        {
+            m_msg_buf = msg;
+            finish_message();
+        }
+        return;
+    }
+
+    m_snapshot.clear();
+    unwind_bool capturing(m_capturing_snapshot, true);
+    _send_everything_uncached();
+    m_snapshot_gen = m_output_gen;
+}
+
+void TilesFramework::_send_everything_uncached()
 {
     // note: a player client will receive and process some of these messages,
     // but not all. This function is currently never called except for
@@ -2213,6 +2642,12 @@ void TilesFramework::redraw()
         return;
     }
 
+    if (m_need_resync)
+    {
+        m_need_resync = false;
+        _send_everything();
+    }
+
     if (m_layout_reset)
     {
         _send_layout();
@@ -2251,6 +2686,28 @@ void TilesFramework::redraw()
     m_last_tick_redraw = get_milliseconds();
 }
 
+/**
+ * Like redraw(), for the steps of a run, rest or explore: then a frame is
+ * only sent once every tile_runrest_rate milliseconds, and the steps in
+ * between are coalesced into it. Since everything is sent as a difference
+ * from what the client already has, nothing is lost by skipping; the next
+ * input wait or more() redraws in full as usual.
+ *
+ * @return whether a frame was sent.
+ */
+bool TilesFramework::redraw_paced()
+{
+    if (you.running && !m_need_resync && !m_layout_reset
+        && get_milliseconds() - m_last_tick_redraw
+           < (unsigned int) Options.tile_runrest_rate)
+    {
+        return false;
+    }
+
+    redraw();
+    return true;
+}
+
 void TilesFramework::update_minimap(const coord_def& gc)
 {
     if (gc.x < 0 || gc.x >= GXM || gc.y < 0 || gc.y >= GYM)
@@ -2434,25 +2891,35 @@ bool TilesFramework::cell_needs_redraw(const coord_def& gc)
 
 void TilesFramework::write_message_escaped(const string& s)
 {
-    for (unsigned char c : s)
+    static const char hex[] = "0123456789abcdef";
+    const char *run = s.data();
+    const char *end = s.data() + s.size();
+
+    // Copy runs of characters that don't need escaping in one go.
+    for (const char *p = run; p < end; ++p)
     {
+        const unsigned char c = *p;
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        m_msg_buf.append(run, p - run);
+        run = p + 1;
         if (c == '"')
             m_msg_buf.append("\\\"");
         else if (c == '\\')
             m_msg_buf.append("\\\\");
-        else if (c < 0x20)
+        else
         {
-            char buf[7];
-            snprintf(buf, sizeof(buf), "\\u%04x", c);
-            m_msg_buf.append(buf);
+            const char esc[] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+            m_msg_buf.append(esc, sizeof(esc));
         }
-        else
-            m_msg_buf.push_back(c);
     }
+    m_msg_buf.append(run, end - run);
 }
 
 void TilesFramework::json_open(const string& name, char opener, char type)
 {
+    _start_message();
     m_json_stack.resize(m_json_stack.size() + 1);
     JsonFrame& fr = m_json_stack.back();
     fr.start = m_msg_buf.size();
@@ -2530,7 +2997,7 @@ void TilesFramework::json_write_comma()
     char last = m_msg_buf[m_msg_buf.size() - 1];
     if (last == '{' || last == '[' || last == ',' || last == ':')
         return;
-    write_message(",");
+    m_msg_buf.push_back(',');
 }
 
 void TilesFramework::json_write_icons(const set<tileidx_t> &icons)
@@ -2548,16 +3015,16 @@ void TilesFramework::json_write_name(const string& name)
 {
     json_write_comma();
 
-    write_message("\"");
+    m_msg_buf.push_back('"');
     write_message_escaped(name);
-    write_message("\":");
+    m_msg_buf.append("\":");
 }
 
 void TilesFramework::json_write_int(int value)
 {
     json_write_comma();
 
-    write_message("%d", value);
+    _append_int(m_msg_buf, value);
 }
 
 void TilesFramework::json_write_int(const string& name, int value)
@@ -2572,10 +3039,7 @@ void TilesFramework::json_write_bool(bool value)
 {
     json_write_comma();
 
-    if (value)
-        write_message("true");
-    else
-        write_message("false");
+    m_msg_buf.append(value ? "true" : "false");
 }
 
 void TilesFramework::json_write_bool(const string& name, bool value)
@@ -2590,7 +3054,7 @@ void TilesFramework::json_write_null()
 {
     json_write_comma();
 
-    write_message("null");
+    m_msg_buf.append("null");
 }
 
 void TilesFramework::json_write_null(const string& name)
@@ -2605,9 +3069,9 @@ void TilesFramework::json_write_string(const string& value)
 {
     json_write_comma();
 
-    write_message("\"");
+    m_msg_buf.push_back('"');
     write_message_escaped(value);
-    write_message("\"");
+    m_msg_buf.push_back('"');
 }
 
 void TilesFramework::json_write_string(const string& name, const string& value)
@@ -8,6 +8,8 @@
 #ifdef USE_TILE_WEB
 
 #include <bitset>
+#include <chrono>
+#include <deque>
 #include <map>
 #include <vector>
 
@@ -80,9 +82,18 @@ struct player_info
     coord_def position;
 
     vector<status_info> status;
+    // Signatures of what the status and inventory sections were last
+    // computed from; see _send_player().
+    uint32_t status_key;
+    uint32_t inv_key;
 
     FixedVector<item_def, ENDOFPACK> inv;
+    FixedVector<item_def, ENDOFPACK> inv_raw; // you.inv as last looked at
     FixedVector<bool, ENDOFPACK> inv_uselessness;
+    // The name and menu colour last sent for each slot, to compare against
+    // rather than naming the old item again.
+    FixedVector<string, ENDOFPACK> inv_name;
+    FixedVector<int, ENDOFPACK> inv_colour;
     FixedVector<int8_t, NUM_EQUIP> equip;
     int8_t quiver_item;
     string quiver_desc;
@@ -117,6 +128,7 @@ public:
     void set_need_redraw(unsigned int min_tick_delay = 0);
     bool need_redraw() const;
     void redraw();
+    bool redraw_paced();
 
     void place_cursor(cursor_type type, const coord_def &gc);
     void clear_text_tags(text_tag_type type);
@@ -155,7 +167,7 @@ public:
     void send_message(PRINTF(1, ));
     void flush_messages();
 
-    bool has_receivers() { return !m_dest_addrs.empty(); }
+    bool has_receivers() { return !m_receivers.empty(); }
     bool is_controlled_from_web() { return m_controlled_from_web; }
 
     /* Webtiles can receive input both via stdin, and on the
@@ -221,11 +233,62 @@ public:
     void send_milestone(const xlog_fields &xl);
     void send_options();
 
+    // Per message type tallies of what has been sent, for the wizard
+    // command; send_stats() sends them to the server (which logs them),
+    // stats_description() formats them for display.
+    void send_stats();
+    string stats_description() const;
+    void reset_stats() { m_msg_stats.clear(); }
+
 protected:
     int m_sock;
     int m_max_msg_size;
     string m_msg_buf;
-    vector<sockaddr_un> m_dest_addrs;
+
+    // Sends never block: output a receiver can't take yet waits in its
+    // queue, and is retried before anything newer is sent to it.
+    struct Receiver
+    {
+        sockaddr_un addr;
+        deque<string> queue; // whole messages, each ending in "\n"
+        size_t sent = 0;     // bytes of queue.front() already sent
+        size_t queued = 0;   // unsent bytes in the queue
+    };
+    vector<Receiver> m_receivers;
+    // Set when queued output was dropped; everything is resent on the next
+    // redraw.
+    bool m_need_resync;
+
+    // The messages of the last _send_everything, kept for the next one:
+    // if nothing else has been sent since (m_output_gen counts other
+    // messages), the client state they describe is still current and they
+    // can be resent without rebuilding them.
+    vector<string> m_snapshot;
+    unsigned int m_snapshot_gen;
+    unsigned int m_output_gen;
+    bool m_capturing_snapshot;
+
+    struct MessageStats
+    {
+        unsigned int count = 0;
+        uint64_t bytes = 0;
+        // Time from the first write into m_msg_buf to finish_message.
+        chrono::steady_clock::duration time = chrono::steady_clock::duration::zero();
+    };
+    map<string, MessageStats> m_msg_stats;
+    chrono::steady_clock::time_point m_msg_started;
+    void _start_message()
+    {
+        if (m_msg_buf.empty())
+            m_msg_started = chrono::steady_clock::now();
+    }
+    void _count_message();
+
+    int _send_data(Receiver &r, const char *data, int len);
+    bool _send_queued(Receiver &r);
+    void _trim_queue(Receiver &r);
+    void _send_queued_output();
+    bool _output_queued() const;
 
     bool m_controlled_from_web;
     bool m_need_flush;
@@ -291,6 +354,12 @@ protected:
     FixedArray<map_cell, GXM, GYM> m_current_map_knowledge;
     map<uint32_t, coord_def> m_monster_locs;
     bool m_need_full_map;
+    // Send map cells as packed arrays (see _send_cell) instead of objects;
+    // set by the client with a map_encoding message.
+    bool m_packed_map;
+    // Doll and mcache definitions already sent with the packed encoding,
+    // so repeats can be sent as an id; reset with every full map.
+    map<string, int> m_composite_ids;
 
     coord_def m_cursor[CURSOR_MAX];
     coord_def m_last_clicked_grid;
@@ -315,24 +384,26 @@ protected:
     void _send_layout();
 
     void _send_everything();
+    void _send_everything_uncached();
 
     bool m_mcache_ref_done;
     void _mcache_ref(bool inc);
 
     void _send_cursor(cursor_type type);
     void _send_map(bool force_full = false);
-    void _send_cell(const coord_def &gc,
+    bool _send_cell(const coord_def &gc, bool send_pos,
                     const screen_cell_t &current_sc, const screen_cell_t &next_sc,
                     const map_cell &current_mc, const map_cell &next_mc,
                     map<uint32_t, coord_def>& new_monster_locs,
                     bool force_full);
+    void _dedup_composite(size_t start);
     void _send_monster(const coord_def &gc, const monster_info* m,
                        map<uint32_t, coord_def>& new_monster_locs,
                        bool force_full);
     void _send_player(bool force_full = false);
     void _send_item(item_def& current, const item_def& next,
-                    bool& current_uselessness,
-                    bool force_full);
+                    bool& current_uselessness, string& current_name,
+                    int& current_colour, bool force_full);
     void _send_messages();
 };
 
@@ -52,6 +52,7 @@
 #include "tileview.h"
 #include "throw.h"
 #include "travel.h"
+#include "turn-times.h"
 #include "viewchar.h"
 #include "unwind.h"
 
@@ -681,6 +682,7 @@ void monster::timeout_enchantments(int levels)
 void update_level(int elapsedTime)
 {
     ASSERT(!crawl_state.game_is_arena());
+    TURN_PHASE(TP_LEVEL_CATCHUP);
 
     const int turns = elapsedTime / 10;
 
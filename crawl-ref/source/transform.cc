@@ -2143,6 +2143,7 @@ void unset_default_form()
 
     you.default_form = transformation::none;
     you.active_talisman.clear();
+    you.invalidate_artefact_cache();
 }
 
 void set_default_form(transformation t, const item_def *source)
@@ -2154,11 +2155,15 @@ void set_default_form(transformation t, const item_def *source)
     if (source)
     {
         you.active_talisman = *source; // iffy
+        you.invalidate_artefact_cache();
         if (is_artefact(you.active_talisman))
             equip_artefact_effect(you.active_talisman, nullptr, false, EQ_NONE);
     }
     else
+    {
         you.active_talisman.clear();
+        you.invalidate_artefact_cache();
+    }
 }
 
 void vampire_update_transformations()
@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <array>
 #include <cctype>
+#include <chrono>
 #include <cstdarg>
 #include <cstdio>
 #include <memory>
@@ -35,12 +36,14 @@
 #include "format.h"
 #include "god-abil.h"
 #include "god-passive.h"
+#include "hash.h"
 #include "hints.h"
 #include "item-name.h"
 #include "item-prop.h"
 #include "item-status-flag-type.h"
 #include "items.h"
 #include "libutil.h"
+#include "losglobal.h"
 #include "macro.h"
 #include "mapmark.h"
 #include "menu.h"
@@ -59,6 +62,7 @@
 #include "tiles-build-specific.h"
 #include "traps.h"
 #include "travel-open-doors-type.h"
+#include "turn-times.h"
 #include "ui.h"
 #include "unicode.h"
 #include "unwind.h"
@@ -127,6 +131,59 @@ static string trans_travel_dest;
 // hostile terrain.
 travel_distance_grid_t travel_point_distance;
 
+travel_stats travel_counters;
+
+// los_cache_misses() as of the last travel() step, if travel has been
+// going since.
+static unsigned int travel_los_mark = 0;
+static bool travel_los_marked = false;
+
+string travel_stats_description()
+{
+    const travel_stats &t = travel_counters;
+    if (!t.steps)
+        return "No travel or explore steps taken.\n";
+
+    const double steps = t.steps;
+    return make_stringf(
+        "Travel steps: %u (%u from the last flood), %.3f ms/step\n"
+        "Floods: %u; per step: %.1f squares flooded, %.1f examined, "
+        "%.1f safety checks\n"
+        "Cell LOS updates: %.1f/step\n",
+        t.steps, t.cached_moves, t.step_ms / steps,
+        t.floods, t.flooded / steps, t.examined / steps,
+        t.safety_checks / steps, t.los_updates / steps);
+}
+
+// Times a travel() call for travel_counters; stop() it before
+// deliberately waiting.
+class travel_step_timer
+{
+public:
+    travel_step_timer() : start(chrono::steady_clock::now()), running(true)
+    {
+    }
+
+    ~travel_step_timer()
+    {
+        stop();
+    }
+
+    void stop()
+    {
+        if (!running)
+            return;
+        running = false;
+        travel_counters.step_ms += chrono::duration<double, milli>(
+                                       chrono::steady_clock::now() - start)
+                                   .count();
+    }
+
+private:
+    chrono::steady_clock::time_point start;
+    bool running;
+};
+
 // Apply slime wall checks when checking if squares are travelsafe.
 static bool g_Slime_Wall_Check = true;
 
@@ -406,49 +463,47 @@ static bool _is_reseedable(const coord_def& c, bool ignore_danger = false)
            || !_is_safe_cloud(c);
 }
 
-struct cell_travel_safety
+// Memoised is_travelsafe_square() results for the current level, one bit per
+// combination of its flags. Safety depends on map knowledge (of the square
+// and, for slime walls, its neighbours), exclusions, the player's LOS and
+// what they can fly over or withstand, so the grid is only trusted for the
+// turn it was filled in, and invalidate_travel_terrain() throws it away
+// early when any of those change without time passing.
+struct travel_terrain_cache
 {
-    bool safe;
-    bool safe_if_ignoring_hostile_terrain;
-
-    cell_travel_safety() : safe(false), safe_if_ignoring_hostile_terrain(false)
-    {
-    }
+    level_id level;
+    int elapsed_time = -1;
+    unsigned int generation = 0;
+    FixedArray<uint16_t, GXM, GYM> computed;
+    FixedArray<uint16_t, GXM, GYM> safe;
 };
 
-typedef FixedArray<cell_travel_safety, GXM, GYM> travel_safe_grid;
-static unique_ptr<travel_safe_grid> _travel_safe_grid;
+static unique_ptr<travel_terrain_cache> _travel_terrain;
+static unsigned int travel_terrain_generation = 1;
 
-class precompute_travel_safety_grid
+void invalidate_travel_terrain()
 {
-private:
-    bool did_compute;
+    travel_terrain_generation++;
+}
 
-public:
-    precompute_travel_safety_grid() : did_compute(false)
-    {
-        if (!_travel_safe_grid)
-        {
-            did_compute = true;
-            auto tsgrid = make_unique<travel_safe_grid>();
-            travel_safe_grid &safegrid(*tsgrid);
-            for (rectangle_iterator ri(1); ri; ++ri)
-            {
-                const coord_def p(*ri);
-                cell_travel_safety &ts(safegrid(p));
-                ts.safe = is_travelsafe_square(p, false);
-                ts.safe_if_ignoring_hostile_terrain =
-                    is_travelsafe_square(p, true);
-            }
-            _travel_safe_grid = std::move(tsgrid);
-        }
-    }
-    ~precompute_travel_safety_grid()
+static travel_terrain_cache &_current_travel_terrain()
+{
+    if (!_travel_terrain)
+        _travel_terrain = make_unique<travel_terrain_cache>();
+
+    travel_terrain_cache &cache(*_travel_terrain);
+    const level_id here = level_id::current();
+    if (cache.generation != travel_terrain_generation
+        || cache.elapsed_time != you.elapsed_time
+        || cache.level != here)
     {
-        if (did_compute)
-            _travel_safe_grid.reset(nullptr);
+        cache.level = here;
+        cache.elapsed_time = you.elapsed_time;
+        cache.generation = travel_terrain_generation;
+        cache.computed.init(0);
     }
-};
+    return cache;
+}
 
 bool is_stair_exclusion(const coord_def &p)
 {
@@ -459,6 +514,9 @@ bool is_stair_exclusion(const coord_def &p)
     return get_exclusion_radius(p) == 1;
 }
 
+static bool _is_travelsafe_square(const coord_def& c, bool ignore_hostile,
+                                  bool ignore_danger, bool try_fallback);
+
 // Returns true if the square at (x,y) is okay to travel over. If ignore_hostile
 // is true, returns true even for dungeon features the character can normally
 // not cross safely (deep water, lava, traps).
@@ -468,13 +526,36 @@ bool is_travelsafe_square(const coord_def& c, bool ignore_hostile,
     if (!in_bounds(c))
         return false;
 
-    if (_travel_safe_grid)
+    // RMODE_CONNECTIVITY answers for a generic player, not this one.
+    if (ignore_player_traversability)
     {
-        const cell_travel_safety &cell((*_travel_safe_grid)(c));
-        return ignore_hostile? cell.safe_if_ignoring_hostile_terrain
-               : cell.safe;
+        return _is_travelsafe_square(c, ignore_hostile, ignore_danger,
+                                     try_fallback);
     }
 
+    const uint16_t flag = 1 << (ignore_hostile | ignore_danger << 1
+                                | try_fallback << 2
+                                | g_Slime_Wall_Check << 3);
+    travel_terrain_cache &cache = _current_travel_terrain();
+    if (!(cache.computed(c) & flag))
+    {
+        cache.computed(c) |= flag;
+        if (_is_travelsafe_square(c, ignore_hostile, ignore_danger,
+                                  try_fallback))
+        {
+            cache.safe(c) |= flag;
+        }
+        else
+            cache.safe(c) &= ~flag;
+    }
+    return cache.safe(c) & flag;
+}
+
+static bool _is_travelsafe_square(const coord_def& c, bool ignore_hostile,
+                                  bool ignore_danger, bool try_fallback)
+{
+    travel_counters.safety_checks++;
+
     if (!env.map_knowledge(c).known())
         return false;
 
@@ -568,6 +649,7 @@ static bool _is_safe_move(const coord_def& c)
 
 void travel_init_load_level()
 {
+    invalidate_travel_terrain();
     curr_excludes.clear();
     travel_cache.set_level_excludes();
     travel_cache.update_waypoints();
@@ -655,6 +737,9 @@ static int _slowest_ally_speed()
 
 static void _start_running()
 {
+    // Options and the map may have been changed by commands that took no
+    // time.
+    invalidate_travel_terrain();
     _userdef_run_startrunning_hook();
     you.running.init_travel_speed();
     you.running.turns_passed = 0;
@@ -670,6 +755,7 @@ static void _start_running()
 void stop_running(bool clear_delays)
 {
     you.running.stop(clear_delays);
+    travel_los_marked = false;
 }
 
 static bool _is_valid_explore_target(const coord_def& where)
@@ -909,6 +995,108 @@ void explore_pickup_event(int did_pickup, int tried_pickup)
     }
 }
 
+// The last travel flood, kept so that travel and explore don't have to
+// redo it on every step. A flood from the same destination over the same
+// squares expands them in the same order, just stopping sooner as we get
+// closer; so while nothing it looked at has changed, our next move is the
+// first square it expanded next to us.
+struct travel_flood_cache
+{
+    bool valid = false;
+    level_id level;
+    coord_def dest;
+    travel_distance_grid_t order;
+    // Every square the flood looked at, with what it made of it.
+    vector<pair<coord_def, uint8_t>> inputs;
+};
+static travel_flood_cache travel_flood;
+
+// What the travel flood needs to know about a square; see path_flood() and
+// square_slows_movement().
+static uint8_t _travel_flood_input(const coord_def &c)
+{
+    return is_travelsafe_square(c)
+           | _feature_traverse_cost(env.map_knowledge(c).feat()) << 1;
+}
+
+static void _save_travel_flood(const coord_def &dest)
+{
+    travel_flood.valid = false;
+    travel_flood.inputs.clear();
+
+    unwind_bool slime_wall_check(g_Slime_Wall_Check,
+                                 !actor_slime_wall_immune(&you));
+    unwind_slime_wall_precomputer slime_neighbours(g_Slime_Wall_Check);
+
+    for (rectangle_iterator ri(1); ri; ++ri)
+    {
+        bool looked = false;
+        for (adjacent_iterator ai(*ri, false); ai; ++ai)
+            if (in_bounds(*ai) && travel_flood.order[ai->x][ai->y])
+            {
+                looked = true;
+                break;
+            }
+        if (!looked)
+            continue;
+
+        // Floods through transporters don't go square by square.
+        if (env.grid(*ri) == DNGN_TRANSPORTER_LANDING)
+            return;
+
+        travel_flood.inputs.emplace_back(*ri, _travel_flood_input(*ri));
+    }
+
+    travel_flood.valid = true;
+    travel_flood.level = level_id::current();
+    travel_flood.dest = dest;
+}
+
+// The move pathfind(RMODE_TRAVEL) would find towards you.running.pos, if
+// the last flood can tell us; otherwise (0,0).
+static coord_def _cached_travel_move(const coord_def &youpos)
+{
+    const coord_def dest = you.running.pos;
+    if (!travel_flood.valid
+        || travel_flood.dest != dest
+        || travel_flood.level != level_id::current()
+        || youpos == dest)
+    {
+        return coord_def();
+    }
+
+    unwind_bool slime_wall_check(g_Slime_Wall_Check,
+                                 !actor_slime_wall_immune(&you));
+    unwind_slime_wall_precomputer slime_neighbours(g_Slime_Wall_Check);
+
+    if (!is_travelsafe_square(dest, false, false, true) && !is_trap(dest))
+        return coord_def();
+
+    for (const auto &input : travel_flood.inputs)
+        if (_travel_flood_input(input.first) != input.second)
+        {
+            travel_flood.valid = false;
+            return coord_def();
+        }
+
+    coord_def move;
+    int first = 0;
+    for (adjacent_iterator ai(youpos); ai; ++ai)
+    {
+        const int order = travel_flood.order[ai->x][ai->y];
+        if (order && (!first || order < first))
+        {
+            move = *ai;
+            first = order;
+        }
+    }
+
+    // A move the flood would refuse has to go through the fallback.
+    if (first && !_is_safe_move(move))
+        return coord_def();
+    return move;
+}
+
 /**
  * Run the travel_pathfind algorithm with a destination with the aim of
  * determining the next travel move. Try to avoid to let travel (including
@@ -927,13 +1115,25 @@ void explore_pickup_event(int did_pickup, int tried_pickup)
  */
 static void _find_travel_pos(const coord_def& youpos, int *move_x, int *move_y)
 {
-    travel_pathfind tp;
+    coord_def dest = _cached_travel_move(youpos);
+    if (!dest.origin())
+        travel_counters.cached_moves++;
+    else
+    {
+        travel_pathfind tp;
 
-    tp.set_src_dst(youpos, you.running.pos);
+        tp.set_src_dst(youpos, you.running.pos);
+        tp.set_expansion_order(travel_flood.order);
 
-    coord_def dest = tp.pathfind(RMODE_TRAVEL, false);
-    if (dest.origin())
-        dest = tp.pathfind(RMODE_TRAVEL, true);
+        dest = tp.pathfind(RMODE_TRAVEL, false);
+        if (dest.origin())
+        {
+            travel_flood.valid = false;
+            dest = tp.pathfind(RMODE_TRAVEL, true);
+        }
+        else
+            _save_travel_flood(you.running.pos);
+    }
     coord_def new_dest = dest;
 
     // We'd either have to travel through a runed door, in which case we'll be
@@ -1061,6 +1261,13 @@ command_type travel()
 
     command_type result = CMD_NO_CMD;
 
+    travel_step_timer timer;
+    travel_counters.steps++;
+    if (travel_los_marked)
+        travel_counters.los_updates += los_cache_misses() - travel_los_mark;
+    travel_los_mark = los_cache_misses();
+    travel_los_marked = true;
+
     if (Options.travel_key_stop && kbhit())
     {
         mprf("Key pressed, stopping %s.", you.running.runmode_name().c_str());
@@ -1195,9 +1402,15 @@ command_type travel()
 
         }
         else if (you.running.is_explore() && Options.explore_delay > -1)
+        {
+            timer.stop();
             delay(Options.explore_delay);
+        }
         else if (Options.travel_delay > 0)
+        {
+            timer.stop();
             delay(Options.travel_delay);
+        }
     }
 
     if (!you.running)
@@ -1247,6 +1460,11 @@ static void _fill_exclude_radius(const travel_exclude &exc)
 
 FixedVector<coord_def, GXM * GYM> travel_pathfind::circumference[2];
 
+size_t travel_pathfind::table_bytes()
+{
+    return sizeof(circumference) + sizeof(travel_point_distance);
+}
+
 // already defined in header
 // const int travel_pathfind::UNFOUND_DIST;
 // const int travel_pathfind::INFINITE_DIST;
@@ -1258,7 +1476,8 @@ travel_pathfind::travel_pathfind()
       need_for_greed(false), autopickup(false),
       unexplored_place(), greedy_place(), unexplored_dist(0), greedy_dist(0),
       refdist(nullptr), reseed_points(), features(nullptr), unreachables(),
-      point_distance(travel_point_distance), next_iter_points(0),
+      point_distance(travel_point_distance), expansion_order(nullptr),
+      expansions(0), next_iter_points(0),
       traveled_distance(0), circ_index(0)
 {
 }
@@ -1297,6 +1516,11 @@ void travel_pathfind::set_floodseed(const coord_def &seed, bool dblflood)
     double_flood = dblflood;
 }
 
+void travel_pathfind::set_expansion_order(travel_distance_grid_t &order)
+{
+    expansion_order = order;
+}
+
 void travel_pathfind::set_feature_vector(vector<coord_def> *feats)
 {
     features = feats;
@@ -1327,6 +1551,7 @@ const coord_def travel_pathfind::explore_target() const
 // Allison - used with his permission.
 coord_def travel_pathfind::pathfind(run_mode_type rmode, bool fallback_explore)
 {
+    TURN_PHASE(TP_TRAVEL_PATHFIND);
     unwind_bool saved_ipt(ignore_player_traversability);
 
     if (rmode == RMODE_INTERLEVEL)
@@ -1336,6 +1561,8 @@ coord_def travel_pathfind::pathfind(run_mode_type rmode, bool fallback_explore)
 
     try_fallback = fallback_explore;
 
+    travel_counters.floods++;
+
     if (runmode == RMODE_CONNECTIVITY)
         ignore_player_traversability = true;
     else
@@ -1382,6 +1609,9 @@ coord_def travel_pathfind::pathfind(run_mode_type rmode, bool fallback_explore)
     // point_distance will hold the distance of all points from the starting
     // point, i.e. the distance travelled to get there.
     memset(point_distance, 0, sizeof(travel_distance_grid_t));
+    if (expansion_order)
+        memset(expansion_order, 0, sizeof(travel_distance_grid_t));
+    expansions = 0;
 
     if (!in_bounds(start))
         return coord_def();
@@ -1768,6 +1998,7 @@ bool travel_pathfind::path_flood(const coord_def &c, const coord_def &dc)
         // iteration
         circumference[!circ_index][next_iter_points++] = dc;
         point_distance[dc.x][dc.y] = traveled_distance;
+        travel_counters.flooded++;
 
         // Negative distances here so that show_map can colour
         // the map differently for these squares.
@@ -1815,6 +2046,7 @@ void travel_pathfind::good_square(const coord_def &c)
         // This point is going to be on the agenda for the next iteration.
         circumference[!circ_index][next_iter_points++] = c;
         point_distance[c.x][c.y] = traveled_distance;
+        travel_counters.flooded++;
     }
 }
 
@@ -1836,6 +2068,8 @@ bool travel_pathfind::point_traverse_delay(const coord_def &c)
 // to be the target; otherwise, false.
 bool travel_pathfind::path_examine_point(const coord_def &c)
 {
+    travel_counters.examined++;
+
     // If we've run off the map, or are pathfinding from nowhere in particular
     if (!in_bounds(c))
         return false;
@@ -1843,6 +2077,9 @@ bool travel_pathfind::path_examine_point(const coord_def &c)
     if (point_traverse_delay(c))
         return false;
 
+    if (expansion_order && !expansion_order[c.x][c.y])
+        expansion_order[c.x][c.y] = ++expansions;
+
     bool found_target = false;
 
     // For each point, we look at all surrounding points. Take them orthogonals
@@ -3184,9 +3421,17 @@ static int _find_transtravel_stair(const level_id &cur,
 
 static bool _loadlev_populate_stair_distances(const level_pos &target)
 {
-    level_excursion excursion;
-    excursion.go_to(target.id);
-    _populate_stair_distances(target);
+    LevelInfo &li = travel_cache.get_level_info(target.id);
+    if (li.get_target_stairs(target.pos, curr_stairs))
+        return true;
+
+    {
+        level_excursion excursion;
+        excursion.go_to(target.id);
+        _populate_stair_distances(target);
+    }
+    // Leaving the level again updated its LevelInfo.
+    li.set_target_stairs(target.pos, curr_stairs);
     return true;
 }
 
@@ -3334,6 +3579,8 @@ void start_travel(const coord_def& p)
     if (!in_bounds(p))
         return;
 
+    invalidate_travel_terrain();
+
     if (!is_travelsafe_square(p, true))
         return;
 
@@ -3602,6 +3849,11 @@ void LevelInfo::update()
     vector<coord_def> stair_positions;
     get_stairs(stair_positions);
 
+    // correct_stair_list() starts the distances afresh; keep the old ones
+    // in case nothing they were worked out from has changed.
+    vector<short> old_distances;
+    old_distances.swap(stair_distances);
+
     // Make sure our stair list is correct.
     correct_stair_list(stair_positions);
 
@@ -3611,8 +3863,7 @@ void LevelInfo::update()
     // neighbours of slimy walls now.
     unwind_slime_wall_precomputer slime_wall_neighbours(
         !actor_slime_wall_immune(&you));
-    precompute_travel_safety_grid travel_safety_calc;
-    update_stair_distances();
+    update_stair_distances(old_distances);
 
     vector<coord_def> transporter_positions;
     get_transporters(transporter_positions);
@@ -3631,8 +3882,72 @@ void LevelInfo::set_distance_between_stairs(int a, int b, int dist)
     stair_distances[b * stairs.size() + a] = dist;
 }
 
-void LevelInfo::update_stair_distances()
+// The player's abilities that decide where travel can go, for telling
+// whether distances worked out on another level still hold.
+static uint32_t _traveller_signature()
+{
+    const uint32_t abilities = you.permanent_flight()
+                               | player_likes_water(true) << 1
+                               | have_passive(passive_t::water_walk) << 2
+                               | actor_slime_wall_immune(&you) << 3
+                               | you.cloud_immune() << 4;
+    return hash32(&Options.travel_avoid_terrain[0], NUM_FEATURES) ^ abilities;
+}
+
+// A hash of everything fill_travel_point_distance() looks at on the current
+// level, with the stairs and transporters it has to find distances between;
+// see path_flood() and path_examine_point().
+static uint32_t _stair_flood_hash(const vector<stair_info> &stairs,
+                                  const vector<transporter_info> &transporters)
+{
+    unwind_bool slime_wall_check(g_Slime_Wall_Check,
+                                 !actor_slime_wall_immune(&you));
+
+    vector<uint16_t> inputs;
+    inputs.reserve(GXM * GYM + 2 * stairs.size() + 4 * transporters.size());
+    for (rectangle_iterator ri(1); ri; ++ri)
+    {
+        const coord_def c = *ri;
+        const dungeon_feature_type grid = env.grid(c);
+        inputs.push_back(is_travelsafe_square(c, false, false, true)
+                         | is_travelsafe_square(c, true, false, true) << 1
+                         | _is_reseedable(c) << 2
+                         | is_excluded(c) << 3
+                         | is_exclude_root(c) << 4
+                         | _is_safe_cloud(c) << 5
+                         | is_trap(c) << 6
+                         | (grid == DNGN_TRANSPORTER) << 7
+                         | (grid == DNGN_TRANSPORTER_LANDING) << 8
+                         | _feature_traverse_cost(env.map_knowledge(c).feat())
+                           << 9);
+    }
+    for (const stair_info &si : stairs)
+    {
+        inputs.push_back(si.position.x);
+        inputs.push_back(si.position.y);
+    }
+    for (const transporter_info &ti : transporters)
+    {
+        inputs.push_back(ti.position.x);
+        inputs.push_back(ti.position.y);
+        inputs.push_back(ti.destination.x);
+        inputs.push_back(ti.destination.y);
+    }
+    return hash32(inputs.data(), inputs.size() * sizeof(uint16_t));
+}
+
+// Works out the distances between all our stairs, unless nothing that
+// went into the distances in previous has changed since they were found.
+void LevelInfo::update_stair_distances(vector<short> &previous)
 {
+    const uint32_t hash = _stair_flood_hash(stairs, transporters);
+    if (hash == flood_hash && previous.size() == stair_distances.size())
+    {
+        stair_distances.swap(previous);
+        return;
+    }
+    flood_hash = hash;
+
     const int nstairs = stairs.size();
     // Now we update distances for all the stairs, relative to all other
     // stairs.
@@ -3983,6 +4298,29 @@ void LevelInfo::get_stairs(vector<coord_def> &st)
     }
 }
 
+bool LevelInfo::get_target_stairs(const coord_def &pos,
+                                  vector<stair_info> &dists) const
+{
+    if (target_stairs.empty() || pos != target_pos || !flood_hash
+        || target_hash != flood_hash
+        || target_traveller != _traveller_signature())
+    {
+        return false;
+    }
+
+    dists = target_stairs;
+    return true;
+}
+
+void LevelInfo::set_target_stairs(const coord_def &pos,
+                                  const vector<stair_info> &dists)
+{
+    target_pos = pos;
+    target_hash = flood_hash;
+    target_traveller = _traveller_signature();
+    target_stairs = dists;
+}
+
 void LevelInfo::clear_distances()
 {
     for (stair_info &stair : stairs)
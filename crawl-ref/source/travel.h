@@ -57,6 +57,7 @@ enum run_mode_type
 void stop_running(bool clear_delays = true);
 void travel_init_load_level();
 void travel_init_new_level();
+void invalidate_travel_terrain();
 
 uint8_t is_waypoint(const coord_def &p);
 command_type direction_to_command(int x, int y);
@@ -154,6 +155,22 @@ const int PD_CLOUD = -20101;
  * *********************************************************************** */
 extern travel_distance_grid_t travel_point_distance;
 
+// Counters for profiling travel and explore, over this session.
+struct travel_stats
+{
+    unsigned int steps = 0;         // calls to travel()
+    unsigned int cached_moves = 0;  // steps that reused the last flood
+    unsigned int floods = 0;        // travel_pathfind::pathfind() runs
+    unsigned int flooded = 0;       // squares added to a flood
+    unsigned int examined = 0;      // path_examine_point() calls
+    unsigned int safety_checks = 0; // squares checked for travel safety
+    unsigned int los_updates = 0;   // cell LOS recomputed during travel
+    double step_ms = 0;             // time in travel(), less any delays
+};
+extern travel_stats travel_counters;
+
+string travel_stats_description();
+
 enum explore_stop_type
 {
     ES_NONE                      = 0x00000,
@@ -383,6 +400,14 @@ struct LevelInfo
     // current level.
     bool is_known_branch(uint8_t branch) const;
 
+    // Stairs with their distances from pos, as last worked out for an
+    // interlevel travel target here, if neither the level nor the player's
+    // travel abilities have changed since.
+    bool get_target_stairs(const coord_def &pos,
+                           vector<stair_info> &dists) const;
+    void set_target_stairs(const coord_def &pos,
+                           const vector<stair_info> &dists);
+
     FixedVector<int, NUM_DACTION_COUNTERS> daction_counters;
 
 private:
@@ -393,7 +418,7 @@ private:
 
     void correct_stair_list(const vector<coord_def> &s);
     void correct_transporter_list(const vector<coord_def> &s);
-    void update_stair_distances();
+    void update_stair_distances(vector<short> &previous);
     void sync_all_branch_stairs();
     void sync_branch_stairs(const stair_info *si);
     void set_distance_between_stairs(int a, int b, int dist);
@@ -409,6 +434,16 @@ private:
     vector<short> stair_distances;  // Dist between stairs
     level_id id;
 
+    // What the level looked like to travel when stair_distances were worked
+    // out; not saved, so the first update() after loading recomputes them.
+    uint32_t flood_hash = 0;
+
+    // Saved by set_target_stairs().
+    coord_def target_pos;
+    uint32_t target_hash = 0;
+    uint32_t target_traveller = 0;
+    vector<stair_info> target_stairs;
+
     friend class TravelCache;
 
 private:
@@ -521,6 +556,13 @@ public:
     // Extract features without pathfinding
     void get_features();
 
+    // The memory held by the tables all pathfinders share.
+    static size_t table_bytes();
+
+    // If set, pathfind() numbers squares from 1 in the order it looks at
+    // their neighbours, leaving 0 for squares it never got to.
+    void set_expansion_order(travel_distance_grid_t &order);
+
     // The next square to go to to move towards the travel destination. Return
     // value is undefined if pathfind was not called with RMODE_TRAVEL.
     const coord_def travel_move() const;
@@ -606,6 +648,9 @@ protected:
 
     travel_distance_col *point_distance;
 
+    travel_distance_col *expansion_order;
+    int expansions;
+
     // How many points we'll consider next iteration.
     int next_iter_points;
 
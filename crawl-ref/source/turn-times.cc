@@ -0,0 +1,355 @@
+/**
+ * @file
+ * @brief Timing the phases of the turn loop, for -print-turn-times, the
+ *        wizard mode turn times command and Chrome trace files. Builds
+ *        with TRACK_ALLOCATIONS count heap allocations in each phase too.
+**/
+
+#include "AppHdr.h"
+
+#include "turn-times.h"
+
+#ifdef TRACK_ALLOCATIONS
+# include <atomic>
+# include <cstdlib>
+# include <new>
+#endif
+#include <vector>
+
+#include "message.h"
+#include "player.h"
+#include "state.h"
+#include "stringutil.h"
+#include "syscalls.h"
+#include "tasks.h"
+
+turn_phase_stats turn_phases[NUM_TURN_PHASES];
+bool turn_times_active = false;
+
+static bool _in_phase[NUM_TURN_PHASES];
+
+static const char *_phase_names[NUM_TURN_PHASES] =
+{
+    "world_reacts", "handle_monsters", "handle_monster_move", "viewwindow",
+    "LOS", "bolt::fire", "travel pathfind", "send_map", "save",
+    "update_level",
+};
+
+// Short names, for the overlay.
+static const char *_phase_abbrevs[NUM_TURN_PHASES] =
+{
+    "turn", "mons", "move", "view", "los", "beam", "path", "map", "save",
+    "lvl",
+};
+
+// The time spent in each phase in the turn so far, and in the last
+// TURN_HISTORY turns.
+#define TURN_HISTORY 100
+static double _this_turn[NUM_TURN_PHASES];
+static double _history[TURN_HISTORY][NUM_TURN_PHASES];
+static int _history_turns = 0;
+
+static bool _overlay = false;
+
+struct trace_event
+{
+    turn_phase_type phase;
+    double start_us;
+    double dur_us;
+};
+
+// Enough for a few thousand turns; anything past it is dropped.
+#define MAX_TRACE_EVENTS (1 << 20)
+static bool _tracing = false;
+static string _trace_file;
+static vector<trace_event> _trace;
+static std::chrono::steady_clock::time_point _trace_start;
+
+#ifdef TRACK_ALLOCATIONS
+// Replacing the global operator new costs a test of turn_times_active on
+// every allocation, which is why only debug builds do it. The counts are
+// atomic because tiles and webtiles builds have other threads allocating.
+static std::atomic<int> _current_phase(TP_NONE);
+static std::atomic<unsigned int> _allocs[NUM_TURN_PHASES + 1];
+static std::atomic<uint64_t> _alloc_bytes[NUM_TURN_PHASES + 1];
+static std::atomic<unsigned int> _turn_allocs(0);
+static unsigned int _last_turn_allocs = 0;
+
+// Sizes up to 16, 64, 256, 1k and 4k bytes, then everything larger.
+#define ALLOC_SIZE_BUCKETS 6
+static std::atomic<unsigned int> _alloc_sizes[ALLOC_SIZE_BUCKETS];
+
+static void _count_alloc(size_t size)
+{
+    const int phase = _current_phase.load(std::memory_order_relaxed);
+    _allocs[phase].fetch_add(1, std::memory_order_relaxed);
+    _alloc_bytes[phase].fetch_add(size, std::memory_order_relaxed);
+    _turn_allocs.fetch_add(1, std::memory_order_relaxed);
+
+    int bucket = 0;
+    for (size_t limit = 16; bucket < ALLOC_SIZE_BUCKETS - 1 && size > limit;
+         limit *= 4)
+    {
+        bucket++;
+    }
+    _alloc_sizes[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void *operator new(size_t size)
+{
+    if (turn_times_active)
+        _count_alloc(size);
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    if (turn_times_active)
+        _count_alloc(size);
+    return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+    free(p);
+}
+
+# ifdef __cpp_sized_deallocation
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
+# endif
+#endif
+
+void turn_times_update_active()
+{
+    turn_times_active = crawl_state.print_turn_times || _overlay || _tracing;
+}
+
+void turn_phase_timer::begin()
+{
+    if (_in_phase[phase])
+    {
+        running = false;
+        return;
+    }
+    _in_phase[phase] = true;
+#ifdef TRACK_ALLOCATIONS
+    outer = _current_phase.exchange(phase, std::memory_order_relaxed);
+#endif
+    start = std::chrono::steady_clock::now();
+}
+
+static void _end_turn()
+{
+    memcpy(_history[_history_turns % TURN_HISTORY], _this_turn,
+           sizeof(_this_turn));
+    _history_turns++;
+
+#ifdef TRACK_ALLOCATIONS
+    _last_turn_allocs = _turn_allocs.exchange(0, std::memory_order_relaxed);
+#endif
+
+    if (_overlay)
+    {
+        string line;
+        for (int i = 0; i < NUM_TURN_PHASES; ++i)
+        {
+            if (_this_turn[i] > 0)
+            {
+                line += make_stringf("%s%s %.2f", line.empty() ? "" : " ",
+                                     _phase_abbrevs[i], _this_turn[i]);
+            }
+        }
+#ifdef TRACK_ALLOCATIONS
+        line += make_stringf(" allocs %u", _last_turn_allocs);
+#endif
+        const string tasks = tasks_overlay_summary();
+        if (!tasks.empty())
+            line += " " + tasks;
+        mprf(MSGCH_DIAGNOSTICS, "ms: %s", line.c_str());
+    }
+    memset(_this_turn, 0, sizeof(_this_turn));
+}
+
+void turn_phase_timer::end()
+{
+    const auto now = std::chrono::steady_clock::now();
+    const double ms =
+        std::chrono::duration<double, std::milli>(now - start).count();
+    _in_phase[phase] = false;
+#ifdef TRACK_ALLOCATIONS
+    _current_phase.store(outer, std::memory_order_relaxed);
+#endif
+    turn_phases[phase].calls++;
+    turn_phases[phase].ms += ms;
+    _this_turn[phase] += ms;
+
+    if (_tracing && _trace.size() < MAX_TRACE_EVENTS)
+    {
+        const double start_us = std::chrono::duration<double, std::micro>(
+                                    start - _trace_start).count();
+        _trace.push_back({phase, start_us, ms * 1000});
+    }
+
+    if (phase == TP_WORLD_REACTS)
+        _end_turn();
+}
+
+void turn_times_reset()
+{
+    for (turn_phase_stats &p : turn_phases)
+        p = turn_phase_stats();
+    memset(_this_turn, 0, sizeof(_this_turn));
+    _history_turns = 0;
+#ifdef TRACK_ALLOCATIONS
+    for (int i = 0; i <= NUM_TURN_PHASES; ++i)
+    {
+        _allocs[i] = 0;
+        _alloc_bytes[i] = 0;
+    }
+    for (auto &count : _alloc_sizes)
+        count = 0;
+    _turn_allocs = 0;
+    _last_turn_allocs = 0;
+#endif
+}
+
+void turn_times_set_overlay(bool on)
+{
+    _overlay = on;
+    turn_times_update_active();
+}
+
+bool turn_times_overlay()
+{
+    return _overlay;
+}
+
+void turn_times_start_trace(const string &file)
+{
+    _trace_file = file;
+    _trace.clear();
+    _trace_start = std::chrono::steady_clock::now();
+    _tracing = true;
+    turn_times_update_active();
+}
+
+bool turn_times_tracing()
+{
+    return _tracing;
+}
+
+/**
+ * Stop tracing and write the events out, in the Chrome trace event format.
+ *
+ * @returns Whether the file could be written.
+ */
+bool turn_times_stop_trace()
+{
+    if (!_tracing)
+        return false;
+    _tracing = false;
+    turn_times_update_active();
+
+    FILE *f = fopen_u(_trace_file.c_str(), "w");
+    if (!f)
+    {
+        _trace.clear();
+        return false;
+    }
+    fprintf(f, "{\"traceEvents\":[\n");
+    for (size_t i = 0; i < _trace.size(); ++i)
+    {
+        const trace_event &ev = _trace[i];
+        fprintf(f, "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                   "\"pid\":1,\"tid\":1}%s\n",
+                _phase_names[ev.phase], ev.start_us, ev.dur_us,
+                i + 1 < _trace.size() ? "," : "");
+    }
+    fprintf(f, "],\"displayTimeUnit\":\"ms\"}\n");
+    _trace.clear();
+    return fclose(f) == 0;
+}
+
+string turn_times_description()
+{
+    const unsigned int turns = turn_phases[TP_WORLD_REACTS].calls;
+    const int recent = min(_history_turns, TURN_HISTORY);
+    string desc = make_stringf("Turn loop: %u world_reacts calls, %d turns\n",
+                               turns, you.num_turns);
+    desc += make_stringf("%-20s %10s %12s %10s %10s %10s\n",
+                         "phase", "calls", "total ms", "ms/call",
+                         "ms/turn", make_stringf("last %d", recent).c_str());
+    for (int i = 0; i < NUM_TURN_PHASES; ++i)
+    {
+        const turn_phase_stats &p = turn_phases[i];
+        double recent_ms = 0;
+        for (int t = 0; t < recent; ++t)
+            recent_ms += _history[t][i];
+        desc += make_stringf("%-20s %10u %12.1f %10.4f %10.4f %10.4f\n",
+                             _phase_names[i], p.calls, p.ms,
+                             p.calls ? p.ms / p.calls : 0.0,
+                             turns ? p.ms / turns : 0.0,
+                             recent ? recent_ms / recent : 0.0);
+    }
+#ifdef TRACK_ALLOCATIONS
+    desc += make_stringf("\n%-20s %10s %12s %10s %10s\n", "allocations in",
+                         "allocs", "bytes", "allocs/turn", "bytes/alloc");
+    for (int i = 0; i <= NUM_TURN_PHASES; ++i)
+    {
+        const unsigned int allocs = _allocs[i];
+        const uint64_t bytes = _alloc_bytes[i];
+        desc += make_stringf("%-20s %10u %12" PRIu64 " %10.1f %10.1f\n",
+                             i == TP_NONE ? "(no phase)" : _phase_names[i],
+                             allocs, bytes,
+                             turns ? (double) allocs / turns : 0.0,
+                             allocs ? (double) bytes / allocs : 0.0);
+    }
+    desc += make_stringf("last turn: %u allocs; sizes:", _last_turn_allocs);
+    static const char *size_names[ALLOC_SIZE_BUCKETS] =
+    {
+        "<=16", "<=64", "<=256", "<=1k", "<=4k", ">4k",
+    };
+    for (int i = 0; i < ALLOC_SIZE_BUCKETS; ++i)
+    {
+        desc += make_stringf(" %s %u", size_names[i],
+                             (unsigned int) _alloc_sizes[i]);
+    }
+    desc += "\n";
+#endif
+    return desc;
+}
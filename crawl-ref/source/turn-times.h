@@ -0,0 +1,104 @@
+/**
+ * @file
+ * @brief Timing the phases of the turn loop, for -print-turn-times, the
+ *        wizard mode turn times command and Chrome trace files. Builds
+ *        with TRACK_ALLOCATIONS count heap allocations in each phase too.
+**/
+
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include "tasks.h"
+
+using std::string;
+
+enum turn_phase_type
+{
+    TP_WORLD_REACTS,
+    TP_MONSTERS,
+    TP_MONSTER_MOVE,
+    TP_VIEW,
+    TP_LOS,
+    TP_BEAM,
+    TP_TRAVEL_PATHFIND,
+    TP_SEND_MAP,
+    TP_SAVE,
+    TP_LEVEL_CATCHUP,
+    NUM_TURN_PHASES
+};
+
+// Calls to and time spent in each phase, over this session. Phases nest
+// (handle_monsters() runs inside world_reacts(), and LOS is computed
+// everywhere), so the times overlap.
+struct turn_phase_stats
+{
+    unsigned int calls = 0;
+    double ms = 0;
+};
+
+#ifdef TRACK_ALLOCATIONS
+// Allocations are counted against the innermost phase running when they
+// are made, so unlike the times they don't overlap; anything outside every
+// phase counts as TP_NONE.
+static const int TP_NONE = NUM_TURN_PHASES;
+#endif
+extern turn_phase_stats turn_phases[NUM_TURN_PHASES];
+
+// Whether phases are being timed at all.
+extern bool turn_times_active;
+
+// Times the enclosing scope as one call of a phase. Does nothing unless
+// turn_times_active, or when it is already inside that phase, or on a worker
+// thread. Use it through TURN_PHASE(), so that building with NO_TURN_TIMES
+// leaves nothing behind.
+class turn_phase_timer
+{
+public:
+    explicit turn_phase_timer(turn_phase_type _phase)
+        : phase(_phase), running(turn_times_active && !task_on_worker())
+    {
+        if (running)
+            begin();
+    }
+
+    ~turn_phase_timer()
+    {
+        if (running)
+            end();
+    }
+
+private:
+    void begin();
+    void end();
+
+    turn_phase_type phase;
+    bool running;
+    std::chrono::steady_clock::time_point start;
+#ifdef TRACK_ALLOCATIONS
+    int outer;
+#endif
+};
+
+#ifdef NO_TURN_TIMES
+# define TURN_PHASE(phase)
+#else
+# define TURN_PHASE(phase) turn_phase_timer turn_phase_timer_(phase)
+#endif
+
+void turn_times_update_active();
+void turn_times_reset();
+
+// Print the times of each turn as it ends, on the diagnostics channel.
+void turn_times_set_overlay(bool on);
+bool turn_times_overlay();
+
+// Record every call to a Chrome trace (chrome://tracing, Perfetto) file,
+// which is written out by turn_times_stop_trace().
+void turn_times_start_trace(const string &file);
+bool turn_times_stop_trace();
+bool turn_times_tracing();
+
+// The session totals, and the mean of the last turns.
+string turn_times_description();
@@ -282,9 +282,15 @@ SizeReq Widget::get_preferred_size(Direction dim, int prosp_width)
     if (!m_visible)
         return { 0, 0 };
 
-    if (cached_sr_valid[dim] && (!dim || cached_sr_pw == prosp_width))
-        return cached_sr[dim];
+    if (!dim && cached_sr_h_valid)
+        return cached_sr_h;
+    if (dim)
+        for (int i = 0; i < num_cached_sr_v; i++)
+            if (cached_sr_pw[i] == prosp_width)
+                return cached_sr_v[i];
 
+    // Cache by the width asked for, not the one less margins.
+    const int requested_width = prosp_width;
     prosp_width = dim ? prosp_width - margin.right - margin.left : prosp_width;
     SizeReq ret = _get_preferred_size(dim, prosp_width);
     ASSERT(ret.min <= ret.nat);
@@ -315,10 +321,18 @@ SizeReq Widget::get_preferred_size(Direction dim, int prosp_width)
 
     ret.nat = min(ret.nat, ui_expand_sz);
 
-    cached_sr_valid[dim] = true;
-    cached_sr[dim] = ret;
     if (dim)
-        cached_sr_pw = prosp_width;
+    {
+        cached_sr_pw[next_cached_sr_v] = requested_width;
+        cached_sr_v[next_cached_sr_v] = ret;
+        next_cached_sr_v = (next_cached_sr_v + 1) % num_cached_heights;
+        num_cached_sr_v = min(num_cached_sr_v + 1, num_cached_heights);
+    }
+    else
+    {
+        cached_sr_h_valid = true;
+        cached_sr_h = ret;
+    }
 
     return ret;
 }
@@ -395,7 +409,11 @@ void Widget::_unparent(shared_ptr<Widget>& child)
 void Widget::_invalidate_sizereq(bool immediate)
 {
     for (auto w = this; w; w = w->m_parent)
-        fill(begin(w->cached_sr_valid), end(w->cached_sr_valid), false);
+    {
+        w->cached_sr_h_valid = false;
+        w->num_cached_sr_v = 0;
+        w->next_cached_sr_v = 0;
+    }
     if (immediate)
         ui_root.queue_layout();
 }
@@ -2587,6 +2605,10 @@ void UIRoot::render()
         return;
 
 #ifdef USE_TILE_LOCAL
+    // Paint once the window can be seen again; see TilesFramework::redraw().
+    if (wm && !wm->window_shown())
+        return;
+
     glmanager->reset_view_for_redraw();
     tiles.maybe_redraw_screen();
     if (should_render_current_regions)
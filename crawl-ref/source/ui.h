@@ -513,9 +513,16 @@ protected:
     void _emit_layout_pop();
 
 private:
-    bool cached_sr_valid[2] = { false, false };
-    SizeReq cached_sr[2];
-    int cached_sr_pw;
+    // Cached size requests. The height depends on the prospective width,
+    // and a layout pass usually asks at more than one (the natural width,
+    // then the allocated one), so a few are kept, replaced in turn.
+    static constexpr int num_cached_heights = 2;
+    bool cached_sr_h_valid = false;
+    SizeReq cached_sr_h;
+    int num_cached_sr_v = 0;
+    int next_cached_sr_v = 0;
+    int cached_sr_pw[num_cached_heights];
+    SizeReq cached_sr_v[num_cached_heights];
     bool alloc_queued = false;
     bool m_visible = true;
     Widget* m_parent = nullptr;
@@ -76,6 +76,7 @@
 #include "tiles-build-specific.h"
 #include "traps.h"
 #include "travel.h"
+#include "turn-times.h"
 #include "unicode.h"
 #include "unwind.h"
 #include "viewchar.h"
@@ -688,116 +689,121 @@ bool magic_mapping(int map_radius, int proportion, bool suppress_msg,
     const FixedArray<uint8_t, GXM, GYM>& difficulty =
         _tile_difficulties(!deterministic);
 
-    for (radius_iterator ri(in_bounds(origin) ? origin : you.pos(),
-                            map_radius, C_SQUARE);
-         ri; ++ri)
     {
-        coord_def pos = *ri;
-        if (range_falloff)
+        // Update the display once the whole area is mapped.
+        map_knowledge_batch batch;
+        for (radius_iterator ri(in_bounds(origin) ? origin : you.pos(),
+                                map_radius, C_SQUARE);
+             ri; ++ri)
         {
-            int threshold = proportion;
+            coord_def pos = *ri;
+            if (range_falloff)
+            {
+                int threshold = proportion;
 
-            const int dist = grid_distance(you.pos(), pos);
+                const int dist = grid_distance(you.pos(), pos);
 
-            if (dist > very_far)
-                threshold = threshold / 3;
-            else if (dist > pfar)
-                threshold = threshold * 2 / 3;
+                if (dist > very_far)
+                    threshold = threshold / 3;
+                else if (dist > pfar)
+                    threshold = threshold * 2 / 3;
 
-            if (difficulty(pos) > threshold)
-                continue;
-        }
+                if (difficulty(pos) > threshold)
+                    continue;
+            }
 
-        map_cell& knowledge = env.map_knowledge(pos);
+            map_cell& knowledge = env.map_knowledge(pos);
 
-        if (knowledge.changed())
-        {
-            // If the player has already seen the square, update map
-            // knowledge with the new terrain. Otherwise clear what we had
-            // before.
-            if (knowledge.seen())
+            if (knowledge.changed())
             {
-                dungeon_feature_type newfeat = env.grid(pos);
-                trap_type tr = feat_is_trap(newfeat) ? get_trap_type(pos) : TRAP_UNASSIGNED;
-                knowledge.set_feature(newfeat, env.grid_colours(pos), tr);
+                // If the player has already seen the square, update map
+                // knowledge with the new terrain. Otherwise clear what we had
+                // before.
+                if (knowledge.seen())
+                {
+                    dungeon_feature_type newfeat = env.grid(pos);
+                    trap_type tr = feat_is_trap(newfeat) ? get_trap_type(pos) : TRAP_UNASSIGNED;
+                    knowledge.set_feature(newfeat, env.grid_colours(pos), tr);
+                }
+                else
+                    knowledge.clear();
             }
-            else
-                knowledge.clear();
-        }
 
-        // Don't assume that DNGN_UNSEEN cells ever count as mapped.
-        // Because of a bug at one point in map forgetting, cells could
-        // spuriously get marked as mapped even when they were completely
-        // unseen.
-        const bool already_mapped = knowledge.mapped()
-                            && knowledge.feat() != DNGN_UNSEEN;
+            // Don't assume that DNGN_UNSEEN cells ever count as mapped.
+            // Because of a bug at one point in map forgetting, cells could
+            // spuriously get marked as mapped even when they were completely
+            // unseen.
+            const bool already_mapped = knowledge.mapped()
+                                && knowledge.feat() != DNGN_UNSEEN;
 
-        if (!full_info && (knowledge.seen() || already_mapped))
-            continue;
+            if (!full_info && (knowledge.seen() || already_mapped))
+                continue;
 
-        const dungeon_feature_type feat = env.grid(pos);
+            const dungeon_feature_type feat = env.grid(pos);
 
-        bool open = true;
+            bool open = true;
 
-        if (feat_is_solid(feat) && !feat_is_closed_door(feat))
-        {
-            open = false;
-            for (adjacent_iterator ai(pos); ai; ++ai)
+            if (feat_is_solid(feat) && !feat_is_closed_door(feat))
             {
-                if (map_bounds(*ai) && (!feat_is_opaque(env.grid(*ai))
-                                        || feat_is_closed_door(env.grid(*ai))))
+                open = false;
+                for (adjacent_iterator ai(pos); ai; ++ai)
                 {
-                    open = true;
-                    break;
+                    if (map_bounds(*ai)
+                        && (!feat_is_opaque(env.grid(*ai))
+                            || feat_is_closed_door(env.grid(*ai))))
+                    {
+                        open = true;
+                        break;
+                    }
                 }
             }
-        }
 
-        if (open)
-        {
-            if (full_info)
-            {
-                knowledge.set_feature(feat, _feat_default_map_colour(feat),
-                    feat_is_trap(env.grid(pos)) ? get_trap_type(pos)
-                                           : TRAP_UNASSIGNED);
-            }
-            else if (!knowledge.feat())
+            if (open)
             {
-                auto base_feat = magic_map_base_feat(feat);
-                auto colour = _feat_default_map_colour(base_feat);
-                auto trap = feat_is_trap(env.grid(pos)) ? get_trap_type(pos)
-                                                   : TRAP_UNASSIGNED;
-                knowledge.set_feature(base_feat, colour, trap);
-            }
-            if (emphasise(pos))
-                knowledge.flags |= MAP_EMPHASIZE;
+                if (full_info)
+                {
+                    knowledge.set_feature(feat, _feat_default_map_colour(feat),
+                        feat_is_trap(env.grid(pos)) ? get_trap_type(pos)
+                                               : TRAP_UNASSIGNED);
+                }
+                else if (!knowledge.feat())
+                {
+                    auto base_feat = magic_map_base_feat(feat);
+                    auto colour = _feat_default_map_colour(base_feat);
+                    auto trap = feat_is_trap(env.grid(pos)) ? get_trap_type(pos)
+                                                       : TRAP_UNASSIGNED;
+                    knowledge.set_feature(base_feat, colour, trap);
+                }
+                if (emphasise(pos))
+                    knowledge.flags |= MAP_EMPHASIZE;
 
-            if (full_info)
-            {
-                if (is_notable_terrain(feat))
-                    seen_notable_thing(feat, pos);
+                if (full_info)
+                {
+                    if (is_notable_terrain(feat))
+                        seen_notable_thing(feat, pos);
+
+                    set_terrain_seen(pos);
+                    StashTrack.add_stash(pos);
+                    show_update_at(pos);
+    #ifdef USE_TILE
+                    tile_wizmap_terrain(pos);
+    #endif
+                }
+                else
+                {
+                    set_terrain_mapped(pos);
 
-                set_terrain_seen(pos);
-                StashTrack.add_stash(pos);
-                show_update_at(pos);
-#ifdef USE_TILE
-                tile_wizmap_terrain(pos);
-#endif
-            }
-            else
-            {
-                set_terrain_mapped(pos);
+                    if (get_cell_map_feature(knowledge) == MF_STAIR_BRANCH)
+                        seen_notable_thing(feat, pos);
 
-                if (get_cell_map_feature(knowledge) == MF_STAIR_BRANCH)
-                    seen_notable_thing(feat, pos);
+                    if (get_feature_dchar(feat) == DCHAR_ALTAR)
+                        num_altars++;
+                    else if (get_feature_dchar(feat) == DCHAR_ARCH)
+                        num_shops_portals++;
+                }
 
-                if (get_feature_dchar(feat) == DCHAR_ALTAR)
-                    num_altars++;
-                else if (get_feature_dchar(feat) == DCHAR_ARCH)
-                    num_shops_portals++;
+                did_map = true;
             }
-
-            did_map = true;
         }
     }
 
@@ -827,6 +833,9 @@ bool magic_mapping(int map_radius, int proportion, bool suppress_msg,
             mpr_comma_separated_list("You sensed ", sensed);
     }
 
+    if (did_map)
+        invalidate_travel_terrain();
+
     return did_map;
 }
 
@@ -1385,6 +1394,8 @@ static bool _viewwindow_should_render()
  */
 void viewwindow(bool show_updates, bool tiles_only, animation *a, view_renderer *renderer)
 {
+    TURN_PHASE(TP_VIEW);
+
     if (_view_is_updating)
     {
         // recursive calls to this function can lead to memory corruption or
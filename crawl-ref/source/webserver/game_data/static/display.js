@@ -88,7 +88,7 @@ function ($, comm, map_knowledge, view_data, monster_list, minimap,
             minimap.do_view_center_update(data.vgrdc.x, data.vgrdc.y);
 
         if (data.cells)
-            map_knowledge.merge(data.cells);
+            map_knowledge.merge(data.cells, data.packed);
 
         // Mark cells overlapped by dirty cells as dirty
         $.each(map_knowledge.dirty().slice(), function (i, loc) {
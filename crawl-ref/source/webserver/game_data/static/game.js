@@ -339,6 +339,9 @@ function ($, exports, comm, client, key_conversion, dungeon_renderer, display,
     {
         game_version = data;
         document.title = data.text;
+        // Ask for the compact map encoding. Map messages say which encoding
+        // they use, so spectators decode them the same way.
+        comm.send_message("map_encoding", { packed: true });
     }
 
     function glyph_mode_font_init()
@@ -2,11 +2,13 @@ define(["jquery", "./enums", "./util"], function ($, enums, util) {
     "use strict";
 
     var k, player_on_level, monster_table, dirty_locs, bounds, bounds_changed;
+    var composites;
 
     function init()
     {
         k = new Array(65536);
         monster_table = {};
+        composites = {};
         dirty_locs = [];
         bounds = null;
         bounds_changed = false;
@@ -34,6 +36,7 @@ define(["jquery", "./enums", "./util"], function ($, enums, util) {
     {
         k = new Array(65536);
         monster_table = {};
+        composites = {};
         bounds = null;
     }
 
@@ -121,6 +124,26 @@ define(["jquery", "./enums", "./util"], function ($, enums, util) {
         }
     }
 
+    // Dolls and mcache entries that were sent before arrive as just an id
+    // (see _dedup_composite in tileweb.cc); the first time, with the id.
+    function expand_composite(t)
+    {
+        if (t.doll !== undefined)
+        {
+            composites[t.mc] = { doll: t.doll, mcache: t.mcache,
+                                 trans: t.trans };
+        }
+        else
+        {
+            var c = composites[t.mc];
+            t.doll = c.doll;
+            t.mcache = c.mcache;
+            if (c.trans !== undefined)
+                t.trans = c.trans;
+        }
+        delete t.mc;
+    }
+
     var merge_last_x, merge_last_y;
 
     function merge(val)
@@ -149,6 +172,8 @@ define(["jquery", "./enums", "./util"], function ($, enums, util) {
             }
             else if (prop == "t")
             {
+                if (val[prop].mc !== undefined)
+                    expand_composite(val[prop]);
                 entry[prop] = merge_objects(entry[prop], val[prop]);
 
                 // The transparency flag is linked to the doll;
@@ -197,11 +222,54 @@ define(["jquery", "./enums", "./util"], function ($, enums, util) {
 
     }
 
-    function merge_diff(vals)
+    // Bits of the mask that starts a packed cell; see _send_cell in
+    // tileweb.cc.
+    var PACKED_POS = 1, PACKED_FEAT = 2, PACKED_MAPFT = 4, PACKED_GLYPH = 8,
+        PACKED_COLOUR = 16, PACKED_FG = 32, PACKED_BG = 64;
+
+    // Turns a packed cell back into the object that would have been sent.
+    function unpack(cell)
+    {
+        var mask = cell[0], i = 1;
+        var val = {}, fg, bg;
+
+        if (mask & PACKED_POS)
+        {
+            val.x = cell[i++];
+            val.y = cell[i++];
+        }
+        if (mask & PACKED_FEAT)
+            val.f = cell[i++];
+        if (mask & PACKED_MAPFT)
+            val.mf = cell[i++];
+        if (mask & PACKED_GLYPH)
+            val.g = cell[i++];
+        if (mask & PACKED_COLOUR)
+            val.col = cell[i++];
+        if (mask & PACKED_FG)
+            fg = cell[i++];
+        if (mask & PACKED_BG)
+            bg = cell[i++];
+
+        if (i < cell.length)
+            $.extend(val, cell[i]);
+
+        if (mask & (PACKED_FG | PACKED_BG))
+        {
+            val.t = val.t || {};
+            if (mask & PACKED_FG)
+                val.t.fg = fg;
+            if (mask & PACKED_BG)
+                val.t.bg = bg;
+        }
+        return val;
+    }
+
+    function merge_diff(vals, packed)
     {
         $.each(vals, function (i, val)
                {
-                   merge(val);
+                   merge(packed ? unpack(val) : val);
                });
 
         clean_monster_table();
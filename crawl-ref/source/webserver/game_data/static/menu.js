@@ -629,6 +629,36 @@ function ($, comm, client, ui, enums, cr, util, options, scroller) {
         if (menu.last_part_visible === -1)
             menu.last_part_visible = menu.last_visible;
         update_more();
+        request_visible_items();
+    }
+
+    // How many items beyond those on screen to ask for, so that scrolling
+    // or moving the hover a little doesn't run into placeholders.
+    var request_margin = 50;
+
+    function is_missing_item(item)
+    {
+        return item && item.elem.hasClass("placeholder") && !item.requested;
+    }
+
+    function request_visible_items()
+    {
+        // Long menus are only sent a chunk at a time, with placeholders for
+        // the rest; ask for any of those that are on or near the screen.
+        var start = Math.max(0, menu.first_visible - request_margin);
+        var end = Math.min(menu.total_items - 1,
+                           menu.last_visible + request_margin);
+        while (start <= end && !is_missing_item(menu.items[start]))
+            start++;
+        while (end >= start && !is_missing_item(menu.items[end]))
+            end--;
+        if (start > end)
+            return;
+
+        for (var i = start; i <= end; ++i)
+            if (menu.items[i])
+                menu.items[i].requested = true;
+        comm.send_message("request_menu_range", { start: start, end: end });
     }
 
     function update_server_scroll()
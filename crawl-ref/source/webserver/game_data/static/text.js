@@ -21,10 +21,76 @@ define(["jquery", "comm"], function ($, comm) {
         return area.children("span").eq(line);
     }
 
-    function set_text_area_line(name, line, content)
+    function is_blank(chr, col)
+    {
+        return chr === " " && ((col >> 4) & 0xF) === 0;
+    }
+
+    // Rebuilds a line from its cells, a span for each run of one colour.
+    function render_line(span, cells)
+    {
+        var chars = cells.chars, cols = cells.cols;
+        var end = chars.length;
+        while (end > 0 && is_blank(chars[end - 1], cols[end - 1]))
+            end--;
+
+        span.empty();
+        var run_col = -1, text = "";
+        function flush()
+        {
+            if (run_col === -1)
+                return;
+            span.append($("<span>").addClass("fg" + (run_col & 0xF)
+                                              + " bg" + ((run_col >> 4) & 0xF))
+                                   .text(text));
+        }
+        for (var x = 0; x < end; ++x)
+        {
+            var chr = chars[x] === undefined ? " " : chars[x];
+            var col = cols[x] === undefined ? 0 : cols[x];
+            // Blank cells don't show their foreground colour.
+            if (run_col !== -1 && is_blank(chr, col))
+                col = run_col;
+            if (col !== run_col)
+            {
+                flush();
+                run_col = col;
+                text = "";
+            }
+            text += chr;
+        }
+        flush();
+    }
+
+    // A line is its first column, then colour and text pairs; starting at
+    // column 0 replaces the whole line, otherwise only those cells change.
+    // See WebTextArea::send.
+    function set_text_area_line(name, line, runs)
     {
         var span = get_text_area_line(name, line);
-        span.html(content);
+        var cells = span.data("cells");
+        var x = runs[0];
+        if (!cells || x === 0)
+        {
+            cells = { chars: [], cols: [] };
+            span.data("cells", cells);
+        }
+        for (var i = 1; i + 1 < runs.length; i += 2)
+        {
+            var col = runs[i];
+            for (var chr of runs[i + 1])
+            {
+                cells.chars[x] = chr;
+                cells.cols[x] = col;
+                x++;
+            }
+        }
+        render_line(span, cells);
+    }
+
+    function is_empty_line(runs)
+    {
+        return runs.length == 1 && runs[0] === 0;
     }
 
     function handle_text_update(data)
@@ -36,7 +102,7 @@ define(["jquery", "comm"], function ($, comm) {
             for (var i = 0; i < lines.length; ++i)
             {
                 if (!(i in data.lines))
-                    lines.eq(i).empty();
+                    lines.eq(i).empty().removeData("cells");
             }
         }
         if (area.hasClass("menu_crt_shrink"))
@@ -45,7 +111,7 @@ define(["jquery", "comm"], function ($, comm) {
             while (klist.length > 0)
             {
                 var i = klist.pop();
-                if (data.lines[i] !== "")
+                if (!is_empty_line(data.lines[i]))
                     break;
                 delete data.lines[i];
             }
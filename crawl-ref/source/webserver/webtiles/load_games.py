@@ -211,7 +211,7 @@ def validate_game_dict(game):
     optional = ('dir_path', 'cwd', 'morgue_url', 'milestone_path',
                 'send_json_options', 'options', 'env', 'separator',
                 'show_save_info', 'allowed_with_hold', 'version',
-                'template', 'pre_options', 'client_path')
+                'template', 'pre_options', 'client_path', 'zygote_socket')
     # XX less ad hoc typing
     boolean = ('send_json_options', 'show_save_info', 'allowed_with_hold')
     string_array = ('options', 'pre_options')
@@ -219,7 +219,8 @@ def validate_game_dict(game):
 
     # values where %n can't be expanded
     # XX not sure this list gets everything
-    username_invalid = ('pre_options', 'crawl_binary', 'socket_path')
+    username_invalid = ('pre_options', 'crawl_binary', 'socket_path',
+                        'zygote_socket')
     # XX should %v be validated here too? Currently handled in
     # GameConfig.validate_game
 
@@ -881,6 +881,12 @@ class CrawlProcessHandler(CrawlProcessHandlerBase):
 
         call = self._base_call() + ["-webtiles-socket", self.socketpath,
                                     "-await-connection"]
+        if "zygote_socket" in game:
+            # Have a `crawl -zygote` server fork the game, instead of starting
+            # it from scratch. (If the server isn't running, the binary just
+            # runs the game itself.)
+            call = [call[0], "-zygote-connect",
+                    game.templated("zygote_socket")] + call[1:]
 
         ttyrec_path = self.config_path("ttyrec_path")
         if ttyrec_path and config.get('enable_ttyrecs'):
@@ -1143,6 +1149,11 @@ class CrawlProcessHandler(CrawlProcessHandlerBase):
                 # message
                 self.receiving_direct_milestones = True # no need for .where files
                 self.set_where_info(msgobj)
+            elif msgobj["msg"] == "webtiles_stats":
+                # per message type counts, sizes and serialization times,
+                # sent on request (wizard mode ^N)
+                self.logger.info("Webtiles message stats: %s",
+                                 json_encode(msgobj["types"]))
             else:
                 self.logger.warning("Unknown message from the crawl process: %s",
                                     msgobj["msg"])
@@ -120,9 +120,14 @@ static void _translate_window_event(const SDL_WindowEvent &sdl_event,
             tile_event.active.gain = 1;
             break;
         case SDL_WINDOWEVENT_HIDDEN:
+        case SDL_WINDOWEVENT_MINIMIZED:
             tile_event.type = WME_ACTIVEEVENT;
             tile_event.active.gain = 0;
             break;
+        case SDL_WINDOWEVENT_RESTORED:
+            tile_event.type = WME_ACTIVEEVENT;
+            tile_event.active.gain = 1;
+            break;
         case SDL_WINDOWEVENT_EXPOSED:
             tile_event.type = WME_EXPOSE;
             break;
@@ -491,13 +496,31 @@ int SDLWrapper::init(coord_def *m_windowsz)
 #ifdef __ANDROID__
     SDL_StartTextInput();
     Options.game_scale = min(_desktop_width, _desktop_height)/1080+1;
+# ifndef USE_GL3
     // Request OpenGL ES 1.0 context
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 1);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
+# endif
     SDL_SetHint(SDL_HINT_ANDROID_SEPARATE_MOUSE_AND_TOUCH, "1");
     SDL_SetHint(SDL_HINT_TOUCH_MOUSE_EVENTS, "1");
 #endif
 
+#ifdef USE_GL3
+    // glwrapper-gl3 needs OpenGL 3.3 core or OpenGL ES 3.0.
+# ifdef USE_GLES
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_ES);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
+# else
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS,
+                        SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+# endif
+    glDebug("SDL_GL_CONTEXT_PROFILE_MASK");
+#endif
+
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
     glDebug("SDL_GL_DOUBLEBUFFER");
     SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 8);
@@ -639,6 +662,13 @@ int SDLWrapper::desktop_height() const
     return _desktop_height;
 }
 
+bool SDLWrapper::window_shown() const
+{
+    return m_window
+           && !(SDL_GetWindowFlags(m_window)
+                & (SDL_WINDOW_HIDDEN | SDL_WINDOW_MINIMIZED));
+}
+
 void SDLWrapper::set_window_title(const char *title)
 {
     SDL_SetWindowTitle(m_window, title);
@@ -1061,6 +1091,7 @@ void SDLWrapper::remove_timer(unsigned int& timer_id)
 
 void SDLWrapper::swap_buffers()
 {
+    glmanager->flush();
     SDL_GL_SwapWindow(m_window);
 }
 
@@ -1136,6 +1167,71 @@ bool SDLWrapper::next_event_is(wm_event_type type)
     return count != 0;
 }
 
+static unsigned int _read_u32(const unsigned char *bytes)
+{
+    return bytes[0] | bytes[1] << 8 | bytes[2] << 16
+           | (unsigned int)bytes[3] << 24;
+}
+
+// Read the uncompressed texture that rltiles writes next to each of its
+// images (see write_texture in rltiles/tool/tile_colour.cc), padded out to
+// powers of two if asked. Fails if there is none, or if it is older than the
+// PNG, which might have been replaced since.
+static bool _load_packed_texture(const string &png_path, bool power_of_two,
+                                 vector<unsigned char> &pixels,
+                                 unsigned int &width, unsigned int &height,
+                                 int &new_width, int &new_height)
+{
+    if (!ends_with(png_path, ".png"))
+        return false;
+    const string path = png_path.substr(0, png_path.size() - 4) + ".tex";
+    if (file_modtime(path) < file_modtime(png_path))
+        return false;
+
+    FILE *fp = fopen_u(path.c_str(), "rb");
+    if (!fp)
+        return false;
+
+    unsigned char header[16];
+    bool success = fread(header, 1, sizeof(header), fp) == sizeof(header)
+                   && !memcmp(header, "CRTX", 4)
+                   && _read_u32(header + 4) == 1;
+    if (success)
+    {
+        width = _read_u32(header + 8);
+        height = _read_u32(header + 12);
+        success = width && height && width <= 0x8000 && height <= 0x8000;
+    }
+
+    if (success)
+    {
+        new_width = width;
+        new_height = height;
+        if (power_of_two)
+        {
+            new_width = 1;
+            while (new_width < (int)width)
+                new_width *= 2;
+            new_height = 1;
+            while (new_height < (int)height)
+                new_height *= 2;
+        }
+
+        pixels.assign(4 * new_width * new_height, 0);
+        // The rows are read in place, leaving any padding transparent.
+        for (unsigned int y = 0; success && y < height; y++)
+        {
+            success = fread(&pixels[4 * y * new_width], 4, width, fp)
+                      == width;
+        }
+    }
+    fclose(fp);
+
+    if (!success)
+        fprintf(stderr, "Couldn't load texture '%s'.\n", path.c_str());
+    return success;
+}
+
 bool SDLWrapper::load_texture(GenericTexture *tex, const char *filename,
                               MipMapOptions mip_opt, unsigned int &orig_width,
                               unsigned int &orig_height, tex_proc_func proc,
@@ -1155,6 +1251,25 @@ bool SDLWrapper::load_texture(GenericTexture *tex, const char *filename,
         return false;
     }
 
+    // Prefer the packed texture, which needs no decoding.
+    vector<unsigned char> packed;
+    int new_width;
+    int new_height;
+    if (_load_packed_texture(tex_path, force_power_of_two, packed,
+                             orig_width, orig_height, new_width, new_height))
+    {
+        glmanager->pixelstore_unpack_alignment(1);
+        bool success = false;
+        if (!proc || proc(&packed[0], new_width, new_height))
+        {
+            opengl::check_texture_size(filename, new_width, new_height);
+            success = tex->load_texture(&packed[0], new_width, new_height,
+                                        mip_opt);
+            opengl::flush_opengl_errors();
+        }
+        return success;
+    }
+
     SDL_Surface *img = load_image(tex_path.c_str());
 
     if (!img)
@@ -1173,8 +1288,6 @@ bool SDLWrapper::load_texture(GenericTexture *tex, const char *filename,
     // Determine texture format
     unsigned char *pixels = (unsigned char*)img->pixels;
 
-    int new_width;
-    int new_height;
     if (force_power_of_two)
     {
         new_width = 1;
@@ -54,6 +54,7 @@ public:
     virtual int screen_height() const override;
     virtual int desktop_width() const override;
     virtual int desktop_height() const override;
+    virtual bool window_shown() const override;
 
     // Texture loading
     virtual bool load_texture(GenericTexture *tex, const char *filename,
@@ -176,6 +176,8 @@ public:
     virtual int screen_height() const = 0;
     virtual int desktop_width() const = 0;
     virtual int desktop_height() const = 0;
+    // Whether any of the window can be seen: not hidden or minimised.
+    virtual bool window_shown() const = 0;
 
     // Texture loading
     virtual bool load_texture(GenericTexture *tex, const char *filename,
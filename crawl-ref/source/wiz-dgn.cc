@@ -34,6 +34,7 @@
 #include "tileview.h"
 #include "tiles-build-specific.h"
 #include "traps.h"
+#include "travel.h"
 #include "view.h"
 #include "wiz-mon.h"
 
@@ -169,6 +170,12 @@ static void _wizard_go_to_level(const level_pos &pos)
     _wizard_level_target = level_id();
 }
 
+// As the interlevel travel command, without the prompt.
+void wizard_go_to_level(const level_id &id)
+{
+    _wizard_go_to_level(level_pos(id, coord_def(-1, -1)));
+}
+
 void wizard_interlevel_travel()
 {
     string name;
@@ -781,6 +788,15 @@ void debug_test_explore()
     mprf("Explore took %d turns.", explore_turns);
 }
 
+void wizard_travel_stats()
+{
+    for (const string &line : split_string("\n", travel_stats_description()))
+        mprf(MSGCH_DIAGNOSTICS, "%s", line.c_str());
+
+    if (travel_counters.steps && yesno("Reset the counters?", true, 'n'))
+        travel_counters = travel_stats();
+}
+
 void wizard_list_levels()
 {
     if (!you.level_stack.empty())
@@ -25,6 +25,7 @@ void wizard_map_level();
 void wizard_place_stairs(bool down);
 void wizard_level_travel(bool down);
 void wizard_interlevel_travel();
+void wizard_go_to_level(const level_id &id);
 void wizard_list_levels();
 void wizard_recreate_level();
 void wizard_clear_used_vaults();
@@ -33,6 +34,7 @@ bool debug_make_shop(const coord_def& pos = you.pos());
 void debug_place_map(bool primary);
 void wizard_primary_vault();
 void debug_test_explore();
+void wizard_travel_stats();
 void wizard_abyss_speed();
 
 bool is_wizard_travel_target(const level_id l);
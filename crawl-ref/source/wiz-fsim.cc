@@ -8,6 +8,11 @@
 #include "wiz-fsim.h"
 
 #include <cerrno>
+#if defined(UNIX) && !defined(USE_TILE_WEB)
+#include <sys/wait.h>
+#include <unistd.h>
+#define FSIM_WORKERS
+#endif
 
 #include "beam.h"
 #include "bitary.h"
@@ -33,6 +38,7 @@
 #include "output.h"
 #include "player-equip.h"
 #include "player.h"
+#include "random.h"
 #include "ranged-attack.h"
 #include "skills.h"
 #include "species.h"
@@ -459,6 +465,129 @@ static void _do_one_fsim_round(monster &mon, fight_data &fd, bool defend)
     you.move_to_pos(you_start_pos);
 }
 
+#ifdef FSIM_WORKERS
+// What a worker hands back: the running totals of both sides.
+struct fsim_worker_totals
+{
+    unsigned int cumulative_damage[2];
+    int time_taken[2];
+    int hits[2];
+    int max_dam[2];
+};
+
+static void _add_fsim_totals(fight_damage_stats &stats,
+                             const fsim_worker_totals &totals, int side)
+{
+    stats.cumulative_damage += totals.cumulative_damage[side];
+    stats.time_taken += totals.time_taken[side];
+    stats.hits += totals.hits[side];
+    stats.max_dam = max(stats.max_dam, totals.max_dam[side]);
+}
+
+static bool _read_fsim_totals(int fd, fsim_worker_totals &totals)
+{
+    char *buf = reinterpret_cast<char *>(&totals);
+    size_t got = 0;
+    while (got < sizeof(totals))
+    {
+        const ssize_t n = read(fd, buf + got, sizeof(totals) - got);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        got += n;
+    }
+    return true;
+}
+
+/**
+ * Split the rounds of a simulation between Options.fsim_jobs worker
+ * processes. Each worker starts from the same player and monster, draws from
+ * its own seed and sends its totals back through a pipe; they are added to
+ * fdata here. The rounds of any worker that couldn't be started, or which
+ * failed, are run in this process instead.
+ */
+static void _run_fsim_parallel(monster &mon, fight_data &fdata,
+                               int iter_limit, bool defend)
+{
+    const int jobs = min(Options.fsim_jobs, iter_limit);
+    // Derived from the current stream, so that a seeded game gives
+    // repeatable results.
+    const uint64_t base_seed = rng::get_uint64();
+    vector<pid_t> workers;
+    vector<int> pipes;
+    int missed = 0;
+
+    fflush(stdout);
+    fflush(stderr);
+
+    for (int i = 0; i < jobs; ++i)
+    {
+        const int rounds = iter_limit / jobs + (i < iter_limit % jobs);
+        int fds[2];
+        if (pipe(fds) == -1)
+        {
+            missed += rounds;
+            continue;
+        }
+
+        const pid_t pid = fork();
+        if (pid == -1)
+        {
+            close(fds[0]);
+            close(fds[1]);
+            missed += rounds;
+            continue;
+        }
+        if (pid)
+        {
+            close(fds[1]);
+            workers.push_back(pid);
+            pipes.push_back(fds[0]);
+            continue;
+        }
+
+        close(fds[0]);
+        rng::seed(base_seed + i);
+
+        fight_data wdata;
+        for (int j = 0; j < rounds; j++)
+            _do_one_fsim_round(mon, wdata, defend);
+
+        const fsim_worker_totals totals =
+        {
+            { wdata.player.cumulative_damage, wdata.monster.cumulative_damage },
+            { wdata.player.time_taken, wdata.monster.time_taken },
+            { wdata.player.hits, wdata.monster.hits },
+            { wdata.player.max_dam, wdata.monster.max_dam },
+        };
+        const bool ok = write(fds[1], &totals, sizeof(totals))
+                        == (ssize_t) sizeof(totals);
+        _exit(ok ? 0 : 1);
+    }
+
+    for (int i = 0, size = workers.size(); i < size; ++i)
+    {
+        fsim_worker_totals totals;
+        const bool got = _read_fsim_totals(pipes[i], totals);
+        close(pipes[i]);
+
+        int status = 0;
+        if (waitpid(workers[i], &status, 0) == -1
+            || !WIFEXITED(status) || WEXITSTATUS(status) || !got)
+        {
+            missed += iter_limit / jobs + (i < iter_limit % jobs);
+            continue;
+        }
+        _add_fsim_totals(fdata.player, totals, 0);
+        _add_fsim_totals(fdata.monster, totals, 1);
+    }
+
+    for (int i = 0; i < missed; i++)
+        _do_one_fsim_round(mon, fdata, defend);
+}
+#endif
+
 static fight_data _get_fight_data(monster &mon, int iter_limit, bool defend)
 {
     const monster orig = mon;
@@ -479,6 +608,11 @@ static fight_data _get_fight_data(monster &mon, int iter_limit, bool defend)
     {
         msg::suppress mx;
 
+#ifdef FSIM_WORKERS
+        if (Options.fsim_jobs > 1)
+            _run_fsim_parallel(mon, fdata, iter_limit, defend);
+        else
+#endif
         for (int i = 0; i < iter_limit; i++)
             _do_one_fsim_round(mon, fdata, defend);
     }
@@ -967,6 +967,7 @@ void wizard_transform()
     {
         you.default_form = form; // ehhh
         you.active_talisman.clear();
+        you.invalidate_artefact_cache();
     }
     if (!transform(200, form, true) && you.form != form)
         mpr("Transformation failed.");
@@ -16,15 +16,19 @@
 #include "command.h" // show_keyhelp_menu
 #include "dbg-util.h"
 #include "dgn-shoals.h" // wizard_mod_tide
+#include "env.h"
 #include "files.h" // save_game
 #include "god-companions.h" // wizard_list_companions
 #include "god-passive.h" // jiyva_eat_offlevel_items
 #include "hiscores.h"
 #include "items.h"
+#include "los.h" // los_ray_bytes
+#include "losglobal.h" // los_cache_bytes
 #include "luaterp.h" // debug_terp_lua
 #include "macro.h"
 #include "menu.h" // column_composer
 #include "message.h"
+#include "mon-pathfind.h"
 #include "notes.h"
 #include "output.h"
 #include "player.h"
@@ -34,7 +38,15 @@
 #include "spl-transloc.h" // wizard_blink
 #include "stairs.h" // down_stairs
 #include "state.h"
+#include "stringutil.h" // split_string
+#include "syscalls.h" // process_memory
+#include "tasks.h"
+#ifdef USE_TILE_WEB
+#include "tileweb.h" // tiles.stats_description
+#endif
 #include "traps.h" // do_trap_effects
+#include "travel.h"
+#include "turn-times.h"
 #include "wizard-option-type.h"
 #include "wiz-dgn.h"
 #include "wiz-dump.h"
@@ -44,6 +56,86 @@
 #include "wiz-you.h"
 #include "xom.h" // debug_xom_effects
 
+#ifdef USE_TILE_WEB
+static void _wizard_webtiles_stats()
+{
+    for (const string &line : split_string("\n", tiles.stats_description()))
+        mprf(MSGCH_DIAGNOSTICS, "%s", line.c_str());
+    tiles.send_stats();
+
+    if (yesno("Reset the counters?", true, 'n'))
+        tiles.reset_stats();
+}
+#endif
+
+static void _wizard_turn_times()
+{
+    const char *trace_file = "turn-trace.json";
+
+    for (const string &line : split_string("\n", turn_times_description()))
+        mprf(MSGCH_DIAGNOSTICS, "%s", line.c_str());
+    for (const string &line : split_string("\n", tasks_description()))
+        mprf(MSGCH_DIAGNOSTICS, "%s", line.c_str());
+
+    mprf(MSGCH_PROMPT, "[o] %s the per-turn overlay, [t] %s a trace, "
+                       "[r] reset the counters",
+         turn_times_overlay() ? "stop" : "start",
+         turn_times_tracing() ? "write" : "start");
+    switch (toalower(getchm()))
+    {
+    case 'o':
+        turn_times_set_overlay(!turn_times_overlay());
+        break;
+    case 't':
+        if (!turn_times_tracing())
+        {
+            turn_times_start_trace(trace_file);
+            mprf("Tracing to %s until this command is used again.",
+                 trace_file);
+        }
+        else if (turn_times_stop_trace())
+            mprf("Wrote %s.", trace_file);
+        else
+            mprf(MSGCH_ERROR, "Couldn't write %s.", trace_file);
+        break;
+    case 'r':
+        turn_times_reset();
+        break;
+    default:
+        canned_msg(MSG_OK);
+        break;
+    }
+}
+
+static void _memory_line(const char *what, size_t bytes,
+                         const string &note = "")
+{
+    mprf(MSGCH_DIAGNOSTICS, "%-26s %9.1f KB%s%s", what, bytes / 1024.0,
+         note.empty() ? "" : "  ", note.c_str());
+}
+
+// The process's memory, and the tables that take up the most of it.
+static void _wizard_memory_report()
+{
+    size_t resident, peak;
+    process_memory(resident, peak);
+    if (resident || peak)
+    {
+        mprf(MSGCH_DIAGNOSTICS, "Resident: %.1f MB now, %.1f MB at most",
+             resident / (1024.0 * 1024.0), peak / (1024.0 * 1024.0));
+    }
+
+    _memory_line("level (env)", sizeof(env));
+    _memory_line("  monsters (env.mons)", sizeof(env.mons));
+    _memory_line("  items (env.item)", sizeof(env.item));
+    _memory_line("LOS cache", los_cache_bytes(),
+                 make_stringf("(%.1f KB with every cell's)",
+                              los_cache_full_bytes() / 1024.0));
+    _memory_line("LOS rays", los_ray_bytes());
+    _memory_line("travel tables", travel_pathfind::table_bytes());
+    _memory_line("monster pathfinder", sizeof(monster_pathfind), "(each)");
+}
+
 static void _do_wizard_command(int wiz_command)
 {
     ASSERT(you.wizard);
@@ -124,18 +216,22 @@ static void _do_wizard_command(int wiz_command)
 
     case 'n': wizard_set_zot_clock(); break;
     // case 'N': break;
+#ifdef USE_TILE_WEB
+    case CONTROL('N'): _wizard_webtiles_stats(); break;
+#else
     // case CONTROL('N'): break;
+#endif
 
     case 'o': wizard_create_spec_object(); break;
     case 'O': debug_test_explore(); break;
-    // case CONTROL('O'): break;
+    case CONTROL('O'): wizard_travel_stats(); break;
 
     case 'p': wizard_transform(); break;
     case 'P': debug_place_map(true); break;
     case CONTROL('P'): wizard_list_props(); break;
 
-    // case 'q': break;
-    // case 'Q': break;
+    case 'q': _wizard_turn_times(); break;
+    case 'Q': _wizard_memory_report(); break;
     case CONTROL('Q'): wizard_toggle_dprf(); break;
 
     case 'r': wizard_change_species(); break;
@@ -510,6 +606,9 @@ int list_wizard_commands(bool do_redraw_screen)
                        "<w>Ctrl-F</w> double scale fsim\n"
                        "<w>Ctrl-I</w> item generation stats\n"
                        "<w>O</w>      measure exploration time\n"
+                       "<w>Ctrl-O</w> travel and explore profiling counters\n"
+                       "<w>q</w>      turn loop and task timings\n"
+                       "<w>Q</w>      memory used by the largest tables\n"
                        "<w>Ctrl-T</w> dungeon (D)Lua interpreter\n"
                        "<w>Ctrl-U</w> client (C)Lua interpreter\n"
                        "<w>Ctrl-X</w> Xom effect stats\n"
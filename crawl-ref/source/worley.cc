@@ -35,6 +35,7 @@
 
 #include <cfloat>
 #include <math.h>
+#include <memory>
 #include <stdint.h>
 #include <stdio.h>
 
@@ -63,6 +64,65 @@ namespace worley
        is 1.0. This makes an easy natural "scale" size of the cellular features. */
 #define DENSITY_ADJUSTMENT  0.398150
 
+    /* The feature points of a cube depend only on its coordinates, and
+       nearby samples (a row of map cells, or the same cell a few turns
+       later) keep visiting the same cubes, so remember the points of
+       recently seen cubes. The points are computed exactly as before, so
+       the noise is unchanged. Each thread has a cache of its own. */
+    struct cube_points
+    {
+        bool valid;
+        int32_t xi, yi, zi;
+        int32_t count;
+        uint32_t id[5];
+        double f[5][3];
+    };
+
+#define CUBE_CACHE_SIZE 1024
+
+    static const cube_points &cube_at(int32_t xi, int32_t yi, int32_t zi)
+    {
+        /* Each cube has a random number seed based on the cube's ID number.
+           The seed might be better if it were a nonlinear hash like Perlin uses
+           for noise but we do very well with this faster simple one.
+           Our LCG uses Knuth-approved constants for maximal periods. */
+        uint32_t seed=702395077*xi + 915488749*yi + 2120969693*zi;
+
+        static thread_local std::unique_ptr<cube_points[]> cube_cache;
+        if (!cube_cache)
+            cube_cache.reset(new cube_points[CUBE_CACHE_SIZE]());
+
+        cube_points &cube = cube_cache[(seed * 2654435761U >> 22)
+                                       % CUBE_CACHE_SIZE];
+        if (cube.valid && cube.xi == xi && cube.yi == yi && cube.zi == zi)
+            return cube;
+
+        cube.valid = true;
+        cube.xi = xi;
+        cube.yi = yi;
+        cube.zi = zi;
+
+        /* How many feature points are in this cube? */
+        cube.count=Poisson_count[(seed>>24)%256]; /* 256 element lookup table. Use MSB */
+
+        seed=1402024253*seed+586950981; /* churn the seed with good Knuth LCG */
+
+        for (int32_t j=0; j<cube.count; j++)
+        {
+            cube.id[j]=seed;
+            seed=1402024253*seed+586950981; /* churn */
+
+            /* compute the 0..1 feature point location's XYZ */
+            cube.f[j][0]=(seed+0.5)*(1.0/4294967296.0);
+            seed=1402024253*seed+586950981; /* churn */
+            cube.f[j][1]=(seed+0.5)*(1.0/4294967296.0);
+            seed=1402024253*seed+586950981; /* churn */
+            cube.f[j][2]=(seed+0.5)*(1.0/4294967296.0);
+            seed=1402024253*seed+586950981; /* churn */
+        }
+        return cube;
+    }
+
     /* the function to merge-sort a "cube" of samples into the current best-found
        list of values. */
     static void AddSamples(int32_t xi, int32_t yi, int32_t zi, int32_t max_order,
@@ -199,32 +259,17 @@ namespace worley
             double (*delta)[3], uint32_t *ID)
     {
         double dx, dy, dz, fx, fy, fz, d2;
-        int32_t count, i, j, index;
-        uint32_t seed, this_id;
-
-        /* Each cube has a random number seed based on the cube's ID number.
-           The seed might be better if it were a nonlinear hash like Perlin uses
-           for noise but we do very well with this faster simple one.
-           Our LCG uses Knuth-approved constants for maximal periods. */
-        seed=702395077*xi + 915488749*yi + 2120969693*zi;
+        int32_t i, j, index;
+        uint32_t this_id;
 
-        /* How many feature points are in this cube? */
-        count=Poisson_count[(seed>>24)%256]; /* 256 element lookup table. Use MSB */
+        const cube_points &cube = cube_at(xi, yi, zi);
 
-        seed=1402024253*seed+586950981; /* churn the seed with good Knuth LCG */
-
-        for (j=0; j<count; j++) /* test and insert each point into our solution */
+        for (j=0; j<cube.count; j++) /* test and insert each point into our solution */
         {
-            this_id=seed;
-            seed=1402024253*seed+586950981; /* churn */
-
-            /* compute the 0..1 feature point location's XYZ */
-            fx=(seed+0.5)*(1.0/4294967296.0);
-            seed=1402024253*seed+586950981; /* churn */
-            fy=(seed+0.5)*(1.0/4294967296.0);
-            seed=1402024253*seed+586950981; /* churn */
-            fz=(seed+0.5)*(1.0/4294967296.0);
-            seed=1402024253*seed+586950981; /* churn */
+            this_id=cube.id[j];
+            fx=cube.f[j][0];
+            fy=cube.f[j][1];
+            fz=cube.f[j][2];
 
             /* delta from feature point to sample location */
             dx=xi+fx-at[0];
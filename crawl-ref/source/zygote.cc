@@ -0,0 +1,489 @@
+/**
+ * @file
+ * @brief Fork server for webtiles: start once, fork a process per game.
+ *
+ * Started as "crawl -zygote <socket> [options]", the server does the part
+ * of startup that doesn't depend on the player (startup_preload()) once,
+ * then waits on a Unix socket. Games are started as
+ * "crawl -zygote-connect <socket> <the usual arguments>". That process
+ * hands its standard streams, working directory, environment and arguments
+ * to the server, which forks a child to carry on from main() with them, as
+ * a fresh crawl would have. The maps, Lua state and caches the server built
+ * are shared copy-on-write by all its games.
+ *
+ * The connecting process stays, forwarding signals to the game and exiting
+ * with its status, so that to the webtiles server it looks like the game.
+ * If there is no server, or it can't start the game, the connecting
+ * process runs the game itself.
+ *
+ * A request is the three descriptors, sent with its first byte, and
+ *   cwd \0 argc \0 arg \0 ... \0 envc \0 NAME=value \0 ... \0
+ * The server answers "pid <pid>\n" once the game is forked, and then
+ * "exit <wait status>\n" once it has been reaped.
+ */
+
+#include "AppHdr.h"
+
+#ifdef USE_TILE_WEB
+
+#include "zygote.h"
+
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "end.h"
+#include "initfile.h"
+#include "libutil.h"
+#include "mapdef.h" // depth_ranges, for resetting SysEnv
+#include "startup.h"
+#include "state.h"
+#include "stringutil.h"
+
+extern char **environ;
+
+// Requests longer than this (it's mostly the environment) are refused.
+#define MAX_REQUEST (1 << 20)
+
+static bool _socket_address(const string &path, sockaddr_un &addr)
+{
+    if (path.size() >= sizeof(addr.sun_path))
+        return false;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path.c_str());
+    return true;
+}
+
+static bool _send_all(int fd, const char *buf, size_t len)
+{
+    while (len)
+    {
+        const ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Read a "<word> <number>" line.
+static bool _read_reply(int fd, const string &word, int &value)
+{
+    string line;
+    while (true)
+    {
+        char c;
+        const ssize_t n = read(fd, &c, 1);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0 || line.size() > 64)
+            return false;
+        if (c == '\n')
+            break;
+        line += c;
+    }
+
+    return starts_with(line, word + " ")
+           && parse_int(line.c_str() + word.size() + 1, value);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// The connecting side
+
+static pid_t _game_pid = 0;
+
+static void _forward_signal(int sig)
+{
+    kill(_game_pid, sig);
+}
+
+static bool _send_request(int sock, const string &request)
+{
+    int fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+    char control[CMSG_SPACE(sizeof(fds))];
+    memset(control, 0, sizeof(control));
+
+    iovec iov;
+    iov.iov_base = const_cast<char *>(request.data());
+    iov.iov_len = request.size();
+
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    ssize_t sent;
+    do
+        sent = sendmsg(sock, &msg, MSG_NOSIGNAL);
+    while (sent < 0 && errno == EINTR);
+
+    return sent > 0
+           && _send_all(sock, request.data() + sent, request.size() - sent)
+           && !shutdown(sock, SHUT_WR);
+}
+
+/**
+ * Have the fork server at argv[2] run the game given by the rest of the
+ * arguments. Doesn't return if it does: exits with the game's status.
+ *
+ * @param[in,out] argc, argv The command line, beginning with
+ *                           "-zygote-connect <socket>". Those two are
+ *                           removed, leaving the game's own arguments.
+ * @return false if there is no server to run the game; the caller should
+ *         run it itself.
+ */
+bool zygote_connect(int &argc, char **&argv)
+{
+    const string socket_path = argv[2];
+    argv[2] = argv[0];
+    argv += 2;
+    argc -= 2;
+
+    sockaddr_un addr;
+    if (!_socket_address(socket_path, addr))
+        return false;
+
+    char cwd[PATH_MAX];
+    if (!getcwd(cwd, sizeof(cwd)))
+        return false;
+
+    string request = cwd;
+    request += '\0';
+    request += to_string(argc);
+    request += '\0';
+    for (int i = 0; i < argc; i++)
+    {
+        request += argv[i];
+        request += '\0';
+    }
+    int envc = 0;
+    while (environ[envc])
+        envc++;
+    request += to_string(envc);
+    request += '\0';
+    for (int i = 0; i < envc; i++)
+    {
+        request += environ[i];
+        request += '\0';
+    }
+
+    const int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0)
+        return false;
+
+    int pid;
+    if (connect(sock, (sockaddr *)&addr, sizeof(addr)) < 0
+        || !_send_request(sock, request)
+        || !_read_reply(sock, "pid", pid))
+    {
+        close(sock);
+        return false;
+    }
+    _game_pid = pid;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = _forward_signal;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    for (int sig : { SIGHUP, SIGINT, SIGQUIT, SIGTERM, SIGABRT, SIGUSR1,
+                     SIGUSR2, SIGWINCH })
+    {
+        sigaction(sig, &sa, nullptr);
+    }
+
+    int status;
+    if (!_read_reply(sock, "exit", status))
+    {
+        // The server went away. Wait for the game by hand.
+        while (!kill(_game_pid, 0))
+            sleep(1);
+        exit(1);
+    }
+
+    if (WIFSIGNALED(status))
+    {
+        signal(WTERMSIG(status), SIG_DFL);
+        raise(WTERMSIG(status));
+    }
+    exit(WIFEXITED(status) ? WEXITSTATUS(status) : 1);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// The server
+
+struct zygote_request
+{
+    string cwd;
+    vector<string> args;
+    vector<string> env;
+    int fds[3];
+
+    zygote_request() : fds{-1, -1, -1} { }
+
+    void close_fds()
+    {
+        for (int &fd : fds)
+        {
+            if (fd >= 0)
+                close(fd);
+            fd = -1;
+        }
+    }
+};
+
+static bool _parse_request(const string &buf, zygote_request &req)
+{
+    vector<string> fields;
+    size_t start = 0;
+    for (size_t stop; (stop = buf.find('\0', start)) != string::npos;
+         start = stop + 1)
+    {
+        fields.emplace_back(buf, start, stop - start);
+    }
+    if (start != buf.size())
+        return false;
+
+    size_t i = 0;
+    auto counted = [&](vector<string> &out)
+    {
+        int count;
+        if (i >= fields.size() || !parse_int(fields[i++].c_str(), count)
+            || count < 0 || (size_t)count > fields.size() - i)
+        {
+            return false;
+        }
+        out.assign(fields.begin() + i, fields.begin() + i + count);
+        i += count;
+        return true;
+    };
+
+    if (fields.empty())
+        return false;
+    req.cwd = fields[i++];
+    return counted(req.args) && !req.args.empty() && counted(req.env)
+           && i == fields.size();
+}
+
+static bool _recv_request(int conn, zygote_request &req)
+{
+    // Don't let a stuck client hold up every other game.
+    timeval timeout = { 5, 0 };
+    setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    char buf[4096];
+    char control[CMSG_SPACE(sizeof(req.fds))];
+
+    iovec iov;
+    iov.iov_base = buf;
+    iov.iov_len = sizeof(buf);
+
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t n;
+    do
+        n = recvmsg(conn, &msg, MSG_CMSG_CLOEXEC);
+    while (n < 0 && errno == EINTR);
+    if (n <= 0)
+        return false;
+
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || cmsg->cmsg_level != SOL_SOCKET
+        || cmsg->cmsg_type != SCM_RIGHTS
+        || cmsg->cmsg_len != CMSG_LEN(sizeof(req.fds)))
+    {
+        return false;
+    }
+    memcpy(req.fds, CMSG_DATA(cmsg), sizeof(req.fds));
+
+    string request(buf, n);
+    while (request.size() <= MAX_REQUEST)
+    {
+        n = read(conn, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            break;
+        if (n == 0)
+        {
+            if (_parse_request(request, req))
+                return true;
+            break;
+        }
+        request.append(buf, n);
+    }
+
+    req.close_fds();
+    return false;
+}
+
+// Tell the clients of any games that have finished how they finished.
+static void _reap_games(map<pid_t, int> &games)
+{
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+    {
+        auto game = games.find(pid);
+        if (game == games.end())
+            continue;
+
+        const string reply = make_stringf("exit %d\n", status);
+        _send_all(game->second, reply.c_str(), reply.size());
+        close(game->second);
+        games.erase(game);
+    }
+}
+
+// Turn a freshly forked child into the process the request asked for.
+static void _become_game(zygote_request &req, int &argc, char **&argv)
+{
+    signal(SIGCHLD, SIG_DFL);
+    setsid();
+
+    for (int i = 0; i < 3; i++)
+        dup2(req.fds[i], i);
+    req.close_fds();
+
+    clearenv();
+    for (const string &var : req.env)
+        putenv(strdup(var.c_str()));
+
+    if (chdir(req.cwd.c_str()) < 0)
+    {
+        fprintf(stderr, "Unable to change directory to %s\n",
+                req.cwd.c_str());
+        exit(1);
+    }
+
+    static vector<char *> game_argv;
+    for (const string &arg : req.args)
+        game_argv.push_back(strdup(arg.c_str()));
+    argc = game_argv.size();
+    game_argv.push_back(nullptr);
+    argv = game_argv.data();
+
+    // Start over from this game's environment and arguments.
+    SysEnv = system_environment();
+    get_system_environment();
+    crawl_state.zygote_socket.clear();
+}
+
+static void _note_child(int)
+{
+}
+
+/**
+ * Preload what can be shared between games, then serve requests from
+ * zygote_connect() on @p socket_path until hung up on.
+ *
+ * Returns only in a forked game process, with @p argc and @p argv set to
+ * the game's own arguments; the caller should start over parsing them.
+ */
+void zygote_serve(const string &socket_path, int &argc, char **&argv)
+{
+    sockaddr_un addr;
+    if (!_socket_address(socket_path, addr))
+        end(1, false, "Socket path too long: %s", socket_path.c_str());
+
+    startup_preload();
+
+    const int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0)
+        end(1, true, "Unable to create socket");
+    unlink(socket_path.c_str());
+    if (bind(listener, (sockaddr *)&addr, sizeof(addr)) < 0
+        || listen(listener, 16) < 0)
+    {
+        end(1, true, "Unable to listen on %s", socket_path.c_str());
+    }
+
+    // Only there to interrupt poll(), so that games are reaped promptly.
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = _note_child;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_NOCLDSTOP;
+    sigaction(SIGCHLD, &sa, nullptr);
+
+    // The connection for each running game, for its exit status.
+    map<pid_t, int> games;
+
+    while (!crawl_state.seen_hups)
+    {
+        _reap_games(games);
+
+        pollfd pfd = { listener, POLLIN, 0 };
+        if (poll(&pfd, 1, 1000) <= 0)
+            continue;
+
+        const int conn = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (conn < 0)
+            continue;
+
+        zygote_request req;
+        if (!_recv_request(conn, req))
+        {
+            close(conn);
+            continue;
+        }
+
+        // Don't let every game write out what this process left buffered.
+        fflush(stdout);
+        fflush(stderr);
+
+        const pid_t pid = fork();
+        if (!pid)
+        {
+            close(listener);
+            close(conn);
+            for (const auto &game : games)
+                close(game.second);
+            _become_game(req, argc, argv);
+            return;
+        }
+        req.close_fds();
+
+        // If the game couldn't be started, dropping the connection without
+        // a pid leaves the client to run it.
+        const string reply = make_stringf("pid %d\n", pid);
+        if (pid < 0 || !_send_all(conn, reply.c_str(), reply.size()))
+        {
+            if (pid > 0)
+                kill(pid, SIGKILL);
+            close(conn);
+            continue;
+        }
+        games[pid] = conn;
+    }
+
+    close(listener);
+    unlink(socket_path.c_str());
+    end(0);
+}
+
+#endif
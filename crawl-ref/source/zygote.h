@@ -0,0 +1,13 @@
+/**
+ * @file
+ * @brief Fork server for webtiles: start once, fork a process per game.
+**/
+
+#pragma once
+
+#ifdef USE_TILE_WEB
+
+bool zygote_connect(int &argc, char **&argv);
+void zygote_serve(const string &socket_path, int &argc, char **&argv);
+
+#endif